@@ -16,11 +16,13 @@
  */
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <string.h>
 
 #include <platform.h>
 #include "build/version.h"
 #include "build/build_config.h"
+#include "build/debug.h"
 
 #ifdef BLACKBOX
 
@@ -45,6 +47,10 @@
 
 #include "fc/rate_profile.h"
 #include "fc/rc_controls.h"
+#include "fc/fc_tasks.h"
+#include "fc/fc_debug.h"
+
+#include "scheduler/scheduler.h"
 
 #include "rx/rx.h"
 
@@ -92,12 +98,57 @@ PG_RESET_TEMPLATE(blackboxConfig_t, blackboxConfig,
         .device = DEFAULT_BLACKBOX_DEVICE,
         .rate_num = 1,
         .rate_denom = 1,
+        .timing_rate = 0,
+        .mode = BLACKBOX_MODE_CONTINUOUS,
+        .triggers = BLACKBOX_TRIGGER_ALL,
+        .pre_trigger_ms = 250,
+        .post_trigger_ms = 2000,
 );
 
 #define BLACKBOX_I_INTERVAL 32
 #define BLACKBOX_SHUTDOWN_TIMEOUT_MILLIS 200
 #define SLOW_FRAME_INTERVAL 4096
 
+#define BLACKBOX_TIMING_MAX_TASKS 17
+#define BLACKBOX_TIMING_MAX_RATE_HZ 50
+
+#ifdef SKIP_TASK_STATISTICS
+#define BLACKBOX_TIMING_TASK_COUNT 0
+#else
+#define BLACKBOX_TIMING_TASK_COUNT TASK_COUNT
+#endif
+
+/*
+ * Targets with the RAM for it render the whole header while the blackbox is stopped, so that once armed it only has to
+ * be copied out to the device. With every frame type and the timing tasks logged the header is about 4kB.
+ */
+#if defined(STM32F303xC) || defined(UNIT_TEST)
+#define BLACKBOX_HEADER_BUFFER_SIZE 4608
+#define BLACKBOX_HEADER_CHECK_INTERVAL_MS 500
+
+/*
+ * The triggered mode keeps the latest frames in a ring in the memory of the header, which is free once the header is
+ * out. At 1kHz and every frame logged that is about a third of a second of flight. It takes the buffer from 4.5kB to
+ * 8.5kB of the 40kB of RAM of the F303, so only targets that define USE_BLACKBOX_RING have it.
+ */
+#if defined(USE_BLACKBOX_RING) || defined(UNIT_TEST)
+#define BLACKBOX_RING_SIZE 8192
+#endif
+#endif
+
+#ifdef BLACKBOX_RING_SIZE
+// Room for what one loop iteration logs, it is rendered past the end of the ring and then wrapped to the start
+#define BLACKBOX_RING_FRAME_MAX 512
+#define BLACKBOX_RING_MAX_INTERVALS 32
+
+// A gyro reading this far out is at the end of the range of any of the supported gyros, which no craft flies at
+#define BLACKBOX_TRIGGER_GYRO_LIMIT 30000
+#define BLACKBOX_TRIGGER_MOTOR_LIMIT_MS 100
+
+// What is left in the ring on disarming takes up to a second to send over serial
+#define BLACKBOX_RING_SHUTDOWN_TIMEOUT_MILLIS 2000
+#endif
+
 #define ARRAY_LENGTH(x) (sizeof((x))/sizeof((x)[0]))
 
 #define STATIC_ASSERT(condition, name ) \
@@ -191,6 +242,11 @@ static const blackboxDeltaFieldDefinition_t blackboxMainFields[] = {
     {"axisD",       0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(NONZERO_PID_D_0)},
     {"axisD",       1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(NONZERO_PID_D_1)},
     {"axisD",       2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(NONZERO_PID_D_2)},
+    /* Yaw setpoint feed-forward and the tail lag it compensates for, in microseconds */
+    {"axisF",       2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(YAW_FEEDFORWARD)},
+    {"tailLag",    -1, UNSIGNED, .Ipredict = PREDICT(0),       .Iencode = ENCODING(UNSIGNED_VB), .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(YAW_FEEDFORWARD)},
+    /* Bit per axis set while the actuators clip its PID output and the I-term is bled off */
+    {"saturation", -1, UNSIGNED, .Ipredict = PREDICT(0),       .Iencode = ENCODING(UNSIGNED_VB), .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(ALWAYS)},
     /* rcCommands are encoded together as a group in P-frames: */
     {"rcCommand",   0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_4S16), CONDITION(ALWAYS)},
     {"rcCommand",   1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_4S16), CONDITION(ALWAYS)},
@@ -221,6 +277,10 @@ static const blackboxDeltaFieldDefinition_t blackboxMainFields[] = {
     {"accSmooth",  0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(ALWAYS)},
     {"accSmooth",  1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(ALWAYS)},
     {"accSmooth",  2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(ALWAYS)},
+    {"debug",      0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(DEBUG)},
+    {"debug",      1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(DEBUG)},
+    {"debug",      2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(DEBUG)},
+    {"debug",      3, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(DEBUG)},
     /* Motors only rarely drops under minthrottle (when stick falls below mincommand), so predict minthrottle for it and use *unsigned* encoding (which is large for negative numbers but more compact for positive ones): */
     {"motor",      0, UNSIGNED, .Ipredict = PREDICT(MINTHROTTLE), .Iencode = ENCODING(UNSIGNED_VB), .Ppredict = PREDICT(AVERAGE_2), .Pencode = ENCODING(SIGNED_VB), CONDITION(AT_LEAST_MOTORS_1)},
     /* Subsequent motors base their I-frame values on the first one, P-frame values on the average of last two frames: */
@@ -265,6 +325,46 @@ static const blackboxSimpleFieldDefinition_t blackboxSlowFields[] = {
     {"rxFlightChannelsValid", -1, UNSIGNED, PREDICT(0),      ENCODING(TAG2_3S32)}
 };
 
+// Scheduler and loop timing since the previous timing frame
+#define BLACKBOX_TIMING_LOOP_FIELD_COUNT 5
+#define BLACKBOX_TIMING_TASK_FIELD_COUNT 4
+
+#define BLACKBOX_TIMING_TASK_FIELDS(task) \
+    {"taskRuns",              task, UNSIGNED, PREDICT(0), ENCODING(UNSIGNED_VB)}, \
+    {"taskExecTotal",         task, UNSIGNED, PREDICT(0), ENCODING(UNSIGNED_VB)}, \
+    {"taskExecMax",           task, UNSIGNED, PREDICT(0), ENCODING(UNSIGNED_VB)}, \
+    {"taskLatencyMax",        task, UNSIGNED, PREDICT(0), ENCODING(UNSIGNED_VB)}
+
+// Only the fields of the tasks in this build are logged
+static const blackboxSimpleFieldDefinition_t blackboxTimingFields[] = {
+    {"time",                  -1, UNSIGNED, PREDICT(0),      ENCODING(UNSIGNED_VB)},
+    {"loopDeltaMin",          -1, UNSIGNED, PREDICT(0),      ENCODING(UNSIGNED_VB)},
+    {"loopDeltaMax",          -1, UNSIGNED, PREDICT(0),      ENCODING(UNSIGNED_VB)},
+    {"systemLoad",            -1, UNSIGNED, PREDICT(0),      ENCODING(UNSIGNED_VB)},
+    {"rxFrameAgeMax",         -1, UNSIGNED, PREDICT(0),      ENCODING(UNSIGNED_VB)},
+
+    BLACKBOX_TIMING_TASK_FIELDS(0),
+    BLACKBOX_TIMING_TASK_FIELDS(1),
+    BLACKBOX_TIMING_TASK_FIELDS(2),
+    BLACKBOX_TIMING_TASK_FIELDS(3),
+    BLACKBOX_TIMING_TASK_FIELDS(4),
+    BLACKBOX_TIMING_TASK_FIELDS(5),
+    BLACKBOX_TIMING_TASK_FIELDS(6),
+    BLACKBOX_TIMING_TASK_FIELDS(7),
+    BLACKBOX_TIMING_TASK_FIELDS(8),
+    BLACKBOX_TIMING_TASK_FIELDS(9),
+    BLACKBOX_TIMING_TASK_FIELDS(10),
+    BLACKBOX_TIMING_TASK_FIELDS(11),
+    BLACKBOX_TIMING_TASK_FIELDS(12),
+    BLACKBOX_TIMING_TASK_FIELDS(13),
+    BLACKBOX_TIMING_TASK_FIELDS(14),
+    BLACKBOX_TIMING_TASK_FIELDS(15),
+    BLACKBOX_TIMING_TASK_FIELDS(16)
+};
+
+STATIC_ASSERT(ARRAY_LENGTH(blackboxTimingFields) == BLACKBOX_TIMING_LOOP_FIELD_COUNT + BLACKBOX_TIMING_MAX_TASKS * BLACKBOX_TIMING_TASK_FIELD_COUNT, timing_fields_do_not_match_max_tasks);
+STATIC_ASSERT(TASK_COUNT <= BLACKBOX_TIMING_MAX_TASKS, too_many_tasks_for_timing_frame);
+
 typedef enum BlackboxState {
     BLACKBOX_STATE_DISABLED = 0,
     BLACKBOX_STATE_STOPPED,
@@ -274,6 +374,7 @@ typedef enum BlackboxState {
     BLACKBOX_STATE_SEND_GPS_H_HEADER,
     BLACKBOX_STATE_SEND_GPS_G_HEADER,
     BLACKBOX_STATE_SEND_SLOW_HEADER,
+    BLACKBOX_STATE_SEND_TIMING_HEADER,
     BLACKBOX_STATE_SEND_SYSINFO,
     BLACKBOX_STATE_PAUSED,
     BLACKBOX_STATE_RUNNING,
@@ -287,10 +388,14 @@ typedef struct blackboxMainState_s {
     uint32_t time;
 
     int32_t axisPID_P[XYZ_AXIS_COUNT], axisPID_I[XYZ_AXIS_COUNT], axisPID_D[XYZ_AXIS_COUNT];
+    int32_t yawPID_F;
+    uint32_t tailLag;
+    uint8_t saturation;
 
     int16_t rcCommand[4];
     int16_t gyroADC[XYZ_AXIS_COUNT];
     int16_t accSmooth[XYZ_AXIS_COUNT];
+    int16_t debug[DEBUG16_VALUE_COUNT];
     int16_t motor[MAX_SUPPORTED_MOTORS];
     int16_t servo[MAX_SUPPORTED_SERVOS];
 
@@ -323,12 +428,23 @@ typedef struct blackboxSlowState_s {
     bool rxFlightChannelsValid;
 } __attribute__((__packed__)) blackboxSlowState_t; // We pack this struct so that padding doesn't interfere with memcmp()
 
+// Loop timing gathered over each logged iteration between timing frames
+typedef struct blackboxTimingState_s {
+    uint32_t nextFrameAt;
+    uint16_t loopDeltaMin;
+    uint16_t loopDeltaMax;
+    uint32_t rxFrameAgeMax;
+} blackboxTimingState_t;
+
 //From mixer.c:
 extern uint8_t motorCount;
 
 //From mw.c:
 extern uint32_t currentTime;
 
+//From cleanflight_fc.c:
+extern uint16_t pidDeltaUs;
+
 //From rx.c:
 extern uint16_t rssi;
 
@@ -367,6 +483,64 @@ static uint16_t vbatReference;
 
 static blackboxGpsState_t gpsHistory;
 static blackboxSlowState_t slowHistory;
+static blackboxTimingState_t timingHistory;
+
+// Microseconds between timing frames, or 0 when they are not logged, fixed while logging to agree with the header
+static uint32_t blackboxTimingInterval;
+
+#ifdef BLACKBOX_HEADER_BUFFER_SIZE
+static union {
+    uint8_t header[BLACKBOX_HEADER_BUFFER_SIZE];
+#ifdef BLACKBOX_RING_SIZE
+    uint8_t ring[BLACKBOX_RING_SIZE + BLACKBOX_RING_FRAME_MAX];
+#endif
+} blackboxBuffer;
+
+// The header rendered while stopped, without the lines only known once armed, and the hash of what it was rendered from
+static bool blackboxHeaderRendered;
+static int32_t blackboxHeaderRenderedLength;
+static uint32_t blackboxHeaderSettingsHash;
+static uint32_t blackboxHeaderCheckAt;
+
+// Bytes of blackboxBuffer.header to send for this log, or 0 when the header is sent line by line instead
+static int32_t blackboxHeaderSendLength;
+
+// The lines of values taken at arming are left out while rendering ahead of it
+static bool blackboxRenderingHeader;
+#endif
+
+#ifdef BLACKBOX_RING_SIZE
+STATIC_ASSERT((BLACKBOX_RING_SIZE & (BLACKBOX_RING_SIZE - 1)) == 0, blackbox_ring_size_not_power_of_two);
+
+// The frames of one "I" interval in the ring, which is the unit the ring is dropped and logged in
+typedef struct blackboxRingInterval_s {
+    uint32_t start;         // Position in the stream of bytes through the ring
+    uint32_t iteration;
+    uint32_t time;
+    bool afterGap;          // The frames before it were not logged, so the log is told of the jump
+    bool triggered;         // Written while triggered, so kept until sent
+} blackboxRingInterval_t;
+
+/*
+ * While the triggered mode is logging, frames are written to the ring and only sent on to the device around a trigger.
+ * Positions count the bytes through the ring since it was opened, the part of the ring they are in is the remainder.
+ */
+static struct {
+    bool open;
+    bool capturing;         // Writes go to the ring
+    bool skipping;          // Out of room, frames are dropped up to the next "I" frame with room
+    uint32_t head;          // Position of the next byte to write
+    uint32_t tail;          // Position of the next byte to send
+    uint32_t sendTo;        // What was written while triggered is all sent, after it only the interval being sent
+    bool triggered;
+    uint32_t triggeredUntil;
+    uint32_t motorLimitSince;
+    bool motorLimitReached;
+    uint8_t intervalFirst;
+    uint8_t intervalCount;
+    blackboxRingInterval_t intervals[BLACKBOX_RING_MAX_INTERVALS];
+} blackboxRing;
+#endif
 
 // Keep a history of length 2, plus a buffer for MW to store the new values into
 static blackboxMainState_t blackboxHistoryRing[3];
@@ -384,6 +558,19 @@ bool blackboxMayEditConfig()
     return blackboxState <= BLACKBOX_STATE_STOPPED;
 }
 
+/*
+ * The triggered mode may log any "I" interval after a gap in the log, so then each has to be readable without the ones
+ * before it.
+ */
+static bool blackboxIntervalsStandAlone(void)
+{
+#ifdef BLACKBOX_RING_SIZE
+    return blackboxRing.open;
+#else
+    return false;
+#endif
+}
+
 static bool blackboxIsOnlyLoggingIntraframes()
 {
     return blackboxConfig()->rate_num == 1 && blackboxConfig()->rate_denom == 32;
@@ -413,6 +600,9 @@ static bool testBlackboxConditionUncached(FlightLogFieldCondition condition)
         case FLIGHT_LOG_FIELD_CONDITION_NONZERO_PID_D_2:
             return pidProfile()->D8[condition - FLIGHT_LOG_FIELD_CONDITION_NONZERO_PID_D_0] != 0;
 
+        case FLIGHT_LOG_FIELD_CONDITION_YAW_FEEDFORWARD:
+            return pidProfile()->yaw_ff_lead_ms != 0 && pidProfile()->pidController == PID_CONTROLLER_LUX_FLOAT;
+
         case FLIGHT_LOG_FIELD_CONDITION_MAG:
 #ifdef MAG
             return sensors(SENSOR_MAG);
@@ -443,6 +633,9 @@ static bool testBlackboxConditionUncached(FlightLogFieldCondition condition)
         case FLIGHT_LOG_FIELD_CONDITION_RSSI:
             return rxConfig()->rssi_channel > 0 || feature(FEATURE_RSSI_ADC);
 
+        case FLIGHT_LOG_FIELD_CONDITION_DEBUG:
+            return debugMode != DEBUG_NONE;
+
         case FLIGHT_LOG_FIELD_CONDITION_NOT_LOGGING_EVERY_FRAME:
             return blackboxConfig()->rate_num < blackboxConfig()->rate_denom;
 
@@ -471,6 +664,78 @@ static bool testBlackboxCondition(FlightLogFieldCondition condition)
     return (blackboxConditionCache & (1 << condition)) != 0;
 }
 
+/**
+ * Start a new timing window, discarding the task statistics gathered so far.
+ */
+static void blackboxResetTimingState(void)
+{
+#ifndef SKIP_TASK_STATISTICS
+    cfTaskTimingWindow_t window;
+
+    for (int i = 0; i < BLACKBOX_TIMING_TASK_COUNT; i++) {
+        getTaskTimingWindow(i, &window);
+    }
+#endif
+
+    timingHistory.nextFrameAt = currentTime + blackboxTimingInterval;
+    timingHistory.loopDeltaMin = UINT16_MAX;
+    timingHistory.loopDeltaMax = 0;
+    timingHistory.rxFrameAgeMax = 0;
+}
+
+static void updateTimingState(void)
+{
+    timingHistory.loopDeltaMin = MIN(timingHistory.loopDeltaMin, pidDeltaUs);
+    timingHistory.loopDeltaMax = MAX(timingHistory.loopDeltaMax, pidDeltaUs);
+    timingHistory.rxFrameAgeMax = MAX(timingHistory.rxFrameAgeMax, rxGetFrameAge(currentTime));
+}
+
+/* Write a "T" frame of the loop timing and the per-task statistics since the last one. The statistics are independent
+ * of each other between frames, so they are not predicted. */
+static void writeTimingFrame(void)
+{
+    blackboxWrite('T');
+
+    blackboxWriteUnsignedVB(currentTime);
+    blackboxWriteUnsignedVB(timingHistory.loopDeltaMin);
+    blackboxWriteUnsignedVB(timingHistory.loopDeltaMax);
+    blackboxWriteUnsignedVB(averageSystemLoadPercent);
+    blackboxWriteUnsignedVB(timingHistory.rxFrameAgeMax);
+
+#ifndef SKIP_TASK_STATISTICS
+    for (int i = 0; i < BLACKBOX_TIMING_TASK_COUNT; i++) {
+        cfTaskTimingWindow_t window;
+
+        getTaskTimingWindow(i, &window);
+
+        blackboxWriteUnsignedVB(window.executionCount);
+        blackboxWriteUnsignedVB(window.totalExecutionTime);
+        blackboxWriteUnsignedVB(window.maxExecutionTime);
+        blackboxWriteUnsignedVB(window.maxLatency);
+    }
+#endif
+
+    timingHistory.nextFrameAt += blackboxTimingInterval;
+    if ((int32_t)(currentTime - timingHistory.nextFrameAt) >= 0) {
+        // We fell behind (e.g. the log was paused), don't try to catch up
+        timingHistory.nextFrameAt = currentTime + blackboxTimingInterval;
+    }
+    timingHistory.loopDeltaMin = UINT16_MAX;
+    timingHistory.loopDeltaMax = 0;
+    timingHistory.rxFrameAgeMax = 0;
+}
+
+#ifdef BLACKBOX_RING_SIZE
+static void blackboxRingOpen(void)
+{
+    memset(&blackboxRing, 0, sizeof(blackboxRing));
+    blackboxRing.open = true;
+
+    // The ring overwrites the header, which has to be rendered again for the next log
+    blackboxHeaderRendered = false;
+}
+#endif
+
 static void blackboxSetState(BlackboxState newState)
 {
     //Perform initial setup required for the new state
@@ -487,6 +752,7 @@ static void blackboxSetState(BlackboxState newState)
         case BLACKBOX_STATE_SEND_GPS_G_HEADER:
         case BLACKBOX_STATE_SEND_GPS_H_HEADER:
         case BLACKBOX_STATE_SEND_SLOW_HEADER:
+        case BLACKBOX_STATE_SEND_TIMING_HEADER:
             xmitState.headerIndex = 0;
             xmitState.u.fieldIndex = -1;
         break;
@@ -495,10 +761,21 @@ static void blackboxSetState(BlackboxState newState)
         break;
         case BLACKBOX_STATE_RUNNING:
             blackboxSlowFrameIterationTimer = SLOW_FRAME_INTERVAL; //Force a slow frame to be written on the first iteration
+            blackboxResetTimingState(); // Don't include the time spent sending headers or paused in the first timing frame
+#ifdef BLACKBOX_RING_SIZE
+            if (blackboxConfig()->mode == BLACKBOX_MODE_TRIGGERED && !blackboxRing.open) {
+                blackboxRingOpen();
+            }
+#endif
         break;
         case BLACKBOX_STATE_SHUTTING_DOWN:
             xmitState.u.startTime = millis();
         break;
+#ifdef BLACKBOX_RING_SIZE
+        case BLACKBOX_STATE_STOPPED:
+            blackboxRing.open = false;
+        break;
+#endif
         default:
             ;
     }
@@ -525,6 +802,13 @@ static void writeIntraframe(void)
         }
     }
 
+    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_YAW_FEEDFORWARD)) {
+        blackboxWriteSignedVB(blackboxCurrent->yawPID_F);
+        blackboxWriteUnsignedVB(blackboxCurrent->tailLag);
+    }
+
+    blackboxWriteUnsignedVB(blackboxCurrent->saturation);
+
     // Write roll, pitch and yaw first:
     blackboxWriteSigned16VBArray(blackboxCurrent->rcCommand, 3);
 
@@ -573,6 +857,10 @@ static void writeIntraframe(void)
     blackboxWriteSigned16VBArray(blackboxCurrent->gyroADC, XYZ_AXIS_COUNT);
     blackboxWriteSigned16VBArray(blackboxCurrent->accSmooth, XYZ_AXIS_COUNT);
 
+    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_DEBUG)) {
+        blackboxWriteSigned16VBArray(blackboxCurrent->debug, DEBUG16_VALUE_COUNT);
+    }
+
     //Motors can be below minthrottle when disarmed, but that doesn't happen much
     blackboxWriteUnsignedVB(blackboxCurrent->motor[0] - motorConfig()->minthrottle);
 
@@ -650,6 +938,13 @@ static void writeInterframe(void)
         }
     }
 
+    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_YAW_FEEDFORWARD)) {
+        blackboxWriteSignedVB(blackboxCurrent->yawPID_F - blackboxLast->yawPID_F);
+        blackboxWriteSignedVB((int32_t) (blackboxCurrent->tailLag - blackboxLast->tailLag));
+    }
+
+    blackboxWriteSignedVB(blackboxCurrent->saturation - blackboxLast->saturation);
+
     /*
      * RC tends to stay the same or fairly small for many frames at a time, so use an encoding that
      * can pack multiple values per byte:
@@ -700,6 +995,9 @@ static void writeInterframe(void)
     //Since gyros, accs and motors are noisy, base their predictions on the average of the history:
     blackboxWriteMainStateArrayUsingAveragePredictor(offsetof(blackboxMainState_t, gyroADC),   XYZ_AXIS_COUNT);
     blackboxWriteMainStateArrayUsingAveragePredictor(offsetof(blackboxMainState_t, accSmooth), XYZ_AXIS_COUNT);
+    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_DEBUG)) {
+        blackboxWriteMainStateArrayUsingAveragePredictor(offsetof(blackboxMainState_t, debug), DEBUG16_VALUE_COUNT);
+    }
     blackboxWriteMainStateArrayUsingAveragePredictor(offsetof(blackboxMainState_t, motor),     motorCount);
 
     if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_TRICOPTER)) {
@@ -821,6 +1119,19 @@ static void validateBlackboxConfig()
         default:
             blackboxConfig()->device = BLACKBOX_DEVICE_SERIAL;
     }
+
+    if (blackboxConfig()->timing_rate > BLACKBOX_TIMING_MAX_RATE_HZ) {
+        blackboxConfig()->timing_rate = BLACKBOX_TIMING_MAX_RATE_HZ;
+    }
+
+    // Only targets with the RAM for the ring have the triggered mode
+#ifdef BLACKBOX_RING_SIZE
+    if (blackboxConfig()->mode > BLACKBOX_MODE_TRIGGERED) {
+#else
+    if (blackboxConfig()->mode != BLACKBOX_MODE_CONTINUOUS) {
+#endif
+        blackboxConfig()->mode = BLACKBOX_MODE_CONTINUOUS;
+    }
 }
 
 /**
@@ -853,6 +1164,8 @@ void startBlackbox(void)
          * cache those now.
          */
         blackboxBuildConditionCache();
+
+        blackboxTimingInterval = blackboxConfig()->timing_rate ? 1000000 / blackboxConfig()->timing_rate : 0;
         
         blackboxModeActivationConditionPresent = rcModeIsActivationConditionPresent(modeActivationProfile()->modeActivationConditions, BOXBLACKBOX);
 
@@ -884,6 +1197,13 @@ void finishBlackbox(void)
 
         case BLACKBOX_STATE_RUNNING:
         case BLACKBOX_STATE_PAUSED:
+#ifdef BLACKBOX_RING_SIZE
+            if (blackboxRing.open) {
+                // The end of the log is written after what is left to send of the ring
+                blackboxSetState(BLACKBOX_STATE_SHUTTING_DOWN);
+                break;
+            }
+#endif
             blackboxLogEvent(FLIGHT_LOG_EVENT_LOG_END, NULL);
 
             // Fall through
@@ -952,6 +1272,9 @@ static void loadMainState(void)
     for (i = 0; i < XYZ_AXIS_COUNT; i++) {
         blackboxCurrent->axisPID_D[i] = axisPID_D[i];
     }
+    blackboxCurrent->yawPID_F = axisPID_F[YAW];
+    blackboxCurrent->tailLag = tailLagTime * 1000000.0f;
+    blackboxCurrent->saturation = pidSaturationFlags;
 
     for (i = 0; i < 4; i++) {
         blackboxCurrent->rcCommand[i] = rcCommand[i];
@@ -965,6 +1288,10 @@ static void loadMainState(void)
         blackboxCurrent->accSmooth[i] = accSmooth[i];
     }
 
+    for (i = 0; i < DEBUG16_VALUE_COUNT; i++) {
+        blackboxCurrent->debug[i] = debug[i];
+    }
+
     for (i = 0; i < motorCount; i++) {
         blackboxCurrent->motor[i] = motor[i];
     }
@@ -1117,6 +1444,8 @@ static bool sendFieldDefinition(char mainFrameChar, char deltaFrameChar, const v
  * Transmit a portion of the system information headers. Call the first time with xmitState.headerIndex == 0. Returns
  * true iff transmission is complete, otherwise call again later to continue transmission.
  */
+#define BLACKBOX_SYSINFO_TIMING_TASK_FIRST 42
+
 static bool blackboxWriteSysinfo()
 {
     // Make sure we have enough room in the buffer for our longest line (as of this writing, the "Firmware date" line)
@@ -1171,6 +1500,11 @@ static bool blackboxWriteSysinfo()
             );
         break;
         case 12:
+#ifdef BLACKBOX_HEADER_BUFFER_SIZE
+            if (blackboxRenderingHeader) {
+                break; // Added once armed by blackboxPrepareRenderedHeader()
+            }
+#endif
             blackboxPrintfHeaderLine("vbatref:%u", vbatReference);
         break;
         case 13:
@@ -1185,7 +1519,115 @@ static bool blackboxWriteSysinfo()
                 );
             }
         break;
+        case 14:
+            blackboxPrintfHeaderLine("yaw_ff_lead_ms:%d", pidProfile()->yaw_ff_lead_ms);
+        break;
+        // The settings the control path depends on, so a log can be replayed through it offline
+        case 15:
+            blackboxPrintfHeaderLine("looptime:%u", targetPidLooptime);
+        break;
+        case 16:
+            blackboxPrintfHeaderLine("pid_controller:%d", pidProfile()->pidController);
+        break;
+        case 17:
+            blackboxPrintfHeaderLine("rollPID:%d,%d,%d", pidProfile()->P8[PIDROLL], pidProfile()->I8[PIDROLL], pidProfile()->D8[PIDROLL]);
+        break;
+        case 18:
+            blackboxPrintfHeaderLine("pitchPID:%d,%d,%d", pidProfile()->P8[PIDPITCH], pidProfile()->I8[PIDPITCH], pidProfile()->D8[PIDPITCH]);
+        break;
+        case 19:
+            blackboxPrintfHeaderLine("yawPID:%d,%d,%d", pidProfile()->P8[PIDYAW], pidProfile()->I8[PIDYAW], pidProfile()->D8[PIDYAW]);
+        break;
+        case 20:
+            blackboxPrintfHeaderLine("levelPID:%d,%d,%d", pidProfile()->P8[PIDLEVEL], pidProfile()->I8[PIDLEVEL], pidProfile()->D8[PIDLEVEL]);
+        break;
+        case 21:
+            blackboxPrintfHeaderLine("yaw_p_limit:%d", pidProfile()->yaw_p_limit);
+        break;
+        case 22:
+            blackboxPrintfHeaderLine("pid_delta_method:%d", pidProfile()->deltaMethod);
+        break;
+        case 23:
+            blackboxPrintfHeaderLine("dterm_lowpass:%d,%d", pidProfile()->dterm_filter_type, pidProfile()->dterm_lpf_hz);
+        break;
+        case 24:
+            blackboxPrintfHeaderLine("dterm_notch:%d,%d", pidProfile()->dterm_notch_hz, pidProfile()->dterm_notch_cutoff);
+        break;
+        case 25:
+            blackboxPrintfHeaderLine("yaw_lpf_hz:%d", pidProfile()->yaw_lpf_hz);
+        break;
+        case 26:
+            blackboxPrintfHeaderLine("rates:%d,%d,%d", currentControlRateProfile->rates[ROLL], currentControlRateProfile->rates[PITCH], currentControlRateProfile->rates[YAW]);
+        break;
+        case 27:
+            blackboxPrintfHeaderLine("tpa:%d,%d", currentControlRateProfile->dynThrPID, currentControlRateProfile->tpa_breakpoint);
+        break;
+        case 28:
+            blackboxPrintfHeaderLine("gyro_lowpass:%d,%d", gyroConfig()->gyro_soft_type, gyroConfig()->gyro_soft_lpf_hz);
+        break;
+        case 29:
+            blackboxPrintfHeaderLine("gyro_notch:%d,%d", gyroConfig()->gyro_soft_notch_hz, gyroConfig()->gyro_soft_notch_cutoff_hz);
+        break;
+        case 30:
+            blackboxPrintfHeaderLine("mixer:%d", mixerConfig()->mixerMode);
+        break;
+        case 31:
+            blackboxPrintfHeaderLine("min_command:%d", motorConfig()->mincommand);
+        break;
+        case 32:
+            blackboxPrintfHeaderLine("yaw_motor_direction:%d", mixerConfig()->yaw_motor_direction);
+        break;
+        case 33:
+            blackboxPrintfHeaderLine("yaw_jump_prevention_limit:%d", mixerConfig()->yaw_jump_prevention_limit);
+        break;
+        case 34:
+            blackboxPrintfHeaderLine("pid_at_min_throttle:%d", mixerConfig()->pid_at_min_throttle);
+        break;
+#ifdef USE_SERVOS
+        case 35:
+            blackboxPrintfHeaderLine("servo_lowpass:%d,0x%x", mixerConfig()->servo_lowpass_enable, castFloatBytesToInt(mixerConfig()->servo_lowpass_freq));
+        break;
+        case 36:
+            if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_TRICOPTER)) {
+                const servoParam_t *tailServo = &servoProfile()->servoConf[SERVO_RUDDER];
+
+                blackboxPrintfHeaderLine("tri_tail_servo:%d,%d,%d,%d,%d", tailServo->min, tailServo->middle, tailServo->max,
+                    tailServo->angleAtMin, tailServo->angleAtMax);
+            } else {
+                xmitState.headerIndex += 4; // Skip the rest of the tricopter settings too
+            }
+        break;
+        case 37:
+            blackboxPrintfHeaderLine("tri_tail:%d,%d,%d", mixerConfig()->tri_tail_motor_thrustfactor, mixerConfig()->tri_tail_servo_speed,
+                mixerConfig()->tri_servo_feedback);
+        break;
+        case 38:
+            blackboxPrintfHeaderLine("tri_motor_acc_yaw_correction:%d", mixerConfig()->tri_motor_acc_yaw_correction);
+        break;
+        case 39:
+            blackboxPrintfHeaderLine("tri_motor_acceleration:0x%x", castFloatBytesToInt(mixerConfig()->tri_motor_acceleration));
+        break;
+        case 40:
+            blackboxPrintfHeaderLine("tri_dynamic_yaw:%d,%d", currentControlRateProfile->tri_dynamic_yaw_minthrottle,
+                currentControlRateProfile->tri_dynamic_yaw_maxthrottle);
+        break;
+#else
+        case 35:
+            xmitState.headerIndex += 5; // No servo settings to log
+        break;
+#endif
+        case 41:
+            blackboxPrintfHeaderLine("debug_mode:%d", debugMode);
+        break;
         default:
+#ifndef SKIP_TASK_STATISTICS
+            // Name the tasks whose statistics are in the timing frame, one line each
+            if (blackboxTimingInterval && xmitState.headerIndex - BLACKBOX_SYSINFO_TIMING_TASK_FIRST < BLACKBOX_TIMING_TASK_COUNT) {
+                const int taskId = xmitState.headerIndex - BLACKBOX_SYSINFO_TIMING_TASK_FIRST;
+                blackboxPrintfHeaderLine("Timing task %d:%s", taskId, cfTasks[taskId].taskName);
+                break;
+            }
+#endif
             return true;
     }
 
@@ -1193,16 +1635,173 @@ static bool blackboxWriteSysinfo()
     return false;
 }
 
-/**
- * Write the given event to the log immediately
+#ifdef BLACKBOX_HEADER_BUFFER_SIZE
+static uint32_t hashBytes(uint32_t hash, const void *data, int length)
+{
+    const uint8_t *bytes = (const uint8_t *)data;
+
+    // FNV-1a
+    for (int i = 0; i < length; i++) {
+        hash = (hash ^ bytes[i]) * 16777619;
+    }
+
+    return hash;
+}
+
+/*
+ * Hash of everything the header is made from that can change after startup: the settings of the current profile and
+ * the field conditions, which also follow the detected sensors.
  */
-void blackboxLogEvent(FlightLogEvent event, flightLogEventData_t *data)
+static uint32_t blackboxHashHeaderSettings(void)
 {
-    // Only allow events to be logged after headers have been written
-    if (!(blackboxState == BLACKBOX_STATE_RUNNING || blackboxState == BLACKBOX_STATE_PAUSED)) {
-        return;
+    uint32_t hash = 2166136261;
+
+    PG_FOREACH(reg) {
+        hash = hashBytes(hash, pgIsSystem(reg) ? reg->address : *reg->ptr, pgSize(reg));
+    }
+    hash = hashBytes(hash, currentControlRateProfile, sizeof(*currentControlRateProfile));
+    hash = hashBytes(hash, &targetPidLooptime, sizeof(targetPidLooptime));
+
+    blackboxBuildConditionCache();
+    hash = hashBytes(hash, &blackboxConditionCache, sizeof(blackboxConditionCache));
+
+    return hash;
+}
+
+static void renderFieldDefinition(char mainFrameChar, char deltaFrameChar, const void *fieldDefinitions,
+        const void *secondFieldDefinition, int fieldCount, const uint8_t *conditions, const uint8_t *secondCondition)
+{
+    xmitState.headerIndex = 0;
+    xmitState.u.fieldIndex = -1;
+
+    // Writes to the render buffer never have to wait, so each call completes a line
+    while (sendFieldDefinition(mainFrameChar, deltaFrameChar, fieldDefinitions, secondFieldDefinition, fieldCount,
+            conditions, secondCondition)) {
+    }
+}
+
+/*
+ * Render the header into blackboxBuffer.header in one go, in the order the header sending states write it. The
+ * settings are taken as they are, if arming changes them when validating the header is rendered again then.
+ */
+static void blackboxRenderHeader(void)
+{
+    blackboxHeaderSettingsHash = blackboxHashHeaderSettings();
+    blackboxTimingInterval = blackboxConfig()->timing_rate ? 1000000 / blackboxConfig()->timing_rate : 0;
+
+    blackboxRenderingHeader = true;
+    blackboxBeginRender(blackboxBuffer.header, sizeof(blackboxBuffer.header));
+
+    blackboxPrint(blackboxHeader);
+
+    renderFieldDefinition('I', 'P', blackboxMainFields, blackboxMainFields + 1, ARRAY_LENGTH(blackboxMainFields),
+        &blackboxMainFields[0].condition, &blackboxMainFields[1].condition);
+#ifdef GPS
+    if (feature(FEATURE_GPS)) {
+        renderFieldDefinition('H', 0, blackboxGpsHFields, blackboxGpsHFields + 1, ARRAY_LENGTH(blackboxGpsHFields),
+            NULL, NULL);
+        renderFieldDefinition('G', 0, blackboxGpsGFields, blackboxGpsGFields + 1, ARRAY_LENGTH(blackboxGpsGFields),
+            &blackboxGpsGFields[0].condition, &blackboxGpsGFields[1].condition);
+    }
+#endif
+    renderFieldDefinition('S', 0, blackboxSlowFields, blackboxSlowFields + 1, ARRAY_LENGTH(blackboxSlowFields),
+        NULL, NULL);
+    if (blackboxTimingInterval) {
+        renderFieldDefinition('T', 0, blackboxTimingFields, blackboxTimingFields + 1,
+            BLACKBOX_TIMING_LOOP_FIELD_COUNT + BLACKBOX_TIMING_TASK_COUNT * BLACKBOX_TIMING_TASK_FIELD_COUNT, NULL, NULL);
+    }
+
+    xmitState.headerIndex = 0;
+    while (!blackboxWriteSysinfo()) {
+    }
+
+    blackboxHeaderRenderedLength = blackboxEndRender();
+    blackboxRenderingHeader = false;
+
+    // A header too long for the buffer is sent line by line as before
+    blackboxHeaderRendered = blackboxHeaderRenderedLength >= 0;
+}
+
+static bool blackboxRenderedHeaderIsCurrent(void)
+{
+    return blackboxHeaderRendered && blackboxHashHeaderSettings() == blackboxHeaderSettingsHash;
+}
+
+/*
+ * Called on arming once the settings are validated. Renders the header again if the settings changed since it was
+ * last rendered, then adds the lines of the values taken at arming.
+ */
+static void blackboxPrepareRenderedHeader(void)
+{
+    if (!blackboxRenderedHeaderIsCurrent()) {
+        blackboxRenderHeader();
     }
 
+    blackboxHeaderSendLength = 0;
+
+    if (blackboxHeaderRendered) {
+        blackboxBeginRender(blackboxBuffer.header + blackboxHeaderRenderedLength,
+            sizeof(blackboxBuffer.header) - blackboxHeaderRenderedLength);
+
+        if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_VBAT)) {
+            blackboxPrintfHeaderLine("vbatref:%u", vbatReference);
+        }
+
+        const int32_t armingLinesLength = blackboxEndRender();
+        if (armingLinesLength >= 0) {
+            blackboxHeaderSendLength = blackboxHeaderRenderedLength + armingLinesLength;
+        }
+    }
+}
+#endif
+
+#ifdef BLACKBOX_RING_SIZE
+static blackboxRingInterval_t *blackboxRingInterval(int index)
+{
+    return &blackboxRing.intervals[(blackboxRing.intervalFirst + index) % BLACKBOX_RING_MAX_INTERVALS];
+}
+
+static int32_t blackboxRingFree(void)
+{
+    return BLACKBOX_RING_SIZE - (int32_t)(blackboxRing.head - blackboxRing.tail);
+}
+
+/*
+ * Point the writes at the free part of the ring. What runs past the end of the ring goes to the room after it, and
+ * is moved to the start by blackboxRingEndCapture().
+ */
+static void blackboxRingBeginCapture(void)
+{
+    const int32_t index = blackboxRing.head % BLACKBOX_RING_SIZE;
+
+    blackboxRing.capturing = true;
+    blackboxBeginRender(&blackboxBuffer.ring[index], MIN(blackboxRingFree(), BLACKBOX_RING_SIZE + BLACKBOX_RING_FRAME_MAX - index));
+}
+
+// Returns false if what was written did not fit in the ring, it is dropped then
+static bool blackboxRingEndCapture(void)
+{
+    const int32_t index = blackboxRing.head % BLACKBOX_RING_SIZE;
+    const int32_t length = blackboxEndRender();
+
+    blackboxRing.capturing = false;
+
+    if (length < 0) {
+        return false;
+    }
+
+    if (index + length > BLACKBOX_RING_SIZE) {
+        memcpy(blackboxBuffer.ring, &blackboxBuffer.ring[BLACKBOX_RING_SIZE], index + length - BLACKBOX_RING_SIZE);
+    }
+    blackboxRing.head += length;
+
+    return true;
+}
+
+#endif
+
+static void writeEventFrame(FlightLogEvent event, flightLogEventData_t *data)
+{
     //Shared header for event frames
     blackboxWrite('E');
     blackboxWrite(event);
@@ -1236,6 +1835,29 @@ void blackboxLogEvent(FlightLogEvent event, flightLogEventData_t *data)
     }
 }
 
+/**
+ * Write the given event to the log immediately
+ */
+void blackboxLogEvent(FlightLogEvent event, flightLogEventData_t *data)
+{
+    // Only allow events to be logged after headers have been written
+    if (!(blackboxState == BLACKBOX_STATE_RUNNING || blackboxState == BLACKBOX_STATE_PAUSED)) {
+        return;
+    }
+
+#ifdef BLACKBOX_RING_SIZE
+    // Keep the event in order with the frames in the ring, unless it is written as part of them
+    if (blackboxRing.open && !blackboxRing.capturing) {
+        blackboxRingBeginCapture();
+        writeEventFrame(event, data);
+        blackboxRingEndCapture();
+        return;
+    }
+#endif
+
+    writeEventFrame(event, data);
+}
+
 /* If an arming beep has played since it was last logged, write the time of the arming beep to the log as a synchronization point */
 static void blackboxCheckAndLogArmingBeep()
 {
@@ -1284,13 +1906,20 @@ static void blackboxAdvanceIterationTimers()
 // Called once every FC loop in order to log the current state
 static void blackboxLogIteration()
 {
+    if (blackboxTimingInterval) {
+        updateTimingState();
+    }
+
     // Write a keyframe every BLACKBOX_I_INTERVAL frames so we can resynchronise upon missing frames
     if (blackboxShouldLogIFrame()) {
         /*
          * Don't log a slow frame if the slow data didn't change ("I" frames are already large enough without adding
          * an additional item to write at the same time). Unless we're *only* logging "I" frames, then we have no choice.
          */
-        writeSlowFrameIfNeeded(blackboxIsOnlyLoggingIntraframes());
+        if (blackboxIntervalsStandAlone()) {
+            blackboxSlowFrameIterationTimer = SLOW_FRAME_INTERVAL;
+        }
+        writeSlowFrameIfNeeded(blackboxIsOnlyLoggingIntraframes() || blackboxIntervalsStandAlone());
 
         loadMainState();
         writeIntraframe();
@@ -1314,10 +1943,11 @@ static void blackboxLogIteration()
              * GPS home position.
              *
              * We write it periodically so that if one Home Frame goes missing, the GPS coordinates can
-             * still be interpreted correctly.
+             * still be interpreted correctly. Intervals that stand alone write it before their first GPS frame.
              */
             if (GPS_home[0] != gpsHistory.GPS_home[0] || GPS_home[1] != gpsHistory.GPS_home[1]
-                || (blackboxPFrameIndex == BLACKBOX_I_INTERVAL / 2 && blackboxIFrameIndex % 128 == 0)) {
+                || (blackboxPFrameIndex == BLACKBOX_I_INTERVAL / 2 && blackboxIFrameIndex % 128 == 0)
+                || (blackboxPFrameIndex == 1 && blackboxIntervalsStandAlone())) {
 
                 writeGPSHomeFrame();
                 writeGPSFrame();
@@ -1328,12 +1958,233 @@ static void blackboxLogIteration()
             }
         }
 #endif
+
+        // Timing frames are small compared to an "I" frame but still keep them apart
+        if (blackboxTimingInterval && (int32_t)(currentTime - timingHistory.nextFrameAt) >= 0) {
+            writeTimingFrame();
+        }
     }
 
     //Flush every iteration so that our runtime variance is minimized
     blackboxDeviceFlush();
 }
 
+#ifdef BLACKBOX_RING_SIZE
+/*
+ * Drop the oldest interval of frames, unless it is being sent or to be sent. To make room for the frames of a trigger
+ * those from before it are dropped even if they are to be sent, a slow device would otherwise still be sending them
+ * while the frames of the trigger are lost. The interval being written is never dropped.
+ */
+static bool blackboxRingDropOldest(bool forRoom)
+{
+    const blackboxRingInterval_t *oldest = blackboxRingInterval(0);
+
+    if (blackboxRing.intervalCount < 2 || (int32_t)(blackboxRing.tail - oldest->start) > 0) {
+        return false;
+    }
+    if ((int32_t)(blackboxRing.sendTo - oldest->start) > 0 && (!forRoom || oldest->triggered)) {
+        return false;
+    }
+
+    blackboxRing.intervalFirst = (blackboxRing.intervalFirst + 1) % BLACKBOX_RING_MAX_INTERVALS;
+    blackboxRing.intervalCount--;
+    blackboxRing.tail = blackboxRingInterval(0)->start;
+    blackboxRingInterval(0)->afterGap = true;
+
+    return true;
+}
+
+// Keep only the intervals of the last pre_trigger_ms that are not to be sent, and drop the oldest to make room
+static void blackboxRingDropExpired(void)
+{
+    const uint32_t keepFrom = currentTime - blackboxConfig()->pre_trigger_ms * 1000;
+
+    while (blackboxRing.intervalCount >= 2) {
+        const bool forRoom = blackboxRingFree() < BLACKBOX_RING_FRAME_MAX;
+
+        if (!forRoom && (int32_t)(keepFrom - blackboxRingInterval(1)->time) < 0) {
+            break;
+        }
+        if (!blackboxRingDropOldest(forRoom)) {
+            break;
+        }
+    }
+}
+
+static uint8_t blackboxRingActiveTriggers(void)
+{
+    uint8_t triggers = 0;
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        if (ABS(gyroADC[axis]) >= BLACKBOX_TRIGGER_GYRO_LIMIT) {
+            triggers |= BLACKBOX_TRIGGER_CRASH;
+        }
+    }
+
+    if (failsafePhase() != FAILSAFE_IDLE) {
+        triggers |= BLACKBOX_TRIGGER_FAILSAFE;
+    }
+
+    // The mixer runs into the motor limits for a moment in any hard manoeuvre, only a longer burst is of interest
+    if (!motorLimitReached) {
+        blackboxRing.motorLimitReached = false;
+    } else if (!blackboxRing.motorLimitReached) {
+        blackboxRing.motorLimitReached = true;
+        blackboxRing.motorLimitSince = millis();
+    } else if (millis() - blackboxRing.motorLimitSince >= BLACKBOX_TRIGGER_MOTOR_LIMIT_MS) {
+        triggers |= BLACKBOX_TRIGGER_MOTOR_LIMIT;
+    }
+
+    if (rcModeIsActive(BOXBLACKBOX)) {
+        triggers |= BLACKBOX_TRIGGER_SWITCH;
+    }
+
+    return triggers & blackboxConfig()->triggers;
+}
+
+static void blackboxRingUpdateTrigger(void)
+{
+    if (blackboxRingActiveTriggers()) {
+        // The interval being written holds the first frames of the trigger
+        if (!blackboxRing.triggered && blackboxRing.intervalCount > 0) {
+            blackboxRingInterval(blackboxRing.intervalCount - 1)->triggered = true;
+        }
+        blackboxRing.triggered = true;
+        blackboxRing.triggeredUntil = millis() + blackboxConfig()->post_trigger_ms;
+    } else if (blackboxRing.triggered && (int32_t)(millis() - blackboxRing.triggeredUntil) > 0) {
+        blackboxRing.triggered = false;
+    }
+}
+
+// Tell the log of the frames skipped before this interval, as is done on resuming from a pause
+static bool blackboxRingSendResume(blackboxRingInterval_t *interval)
+{
+    flightLogEvent_loggingResume_t resume;
+    uint8_t event[16];
+
+    resume.logIteration = interval->iteration;
+    resume.currentTime = interval->time;
+
+    blackboxBeginRender(event, sizeof(event));
+    writeEventFrame(FLIGHT_LOG_EVENT_LOGGING_RESUME, (flightLogEventData_t *) &resume);
+    const int32_t length = blackboxEndRender();
+
+    if (length > blackboxHeaderBudget) {
+        return false;
+    }
+
+    blackboxWriteBuf(event, length);
+    blackboxHeaderBudget -= length;
+    interval->afterGap = false;
+
+    return true;
+}
+
+/*
+ * Send on the frames in the ring, as many as the device takes this iteration. Past what was written while triggered
+ * that is only to the end of the interval being sent, so that the log only ever skips whole intervals.
+ *
+ * Returns true once there is nothing more to send.
+ */
+static bool blackboxRingSend(void)
+{
+    while (true) {
+        while (blackboxRing.intervalCount >= 2 && (int32_t)(blackboxRing.tail - blackboxRingInterval(1)->start) >= 0) {
+            blackboxRing.intervalFirst = (blackboxRing.intervalFirst + 1) % BLACKBOX_RING_MAX_INTERVALS;
+            blackboxRing.intervalCount--;
+        }
+
+        const bool atIntervalStart = blackboxRing.intervalCount > 0 && blackboxRing.tail == blackboxRingInterval(0)->start;
+
+        if (blackboxRing.tail == blackboxRing.head || (atIntervalStart && (int32_t)(blackboxRing.sendTo - blackboxRing.tail) <= 0)) {
+            return true;
+        }
+
+        // Frames from before a trigger are only sent while they leave half of the ring for the frames of the trigger
+        if (atIntervalStart && !blackboxRingInterval(0)->triggered && blackboxRingFree() < BLACKBOX_RING_SIZE / 2
+                && blackboxRingDropOldest(true)) {
+            continue;
+        }
+
+        if (atIntervalStart && blackboxRingInterval(0)->afterGap && !blackboxRingSendResume(blackboxRingInterval(0))) {
+            return false;
+        }
+
+        // Stop at the start of the next interval, which may have to be told of a gap before it
+        uint32_t end = blackboxRing.head;
+        for (int i = 0; i < blackboxRing.intervalCount; i++) {
+            if ((int32_t)(blackboxRingInterval(i)->start - blackboxRing.tail) > 0) {
+                end = blackboxRingInterval(i)->start;
+                break;
+            }
+        }
+
+        const int32_t index = blackboxRing.tail % BLACKBOX_RING_SIZE;
+        const int32_t length = MIN(MIN(blackboxHeaderBudget, (int32_t)(end - blackboxRing.tail)), BLACKBOX_RING_SIZE - index);
+
+        if (length <= 0) {
+            return false;
+        }
+
+        blackboxWriteBuf(&blackboxBuffer.ring[index], length);
+        blackboxHeaderBudget -= length;
+        blackboxRing.tail += length;
+        blackboxLoggedAnyFrames = true;
+    }
+}
+
+/*
+ * Log the iteration to the ring, in place of blackboxLogIteration(), and send on what a trigger asks for.
+ */
+static void blackboxRingLogIteration(void)
+{
+    // Frames only count as logged once they are sent
+    const bool loggedAnyFrames = blackboxLoggedAnyFrames;
+    const uint32_t start = blackboxRing.head;
+
+    blackboxRingUpdateTrigger();
+    blackboxRingDropExpired();
+
+    if (blackboxShouldLogIFrame()) {
+        if (blackboxRing.intervalCount == BLACKBOX_RING_MAX_INTERVALS && !blackboxRingDropOldest(true)) {
+            blackboxRing.skipping = true;
+        } else {
+            blackboxRingBeginCapture();
+            blackboxLogIteration();
+
+            if (blackboxRingEndCapture()) {
+                blackboxRingInterval_t *interval = blackboxRingInterval(blackboxRing.intervalCount++);
+
+                interval->start = start;
+                interval->iteration = blackboxIteration;
+                interval->time = currentTime;
+                interval->afterGap = blackboxRing.skipping;
+                interval->triggered = blackboxRing.triggered;
+                blackboxRing.skipping = false;
+            } else {
+                blackboxRing.skipping = true;
+            }
+        }
+    } else if (!blackboxRing.skipping) {
+        blackboxRingBeginCapture();
+        blackboxLogIteration();
+
+        // The frames after this one are predicted from it, so they have to wait for the next "I" frame
+        if (!blackboxRingEndCapture()) {
+            blackboxRing.skipping = true;
+        }
+    }
+
+    blackboxLoggedAnyFrames = loggedAnyFrames;
+
+    if (blackboxRing.triggered) {
+        blackboxRing.sendTo = blackboxRing.head;
+    }
+    blackboxRingSend();
+    blackboxDeviceFlush();
+}
+#endif
+
 /**
  * Call each flight loop iteration to perform blackbox logging.
  */
@@ -1344,10 +2195,31 @@ void handleBlackbox(void)
     if (blackboxState >= BLACKBOX_FIRST_HEADER_SENDING_STATE && blackboxState <= BLACKBOX_LAST_HEADER_SENDING_STATE) {
         blackboxReplenishHeaderBudget();
     }
+#ifdef BLACKBOX_RING_SIZE
+    // The ring is sent at the rate of the header, which the device is known to keep up with
+    if (blackboxRing.open) {
+        blackboxReplenishHeaderBudget();
+    }
+#endif
 
     switch (blackboxState) {
+#ifdef BLACKBOX_HEADER_BUFFER_SIZE
+        case BLACKBOX_STATE_STOPPED:
+            // Keep the header rendered for the next arming, so that it only has to be copied out then
+            if ((int32_t)(millis() - blackboxHeaderCheckAt) >= 0) {
+                blackboxHeaderCheckAt = millis() + BLACKBOX_HEADER_CHECK_INTERVAL_MS;
+
+                if (!blackboxRenderedHeaderIsCurrent()) {
+                    blackboxRenderHeader();
+                }
+            }
+        break;
+#endif
         case BLACKBOX_STATE_PREPARE_LOG_FILE:
             if (blackboxDeviceBeginLog()) {
+#ifdef BLACKBOX_HEADER_BUFFER_SIZE
+                blackboxPrepareRenderedHeader();
+#endif
                 blackboxSetState(BLACKBOX_STATE_SEND_HEADER);
             }
         break;
@@ -1358,7 +2230,25 @@ void handleBlackbox(void)
              * Once the UART has had time to init, transmit the header in chunks so we don't overflow its transmit
              * buffer, overflow the OpenLog's buffer, or keep the main loop busy for too long.
              */
-            if (millis() > xmitState.u.startTime + 100) {
+            if (blackboxConfig()->device != BLACKBOX_DEVICE_SERIAL || millis() > xmitState.u.startTime + 100) {
+#ifdef BLACKBOX_HEADER_BUFFER_SIZE
+                if (blackboxHeaderSendLength) {
+                    // Only a copy is left to do, so send as much as the device takes
+                    const int32_t length = MIN(blackboxHeaderBudget, blackboxHeaderSendLength - (int32_t)xmitState.headerIndex);
+
+                    if (length > 0) {
+                        blackboxWriteBuf(&blackboxBuffer.header[xmitState.headerIndex], length);
+                        blackboxHeaderBudget -= length;
+                        xmitState.headerIndex += length;
+                    }
+
+                    // As after the line by line header, let it drain before the first frame
+                    if ((int32_t)xmitState.headerIndex == blackboxHeaderSendLength && blackboxDeviceFlushForce()) {
+                        blackboxSetState(BLACKBOX_STATE_RUNNING);
+                    }
+                    break;
+                }
+#endif
                 if (blackboxDeviceReserveBufferSpace(BLACKBOX_TARGET_HEADER_BUDGET_PER_ITERATION) == BLACKBOX_RESERVE_SUCCESS) {
                     for (i = 0; i < BLACKBOX_TARGET_HEADER_BUDGET_PER_ITERATION && blackboxHeader[xmitState.headerIndex] != '\0'; i++, xmitState.headerIndex++) {
                         blackboxWrite(blackboxHeader[xmitState.headerIndex]);
@@ -1403,6 +2293,17 @@ void handleBlackbox(void)
             //On entry of this state, xmitState.headerIndex is 0 and xmitState.u.fieldIndex is -1
             if (!sendFieldDefinition('S', 0, blackboxSlowFields, blackboxSlowFields + 1, ARRAY_LENGTH(blackboxSlowFields),
                     NULL, NULL)) {
+                if (blackboxTimingInterval) {
+                    blackboxSetState(BLACKBOX_STATE_SEND_TIMING_HEADER);
+                } else {
+                    blackboxSetState(BLACKBOX_STATE_SEND_SYSINFO);
+                }
+            }
+        break;
+        case BLACKBOX_STATE_SEND_TIMING_HEADER:
+            //On entry of this state, xmitState.headerIndex is 0 and xmitState.u.fieldIndex is -1
+            if (!sendFieldDefinition('T', 0, blackboxTimingFields, blackboxTimingFields + 1,
+                    BLACKBOX_TIMING_LOOP_FIELD_COUNT + BLACKBOX_TIMING_TASK_COUNT * BLACKBOX_TIMING_TASK_FIELD_COUNT, NULL, NULL)) {
                 blackboxSetState(BLACKBOX_STATE_SEND_SYSINFO);
             }
         break;
@@ -1442,6 +2343,12 @@ void handleBlackbox(void)
         break;
         case BLACKBOX_STATE_RUNNING:
             // On entry to this state, blackboxIteration, blackboxPFrameIndex and blackboxIFrameIndex are reset to 0
+#ifdef BLACKBOX_RING_SIZE
+            if (blackboxRing.open) {
+                // The BLACKBOX mode is a trigger rather than a pause
+                blackboxRingLogIteration();
+            } else
+#endif
             if (blackboxModeActivationConditionPresent && !rcModeIsActive(BOXBLACKBOX)) {
                 blackboxSetState(BLACKBOX_STATE_PAUSED);
             } else {
@@ -1452,6 +2359,18 @@ void handleBlackbox(void)
         break;
         case BLACKBOX_STATE_SHUTTING_DOWN:
             //On entry of this state, startTime is set
+#ifdef BLACKBOX_RING_SIZE
+            if (blackboxRing.open) {
+                // Finish sending what was triggered, or the interval being sent, and end the log after it
+                if (!blackboxRingSend() && millis() < xmitState.u.startTime + BLACKBOX_RING_SHUTDOWN_TIMEOUT_MILLIS) {
+                    blackboxDeviceFlush();
+                    break;
+                }
+                blackboxRing.open = false;
+                writeEventFrame(FLIGHT_LOG_EVENT_LOG_END, NULL);
+                xmitState.u.startTime = millis();
+            }
+#endif
 
             /*
              * Wait for the log we've transmitted to make its way to the logger before we release the serial port,
@@ -19,10 +19,30 @@
 
 #include "blackbox/blackbox_fielddefs.h"
 
+typedef enum {
+    BLACKBOX_MODE_CONTINUOUS = 0,
+    BLACKBOX_MODE_TRIGGERED         // Keep the latest frames in RAM and only log them around a trigger
+} blackboxMode_e;
+
+// What makes the triggered mode log the frames it keeps, blackboxConfig_t.triggers is a mask of these
+typedef enum {
+    BLACKBOX_TRIGGER_CRASH       = 1 << 0,  // A gyro axis at the end of its range
+    BLACKBOX_TRIGGER_FAILSAFE    = 1 << 1,
+    BLACKBOX_TRIGGER_MOTOR_LIMIT = 1 << 2,  // The mixer out of motor range for a while
+    BLACKBOX_TRIGGER_SWITCH      = 1 << 3   // The BLACKBOX mode
+} blackboxTrigger_e;
+
+#define BLACKBOX_TRIGGER_ALL (BLACKBOX_TRIGGER_CRASH | BLACKBOX_TRIGGER_FAILSAFE | BLACKBOX_TRIGGER_MOTOR_LIMIT | BLACKBOX_TRIGGER_SWITCH)
+
 typedef struct blackboxConfig_s {
     uint8_t rate_num;
     uint8_t rate_denom;
     uint8_t device;
+    uint8_t timing_rate;        // Hz, 0 to not log timing frames
+    uint8_t mode;               // blackboxMode_e
+    uint8_t triggers;           // blackboxTrigger_e flags
+    uint16_t pre_trigger_ms;    // Frames to log from before a trigger, as far as the RAM holds them
+    uint16_t post_trigger_ms;   // Frames to log after the last trigger
 } blackboxConfig_t;
 
 PG_DECLARE(blackboxConfig_t, blackboxConfig);
@@ -42,6 +42,10 @@ typedef enum FlightLogFieldCondition {
     FLIGHT_LOG_FIELD_CONDITION_NONZERO_PID_D_1,
     FLIGHT_LOG_FIELD_CONDITION_NONZERO_PID_D_2,
 
+    FLIGHT_LOG_FIELD_CONDITION_YAW_FEEDFORWARD,
+
+    FLIGHT_LOG_FIELD_CONDITION_DEBUG,
+
     FLIGHT_LOG_FIELD_CONDITION_NOT_LOGGING_EVERY_FRAME,
 
     FLIGHT_LOG_FIELD_CONDITION_NEVER,
@@ -82,8 +82,46 @@ static struct {
 
 #endif
 
+/*
+ * While a header is being rendered the writes go to this buffer instead of the device. The length keeps counting past
+ * the end of the buffer so that running out of room shows.
+ */
+static uint8_t *blackboxRenderBuffer;
+static int32_t blackboxRenderBufferSize;
+static int32_t blackboxRenderLength;
+
+void blackboxBeginRender(uint8_t *buffer, int32_t size)
+{
+    blackboxRenderBuffer = buffer;
+    blackboxRenderBufferSize = size;
+    blackboxRenderLength = 0;
+}
+
+/**
+ * Go back to writing to the device. Returns the number of bytes rendered, or -1 if they did not fit in the buffer.
+ */
+int32_t blackboxEndRender(void)
+{
+    blackboxRenderBuffer = NULL;
+
+    return blackboxRenderLength <= blackboxRenderBufferSize ? blackboxRenderLength : -1;
+}
+
+static void blackboxRender(const uint8_t *data, int32_t length)
+{
+    if (blackboxRenderLength + length <= blackboxRenderBufferSize) {
+        memcpy(blackboxRenderBuffer + blackboxRenderLength, data, length);
+    }
+    blackboxRenderLength += length;
+}
+
 void blackboxWrite(uint8_t value)
 {
+    if (blackboxRenderBuffer) {
+        blackboxRender(&value, 1);
+        return;
+    }
+
     switch (blackboxConfig()->device) {
 #ifdef USE_FLASHFS
         case BLACKBOX_DEVICE_FLASH:
@@ -150,39 +188,43 @@ void blackboxPrintfHeaderLine(const char *fmt, ...)
     blackboxHeaderBudget -= written + 3;
 }
 
-// Print the null-terminated string 's' to the blackbox device and return the number of bytes written
-int blackboxPrint(const char *s)
+// Write 'length' bytes from 'data' to the blackbox device in one go
+void blackboxWriteBuf(const uint8_t *data, int32_t length)
 {
-    int length;
-    const uint8_t *pos;
+    if (blackboxRenderBuffer) {
+        blackboxRender(data, length);
+        return;
+    }
 
     switch (blackboxConfig()->device) {
 
 #ifdef USE_FLASHFS
         case BLACKBOX_DEVICE_FLASH:
-            length = strlen(s);
-            flashfsWrite((const uint8_t*) s, length, false); // Write asynchronously
+            flashfsWrite(data, length, false); // Write asynchronously
         break;
 #endif
 
 #ifdef USE_SDCARD
         case BLACKBOX_DEVICE_SDCARD:
-            length = strlen(s);
-            afatfs_fwrite(blackboxSDCard.logFile, (const uint8_t*) s, length); // Ignore failures due to buffers filling up
+            afatfs_fwrite(blackboxSDCard.logFile, data, length); // Ignore failures due to buffers filling up
         break;
 #endif
 
         case BLACKBOX_DEVICE_SERIAL:
         default:
-            pos = (uint8_t*) s;
-            while (*pos) {
-                serialWrite(blackboxPort, *pos);
-                pos++;
+            for (int32_t i = 0; i < length; i++) {
+                serialWrite(blackboxPort, data[i]);
             }
-
-            length = pos - (uint8_t*) s;
         break;
     }
+}
+
+// Print the null-terminated string 's' to the blackbox device and return the number of bytes written
+int blackboxPrint(const char *s)
+{
+    const int length = strlen(s);
+
+    blackboxWriteBuf((const uint8_t*) s, length);
 
     return length;
 }
@@ -895,7 +937,8 @@ void blackboxReplenishHeaderBudget()
  */
 blackboxBufferReserveStatus_e blackboxDeviceReserveBufferSpace(int32_t bytes)
 {
-    if (bytes <= blackboxHeaderBudget) {
+    // A rendered header is sent from its buffer later, so there is no device to wait for
+    if (blackboxRenderBuffer || bytes <= blackboxHeaderBudget) {
         return BLACKBOX_RESERVE_SUCCESS;
     }
 
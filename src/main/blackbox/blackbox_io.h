@@ -51,6 +51,10 @@ typedef enum {
 extern int32_t blackboxHeaderBudget;
 
 void blackboxWrite(uint8_t value);
+void blackboxWriteBuf(const uint8_t *data, int32_t length);
+
+void blackboxBeginRender(uint8_t *buffer, int32_t size);
+int32_t blackboxEndRender(void);
 
 int blackboxPrintf(const char *fmt, ...);
 void blackboxPrintfHeaderLine(const char *fmt, ...);
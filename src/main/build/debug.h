@@ -15,6 +15,8 @@
  * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "build/trace.h"
+
 #define DEBUG16_VALUE_COUNT 4
 extern int16_t debug[DEBUG16_VALUE_COUNT];
 extern uint8_t debugMode;
@@ -26,6 +28,7 @@ extern uint32_t sectionTimes[2][4];
 
 #define TIME_SECTION_BEGIN(index) { \
     extern uint32_t sectionTimes[2][4]; \
+    TRACE_BEGIN(TRACE_SECTION_TIME_SECTION, index); \
     sectionTimes[0][index] = micros(); \
 }
 
@@ -33,10 +36,11 @@ extern uint32_t sectionTimes[2][4];
     extern uint32_t sectionTimes[2][4]; \
     sectionTimes[1][index] = micros(); \
     debug[index] = sectionTimes[1][index] - sectionTimes[0][index]; \
+    TRACE_END(TRACE_SECTION_TIME_SECTION, index); \
 }
 #else
 
-#define TIME_SECTION_BEGIN(index) {}
-#define TIME_SECTION_END(index) {}
+#define TIME_SECTION_BEGIN(index) { TRACE_BEGIN(TRACE_SECTION_TIME_SECTION, index); }
+#define TIME_SECTION_END(index) { TRACE_END(TRACE_SECTION_TIME_SECTION, index); }
 
 #endif
@@ -0,0 +1,105 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <platform.h>
+
+#include "build/trace.h"
+
+#include "drivers/system.h"
+
+const char * const traceSectionNames[TRACE_SECTION_COUNT] = {
+    "timeSection",
+    "task",
+    "gyroDataReady",
+    "pidController",
+    "motorUpdate",
+    "subprocesses",
+};
+
+#ifdef USE_TRACE
+
+/*
+ * Events are written from tasks and interrupt handlers. A writer reserves its slot by moving the head on
+ * with a compare and swap, so writers never wait for each other. Recording stops when the buffer is full,
+ * which leaves a gapless capture to read. The buffer must be read from a task, so that no writer is
+ * half way through an event that is read.
+ */
+static traceEvent_t traceBuffer[TRACE_BUFFER_SIZE];
+static volatile uint32_t traceHead;     // slots reserved by writers
+static volatile uint32_t traceTail;     // the next event to read
+static volatile bool traceRecording;
+
+void traceRecord(uint8_t section, uint8_t flags)
+{
+    if (!traceRecording) {
+        return;
+    }
+
+    const uint32_t timeUs = micros();
+
+    uint32_t head;
+    do {
+        head = traceHead;
+        if (head - traceTail >= TRACE_BUFFER_SIZE) {
+            traceRecording = false;
+            return;
+        }
+    } while (!__sync_bool_compare_and_swap(&traceHead, head, head + 1));
+
+    traceEvent_t *event = &traceBuffer[head % TRACE_BUFFER_SIZE];
+    event->timeUs = timeUs;
+    event->section = section;
+    event->flags = flags;
+}
+
+// Discards the events not read yet and records from now on.
+void traceStart(void)
+{
+    traceRecording = false;
+    traceTail = traceHead;
+    traceRecording = true;
+}
+
+void traceStop(void)
+{
+    traceRecording = false;
+}
+
+bool traceIsRecording(void)
+{
+    return traceRecording;
+}
+
+uint16_t traceEventsWaiting(void)
+{
+    return traceHead - traceTail;
+}
+
+uint16_t traceRead(traceEvent_t *events, uint16_t maxCount)
+{
+    uint16_t count = 0;
+    while (count < maxCount && traceTail != traceHead) {
+        events[count++] = traceBuffer[traceTail % TRACE_BUFFER_SIZE];
+        traceTail++;
+    }
+    return count;
+}
+
+#endif
@@ -0,0 +1,66 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Section names are in traceSectionNames[], in the same order.
+typedef enum {
+    TRACE_SECTION_TIME_SECTION = 0,     // TIME_SECTION_BEGIN/END, the argument is the index
+    TRACE_SECTION_TASK,                 // scheduler tasks, the argument is the task id
+    TRACE_SECTION_GYRO_DATA_READY,
+    TRACE_SECTION_PID_CONTROLLER,
+    TRACE_SECTION_MOTOR_UPDATE,
+    TRACE_SECTION_SUBPROCESSES,
+    TRACE_SECTION_COUNT
+} traceSectionId_e;
+
+#define TRACE_EVENT_BEGIN       0x00
+#define TRACE_EVENT_END         0x40
+#define TRACE_EVENT_INSTANT     0x80
+#define TRACE_EVENT_TYPE_MASK   0xC0
+#define TRACE_EVENT_ARG_MASK    0x3F
+
+typedef struct traceEvent_s {
+    uint32_t timeUs;
+    uint8_t section;
+    uint8_t flags;                      // the event type and the argument
+} traceEvent_t;
+
+#define TRACE_BUFFER_SIZE 512           // events, a power of two
+
+#ifdef USE_TRACE
+#define TRACE_BEGIN(section, arg) traceRecord((section), TRACE_EVENT_BEGIN | ((arg) & TRACE_EVENT_ARG_MASK))
+#define TRACE_END(section, arg) traceRecord((section), TRACE_EVENT_END | ((arg) & TRACE_EVENT_ARG_MASK))
+#define TRACE_INSTANT(section, arg) traceRecord((section), TRACE_EVENT_INSTANT | ((arg) & TRACE_EVENT_ARG_MASK))
+#else
+#define TRACE_BEGIN(section, arg) do {} while (0)
+#define TRACE_END(section, arg) do {} while (0)
+#define TRACE_INSTANT(section, arg) do {} while (0)
+#endif
+
+extern const char * const traceSectionNames[TRACE_SECTION_COUNT];
+
+void traceRecord(uint8_t section, uint8_t flags);
+
+void traceStart(void);
+void traceStop(void);
+bool traceIsRecording(void);
+uint16_t traceEventsWaiting(void);
+uint16_t traceRead(traceEvent_t *events, uint16_t maxCount);
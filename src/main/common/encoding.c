@@ -35,6 +35,21 @@ uint32_t castFloatBytesToInt(float f)
     return floatConvert.u;
 }
 
+/**
+ * The inverse of castFloatBytesToInt(), for reading back the floats the blackbox logs.
+ */
+float castIntBytesToFloat(uint32_t u)
+{
+    union floatConvert_t {
+        float f;
+        uint32_t u;
+    } floatConvert;
+
+    floatConvert.u = u;
+
+    return floatConvert.f;
+}
+
 /**
  * ZigZag encoding maps all values of a signed integer into those of an unsigned integer in such
  * a way that numbers of small absolute value correspond to small integers in the result.
@@ -46,3 +61,11 @@ uint32_t zigzagEncode(int32_t value)
 {
     return (uint32_t)((value << 1) ^ (value >> 31));
 }
+
+/**
+ * The inverse of zigzagEncode().
+ */
+int32_t zigzagDecode(uint32_t value)
+{
+    return (int32_t)((value >> 1) ^ -(int32_t)(value & 1));
+}
@@ -20,4 +20,6 @@
 #include <stdint.h>
 
 uint32_t castFloatBytesToInt(float f);
+float castIntBytesToFloat(uint32_t u);
 uint32_t zigzagEncode(int32_t value);
+int32_t zigzagDecode(uint32_t value);
@@ -0,0 +1,179 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "fixedpoint.h"
+
+#define CORDIC_ITERATIONS 24
+
+// atan(2^-i) as binary angles
+static const fixAngle_t cordicAtanTable[CORDIC_ITERATIONS] = {
+    536870912, 316933406, 167458907, 85004756, 42667331, 21354465, 10679838, 5340245,
+    2670163,   1335087,   667544,    333772,   166886,   83443,    41722,    20861,
+    10430,     5215,      2608,      1304,     652,      326,      163,      81
+};
+
+// 1 / prod(sqrt(1 + 2^-2i)), the inverse CORDIC gain in Q30
+#define CORDIC_INV_GAIN 652032874
+
+// CORDIC works on values in [2^28, 2^29) so the gain of 1.647 plus the sqrt(2) of the vector
+// magnitude can not overflow an int32
+#define CORDIC_INPUT_BITS 29
+
+static int cordicNormalizeShift(uint32_t magnitude)
+{
+    if (magnitude == 0) {
+        return 0;
+    }
+    return (32 - CORDIC_INPUT_BITS) - __builtin_clz(magnitude);
+}
+
+// 1/sqrt(x) at the centre of each 0.25 wide interval in [1.0, 4.0), Q30
+static const uint32_t invSqrtSeedTable[12] = {
+    1012333500, 915690104, 842312387, 784150157, 736580814, 696735698,
+    662727842,  633258380, 607400100, 584471019, 563956835, 545461392
+};
+
+// Q30 inverse square root of m, where m is a Q30 value in [1.0, 4.0)
+static uint32_t fixInvSqrtNormalized(uint32_t m)
+{
+    // table seed is within 6% of the result
+    int64_t y = invSqrtSeedTable[(m >> 28) - 4];
+
+    // Newton-Raphson: y = y * (3 - m * y^2) / 2, the relative error is squared on each iteration
+    for (int i = 0; i < 3; i++) {
+        int64_t my2 = (((y * y) >> 30) * m) >> 30;
+        y = (y * ((3LL << 30) - my2)) >> 31;
+    }
+    return (uint32_t)y;
+}
+
+/*
+ * Scales the integer vector src to unit length and stores it in dest in Q30.
+ * The input can be in any integer scale (raw sensor counts or Q30).
+ * Returns false and leaves dest untouched if the vector has zero length.
+ */
+bool fixNormalize(const int32_t *src, fix30_t *dest, int count)
+{
+    uint64_t sumSq = 0;
+    for (int i = 0; i < count; i++) {
+        sumSq += (uint64_t)((int64_t)src[i] * src[i]);
+    }
+    if (sumSq == 0) {
+        return false;
+    }
+
+    // bring sumSq into [2^30, 2^32) with an even shift so the square root of the shift is exact
+    int lz = (sumSq >> 32) ? __builtin_clz((uint32_t)(sumSq >> 32)) : 32 + __builtin_clz((uint32_t)sumSq);
+    int shift = 32 - lz;    // positive: shift right, negative: shift left
+    shift += shift & 1;
+    uint32_t m = shift >= 0 ? (uint32_t)(sumSq >> shift) : (uint32_t)(sumSq << -shift);
+
+    uint32_t invSqrt = fixInvSqrtNormalized(m);
+
+    // 1/sqrt(sumSq) = invSqrt * 2^-((shift + 30) / 2), shifted into Q30
+    int outShift = (shift + 30) / 2;
+    for (int i = 0; i < count; i++) {
+        int64_t v = (int64_t)src[i] * invSqrt;
+        dest[i] = (fix30_t)(outShift >= 0 ? v >> outShift : v << -outShift);
+    }
+    return true;
+}
+
+/*
+ * CORDIC vectoring mode atan2.
+ * Returns the angle of the vector (x, y) and, if magnitude is not NULL, its length in the units of x and y.
+ */
+fixAngle_t fixAtan2(int32_t y, int32_t x, int32_t *magnitude)
+{
+    // accumulated unsigned so that wrapping past 180 degrees is well defined
+    uint32_t angle = 0;
+
+    if (x == 0 && y == 0) {
+        if (magnitude) {
+            *magnitude = 0;
+        }
+        return 0;
+    }
+
+    // rotate into the right half plane, the CORDIC only converges for |angle| < 99 degrees
+    if (x < 0) {
+        x = -x;
+        y = -y;
+        angle = 0x80000000U;    // 180 degrees
+    }
+
+    uint32_t absY = y < 0 ? -(uint32_t)y : (uint32_t)y;
+    int shift = cordicNormalizeShift((uint32_t)x | absY);
+    if (shift > 0) {
+        x >>= shift;
+        y >>= shift;
+    } else {
+        x <<= -shift;
+        y <<= -shift;
+    }
+
+    for (int i = 0; i < CORDIC_ITERATIONS; i++) {
+        int32_t xi = x >> i;
+        int32_t yi = y >> i;
+        if (y > 0) {
+            x += yi;
+            y -= xi;
+            angle += cordicAtanTable[i];
+        } else {
+            x -= yi;
+            y += xi;
+            angle -= cordicAtanTable[i];
+        }
+    }
+
+    if (magnitude) {
+        int64_t mag = ((int64_t)x * CORDIC_INV_GAIN) >> 30;
+        *magnitude = (int32_t)(shift > 0 ? mag << shift : mag >> -shift);
+    }
+    return (fixAngle_t)angle;
+}
+
+// CORDIC rotation mode sine, returns Q30
+fix30_t fixSin(fixAngle_t angle)
+{
+    // sin(a) == sin(180 - a), folds the angle into [-90, 90] degrees
+    if (angle > FIX_ANGLE_90_DEG || angle < -FIX_ANGLE_90_DEG) {
+        angle = (fixAngle_t)(0x80000000U - (uint32_t)angle);
+    }
+
+    // start with a pre-scaled unit vector so the CORDIC gain cancels out
+    int32_t x = CORDIC_INV_GAIN >> 2;
+    int32_t y = 0;
+
+    for (int i = 0; i < CORDIC_ITERATIONS; i++) {
+        int32_t xi = x >> i;
+        int32_t yi = y >> i;
+        if (angle > 0) {
+            x -= yi;
+            y += xi;
+            angle -= cordicAtanTable[i];
+        } else {
+            x += yi;
+            y -= xi;
+            angle += cordicAtanTable[i];
+        }
+    }
+    return y << 2;
+}
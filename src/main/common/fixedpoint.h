@@ -0,0 +1,55 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Q-format integer maths for targets without an FPU.
+//
+// fix30_t holds values in the range [-2.0, 2.0) with 30 fractional bits, suitable for unit vectors,
+// quaternions and rotation matrix elements.
+// fixAngle_t is a binary angle where the full int32 range maps to one revolution, so that angle
+// wrapping is free: 0x40000000 == 90 degrees, INT32_MIN == -180 degrees.
+
+typedef int32_t fix30_t;
+typedef int32_t fixAngle_t;
+
+#define FIX30_ONE           (1L << 30)
+#define FIX30_FROM_FLOAT(x) ((fix30_t)((x) * (float)FIX30_ONE))
+#define FIX30_TO_FLOAT(x)   ((float)(x) * (1.0f / FIX30_ONE))
+
+#define FIX_ANGLE_90_DEG    ((fixAngle_t)0x40000000)
+
+static inline fix30_t fixMul30(fix30_t a, fix30_t b)
+{
+    return (fix30_t)(((int64_t)a * b + (1L << 29)) >> 30);
+}
+
+// converts a binary angle to decidegrees, rounded to nearest
+static inline int32_t fixAngleToDecidegrees(fixAngle_t angle)
+{
+    return (int32_t)(((int64_t)angle * 3600 + (1LL << 31)) >> 32);
+}
+
+static inline fixAngle_t fixAngleFromDecidegrees(int32_t decidegrees)
+{
+    // 2^32 / 3600 = 1193046.47
+    return (fixAngle_t)(((int64_t)decidegrees * 4886718345LL + (1 << 11)) >> 12);
+}
+
+bool fixNormalize(const int32_t *src, fix30_t *dest, int count);
+fixAngle_t fixAtan2(int32_t y, int32_t x, int32_t *magnitude);
+fix30_t fixSin(fixAngle_t angle);
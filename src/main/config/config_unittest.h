@@ -50,6 +50,7 @@ float unittest_pidLuxFloatCore_lastRateForDelta[3];
 float unittest_pidLuxFloatCore_PTerm[3];
 float unittest_pidLuxFloatCore_ITerm[3];
 float unittest_pidLuxFloatCore_DTerm[3];
+float unittest_pidLuxFloatCore_FTerm[3];
 
 #define SET_PID_LUX_FLOAT_CORE_LOCALS(axis) \
     { \
@@ -62,6 +63,7 @@ float unittest_pidLuxFloatCore_DTerm[3];
         unittest_pidLuxFloatCore_PTerm[axis] = PTerm; \
         unittest_pidLuxFloatCore_ITerm[axis] = ITerm; \
         unittest_pidLuxFloatCore_DTerm[axis] = DTerm; \
+        unittest_pidLuxFloatCore_FTerm[axis] = FTerm; \
     }
 
 #else
@@ -197,6 +197,7 @@ void mpuIntExtiHandler(extiCallbackRec_t *cb)
     }
 
     counter = 0;
+    TRACE_INSTANT(TRACE_SECTION_GYRO_DATA_READY, 0);
     gyroSyncIntHandler();
 }
 
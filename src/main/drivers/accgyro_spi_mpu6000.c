@@ -24,6 +24,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 #include <stdlib.h>
 
 #include <platform.h>
@@ -97,26 +98,41 @@ extern uint8_t mpuIntDenominator;
 #define MPU6000_REV_D9 0x59
 #define MPU6000_REV_D10 0x5A
 
-#define DISABLE_MPU6000       GPIO_SetBits(MPU6000_CS_GPIO,   MPU6000_CS_PIN)
-#define ENABLE_MPU6000        GPIO_ResetBits(MPU6000_CS_GPIO, MPU6000_CS_PIN)
+#define MPU6000_MAX_READ_LENGTH 14   // accelerometer, temperature and gyro
 
+static const spiDevice_t mpu6000SpiDevice = { MPU6000_SPI_INSTANCE, MPU6000_CS_GPIO, MPU6000_CS_PIN };
+
+// Register access goes through the bus queue ahead of any flash or SD card transfer waiting on a shared bus.
+static bool mpu6000Transfer(uint8_t *rxBuf, const uint8_t *txBuf, uint8_t len)
+{
+    spiTransaction_t transaction = {
+        .device = &mpu6000SpiDevice,
+        .txBuf = txBuf,
+        .rxBuf = rxBuf,
+        .len = len,
+        .priority = SPI_PRIORITY_SENSOR,
+    };
+    return spiTransactionBlocking(&transaction);
+}
 
 bool mpu6000WriteRegister(uint8_t reg, uint8_t data)
 {
-    ENABLE_MPU6000;
-    spiTransferByte(MPU6000_SPI_INSTANCE, reg);
-    spiTransferByte(MPU6000_SPI_INSTANCE, data);
-    DISABLE_MPU6000;
+    const uint8_t frame[2] = { reg, data };
 
-    return true;
+    return mpu6000Transfer(NULL, frame, sizeof(frame));
 }
 
 bool mpu6000ReadRegister(uint8_t reg, uint8_t length, uint8_t *data)
 {
-    ENABLE_MPU6000;
-    spiTransferByte(MPU6000_SPI_INSTANCE, reg | 0x80); // read transaction
-    spiTransfer(MPU6000_SPI_INSTANCE, data, NULL, length);
-    DISABLE_MPU6000;
+    uint8_t frame[MPU6000_MAX_READ_LENGTH + 1] = { reg | 0x80 }; // read transaction
+
+    if (length > MPU6000_MAX_READ_LENGTH) {
+        return false;
+    }
+    if (!mpu6000Transfer(frame, frame, length + 1)) {
+        return false;
+    }
+    memcpy(data, &frame[1], length);
 
     return true;
 }
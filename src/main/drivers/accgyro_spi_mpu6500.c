@@ -17,6 +17,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 #include <stdlib.h>
 
 #include <platform.h>
@@ -35,25 +36,41 @@
 #include "accgyro_mpu6500.h"
 #include "accgyro_spi_mpu6500.h"
 
-#define DISABLE_MPU6500       GPIO_SetBits(MPU6500_CS_GPIO,   MPU6500_CS_PIN)
-#define ENABLE_MPU6500        GPIO_ResetBits(MPU6500_CS_GPIO, MPU6500_CS_PIN)
+#define MPU6500_MAX_READ_LENGTH 14   // accelerometer, temperature and gyro
+
+static const spiDevice_t mpu6500SpiDevice = { MPU6500_SPI_INSTANCE, MPU6500_CS_GPIO, MPU6500_CS_PIN };
+
+// Register access goes through the bus queue ahead of any flash or SD card transfer waiting on a shared bus.
+static bool mpu6500Transfer(uint8_t *rxBuf, const uint8_t *txBuf, uint8_t len)
+{
+    spiTransaction_t transaction = {
+        .device = &mpu6500SpiDevice,
+        .txBuf = txBuf,
+        .rxBuf = rxBuf,
+        .len = len,
+        .priority = SPI_PRIORITY_SENSOR,
+    };
+    return spiTransactionBlocking(&transaction);
+}
 
 bool mpu6500WriteRegister(uint8_t reg, uint8_t data)
 {
-    ENABLE_MPU6500;
-    spiTransferByte(MPU6500_SPI_INSTANCE, reg);
-    spiTransferByte(MPU6500_SPI_INSTANCE, data);
-    DISABLE_MPU6500;
+    const uint8_t frame[2] = { reg, data };
 
-    return true;
+    return mpu6500Transfer(NULL, frame, sizeof(frame));
 }
 
 bool mpu6500ReadRegister(uint8_t reg, uint8_t length, uint8_t *data)
 {
-    ENABLE_MPU6500;
-    spiTransferByte(MPU6500_SPI_INSTANCE, reg | 0x80); // read transaction
-    spiTransfer(MPU6500_SPI_INSTANCE, data, NULL, length);
-    DISABLE_MPU6500;
+    uint8_t frame[MPU6500_MAX_READ_LENGTH + 1] = { reg | 0x80 }; // read transaction
+
+    if (length > MPU6500_MAX_READ_LENGTH) {
+        return false;
+    }
+    if (!mpu6500Transfer(frame, frame, length + 1)) {
+        return false;
+    }
+    memcpy(data, &frame[1], length);
 
     return true;
 }
@@ -31,34 +31,43 @@
 
 #ifdef USE_ADC
 adc_config_t adcConfig[ADC_CHANNEL_COUNT];
-volatile uint16_t adcValues[ADC_CHANNEL_COUNT];
+volatile uint16_t adcValues[ADC_CHANNEL_COUNT * ADC_OVERSAMPLE_COUNT];  // ADC_OVERSAMPLE_COUNT conversion sequences
+uint8_t adcSequenceLength;                                              // enabled channels per sequence
 
+static uint16_t adcGetOversampledValue(uint8_t dmaIndex)
+{
+    uint32_t sum = 0;
+    for (int i = 0; i < ADC_OVERSAMPLE_COUNT; i++) {
+        sum += adcValues[i * adcSequenceLength + dmaIndex];
+    }
+    return (sum + ADC_OVERSAMPLE_COUNT / 2) / ADC_OVERSAMPLE_COUNT;
+}
 
 uint16_t adcGetChannel(uint8_t channel)
 {
 #ifdef DEBUG_ADC_CHANNELS
 #if ADC_CHANNEL_COUNT > 0
     if (adcConfig[0].enabled) {
-        debug[0] = adcValues[adcConfig[0].dmaIndex];
+        debug[0] = adcGetOversampledValue(adcConfig[0].dmaIndex);
     }
 #endif
 #if ADC_CHANNEL_COUNT > 1
     if (adcConfig[1].enabled) {
-        debug[1] = adcValues[adcConfig[1].dmaIndex];
+        debug[1] = adcGetOversampledValue(adcConfig[1].dmaIndex);
     }
 #endif
 #if ADC_CHANNEL_COUNT > 2
     if (adcConfig[2].enabled) {
-        debug[2] = adcValues[adcConfig[2].dmaIndex];
+        debug[2] = adcGetOversampledValue(adcConfig[2].dmaIndex);
     }
 #endif
 #if ADC_CHANNEL_COUNT > 3
     if (adcConfig[3].enabled) {
-        debug[3] = adcValues[adcConfig[3].dmaIndex];
+        debug[3] = adcGetOversampledValue(adcConfig[3].dmaIndex);
     }
 #endif
 #endif // DEBUG_ADC_CHANNELS
-    return adcValues[adcConfig[channel].dmaIndex];
+    return adcGetOversampledValue(adcConfig[channel].dmaIndex);
 }
 
 #else
@@ -45,6 +45,12 @@ typedef enum {
 
 #define ADC_CHANNEL_MASK(adcChannel) (1 << adcChannel)
 
+// The ADC converts continuously and the DMA keeps the last ADC_OVERSAMPLE_COUNT conversions of every channel.
+// Reads return their average, a window of about 0.9ms on F1 with four channels and 1.6ms on F3 with six.
+#ifndef ADC_OVERSAMPLE_COUNT
+#define ADC_OVERSAMPLE_COUNT 8
+#endif
+
 typedef struct adc_config_s {
     uint8_t adcChannel;         // ADC1_INxx channel number
     uint8_t dmaIndex;           // index into DMA buffer in case of sparse channels
@@ -18,4 +18,5 @@
 #pragma once
 
 extern adc_config_t adcConfig[ADC_CHANNEL_COUNT];
-extern volatile uint16_t adcValues[ADC_CHANNEL_COUNT];
+extern volatile uint16_t adcValues[ADC_CHANNEL_COUNT * ADC_OVERSAMPLE_COUNT];
+extern uint8_t adcSequenceLength;
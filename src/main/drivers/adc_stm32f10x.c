@@ -106,6 +106,8 @@ void adcInit(drv_adc_config_t *init)
     }
 #endif
 
+    adcSequenceLength = configuredAdcChannels;
+
     RCC_ADCCLKConfig(RCC_PCLK2_Div8);  // 9MHz from 72MHz APB2 clock(HSE), 8MHz from 64MHz (HSI)
     RCC_AHBPeriphClockCmd(ADC_AHB_PERIPHERAL, ENABLE);
     RCC_APB2PeriphClockCmd(ADC_ABP2_PERIPHERAL, ENABLE);
@@ -118,9 +120,9 @@ void adcInit(drv_adc_config_t *init)
     DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&ADC_INSTANCE->DR;
     DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)adcValues;
     DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
-    DMA_InitStructure.DMA_BufferSize = configuredAdcChannels;
+    DMA_InitStructure.DMA_BufferSize = configuredAdcChannels * ADC_OVERSAMPLE_COUNT;
     DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
-    DMA_InitStructure.DMA_MemoryInc = configuredAdcChannels > 1 ? DMA_MemoryInc_Enable : DMA_MemoryInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
     DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_HalfWord;
     DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_HalfWord;
     DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
@@ -32,6 +32,10 @@
 
 #ifdef USE_ADC
 
+// The ADC runs from the AHB clock divided by 4, 18 MHz, so a conversion takes (601.5 + 12.5) cycles, about 34us.
+// The ADC_OVERSAMPLE_COUNT sequences averaged span about 1.6ms with all six channels enabled.
+#define ADC_SAMPLE_TIME ADC_SampleTime_601Cycles5
+
 void adcInit(drv_adc_config_t *init)
 {
     ADC_InitTypeDef ADC_InitStructure;
@@ -54,7 +58,7 @@ void adcInit(drv_adc_config_t *init)
 
         adcConfig[ADC_CHANNEL0].adcChannel = ADC0_CHANNEL;
         adcConfig[ADC_CHANNEL0].dmaIndex = adcChannelCount;
-        adcConfig[ADC_CHANNEL0].sampleTime = ADC_SampleTime_601Cycles5;
+        adcConfig[ADC_CHANNEL0].sampleTime = ADC_SAMPLE_TIME;
         adcConfig[ADC_CHANNEL0].enabled = true;
         adcChannelCount++;
     }
@@ -67,7 +71,7 @@ void adcInit(drv_adc_config_t *init)
 
         adcConfig[ADC_CHANNEL1].adcChannel = ADC1_CHANNEL;
         adcConfig[ADC_CHANNEL1].dmaIndex = adcChannelCount;
-        adcConfig[ADC_CHANNEL1].sampleTime = ADC_SampleTime_601Cycles5;
+        adcConfig[ADC_CHANNEL1].sampleTime = ADC_SAMPLE_TIME;
         adcConfig[ADC_CHANNEL1].enabled = true;
         adcChannelCount++;
     }
@@ -80,7 +84,7 @@ void adcInit(drv_adc_config_t *init)
 
         adcConfig[ADC_CHANNEL2].adcChannel = ADC2_CHANNEL;
         adcConfig[ADC_CHANNEL2].dmaIndex = adcChannelCount;
-        adcConfig[ADC_CHANNEL2].sampleTime = ADC_SampleTime_601Cycles5;
+        adcConfig[ADC_CHANNEL2].sampleTime = ADC_SAMPLE_TIME;
         adcConfig[ADC_CHANNEL2].enabled = true;
         adcChannelCount++;
     }
@@ -93,7 +97,7 @@ void adcInit(drv_adc_config_t *init)
 
         adcConfig[ADC_CHANNEL3].adcChannel = ADC3_CHANNEL;
         adcConfig[ADC_CHANNEL3].dmaIndex = adcChannelCount;
-        adcConfig[ADC_CHANNEL3].sampleTime = ADC_SampleTime_601Cycles5;
+        adcConfig[ADC_CHANNEL3].sampleTime = ADC_SAMPLE_TIME;
         adcConfig[ADC_CHANNEL3].enabled = true;
         adcChannelCount++;
     }
@@ -106,7 +110,7 @@ void adcInit(drv_adc_config_t *init)
 
         adcConfig[ADC_CHANNEL4].adcChannel = ADC4_CHANNEL;
         adcConfig[ADC_CHANNEL4].dmaIndex = adcChannelCount;
-        adcConfig[ADC_CHANNEL4].sampleTime = ADC_SampleTime_601Cycles5;
+        adcConfig[ADC_CHANNEL4].sampleTime = ADC_SAMPLE_TIME;
         adcConfig[ADC_CHANNEL4].enabled = true;
         adcChannelCount++;
     }
@@ -119,13 +123,15 @@ void adcInit(drv_adc_config_t *init)
 
         adcConfig[ADC_CHANNEL5].adcChannel = ADC5_CHANNEL;
         adcConfig[ADC_CHANNEL5].dmaIndex = adcChannelCount;
-        adcConfig[ADC_CHANNEL5].sampleTime = ADC_SampleTime_601Cycles5;
+        adcConfig[ADC_CHANNEL5].sampleTime = ADC_SAMPLE_TIME;
         adcConfig[ADC_CHANNEL5].enabled = true;
         adcChannelCount++;
     }
 #endif
 
-    RCC_ADCCLKConfig(RCC_ADC12PLLCLK_Div256);  // 72 MHz divided by 256 = 281.25 kHz
+    adcSequenceLength = adcChannelCount;
+
+    RCC_ADCCLKConfig(RCC_ADC12PLLCLK_Div256);  // asynchronous clock, unused in the synchronous mode set below
     RCC_AHBPeriphClockCmd(ADC_AHB_PERIPHERAL | RCC_AHBPeriph_ADC12, ENABLE);
 
     DMA_DeInit(ADC_DMA_CHANNEL);
@@ -134,9 +140,9 @@ void adcInit(drv_adc_config_t *init)
     DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&ADC_INSTANCE->DR;
     DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)adcValues;
     DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
-    DMA_InitStructure.DMA_BufferSize = adcChannelCount;
+    DMA_InitStructure.DMA_BufferSize = adcChannelCount * ADC_OVERSAMPLE_COUNT;
     DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
-    DMA_InitStructure.DMA_MemoryInc = adcChannelCount > 1 ? DMA_MemoryInc_Enable : DMA_MemoryInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
     DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_HalfWord;
     DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_HalfWord;
     DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
@@ -162,7 +168,7 @@ void adcInit(drv_adc_config_t *init)
 
     ADC_CommonStructInit(&ADC_CommonInitStructure);
     ADC_CommonInitStructure.ADC_Mode = ADC_Mode_Independent;
-    ADC_CommonInitStructure.ADC_Clock = ADC_Clock_SynClkModeDiv4;
+    ADC_CommonInitStructure.ADC_Clock = ADC_Clock_SynClkModeDiv4;  // AHB divided by 4, 18 MHz
     ADC_CommonInitStructure.ADC_DMAAccessMode = ADC_DMAAccessMode_1;
     ADC_CommonInitStructure.ADC_DMAMode = ADC_DMAMode_Circular;
     ADC_CommonInitStructure.ADC_TwoSamplingDelay = 0;
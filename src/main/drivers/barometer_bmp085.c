@@ -117,6 +117,10 @@ static bool bmp085InitDone = false;
 STATIC_UNIT_TESTED uint16_t bmp085_ut;  // static result of temperature measurement
 STATIC_UNIT_TESTED uint32_t bmp085_up;  // static result of pressure measurement
 
+static i2cJob_t bmp085CommandJob;
+static i2cJob_t bmp085ReadJob;
+static uint8_t bmp085AdcBuf[3];
+
 static void bmp085_get_cal_param(void);
 static void bmp085_start_ut(void);
 static void bmp085_get_ut(void);
@@ -280,13 +284,18 @@ static void bmp085_start_ut(void)
 #if defined(BARO_EOC_GPIO)
     isConversionComplete = false;
 #endif
-    i2cWrite(BMP085_I2C_ADDR, BMP085_CTRL_MEAS_REG, BMP085_T_MEASURE);
+    i2cQueueWrite(&bmp085CommandJob, BMP085_I2C_ADDR, BMP085_CTRL_MEAS_REG, BMP085_T_MEASURE);
 }
 
-static void bmp085_get_ut(void)
+static void bmp085_ut_read(i2cJob_t *job)
 {
-    uint8_t data[2];
+    if (job->state == I2C_JOB_DONE) {
+        bmp085_ut = (job->buf[0] << 8) | job->buf[1];
+    }
+}
 
+static void bmp085_get_ut(void)
+{
 #if defined(BARO_EOC_GPIO)
     // return old baro value if conversion time exceeds datasheet max when EOC is connected
     if ((isEOCConnected) && (!isConversionComplete)) {
@@ -294,8 +303,7 @@ static void bmp085_get_ut(void)
     }
 #endif
 
-    i2cRead(BMP085_I2C_ADDR, BMP085_ADC_OUT_MSB_REG, 2, data);
-    bmp085_ut = (data[0] << 8) | data[1];
+    i2cQueueRead(&bmp085ReadJob, BMP085_I2C_ADDR, BMP085_ADC_OUT_MSB_REG, 2, bmp085AdcBuf, bmp085_ut_read);
 }
 
 static void bmp085_start_up(void)
@@ -308,7 +316,17 @@ static void bmp085_start_up(void)
     isConversionComplete = false;
 #endif
 
-    i2cWrite(BMP085_I2C_ADDR, BMP085_CTRL_MEAS_REG, ctrl_reg_data);
+    i2cQueueWrite(&bmp085CommandJob, BMP085_I2C_ADDR, BMP085_CTRL_MEAS_REG, ctrl_reg_data);
+}
+
+static void bmp085_up_read(i2cJob_t *job)
+{
+    const uint8_t *data = job->buf;
+
+    if (job->state == I2C_JOB_DONE) {
+        bmp085_up = (((uint32_t) data[0] << 16) | ((uint32_t) data[1] << 8) | (uint32_t) data[2])
+                >> (8 - bmp085.oversampling_setting);
+    }
 }
 
 /** read out up for pressure conversion
@@ -317,8 +335,6 @@ static void bmp085_start_up(void)
  */
 static void bmp085_get_up(void)
 {
-    uint8_t data[3];
-
 #if defined(BARO_EOC_GPIO)
     // return old baro value if conversion time exceeds datasheet max when EOC is connected
     if ((isEOCConnected) && (!isConversionComplete)) {
@@ -326,9 +342,7 @@ static void bmp085_get_up(void)
     }
 #endif
 
-    i2cRead(BMP085_I2C_ADDR, BMP085_ADC_OUT_MSB_REG, 3, data);
-    bmp085_up = (((uint32_t) data[0] << 16) | ((uint32_t) data[1] << 8) | (uint32_t) data[2])
-            >> (8 - bmp085.oversampling_setting);
+    i2cQueueRead(&bmp085ReadJob, BMP085_I2C_ADDR, BMP085_ADC_OUT_MSB_REG, 3, bmp085AdcBuf, bmp085_up_read);
 }
 
 STATIC_UNIT_TESTED void bmp085_calculate(int32_t *pressure, int32_t *temperature)
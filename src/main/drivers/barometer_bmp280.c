@@ -95,6 +95,10 @@ STATIC_UNIT_TESTED bmp280_calib_param_t bmp280_cal;
 STATIC_UNIT_TESTED int32_t bmp280_up = 0;
 STATIC_UNIT_TESTED int32_t bmp280_ut = 0;
 
+static i2cJob_t bmp280CommandJob;
+static i2cJob_t bmp280ReadJob;
+static uint8_t bmp280DataBuf[BMP280_DATA_FRAME_SIZE];
+
 static void bmp280_start_ut(void);
 static void bmp280_get_ut(void);
 static void bmp280_start_up(void);
@@ -147,19 +151,26 @@ static void bmp280_start_up(void)
 {
     // start measurement
     // set oversampling + power mode (forced), and start sampling
-    i2cWrite(BMP280_I2C_ADDR, BMP280_CTRL_MEAS_REG, BMP280_MODE);
+    i2cQueueWrite(&bmp280CommandJob, BMP280_I2C_ADDR, BMP280_CTRL_MEAS_REG, BMP280_MODE);
 }
 
-static void bmp280_get_up(void)
+static void bmp280_data_read(i2cJob_t *job)
 {
-    uint8_t data[BMP280_DATA_FRAME_SIZE];
+    const uint8_t *data = job->buf;
 
-    // read data from sensor
-    i2cRead(BMP280_I2C_ADDR, BMP280_PRESSURE_MSB_REG, BMP280_DATA_FRAME_SIZE, data);
+    if (job->state != I2C_JOB_DONE) {
+        return;
+    }
     bmp280_up = (int32_t)((((uint32_t)(data[0])) << 12) | (((uint32_t)(data[1])) << 4) | ((uint32_t)data[2] >> 4));
     bmp280_ut = (int32_t)((((uint32_t)(data[3])) << 12) | (((uint32_t)(data[4])) << 4) | ((uint32_t)data[5] >> 4));
 }
 
+static void bmp280_get_up(void)
+{
+    // read data from sensor
+    i2cQueueRead(&bmp280ReadJob, BMP280_I2C_ADDR, BMP280_PRESSURE_MSB_REG, BMP280_DATA_FRAME_SIZE, bmp280DataBuf, bmp280_data_read);
+}
+
 // Returns temperature in DegC, resolution is 0.01 DegC. Output value of "5123" equals 51.23 DegC
 // t_fine carries fine temperature as global value
 static int32_t bmp280_compensate_T(int32_t adc_T)
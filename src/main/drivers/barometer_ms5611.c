@@ -47,7 +47,6 @@
 static void ms5611_reset(void);
 static uint16_t ms5611_prom(int8_t coef_num);
 STATIC_UNIT_TESTED int8_t ms5611_crc(uint16_t *prom);
-static uint32_t ms5611_read_adc(void);
 static void ms5611_start_ut(void);
 static void ms5611_get_ut(void);
 static void ms5611_start_up(void);
@@ -59,6 +58,11 @@ STATIC_UNIT_TESTED uint32_t ms5611_up;  // static result of pressure measurement
 STATIC_UNIT_TESTED uint16_t ms5611_c[PROM_NB];  // on-chip ROM
 static uint8_t ms5611_osr = CMD_ADC_4096;
 
+// the conversions are started and read without waiting for the bus, the results arrive in the job callbacks
+static i2cJob_t ms5611CommandJob;
+static i2cJob_t ms5611ReadJob;
+static uint8_t ms5611AdcBuf[3];
+
 bool ms5611Detect(baro_t *baro)
 {
     bool ack = false;
@@ -134,31 +138,43 @@ STATIC_UNIT_TESTED int8_t ms5611_crc(uint16_t *prom)
     return -1;
 }
 
-static uint32_t ms5611_read_adc(void)
+static uint32_t ms5611_adc_value(const uint8_t *rxbuf)
 {
-    uint8_t rxbuf[3];
-    i2cRead(MS5611_ADDR, CMD_ADC_READ, 3, rxbuf); // read ADC
     return (rxbuf[0] << 16) | (rxbuf[1] << 8) | rxbuf[2];
 }
 
+static void ms5611_ut_read(i2cJob_t *job)
+{
+    if (job->state == I2C_JOB_DONE) {
+        ms5611_ut = ms5611_adc_value(job->buf);
+    }
+}
+
+static void ms5611_up_read(i2cJob_t *job)
+{
+    if (job->state == I2C_JOB_DONE) {
+        ms5611_up = ms5611_adc_value(job->buf);
+    }
+}
+
 static void ms5611_start_ut(void)
 {
-    i2cWrite(MS5611_ADDR, CMD_ADC_CONV + CMD_ADC_D2 + ms5611_osr, 1); // D2 (temperature) conversion start!
+    i2cQueueWrite(&ms5611CommandJob, MS5611_ADDR, CMD_ADC_CONV + CMD_ADC_D2 + ms5611_osr, 1); // D2 (temperature) conversion start!
 }
 
 static void ms5611_get_ut(void)
 {
-    ms5611_ut = ms5611_read_adc();
+    i2cQueueRead(&ms5611ReadJob, MS5611_ADDR, CMD_ADC_READ, 3, ms5611AdcBuf, ms5611_ut_read); // read ADC
 }
 
 static void ms5611_start_up(void)
 {
-    i2cWrite(MS5611_ADDR, CMD_ADC_CONV + CMD_ADC_D1 + ms5611_osr, 1); // D1 (pressure) conversion start!
+    i2cQueueWrite(&ms5611CommandJob, MS5611_ADDR, CMD_ADC_CONV + CMD_ADC_D1 + ms5611_osr, 1); // D1 (pressure) conversion start!
 }
 
 static void ms5611_get_up(void)
 {
-    ms5611_up = ms5611_read_adc();
+    i2cQueueRead(&ms5611ReadJob, MS5611_ADDR, CMD_ADC_READ, 3, ms5611AdcBuf, ms5611_up_read); // read ADC
 }
 
 STATIC_UNIT_TESTED void ms5611_calculate(int32_t *pressure, int32_t *temperature)
@@ -33,3 +33,46 @@ bool i2cWrite(uint8_t addr_, uint8_t reg, uint8_t data);
 bool i2cRead(uint8_t addr_, uint8_t reg, uint8_t len, uint8_t* buf);
 uint16_t i2cGetErrorCounter(void);
 void i2cSetOverclock(uint8_t OverClock);
+
+// Asynchronous transactions.
+//
+// A job is queued and the caller carries on, the bus driver runs the queued jobs one after the other from its
+// interrupt and calls the callback of each when it is done. Drivers keep their jobs in static storage and must
+// not touch the buffer of a job while it is queued.
+
+#define I2C_QUEUE_SIZE               8
+#define I2C_JOB_TIMEOUT_US           5000      // a job that took longer is aborted
+#define I2C_NO_REGISTER              0xFF
+
+typedef enum {
+    I2C_JOB_IDLE = 0,
+    I2C_JOB_QUEUED,                 // waiting for the bus or on it
+    I2C_JOB_DONE,
+    I2C_JOB_FAILED,
+} i2cJobState_e;
+
+struct i2cJob_s;
+typedef void (*i2cJobCallbackPtr)(struct i2cJob_s *job);
+
+typedef struct i2cJob_s {
+    uint8_t addr;
+    uint8_t reg;                    // I2C_NO_REGISTER for none
+    uint8_t len;
+    bool read;
+    uint8_t *buf;
+    uint8_t value;                  // data of single byte writes
+    i2cJobCallbackPtr callback;     // called from the bus interrupt when the job is done or failed, may be NULL
+    volatile i2cJobState_e state;
+} i2cJob_t;
+
+bool i2cQueueJob(i2cJob_t *job);
+bool i2cQueueRead(i2cJob_t *job, uint8_t addr_, uint8_t reg_, uint8_t len, uint8_t *buf, i2cJobCallbackPtr callback);
+bool i2cQueueWrite(i2cJob_t *job, uint8_t addr_, uint8_t reg_, uint8_t data);
+bool i2cQueueBusy(void);
+void i2cQueueCheckTimeout(void);
+bool i2cTransferBlocking(i2cJob_t *job);
+
+// implemented by the bus drivers
+i2cJobState_e i2cHardwareStartJob(const i2cJob_t *job);  // I2C_JOB_QUEUED if the job is running, or its result
+void i2cHardwareAbortJob(void);
+void i2cJobComplete(bool success);                      // called by the bus driver when the running job ended
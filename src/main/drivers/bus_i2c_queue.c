@@ -0,0 +1,220 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <platform.h>
+
+#include "build/build_config.h"
+
+#include "common/utils.h"
+
+#include "system.h"
+
+#include "bus_i2c.h"
+
+#ifdef UNIT_TEST
+#define ATOMIC_BLOCK(prio) for (int __ToDo = 1; __ToDo; __ToDo = 0)
+#else
+#include "build/atomic.h"
+#include "nvic.h"
+#endif
+
+// The I2C interrupts run at priority 0, which NVIC_PRIO_MAX masks as well.
+#define I2C_QUEUE_ATOMIC_BLOCK ATOMIC_BLOCK(NVIC_PRIO_MAX)
+
+static i2cJob_t *i2cQueue[I2C_QUEUE_SIZE];
+static volatile uint8_t i2cQueueHead;   // the job on the bus
+static volatile uint8_t i2cQueueTail;   // where the next job is queued
+static volatile bool i2cQueueRunning;   // the head job is being run, until the next is taken
+static volatile bool i2cJobOnBus;       // the head job is started and not yet ended
+static volatile uint32_t i2cJobStartedAt;
+
+// Takes the job at the head of the queue onto the bus, must be called inside I2C_QUEUE_ATOMIC_BLOCK.
+static i2cJob_t *i2cTakeNextJob(void)
+{
+    if (i2cQueueHead == i2cQueueTail) {
+        i2cQueueRunning = false;
+        return NULL;
+    }
+    i2cQueueRunning = true;
+    i2cJobOnBus = true;
+    i2cJobStartedAt = micros();
+    return i2cQueue[i2cQueueHead];
+}
+
+// Ends the job on the bus once, whichever of its completion and its timeout comes first.
+static i2cJob_t *i2cEndJob(void)
+{
+    i2cJob_t *job = NULL;
+
+    I2C_QUEUE_ATOMIC_BLOCK {
+        if (i2cJobOnBus) {
+            i2cJobOnBus = false;
+            job = i2cQueue[i2cQueueHead];
+        }
+    }
+    return job;
+}
+
+// Removes the job on the bus from the queue and takes the next, must be called inside I2C_QUEUE_ATOMIC_BLOCK.
+static i2cJob_t *i2cPopJob(void)
+{
+    i2cQueueHead = (i2cQueueHead + 1) % I2C_QUEUE_SIZE;
+    return i2cTakeNextJob();
+}
+
+static void i2cFinishJob(i2cJob_t *job, bool success)
+{
+    job->state = success ? I2C_JOB_DONE : I2C_JOB_FAILED;
+    if (job->callback) {
+        job->callback(job);
+    }
+}
+
+/*
+ * Runs jobs until one is left running in the background, bus drivers that cannot work in the background finish them
+ * here. Only taking the jobs is atomic, so the interrupts are not held off while a driver busy waits for the bus.
+ * The bus is marked as running the job while its callback runs, so jobs queued by the callback are run by this loop
+ * rather than recursively.
+ */
+static void i2cRunJobs(i2cJob_t *job)
+{
+    while (job) {
+        const i2cJobState_e state = i2cHardwareStartJob(job);
+        if (state == I2C_JOB_QUEUED || !i2cEndJob()) {
+            return;
+        }
+        i2cFinishJob(job, state == I2C_JOB_DONE);
+
+        I2C_QUEUE_ATOMIC_BLOCK {
+            job = i2cPopJob();
+        }
+    }
+}
+
+void i2cJobComplete(bool success)
+{
+    i2cJob_t *job = i2cEndJob();
+
+    if (!job) {
+        return;
+    }
+
+    i2cFinishJob(job, success);
+
+    I2C_QUEUE_ATOMIC_BLOCK {
+        job = i2cPopJob();
+    }
+    i2cRunJobs(job);
+}
+
+/*
+ * Queues a job, returns false if it is still queued from before or the queue is full.
+ * The callback may run before this returns, with bus drivers that complete the job when it starts.
+ */
+bool i2cQueueJob(i2cJob_t *job)
+{
+    i2cJob_t *start = NULL;
+    bool queued = false;
+
+    i2cQueueCheckTimeout();
+
+    I2C_QUEUE_ATOMIC_BLOCK {
+        const uint8_t next = (i2cQueueTail + 1) % I2C_QUEUE_SIZE;
+        if (job->state != I2C_JOB_QUEUED && next != i2cQueueHead) {
+            job->state = I2C_JOB_QUEUED;
+            i2cQueue[i2cQueueTail] = job;
+            i2cQueueTail = next;
+            queued = true;
+            if (!i2cQueueRunning) {
+                start = i2cTakeNextJob();
+            }
+        }
+    }
+
+    i2cRunJobs(start);
+
+    return queued;
+}
+
+bool i2cQueueRead(i2cJob_t *job, uint8_t addr_, uint8_t reg_, uint8_t len, uint8_t *buf, i2cJobCallbackPtr callback)
+{
+    if (job->state == I2C_JOB_QUEUED) {
+        return false;
+    }
+    job->addr = addr_;
+    job->reg = reg_;
+    job->len = len;
+    job->read = true;
+    job->buf = buf;
+    job->callback = callback;
+    return i2cQueueJob(job);
+}
+
+bool i2cQueueWrite(i2cJob_t *job, uint8_t addr_, uint8_t reg_, uint8_t data)
+{
+    if (job->state == I2C_JOB_QUEUED) {
+        return false;
+    }
+    job->addr = addr_;
+    job->reg = reg_;
+    job->len = 1;
+    job->read = false;
+    job->value = data;
+    job->buf = &job->value;
+    job->callback = NULL;
+    return i2cQueueJob(job);
+}
+
+bool i2cQueueBusy(void)
+{
+    return i2cQueueRunning;
+}
+
+// Aborts the job on the bus if it has not finished in time, so a hung bus or device does not stop the queue.
+void i2cQueueCheckTimeout(void)
+{
+    i2cJob_t *job = NULL;
+
+    if (i2cJobOnBus && cmp32(micros(), i2cJobStartedAt) > I2C_JOB_TIMEOUT_US) {
+        job = i2cEndJob();
+    }
+
+    if (job) {
+        i2cHardwareAbortJob();
+        i2cFinishJob(job, false);
+
+        I2C_QUEUE_ATOMIC_BLOCK {
+            job = i2cPopJob();
+        }
+        i2cRunJobs(job);
+    }
+}
+
+// Queues a job and waits until it is done, for code that cannot go on without the result, e.g. sensor detection.
+bool i2cTransferBlocking(i2cJob_t *job)
+{
+    if (!i2cQueueJob(job)) {
+        return false;
+    }
+    while (job->state == I2C_JOB_QUEUED) {
+        i2cQueueCheckTimeout();
+    }
+    return job->state == I2C_JOB_DONE;
+}
@@ -257,6 +257,23 @@ bool i2cRead(uint8_t addr, uint8_t reg, uint8_t len, uint8_t *buf)
     return true;
 }
 
+// The bus is bit banged, so queued jobs are done when they start, with the interrupts enabled.
+i2cJobState_e i2cHardwareStartJob(const i2cJob_t *job)
+{
+    bool ack;
+
+    if (job->read) {
+        ack = i2cRead(job->addr, job->reg, job->len, job->buf);
+    } else {
+        ack = i2cWriteBuffer(job->addr, job->reg, job->len, job->buf);
+    }
+    return ack ? I2C_JOB_DONE : I2C_JOB_FAILED;
+}
+
+void i2cHardwareAbortJob(void)
+{
+}
+
 uint16_t i2cGetErrorCounter(void)
 {
     // TODO maybe fix this, but since this is test code, doesn't matter.
@@ -103,54 +103,57 @@ static volatile uint8_t reading;
 static volatile uint8_t* write_p;
 static volatile uint8_t* read_p;
 
-static bool i2cHandleHardwareFailure(void)
-{
-    i2cErrorCount++;
-
-    // reinit peripheral + clock out garbage
-    if (busError) {
-        i2cInit(I2Cx_index);
-    }
-
-    return false;
-}
-
-bool i2cWriteBuffer(uint8_t addr_, uint8_t reg_, uint8_t len_, uint8_t *data)
+i2cJobState_e i2cHardwareStartJob(const i2cJob_t *job)
 {
     uint32_t timeout = I2C_DEFAULT_TIMEOUT;
 
-    addr = addr_ << 1;
-    reg = reg_;
-    writing = 1;
-    reading = 0;
-    write_p = data;
-    read_p = data;
-    bytes = len_;
+    addr = job->addr << 1;
+    reg = job->reg;
+    writing = !job->read;
+    reading = job->read;
+    write_p = job->buf;
+    read_p = job->buf;
+    bytes = job->len;
     busy = 1;
     error = false;
     busError = false;
 
-    if (!I2Cx)
-        return false;
+    if (!I2Cx) {
+        busy = 0;
+        return I2C_JOB_FAILED;
+    }
 
     if (!(I2Cx->CR2 & I2C_IT_EVT)) {                                    // if we are restarting the driver
         if (!(I2Cx->CR1 & 0x0100)) {                                    // ensure sending a start
             while (I2Cx->CR1 & 0x0200 && --timeout > 0) { ; }           // wait for any stop to finish sending
             if (error || timeout == 0) {
-                return i2cHandleHardwareFailure();
+                i2cHardwareAbortJob();
+                return I2C_JOB_FAILED;
             }
             I2C_GenerateSTART(I2Cx, ENABLE);                            // send the start for the new job
         }
         I2C_ITConfig(I2Cx, I2C_IT_EVT | I2C_IT_ERR, ENABLE);            // allow the interrupts to fire off again
     }
 
-    timeout = I2C_DEFAULT_TIMEOUT;
-    while (busy && --timeout > 0) { ; }
-    if (timeout == 0) {
-        return i2cHandleHardwareFailure();
+    return I2C_JOB_QUEUED;                                              // completed by the interrupt handlers
+}
+
+void i2cHardwareAbortJob(void)
+{
+    busy = 0;
+    i2cErrorCount++;
+
+    // reinit peripheral + clock out garbage
+    if (busError) {
+        i2cInit(I2Cx_index);
     }
+}
+
+bool i2cWriteBuffer(uint8_t addr_, uint8_t reg_, uint8_t len_, uint8_t *data)
+{
+    i2cJob_t job = { .addr = addr_, .reg = reg_, .len = len_, .read = false, .buf = data };
 
-    return !error;
+    return i2cTransferBlocking(&job);
 }
 
 bool i2cWrite(uint8_t addr_, uint8_t reg_, uint8_t data)
@@ -160,38 +163,9 @@ bool i2cWrite(uint8_t addr_, uint8_t reg_, uint8_t data)
 
 bool i2cRead(uint8_t addr_, uint8_t reg_, uint8_t len, uint8_t* buf)
 {
-    uint32_t timeout = I2C_DEFAULT_TIMEOUT;
-
-    addr = addr_ << 1;
-    reg = reg_;
-    writing = 0;
-    reading = 1;
-    read_p = buf;
-    write_p = buf;
-    bytes = len;
-    busy = 1;
-    error = false;
-    busError = false;
-
-    if (!I2Cx)
-        return false;
-
-    if (!(I2Cx->CR2 & I2C_IT_EVT)) {                                    // if we are restarting the driver
-        if (!(I2Cx->CR1 & 0x0100)) {                                    // ensure sending a start
-            while (I2Cx->CR1 & 0x0200 && --timeout > 0) { ; }           // wait for any stop to finish sending
-            if (error || timeout == 0)
-                return i2cHandleHardwareFailure();
-            I2C_GenerateSTART(I2Cx, ENABLE);                            // send the start for the new job
-        }
-        I2C_ITConfig(I2Cx, I2C_IT_EVT | I2C_IT_ERR, ENABLE);            // allow the interrupts to fire off again
-    }
-
-    timeout = I2C_DEFAULT_TIMEOUT;
-    while (busy && --timeout > 0) { ; }
-    if (timeout == 0)
-        return i2cHandleHardwareFailure();
+    i2cJob_t job = { .addr = addr_, .reg = reg_, .len = len, .read = true, .buf = buf };
 
-    return !error;
+    return i2cTransferBlocking(&job);
 }
 
 static void i2c_er_handler(void)
@@ -225,7 +199,10 @@ static void i2c_er_handler(void)
         }
     }
     I2Cx->SR1 &= ~0x0F00;                                               // reset all the error bits to clear the interrupt
-    busy = 0;
+    if (busy) {
+        busy = 0;
+        i2cJobComplete(!error);
+    }
 }
 
 void i2c_ev_handler(void)
@@ -326,6 +303,7 @@ void i2c_ev_handler(void)
         if (final_stop)                                                 // If there is a final stop and no more jobs, bus is inactive, disable interrupts to prevent BTF
             I2C_ITConfig(I2Cx, I2C_IT_EVT | I2C_IT_ERR, DISABLE);       // Disable EVT and ERR interrupts while bus inactive
         busy = 0;
+        i2cJobComplete(!error);                                         // may start the next job
     }
 }
 
@@ -208,6 +208,23 @@ uint16_t i2cGetErrorCounter(void)
 
 }
 
+// The transfers busy wait for the peripheral, so queued jobs are done when they start, with the interrupts enabled.
+i2cJobState_e i2cHardwareStartJob(const i2cJob_t *job)
+{
+    bool ack;
+
+    if (job->read) {
+        ack = i2cRead(job->addr, job->reg, job->len, job->buf);
+    } else {
+        ack = job->len == 1 && i2cWrite(job->addr, job->reg, job->buf[0]);
+    }
+    return ack ? I2C_JOB_DONE : I2C_JOB_FAILED;
+}
+
+void i2cHardwareAbortJob(void)
+{
+}
+
 bool i2cWrite(uint8_t addr_, uint8_t reg, uint8_t data)
 {
     addr_ <<= 1;
@@ -23,9 +23,34 @@
 #include "build/build_config.h"
 
 #include "gpio.h"
+#include "nvic.h"
+#include "dma.h"
 
 #include "bus_spi.h"
 
+#if defined(SPI1_DMA_CHANNEL_TX) || defined(SPI2_DMA_CHANNEL_TX) || defined(SPI3_DMA_CHANNEL_TX)
+#define USE_SPI_DMA
+#endif
+
+#ifdef USE_SPI_DMA
+/*
+ * DMA for a bus, configured by the target with SPIx_DMA_CHANNEL_TX, SPIx_DMA_CHANNEL_RX and SPIx_DMA_IRQ_HANDLER_ID.
+ * The RX channel is optional, without it the received bytes are drained when the transfer is complete and
+ * the interrupt is the one of the TX channel.
+ */
+typedef struct spiDma_s {
+    dmaCallbackHandler_t handler;   // first, the interrupt handler gets a pointer to it
+    SPI_TypeDef *instance;
+    DMA_Channel_TypeDef *txChannel;
+    DMA_Channel_TypeDef *rxChannel;
+    const spiTransaction_t * volatile transaction;
+} spiDma_t;
+
+#define SPI_DMA_BUS_COUNT 3
+
+static spiDma_t spiDma[SPI_DMA_BUS_COUNT];
+#endif
+
 #ifdef USE_SPI_DEVICE_1
 
 #ifndef SPI1_GPIO
@@ -420,6 +445,186 @@ void initSpi3(void)
 }
 #endif
 
+static void spiSelect(const spiDevice_t *device)
+{
+    if (device->csGpio) {
+        GPIO_ResetBits(device->csGpio, device->csPin);
+    }
+}
+
+static void spiDeselect(const spiDevice_t *device)
+{
+    if (device->csGpio) {
+        while (spiIsBusBusy(device->instance)) {
+        }
+        GPIO_SetBits(device->csGpio, device->csPin);
+    }
+}
+
+#ifdef USE_SPI_DMA
+static spiDma_t *spiFindDma(SPI_TypeDef *instance)
+{
+    for (int i = 0; i < SPI_DMA_BUS_COUNT; i++) {
+        if (spiDma[i].instance == instance) {
+            return &spiDma[i];
+        }
+    }
+    return NULL;
+}
+
+static void spiDmaFinish(spiDma_t *dma, bool success)
+{
+    SPI_TypeDef *instance = dma->instance;
+
+    if (dma->rxChannel) {
+        DMA_Cmd(dma->rxChannel, DISABLE);
+    }
+
+    // Make sure the last byte is out (empty transmit buffer and not busy)
+    while (SPI_I2S_GetFlagStatus(instance, SPI_I2S_FLAG_TXE) == RESET) {
+    }
+    while (SPI_I2S_GetFlagStatus(instance, SPI_I2S_FLAG_BSY) == SET) {
+    }
+
+    // Empty the RX buffer, the RX channel takes care of it if there is one.
+    while (SPI_I2S_GetFlagStatus(instance, SPI_I2S_FLAG_RXNE) == SET) {
+        instance->DR;
+    }
+
+    DMA_Cmd(dma->txChannel, DISABLE);
+    SPI_I2S_DMACmd(instance, SPI_I2S_DMAReq_Rx | SPI_I2S_DMAReq_Tx, DISABLE);
+
+    const spiTransaction_t *transaction = dma->transaction;
+    dma->transaction = NULL;
+    if (transaction) {
+        spiDeselect(transaction->device);
+        spiTransactionComplete(instance, success);
+    }
+}
+
+static void spiDmaIrqHandler(dmaChannel_t *descriptor, dmaCallbackHandler_t *callbackHandler)
+{
+    spiDma_t *dma = (spiDma_t *)callbackHandler;
+
+    if (DMA_GET_FLAG_STATUS(descriptor, DMA_IT_TCIF)) {
+        DMA_CLEAR_FLAG(descriptor, DMA_IT_TCIF);
+        spiDmaFinish(dma, true);
+    }
+    if (DMA_GET_FLAG_STATUS(descriptor, DMA_IT_HTIF)) {
+        DMA_CLEAR_FLAG(descriptor, DMA_IT_HTIF);
+    }
+    if (DMA_GET_FLAG_STATUS(descriptor, DMA_IT_TEIF)) {
+        DMA_CLEAR_FLAG(descriptor, DMA_IT_TEIF);
+        spiDmaFinish(dma, false);
+    }
+}
+
+static void spiDmaStart(spiDma_t *dma, const spiTransaction_t *transaction)
+{
+    static uint8_t dummy = 0xFF;
+    DMA_InitTypeDef DMA_InitStructure;
+
+    dma->transaction = transaction;
+
+    DMA_DeInit(dma->txChannel);
+    if (dma->rxChannel) {
+        DMA_DeInit(dma->rxChannel);
+    }
+
+    // Common to both channels
+    DMA_StructInit(&DMA_InitStructure);
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&dma->instance->DR;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_BufferSize = transaction->len;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+    DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+
+    if (dma->rxChannel) {
+        // Rx has the higher priority so the receive register never overruns
+        DMA_InitStructure.DMA_Priority = DMA_Priority_Medium;
+        DMA_InitStructure.DMA_MemoryBaseAddr = transaction->rxBuf ? (uint32_t)transaction->rxBuf : (uint32_t)&dummy;
+        DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
+        DMA_InitStructure.DMA_MemoryInc = transaction->rxBuf ? DMA_MemoryInc_Enable : DMA_MemoryInc_Disable;
+
+        DMA_Init(dma->rxChannel, &DMA_InitStructure);
+        DMA_ITConfig(dma->rxChannel, DMA_IT_TC | DMA_IT_TE, ENABLE);
+        DMA_Cmd(dma->rxChannel, ENABLE);
+    }
+
+    DMA_InitStructure.DMA_Priority = DMA_Priority_Low;
+    DMA_InitStructure.DMA_MemoryBaseAddr = transaction->txBuf ? (uint32_t)transaction->txBuf : (uint32_t)&dummy;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralDST;
+    DMA_InitStructure.DMA_MemoryInc = transaction->txBuf ? DMA_MemoryInc_Enable : DMA_MemoryInc_Disable;
+
+    DMA_Init(dma->txChannel, &DMA_InitStructure);
+    if (!dma->rxChannel) {
+        DMA_ITConfig(dma->txChannel, DMA_IT_TC | DMA_IT_TE, ENABLE);
+    }
+    DMA_Cmd(dma->txChannel, ENABLE);
+
+    // Discard anything received before
+    while (SPI_I2S_GetFlagStatus(dma->instance, SPI_I2S_FLAG_RXNE) == SET) {
+        dma->instance->DR;
+    }
+
+    SPI_I2S_DMACmd(dma->instance, (dma->rxChannel ? SPI_I2S_DMAReq_Rx : 0) | SPI_I2S_DMAReq_Tx, ENABLE);
+}
+
+static void spiDmaInit(spiDma_t *dma, SPI_TypeDef *instance, DMA_Channel_TypeDef *txChannel, DMA_Channel_TypeDef *rxChannel, dmaChannel_t *irqChannel)
+{
+    if (dma->instance) {
+        return;
+    }
+    dma->instance = instance;
+    dma->txChannel = txChannel;
+    dma->rxChannel = rxChannel;
+    dmaHandlerInit(&dma->handler, spiDmaIrqHandler);
+    dmaSetHandler(irqChannel, &dma->handler, NVIC_PRIO_SPI_DMA);
+}
+#endif
+
+static void spiInitDma(SPI_TypeDef *instance)
+{
+    UNUSED(instance);
+
+#ifdef SPI1_DMA_CHANNEL_TX
+#ifndef SPI1_DMA_CHANNEL_RX
+#define SPI1_DMA_CHANNEL_RX NULL
+#endif
+    if (instance == SPI1) {
+        spiDmaInit(&spiDma[0], SPI1, SPI1_DMA_CHANNEL_TX, SPI1_DMA_CHANNEL_RX, SPI1_DMA_IRQ_HANDLER_ID);
+    }
+#endif
+#ifdef SPI2_DMA_CHANNEL_TX
+#ifndef SPI2_DMA_CHANNEL_RX
+#define SPI2_DMA_CHANNEL_RX NULL
+#endif
+    if (instance == SPI2) {
+        spiDmaInit(&spiDma[1], SPI2, SPI2_DMA_CHANNEL_TX, SPI2_DMA_CHANNEL_RX, SPI2_DMA_IRQ_HANDLER_ID);
+    }
+#endif
+#ifdef SPI3_DMA_CHANNEL_TX
+#ifndef SPI3_DMA_CHANNEL_RX
+#define SPI3_DMA_CHANNEL_RX NULL
+#endif
+    if (instance == SPI3) {
+        spiDmaInit(&spiDma[2], SPI3, SPI3_DMA_CHANNEL_TX, SPI3_DMA_CHANNEL_RX, SPI3_DMA_IRQ_HANDLER_ID);
+    }
+#endif
+}
+
+bool spiHasDma(SPI_TypeDef *instance)
+{
+#ifdef USE_SPI_DMA
+    return spiFindDma(instance) != NULL;
+#else
+    UNUSED(instance);
+    return false;
+#endif
+}
+
 bool spiInit(SPI_TypeDef *instance)
 {
 #if (!(defined(USE_SPI_DEVICE_1) && defined(USE_SPI_DEVICE_2) && defined(USE_SPI_DEVICE_3)))
@@ -429,18 +634,21 @@ bool spiInit(SPI_TypeDef *instance)
 #ifdef USE_SPI_DEVICE_1
     if (instance == SPI1) {
         initSpi1();
+        spiInitDma(instance);
         return true;
     }
 #endif
 #ifdef USE_SPI_DEVICE_2
     if (instance == SPI2) {
         initSpi2();
+        spiInitDma(instance);
         return true;
     }
 #endif
 #if defined(USE_SPI_DEVICE_3) && defined(STM32F303xC)
     if (instance == SPI3) {
         initSpi3();
+        spiInitDma(instance);
         return true;
     }
 #endif
@@ -449,6 +657,8 @@ bool spiInit(SPI_TypeDef *instance)
 
 uint8_t spiTransferByte(SPI_TypeDef *instance, uint8_t data)
 {
+    spiQueueWaitIdle(instance);
+
     uint16_t spiTimeout = 1000;
 
     while (SPI_I2S_GetFlagStatus(instance, SPI_I2S_FLAG_TXE) == RESET) {
@@ -490,7 +700,7 @@ bool spiIsBusBusy(SPI_TypeDef *instance)
 
 }
 
-void spiTransfer(SPI_TypeDef *instance, uint8_t *out, const uint8_t *in, int len)
+static void spiTransferPolled(SPI_TypeDef *instance, uint8_t *out, const uint8_t *in, int len)
 {
     uint16_t spiTimeout = 1000;
 
@@ -526,6 +736,32 @@ void spiTransfer(SPI_TypeDef *instance, uint8_t *out, const uint8_t *in, int len
     }
 }
 
+void spiTransfer(SPI_TypeDef *instance, uint8_t *out, const uint8_t *in, int len)
+{
+    spiQueueWaitIdle(instance);
+    spiTransferPolled(instance, out, in, len);
+}
+
+spiTransactionState_e spiHardwareStartTransaction(const spiTransaction_t *transaction)
+{
+    const spiDevice_t *device = transaction->device;
+
+    spiSelect(device);
+
+#ifdef USE_SPI_DMA
+    spiDma_t *dma = spiFindDma(device->instance);
+    if (dma && transaction->len >= SPI_DMA_MIN_LENGTH) {
+        spiDmaStart(dma, transaction);
+        return SPI_TRANSACTION_QUEUED;
+    }
+#endif
+
+    spiTransferPolled(device->instance, transaction->rxBuf, transaction->txBuf, transaction->len);
+    spiDeselect(device);
+
+    return SPI_TRANSACTION_DONE;
+}
+
 
 void spiSetDivisor(SPI_TypeDef *instance, uint16_t divisor)
 {
@@ -533,6 +769,8 @@ void spiSetDivisor(SPI_TypeDef *instance, uint16_t divisor)
 
     uint16_t tempRegister;
 
+    spiQueueWaitIdle(instance);
+
     SPI_Cmd(instance, DISABLE);
 
     tempRegister = instance->CR1;
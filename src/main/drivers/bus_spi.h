@@ -28,3 +28,60 @@ uint8_t spiTransferByte(SPI_TypeDef *instance, uint8_t in);
 bool spiIsBusBusy(SPI_TypeDef *instance);
 
 void spiTransfer(SPI_TypeDef *instance, uint8_t *out, const uint8_t *in, int len);
+
+bool spiHasDma(SPI_TypeDef *instance);
+
+/*
+ * Transaction queue, one per bus.
+ *
+ * Devices sharing a bus queue their transfers instead of driving the bus themselves. Queued transactions run in
+ * priority order, first come first served within a priority, so a gyro read goes ahead of a flash page program or
+ * SD card block that is still waiting. A transaction already on the bus runs to completion. Buses with DMA
+ * channels run long transactions in the background and call back from the DMA interrupt, other transactions
+ * complete when they are started.
+ */
+
+#define SPI_DMA_MIN_LENGTH  16      // shorter transactions are quicker polled than set up for DMA
+
+typedef enum {
+    SPI_PRIORITY_SENSOR = 0,        // gyro and accelerometer
+    SPI_PRIORITY_NORMAL,
+    SPI_PRIORITY_BULK,              // flash, SD card and OSD transfers
+} spiPriority_e;
+
+typedef enum {
+    SPI_TRANSACTION_IDLE = 0,
+    SPI_TRANSACTION_QUEUED,
+    SPI_TRANSACTION_DONE,
+    SPI_TRANSACTION_FAILED,
+} spiTransactionState_e;
+
+typedef struct spiDevice_s {
+    SPI_TypeDef *instance;
+    GPIO_TypeDef *csGpio;           // NULL if the driver selects the device itself
+    uint16_t csPin;
+} spiDevice_t;
+
+struct spiTransaction_s;
+typedef void (*spiTransactionCallbackPtr)(struct spiTransaction_s *transaction);
+
+typedef struct spiTransaction_s {
+    const spiDevice_t *device;
+    const uint8_t *txBuf;           // NULL sends 0xFF
+    uint8_t *rxBuf;                 // NULL discards what is received
+    uint16_t len;
+    uint8_t priority;               // spiPriority_e
+    spiTransactionCallbackPtr callback;     // called from the DMA interrupt for transactions run with DMA
+    volatile uint8_t state;         // spiTransactionState_e
+    struct spiTransaction_s *next;
+} spiTransaction_t;
+
+bool spiQueueTransaction(spiTransaction_t *transaction);
+bool spiTransactionBlocking(spiTransaction_t *transaction);
+bool spiQueueBusy(SPI_TypeDef *instance);
+void spiQueueWaitIdle(SPI_TypeDef *instance);
+
+// implemented by the bus driver
+spiTransactionState_e spiHardwareStartTransaction(const spiTransaction_t *transaction);
+// called by the bus driver when a transaction it started in the background is complete
+void spiTransactionComplete(SPI_TypeDef *instance, bool success);
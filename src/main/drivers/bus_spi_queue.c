@@ -0,0 +1,180 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <platform.h>
+
+#include "build/build_config.h"
+
+#include "bus_spi.h"
+
+#ifdef UNIT_TEST
+#define ATOMIC_BLOCK(prio) for (int __ToDo = 1; __ToDo; __ToDo = 0)
+#else
+#include "build/atomic.h"
+#include "nvic.h"
+#endif
+
+#define SPI_QUEUE_ATOMIC_BLOCK ATOMIC_BLOCK(NVIC_PRIO_SPI_DMA)
+
+#define SPI_QUEUE_BUS_COUNT 3
+
+typedef struct spiQueue_s {
+    SPI_TypeDef *instance;
+    spiTransaction_t * volatile waiting;    // in priority order
+    spiTransaction_t * volatile running;
+} spiQueue_t;
+
+static spiQueue_t spiQueues[SPI_QUEUE_BUS_COUNT];
+
+static spiQueue_t *spiFindQueue(SPI_TypeDef *instance)
+{
+    for (int i = 0; i < SPI_QUEUE_BUS_COUNT; i++) {
+        if (spiQueues[i].instance == instance) {
+            return &spiQueues[i];
+        }
+    }
+    return NULL;
+}
+
+static spiQueue_t *spiGetQueue(SPI_TypeDef *instance)
+{
+    spiQueue_t *queue = spiFindQueue(instance);
+    if (!queue) {
+        queue = spiFindQueue(NULL);
+        if (queue) {
+            queue->instance = instance;
+        }
+    }
+    return queue;
+}
+
+// Takes the next waiting transaction onto the bus, must be called with the DMA interrupt masked.
+static spiTransaction_t *spiTakeNextTransaction(spiQueue_t *queue)
+{
+    spiTransaction_t *transaction = queue->waiting;
+    if (transaction) {
+        queue->waiting = transaction->next;
+    }
+    queue->running = transaction;
+    return transaction;
+}
+
+static void spiFinishTransaction(spiTransaction_t *transaction, bool success)
+{
+    transaction->state = success ? SPI_TRANSACTION_DONE : SPI_TRANSACTION_FAILED;
+    if (transaction->callback) {
+        transaction->callback(transaction);
+    }
+}
+
+/*
+ * Runs transactions until one is left running in the background. The bus is marked as running the transaction
+ * while its callback runs, so transactions queued by the callback are run by this loop rather than recursively.
+ */
+static void spiRunTransactions(spiQueue_t *queue, spiTransaction_t *transaction)
+{
+    while (transaction) {
+        const spiTransactionState_e state = spiHardwareStartTransaction(transaction);
+        if (state == SPI_TRANSACTION_QUEUED) {
+            return;
+        }
+        spiFinishTransaction(transaction, state == SPI_TRANSACTION_DONE);
+
+        SPI_QUEUE_ATOMIC_BLOCK {
+            transaction = spiTakeNextTransaction(queue);
+        }
+    }
+}
+
+void spiTransactionComplete(SPI_TypeDef *instance, bool success)
+{
+    spiQueue_t *queue = spiFindQueue(instance);
+    spiTransaction_t *transaction;
+
+    if (!queue || !queue->running) {
+        return;
+    }
+
+    spiFinishTransaction(queue->running, success);
+
+    SPI_QUEUE_ATOMIC_BLOCK {
+        transaction = spiTakeNextTransaction(queue);
+    }
+    spiRunTransactions(queue, transaction);
+}
+
+/*
+ * Queues a transaction on the bus of its device, returns false if it is still queued from before.
+ * A transaction that does not run in the background is complete, and its callback called, before this returns.
+ */
+bool spiQueueTransaction(spiTransaction_t *transaction)
+{
+    spiTransaction_t *start = NULL;
+    bool queued = false;
+
+    SPI_QUEUE_ATOMIC_BLOCK {
+        spiQueue_t *queue = spiGetQueue(transaction->device->instance);
+        if (queue && transaction->state != SPI_TRANSACTION_QUEUED) {
+            spiTransaction_t * volatile *link = &queue->waiting;
+            while (*link && (*link)->priority <= transaction->priority) {
+                link = &(*link)->next;
+            }
+            transaction->next = *link;
+            *link = transaction;
+            transaction->state = SPI_TRANSACTION_QUEUED;
+            queued = true;
+
+            if (!queue->running) {
+                start = spiTakeNextTransaction(queue);
+            }
+        }
+    }
+
+    if (start) {
+        spiRunTransactions(spiFindQueue(transaction->device->instance), start);
+    }
+
+    return queued;
+}
+
+// Queues a transaction and waits for it, must not be called from a transaction callback.
+bool spiTransactionBlocking(spiTransaction_t *transaction)
+{
+    if (!spiQueueTransaction(transaction)) {
+        return false;
+    }
+    while (transaction->state == SPI_TRANSACTION_QUEUED) {
+    }
+    return transaction->state == SPI_TRANSACTION_DONE;
+}
+
+bool spiQueueBusy(SPI_TypeDef *instance)
+{
+    const spiQueue_t *queue = spiFindQueue(instance);
+    return queue && (queue->running || queue->waiting);
+}
+
+// For drivers that drive the bus themselves, waits until the queued transactions are done.
+void spiQueueWaitIdle(SPI_TypeDef *instance)
+{
+    while (spiQueueBusy(instance)) {
+    }
+}
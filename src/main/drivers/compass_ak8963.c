@@ -17,6 +17,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
 #include <math.h>
 
@@ -323,15 +324,23 @@ restart:
         }
     }
 #else
-    ack = ak8963SensorRead(AK8963_MAG_I2C_ADDRESS, AK8963_MAG_REG_STATUS1, 1, &buf[0]);
-
-    uint8_t status = buf[0];
-
-    if (!ack || (status & STATUS1_DATA_READY) == 0) {
+    // the status, the 6 bytes of data and the status2 register are read in one job, the result is used by the next
+    // call, so the compass task never waits for the bus
+    static i2cJob_t readJob;
+    static i2cJob_t measureJob;
+    static uint8_t frame[8];
+
+    ack = readJob.state == I2C_JOB_DONE && (frame[0] & STATUS1_DATA_READY);
+    if (ack) {
+        memcpy(buf, &frame[1], sizeof(buf));
+    }
+    if (readJob.state != I2C_JOB_QUEUED) {
+        i2cQueueRead(&readJob, AK8963_MAG_I2C_ADDRESS, AK8963_MAG_REG_STATUS1, sizeof(frame), frame, NULL);
+        i2cQueueWrite(&measureJob, AK8963_MAG_I2C_ADDRESS, AK8963_MAG_REG_CNTL, CNTL_MODE_ONCE); // start the measurement the next read gets
+    }
+    if (!ack) {
         return false;
     }
-
-    ack = ak8963SensorRead(AK8963_MAG_I2C_ADDRESS, AK8963_MAG_REG_HXL, 7, &buf[0]);
 #endif
     uint8_t status2 = buf[6];
     if (!ack || (status2 & STATUS2_DATA_ERROR) || (status2 & STATUS2_MAG_SENSOR_OVERFLOW)) {
@@ -344,9 +353,7 @@ restart:
 
 #if defined(USE_SPI) && defined(MPU9250_SPI_INSTANCE)
     state = CHECK_STATUS;
-    return true;
-#else
-    return ak8963SensorWrite(AK8963_MAG_I2C_ADDRESS, AK8963_MAG_REG_CNTL, CNTL_MODE_ONCE); // start reading again
 #endif
+    return true;
 }
 #endif
@@ -188,6 +188,8 @@ bool hmc5883lDetect(mag_t* mag, const hmc5883Config_t *hmc5883ConfigToUse)
 }
 
 #define INIT_MAX_FAILURES 5
+static bool hmc5883lReadBlocking(int16_t *magData);
+
 bool hmc5883lInit(void)
 {
     int16_t magADC[3] = { 0, 0, 0 };
@@ -219,14 +221,14 @@ bool hmc5883lInit(void)
     // The new gain setting is effective from the second measurement and on.
     i2cWrite(MAG_ADDRESS, HMC58X3_R_CONFB, 0x60); // Set the Gain to 2.5Ga (7:5->011)
     delay(100);
-    hmc5883lRead(magADC);
+    hmc5883lReadBlocking(magADC);
 
     int validSamples = 0;
     int failedSamples = 0;
     while (validSamples < 10 && failedSamples < INIT_MAX_FAILURES) { // Collect 10 samples
         i2cWrite(MAG_ADDRESS, HMC58X3_R_MODE, 1);
         delay(50);
-        if (hmc5883lRead(magADC)) { // Get the raw values in case the scales have already been changed.
+        if (hmc5883lReadBlocking(magADC)) { // Get the raw values in case the scales have already been changed.
             ++validSamples;
             // Since the measurements are noisy, they should be averaged rather than taking the max.
             xyz_total[X] += magADC[X];
@@ -253,7 +255,7 @@ bool hmc5883lInit(void)
     while (validSamples < 10 && failedSamples < INIT_MAX_FAILURES) { // Collect 10 samples
         i2cWrite(MAG_ADDRESS, HMC58X3_R_MODE, 1);
         delay(50);
-        if (hmc5883lRead(magADC)) { // Get the raw values in case the scales have already been changed.
+        if (hmc5883lReadBlocking(magADC)) { // Get the raw values in case the scales have already been changed.
             ++validSamples;
             // Since the measurements are noisy, they should be averaged.
             xyz_total[X] -= magADC[X];
@@ -294,7 +296,16 @@ bool hmc5883lInit(void)
     return bret;
 }
 
-bool hmc5883lRead(int16_t *magData)
+static void hmc5883lDecode(const uint8_t *buf, int16_t *magData)
+{
+    // During calibration, magGain is 1.0, so the read returns normal non-calibrated values.
+    // After calibration is done, magGain is set to calculated gain values.
+    magData[X] = (int16_t)(buf[0] << 8 | buf[1]) * magGain[X];
+    magData[Z] = (int16_t)(buf[2] << 8 | buf[3]) * magGain[Z];
+    magData[Y] = (int16_t)(buf[4] << 8 | buf[5]) * magGain[Y];
+}
+
+static bool hmc5883lReadBlocking(int16_t *magData)
 {
     uint8_t buf[6];
 
@@ -302,12 +313,25 @@ bool hmc5883lRead(int16_t *magData)
     if (!ack) {
         return false;
     }
-    // During calibration, magGain is 1.0, so the read returns normal non-calibrated values.
-    // After calibration is done, magGain is set to calculated gain values.
-    magData[X] = (int16_t)(buf[0] << 8 | buf[1]) * magGain[X];
-    magData[Z] = (int16_t)(buf[2] << 8 | buf[3]) * magGain[Z];
-    magData[Y] = (int16_t)(buf[4] << 8 | buf[5]) * magGain[Y];
+    hmc5883lDecode(buf, magData);
 
     return true;
 }
+
+// Returns the data read on the previous call and queues the next read, the compass task never waits for the bus.
+bool hmc5883lRead(int16_t *magData)
+{
+    static i2cJob_t readJob;
+    static uint8_t buf[6];
+
+    const bool ready = readJob.state == I2C_JOB_DONE;
+    if (ready) {
+        hmc5883lDecode(buf, magData);
+    }
+    if (readJob.state != I2C_JOB_QUEUED) {
+        i2cQueueRead(&readJob, MAG_ADDRESS, MAG_DATA_REGISTER, 6, buf, NULL);
+    }
+
+    return ready;
+}
 #endif
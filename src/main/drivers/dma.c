@@ -23,11 +23,13 @@
 
 #include "build/build_config.h"
 
+#include "common/utils.h"
+
 #include "drivers/dma.h"
 #include "drivers/nvic.h"
 
 #define DEFINE_DMA_CHANNEL(d, c, f, i, r) \
-    {.dma = d, .channel = c, .handler = NULL, .flagsShift = f, .irqn = i, .rcc = r}
+    {.dma = d, .channel = c, .handler = NULL, .owner = DMA_OWNER_NONE, .flagsShift = f, .irqn = i, .rcc = r}
 
 #define DEFINE_DMA_IRQ_HANDLER(d, c, h) \
     void DMA ## d ## _Channel ## c ## _IRQHandler(void) {\
@@ -119,3 +121,27 @@ void dmaSetHandler(dmaChannel_t* channel, dmaCallbackHandler_t* handler, uint8_t
     }
 }
 
+
+dmaChannel_t* dmaFindChannel(DMA_Channel_TypeDef* channel)
+{
+    for (unsigned i = 0; i < ARRAYLEN(dmaChannels); i++) {
+        if (dmaChannels[i].channel == channel) {
+            return &dmaChannels[i];
+        }
+    }
+    return NULL;
+}
+
+// Claim a channel for a driver that is set up later in the boot, the first owner keeps it
+void dmaReserveChannel(DMA_Channel_TypeDef* channel, dmaOwner_e owner)
+{
+    dmaChannel_t *dmaChannel = dmaFindChannel(channel);
+    if (dmaChannel && dmaChannel->owner == DMA_OWNER_NONE) {
+        dmaChannel->owner = owner;
+    }
+}
+
+bool dmaIsChannelFree(const dmaChannel_t* dmaChannel)
+{
+    return dmaChannel->owner == DMA_OWNER_NONE && !dmaChannel->handler;
+}
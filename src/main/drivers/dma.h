@@ -42,10 +42,22 @@ struct dmaCallbackHandler_s {
 #define DMA2Channel5Descriptor  (&dmaChannels[11])
 #endif
 
+// Drivers that run a channel without an interrupt handler claim it with an owner, so later users can tell it is taken
+typedef enum {
+    DMA_OWNER_NONE = 0,
+    DMA_OWNER_ADC,
+    DMA_OWNER_SERIAL,
+    DMA_OWNER_SPI,
+    DMA_OWNER_LED_STRIP,
+    DMA_OWNER_TRANSPONDER,
+    DMA_OWNER_MOTOR
+} dmaOwner_e;
+
 struct dmaChannel_s {
     DMA_TypeDef*                dma;
     DMA_Channel_TypeDef*        channel;
     dmaCallbackHandler_t*       handler;
+    dmaOwner_e                  owner;
     uint8_t                     flagsShift;
     IRQn_Type                   irqn;
     uint32_t                    rcc;
@@ -63,4 +75,7 @@ extern dmaChannel_t dmaChannels[];
 void dmaInit(void);
 void dmaHandlerInit(dmaCallbackHandler_t* handlerRec, dmaCallbackHandlerFunc* handler);
 void dmaSetHandler(dmaChannel_t* dmaChannel, dmaCallbackHandler_t* handler, uint8_t priority);
+dmaChannel_t* dmaFindChannel(DMA_Channel_TypeDef* channel);
+void dmaReserveChannel(DMA_Channel_TypeDef* channel, dmaOwner_e owner);
+bool dmaIsChannelFree(const dmaChannel_t* dmaChannel);
 
@@ -0,0 +1,152 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dshot.h"
+
+typedef struct dshotTimerUse_s {
+    const void *tim;
+    bool dshot;                     // false when a PWM output or input set the timer up first
+    dshotBurst_t burst;
+} dshotTimerUse_t;
+
+static dshotTimerUse_t timerUses[DSHOT_MAX_TRACKED_TIMERS];
+static uint8_t timerUseCount = 0;
+
+static dshotTimerUse_t *findTimerUse(const void *tim)
+{
+    for (int i = 0; i < timerUseCount; i++) {
+        if (timerUses[i].tim == tim) {
+            return &timerUses[i];
+        }
+    }
+    return NULL;
+}
+
+static dshotTimerUse_t *addTimerUse(const void *tim, bool dshot)
+{
+    if (timerUseCount >= DSHOT_MAX_TRACKED_TIMERS) {
+        return NULL;
+    }
+    dshotTimerUse_t *use = &timerUses[timerUseCount++];
+    use->tim = tim;
+    use->dshot = dshot;
+    use->burst.firstChannelIndex = 0;
+    use->burst.length = 0;
+    return use;
+}
+
+/*
+ * A DShot channel can go on a timer nothing else uses yet, or on a DShot timer next to its burst.
+ * The burst writes every compare register from the first to the last DShot channel, so a channel further away
+ * would overwrite the outputs in between.
+ */
+bool dshotTimerAcceptsChannel(const void *tim, uint8_t channelIndex)
+{
+    const dshotTimerUse_t *use = findTimerUse(tim);
+    if (!use) {
+        return timerUseCount < DSHOT_MAX_TRACKED_TIMERS;
+    }
+    if (!use->dshot) {
+        return false;
+    }
+    const uint8_t last = use->burst.firstChannelIndex + use->burst.length - 1;
+    return channelIndex + 1 == use->burst.firstChannelIndex || channelIndex == last + 1;
+}
+
+/*
+ * Marks the timer as DShot and grows its burst by the channel, the caller checks dshotTimerAcceptsChannel() first.
+ * Returns the burst the DMA and buffer layout have to follow.
+ */
+const dshotBurst_t *dshotTimerAddChannel(const void *tim, uint8_t channelIndex)
+{
+    dshotTimerUse_t *use = findTimerUse(tim);
+    if (!use) {
+        use = addTimerUse(tim, true);
+        if (!use) {
+            return NULL;
+        }
+    }
+
+    if (use->burst.length == 0) {
+        use->burst.firstChannelIndex = channelIndex;
+        use->burst.length = 1;
+    } else if (channelIndex < use->burst.firstChannelIndex) {
+        use->burst.length += use->burst.firstChannelIndex - channelIndex;
+        use->burst.firstChannelIndex = channelIndex;
+    } else if (channelIndex >= use->burst.firstChannelIndex + use->burst.length) {
+        use->burst.length = channelIndex - use->burst.firstChannelIndex + 1;
+    }
+    return &use->burst;
+}
+
+/*
+ * Called before a PWM output or input configures a timer, refuses timers running DShot because rewriting the
+ * prescaler and period would break the DShot motors on them.
+ */
+bool dshotClaimTimerForPwm(const void *tim)
+{
+    const dshotTimerUse_t *use = findTimerUse(tim);
+    if (use) {
+        return !use->dshot;
+    }
+    // untracked timers are never DShot, so a full table only stops new DShot timers
+    addTimerUse(tim, false);
+    return true;
+}
+
+/*
+ * Maps a motor pulse width in microseconds onto the DShot throttle range.
+ * Pulses at or below 1ms stop the motor, anything above is spread linearly over 48-2047.
+ */
+uint16_t dshotThrottleFromPulse(uint16_t pulse)
+{
+    if (pulse <= DSHOT_PULSE_MIN) {
+        return DSHOT_CMD_MOTOR_STOP;
+    }
+    if (pulse >= DSHOT_PULSE_MAX) {
+        return DSHOT_MAX_THROTTLE;
+    }
+    return DSHOT_MIN_THROTTLE + ((uint32_t)(pulse - DSHOT_PULSE_MIN) * (DSHOT_MAX_THROTTLE - DSHOT_MIN_THROTTLE)) / (DSHOT_PULSE_MAX - DSHOT_PULSE_MIN);
+}
+
+uint16_t dshotEncodePacket(uint16_t value, bool requestTelemetry)
+{
+    uint16_t packet = (value << 1) | (requestTelemetry ? 1 : 0);
+
+    // xor of the three nibbles of value and telemetry bit
+    uint16_t csum = packet ^ (packet >> 4) ^ (packet >> 8);
+
+    return (packet << 4) | (csum & 0x0f);
+}
+
+/*
+ * Expands a packet into timer compare values, MSB first.
+ * Successive bits are stride entries apart so that several channels of one timer can be interleaved
+ * in a single DMA burst buffer.
+ */
+void dshotEncodeBits(uint16_t packet, uint32_t *dest, uint8_t stride)
+{
+    for (int bit = 0; bit < DSHOT_FRAME_BITS; bit++) {
+        *dest = (packet & 0x8000) ? DSHOT_BIT_COMPARE_1 : DSHOT_BIT_COMPARE_0;
+        dest += stride;
+        packet <<= 1;
+    }
+}
@@ -0,0 +1,80 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// DShot digital ESC protocol.
+//
+// A frame is 16 bits sent MSB first: an 11 bit value, a telemetry request bit and a 4 bit CRC.
+// Values 1-47 are commands, 48-2047 are throttle and 0 stops the motor.
+// Each bit is a fixed length pulse, a 1 is high for 75% of the bit and a 0 for 37.5%.
+
+#define DSHOT_FRAME_BITS            16
+#define DSHOT_FRAME_PAD_BITS        2       // trailing zero length pulses so the line idles low between frames
+#define DSHOT_DMA_BUFFER_SLOTS      (DSHOT_FRAME_BITS + DSHOT_FRAME_PAD_BITS)
+
+#define DSHOT_MIN_THROTTLE          48
+#define DSHOT_MAX_THROTTLE          2047
+
+// motor[] pulse widths that map onto the ends of the throttle range
+#define DSHOT_PULSE_MIN             1000
+#define DSHOT_PULSE_MAX             2000
+
+// DShot600, timer ticks at DSHOT_TIMER_MHZ
+#define DSHOT_TIMER_MHZ             24
+#define DSHOT_BIT_PERIOD            40
+#define DSHOT_BIT_COMPARE_1         30
+#define DSHOT_BIT_COMPARE_0         15
+
+// the ESC only acts on a command after it has been received several times in a row
+#define DSHOT_COMMAND_REPEATS       10
+
+typedef enum {
+    DSHOT_CMD_MOTOR_STOP = 0,
+    DSHOT_CMD_BEEP1,
+    DSHOT_CMD_BEEP2,
+    DSHOT_CMD_BEEP3,
+    DSHOT_CMD_BEEP4,
+    DSHOT_CMD_BEEP5,
+    DSHOT_CMD_ESC_INFO,
+    DSHOT_CMD_SPIN_DIRECTION_1,
+    DSHOT_CMD_SPIN_DIRECTION_2,
+    DSHOT_CMD_3D_MODE_OFF,
+    DSHOT_CMD_3D_MODE_ON,
+    DSHOT_CMD_SETTINGS_REQUEST,
+    DSHOT_CMD_SAVE_SETTINGS,
+    DSHOT_CMD_SPIN_DIRECTION_NORMAL = 20,
+    DSHOT_CMD_SPIN_DIRECTION_REVERSED = 21,
+    DSHOT_CMD_MAX = 47
+} dshotCommand_e;
+
+// A DShot timer runs at DSHOT_TIMER_MHZ and streams its compare registers from DMA, so it cannot share its time
+// base with PWM outputs or inputs. Timers are tracked by address so the rules can be checked without the hardware.
+#define DSHOT_MAX_TRACKED_TIMERS    12
+
+typedef struct dshotBurst_s {
+    uint8_t firstChannelIndex;      // CCR register the burst starts at, 0 = CCR1
+    uint8_t length;                 // CCR registers written per burst
+} dshotBurst_t;
+
+bool dshotTimerAcceptsChannel(const void *tim, uint8_t channelIndex);
+const dshotBurst_t *dshotTimerAddChannel(const void *tim, uint8_t channelIndex);
+bool dshotClaimTimerForPwm(const void *tim);
+
+uint16_t dshotThrottleFromPulse(uint16_t pulse);
+uint16_t dshotEncodePacket(uint16_t value, bool requestTelemetry);
+void dshotEncodeBits(uint16_t packet, uint32_t *dest, uint8_t stride);
@@ -52,7 +52,7 @@
 #define JEDEC_ID_WINBOND_W25Q128       0xEF4018
 
 #define DISABLE_M25P16       GPIO_SetBits(M25P16_CS_GPIO,   M25P16_CS_PIN)
-#define ENABLE_M25P16        GPIO_ResetBits(M25P16_CS_GPIO, M25P16_CS_PIN)
+#define ENABLE_M25P16        do { spiQueueWaitIdle(M25P16_SPI_INSTANCE); GPIO_ResetBits(M25P16_CS_GPIO, M25P16_CS_PIN); } while (0)
 
 // The timeout we expect between being able to issue page program instructions
 #define DEFAULT_TIMEOUT_MILLIS       6
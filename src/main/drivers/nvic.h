@@ -11,8 +11,9 @@
 #define NVIC_PRIO_MPU_INT_EXTI             NVIC_BUILD_PRIORITY(0x0f, 0x0f)
 #define NVIC_PRIO_MAG_INT_EXTI             NVIC_BUILD_PRIORITY(0x0f, 0x0f)
 #define NVIC_PRIO_WS2811_DMA               NVIC_BUILD_PRIORITY(1, 2)  // TODO - is there some reason to use high priority? (or to use DMA IRQ at all?)
+#define NVIC_PRIO_DSHOT_DMA                NVIC_BUILD_PRIORITY(1, 2)
 #define NVIC_PRIO_TRANSPONDER_DMA          NVIC_BUILD_PRIORITY(3, 0)
-#define NVIC_PRIO_MAX7456_DMA              NVIC_BUILD_PRIORITY(3, 0)
+#define NVIC_PRIO_SPI_DMA                  NVIC_BUILD_PRIORITY(1, 0)
 #define NVIC_PRIO_SERIALUART1_TXDMA       NVIC_BUILD_PRIORITY(1, 1)
 #define NVIC_PRIO_SERIALUART1_RXDMA       NVIC_BUILD_PRIORITY(1, 1)
 #define NVIC_PRIO_SERIALUART1             NVIC_BUILD_PRIORITY(1, 1)
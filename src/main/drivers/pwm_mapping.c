@@ -22,6 +22,8 @@
 
 #include <platform.h>
 
+#include "common/utils.h"
+
 #include "config/parameter_group.h"
 
 #include "gpio.h"
@@ -31,6 +33,9 @@
 #include "pwm_output.h"
 #include "pwm_rx.h"
 #include "pwm_mapping.h"
+#ifdef USE_DSHOT
+#include "dshot.h"
+#endif
 
 #ifdef STM32F10X
 #include "serial_uart_stm32f10x.h"
@@ -42,6 +47,9 @@
 void pwmBrushedMotorConfig(const timerHardware_t *timerHardware, uint8_t motorIndex, uint16_t motorPwmRate, uint16_t idlePulse);
 void pwmBrushlessMotorConfig(const timerHardware_t *timerHardware, uint8_t motorIndex, uint16_t motorPwmRate, uint16_t idlePulse);
 void pwmOneshotMotorConfig(const timerHardware_t *timerHardware, uint8_t motorIndex);
+#ifdef USE_DSHOT
+bool pwmDshotMotorConfig(const timerHardware_t *timerHardware, uint8_t motorIndex);
+#endif
 void pwmServoConfig(const timerHardware_t *timerHardware, uint8_t servoIndex, uint16_t servoPwmRate, uint16_t servoCenterPulse);
 
 /*
@@ -683,6 +691,17 @@ pwmIOConfiguration_t *pwmGetOutputConfiguration(void){
     return &pwmIOConfiguration;
 }
 
+// PWM outputs and inputs set the prescaler and period of their timer, which must not happen to a timer running DShot
+static bool isTimerFreeForPwm(const timerHardware_t *timerHardware)
+{
+#ifdef USE_DSHOT
+    return dshotClaimTimerForPwm(timerHardware->tim);
+#else
+    UNUSED(timerHardware);
+    return true;
+#endif
+}
+
 pwmIOConfiguration_t *pwmInit(drv_pwm_config_t *init)
 {
     int i = 0;
@@ -922,6 +941,9 @@ pwmIOConfiguration_t *pwmInit(drv_pwm_config_t *init)
 #endif
 
         if (type == MAP_TO_PPM_INPUT) {
+            if (!isTimerFreeForPwm(timerHardwarePtr)) {
+                continue;
+            }
 #if defined(SPARKY) || defined(ALIENFLIGHTF3)
             if (init->useOneshot || isMotorBrushed(init->motorPwmRate)) {
                 ppmAvoidPWMTimerClash(timerHardwarePtr, TIM2);
@@ -931,6 +953,9 @@ pwmIOConfiguration_t *pwmInit(drv_pwm_config_t *init)
             pwmIOConfiguration.ioConfigurations[pwmIOConfiguration.ioCount].flags = PWM_PF_PPM;
             pwmIOConfiguration.ppmInputCount++;
         } else if (type == MAP_TO_PWM_INPUT) {
+            if (!isTimerFreeForPwm(timerHardwarePtr)) {
+                continue;
+            }
             pwmInConfig(timerHardwarePtr, channelIndex);
             pwmIOConfiguration.ioConfigurations[pwmIOConfiguration.ioCount].flags = PWM_PF_PWM;
             pwmIOConfiguration.pwmInputCount++;
@@ -943,7 +968,20 @@ pwmIOConfiguration_t *pwmInit(drv_pwm_config_t *init)
             		continue;
             }
 #endif
-            if (init->useOneshot) {
+#ifdef USE_DSHOT
+            // falls back to PWM when the timer has no free update DMA channel or already drives PWM outputs,
+            // a motor that can neither join nor share a DShot timer is left unused
+            if (init->useDshot && pwmDshotMotorConfig(timerHardwarePtr, pwmIOConfiguration.motorCount)) {
+
+                pwmIOConfiguration.ioConfigurations[pwmIOConfiguration.ioCount].flags = PWM_PF_MOTOR | PWM_PF_OUTPUT_PROTOCOL_DSHOT;
+
+            } else
+#endif
+            if (!isTimerFreeForPwm(timerHardwarePtr)) {
+
+                continue;
+
+            } else if (init->useOneshot) {
 
                 pwmOneshotMotorConfig(timerHardwarePtr, pwmIOConfiguration.motorCount);
                 pwmIOConfiguration.ioConfigurations[pwmIOConfiguration.ioCount].flags = PWM_PF_MOTOR | PWM_PF_OUTPUT_PROTOCOL_ONESHOT|PWM_PF_OUTPUT_PROTOCOL_PWM;
@@ -966,6 +1004,9 @@ pwmIOConfiguration_t *pwmInit(drv_pwm_config_t *init)
 
         } else if (type == MAP_TO_SERVO_OUTPUT) {
 #ifdef USE_SERVOS
+            if (!isTimerFreeForPwm(timerHardwarePtr)) {
+                continue;
+            }
             pwmServoConfig(timerHardwarePtr, pwmIOConfiguration.servoCount, init->servoPwmRate, init->servoCenterPulse);
 
             pwmIOConfiguration.ioConfigurations[pwmIOConfiguration.ioCount].flags = PWM_PF_SERVO | PWM_PF_OUTPUT_PROTOCOL_PWM;
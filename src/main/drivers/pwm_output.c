@@ -23,23 +23,47 @@
 #include <platform.h>
 
 #include "gpio.h"
+#include "system.h"
 #include "timer.h"
+#include "dma.h"
+#include "nvic.h"
+#include "dshot.h"
 
 #include "pwm_mapping.h"
 
 #include "pwm_output.h"
 
 #include "common/maths.h"
+#include "common/utils.h"
 
 #define MAX_PWM_OUTPUT_PORTS MAX(MAX_MOTORS, MAX_SERVOS)
 
 typedef void (*pwmWriteFuncPtr)(uint8_t index, uint16_t value);  // function pointer used to write motors
 
+#ifdef USE_DSHOT
+// all DShot channels of a timer are refreshed by one DMA burst per bit into the CCR registers
+typedef struct dshotTimer_s {
+    TIM_TypeDef *tim;
+    dmaChannel_t *dma;
+    dmaCallbackHandler_t dmaHandler;
+    uint8_t firstChannelIndex;      // CCR register the burst starts at, 0 = CCR1
+    uint8_t burstLength;            // CCR registers written per burst
+    volatile bool transferInProgress;
+    uint32_t dmaBuffer[DSHOT_DMA_BUFFER_SLOTS * 4];
+} dshotTimer_t;
+#endif
+
 typedef struct {
     volatile timCCR_t *ccr;
     TIM_TypeDef *tim;
     uint16_t period;
     pwmWriteFuncPtr pwmWritePtr;
+#ifdef USE_DSHOT
+    dshotTimer_t *dshotTimer;
+    uint8_t dshotChannelIndex;
+    uint8_t dshotCommand;
+    uint8_t dshotCommandRepeats;
+#endif
 } pwmOutputPort_t;
 
 static pwmOutputPort_t pwmOutputPorts[MAX_PWM_OUTPUT_PORTS];
@@ -52,7 +76,20 @@ static pwmOutputPort_t *servos[MAX_PWM_SERVOS];
 
 static uint8_t allocatedOutputPortCount = 0;
 
+// timers with motor or servo channels whose compare registers are latched together, see pwmOutputBeginUpdate()
+static TIM_TypeDef *outputTimers[MAX_PWM_OUTPUT_PORTS];
+static uint8_t outputTimerCount = 0;
+static uint32_t outputCommitTime = 0;
+
 static bool pwmMotorsEnabled = true;
+
+#ifdef USE_DSHOT
+#define MAX_DSHOT_TIMERS 4
+
+static dshotTimer_t dshotTimers[MAX_DSHOT_TIMERS];
+static uint8_t dshotTimerCount = 0;
+#endif
+
 static void pwmOCConfig(TIM_TypeDef *tim, uint8_t channel, uint16_t value)
 {
     TIM_OCInitTypeDef  TIM_OCInitStructure;
@@ -128,6 +165,48 @@ static pwmOutputPort_t *pwmOutConfig(const timerHardware_t *timerHardware, uint8
     return p;
 }
 
+static void pwmRegisterOutputTimer(TIM_TypeDef *tim)
+{
+    for (int i = 0; i < outputTimerCount; i++) {
+        if (outputTimers[i] == tim) {
+            return;
+        }
+    }
+    outputTimers[outputTimerCount++] = tim;
+}
+
+/*
+ * Holds back the update event on every output timer while a frame of motor and servo values is written.
+ * CCR writes go to the preload registers, so with updates disabled no channel can switch to its new value
+ * before the others have been written.
+ *
+ * A timer shared with PPM or PWM input capture counts its overflows in the update interrupt, holding back its
+ * update event would lose them and corrupt the captured pulse widths, so its outputs are written unstaged.
+ */
+void pwmOutputBeginUpdate(void)
+{
+    for (int i = 0; i < outputTimerCount; i++) {
+        if (outputTimers[i]->DIER & TIM_IT_Update) {
+            continue;
+        }
+        TIM_UpdateDisableConfig(outputTimers[i], ENABLE);
+    }
+}
+
+// releases the frame, all channels of a timer take their new values on its next update event
+void pwmOutputCommitUpdate(void)
+{
+    for (int i = 0; i < outputTimerCount; i++) {
+        TIM_UpdateDisableConfig(outputTimers[i], DISABLE);
+    }
+    outputCommitTime = micros();
+}
+
+uint32_t pwmGetOutputCommitTime(void)
+{
+    return outputCommitTime;
+}
+
 static void pwmWriteBrushed(uint8_t index, uint16_t value)
 {
     *motors[index]->ccr = (value - 1000) * motors[index]->period / 1000;
@@ -194,6 +273,7 @@ void pwmBrushedMotorConfig(const timerHardware_t *timerHardware, uint8_t motorIn
     uint32_t hz = PWM_BRUSHED_TIMER_MHZ * 1000000;
     motors[motorIndex] = pwmOutConfig(timerHardware, PWM_BRUSHED_TIMER_MHZ, hz / motorPwmRate, idlePulse);
     motors[motorIndex]->pwmWritePtr = pwmWriteBrushed;
+    pwmRegisterOutputTimer(timerHardware->tim);
 }
 
 void pwmBrushlessMotorConfig(const timerHardware_t *timerHardware, uint8_t motorIndex, uint16_t motorPwmRate, uint16_t idlePulse)
@@ -201,18 +281,194 @@ void pwmBrushlessMotorConfig(const timerHardware_t *timerHardware, uint8_t motor
     uint32_t hz = PWM_TIMER_MHZ * 1000000;
     motors[motorIndex] = pwmOutConfig(timerHardware, PWM_TIMER_MHZ, hz / motorPwmRate, idlePulse);
     motors[motorIndex]->pwmWritePtr = pwmWriteStandard;
+    pwmRegisterOutputTimer(timerHardware->tim);
 }
 
 void pwmOneshotMotorConfig(const timerHardware_t *timerHardware, uint8_t motorIndex)
 {
     motors[motorIndex] = pwmOutConfig(timerHardware, ONESHOT125_TIMER_MHZ, 0xFFFF, 0);
     motors[motorIndex]->pwmWritePtr = pwmWriteStandard;
+    pwmRegisterOutputTimer(timerHardware->tim);
+}
+
+#ifdef USE_DSHOT
+// DMA channel serving the update event of each timer, see the DMA request mapping in the reference manual
+static dmaChannel_t *timerUpdateDMADescriptor(TIM_TypeDef *tim)
+{
+    if (tim == TIM1) {
+        return DMA1Channel5Descriptor;
+    }
+    if (tim == TIM2) {
+        return DMA1Channel2Descriptor;
+    }
+    if (tim == TIM3) {
+        return DMA1Channel3Descriptor;
+    }
+    if (tim == TIM4) {
+        return DMA1Channel7Descriptor;
+    }
+#ifdef STM32F303
+    if (tim == TIM8) {
+        return DMA2Channel1Descriptor;
+    }
+    if (tim == TIM15) {
+        return DMA1Channel5Descriptor;
+    }
+    if (tim == TIM16) {
+        return DMA1Channel3Descriptor;
+    }
+    if (tim == TIM17) {
+        return DMA1Channel1Descriptor;
+    }
+#endif
+    return NULL;
+}
+
+static void dshotDMAHandler(dmaChannel_t *descriptor, dmaCallbackHandler_t *handler)
+{
+    dshotTimer_t *dshotTimer = container_of(handler, dshotTimer_t, dmaHandler);
+
+    if (DMA_GET_FLAG_STATUS(descriptor, DMA_IT_TCIF)) {
+        DMA_Cmd(descriptor->channel, DISABLE);
+        DMA_CLEAR_FLAG(descriptor, DMA_IT_TCIF);
+        dshotTimer->transferInProgress = false;
+    }
+}
+
+static dshotTimer_t *dshotTimerConfig(TIM_TypeDef *tim)
+{
+    for (int i = 0; i < dshotTimerCount; i++) {
+        if (dshotTimers[i].tim == tim) {
+            return &dshotTimers[i];
+        }
+    }
+
+    if (dshotTimerCount >= MAX_DSHOT_TIMERS) {
+        return NULL;
+    }
+
+    dmaChannel_t *dma = timerUpdateDMADescriptor(tim);
+    if (!dma || !dmaIsChannelFree(dma)) {
+        // no update DMA on this timer, or the channel is already used or reserved by another timer or driver
+        return NULL;
+    }
+
+    dshotTimer_t *dshotTimer = &dshotTimers[dshotTimerCount++];
+    dshotTimer->tim = tim;
+    dshotTimer->dma = dma;
+    dma->owner = DMA_OWNER_MOTOR;
+
+    dmaHandlerInit(&dshotTimer->dmaHandler, dshotDMAHandler);
+    dmaSetHandler(dma, &dshotTimer->dmaHandler, NVIC_PRIO_DSHOT_DMA);
+
+    DMA_InitTypeDef DMA_InitStructure;
+
+    DMA_DeInit(dma->channel);
+    DMA_StructInit(&DMA_InitStructure);
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&tim->DMAR;
+    DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)dshotTimer->dmaBuffer;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralDST;
+    DMA_InitStructure.DMA_BufferSize = 0;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Word;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Word;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+    DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+    DMA_Init(dma->channel, &DMA_InitStructure);
+
+    DMA_ITConfig(dma->channel, DMA_IT_TC, ENABLE);
+    TIM_DMACmd(tim, TIM_DMA_Update, ENABLE);
+
+    return dshotTimer;
 }
 
+static void pwmWriteDshot(uint8_t index, uint16_t value)
+{
+    pwmOutputPort_t *motor = motors[index];
+    dshotTimer_t *dshotTimer = motor->dshotTimer;
+
+    if (dshotTimer->transferInProgress) {
+        // previous frame is still on the wire, drop this update rather than corrupt it
+        return;
+    }
+
+    uint16_t packet;
+    if (motor->dshotCommandRepeats) {
+        motor->dshotCommandRepeats--;
+        packet = dshotEncodePacket(motor->dshotCommand, true);
+    } else {
+        packet = dshotEncodePacket(dshotThrottleFromPulse(value), false);
+    }
+
+    dshotEncodeBits(packet, &dshotTimer->dmaBuffer[motor->dshotChannelIndex - dshotTimer->firstChannelIndex], dshotTimer->burstLength);
+}
+
+/*
+ * Queues a DShot command in place of the throttle value for the next DSHOT_COMMAND_REPEATS updates.
+ * The ESC ignores commands while the motor is running, only use this while disarmed.
+ */
+void pwmWriteDshotCommand(uint8_t index, uint8_t command)
+{
+    if (index < MAX_MOTORS && motors[index] && motors[index]->dshotTimer && command <= DSHOT_CMD_MAX) {
+        motors[index]->dshotCommand = command;
+        motors[index]->dshotCommandRepeats = DSHOT_COMMAND_REPEATS;
+    }
+}
+
+void pwmCompleteDshotMotorUpdate(void)
+{
+    if (!pwmMotorsEnabled) {
+        return;
+    }
+
+    for (int i = 0; i < dshotTimerCount; i++) {
+        dshotTimer_t *dshotTimer = &dshotTimers[i];
+
+        if (dshotTimer->transferInProgress) {
+            continue;
+        }
+
+        dshotTimer->transferInProgress = true;
+        DMA_SetCurrDataCounter(dshotTimer->dma->channel, dshotTimer->burstLength * DSHOT_DMA_BUFFER_SLOTS);
+        DMA_Cmd(dshotTimer->dma->channel, ENABLE);
+    }
+}
+
+bool pwmDshotMotorConfig(const timerHardware_t *timerHardware, uint8_t motorIndex)
+{
+    const uint8_t channelIndex = timerHardware->channel >> 2;    // TIM_Channel_x is 4 * (x - 1)
+    if (!dshotTimerAcceptsChannel(timerHardware->tim, channelIndex)) {
+        return false;
+    }
+
+    dshotTimer_t *dshotTimer = dshotTimerConfig(timerHardware->tim);
+    if (!dshotTimer) {
+        return false;
+    }
+    const dshotBurst_t *burst = dshotTimerAddChannel(timerHardware->tim, channelIndex);
+
+    motors[motorIndex] = pwmOutConfig(timerHardware, DSHOT_TIMER_MHZ, DSHOT_BIT_PERIOD, 0);
+    motors[motorIndex]->pwmWritePtr = pwmWriteDshot;
+    motors[motorIndex]->dshotTimer = dshotTimer;
+    motors[motorIndex]->dshotChannelIndex = channelIndex;
+
+    // the buffer layout follows the burst
+    dshotTimer->firstChannelIndex = burst->firstChannelIndex;
+    dshotTimer->burstLength = burst->length;
+
+    TIM_DMAConfig(timerHardware->tim, TIM_DMABase_CCR1 + burst->firstChannelIndex, (burst->length - 1) << 8);
+
+    return true;
+}
+#endif
+
 #ifdef USE_SERVOS
 void pwmServoConfig(const timerHardware_t *timerHardware, uint8_t servoIndex, uint16_t servoPwmRate, uint16_t servoCenterPulse)
 {
     servos[servoIndex] = pwmOutConfig(timerHardware, PWM_TIMER_MHZ, 1000000 / servoPwmRate, servoCenterPulse);
+    pwmRegisterOutputTimer(timerHardware->tim);
 }
 
 void pwmWriteServo(uint8_t index, uint16_t value)
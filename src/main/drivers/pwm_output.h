@@ -20,9 +20,17 @@
 void pwmWriteMotor(uint8_t index, uint16_t value);
 void pwmShutdownPulsesForAllMotors(uint8_t motorCount);
 void pwmCompleteOneshotMotorUpdate(uint8_t motorCount);
+#ifdef USE_DSHOT
+void pwmCompleteDshotMotorUpdate(void);
+void pwmWriteDshotCommand(uint8_t index, uint8_t command);
+#endif
 
 void pwmWriteServo(uint8_t index, uint16_t value);
 
+void pwmOutputBeginUpdate(void);
+void pwmOutputCommitUpdate(void);
+uint32_t pwmGetOutputCommitTime(void);
+
 bool isMotorBrushed(uint16_t motorPwmRate);
 
 void pwmDisableMotors(void);
@@ -108,12 +108,11 @@ typedef struct sdcard_t {
 
 static sdcard_t sdcard;
 
-#ifdef SDCARD_DMA_CHANNEL_TX
-    static bool useDMAForTx;
-#else
-    // DMA channel not available so we can hard-code this to allow the non-DMA paths to be stripped by optimization
-    static const bool useDMAForTx = false;
-#endif
+static bool useDMAForTx;
+
+// The card stays selected from the write command to the data response, so the driver selects it itself.
+static const spiDevice_t sdcardSpiDevice = { SDCARD_SPI_INSTANCE, NULL, 0 };
+static spiTransaction_t sdcardBlockTransaction;
 
 STATIC_ASSERT(sizeof(sdcardCSD_t) == 16, sdcard_csd_bitfields_didnt_pack_properly);
 
@@ -413,29 +412,13 @@ static void sdcard_sendDataBlockBegin(uint8_t *buffer, bool multiBlockWrite)
 
     if (useDMAForTx) {
         // Queue the transmission of the sector payload
-        DMA_InitTypeDef DMA_InitStructure;
-
-        DMA_StructInit(&DMA_InitStructure);
-        DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t) &SDCARD_SPI_INSTANCE->DR;
-        DMA_InitStructure.DMA_Priority = DMA_Priority_Low;
-        DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
-        DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
-        DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
-
-        DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
-        DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t) buffer;
-        DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+        sdcardBlockTransaction.device = &sdcardSpiDevice;
+        sdcardBlockTransaction.txBuf = buffer;
+        sdcardBlockTransaction.rxBuf = NULL;
+        sdcardBlockTransaction.len = SDCARD_BLOCK_SIZE;
+        sdcardBlockTransaction.priority = SPI_PRIORITY_BULK;
 
-        DMA_InitStructure.DMA_BufferSize = SDCARD_BLOCK_SIZE;
-        DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralDST;
-        DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
-
-        DMA_DeInit(SDCARD_DMA_CHANNEL_TX);
-        DMA_Init(SDCARD_DMA_CHANNEL_TX, &DMA_InitStructure);
-
-        DMA_Cmd(SDCARD_DMA_CHANNEL_TX, ENABLE);
-
-        SPI_I2S_DMACmd(SDCARD_SPI_INSTANCE, SPI_I2S_DMAReq_Tx, ENABLE);
+        spiQueueTransaction(&sdcardBlockTransaction);
     } else {
         // Send the first chunk now
         spiTransfer(SDCARD_SPI_INSTANCE, NULL, buffer, SDCARD_NON_DMA_CHUNK_SIZE);
@@ -530,12 +513,7 @@ static bool sdcard_checkInitDone(void)
  */
 void sdcard_init(bool useDMA)
 {
-#ifdef SDCARD_DMA_CHANNEL_TX
-    useDMAForTx = useDMA;
-#else
-    // DMA is not available
-    (void) useDMA;
-#endif
+    useDMAForTx = useDMA && spiHasDma(SDCARD_SPI_INSTANCE);
 
     // Max frequency is initially 400kHz
     spiSetDivisor(SDCARD_SPI_INSTANCE, SDCARD_SPI_INITIALIZATION_CLOCK_DIVIDER);
@@ -704,22 +682,8 @@ bool sdcard_poll(void)
             // Have we finished sending the write yet?
             sendComplete = false;
 
-            if (useDMAForTx && DMA_GetFlagStatus(SDCARD_DMA_CHANNEL_TX_COMPLETE_FLAG) == SET) {
-                DMA_ClearFlag(SDCARD_DMA_CHANNEL_TX_COMPLETE_FLAG);
-
-                DMA_Cmd(SDCARD_DMA_CHANNEL_TX, DISABLE);
-
-                // Drain anything left in the Rx FIFO (we didn't read it during the write)
-                while (SPI_I2S_GetFlagStatus(SDCARD_SPI_INSTANCE, SPI_I2S_FLAG_RXNE) == SET) {
-                    SDCARD_SPI_INSTANCE->DR;
-                }
-
-                // Wait for the final bit to be transmitted
-                while (spiIsBusBusy(SDCARD_SPI_INSTANCE)) {
-                }
-
-                SPI_I2S_DMACmd(SDCARD_SPI_INSTANCE, SPI_I2S_DMAReq_Tx, DISABLE);
-
+            // The bus driver drains the Rx FIFO and waits for the final bit before it completes the transaction
+            if (useDMAForTx && sdcardBlockTransaction.state != SPI_TRANSACTION_QUEUED) {
                 sendComplete = true;
             }
 
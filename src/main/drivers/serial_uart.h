@@ -58,6 +58,7 @@ typedef struct {
 serialPort_t *uartOpen(USART_TypeDef *USARTx, serialReceiveCallbackPtr callback, uint32_t baudRate, portMode_t mode, portOptions_t options);
 
 void usartInitAllIOSignals(void);
+void uartReserveDmaChannels(void);
 
 // serialPort API
 void uartWrite(serialPort_t *instance, uint8_t ch);
@@ -94,6 +94,17 @@ void usartIrqHandler(uartPort_t *s)
     }
 }
 
+// Claims the DMA channels the ports take when they are opened, which is after the motors are set up
+void uartReserveDmaChannels(void)
+{
+#ifdef USE_UART1
+#ifdef USE_UART1_RX_DMA
+    dmaReserveChannel(DMA1_Channel5, DMA_OWNER_SERIAL);
+#endif
+    dmaReserveChannel(DMA1_Channel4, DMA_OWNER_SERIAL);
+#endif
+}
+
 #ifdef USE_UART1
 
 // UART1 Tx DMA Handler
@@ -81,6 +81,29 @@ static void handleUsartTxDma(dmaChannel_t* descriptor, dmaCallbackHandler_t* han
 }
 #endif
 
+// Claims the DMA channels the ports take when they are opened, which is after the motors are set up
+void uartReserveDmaChannels(void)
+{
+#ifdef USE_UART1_RX_DMA
+    dmaReserveChannel(DMA1_Channel5, DMA_OWNER_SERIAL);
+#endif
+#ifdef USE_UART1_TX_DMA
+    dmaReserveChannel(DMA1_Channel4, DMA_OWNER_SERIAL);
+#endif
+#ifdef USE_UART2_RX_DMA
+    dmaReserveChannel(DMA1_Channel6, DMA_OWNER_SERIAL);
+#endif
+#ifdef USE_UART2_TX_DMA
+    dmaReserveChannel(DMA1_Channel7, DMA_OWNER_SERIAL);
+#endif
+#ifdef USE_UART3_RX_DMA
+    dmaReserveChannel(DMA1_Channel3, DMA_OWNER_SERIAL);
+#endif
+#ifdef USE_UART3_TX_DMA
+    dmaReserveChannel(DMA1_Channel2, DMA_OWNER_SERIAL);
+#endif
+}
+
 #ifdef USE_UART1
 uartPort_t *serialUART1(uint32_t baudRate, portMode_t mode, portOptions_t options)
 {
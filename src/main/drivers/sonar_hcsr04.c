@@ -41,6 +41,7 @@
 
 #if defined(SONAR)
 STATIC_UNIT_TESTED volatile int32_t measurement = -1;
+static volatile uint32_t measurementTime;
 static uint32_t lastMeasurementAt;
 static sonarHardware_t const *sonarHardware;
 
@@ -60,6 +61,7 @@ void hcsr04_extiHandler(extiCallbackRec_t* cb)
         timing_stop = micros();
         if (timing_stop > timing_start) {
             measurement = timing_stop - timing_start;
+            measurementTime = timing_start + measurement / 2; // the pulse reached the ground half way
         }
     }
 }
@@ -136,4 +138,12 @@ int32_t hcsr04_get_distance(void)
 
     return distance;
 }
+
+/**
+ * Get the time in microseconds the last distance was measured at, it changes with every new measurement.
+ */
+uint32_t hcsr04_get_measurement_time(void)
+{
+    return measurementTime;
+}
 #endif
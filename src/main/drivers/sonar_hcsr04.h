@@ -46,3 +46,4 @@ typedef struct sonarRange_s {
 void hcsr04_init(const sonarHardware_t *sonarHardware, sonarRange_t *sonarRange);
 void hcsr04_start_reading(void);
 int32_t hcsr04_get_distance(void);
+uint32_t hcsr04_get_measurement_time(void);
@@ -23,13 +23,14 @@
 
 #include "build/debug.h"
 
-#include "drivers/dma.h"
 #include "drivers/io.h"
 #include "drivers/exti.h"
 #include "drivers/nvic.h"
 #include "drivers/video.h"
 #include "drivers/video_textscreen.h"
 #include "drivers/video_max7456.h"
+#include "drivers/video_max7456_registers.h"
+#include "drivers/video_max7456_update.h"
 #include "drivers/bus_spi.h"
 #include "drivers/gpio.h"
 #include "drivers/light_led.h"
@@ -38,83 +39,6 @@
 
 #include "osd/fonts/font_max7456_12x18.h"
 
-#define MAX7456_MODE_MASK_PAL 0x40
-#define MAX7456_CENTER_PAL 0x8
-
-#define MAX7456_MODE_MASK_NTSC 0x00
-#define MAX7456_CENTER_NTSC 0x6
-
-#define MAX7456_SHADOW_TO_NVM_MASK 0xA0
-
-//MAX7456 read addresses
-#define MAX7456_REG_OSDBL_READ 0xec //black level
-#define MAX7456_REG_STAT_READ  0xa0 //0xa[X] Status
-#define MAX7456_REG_VM0_READ  0x80
-#define MAX7456_REG_DMM_READ   0x84
-
-//MAX7456 write addresses
-#define MAX7456_REG_VM0   0x00
-#define MAX7456_REG_VM1   0x01
-#define MAX7456_REG_DMM   0x04
-#define MAX7456_REG_DMAH  0x05
-#define MAX7456_REG_DMAL  0x06
-#define MAX7456_REG_DMDI  0x07
-#define MAX7456_REG_OSDM  0x0c
-#define MAX7456_REG_OSDBL 0x6c // WARNING - see datasheet before writing to this register, there are factory preset bits.
-
-//MAX7456 write addresses
-#define MAX7456_REG_CMM   0x08
-#define MAX7456_REG_CMAH  0x09
-#define MAX7456_REG_CMAL  0x0a
-#define MAX7456_REG_CMDI  0x0b
-#define MAX7456_REG_CMDO  0xc0
-
-#define MAX7456_REG_RB0          0x10
-#define MAX7456_REG_RB1          0x11
-#define MAX7456_REG_RB2          0x12
-#define MAX7456_REG_RB3          0x13
-#define MAX7456_REG_RB4          0x14
-#define MAX7456_REG_RB5          0x15
-#define MAX7456_REG_RB6          0x16
-#define MAX7456_REG_RB7          0x17
-#define MAX7456_REG_RB8          0x18
-#define MAX7456_REG_RB9          0x19
-#define MAX7456_REG_RB10         0x1a
-#define MAX7456_REG_RB11         0x1b
-#define MAX7456_REG_RB12         0x1c
-#define MAX7456_REG_RB13         0x1d
-#define MAX7456_REG_RB14         0x1e
-#define MAX7456_REG_RB15         0x1f
-
-#define MAX7456_VM0_BIT_VIDEO_BUFFER_DISABLE    (0 << 0)
-#define MAX7456_VM0_BIT_VIDEO_BUFFER_ENABLE     (1 << 0)
-#define MAX7456_VM0_BIT_SOFTWARE_RESET          (1 << 1)
-#define MAX7456_VM0_BIT_VSYNC_DISABLE           (0 << 2)
-#define MAX7456_VM0_BIT_VSYNC_ENABLE            (1 << 2)
-#define MAX7456_VM0_BIT_OSD_DISABLE             (0 << 3)
-#define MAX7456_VM0_BIT_OSD_ENABLE              (1 << 3)
-#define MAX7456_VM0_BIT_SYNC_MODE_EXTERNAL      ((1 << 5) | (0 << 4))
-#define MAX7456_VM0_BIT_SYNC_MODE_INTERNAL      ((1 << 5) | (1 << 4))
-#define MAX7456_VM0_BIT_VIDEO_MODE_PAL          (0 << 6)
-#define MAX7456_VM0_BIT_VIDEO_MODE_NTSC         (1 << 6)
-
-#define MAX7456_STAT_BIT_PAL_DETECTED           (1 << 0)
-#define MAX7456_STAT_BIT_NTSC_DETECTED          (1 << 1)
-#define MAX7456_STAT_BIT_LOS_OF_SYNC            (1 << 2)
-#define MAX7456_STAT_BIT_HSYNC_INACTIVE         (1 << 3)
-#define MAX7456_STAT_BIT_VSYNC_INACTIVE         (1 << 4)
-#define MAX7456_STAT_BIT_CHAR_MEM_BUSY          (1 << 5)
-#define MAX7456_STAT_BIT_RESET_MODE             (1 << 6)
-#define MAX7456_STAT_BIT_NA                     (1 << 7)
-
-#define MAX7456_DMM_BIT_8BIT_ENABLE             (1 << 6) // 16 bit when disabled
-#define MAX7456_DMM_BIT_LBC                     (1 << 5) // only when in 16 bit mode
-#define MAX7456_DMM_BIT_BLINK                   (1 << 4) // only when in 16 bit mode
-#define MAX7456_DMM_BIT_INVERT                  (1 << 3) // only when in 16 bit mode
-#define MAX7456_DMM_BIT_CLEAR                   (1 << 2)
-#define MAX7456_DMM_BIT_VSYNC_CLEAR             (1 << 1)
-#define MAX7456_DMM_BIT_AUTO_INCREMENT          (1 << 0)
-
 #ifndef WHITEBRIGHTNESS
   #define WHITEBRIGHTNESS 0x01
 #endif
@@ -124,9 +48,9 @@
 
 #define BWBRIGHTNESS(black, white) ((black << 2) | white)
 
-#ifdef MAX7456_DMA_CHANNEL_TX
-dmaCallbackHandler_t dmaTxHandler;
-volatile uint8_t dma_transaction_in_progress = 0;
+#ifdef USE_MAX7456_DMA
+static const spiDevice_t max7456SpiDevice = { MAX7456_SPI_INSTANCE, MAX7456_CS_GPIO, MAX7456_CS_PIN };
+static spiTransaction_t max7456Transaction;
 #endif
 
 uint8_t max7456_videoModeMask;
@@ -137,6 +61,8 @@ uint8_t max7456_videoModeMask;
 textScreen_t max7456Screen;
 max7456State_t max7456State;
 
+static max7456Display_t max7456Display;
+
 static extiCallbackRec_t losExtiCallbackRec;
 static IO_t losIO;
 static extiCallbackRec_t vsyncExtiCallbackRec;
@@ -235,122 +161,30 @@ textScreen_t *max7456_getTextScreen(void)
 }
 
 
-#ifdef MAX7456_DMA_CHANNEL_TX
-static void max7456_writeDMA(void* tx_buffer, void* rx_buffer, uint16_t buffer_size)
+static void max7456_waitForDMAToComplete(void)
 {
-    DMA_InitTypeDef DMA_InitStructure;
-#ifdef MAX7456_DMA_CHANNEL_RX
-    static uint16_t dummy[] = {0xffff};
-#else
-    UNUSED(rx_buffer);
-#endif
-    while (dma_transaction_in_progress); // Wait for prev DMA transaction
-
-    // Enable SPI TX/RX request
-    ENABLE_MAX7456;
-
-    DMA_DeInit(MAX7456_DMA_CHANNEL_TX);
-#ifdef MAX7456_DMA_CHANNEL_RX
-    DMA_DeInit(MAX7456_DMA_CHANNEL_RX);
-#endif
-
-    // Common to both channels
-    DMA_StructInit(&DMA_InitStructure);
-    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)(&(MAX7456_SPI_INSTANCE->DR));
-    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
-    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
-    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
-    DMA_InitStructure.DMA_BufferSize = buffer_size;
-    DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
-    DMA_InitStructure.DMA_Priority = DMA_Priority_Low;
-
-#ifdef MAX7456_DMA_CHANNEL_RX
-    // Rx Channel
-    DMA_InitStructure.DMA_MemoryBaseAddr = rx_buffer ? (uint32_t)rx_buffer : (uint32_t)(dummy);
-    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
-    DMA_InitStructure.DMA_MemoryInc = rx_buffer ? DMA_MemoryInc_Enable : DMA_MemoryInc_Disable;
-
-    DMA_Init(MAX7456_DMA_CHANNEL_RX, &DMA_InitStructure);
-    DMA_Cmd(MAX7456_DMA_CHANNEL_RX, ENABLE);
-#endif
-    // Tx channel
-
-    DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)tx_buffer; //max7456_screen;
-    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralDST;
-    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
-
-    DMA_Init(MAX7456_DMA_CHANNEL_TX, &DMA_InitStructure);
-    DMA_Cmd(MAX7456_DMA_CHANNEL_TX, ENABLE);
-
-#ifdef MAX7456_DMA_CHANNEL_RX
-    DMA_ITConfig(MAX7456_DMA_CHANNEL_RX, DMA_IT_TC, ENABLE);
-#else
-    DMA_ITConfig(MAX7456_DMA_CHANNEL_TX, DMA_IT_TC, ENABLE);
-#endif
-
-    dma_transaction_in_progress = 1;
-
-    SPI_I2S_DMACmd(MAX7456_SPI_INSTANCE,
-#ifdef MAX7456_DMA_CHANNEL_RX
-            SPI_I2S_DMAReq_Rx |
+#ifdef USE_MAX7456_DMA
+    while (max7456Transaction.state == SPI_TRANSACTION_QUEUED) {
+    }
 #endif
-            SPI_I2S_DMAReq_Tx, ENABLE);
 }
 
-void max7456_dma_irq_handler(dmaChannel_t* descriptor, dmaCallbackHandler_t* callbackHandler)
+#ifdef USE_MAX7456_DMA
+// The screen is sent by the bus queue, with DMA when the bus has it, after transfers of higher priority devices.
+static void max7456_writeDMA(void* tx_buffer, void* rx_buffer, uint16_t buffer_size)
 {
-    UNUSED(callbackHandler);
-
-    if (DMA_GET_FLAG_STATUS(descriptor, DMA_IT_TCIF)) {
-#ifdef MAX7456_DMA_CHANNEL_RX
-        DMA_Cmd(MAX7456_DMA_CHANNEL_RX, DISABLE);
-#endif
-        uint32_t counter1 = 0;
-        uint32_t counter2 = 0;
-
-        // Make sure spi transfer is complete (empty transmit buffer and not busy)
-        while (SPI_I2S_GetFlagStatus (MAX7456_SPI_INSTANCE, SPI_I2S_FLAG_TXE) == RESET) {counter1++;};
-        while (SPI_I2S_GetFlagStatus (MAX7456_SPI_INSTANCE, SPI_I2S_FLAG_BSY) == SET) {counter2++;};
-
-        // Empty the RX buffer. RX DMA takes care of it if enabled.
-        // Note: This can only be be done after transmission is complete.
-        while (SPI_I2S_GetFlagStatus(MAX7456_SPI_INSTANCE, SPI_I2S_FLAG_RXNE) == SET) {
-            MAX7456_SPI_INSTANCE->DR;
-        }
-
-        DMA_Cmd(MAX7456_DMA_CHANNEL_TX, DISABLE);
-
-        DMA_CLEAR_FLAG(descriptor, DMA_IT_TCIF);
-
-        SPI_I2S_DMACmd(MAX7456_SPI_INSTANCE,
-#ifdef MAX7456_DMA_CHANNEL_RX
-                SPI_I2S_DMAReq_Rx |
-#endif
-                SPI_I2S_DMAReq_Tx, DISABLE);
+    max7456_waitForDMAToComplete();
 
-        DISABLE_MAX7456;
-        dma_transaction_in_progress = 0;
-    }
+    max7456Transaction.device = &max7456SpiDevice;
+    max7456Transaction.txBuf = tx_buffer;
+    max7456Transaction.rxBuf = rx_buffer;
+    max7456Transaction.len = buffer_size;
+    max7456Transaction.priority = SPI_PRIORITY_BULK;
 
-    if (DMA_GET_FLAG_STATUS(descriptor, DMA_IT_HTIF)) {
-        DMA_CLEAR_FLAG(descriptor, DMA_IT_HTIF);
-    }
-    if (DMA_GET_FLAG_STATUS(descriptor, DMA_IT_TEIF)) {
-        DMA_CLEAR_FLAG(descriptor, DMA_IT_TEIF);
-    }
+    spiQueueTransaction(&max7456Transaction);
 }
 #endif
 
-static void max7456_waitForDMAToComplete(void)
-{
-#ifdef MAX7456_DMA_CHANNEL_TX
-    static uint32_t waiting = 0;
-    while (dma_transaction_in_progress) {
-        waiting++;
-    };
-#endif
-}
-
 static void max7456_write(uint8_t address, uint8_t data)
 {
     max7456_waitForDMAToComplete();
@@ -476,6 +310,7 @@ void max7456_init(videoMode_e desiredVideoMode)
     spiSetDivisor(MAX7456_SPI_INSTANCE, MAX7456_SPI_CLOCK_DIVIDER);
 
     max7456_softReset();
+    max7456DisplayInvalidate(&max7456Display);
 
     delay(100); // allow time to detect video signal
 
@@ -503,15 +338,6 @@ void max7456_init(videoMode_e desiredVideoMode)
 
     max7456_write(MAX7456_REG_OSDBL, blackLevelValue);
 
-#ifdef MAX7456_DMA_CHANNEL_TX
-    static bool dmaInitDone = false;
-    if (!dmaInitDone) {
-        dmaHandlerInit(&dmaTxHandler, max7456_dma_irq_handler);
-        dmaSetHandler(MAX7456_DMA_IRQ_HANDLER_ID, &dmaTxHandler, NVIC_PRIO_MAX7456_DMA);
-        dmaInitDone = true;
-    }
-#endif
-
 }
 
 void max7456_setFontCharacter(uint8_t characterIndex, const uint8_t *characterBitmap)
@@ -600,94 +426,32 @@ void max7456_waitForVSync(void)
     }
 }
 
-#ifdef MAX7456_DMA_CHANNEL_TX
-
+// Sends the characters that differ from the display memory, a flight screen changes a few dozen per frame.
 void max7456_writeScreen(textScreen_t *textScreen, TEXT_SCREEN_CHAR *screenBuffer)
 {
-    MAX7456_TIME_SECTION_BEGIN(1);
-
-    uint32_t totalScreenCharacters = textScreen->height * textScreen->width;
+    static uint8_t frame[MAX7456_UPDATE_FRAME_SIZE];
 
-    static uint16_t max7456_screen[MAX7456_PAL_CHARACTER_COUNT + 3 + 2];
-
-    uint32_t offset = 0;
+    max7456_waitForDMAToComplete();
 
-    max7456_screen[offset++] = (uint16_t)(MAX7456_REG_DMAH) | (0 << 8);
-    max7456_screen[offset++] = (uint16_t)(MAX7456_REG_DMAL) | (0 << 8);
-    max7456_screen[offset++] = (uint16_t)(MAX7456_REG_DMM) | ((MAX7456_DMM_BIT_AUTO_INCREMENT) << 8);
+    MAX7456_TIME_SECTION_BEGIN(1);
 
-    for(uint32_t characterOffset = 0; characterOffset < totalScreenCharacters; characterOffset++) {
-        max7456_screen[offset++] = (uint16_t)(MAX7456_REG_DMDI | (screenBuffer[characterOffset] << 8));
+    const uint16_t length = max7456BuildScreenUpdate(&max7456Display, screenBuffer, textScreen->height * textScreen->width, frame, sizeof(frame));
+    if (length == 0) {
+        MAX7456_TIME_SECTION_END(1);
+        return;
     }
 
-    // terminate auto-increment
-    max7456_screen[offset++] = (uint16_t)(MAX7456_REG_DMDI) | (0xFF << 8);
-
-    // disable auto increment, enabled above.
-    max7456_screen[offset++] = (uint16_t)(MAX7456_REG_DMM) | (0x00 << 8);
-
-    max7456_writeDMA(&max7456_screen, NULL, offset * 2);
-
-    MAX7456_TIME_SECTION_END(1);
-}
-
+#ifdef USE_MAX7456_DMA
+    max7456_writeDMA(frame, NULL, length);
 #else
-void max7456_writeScreen(textScreen_t *textScreen, TEXT_SCREEN_CHAR *screenBuffer)
-{
     ENABLE_MAX7456;
-
-    spiTransferByte(MAX7456_SPI_INSTANCE, MAX7456_REG_DMAH); // set start address high
-    spiTransferByte(MAX7456_SPI_INSTANCE, 0);
-
-    spiTransferByte(MAX7456_SPI_INSTANCE, MAX7456_REG_DMAL); // set start address low
-    spiTransferByte(MAX7456_SPI_INSTANCE, 0);
-
-    spiTransferByte(MAX7456_SPI_INSTANCE, MAX7456_REG_DMM);
-    spiTransferByte(MAX7456_SPI_INSTANCE, MAX7456_DMM_BIT_8BIT_ENABLE | MAX7456_DMM_BIT_AUTO_INCREMENT);
-
-    //
-    // It takes about 4600us to transfer the contents of the screen buffer via SPI to the MAX7456
-    // (See DEBUG_MAX7456_DM_UPDATE)
-
-    max7456State.vSyncDetected = false;
-
-    for (int y = 0; y < textScreen->height; y++) {
-        unsigned int rowOffset = (y * textScreen->width);
-        TEXT_SCREEN_CHAR *buffer = &screenBuffer[rowOffset];
-
-        if (y == 8) {
-            MAX7456_TIME_SECTION_END(1);
-            // wait for next frame to send the remaining rows
-            max7456State.vSyncDetected = false;
-        }
-
-        max7456_waitForVSync();
-
-        if (y == 0) {
-            MAX7456_TIME_SECTION_BEGIN(1);
-        } else if (y == 8) {
-            MAX7456_TIME_SECTION_BEGIN(2);
-        }
-
-        for (int x = 0; x < textScreen->width; x++) {
-            // TODO ensure 0xFF is replaced with ' ' to avoid early termination of auto-increment mode.
-            spiTransferByte(MAX7456_SPI_INSTANCE, MAX7456_REG_DMDI);
-            spiTransferByte(MAX7456_SPI_INSTANCE, *buffer++);
-        }
-    }
-
-    spiTransferByte(MAX7456_SPI_INSTANCE, MAX7456_REG_DMDI);
-    spiTransferByte(MAX7456_SPI_INSTANCE, 0xFF); // terminate auto-increment
-
-    spiTransferByte(MAX7456_SPI_INSTANCE, MAX7456_REG_DMM);
-    spiTransferByte(MAX7456_SPI_INSTANCE, 0x00); // disable 8bit mode and auto increment, enabled above.
-
-    MAX7456_TIME_SECTION_END(2);
-
+    spiTransfer(MAX7456_SPI_INSTANCE, NULL, frame, length);
     DISABLE_MAX7456;
-}
 #endif
 
+    MAX7456_TIME_SECTION_END(1);
+}
+
 void max7456_setCharacterAtPosition(uint8_t x, uint8_t y, uint8_t c)
 {
     uint32_t linepos;
@@ -700,6 +464,9 @@ void max7456_setCharacterAtPosition(uint8_t x, uint8_t y, uint8_t c)
     char_address_hi = linepos >> 8;
     char_address_lo = linepos;
 
+    max7456_waitForDMAToComplete();
+    max7456DisplayInvalidate(&max7456Display);
+
     ENABLE_MAX7456;
 
     spiTransferByte(MAX7456_SPI_INSTANCE, MAX7456_REG_DMAH); // set start address high
@@ -750,6 +517,7 @@ void max7456_clearScreen(void)
 
     dmmStatus |= MAX7456_DMM_BIT_CLEAR;
     max7456_write(MAX7456_REG_DMM, dmmStatus);
+    max7456DisplayInvalidate(&max7456Display);
 }
 
 void max7456_clearScreenAtNextVSync(void)
@@ -759,4 +527,5 @@ void max7456_clearScreenAtNextVSync(void)
     dmmStatus |= MAX7456_DMM_BIT_CLEAR;
     dmmStatus |= MAX7456_DMM_BIT_VSYNC_CLEAR;
     max7456_write(MAX7456_REG_DMM, dmmStatus);
+    max7456DisplayInvalidate(&max7456Display);
 }
@@ -0,0 +1,95 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#define MAX7456_MODE_MASK_PAL 0x40
+#define MAX7456_CENTER_PAL 0x8
+
+#define MAX7456_MODE_MASK_NTSC 0x00
+#define MAX7456_CENTER_NTSC 0x6
+
+#define MAX7456_SHADOW_TO_NVM_MASK 0xA0
+
+//MAX7456 read addresses
+#define MAX7456_REG_OSDBL_READ 0xec //black level
+#define MAX7456_REG_STAT_READ  0xa0 //0xa[X] Status
+#define MAX7456_REG_VM0_READ  0x80
+#define MAX7456_REG_DMM_READ   0x84
+
+//MAX7456 write addresses
+#define MAX7456_REG_VM0   0x00
+#define MAX7456_REG_VM1   0x01
+#define MAX7456_REG_DMM   0x04
+#define MAX7456_REG_DMAH  0x05
+#define MAX7456_REG_DMAL  0x06
+#define MAX7456_REG_DMDI  0x07
+#define MAX7456_REG_OSDM  0x0c
+#define MAX7456_REG_OSDBL 0x6c // WARNING - see datasheet before writing to this register, there are factory preset bits.
+
+//MAX7456 write addresses
+#define MAX7456_REG_CMM   0x08
+#define MAX7456_REG_CMAH  0x09
+#define MAX7456_REG_CMAL  0x0a
+#define MAX7456_REG_CMDI  0x0b
+#define MAX7456_REG_CMDO  0xc0
+
+#define MAX7456_REG_RB0          0x10
+#define MAX7456_REG_RB1          0x11
+#define MAX7456_REG_RB2          0x12
+#define MAX7456_REG_RB3          0x13
+#define MAX7456_REG_RB4          0x14
+#define MAX7456_REG_RB5          0x15
+#define MAX7456_REG_RB6          0x16
+#define MAX7456_REG_RB7          0x17
+#define MAX7456_REG_RB8          0x18
+#define MAX7456_REG_RB9          0x19
+#define MAX7456_REG_RB10         0x1a
+#define MAX7456_REG_RB11         0x1b
+#define MAX7456_REG_RB12         0x1c
+#define MAX7456_REG_RB13         0x1d
+#define MAX7456_REG_RB14         0x1e
+#define MAX7456_REG_RB15         0x1f
+
+#define MAX7456_VM0_BIT_VIDEO_BUFFER_DISABLE    (0 << 0)
+#define MAX7456_VM0_BIT_VIDEO_BUFFER_ENABLE     (1 << 0)
+#define MAX7456_VM0_BIT_SOFTWARE_RESET          (1 << 1)
+#define MAX7456_VM0_BIT_VSYNC_DISABLE           (0 << 2)
+#define MAX7456_VM0_BIT_VSYNC_ENABLE            (1 << 2)
+#define MAX7456_VM0_BIT_OSD_DISABLE             (0 << 3)
+#define MAX7456_VM0_BIT_OSD_ENABLE              (1 << 3)
+#define MAX7456_VM0_BIT_SYNC_MODE_EXTERNAL      ((1 << 5) | (0 << 4))
+#define MAX7456_VM0_BIT_SYNC_MODE_INTERNAL      ((1 << 5) | (1 << 4))
+#define MAX7456_VM0_BIT_VIDEO_MODE_PAL          (0 << 6)
+#define MAX7456_VM0_BIT_VIDEO_MODE_NTSC         (1 << 6)
+
+#define MAX7456_STAT_BIT_PAL_DETECTED           (1 << 0)
+#define MAX7456_STAT_BIT_NTSC_DETECTED          (1 << 1)
+#define MAX7456_STAT_BIT_LOS_OF_SYNC            (1 << 2)
+#define MAX7456_STAT_BIT_HSYNC_INACTIVE         (1 << 3)
+#define MAX7456_STAT_BIT_VSYNC_INACTIVE         (1 << 4)
+#define MAX7456_STAT_BIT_CHAR_MEM_BUSY          (1 << 5)
+#define MAX7456_STAT_BIT_RESET_MODE             (1 << 6)
+#define MAX7456_STAT_BIT_NA                     (1 << 7)
+
+#define MAX7456_DMM_BIT_8BIT_ENABLE             (1 << 6) // 16 bit when disabled
+#define MAX7456_DMM_BIT_LBC                     (1 << 5) // only when in 16 bit mode
+#define MAX7456_DMM_BIT_BLINK                   (1 << 4) // only when in 16 bit mode
+#define MAX7456_DMM_BIT_INVERT                  (1 << 3) // only when in 16 bit mode
+#define MAX7456_DMM_BIT_CLEAR                   (1 << 2)
+#define MAX7456_DMM_BIT_VSYNC_CLEAR             (1 << 1)
+#define MAX7456_DMM_BIT_AUTO_INCREMENT          (1 << 0)
@@ -0,0 +1,127 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <platform.h>
+
+#include "drivers/io.h"
+#include "drivers/exti.h"
+#include "drivers/video.h"
+#include "drivers/video_textscreen.h"
+#include "drivers/video_max7456.h"
+#include "drivers/video_max7456_registers.h"
+#include "drivers/video_max7456_update.h"
+
+#define MAX7456_AUTO_INCREMENT_END  0xFF    // ends auto-increment mode, so cannot be sent in a run
+
+#define MAX7456_RUN_OVERHEAD        10      // address, mode, end of auto-increment and mode again
+#define MAX7456_CHARACTER_OVERHEAD  4       // low address and the character, high address when it changes
+#define MAX7456_RUN_MIN_LENGTH      6       // shorter runs are cheaper sent character by character
+#define MAX7456_RUN_MAX_GAP         2       // unchanged characters sent again to join two runs
+
+#define MAX7456_DMAH_UNKNOWN        -1
+
+void max7456DisplayInvalidate(max7456Display_t *display)
+{
+    display->knownCount = 0;
+}
+
+static bool max7456IsChanged(const max7456Display_t *display, const TEXT_SCREEN_CHAR *screen, uint16_t offset)
+{
+    return offset >= display->knownCount || display->shadow[offset] != screen[offset];
+}
+
+static uint8_t *max7456PutRegister(uint8_t *frame, uint8_t reg, uint8_t value)
+{
+    *frame++ = reg;
+    *frame++ = value;
+    return frame;
+}
+
+/*
+ * Builds the SPI frame that brings the display memory up to date with the screen and updates the shadow,
+ * returns its length. Characters that do not fit in the frame stay changed and are sent by the next update.
+ */
+uint16_t max7456BuildScreenUpdate(max7456Display_t *display, const TEXT_SCREEN_CHAR *screen, uint16_t characterCount, uint8_t *frame, uint16_t frameSize)
+{
+    uint8_t *ptr = frame;
+    const uint8_t *frameEnd = frame + frameSize;
+    int dmah = MAX7456_DMAH_UNKNOWN;
+    uint16_t offset = 0;
+
+    while (offset < characterCount) {
+        if (!max7456IsChanged(display, screen, offset)) {
+            offset++;
+            continue;
+        }
+
+        uint16_t end = offset + 1;
+        if (screen[offset] != MAX7456_AUTO_INCREMENT_END) {
+            for (uint16_t next = end; next < characterCount && next - end <= MAX7456_RUN_MAX_GAP && screen[next] != MAX7456_AUTO_INCREMENT_END; next++) {
+                if (max7456IsChanged(display, screen, next)) {
+                    end = next + 1;
+                }
+            }
+        }
+
+        const uint16_t runLength = end - offset;
+        if (runLength >= MAX7456_RUN_MIN_LENGTH) {
+            if (ptr + MAX7456_RUN_OVERHEAD + runLength * 2 > frameEnd) {
+                break;
+            }
+            ptr = max7456PutRegister(ptr, MAX7456_REG_DMAH, offset >> 8);
+            ptr = max7456PutRegister(ptr, MAX7456_REG_DMAL, offset & 0xFF);
+            ptr = max7456PutRegister(ptr, MAX7456_REG_DMM, MAX7456_DMM_BIT_AUTO_INCREMENT);
+            for (; offset < end; offset++) {
+                ptr = max7456PutRegister(ptr, MAX7456_REG_DMDI, screen[offset]);
+                display->shadow[offset] = screen[offset];
+            }
+            ptr = max7456PutRegister(ptr, MAX7456_REG_DMDI, MAX7456_AUTO_INCREMENT_END);
+            ptr = max7456PutRegister(ptr, MAX7456_REG_DMM, 0);
+            dmah = MAX7456_DMAH_UNKNOWN;    // the address has moved on
+            continue;
+        }
+
+        for (; offset < end; offset++) {
+            if (!max7456IsChanged(display, screen, offset)) {
+                continue;
+            }
+            const bool setDmah = dmah != (offset >> 8);
+            if (ptr + MAX7456_CHARACTER_OVERHEAD + (setDmah ? 2 : 0) > frameEnd) {
+                break;
+            }
+            if (setDmah) {
+                dmah = offset >> 8;
+                ptr = max7456PutRegister(ptr, MAX7456_REG_DMAH, dmah);
+            }
+            ptr = max7456PutRegister(ptr, MAX7456_REG_DMAL, offset & 0xFF);
+            ptr = max7456PutRegister(ptr, MAX7456_REG_DMDI, screen[offset]);
+            display->shadow[offset] = screen[offset];
+        }
+        if (offset < end) {
+            break;
+        }
+    }
+
+    if (offset > display->knownCount) {
+        display->knownCount = offset;
+    }
+
+    return ptr - frame;
+}
@@ -0,0 +1,33 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Enough for the whole screen in one auto-increment burst.
+#define MAX7456_UPDATE_FRAME_SIZE (MAX7456_PAL_CHARACTER_COUNT * 2 + 16)
+
+/*
+ * Keeps a copy of the MAX7456 display memory so that only the characters that differ from the screen buffer
+ * are sent. Runs of changed characters are sent with an auto-increment burst, single characters by address.
+ */
+typedef struct max7456Display_s {
+    uint8_t shadow[MAX7456_PAL_CHARACTER_COUNT];
+    uint16_t knownCount;            // characters from the start of the display memory that the shadow holds, 0 after a reset or clear
+} max7456Display_t;
+
+void max7456DisplayInvalidate(max7456Display_t *display);
+uint16_t max7456BuildScreenUpdate(max7456Display_t *display, const TEXT_SCREEN_CHAR *screen, uint16_t characterCount, uint8_t *frame, uint16_t frameSize);
@@ -246,6 +246,46 @@ void buttonsHandleColdBootButtonPresses(void)
 
 #endif
 
+#ifdef USE_DSHOT
+// DShot takes the update DMA channel of its motor timers in pwmInit(), claim the channels of the drivers
+// set up after it first so it falls back to PWM instead of taking one of them.
+static void reserveDmaChannels(void)
+{
+#ifdef USE_ADC
+    dmaReserveChannel(ADC_DMA_CHANNEL, DMA_OWNER_ADC);
+#endif
+    uartReserveDmaChannels();
+#if defined(USE_SPI_DEVICE_1) && defined(SPI1_DMA_CHANNEL_TX)
+    dmaReserveChannel(SPI1_DMA_CHANNEL_TX, DMA_OWNER_SPI);
+#ifdef SPI1_DMA_CHANNEL_RX
+    dmaReserveChannel(SPI1_DMA_CHANNEL_RX, DMA_OWNER_SPI);
+#endif
+#endif
+#if defined(USE_SPI_DEVICE_2) && defined(SPI2_DMA_CHANNEL_TX)
+    dmaReserveChannel(SPI2_DMA_CHANNEL_TX, DMA_OWNER_SPI);
+#ifdef SPI2_DMA_CHANNEL_RX
+    dmaReserveChannel(SPI2_DMA_CHANNEL_RX, DMA_OWNER_SPI);
+#endif
+#endif
+#if defined(USE_SPI_DEVICE_3) && defined(SPI3_DMA_CHANNEL_TX)
+    dmaReserveChannel(SPI3_DMA_CHANNEL_TX, DMA_OWNER_SPI);
+#ifdef SPI3_DMA_CHANNEL_RX
+    dmaReserveChannel(SPI3_DMA_CHANNEL_RX, DMA_OWNER_SPI);
+#endif
+#endif
+#ifdef LED_STRIP
+    if (feature(FEATURE_LED_STRIP)) {
+        dmaReserveChannel(WS2811_DMA_HANDLER_IDENTIFER->channel, DMA_OWNER_LED_STRIP);
+    }
+#endif
+#ifdef TRANSPONDER
+    if (feature(FEATURE_TRANSPONDER)) {
+        dmaReserveChannel(TRANSPONDER_DMA_HANDLER_IDENTIFER->channel, DMA_OWNER_TRANSPONDER);
+    }
+#endif
+}
+#endif
+
 void init(void)
 {
     drv_pwm_config_t pwm_params;
@@ -418,6 +458,11 @@ void init(void)
 #endif
 
     pwm_params.useOneshot = feature(FEATURE_ONESHOT125);
+#ifdef USE_DSHOT
+    pwm_params.useDshot = feature(FEATURE_DSHOT);
+    if (pwm_params.useDshot)
+        pwm_params.useOneshot = false;
+#endif
     pwm_params.motorPwmRate = motorConfig()->motor_pwm_rate;
     pwm_params.idlePulse = calculateMotorOff();
     if (pwm_params.motorPwmRate > 500)
@@ -425,6 +470,12 @@ void init(void)
 
     pwmRxInit();
 
+#ifdef USE_DSHOT
+    if (pwm_params.useDshot) {
+        reserveDmaChannels();
+    }
+#endif
+
     // pwmInit() needs to be called as soon as possible for ESC compatibility reasons
     pwmIOConfiguration_t *pwmIOConfiguration = pwmInit(&pwm_params);
 
@@ -659,11 +710,11 @@ void init(void)
 
     sdcardInsertionDetectInit();
 
-#ifdef SDCARD_DMA_CHANNEL_TX
+#if defined(USE_SDCARD_SPI2) && defined(SPI2_DMA_CHANNEL_TX)
 
 #if defined(LED_STRIP) && defined(WS2811_DMA_CHANNEL)
     // Ensure the SPI Tx DMA doesn't overlap with the led strip
-    sdcardUseDMA = !feature(FEATURE_LED_STRIP) || SDCARD_DMA_CHANNEL_TX != WS2811_DMA_CHANNEL;
+    sdcardUseDMA = !feature(FEATURE_LED_STRIP) || SPI2_DMA_CHANNEL_TX != WS2811_DMA_CHANNEL;
 #else
     sdcardUseDMA = true;
 #endif
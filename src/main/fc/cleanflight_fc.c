@@ -44,6 +44,7 @@
 #include "drivers/system.h"
 #include "drivers/serial.h"
 #include "drivers/gyro_sync.h"
+#include "drivers/pwm_output.h"
 
 #include "fc/rc_controls.h"
 #include "fc/rate_profile.h"
@@ -123,7 +124,6 @@ int16_t telemTemperature1;      // gyro sensor temperature
 static uint32_t disarmAt;     // Time of automatic disarm when "Don't spin the motors when armed" is enabled and auto_disarm_delay is nonzero
 
 extern uint32_t currentTime;
-extern uint8_t PIDweight[3], Iweigth[3];
 extern uint8_t dynP8[3], dynI8[3], dynD8[3];
 
 static bool isRXDataNew;
@@ -215,8 +215,7 @@ static void updateRcCommands(void)
             prop1 = 100 - (uint16_t)currentControlRateProfile->rates[axis] * tmp / 500;
             prop1 = (uint16_t)prop1 * prop2 / 100;
             // non coupled PID reduction scaler used in PID controller 1 and PID controller 2. 100 means 100% of the pids
-            PIDweight[axis] = prop2;
-			Iweigth[axis] = 100;
+            pidSetWeights(axis, prop2, 100);
         } else {
             if (rcControlsConfig()->yaw_deadband) {
                 if (tmp > rcControlsConfig()->yaw_deadband) {
@@ -228,8 +227,7 @@ static void updateRcCommands(void)
             rcCommand[axis] = rcLookupYaw(tmp) * -rcControlsConfig()->yaw_control_direction;
             prop1 = 100 - (uint16_t)currentControlRateProfile->rates[axis] * ABS(tmp) / 500;
             // YAW TPA disabled.
-            PIDweight[axis] = 100;
-			Iweigth[axis] = yawIWeigth;
+            pidSetWeights(axis, 100, yawIWeigth);
         }
 #ifdef USE_PID_MW23
         // FIXME axis indexes into pids.  use something like lookupPidIndex(rc_alias_e alias) to reduce coupling.
@@ -673,6 +671,7 @@ void processRcCommand(void)
 void subTaskPidController(void)
 {
     const uint32_t startTime = micros();
+    TRACE_BEGIN(TRACE_SECTION_PID_CONTROLLER, 0);
 
     // PID - note this is function pointer set by setPIDController()
     pid_controller(
@@ -683,12 +682,14 @@ void subTaskPidController(void)
         rxConfig()
     );
 
+    TRACE_END(TRACE_SECTION_PID_CONTROLLER, 0);
     if (debugMode == DEBUG_PIDLOOP) {debug[2] = micros() - startTime;}
 }
 
 void subTaskMainSubprocesses(void)
 {
     const uint32_t startTime = micros();
+    TRACE_BEGIN(TRACE_SECTION_SUBPROCESSES, 0);
 
     // Read out gyro temperature. can use it for something somewhere. maybe get MCU temperature instead? lots of fun possibilities.
     if (gyro.temperature) {
@@ -757,12 +758,14 @@ void subTaskMainSubprocesses(void)
         handleBlackbox();
     }
 #endif
+    TRACE_END(TRACE_SECTION_SUBPROCESSES, 0);
     if (debugMode == DEBUG_PIDLOOP) {debug[1] = micros() - startTime;}
 }
 
 void subTaskMotorUpdate(void)
 {
     const uint32_t startTime = micros();
+    TRACE_BEGIN(TRACE_SECTION_MOTOR_UPDATE, 0);
     if (debugMode == DEBUG_CYCLETIME) {
         static uint32_t previousMotorUpdateTime;
         const uint32_t currentDeltaTime = startTime - previousMotorUpdateTime;
@@ -775,12 +778,18 @@ void subTaskMotorUpdate(void)
 
 #ifdef USE_SERVOS
     filterServos();
-    writeServos();
 #endif
 
-    if (motorControlEnable) {
-        writeMotors();
+    writeOutputFrame(motorControlEnable);
+
+    if (debugMode == DEBUG_OUTPUT_LATENCY) {
+        static uint32_t previousCommitTime;
+        const uint32_t commitTime = pwmGetOutputCommitTime();
+        debug[0] = commitTime - currentTime;    // PID task start to outputs latched
+        debug[1] = commitTime - previousCommitTime;
+        previousCommitTime = commitTime;
     }
+    TRACE_END(TRACE_SECTION_MOTOR_UPDATE, 0);
     if (debugMode == DEBUG_PIDLOOP) {debug[3] = micros() - startTime;}
 }
 
@@ -882,6 +891,11 @@ void taskUpdateAccelerometer(void)
 
 void taskUpdateAttitude(void) {
     imuUpdateAttitude();
+#if defined(BARO) || defined(SONAR)
+    if (sensors(SENSOR_BARO) || sensors(SENSOR_SONAR)) {
+        updateAltitudeAcceleration(currentTime);
+    }
+#endif
 }
 
 void taskHandleSerial(void)
@@ -980,6 +994,7 @@ void taskProcessGPS(void)
     }
 
     if (sensors(SENSOR_GPS)) {
+        updateGpsInertialNavigation();
         updateGpsIndicator(currentTime);
     }
 }
@@ -1002,6 +1017,7 @@ void taskUpdateBaro(void)
         if (newDeadline != 0) {
             rescheduleTask(TASK_SELF, newDeadline);
         }
+        updateAltitudeBaro();
     }
 }
 #endif
@@ -1010,6 +1026,7 @@ void taskUpdateBaro(void)
 void taskUpdateSonar(void)
 {
     if (sensors(SENSOR_SONAR)) {
+        updateAltitudeSonar();
         sonarUpdate();
     }
 }
@@ -43,6 +43,7 @@ typedef enum {
     FEATURE_BLACKBOX = 1 << 19,
     FEATURE_CHANNEL_FORWARDING = 1 << 20,
     FEATURE_TRANSPONDER = 1 << 21,
+    FEATURE_DSHOT = 1 << 22,
 } features_e;
 
 void handleOneshotFeatureChangeOnRestart(void);
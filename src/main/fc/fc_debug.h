@@ -23,6 +23,7 @@ typedef enum {
     DEBUG_GYRO,
     DEBUG_PIDLOOP,
     DEBUG_GYRO_SYNC,
+    DEBUG_OUTPUT_LATENCY,
 
     DEBUG_MODE_COUNT
 } debugMode_e;
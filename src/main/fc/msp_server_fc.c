@@ -23,6 +23,7 @@
 
 #include "build/build_config.h"
 #include "build/debug.h"
+#include "build/trace.h"
 #include <platform.h>
 
 #include "common/axis.h"
@@ -499,6 +500,50 @@ static void serializeDataflashReadReply(mspPacket_t *reply, uint32_t address, in
 }
 #endif
 
+#ifdef USE_TRACE
+static void serializeTraceNamesReply(mspPacket_t *reply, uint8_t list)
+{
+    sbuf_t *dst = &reply->buf;
+    if (list == MSP_TRACE_NAMES_SECTIONS) {
+        for (int i = 0; i < TRACE_SECTION_COUNT; i++) {
+            sbufWriteString(dst, traceSectionNames[i]);
+            sbufWriteU8(dst, ';');
+        }
+    } else {
+        for (unsigned i = 0; i < taskCount; i++) {
+            sbufWriteString(dst, cfTasks[i].taskName);
+            sbufWriteU8(dst, ';');
+        }
+    }
+}
+
+static void serializeTraceReadReply(mspPacket_t *reply, uint8_t command)
+{
+    sbuf_t *dst = &reply->buf;
+
+    if (command == MSP_TRACE_READ_START) {
+        traceStart();
+    } else if (command == MSP_TRACE_READ_STOP) {
+        traceStop();
+    }
+
+    sbufWriteU8(dst, traceIsRecording());
+    uint8_t *waiting = sbufPtr(dst);
+    sbufWriteU16(dst, 0);
+
+    traceEvent_t event;
+    while (sbufBytesRemaining(dst) >= 6 && traceRead(&event, 1)) {
+        sbufWriteU32(dst, event.timeUs);
+        sbufWriteU8(dst, event.section);
+        sbufWriteU8(dst, event.flags);
+    }
+
+    const uint16_t eventsWaiting = traceEventsWaiting();
+    waiting[0] = eventsWaiting & 0xFF;
+    waiting[1] = eventsWaiting >> 8;
+}
+#endif
+
 // return positive for ACK, negative on error, zero for no reply
 int mspServerCommandHandler(mspPacket_t *cmd, mspPacket_t *reply)
 {
@@ -941,6 +986,16 @@ int mspServerCommandHandler(mspPacket_t *cmd, mspPacket_t *reply)
             serializeDataflashSummaryReply(reply);
             break;
 
+#ifdef USE_TRACE
+        case MSP_TRACE_NAMES:
+            serializeTraceNamesReply(reply, len > 0 ? sbufReadU8(src) : MSP_TRACE_NAMES_SECTIONS);
+            break;
+
+        case MSP_TRACE_READ:
+            serializeTraceReadReply(reply, len > 0 ? sbufReadU8(src) : MSP_TRACE_READ_EVENTS);
+            break;
+#endif
+
 #ifdef USE_FLASHFS
         case MSP_DATAFLASH_READ: {
             uint32_t readAddress = sbufReadU32(src);
@@ -1084,6 +1139,7 @@ int mspServerCommandHandler(mspPacket_t *cmd, mspPacket_t *reply)
                     pidProfile()->I8[i] = sbufReadU8(src);
                     pidProfile()->D8[i] = sbufReadU8(src);
                 }
+            pidInvalidateCoefficients();
             break;
 
         case MSP_SET_MODE_RANGE: {
@@ -263,7 +263,7 @@ void applyStepAdjustment(controlRateConfig_t *controlRateConfig, uint8_t adjustm
         setAdjustment(ptr,adjustmentFunction,delta,PID_MIN,PID_MAX);
     }
 
-
+    pidInvalidateCoefficients();
 }
 
 void applySelectAdjustment(uint8_t adjustmentFunction, uint8_t position)
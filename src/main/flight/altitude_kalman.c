@@ -0,0 +1,173 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <platform.h>
+
+#include "common/maths.h"
+
+#include "flight/altitude_kalman.h"
+
+#define ALT_KF_MAX_PREDICT_US       100000
+#define ALT_KF_MAX_MEASUREMENT_AGE  0.2f    // s
+#define ALT_KF_GATE_SIGMA           5.0f    // measurements further from the prediction are rejected
+#define ALT_KF_MAX_REJECTED         10      // the filter is restarted on the measurement after this many in a row
+
+#define ALT_KF_INITIAL_ALTITUDE_SD  100.0f  // cm
+#define ALT_KF_INITIAL_VELOCITY_SD  100.0f  // cm/s
+#define ALT_KF_INITIAL_ACC_BIAS_SD  50.0f   // cm/s/s
+
+void altitudeKalmanInit(altitudeKalman_t *kf, float accNoise, float accBiasNoise)
+{
+    memset(kf, 0, sizeof(*kf));
+    kf->accNoise = accNoise;
+    kf->accBiasNoise = accBiasNoise;
+}
+
+// Starts the filter at the given altitude, at rest, keeping the accelerometer bias learned so far.
+void altitudeKalmanReset(altitudeKalman_t *kf, float altitude, uint32_t timeUs)
+{
+    memset(kf->P, 0, sizeof(kf->P));
+    kf->P[ALT_KF_ALTITUDE][ALT_KF_ALTITUDE] = sq(ALT_KF_INITIAL_ALTITUDE_SD);
+    kf->P[ALT_KF_VELOCITY][ALT_KF_VELOCITY] = sq(ALT_KF_INITIAL_VELOCITY_SD);
+    kf->P[ALT_KF_ACC_BIAS][ALT_KF_ACC_BIAS] = sq(ALT_KF_INITIAL_ACC_BIAS_SD);
+
+    kf->x[ALT_KF_ALTITUDE] = altitude;
+    kf->x[ALT_KF_VELOCITY] = 0.0f;
+    if (!kf->initialised) {
+        kf->x[ALT_KF_ACC_BIAS] = 0.0f;
+    }
+    kf->timeUs = timeUs;
+    kf->rejectedCount = 0;
+    kf->initialised = true;
+}
+
+/*
+ * Advances the state to timeUs with the earth frame vertical acceleration measured then, gravity removed.
+ *
+ *     F = | 1  dt  -dt^2/2 |    Q = accNoise^2 * | dt^4/4  dt^3/2 | + accBiasNoise^2 * dt for the bias
+ *         | 0   1  -dt     |                     | dt^3/2  dt^2   |
+ *         | 0   0   1      |
+ */
+void altitudeKalmanPredict(altitudeKalman_t *kf, float acc, uint32_t timeUs)
+{
+    float FP[ALT_KF_STATE_COUNT][ALT_KF_STATE_COUNT];
+    int i, j;
+
+    if (!kf->initialised) {
+        return;
+    }
+
+    const uint32_t dTimeUs = MIN(timeUs - kf->timeUs, ALT_KF_MAX_PREDICT_US);
+    kf->timeUs = timeUs;
+    if (dTimeUs == 0) {
+        return;
+    }
+
+    const float dt = dTimeUs * 1e-6f;
+    const float dt2 = dt * dt;
+    const float a = acc - kf->x[ALT_KF_ACC_BIAS];
+
+    kf->x[ALT_KF_ALTITUDE] += (kf->x[ALT_KF_VELOCITY] + 0.5f * a * dt) * dt;
+    kf->x[ALT_KF_VELOCITY] += a * dt;
+
+    // P = F * P * F'
+    for (j = 0; j < ALT_KF_STATE_COUNT; j++) {
+        FP[0][j] = kf->P[0][j] + dt * kf->P[1][j] - 0.5f * dt2 * kf->P[2][j];
+        FP[1][j] = kf->P[1][j] - dt * kf->P[2][j];
+        FP[2][j] = kf->P[2][j];
+    }
+    for (i = 0; i < ALT_KF_STATE_COUNT; i++) {
+        kf->P[i][0] = FP[i][0] + dt * FP[i][1] - 0.5f * dt2 * FP[i][2];
+        kf->P[i][1] = FP[i][1] - dt * FP[i][2];
+        kf->P[i][2] = FP[i][2];
+    }
+
+    // P += Q
+    const float q = sq(kf->accNoise);
+    kf->P[0][0] += 0.25f * dt2 * dt2 * q;
+    kf->P[0][1] += 0.5f * dt2 * dt * q;
+    kf->P[1][0] += 0.5f * dt2 * dt * q;
+    kf->P[1][1] += dt2 * q;
+    kf->P[2][2] += sq(kf->accBiasNoise) * dt;
+}
+
+static float altitudeKalmanMeasurementAge(const altitudeKalman_t *kf, uint32_t measurementTimeUs)
+{
+    return constrainf((int32_t)(kf->timeUs - measurementTimeUs) * 1e-6f, 0.0f, ALT_KF_MAX_MEASUREMENT_AGE);
+}
+
+// Moves the altitude to a measurement, e.g. when the reference of the altitude changes, the rest of the state is kept.
+void altitudeKalmanSetAltitude(altitudeKalman_t *kf, float altitude, uint32_t measurementTimeUs)
+{
+    if (!kf->initialised) {
+        altitudeKalmanReset(kf, altitude, measurementTimeUs);
+        return;
+    }
+    kf->x[ALT_KF_ALTITUDE] = altitude + altitudeKalmanMeasurementAge(kf, measurementTimeUs) * kf->x[ALT_KF_VELOCITY];
+    kf->rejectedCount = 0;
+}
+
+/*
+ * Corrects the state with an altitude measured at measurementTimeUs with the given standard deviation.
+ * The altitude at that time is estimated as altitude - velocity * age, so H = | 1  -age  0 |.
+ * Returns false if the measurement was rejected as an outlier.
+ */
+bool altitudeKalmanCorrect(altitudeKalman_t *kf, float altitude, float noise, uint32_t measurementTimeUs)
+{
+    float PHt[ALT_KF_STATE_COUNT];
+    float K[ALT_KF_STATE_COUNT];
+    int i, j;
+
+    if (!kf->initialised) {
+        altitudeKalmanReset(kf, altitude, measurementTimeUs);
+        return true;
+    }
+
+    const float age = altitudeKalmanMeasurementAge(kf, measurementTimeUs);
+
+    for (i = 0; i < ALT_KF_STATE_COUNT; i++) {
+        PHt[i] = kf->P[i][0] - age * kf->P[i][1];
+    }
+    const float S = PHt[0] - age * PHt[1] + sq(noise);
+    const float innovation = altitude - (kf->x[ALT_KF_ALTITUDE] - age * kf->x[ALT_KF_VELOCITY]);
+
+    if (sq(innovation) > sq(ALT_KF_GATE_SIGMA) * S) {
+        if (++kf->rejectedCount >= ALT_KF_MAX_REJECTED) {
+            altitudeKalmanReset(kf, altitude, kf->timeUs);
+        }
+        return false;
+    }
+    kf->rejectedCount = 0;
+
+    for (i = 0; i < ALT_KF_STATE_COUNT; i++) {
+        K[i] = PHt[i] / S;
+        kf->x[i] += K[i] * innovation;
+    }
+
+    // P = P - K * H * P, H * P is PHt transposed as P is symmetric
+    for (i = 0; i < ALT_KF_STATE_COUNT; i++) {
+        for (j = 0; j < ALT_KF_STATE_COUNT; j++) {
+            kf->P[i][j] -= K[i] * PHt[j];
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,47 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Vertical Kalman filter estimating altitude, vertical velocity and the bias of the vertical acceleration.
+//
+// Every accelerometer sample predicts the state to its own time, altitude measurements correct it whenever
+// a sensor has a new one. A measurement carries the time it was taken, which is usually a little before the
+// last prediction, and is compared with the altitude the filter had at that time.
+
+typedef enum {
+    ALT_KF_ALTITUDE = 0,            // cm
+    ALT_KF_VELOCITY,                // cm/s
+    ALT_KF_ACC_BIAS,                // cm/s/s, subtracted from the measured acceleration
+    ALT_KF_STATE_COUNT
+} altitudeKalmanState_e;
+
+typedef struct altitudeKalman_s {
+    bool initialised;
+    uint32_t timeUs;                // time of the state
+    float x[ALT_KF_STATE_COUNT];
+    float P[ALT_KF_STATE_COUNT][ALT_KF_STATE_COUNT];
+    float accNoise;                 // cm/s/s
+    float accBiasNoise;             // cm/s/s per sqrt(s)
+    uint8_t rejectedCount;          // measurements rejected in a row
+} altitudeKalman_t;
+
+void altitudeKalmanInit(altitudeKalman_t *kf, float accNoise, float accBiasNoise);
+void altitudeKalmanReset(altitudeKalman_t *kf, float altitude, uint32_t timeUs);
+void altitudeKalmanPredict(altitudeKalman_t *kf, float acc, uint32_t timeUs);
+void altitudeKalmanSetAltitude(altitudeKalman_t *kf, float altitude, uint32_t measurementTimeUs);
+bool altitudeKalmanCorrect(altitudeKalman_t *kf, float altitude, float noise, uint32_t measurementTimeUs);
@@ -51,6 +51,7 @@
 #include "flight/mixer.h"
 #include "flight/pid.h"
 #include "flight/imu.h"
+#include "flight/altitude_kalman.h"
 
 #include "flight/altitudehold.h"
 
@@ -68,12 +69,37 @@ static int16_t initialRawThrottleHold;
 static int16_t initialThrottleHold;
 static int32_t EstAlt;                // in cm
 
+static altitudeKalman_t altitudeKalman;
+#ifdef BARO
+static int32_t baroAltOffset;         // baro altitude of the ground below the sonar
+#endif
+#ifdef SONAR
+static uint32_t lastSonarAltitudeTime;
+#define SONAR_ALTITUDE_TIMEOUT_US 200000    // the baro takes over if the sonar had no altitude for this long
+#define SONAR_ENTRY_SAMPLES       5         // in range samples in a row that agree before the sonar takes over
+#define SONAR_ENTRY_TOLERANCE_CM  15.0f     // how far the offset of each of them to the estimate may be from their mean
+#define SONAR_BLEND_RATE_CMS      50.0f     // the estimate moves over to the sonar altitude at up to this rate
+
+static uint8_t sonarEntryCount;
+static float sonarEntryOffset;          // mean offset of the sonar altitude to the estimate over the entry samples
+static float sonarBlendOffset;          // part of that offset not yet moved into the estimate
+#endif
+
 PG_REGISTER_WITH_RESET_TEMPLATE(airplaneConfig_t, airplaneConfig, PG_AIRPLANE_ALT_HOLD_CONFIG, 0);
 
 PG_RESET_TEMPLATE(airplaneConfig_t, airplaneConfig,
     .fixedwing_althold_dir = 1,
 );
 
+PG_REGISTER_WITH_RESET_TEMPLATE(altitudeKalmanConfig_t, altitudeKalmanConfig, PG_ALTITUDE_KALMAN_CONFIG, 0);
+
+PG_RESET_TEMPLATE(altitudeKalmanConfig_t, altitudeKalmanConfig,
+    .alt_acc_noise = 50.0f,
+    .alt_acc_bias_noise = 2.0f,
+    .alt_baro_noise = 50.0f,
+    .alt_sonar_noise = 5.0f,
+);
+
 // 40hz update rate (20hz LPF on acc)
 #define BARO_UPDATE_FREQUENCY_40HZ (1000 * 25)
 
@@ -207,25 +233,109 @@ int32_t calculateAltHoldThrottleAdjustment(int32_t vel_tmp, float accZ_tmp, floa
     return result;
 }
 
+static void altitudeKalmanStart(void)
+{
+    altitudeKalmanInit(&altitudeKalman, altitudeKalmanConfig()->alt_acc_noise, altitudeKalmanConfig()->alt_acc_bias_noise);
+}
+
+// Called after every attitude update, the vertical acceleration advances the estimate
+void updateAltitudeAcceleration(uint32_t currentTime)
+{
+    altitudeKalmanPredict(&altitudeKalman, accEarth[Z], currentTime);
+}
+
+#ifdef SONAR
+static bool isSonarAltitudeValid(uint32_t timeUs)
+{
+    return lastSonarAltitudeTime && (int32_t)(timeUs - lastSonarAltitudeTime) < SONAR_ALTITUDE_TIMEOUT_US;
+}
+
+/*
+ * Returns true once the sonar has had SONAR_ENTRY_SAMPLES altitudes in a row that agree with each other, taken as
+ * offsets to the estimate so that climbing or descending meanwhile does not count as disagreement.
+ */
+static bool sonarEntrySample(float offset)
+{
+    if (sonarEntryCount && ABS(offset - sonarEntryOffset) > SONAR_ENTRY_TOLERANCE_CM) {
+        sonarEntryCount = 0;
+    }
+    sonarEntryCount++;
+    sonarEntryOffset += (offset - sonarEntryOffset) / sonarEntryCount;
+
+    return sonarEntryCount >= SONAR_ENTRY_SAMPLES;
+}
+
+// Called by the sonar task, corrects the estimate with each new measurement in range
+void updateAltitudeSonar(void)
+{
+    int32_t distance;
+    uint32_t measurementTime;
+
+    if (!sonarReadSample(&distance, &measurementTime)) {
+        return;
+    }
+
+    const int32_t sonarAlt = sonarCalculateAltitude(distance, getCosTiltAngle());
+    if (sonarAlt <= 0 || sonarAlt > sonarMaxAltWithTiltCm) {
+        sonarEntryCount = 0;
+        return;
+    }
+
+    if (!altitudeKalman.initialised) {
+        altitudeKalmanStart();
+    }
+    if (!isSonarAltitudeValid(measurementTime)) {
+        if (!sonarEntrySample(sonarAlt - altitudeKalman.x[ALT_KF_ALTITUDE])) {
+            return;
+        }
+        sonarEntryCount = 0;
+        // the sonar measures from the ground below, not from where the baro was calibrated. The estimate is moved
+        // over to it gradually, a jump would make the altitude hold jump with it.
+        sonarBlendOffset = altitudeKalman.initialised ? sonarEntryOffset : 0.0f;
+    } else {
+        const float blendStep = SONAR_BLEND_RATE_CMS * (measurementTime - lastSonarAltitudeTime) * 1e-6f;
+        // towards zero by at most blendStep
+        sonarBlendOffset = constrainf(0.0f, sonarBlendOffset - blendStep, sonarBlendOffset + blendStep);
+    }
+    lastSonarAltitudeTime = measurementTime;
+
+    altitudeKalmanCorrect(&altitudeKalman, sonarAlt - sonarBlendOffset, altitudeKalmanConfig()->alt_sonar_noise, measurementTime);
+}
+#endif
+
+#ifdef BARO
+// Called by the baro task, corrects the estimate with each new pressure sample
+void updateAltitudeBaro(void)
+{
+    static uint32_t lastBaroSampleTime;
+
+    if (baroSampleTime == lastBaroSampleTime || !isBaroCalibrationComplete()) {
+        return;
+    }
+    lastBaroSampleTime = baroSampleTime;
+
+#ifdef SONAR
+    if (isSonarAltitudeValid(baroSampleTime)) {
+        // the sonar has the best range, keep the baro in line with the estimate for when it leaves it
+        baroAltOffset = baroSampleAltitude - lrintf(altitudeKalman.x[ALT_KF_ALTITUDE]);
+        return;
+    }
+#endif
+
+    if (!altitudeKalman.initialised) {
+        altitudeKalmanStart();
+    }
+    altitudeKalmanCorrect(&altitudeKalman, baroSampleAltitude - baroAltOffset, altitudeKalmanConfig()->alt_baro_noise, baroSampleTime);
+}
+#endif
+
 void calculateEstimatedAltitude(uint32_t currentTime)
 {
     static uint32_t previousTime;
     uint32_t dTime;
-    int32_t baroVel;
-    float dt;
-    float vel_acc;
     int32_t vel_tmp;
     float accZ_tmp;
     static float accZ_old = 0.0f;
-    static float vel = 0.0f;
-    static float accAlt = 0.0f;
-    static int32_t lastBaroAlt;
-
-#ifdef SONAR
-    int32_t sonarAlt = SONAR_OUT_OF_RANGE;
-    static int32_t baroAlt_offset = 0;
-    float sonarTransition;
-#endif
 
     dTime = currentTime - previousTime;
     if (dTime < BARO_UPDATE_FREQUENCY_40HZ)
@@ -236,8 +346,8 @@ void calculateEstimatedAltitude(uint32_t currentTime)
 #ifdef BARO
     if (!isBaroCalibrationComplete()) {
         performBaroCalibrationCycle();
-        vel = 0;
-        accAlt = 0;
+        altitudeKalmanStart();  // started again by the first sample after the calibration
+        baroAltOffset = 0;
     }
 
     BaroAlt = baroCalculateAltitude();
@@ -245,78 +355,29 @@ void calculateEstimatedAltitude(uint32_t currentTime)
     BaroAlt = 0;
 #endif
 
-#ifdef SONAR
-    sonarAlt = sonarRead();
-    sonarAlt = sonarCalculateAltitude(sonarAlt, getCosTiltAngle());
-
-    if (sonarAlt > 0 && sonarAlt < sonarCfAltCm) {
-        // just use the SONAR
-        baroAlt_offset = BaroAlt - sonarAlt;
-        BaroAlt = sonarAlt;
-    } else {
-        BaroAlt -= baroAlt_offset;
-        if (sonarAlt > 0  && sonarAlt <= sonarMaxAltWithTiltCm) {
-            // SONAR in range, so use complementary filter
-            sonarTransition = (float)(sonarMaxAltWithTiltCm - sonarAlt) / (sonarMaxAltWithTiltCm - sonarCfAltCm);
-            BaroAlt = sonarAlt * sonarTransition + BaroAlt * (1.0f - sonarTransition);
-        }
-    }
-#endif
-
-    dt = accTimeSum * 1e-6f; // delta acc reading time in seconds
-
-    // Integrator - velocity, cm/sec
+    // the acceleration since the last run, for the D term of the velocity controller
     if (accSumCount) {
         accZ_tmp = (float)accSum[2] / (float)accSumCount;
     } else {
         accZ_tmp = 0;
     }
-    vel_acc = accZ_tmp * accVelScale * (float)accTimeSum;
 
-    // Integrator - Altitude in cm
-    accAlt += (vel_acc * 0.5f) * dt + vel * dt;                                                                 // integrate velocity to get distance (x= a/2 * t^2)
-#ifdef BARO
-    accAlt = accAlt * barometerConfig()->baro_cf_alt + (float)BaroAlt * (1.0f - barometerConfig()->baro_cf_alt);    // complementary filter for altitude estimation (baro & acc)
-#endif
-    vel += vel_acc;
+    imuResetAccelerationSum();
 
 #ifdef DEBUG_ALT_HOLD
-    debug[1] = accSum[2] / accSumCount; // acceleration
-    debug[2] = vel;                     // velocity
-    debug[3] = accAlt;                  // height
+    debug[1] = lrintf(altitudeKalman.x[ALT_KF_ACC_BIAS]);   // acceleration bias
+    debug[2] = lrintf(altitudeKalman.x[ALT_KF_VELOCITY]);   // velocity
+    debug[3] = lrintf(altitudeKalman.x[ALT_KF_ALTITUDE]);   // height
 #endif
 
-    imuResetAccelerationSum();
-
 #ifdef BARO
     if (!isBaroCalibrationComplete()) {
         return;
     }
 #endif
 
-#ifdef SONAR
-    if (sonarAlt > 0 && sonarAlt < sonarCfAltCm) {
-        // the sonar has the best range
-        EstAlt = BaroAlt;
-    } else {
-        EstAlt = accAlt;
-    }
-#else
-    EstAlt = accAlt;
-#endif
-
-    baroVel = (BaroAlt - lastBaroAlt) * 1000000.0f / dTime;
-    lastBaroAlt = BaroAlt;
-
-    baroVel = constrain(baroVel, -1500, 1500);  // constrain baro velocity +/- 1500cm/s
-    baroVel = applyDeadband(baroVel, 10);       // to reduce noise near zero
-
-    // apply Complimentary Filter to keep the calculated velocity based on baro velocity (i.e. near real velocity).
-    // By using CF it's possible to correct the drift of integrated accZ (velocity) without loosing the phase, i.e without delay
-#ifdef BARO
-    vel = vel * barometerConfig()->baro_cf_vel + baroVel * (1.0f - barometerConfig()->baro_cf_vel);
-#endif
-    vel_tmp = lrintf(vel);
+    EstAlt = lrintf(altitudeKalman.x[ALT_KF_ALTITUDE]);
+    vel_tmp = lrintf(altitudeKalman.x[ALT_KF_VELOCITY]);
 
     // set vario
     vario = applyDeadband(vel_tmp, 5);
@@ -24,6 +24,18 @@ typedef struct airplaneConfig_s {
 
 PG_DECLARE(airplaneConfig_t, airplaneConfig);
 
+typedef struct altitudeKalmanConfig_s {
+    float alt_acc_noise;                    // cm/s/s, noise of the vertical acceleration
+    float alt_acc_bias_noise;               // cm/s/s per sqrt(s), how fast the accelerometer bias may drift
+    float alt_baro_noise;                   // cm, noise of a single baro sample
+    float alt_sonar_noise;                  // cm, noise of a sonar measurement
+} altitudeKalmanConfig_t;
+
+PG_DECLARE(altitudeKalmanConfig_t, altitudeKalmanConfig);
+
+void updateAltitudeAcceleration(uint32_t currentTime);
+void updateAltitudeBaro(void);
+void updateAltitudeSonar(void);
 void calculateEstimatedAltitude(uint32_t currentTime);
 
 void applyAltHold(void);
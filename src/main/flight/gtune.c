@@ -139,6 +139,7 @@ void init_Gtune(void)
         }
         if(pidProfile()->P8[i] < gtuneConfig()->gtune_lolimP[i]) {
             pidProfile()->P8[i] = gtuneConfig()->gtune_lolimP[i];
+            pidInvalidateCoefficients();
         }
         result_P64[i] = (int16_t)pidProfile()->P8[i] << 6;                    // 6 bit extra resolution for P.
         OldError[i] = 0;
@@ -210,6 +211,7 @@ void calculate_Gtune(uint8_t axis)
 #endif
 
                 pidProfile()->P8[axis] = newP;                                // new P value
+                pidInvalidateCoefficients();
             }
             OldError[axis] = error;
         }
@@ -51,6 +51,7 @@
 #include "flight/mixer.h"
 #include "flight/pid.h"
 #include "flight/imu.h"
+#include "flight/imu_fixed.h"
 
 #include "io/gps.h"
 
@@ -64,10 +65,12 @@
 
 int16_t accSmooth[XYZ_AXIS_COUNT];
 int32_t accSum[XYZ_AXIS_COUNT];
+float accEarth[XYZ_AXIS_COUNT];   // cm/s/s, latest acceleration in the earth frame (north, east, up), used by the navigation filter
 
 uint32_t accTimeSum = 0;        // keep track for integration of acc
 int accSumCount = 0;
 float accVelScale;
+static float accEarthScale;
 
 float throttleAngleScale;
 float fc_acc;
@@ -92,13 +95,16 @@ PG_RESET_TEMPLATE(throttleCorrectionConfig_t, throttleCorrectionConfig,
     .throttle_correction_angle = 800,    // could be 80.0 deg with atlhold or 45.0 for fpv
 );
 
+#ifndef USE_IMU_FIXED_POINT
 STATIC_UNIT_TESTED float q0 = 1.0f, q1 = 0.0f, q2 = 0.0f, q3 = 0.0f;    // quaternion of sensor frame relative to earth frame
+#endif
 static float rMat[3][3];
 
 attitudeEulerAngles_t attitude = { { 0, 0, 0 } };     // absolute angle inclination in multiple of 0.1 degree    180 deg = 1800
 
 static float gyroScale;
 
+#ifndef USE_IMU_FIXED_POINT
 STATIC_UNIT_TESTED void imuComputeRotationMatrix(void)
 {
     float q1q1 = sq(q1);
@@ -124,6 +130,7 @@ STATIC_UNIT_TESTED void imuComputeRotationMatrix(void)
     rMat[2][1] = 2.0f * (q2q3 - -q0q1);
     rMat[2][2] = 1.0f - 2.0f * q1q1 - 2.0f * q2q2;
 }
+#endif
 
 void imuConfigure(
     imuRuntimeConfig_t *initialImuRuntimeConfig,
@@ -136,6 +143,10 @@ void imuConfigure(
     accDeadband = initialAccDeadband;
     fc_acc = calculateAccZLowPassFilterRCTimeConstant(accz_lpf_cutoff);
     throttleAngleScale = calculateThrottleAngleScale(throttle_correction_angle);
+
+#ifdef USE_IMU_FIXED_POINT
+    imuFixedConfigure(imuRuntimeConfig->dcm_kp, imuRuntimeConfig->dcm_ki);
+#endif
 }
 
 void imuInit(void)
@@ -143,8 +154,14 @@ void imuInit(void)
     smallAngleCosZ = cos_approx(degreesToRadians(imuRuntimeConfig->small_angle));
     gyroScale = gyro.scale * (M_PIf / 180.0f);  // gyro output scaled to rad per second
     accVelScale = 9.80665f / acc.acc_1G / 10000.0f;
+    accEarthScale = 980.665f / acc.acc_1G;
 
+#ifdef USE_IMU_FIXED_POINT
+    imuFixedInit(gyroScale);
+    imuFixedGetRotationMatrix(rMat);
+#else
     imuComputeRotationMatrix();
+#endif
 }
 
 float calculateThrottleAngleScale(uint16_t throttle_correction_angle)
@@ -209,6 +226,10 @@ void imuCalculateAcceleration(uint32_t deltaT)
     } else
         accel_ned.V.Z -= acc.acc_1G;
 
+    accEarth[X] = accel_ned.V.X * accEarthScale;
+    accEarth[Y] = accel_ned.V.Y * accEarthScale;
+    accEarth[Z] = accel_ned.V.Z * accEarthScale;
+
     accz_smooth = accz_smooth + (dT / (fc_acc + dT)) * (accel_ned.V.Z - accz_smooth); // low pass filter
 
     // apply Deadband to reduce integration drift and vibration influence
@@ -221,16 +242,12 @@ void imuCalculateAcceleration(uint32_t deltaT)
     accSumCount++;
 }
 
-static float invSqrt(float x)
-{
-    return 1.0f / sqrtf(x);
-}
-
 static bool imuUseFastGains(void)
 {
     return !ARMING_FLAG(ARMED) && millis() < 20000;
 }
 
+#ifndef USE_IMU_FIXED_POINT
 static float imuGetPGainScaleFactor(void)
 {
     if (imuUseFastGains()) {
@@ -241,7 +258,12 @@ static float imuGetPGainScaleFactor(void)
     }
 }
 
-static void imuMahonyAHRSupdate(float dt, float gx, float gy, float gz,
+static float invSqrt(float x)
+{
+    return 1.0f / sqrtf(x);
+}
+
+STATIC_UNIT_TESTED void imuMahonyAHRSupdate(float dt, float gx, float gy, float gz,
                                 bool useAcc, float ax, float ay, float az,
                                 bool useMag, float mx, float my, float mz,
                                 bool useYaw, float yawError)
@@ -352,6 +374,7 @@ static void imuMahonyAHRSupdate(float dt, float gx, float gy, float gz,
     // Pre-compute rotation matrix from quaternion
     imuComputeRotationMatrix();
 }
+#endif
 
 STATIC_UNIT_TESTED void imuUpdateEulerAngles(void)
 {
@@ -359,10 +382,15 @@ STATIC_UNIT_TESTED void imuUpdateEulerAngles(void)
     // this local variable should be optimized out when GPS is not used.
     float magneticDeclination = 0.0f;
 #endif
+#ifdef USE_IMU_FIXED_POINT
+    imuFixedCalculateEulerAngles(&attitude);
+    attitude.values.yaw += lrintf(magneticDeclination);
+#else
     /* Compute pitch/roll angles */
     attitude.values.roll = lrintf(atan2_approx(rMat[2][1], rMat[2][2]) * (1800.0f / M_PIf));
     attitude.values.pitch = lrintf(((0.5f * M_PIf) - acos_approx(-rMat[2][0])) * (1800.0f / M_PIf));
     attitude.values.yaw = lrintf((-atan2_approx(rMat[1][0], rMat[0][0]) * (1800.0f / M_PIf) + magneticDeclination));
+#endif
 
     if (attitude.values.yaw < 0)
         attitude.values.yaw += 3600;
@@ -410,7 +438,7 @@ static void imuCalculateEstimatedAttitude(void)
 {
     static pt1Filter_t accLPFState[3];
     static uint32_t previousIMUUpdateTime;
-    float rawYawError = 0;
+    int32_t rawYawErrorDecidegrees = 0;
     int32_t axis;
     bool useAcc = false;
     bool useMag = false;
@@ -441,16 +469,27 @@ static void imuCalculateEstimatedAttitude(void)
 #if defined(GPS)
     else if (STATE(FIXED_WING) && sensors(SENSOR_GPS) && STATE(GPS_FIX) && GPS_numSat >= 5 && GPS_speed >= 300) {
         // In case of a fixed-wing aircraft we can use GPS course over ground to correct heading
-        rawYawError = DECIDEGREES_TO_RADIANS(attitude.values.yaw - GPS_ground_course);
+        rawYawErrorDecidegrees = attitude.values.yaw - GPS_ground_course;
         useYaw = true;
     }
 #endif
 
+#ifdef USE_IMU_FIXED_POINT
+    int32_t accSample[XYZ_AXIS_COUNT] = { accSmooth[X], accSmooth[Y], accSmooth[Z] };
+
+    imuFixedMahonyAHRSupdate(deltaT, gyroADC,
+                             useAcc, accSample,
+                             useMag, magADC,
+                             useYaw, rawYawErrorDecidegrees,
+                             imuUseFastGains());
+    imuFixedGetRotationMatrix(rMat);
+#else
     imuMahonyAHRSupdate(deltaT * 1e-6f,
                         gyroADC[X] * gyroScale, gyroADC[Y] * gyroScale, gyroADC[Z] * gyroScale,
                         useAcc, accSmooth[X], accSmooth[Y], accSmooth[Z],
                         useMag, magADC[X], magADC[Y], magADC[Z],
-                        useYaw, rawYawError);
+                        useYaw, DECIDEGREES_TO_RADIANS(rawYawErrorDecidegrees));
+#endif
 
     imuUpdateEulerAngles();
 
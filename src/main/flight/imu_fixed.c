@@ -0,0 +1,241 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Fixed point Mahony AHRS for targets without an FPU (F1).
+//
+// Quaternion, rotation matrix and error vectors are unit scale values in Q30,
+// body rates are rad/s in Q24, gains are in Q24 and the integral feedback is rad/s in Q30.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <platform.h>
+
+#ifdef USE_IMU_FIXED_POINT
+
+#include "common/axis.h"
+#include "common/maths.h"
+#include "common/fixedpoint.h"
+
+#include "config/parameter_group.h"
+
+#include "drivers/sensor.h"
+#include "drivers/accgyro.h"
+
+#include "sensors/sensors.h"
+#include "sensors/acceleration.h"
+
+#include "flight/imu.h"
+#include "flight/imu_fixed.h"
+
+#define IMU_RATE_FRACTION_BITS  24
+#define IMU_GAIN_FRACTION_BITS  24
+
+// same limit as the float implementation, 20 deg/s in rad/s Q24
+#define SPIN_RATE_LIMIT_Q24     5856428
+
+// 1.9 s, keeps dt in Q30 seconds inside an int32
+#define IMU_MAX_DELTA_T_US      1900000
+
+// largest half angle rotation applied per update, keeps the un-normalised quaternion inside the Q30 range.
+// Only reached on the very first update after boot when deltaT is the time since power up.
+#define IMU_MAX_HALF_ANGLE      (FIX30_ONE / 2)
+
+static fix30_t q[4] = { FIX30_ONE, 0, 0, 0 };    // quaternion of sensor frame relative to earth frame
+static fix30_t rMat[3][3];
+static int32_t integralFB[XYZ_AXIS_COUNT];      // integral error terms scaled by Ki
+
+static int32_t dcmKp;
+static int32_t dcmKpFast;
+static int32_t dcmKi;
+static fix30_t gyroScaleQ30;                    // gyro LSB to rad/s
+
+// 2 * a * b, can reach 2.0 which does not fit a fix30_t
+static int64_t fixMulRotationTerm(fix30_t a, fix30_t b)
+{
+    return ((int64_t)a * b) >> 29;
+}
+
+static void imuFixedComputeRotationMatrix(void)
+{
+    int64_t q1q1 = fixMulRotationTerm(q[1], q[1]);
+    int64_t q2q2 = fixMulRotationTerm(q[2], q[2]);
+    int64_t q3q3 = fixMulRotationTerm(q[3], q[3]);
+
+    int64_t q0q1 = fixMulRotationTerm(q[0], q[1]);
+    int64_t q0q2 = fixMulRotationTerm(q[0], q[2]);
+    int64_t q0q3 = fixMulRotationTerm(q[0], q[3]);
+    int64_t q1q2 = fixMulRotationTerm(q[1], q[2]);
+    int64_t q1q3 = fixMulRotationTerm(q[1], q[3]);
+    int64_t q2q3 = fixMulRotationTerm(q[2], q[3]);
+
+    // the sums are bounded to [-1, 1] for a unit quaternion
+    rMat[0][0] = (fix30_t)(FIX30_ONE - q2q2 - q3q3);
+    rMat[0][1] = (fix30_t)(q1q2 - q0q3);
+    rMat[0][2] = (fix30_t)(q1q3 + q0q2);
+
+    rMat[1][0] = (fix30_t)(q1q2 + q0q3);
+    rMat[1][1] = (fix30_t)(FIX30_ONE - q1q1 - q3q3);
+    rMat[1][2] = (fix30_t)(q2q3 - q0q1);
+
+    rMat[2][0] = (fix30_t)(q1q3 - q0q2);
+    rMat[2][1] = (fix30_t)(q2q3 + q0q1);
+    rMat[2][2] = (fix30_t)(FIX30_ONE - q1q1 - q2q2);
+}
+
+void imuFixedConfigure(float dcm_kp, float dcm_ki)
+{
+    dcmKp = lrintf(dcm_kp * (1 << IMU_GAIN_FRACTION_BITS));
+    dcmKpFast = dcmKp * 10;     // see imuGetPGainScaleFactor()
+    dcmKi = lrintf(dcm_ki * (1 << IMU_GAIN_FRACTION_BITS));
+}
+
+void imuFixedInit(float gyroScale)
+{
+    gyroScaleQ30 = FIX30_FROM_FLOAT(gyroScale);
+
+    q[0] = FIX30_ONE;
+    q[1] = 0;
+    q[2] = 0;
+    q[3] = 0;
+    integralFB[X] = 0;
+    integralFB[Y] = 0;
+    integralFB[Z] = 0;
+
+    imuFixedComputeRotationMatrix();
+}
+
+void imuFixedMahonyAHRSupdate(uint32_t deltaT, const int32_t *gyro,
+                              bool useAcc, const int32_t *acc,
+                              bool useMag, const int32_t *mag,
+                              bool useYaw, int32_t yawErrorDecidegrees,
+                              bool useFastGains)
+{
+    fix30_t error[XYZ_AXIS_COUNT] = { 0, 0, 0 };
+    int32_t rate[XYZ_AXIS_COUNT];
+    int64_t spinRateSq = 0;
+    int axis;
+
+    for (axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        rate[axis] = (int32_t)(((int64_t)gyro[axis] * gyroScaleQ30) >> (30 - IMU_RATE_FRACTION_BITS));
+        spinRateSq += (int64_t)rate[axis] * rate[axis];
+    }
+
+    // Use raw heading error (from GPS or whatever else), binary angles wrap to +-180 degrees by themselves
+    if (useYaw) {
+        error[Z] += fixSin(fixAngleFromDecidegrees(yawErrorDecidegrees) / 2);
+    }
+
+    // Use measured magnetic field vector
+    fix30_t m[XYZ_AXIS_COUNT];
+    if (useMag && fixNormalize(mag, m, XYZ_AXIS_COUNT)) {
+        // (hx; hy; 0) - measured mag field vector in EF (assuming Z-component is zero)
+        // (bx; 0; 0) - reference mag field vector heading due North in EF (assuming Z-component is zero)
+        fix30_t hx = fixMul30(rMat[0][0], m[X]) + fixMul30(rMat[0][1], m[Y]) + fixMul30(rMat[0][2], m[Z]);
+        fix30_t hy = fixMul30(rMat[1][0], m[X]) + fixMul30(rMat[1][1], m[Y]) + fixMul30(rMat[1][2], m[Z]);
+        int32_t bx;
+        fixAtan2(hy, hx, &bx);
+
+        // magnetometer error is cross product between estimated magnetic north and measured magnetic north (calculated in EF)
+        fix30_t ezEf = -fixMul30(hy, bx);
+
+        // Rotate mag error vector back to BF and accumulate
+        error[X] += fixMul30(rMat[2][0], ezEf);
+        error[Y] += fixMul30(rMat[2][1], ezEf);
+        error[Z] += fixMul30(rMat[2][2], ezEf);
+    }
+
+    // Use measured acceleration vector
+    fix30_t a[XYZ_AXIS_COUNT];
+    if (useAcc && fixNormalize(acc, a, XYZ_AXIS_COUNT)) {
+        // Error is sum of cross product between estimated direction and measured direction of gravity
+        error[X] += fixMul30(a[Y], rMat[2][2]) - fixMul30(a[Z], rMat[2][1]);
+        error[Y] += fixMul30(a[Z], rMat[2][0]) - fixMul30(a[X], rMat[2][2]);
+        error[Z] += fixMul30(a[X], rMat[2][1]) - fixMul30(a[Y], rMat[2][0]);
+    }
+
+    fix30_t dt = (fix30_t)(((uint64_t)MIN(deltaT, IMU_MAX_DELTA_T_US) * 1125899907ULL) >> 20);  // 2^50 / 10^6
+
+    // Compute and apply integral feedback if enabled
+    if (dcmKi > 0) {
+        // Stop integrating if spinning beyond the certain limit
+        if (spinRateSq < (int64_t)SPIN_RATE_LIMIT_Q24 * SPIN_RATE_LIMIT_Q24) {
+            for (axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+                integralFB[axis] += (int32_t)(((((int64_t)dcmKi * error[axis]) >> IMU_GAIN_FRACTION_BITS) * dt) >> 30);
+            }
+        }
+    } else {
+        // prevent integral windup
+        integralFB[X] = 0;
+        integralFB[Y] = 0;
+        integralFB[Z] = 0;
+    }
+
+    int32_t kp = useFastGains ? dcmKpFast : dcmKp;
+    fix30_t halfAngle[XYZ_AXIS_COUNT];
+
+    for (axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        // Apply proportional and integral feedback
+        rate[axis] += (int32_t)(((int64_t)kp * error[axis]) >> 30) + (integralFB[axis] >> (30 - IMU_RATE_FRACTION_BITS));
+
+        // Integrate rate of change of quaternion, 0.5 * rate * dt
+        int64_t angle = ((int64_t)rate[axis] * dt) >> (IMU_RATE_FRACTION_BITS + 1);
+        if (angle > IMU_MAX_HALF_ANGLE) {
+            angle = IMU_MAX_HALF_ANGLE;
+        } else if (angle < -IMU_MAX_HALF_ANGLE) {
+            angle = -IMU_MAX_HALF_ANGLE;
+        }
+        halfAngle[axis] = (fix30_t)angle;
+    }
+
+    fix30_t qa = q[0];
+    fix30_t qb = q[1];
+    fix30_t qc = q[2];
+    q[0] += -fixMul30(qb, halfAngle[X]) - fixMul30(qc, halfAngle[Y]) - fixMul30(q[3], halfAngle[Z]);
+    q[1] += fixMul30(qa, halfAngle[X]) + fixMul30(qc, halfAngle[Z]) - fixMul30(q[3], halfAngle[Y]);
+    q[2] += fixMul30(qa, halfAngle[Y]) - fixMul30(qb, halfAngle[Z]) + fixMul30(q[3], halfAngle[X]);
+    q[3] += fixMul30(qa, halfAngle[Z]) + fixMul30(qb, halfAngle[Y]) - fixMul30(qc, halfAngle[X]);
+
+    // Normalise quaternion
+    fixNormalize(q, q, 4);
+
+    // Pre-compute rotation matrix from quaternion
+    imuFixedComputeRotationMatrix();
+}
+
+void imuFixedGetRotationMatrix(float dest[3][3])
+{
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            dest[i][j] = FIX30_TO_FLOAT(rMat[i][j]);
+        }
+    }
+}
+
+void imuFixedCalculateEulerAngles(attitudeEulerAngles_t *attitude)
+{
+    int32_t cosPitch;
+
+    attitude->values.roll = fixAngleToDecidegrees(fixAtan2(rMat[2][1], rMat[2][2], &cosPitch));
+    // asin(-r20) == atan2(-r20, sqrt(r21^2 + r22^2))
+    attitude->values.pitch = fixAngleToDecidegrees(fixAtan2(-rMat[2][0], cosPitch, NULL));
+    attitude->values.yaw = -fixAngleToDecidegrees(fixAtan2(rMat[1][0], rMat[0][0], NULL));
+}
+
+#endif
@@ -0,0 +1,33 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Fixed point implementation of the Mahony AHRS, selected with USE_IMU_FIXED_POINT.
+// Intended for targets without an FPU, it uses the same gains as the float implementation in imu.c.
+
+void imuFixedConfigure(float dcm_kp, float dcm_ki);
+void imuFixedInit(float gyroScale);
+
+void imuFixedMahonyAHRSupdate(uint32_t deltaT, const int32_t *gyro,
+                              bool useAcc, const int32_t *acc,
+                              bool useMag, const int32_t *mag,
+                              bool useYaw, int32_t yawErrorDecidegrees,
+                              bool useFastGains);
+
+void imuFixedGetRotationMatrix(float rMat[3][3]);
+void imuFixedCalculateEulerAngles(attitudeEulerAngles_t *attitude);
@@ -49,6 +49,7 @@
 #include "sensors/acceleration.h"
 
 #include "flight/mixer.h"
+#include "flight/servos.h"
 #include "flight/failsafe.h"
 #include "flight/pid.h"
 #include "flight/imu.h"
@@ -398,19 +399,61 @@ void mixerResetDisarmedMotors(void)
     }
 }
 
-void writeMotors(void)
+static void stageMotors(void)
 {
     uint8_t i;
 
     for (i = 0; i < motorCount; i++)
         pwmWriteMotor(i, motor[i]);
+}
 
+static void completeMotorUpdate(void)
+{
+#ifdef USE_DSHOT
+    if (feature(FEATURE_DSHOT)) {
+        // one DMA burst per timer sends the frames of all its motors
+        pwmCompleteDshotMotorUpdate();
+        return;
+    }
+#endif
 
     if (feature(FEATURE_ONESHOT125)) {
         pwmCompleteOneshotMotorUpdate(motorCount);
     }
 }
 
+void writeMotors(void)
+{
+    pwmOutputBeginUpdate();
+    stageMotors();
+    pwmOutputCommitUpdate();
+
+    completeMotorUpdate();
+}
+
+/*
+ * Writes the servo and motor values of one PID cycle as a single output frame.
+ * Nothing is latched until every value has been staged, so the tail servo and the motors of a tricopter
+ * change on the same timer update instead of one loop apart.
+ */
+void writeOutputFrame(bool includeMotors)
+{
+    pwmOutputBeginUpdate();
+
+#ifdef USE_SERVOS
+    writeServos();
+#endif
+    if (includeMotors) {
+        stageMotors();
+    }
+
+    pwmOutputCommitUpdate();
+
+    if (includeMotors) {
+        completeMotorUpdate();
+    }
+}
+
 void writeAllMotors(int16_t mc)
 {
     uint8_t i;
@@ -438,9 +481,42 @@ uint16_t mixConstrainMotorForFailsafeCondition(uint8_t motorIndex)
     return constrain(motor[motorIndex], motorConfig()->mincommand, motorConfig()->maxthrottle);
 }
 
+/*
+ * Reports to the PID controller how much of each axis output the motors could not deliver: the difference between
+ * what the mix asked of each motor and what it got after limiting, projected back onto the mixer column of that axis.
+ * Throttle shifts and limiting are the same on all motors and drop out of the projection.
+ * Axes without motor authority (tricopter yaw) are left to the servo mixer.
+ */
+static void updateMotorSaturation(const int16_t *motorDemand)
+{
+    float clipped[XYZ_AXIS_COUNT] = { 0.0f, 0.0f, 0.0f };
+    float authority[XYZ_AXIS_COUNT] = { 0.0f, 0.0f, 0.0f };
+
+    for (uint32_t i = 0; i < motorCount; i++) {
+        const float error = motorDemand[i] - motor[i];
+        const float axisMix[XYZ_AXIS_COUNT] = {
+            currentMixer[i].roll,
+            currentMixer[i].pitch,
+            -mixerConfig()->yaw_motor_direction * currentMixer[i].yaw
+        };
+
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            clipped[axis] += error * axisMix[axis];
+            authority[axis] += axisMix[axis] * axisMix[axis];
+        }
+    }
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        if (authority[axis] > 0.0f) {
+            pidSetActuatorSaturation(axis, lrintf(clipped[axis] / authority[axis]));
+        }
+    }
+}
+
 void mixTable(void)
 {
     uint32_t i;
+    int16_t motorDemand[MAX_SUPPORTED_MOTORS];  // motor outputs needed to deliver the PID output in full
 
     bool isFailsafeActive = failsafeIsActive();
 
@@ -462,6 +538,8 @@ void mixTable(void)
                 axisPID[FD_ROLL] * currentMixer[i].roll +
                 -mixerConfig()->yaw_motor_direction * axisPID[FD_YAW] * currentMixer[i].yaw;
 
+            motorDemand[i] = rollPitchYawMix[i];
+
             if (rollPitchYawMix[i] > rollPitchYawMixMax) rollPitchYawMixMax = rollPitchYawMix[i];
             if (rollPitchYawMix[i] < rollPitchYawMixMin) rollPitchYawMixMin = rollPitchYawMix[i];
         }
@@ -521,6 +599,7 @@ void mixTable(void)
         for (i = 0; i < motorCount; i++) {
             motor[i] = rollPitchYawMix[i] + constrain(throttle * currentMixer[i].throttle, throttleMin, throttleMax);
             motor[i] += triGetMotorCorrection(i);
+            motorDemand[i] += motor[i] - rollPitchYawMix[i];
 
             if (isFailsafeActive) {
                 motor[i] = mixConstrainMotorForFailsafeCondition(i);
@@ -546,6 +625,7 @@ void mixTable(void)
                 axisPID[FD_PITCH] * currentMixer[i].pitch +
                 axisPID[FD_ROLL] * currentMixer[i].roll +
                 -mixerConfig()->yaw_motor_direction * axisPID[FD_YAW] * currentMixer[i].yaw + triGetMotorCorrection(i);
+            motorDemand[i] = motor[i];
         }
 
         // Find the maximum motor output.
@@ -606,6 +686,7 @@ void mixTable(void)
         }
     }
 
+    updateMotorSaturation(motorDemand);
 
     /* Disarmed for all mixers */
     if (!ARMING_FLAG(ARMED)) {
@@ -123,6 +123,7 @@ void mixerResetDisarmedMotors(void);
 void mixTable(void);
 void servoMixTable(void);
 void writeMotors(void);
+void writeOutputFrame(bool includeMotors);
 void stopMotors(void);
 void StopPwmAllMotors(void);
 void mixerInitialiseServoFiltering(uint32_t targetLooptime);
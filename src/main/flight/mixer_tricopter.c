@@ -103,8 +103,9 @@ static void triTailTuneStep(servoParam_t *pServoConf, int16_t *pServoVal);
 static void updateServoAngle(void);
 static void updateServoFeedbackADCChannel(uint8_t tri_servo_feedback);
 static void predictGyroOnDecceleration(void);
-static int16_t getScaledPIDatThrottle(int16_t PIDoutput);
+static int32_t getScaledPIDatThrottle(int16_t PIDoutput);
 static void tailMotorStep(int16_t setpoint, float dT);
+static float getTailLag(void);
 static int8_t triGetServoDirection(void);
 
 void triInitMixer(servoParam_t *pTailServoConfig, int16_t *pTailServo)
@@ -175,15 +176,24 @@ static uint16_t getNormalServoValue(servoParam_t *servoConf, int16_t constrained
 
 void triServoMixer(int16_t PIDoutput)
 {
-    static pt1Filter_t feedbackFilter;
-
     // Dynamic yaw expects input [-1000, 1000]
-    PIDoutput = constrain(PIDoutput, -1000, 1000);
-    PIDoutput = getScaledPIDatThrottle(PIDoutput);
+    const int16_t constrainedPIDoutput = constrain(PIDoutput, -1000, 1000);
+    const int32_t scaledPIDoutput = getScaledPIDatThrottle(constrainedPIDoutput);
+    const int16_t servoPIDoutput = constrain(scaledPIDoutput, -1000, 1000);
+
+    // Report the part of the yaw PID output the servo could not deliver, in PID units,
+    // so the yaw I-term stops winding up against the servo end points
+    int32_t deliveredPIDoutput = constrainedPIDoutput;
+    if (scaledPIDoutput != 0) {
+        deliveredPIDoutput = servoPIDoutput * constrainedPIDoutput / scaledPIDoutput;
+    }
+    pidSetActuatorSaturation(FD_YAW, constrain(PIDoutput - deliveredPIDoutput, INT16_MIN, INT16_MAX));
+    PIDoutput = servoPIDoutput;
 
     if (gpMixerConfig->tri_servo_feedback != TRI_SERVO_FB_VIRTUAL) {
-        // Read new servo feedback signal sample and run it through filter
-        tailServo.ADC = pt1FilterApply4(&feedbackFilter, adcGetChannel(tailServoADCChannel), 70, getdT());
+        // The ADC driver already averages the latest conversions, no further filtering
+        // so the feedback does not lag behind the servo it is meant to track
+        tailServo.ADC = adcGetChannel(tailServoADCChannel);
     }
     // Linear servo logic only in armed state
     if (ARMING_FLAG(ARMED)) {
@@ -196,6 +206,7 @@ void triServoMixer(int16_t PIDoutput)
     // Update the tail motor virtual feedback
     tailMotorStep(motor[TRI_TAIL_MOTOR_INDEX], getdT());
     predictGyroOnDecceleration();
+    pidSetTailLag(getTailLag());
 }
 
 int16_t triGetMotorCorrection(uint8_t motorIndex)
@@ -739,7 +750,8 @@ static void predictGyroOnDecceleration(void)
     }
 }
 
-static int16_t getScaledPIDatThrottle(int16_t PIDoutput)
+// Returns the yaw output scaled for the tail motor speed, not limited to the servo range
+static int32_t getScaledPIDatThrottle(int16_t PIDoutput)
 {
     const int16_t halfRange = throttleRange / 2;
     const int16_t midpoint = motorConfig()->minthrottle + halfRange;
@@ -758,10 +770,9 @@ static int16_t getScaledPIDatThrottle(int16_t PIDoutput)
         gain = 100 - currentControlRateProfile->tri_dynamic_yaw_maxthrottle;
     }
     const int16_t distanceFromMid = tailMotor.virtualFeedBack - midpoint;
-    const int16_t scaledPIDoutput = PIDoutput - distanceFromMid * gain * PIDoutput / (halfRange * 100);
-    const int16_t pid = constrain(scaledPIDoutput, -1000, 1000);
+    const int32_t scaledPIDoutput = PIDoutput - distanceFromMid * gain * PIDoutput / (halfRange * 100);
 
-    return pid;
+    return scaledPIDoutput;
 }
 
 static void tailMotorStep(int16_t setpoint, float dT)
@@ -786,6 +797,24 @@ static void tailMotorStep(int16_t setpoint, float dT)
     tailMotor.virtualFeedBack = pt1FilterApply4(&motorFilter, current, 5, dT);
 }
 
+// Time needed by the tail to deliver the current command: the servo travel left at the configured servo speed
+// or the tail motor speed change left at the configured motor acceleration, whichever is longer.
+static float getTailLag(void)
+{
+    float servoLag = 0.0f;
+    float motorLag = 0.0f;
+
+    if (tailServo.speed > 0) {
+        const int16_t servoSetpointAngle = getServoAngle(gpTailServoConf, *gpTailServo);
+        servoLag = ABS(servoSetpointAngle - (int16_t)tailServo.angle) / (tailServo.speed * 10.0f);
+    }
+    if (motorAcceleration > 0.0f) {
+        motorLag = fabsf(motor[TRI_TAIL_MOTOR_INDEX] - tailMotor.virtualFeedBack) / motorAcceleration;
+    }
+
+    return MAX(servoLag, motorLag);
+}
+
 static int8_t triGetServoDirection(void)
 {
     const int8_t direction = (int8_t) servoDirection(SERVO_RUDDER, INPUT_STABILIZED_YAW);
@@ -50,6 +50,7 @@
 
 #include "flight/pid.h"
 #include "flight/navigation.h"
+#include "flight/navigation_ins.h"
 #include "flight/gps_conversion.h"
 #include "flight/imu.h"
 
@@ -95,6 +96,8 @@ PG_RESET_TEMPLATE(gpsProfile_t, gpsProfile,
     .nav_speed_min = 100,
     .nav_speed_max = 300,
     .ap_mode = 40,
+    .nav_inertial = 0,
+    .nav_gps_delay = 50,
 );
 
 
@@ -132,6 +135,9 @@ static void GPS_calc_poshold(void);
 static void GPS_calc_nav_rate(uint16_t max_speed);
 static void GPS_update_crosstrack(void);
 static uint16_t GPS_calc_desired_speed(uint16_t max_speed, bool _slow);
+static void GPS_calc_navigation(int32_t *lat, int32_t *lon);
+static bool GPS_use_inertial(void);
+static void GPS_correct_inertial(void);
 
 static int32_t wrap_18000(int32_t error);
 static int32_t wrap_36000(int32_t angle);
@@ -282,7 +288,6 @@ void onGpsNewData(void)
 {
     int axis;
     static uint32_t nav_loopTimer;
-    uint16_t speed;
 
 
     if (!(STATE(GPS_FIX) && GPS_numSat >= 5)) {
@@ -295,6 +300,13 @@ void onGpsNewData(void)
     if (!STATE(GPS_FIX_HOME) && ARMING_FLAG(ARMED))
         GPS_reset_home_position();
 
+    if (GPS_use_inertial()) {
+        // the navigation pids run at the filter rate, see updateGpsInertialNavigation()
+        GPS_correct_inertial();
+        GPS_calculateDistanceAndDirectionToHome();
+        return;
+    }
+
     // Apply moving average filter to GPS data
 #if defined(GPS_FILTERING)
     GPS_filter_index = (GPS_filter_index + 1) % GPS_FILTER_VECTOR_LENGTH;
@@ -331,12 +343,22 @@ void onGpsNewData(void)
     // calculate the current velocity based on gps coordinates continously to get a valid speed at the moment when we start navigating
     GPS_calc_velocity();
 
+    GPS_calc_navigation(&GPS_coord[LAT], &GPS_coord[LON]);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+// Run the navigation pids for the given position, actual_speed and dTnav must be up to date
+//
+static void GPS_calc_navigation(int32_t *lat, int32_t *lon)
+{
+    uint16_t speed;
+
     if (FLIGHT_MODE(GPS_HOLD_MODE) || FLIGHT_MODE(GPS_HOME_MODE)) {
         // we are navigating
 
         // gps nav calculations, these are common for nav and poshold
-        GPS_distance_cm_bearing(&GPS_coord[LAT], &GPS_coord[LON], &GPS_WP[LAT], &GPS_WP[LON], &wp_distance, &target_bearing);
-        GPS_calc_location_error(&GPS_WP[LAT], &GPS_WP[LON], &GPS_coord[LAT], &GPS_coord[LON]);
+        GPS_distance_cm_bearing(lat, lon, &GPS_WP[LAT], &GPS_WP[LON], &wp_distance, &target_bearing);
+        GPS_calc_location_error(&GPS_WP[LAT], &GPS_WP[LON], lat, lon);
 
         switch (nav_mode) {
         case NAV_MODE_POSHOLD:
@@ -519,6 +541,74 @@ static void GPS_calc_velocity(void)
     last_coord[LAT] = GPS_coord[LAT];
 }
 
+////////////////////////////////////////////////////////////////////////////////////
+// Inertial navigation, see flight/navigation_ins.c
+// The filter works in cm north and east of the first fix, the navigation code in lat/lon units
+//
+static navIns_t navIns;
+static int32_t navInsOrigin[2];
+static float navInsScaleLonDown = 1.0f;
+
+// the filter rotates the accelerometer into north and east with the heading, which is arbitrary without a magnetometer
+static bool GPS_use_inertial(void)
+{
+    return gpsProfile()->nav_inertial && sensors(SENSOR_ACC) && sensors(SENSOR_MAG);
+}
+
+static void GPS_correct_inertial(void)
+{
+    float pos[2];
+    float vel[2];
+    uint16_t latency = gpsProfile()->nav_gps_delay;
+
+    if (!navIns.valid) {
+        navInsOrigin[LAT] = GPS_coord[LAT];
+        navInsOrigin[LON] = GPS_coord[LON];
+        navInsScaleLonDown = cos_approx((ABS((float)GPS_coord[LAT]) / 10000000.0f) * 0.0174532925f);
+    }
+
+    pos[LAT] = (GPS_coord[LAT] - navInsOrigin[LAT]) * DISTANCE_BETWEEN_TWO_LONGITUDE_POINTS_AT_EQUATOR_IN_HUNDREDS_OF_KILOMETERS;
+    pos[LON] = (GPS_coord[LON] - navInsOrigin[LON]) * DISTANCE_BETWEEN_TWO_LONGITUDE_POINTS_AT_EQUATOR_IN_HUNDREDS_OF_KILOMETERS * navInsScaleLonDown;
+    vel[LAT] = GPS_velNED[0];
+    vel[LON] = GPS_velNED[1];
+
+    if (GPS_timeOfWeek) {
+        latency = navInsEstimateLatency(&navIns, gpsData.lastMessage, GPS_timeOfWeek, latency);
+    }
+
+    navInsCorrect(&navIns, pos, GPS_velNEDValid ? vel : NULL, gpsData.lastMessage, latency);
+}
+
+// Called at the GPS task rate, predicts the position between fixes and runs the navigation pids on it
+void updateGpsInertialNavigation(void)
+{
+    int32_t coord[2];
+    static uint32_t nav_loopTimer;
+
+    if (!GPS_use_inertial()) {
+        return;
+    }
+
+    const uint32_t now = millis();
+    const float acc[NAV_INS_AXIS_COUNT] = { accEarth[X], accEarth[Y] };
+
+    navInsPredict(&navIns, acc, now);
+    if (!navIns.valid) {
+        return;
+    }
+
+    dTnav = (float)(now - nav_loopTimer) / 1000.0f;
+    nav_loopTimer = now;
+    dTnav = MIN(dTnav, 1.0f);
+
+    coord[LAT] = navInsOrigin[LAT] + lrintf(navIns.pos[NAV_INS_NORTH] / DISTANCE_BETWEEN_TWO_LONGITUDE_POINTS_AT_EQUATOR_IN_HUNDREDS_OF_KILOMETERS);
+    coord[LON] = navInsOrigin[LON] + lrintf(navIns.pos[NAV_INS_EAST] / (DISTANCE_BETWEEN_TWO_LONGITUDE_POINTS_AT_EQUATOR_IN_HUNDREDS_OF_KILOMETERS * navInsScaleLonDown));
+    actual_speed[GPS_Y] = constrainf(navIns.vel[NAV_INS_NORTH] / DISTANCE_BETWEEN_TWO_LONGITUDE_POINTS_AT_EQUATOR_IN_HUNDREDS_OF_KILOMETERS, INT16_MIN, INT16_MAX);
+    actual_speed[GPS_X] = constrainf(navIns.vel[NAV_INS_EAST] / DISTANCE_BETWEEN_TWO_LONGITUDE_POINTS_AT_EQUATOR_IN_HUNDREDS_OF_KILOMETERS, INT16_MIN, INT16_MAX);
+
+    GPS_calc_navigation(&coord[LAT], &coord[LON]);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////
 // Calculate a location error between two gps coordinates
 // Because we are using lat and lon to do our distance errors here's a quick chart:
@@ -34,6 +34,8 @@ typedef struct gpsProfile_s {
     uint16_t nav_speed_min;                 // cm/sec
     uint16_t nav_speed_max;                 // cm/sec
     uint16_t ap_mode;                       // Temporarily Disables GPS_HOLD_MODE to be able to make it possible to adjust the Hold-position when moving the sticks, creating a deadspan for GPS
+    uint8_t nav_inertial;                   // fuse GPS with the accelerometer and run the navigation pids at the GPS task rate
+    uint8_t nav_gps_delay;                  // ms, time the GPS receiver needs to compute a solution before sending it
 } gpsProfile_t;
 
 PG_DECLARE_PROFILE(gpsProfile_t, gpsProfile);
@@ -57,3 +59,4 @@ void updateGpsStateForHomeAndHoldMode(void);
 void updateGpsWaypointsAndMode(void);
 
 void onGpsNewData(void);
+void updateGpsInertialNavigation(void);
@@ -0,0 +1,224 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <platform.h>
+
+#ifdef GPS
+
+#include "common/maths.h"
+
+#include "flight/navigation_ins.h"
+
+// Correction gains, per second of time between two solutions. Position errors alone correct the velocity and
+// the accelerometer bias as well, with a velocity measurement they only correct the position.
+#define NAV_INS_GAIN_POS                2.0f
+#define NAV_INS_GAIN_POS_VEL            1.0f
+#define NAV_INS_GAIN_POS_ACC_BIAS       0.05f
+#define NAV_INS_GAIN_VEL                2.0f
+#define NAV_INS_GAIN_VEL_ACC_BIAS       0.2f
+
+#define NAV_INS_MAX_ACC_BIAS            100.0f  // cm/s/s, about 0.1G
+#define NAV_INS_MAX_PREDICT_MS          100
+#define NAV_INS_MAX_CORRECTION_MS       500
+#define NAV_INS_RESET_DISTANCE          5000.0f // cm, the filter is restarted if a solution is further away
+#define NAV_INS_CLOCK_CREEP_SOLUTIONS   32      // the clock offset is raised by 1ms per this many solutions
+
+void navInsInit(navIns_t *ins)
+{
+    memset(ins, 0, sizeof(*ins));
+}
+
+// Starts the filter at the given position, the velocity is zero unless given.
+void navInsReset(navIns_t *ins, const float pos[NAV_INS_AXIS_COUNT], const float *vel, uint32_t timeMs)
+{
+    int axis;
+
+    for (axis = 0; axis < NAV_INS_AXIS_COUNT; axis++) {
+        ins->pos[axis] = pos[axis];
+        ins->vel[axis] = vel ? vel[axis] : 0.0f;
+        ins->accBias[axis] = 0.0f;
+    }
+    ins->timeMs = timeMs;
+    ins->lastCorrectionMs = timeMs;
+    ins->historyHead = 0;
+    ins->historyCount = 0;
+    ins->valid = true;
+}
+
+static void navInsRecordHistory(navIns_t *ins)
+{
+    if (ins->historyCount) {
+        const navInsHistory_t *newest = &ins->history[(ins->historyHead + NAV_INS_HISTORY_SIZE - 1) % NAV_INS_HISTORY_SIZE];
+        if (ins->timeMs - newest->timeMs < NAV_INS_HISTORY_INTERVAL_MS) {
+            return;
+        }
+    }
+
+    navInsHistory_t *entry = &ins->history[ins->historyHead];
+    entry->timeMs = ins->timeMs;
+    memcpy(entry->pos, ins->pos, sizeof(entry->pos));
+    memcpy(entry->vel, ins->vel, sizeof(entry->vel));
+
+    ins->historyHead = (ins->historyHead + 1) % NAV_INS_HISTORY_SIZE;
+    if (ins->historyCount < NAV_INS_HISTORY_SIZE) {
+        ins->historyCount++;
+    }
+}
+
+// Returns the estimate at timeMs, interpolated between the kept ones, or the oldest one kept if it is older.
+static void navInsEstimateAt(const navIns_t *ins, uint32_t timeMs, float pos[NAV_INS_AXIS_COUNT], float vel[NAV_INS_AXIS_COUNT])
+{
+    const float *newerPos = ins->pos;
+    const float *newerVel = ins->vel;
+    uint32_t newerTimeMs = ins->timeMs;
+    float fraction = 1.0f;
+    int axis;
+    uint8_t i;
+
+    for (i = 1; i <= ins->historyCount; i++) {
+        const navInsHistory_t *entry = &ins->history[(ins->historyHead + NAV_INS_HISTORY_SIZE - i) % NAV_INS_HISTORY_SIZE];
+        if ((int32_t)(timeMs - entry->timeMs) >= 0) {
+            if (newerTimeMs != entry->timeMs) {
+                fraction = MIN((float)(timeMs - entry->timeMs) / (newerTimeMs - entry->timeMs), 1.0f);
+            }
+            for (axis = 0; axis < NAV_INS_AXIS_COUNT; axis++) {
+                pos[axis] = entry->pos[axis] + (newerPos[axis] - entry->pos[axis]) * fraction;
+                vel[axis] = entry->vel[axis] + (newerVel[axis] - entry->vel[axis]) * fraction;
+            }
+            return;
+        }
+        newerPos = entry->pos;
+        newerVel = entry->vel;
+        newerTimeMs = entry->timeMs;
+    }
+
+    memcpy(pos, newerPos, sizeof(float) * NAV_INS_AXIS_COUNT);
+    memcpy(vel, newerVel, sizeof(float) * NAV_INS_AXIS_COUNT);
+}
+
+void navInsPredict(navIns_t *ins, const float acc[NAV_INS_AXIS_COUNT], uint32_t timeMs)
+{
+    int axis;
+
+    if (!ins->valid) {
+        return;
+    }
+
+    if (timeMs - ins->lastCorrectionMs > NAV_INS_TIMEOUT_MS) {
+        ins->valid = false;
+        return;
+    }
+
+    const float dT = MIN(timeMs - ins->timeMs, NAV_INS_MAX_PREDICT_MS) / 1000.0f;
+
+    for (axis = 0; axis < NAV_INS_AXIS_COUNT; axis++) {
+        const float a = acc[axis] - ins->accBias[axis];
+        ins->pos[axis] += (ins->vel[axis] + 0.5f * a * dT) * dT;
+        ins->vel[axis] += a * dT;
+    }
+    ins->timeMs = timeMs;
+
+    navInsRecordHistory(ins);
+}
+
+/*
+ * Corrects the estimate with a GPS position and, if the receiver reports it, velocity that arrived at timeMs
+ * and were measured latencyMs earlier. The errors are taken against the estimate of that time and the
+ * correction is added to it and to everything predicted since, so the next solution is compared with
+ * corrected values.
+ */
+void navInsCorrect(navIns_t *ins, const float pos[NAV_INS_AXIS_COUNT], const float *vel, uint32_t timeMs, uint16_t latencyMs)
+{
+    float posThen[NAV_INS_AXIS_COUNT];
+    float velThen[NAV_INS_AXIS_COUNT];
+    float posCorrection[NAV_INS_AXIS_COUNT];
+    float velCorrection[NAV_INS_AXIS_COUNT];
+    int axis;
+    uint8_t i;
+
+    if (!ins->valid) {
+        navInsReset(ins, pos, vel, timeMs);
+        return;
+    }
+
+    navInsEstimateAt(ins, timeMs - MIN(latencyMs, NAV_INS_MAX_LATENCY_MS), posThen, velThen);
+
+    for (axis = 0; axis < NAV_INS_AXIS_COUNT; axis++) {
+        if (ABS(pos[axis] - posThen[axis]) > NAV_INS_RESET_DISTANCE) {
+            navInsReset(ins, pos, vel, timeMs);
+            return;
+        }
+    }
+
+    const float dT = MIN(timeMs - ins->lastCorrectionMs, NAV_INS_MAX_CORRECTION_MS) / 1000.0f;
+    ins->lastCorrectionMs = timeMs;
+
+    for (axis = 0; axis < NAV_INS_AXIS_COUNT; axis++) {
+        const float posError = pos[axis] - posThen[axis];
+
+        posCorrection[axis] = posError * NAV_INS_GAIN_POS * dT;
+        if (vel) {
+            const float velError = vel[axis] - velThen[axis];
+            velCorrection[axis] = velError * NAV_INS_GAIN_VEL * dT;
+            ins->accBias[axis] -= velError * NAV_INS_GAIN_VEL_ACC_BIAS * dT;
+        } else {
+            velCorrection[axis] = posError * NAV_INS_GAIN_POS_VEL * dT;
+            ins->accBias[axis] -= posError * NAV_INS_GAIN_POS_ACC_BIAS * dT;
+        }
+        ins->accBias[axis] = constrainf(ins->accBias[axis], -NAV_INS_MAX_ACC_BIAS, NAV_INS_MAX_ACC_BIAS);
+    }
+
+    for (axis = 0; axis < NAV_INS_AXIS_COUNT; axis++) {
+        ins->pos[axis] += posCorrection[axis];
+        ins->vel[axis] += velCorrection[axis];
+        for (i = 0; i < ins->historyCount; i++) {
+            ins->history[i].pos[axis] += posCorrection[axis];
+            ins->history[i].vel[axis] += velCorrection[axis];
+        }
+    }
+}
+
+/*
+ * Returns the age of a solution for the epoch timeOfWeekMs that completed at arrivalMs.
+ *
+ * The difference between the two is the offset between our clock and the GPS clock plus the time it took
+ * the solution to get here. The smallest difference seen is taken as the offset, raised slowly to follow
+ * clock drift, so whatever a solution adds to it is its delay. The time the receiver needs before it starts
+ * sending is the same for every solution and cannot be seen this way, processingMs is added for it.
+ */
+uint16_t navInsEstimateLatency(navIns_t *ins, uint32_t arrivalMs, uint32_t timeOfWeekMs, uint16_t processingMs)
+{
+    const int32_t offset = (int32_t)(arrivalMs - timeOfWeekMs);
+
+    if (!ins->clockOffsetValid || offset < ins->clockOffsetMs || offset - ins->clockOffsetMs > NAV_INS_TIMEOUT_MS) {
+        // first solution, a faster one, or the receiver restarted or started a new week
+        ins->clockOffsetMs = offset;
+        ins->clockOffsetCreep = 0;
+        ins->clockOffsetValid = true;
+    } else if (++ins->clockOffsetCreep >= NAV_INS_CLOCK_CREEP_SOLUTIONS) {
+        ins->clockOffsetMs++;
+        ins->clockOffsetCreep = 0;
+    }
+
+    return MIN(processingMs + (offset - ins->clockOffsetMs), NAV_INS_MAX_LATENCY_MS);
+}
+
+#endif
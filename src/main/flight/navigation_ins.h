@@ -0,0 +1,67 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Horizontal inertial navigation filter.
+//
+// Position and velocity north and east of an origin are predicted at a fixed rate from the earth frame
+// acceleration of the IMU and corrected by every GPS solution. A solution describes where the aircraft was
+// when the receiver computed it, not where it is when the last byte arrives, so it is compared with the
+// estimate the filter had at that time and the difference is applied to the current estimate.
+
+#define NAV_INS_HISTORY_SIZE            16
+#define NAV_INS_HISTORY_INTERVAL_MS     20      // 16 entries cover 320ms of GPS latency
+#define NAV_INS_MAX_LATENCY_MS          (NAV_INS_HISTORY_SIZE * NAV_INS_HISTORY_INTERVAL_MS)
+#define NAV_INS_TIMEOUT_MS              1000    // dead reckoning is stopped if no solution arrives for this long
+
+typedef enum {
+    NAV_INS_NORTH = 0,                  // same order as LAT/LON
+    NAV_INS_EAST,
+    NAV_INS_AXIS_COUNT
+} navInsAxis_e;
+
+typedef struct navInsHistory_s {
+    uint32_t timeMs;
+    float pos[NAV_INS_AXIS_COUNT];
+    float vel[NAV_INS_AXIS_COUNT];
+} navInsHistory_t;
+
+typedef struct navIns_s {
+    bool valid;
+    uint32_t timeMs;                    // time of the estimate
+    float pos[NAV_INS_AXIS_COUNT];      // cm from the origin
+    float vel[NAV_INS_AXIS_COUNT];      // cm/s
+    float accBias[NAV_INS_AXIS_COUNT];  // cm/s/s, subtracted from the IMU acceleration
+
+    uint32_t lastCorrectionMs;
+
+    navInsHistory_t history[NAV_INS_HISTORY_SIZE];
+    uint8_t historyHead;                // next entry to write
+    uint8_t historyCount;
+
+    // GPS clock offset, see navInsEstimateLatency()
+    bool clockOffsetValid;
+    uint8_t clockOffsetCreep;
+    int32_t clockOffsetMs;
+} navIns_t;
+
+void navInsInit(navIns_t *ins);
+void navInsReset(navIns_t *ins, const float pos[NAV_INS_AXIS_COUNT], const float *vel, uint32_t timeMs);
+void navInsPredict(navIns_t *ins, const float acc[NAV_INS_AXIS_COUNT], uint32_t timeMs);
+void navInsCorrect(navIns_t *ins, const float pos[NAV_INS_AXIS_COUNT], const float *vel, uint32_t timeMs, uint16_t latencyMs);
+uint16_t navInsEstimateLatency(navIns_t *ins, uint32_t arrivalMs, uint32_t timeOfWeekMs, uint16_t processingMs);
@@ -54,15 +54,25 @@ int16_t axisPID[3];
 
 #ifdef BLACKBOX
 int32_t axisPID_P[3], axisPID_I[3], axisPID_D[3];
+int32_t axisPID_F[3];
 #endif
 
 // PIDweight is a scale factor for PIDs which is derived from the throttle and TPA setting, and 100 = 100% scale means no PID reduction
 uint8_t PIDweight[3], Iweigth[3];
 
+// The controllers fold the profile gains, PIDweight, Iweigth and the loop time into per-axis coefficients.
+// Cleared whenever one of those changes, the active controller recalculates the coefficients on its next run.
+bool pidCoefficientsValid = false;
+
 int32_t lastITerm[3], ITermLimit[3];
 float lastITermf[3], ITermLimitf[3];
 
 int16_t expectedGyroError[3] = {0};
+// Time in seconds the yaw actuator still needs to deliver its last command, reported by the tricopter mixer
+float tailLagTime = 0.0f;
+// Part of the last PID output per axis that the actuators could not deliver, reported by the mixers
+int16_t actuatorSaturation[3] = {0};
+uint8_t pidSaturationFlags = 0;     // one bit per axis, set while actuatorSaturation is not zero
 
 pt1Filter_t deltaFilter[3];
 pt1Filter_t yawFilter;
@@ -124,6 +134,7 @@ PG_RESET_TEMPLATE(pidProfile_t, pidProfile,
     .deltaMethod = PID_DELTA_FROM_MEASUREMENT,
     .horizon_tilt_effect = 75,
     .horizon_tilt_mode = HORIZON_TILT_MODE_SAFE,
+    .yaw_ff_lead_ms = 0,
 );
 
 
@@ -133,6 +144,7 @@ static float dT;
 STATIC_UNIT_TESTED void pidResetDt(void)
 {
     dT = 0.0f;
+    pidCoefficientsValid = false;
 }
 #endif
 float getdT(void)
@@ -145,12 +157,30 @@ float getdT(void)
 void pidSetTargetLooptime(uint32_t pidLooptime)
 {
     targetPidLooptime = pidLooptime;
+    pidCoefficientsValid = false;
+}
+
+void pidSetWeights(flight_dynamics_index_t axis, uint8_t pidWeight, uint8_t iWeight)
+{
+    if (PIDweight[axis] != pidWeight || Iweigth[axis] != iWeight) {
+        PIDweight[axis] = pidWeight;
+        Iweigth[axis] = iWeight;
+        pidCoefficientsValid = false;
+    }
+}
+
+void pidInvalidateCoefficients(void)
+{
+    pidCoefficientsValid = false;
 }
 
 void pidInitFilters(const pidProfile_t *pidProfile)
 {
     int axis;
 
+    // called on profile changes, the gains may have changed as well
+    pidCoefficientsValid = false;
+
     if (!targetPidLooptime) {
         // loop time needs to be set.  currently activateConfig calls this but the gyro has not been initialised yet
         // this requires an additional call after pidSetTargetLooptime has been used.
@@ -180,6 +210,8 @@ void pidResetITerm(void)
 
 void pidSetController(pidControllerType_e type)
 {
+    pidCoefficientsValid = false;
+
     switch (type) {
         default:
         case PID_CONTROLLER_LUX_FLOAT:
@@ -277,3 +309,18 @@ void pidSetExpectedGyroError(flight_dynamics_index_t axis, int16_t error)
 {
     expectedGyroError[axis] = error;
 }
+
+void pidSetTailLag(float lagTime)
+{
+    tailLagTime = lagTime;
+}
+
+void pidSetActuatorSaturation(flight_dynamics_index_t axis, int16_t clipped)
+{
+    actuatorSaturation[axis] = clipped;
+    if (clipped) {
+        pidSaturationFlags |= (1 << axis);
+    } else {
+        pidSaturationFlags &= ~(1 << axis);
+    }
+}
@@ -24,6 +24,9 @@
 #define GYRO_I_MAX 256                      // Gyro I limiter
 #define YAW_P_LIMIT_MIN 100                 // Maximum value for yaw P limiter
 #define YAW_P_LIMIT_MAX 500                 // Maximum value for yaw P limiter
+#define YAW_FF_LEAD_MS_MAX 200              // Maximum yaw feed-forward lead time, ms
+
+#define PID_SATURATION_BACKCALC_GAIN 10     // 1/s, rate at which the I term bleeds off output the actuators could not deliver
 
 typedef enum {
     PIDROLL,
@@ -72,6 +75,8 @@ typedef struct pidProfile_s {
     uint8_t dterm_filter_type;              // Filter selection for dterm
     uint16_t dterm_notch_hz;                // Biquad dterm notch hz
     uint16_t dterm_notch_cutoff;            // Biquad dterm notch low cutoff
+
+    uint8_t yaw_ff_lead_ms;                 // Yaw setpoint feed-forward lead time in ms, 0 disables
 } pidProfile_t;
 
 PG_DECLARE_PROFILE(pidProfile_t, pidProfile);
@@ -84,6 +89,9 @@ typedef void (*pidControllerFuncPtr)(const pidProfile_t *pidProfile, const struc
 
 extern int16_t axisPID[FD_INDEX_COUNT];
 extern int32_t axisPID_P[FD_INDEX_COUNT], axisPID_I[FD_INDEX_COUNT], axisPID_D[FD_INDEX_COUNT];
+extern int32_t axisPID_F[FD_INDEX_COUNT];
+extern uint8_t pidSaturationFlags;
+extern float tailLagTime;
 extern uint32_t targetPidLooptime;
 
 float pidScaleITermToRcInput(int axis);
@@ -93,6 +101,8 @@ float getdT(void);
 void pidInitFilters(const pidProfile_t *pidProfile);
 void pidSetController(pidControllerType_e type);
 void pidSetTargetLooptime(uint32_t pidLooptime);
+void pidSetWeights(flight_dynamics_index_t axis, uint8_t pidWeight, uint8_t iWeight);
+void pidInvalidateCoefficients(void);
 void pidResetITermAngle(void);
 void pidResetITerm(void);
 
@@ -100,3 +110,5 @@ int calcHorizonLevelStrength(uint16_t rxConfigMidrc, int horizonTiltEffect,
         uint8_t horizonTiltMode, int horizonSensitivity);
 		
 void pidSetExpectedGyroError(flight_dynamics_index_t axis, int16_t error);
+void pidSetTailLag(float lagTime);
+void pidSetActuatorSaturation(flight_dynamics_index_t axis, int16_t clipped);
@@ -57,12 +57,15 @@
 
 //! Integrator is disabled when rate error exceeds this limit
 #define LUXFLOAT_INTEGRATOR_DISABLE_LIMIT_DPS (75.0f)
+//! Smooths the steps in the yaw setpoint between RX frames before it is differentiated
+#define LUXFLOAT_YAW_FF_LPF_HZ (15)
 
 extern uint8_t PIDweight[3], Iweigth[3];
 extern float lastITermf[3], ITermLimitf[3];
 
 extern pt1Filter_t deltaFilter[3];
 extern pt1Filter_t yawFilter;
+static pt1Filter_t yawFeedForwardFilter;
 
 extern biquadFilter_t dtermFilterNotch[3];
 extern biquadFilter_t dtermFilterLpf[3];
@@ -70,9 +73,13 @@ extern biquadFilter_t dtermFilterLpf[3];
 extern uint8_t motorCount;
 
 extern int16_t expectedGyroError[3];
+extern float tailLagTime;
+extern bool pidCoefficientsValid;
+extern int16_t actuatorSaturation[3];
 
 #ifdef BLACKBOX
 extern int32_t axisPID_P[3], axisPID_I[3], axisPID_D[3];
+extern int32_t axisPID_F[3];
 #endif
 
 // constants to scale pidLuxFloat so output is same as pidMultiWiiRewrite
@@ -81,16 +88,65 @@ static const float luxITermScale = 1000000.0f / 0x1000000;
 static const float luxDTermScale = (0.000001f * (float)0xFFFF) / 512;
 static const float luxGyroScale = 16.4f / 4; // the 16.4 is needed because mwrewrite does not scale according to the gyro model gyro.scale
 
+// per axis gains with the term scaling, TPA weights and loop time folded in
+typedef struct luxFloatCoefficient_s {
+    float Kp;
+    float Ki;   // includes dT
+    float Kd;   // includes 1/dT
+} luxFloatCoefficient_t;
+
+static luxFloatCoefficient_t luxCoefficient[3];
+static float luxSaturationGain;     // fraction of the clipped output removed from the integrator per loop
+
+static void pidLuxFloatUpdateCoefficients(const pidProfile_t *pidProfile)
+{
+    const float dT = getdT();
+
+    for (int axis = 0; axis < 3; axis++) {
+        luxCoefficient[axis].Kp = luxPTermScale * pidProfile->P8[axis] * PIDweight[axis] / 100;
+        luxCoefficient[axis].Ki = luxITermScale * dT * pidProfile->I8[axis] * Iweigth[axis] / 100;
+        luxCoefficient[axis].Kd = luxDTermScale * pidProfile->D8[axis] * PIDweight[axis] / 100 / dT;
+    }
+    luxSaturationGain = PID_SATURATION_BACKCALC_GAIN * dT;
+    pidCoefficientsValid = true;
+}
+
+/*
+ * Yaw setpoint feed-forward. The tail (servo travel plus tail motor spool up) responds tens of milliseconds
+ * after it is commanded, so a pure feedback loop only starts correcting once the gyro shows the rate error.
+ * Instead predict the error that a changing setpoint will build up over the lead time and command it right away,
+ * scaled like the P term. The lead time is yaw_ff_lead_ms plus the time the tail model still needs to deliver the
+ * previous command, as a tail that is still travelling delays any new command by that much.
+ */
+static float pidLuxFloatYawFeedForward(const pidProfile_t *pidProfile, float angleRate, float dT)
+{
+    static float lastAngleRate;
+
+    float setpointDelta = (angleRate - lastAngleRate) / dT;
+    lastAngleRate = angleRate;
+    setpointDelta = pt1FilterApply4(&yawFeedForwardFilter, setpointDelta, LUXFLOAT_YAW_FF_LPF_HZ, dT);
+
+    const float leadTime = pidProfile->yaw_ff_lead_ms * 0.001f + tailLagTime;
+    const float FTerm = luxCoefficient[YAW].Kp * setpointDelta * leadTime;
+
+    return constrainf(FTerm, -PID_MAX_D, PID_MAX_D);
+}
+
 STATIC_UNIT_TESTED int16_t pidLuxFloatCore(int axis, const pidProfile_t *pidProfile, float gyroRate, float angleRate)
 {
     static float lastRateForDelta[3];
 
     SET_PID_LUX_FLOAT_CORE_LOCALS(axis);
 
+    if (!pidCoefficientsValid) {
+        pidLuxFloatUpdateCoefficients(pidProfile);
+    }
+    const luxFloatCoefficient_t *coefficient = &luxCoefficient[axis];
+
     const float rateError = angleRate - gyroRate + (float)expectedGyroError[axis];
 
     // -----calculate P component
-    float PTerm = luxPTermScale * rateError * pidProfile->P8[axis] * PIDweight[axis] / 100;
+    float PTerm = coefficient->Kp * rateError;
     // Constrain YAW by yaw_p_limit value if not servo driven, in that case servolimits apply
     const float dT = getdT();
 
@@ -104,10 +160,20 @@ STATIC_UNIT_TESTED int16_t pidLuxFloatCore(int axis, const pidProfile_t *pidProf
     }
 
     // -----calculate I component
-    float ITerm = lastITermf[axis] + luxITermScale * rateError * dT * pidProfile->I8[axis] * Iweigth[axis] / 100;
+    float ITerm = lastITermf[axis] + coefficient->Ki * rateError;
     // limit maximum integrator value to prevent WindUp - accumulating extreme values when system is saturated.
     // I coefficient (I8) moved before integration to make limiting independent from PID settings
     ITerm = constrainf(ITerm, -PID_MAX_I, PID_MAX_I);
+    // Back-calculation anti-windup, bleed off the part of the last output the motors or tail servo could not deliver.
+    // The clipped output includes P and D as well, so only ever shrink the integrator towards zero.
+    if (actuatorSaturation[axis]) {
+        const float bleed = luxSaturationGain * actuatorSaturation[axis];
+        if (ITerm > 0 && bleed > 0) {
+            ITerm = MAX(ITerm - bleed, 0.0f);
+        } else if (ITerm < 0 && bleed < 0) {
+            ITerm = MIN(ITerm - bleed, 0.0f);
+        }
+    }
     if (fabsf(gyroRate) < LUXFLOAT_INTEGRATOR_DISABLE_LIMIT_DPS) {
         lastITermf[axis] = ITerm;
     } else {
@@ -131,10 +197,8 @@ STATIC_UNIT_TESTED int16_t pidLuxFloatCore(int axis, const pidProfile_t *pidProf
             delta = rateError - lastRateForDelta[axis];
             lastRateForDelta[axis] = rateError;
         }
-        // Divide delta by targetLooptime to get differential (ie dr/dt)
-        delta /= getdT();
-
-        // Filter delta
+        // Filter delta, the filters are linear so the division by dT to get the differential (ie dr/dt)
+        // is left to the coefficient
         if (pidProfile->dterm_notch_hz) {
             delta = biquadFilterApply(&dtermFilterNotch[axis], delta);
         }
@@ -144,22 +208,29 @@ STATIC_UNIT_TESTED int16_t pidLuxFloatCore(int axis, const pidProfile_t *pidProf
                 delta = biquadFilterApply(&dtermFilterLpf[axis], delta);
             } else {
                 // DTerm delta low pass filter
-                delta = pt1FilterApply4(&deltaFilter[axis], delta, pidProfile->dterm_lpf_hz, getdT());
+                delta = pt1FilterApply4(&deltaFilter[axis], delta, pidProfile->dterm_lpf_hz, dT);
             }
         }
 
-        DTerm = luxDTermScale * delta * pidProfile->D8[axis] * PIDweight[axis] / 100;
+        DTerm = coefficient->Kd * delta;
         DTerm = constrainf(DTerm, -PID_MAX_D, PID_MAX_D);
     }
 
+    // -----calculate feed-forward component
+    float FTerm = 0;
+    if (axis == YAW && pidProfile->yaw_ff_lead_ms) {
+        FTerm = pidLuxFloatYawFeedForward(pidProfile, angleRate, dT);
+    }
+
 #ifdef BLACKBOX
     axisPID_P[axis] = PTerm;
     axisPID_I[axis] = ITerm;
     axisPID_D[axis] = DTerm;
+    axisPID_F[axis] = FTerm;
 #endif
     GET_PID_LUX_FLOAT_CORE_LOCALS(axis);
     // -----calculate total PID output
-    return lrintf(PTerm + ITerm + DTerm);
+    return lrintf(PTerm + ITerm + DTerm + FTerm);
 }
 
 void pidLuxFloat(const pidProfile_t *pidProfile, const controlRateConfig_t *controlRateConfig,
@@ -65,21 +65,54 @@ extern pt1Filter_t yawFilter;
 extern uint8_t motorCount;
 
 extern int16_t expectedGyroError[3];
+extern bool pidCoefficientsValid;
+extern int16_t actuatorSaturation[3];
 
 #ifdef BLACKBOX
 extern int32_t axisPID_P[3], axisPID_I[3], axisPID_D[3];
 #endif
 
+// per axis gains with the TPA weights folded in, fixed point so that the weights keep some precision.
+// A weight of 100 gives exactly the same result as scaling by P8 * PIDweight / 100.
+#define MWR_COEFFICIENT_SHIFT 4
+
+typedef struct mwrCoefficient_s {
+    int32_t Kp;
+    int32_t Ki;
+    int32_t Kd;
+} mwrCoefficient_t;
+
+static mwrCoefficient_t mwrCoefficient[3];
+static int32_t mwrDeltaScale;   // divides delta by the loop time to get the differential (ie dr/dt)
+static int32_t mwrSaturationGain;   // fraction of the clipped output removed from the Q19.13 integrator per loop
+
+static void pidMultiWiiRewriteUpdateCoefficients(const pidProfile_t *pidProfile)
+{
+    for (int axis = 0; axis < 3; axis++) {
+        mwrCoefficient[axis].Kp = ((int32_t)pidProfile->P8[axis] * PIDweight[axis] << MWR_COEFFICIENT_SHIFT) / 100;
+        mwrCoefficient[axis].Ki = ((int32_t)pidProfile->I8[axis] * Iweigth[axis] << MWR_COEFFICIENT_SHIFT) / 100;
+        mwrCoefficient[axis].Kd = ((int32_t)pidProfile->D8[axis] * PIDweight[axis] << MWR_COEFFICIENT_SHIFT) / 100;
+    }
+    mwrDeltaScale = (uint16_t)0xFFFF / ((uint16_t)targetPidLooptime >> 4);
+    mwrSaturationGain = lrintf(PID_SATURATION_BACKCALC_GAIN * getdT() * (1 << (13 + MWR_COEFFICIENT_SHIFT)));
+    pidCoefficientsValid = true;
+}
+
 STATIC_UNIT_TESTED int16_t pidMultiWiiRewriteCore(int axis, const pidProfile_t *pidProfile, int32_t gyroRate, int32_t angleRate)
 {
     static int32_t lastRateForDelta[3];
 
     SET_PID_MULTI_WII_REWRITE_CORE_LOCALS(axis);
 
+    if (!pidCoefficientsValid) {
+        pidMultiWiiRewriteUpdateCoefficients(pidProfile);
+    }
+    const mwrCoefficient_t *coefficient = &mwrCoefficient[axis];
+
     const int32_t rateError = angleRate - gyroRate + (expectedGyroError[axis] * 41);
 
     // -----calculate P component
-    int32_t PTerm = (rateError * pidProfile->P8[axis] * PIDweight[axis] / 100) >> 7;
+    int32_t PTerm = (rateError * coefficient->Kp) >> (7 + MWR_COEFFICIENT_SHIFT);
     // Constrain YAW by yaw_p_limit value if not servo driven, in that case servolimits apply
     if (axis == YAW) {
         if (pidProfile->yaw_lpf_hz) {
@@ -95,10 +128,20 @@ STATIC_UNIT_TESTED int16_t pidMultiWiiRewriteCore(int axis, const pidProfile_t *
     // Precision is critical, as I prevents from long-time drift. Thus, 32 bits integrator (Q19.13 format) is used.
     // Time correction (to avoid different I scaling for different builds based on average cycle time)
     // is normalized to cycle time = 2048 (2^11).
-    int32_t ITerm = lastITerm[axis] + ((rateError * (uint16_t)targetPidLooptime) >> 11) * pidProfile->I8[axis] * Iweigth[axis] / 100;
+    int32_t ITerm = lastITerm[axis] + ((((rateError * (uint16_t)targetPidLooptime) >> 11) * coefficient->Ki) >> MWR_COEFFICIENT_SHIFT);
     // limit maximum integrator value to prevent WindUp - accumulating extreme values when system is saturated.
     // I coefficient (I8) moved before integration to make limiting independent from PID settings
     ITerm = constrain(ITerm, (int32_t) - GYRO_I_MAX << 13, (int32_t) + GYRO_I_MAX << 13);
+    // Back-calculation anti-windup, bleed off the part of the last output the motors or tail servo could not deliver.
+    // The clipped output includes P and D as well, so only ever shrink the integrator towards zero.
+    if (actuatorSaturation[axis]) {
+        const int32_t bleed = (actuatorSaturation[axis] * mwrSaturationGain) >> MWR_COEFFICIENT_SHIFT;
+        if (ITerm > 0 && bleed > 0) {
+            ITerm = MAX(ITerm - bleed, 0);
+        } else if (ITerm < 0 && bleed < 0) {
+            ITerm = MIN(ITerm - bleed, 0);
+        }
+    }
 
     if (ABS(gyroRate) < REWRITE_INTEGRATOR_DISABLE_LIMIT_DPS) {
         lastITerm[axis] = ITerm;
@@ -125,12 +168,12 @@ STATIC_UNIT_TESTED int16_t pidMultiWiiRewriteCore(int axis, const pidProfile_t *
             lastRateForDelta[axis] = rateError;
         }
         // Divide delta by targetLooptime to get differential (ie dr/dt)
-        delta = (delta * ((uint16_t)0xFFFF / ((uint16_t)targetPidLooptime >> 4))) >> 5;
+        delta = (delta * mwrDeltaScale) >> 5;
         if (pidProfile->dterm_lpf_hz) {
             // DTerm delta low pass filter
             delta = lrintf(pt1FilterApply4(&deltaFilter[axis], (float)delta, pidProfile->dterm_lpf_hz, getdT()));
         }
-        DTerm = (delta * pidProfile->D8[axis] * PIDweight[axis] / 100) >> 8;
+        DTerm = (delta * coefficient->Kd) >> (8 + MWR_COEFFICIENT_SHIFT);
         DTerm = constrain(DTerm, -PID_MAX_D, PID_MAX_D);
     }
 
@@ -57,6 +57,11 @@ typedef enum {
     GPS_AUTOBAUD_ON
 } gpsAutoBaud_e;
 
+typedef enum {
+    GPS_UBLOX_NAV_PVT_OFF = 0,
+    GPS_UBLOX_NAV_PVT_ON
+} gpsUbloxNavPvt_e;
+
 #define GPS_BAUDRATE_MAX GPS_BAUDRATE_9600
 
 typedef struct gpsConfig_s {
@@ -64,6 +69,7 @@ typedef struct gpsConfig_s {
     sbasMode_e sbasMode;
     gpsAutoConfig_e autoConfig;
     gpsAutoBaud_e autoBaud;
+    gpsUbloxNavPvt_e ubloxNavPvt;       // u-blox 7 and newer, configure a single NAV-PVT message at 10Hz
 } gpsConfig_t;
 
 PG_DECLARE(gpsConfig_t, gpsConfig);
@@ -77,6 +83,7 @@ typedef struct gpsCoordinateDDDMMmmmm_s {
 typedef enum {
     GPS_MESSAGE_STATE_IDLE = 0,
     GPS_MESSAGE_STATE_INIT,
+    GPS_MESSAGE_STATE_NAV,
     GPS_MESSAGE_STATE_SBAS,
     GPS_MESSAGE_STATE_MAX = GPS_MESSAGE_STATE_SBAS
 } gpsMessageState_e;
@@ -110,6 +117,9 @@ extern uint32_t GPS_svInfoReceivedCount;
 extern uint16_t GPS_altitude;              // altitude in 0.1m
 extern uint16_t GPS_speed;                 // speed in 0.1m/s
 extern uint16_t GPS_ground_course;         // degrees * 10
+extern int32_t GPS_velNED[3];              // cm/s, only set if GPS_velNEDValid
+extern bool GPS_velNEDValid;
+extern uint32_t GPS_timeOfWeek;            // ms, epoch of the solution, 0 if the receiver doesn't report it
 extern uint8_t GPS_numCh;                  // Number of channels
 extern uint8_t GPS_svinfo_chn[16];         // Channel number
 extern uint8_t GPS_svinfo_svid[16];        // Satellite ID
@@ -0,0 +1,786 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <platform.h>
+
+#ifdef GPS
+
+#include "common/maths.h"
+#include "common/utils.h"
+
+#include "config/parameter_group.h"
+
+#include "io/gps.h"
+#include "io/gps_parser.h"
+
+void gpsParserInit(gpsParser_t *parser, uint8_t provider)
+{
+    memset(parser, 0, sizeof(*parser));
+    parser->provider = provider;
+    parser->solution.hdop = 9999;
+}
+
+gpsParseResult_e gpsParserProcessByte(gpsParser_t *parser, uint8_t c)
+{
+    switch (parser->provider) {
+        case GPS_NMEA:
+            return gpsParserProcessNmea(parser, c);
+        case GPS_UBLOX:
+            return gpsParserProcessUblox(parser, c);
+    }
+    return GPS_PARSE_IN_PROGRESS;
+}
+
+/*
+ * NMEA
+ *
+ * Fields are converted while their characters arrive, the integer part and up to four decimals are kept,
+ * which is all the precision any of the used fields carry. Positions are dddmm.mmmm, the result is in
+ * degrees * 10^7, 1 cm resolution.
+ *
+ * Only the following data is used:
+ *   - GGA: latitude, longitude, fix, number of satellites, HDOP and altitude
+ *   - RMC: speed and course over ground
+ *   - GPGSV: satellite IDs and signal strengths
+ * GGA and RMC are accepted from any talker, GN for combined GNSS solutions.
+ */
+
+#define NMEA_FRAME_NONE  0
+#define NMEA_FRAME_GGA   1
+#define NMEA_FRAME_RMC   2
+#define NMEA_FRAME_GSV   3
+
+#define NMEA_TAG(a, b, c)       (((uint32_t)(a) << 16) | ((uint32_t)(b) << 8) | (uint32_t)(c))
+#define NMEA_TAG4(a, b, c, d)   (((uint32_t)(a) << 24) | NMEA_TAG(b, c, d))
+
+#define NMEA_FIELD_INTEGER_DIGITS_MAX   9
+#define NMEA_FIELD_FRACTION_DIGITS_MAX  4
+#define NMEA_GSV_SATS_PER_MESSAGE       4
+
+// scales the received decimals to ten-thousandths
+static const uint16_t nmeaFractionScale[NMEA_FIELD_FRACTION_DIGITS_MAX + 1] = { 0, 1000, 100, 10, 1 };
+
+static void nmeaFieldReset(gpsNmeaState_t *nmea)
+{
+    nmea->fieldTag = 0;
+    nmea->fieldInteger = 0;
+    nmea->fieldFraction = 0;
+    nmea->fieldFractionDigits = 0;
+    nmea->fieldIntegerDigits = 0;
+    nmea->fieldLength = 0;
+    nmea->fieldDecimal = false;
+}
+
+static void nmeaFieldAddChar(gpsNmeaState_t *nmea, uint8_t c)
+{
+    const uint8_t digit = c - '0';
+
+    if (digit <= 9) {
+        if (!nmea->fieldDecimal) {
+            if (nmea->fieldIntegerDigits < NMEA_FIELD_INTEGER_DIGITS_MAX) {
+                nmea->fieldInteger = nmea->fieldInteger * 10 + digit;
+                nmea->fieldIntegerDigits++;
+            }
+        } else if (nmea->fieldFractionDigits < NMEA_FIELD_FRACTION_DIGITS_MAX) {
+            nmea->fieldFraction = nmea->fieldFraction * 10 + digit;
+            nmea->fieldFractionDigits++;
+        }
+    } else if (c == '.') {
+        nmea->fieldDecimal = true;
+    }
+
+    nmea->fieldTag = (nmea->fieldTag << 8) | c;
+    if (nmea->fieldLength < UINT8_MAX) {
+        nmea->fieldLength++;
+    }
+}
+
+static uint16_t nmeaFieldFraction(const gpsNmeaState_t *nmea)
+{
+    return nmea->fieldFraction * nmeaFractionScale[nmea->fieldFractionDigits];
+}
+
+// the value with one decimal, * 10
+static uint32_t nmeaFieldTenths(const gpsNmeaState_t *nmea)
+{
+    return nmea->fieldInteger * 10 + nmeaFieldFraction(nmea) / 1000;
+}
+
+static int32_t nmeaFieldCoordinate(const gpsNmeaState_t *nmea)
+{
+    const uint32_t degrees = nmea->fieldInteger / 100;
+    const uint32_t minutes = nmea->fieldInteger % 100;
+
+    return degrees * GPS_DEGREES_DIVIDER + (minutes * 1000000UL + nmeaFieldFraction(nmea) * 100UL) / 6;
+}
+
+static bool nmeaFieldIs(const gpsNmeaState_t *nmea, uint8_t c)
+{
+    return nmea->fieldLength == 1 && (nmea->fieldTag & 0xFF) == c;
+}
+
+static void nmeaFieldEnd(gpsNmeaState_t *nmea)
+{
+    gpsSolution_t *pending = &nmea->pending;
+
+    if (nmea->param == 0) {
+        const uint32_t sentence = nmea->fieldTag & 0xFFFFFF;
+
+        nmea->frame = NMEA_FRAME_NONE;
+        if (nmea->fieldLength != 5) {
+            return;
+        }
+        if (sentence == NMEA_TAG('G', 'G', 'A')) {
+            nmea->frame = NMEA_FRAME_GGA;
+        } else if (sentence == NMEA_TAG('R', 'M', 'C')) {
+            nmea->frame = NMEA_FRAME_RMC;
+        } else if (nmea->fieldTag == NMEA_TAG4('P', 'G', 'S', 'V')) {
+            nmea->frame = NMEA_FRAME_GSV;
+            nmea->svCount = 0;
+        }
+        return;
+    }
+
+    switch (nmea->frame) {
+        case NMEA_FRAME_GGA:
+            switch (nmea->param) {
+                case 2:
+                    pending->coord[LAT] = nmeaFieldCoordinate(nmea);
+                    break;
+                case 3:
+                    if (nmeaFieldIs(nmea, 'S')) {
+                        pending->coord[LAT] = -pending->coord[LAT];
+                    }
+                    break;
+                case 4:
+                    pending->coord[LON] = nmeaFieldCoordinate(nmea);
+                    break;
+                case 5:
+                    if (nmeaFieldIs(nmea, 'W')) {
+                        pending->coord[LON] = -pending->coord[LON];
+                    }
+                    break;
+                case 6:
+                    pending->fix = nmea->fieldInteger > 0;
+                    break;
+                case 7:
+                    pending->numSat = nmea->fieldInteger;
+                    break;
+                case 8:
+                    pending->hdop = nmea->fieldInteger * 100 + nmeaFieldFraction(nmea) / 100;
+                    break;
+                case 9:
+                    pending->altitude = nmea->fieldInteger;     // m
+                    break;
+            }
+            break;
+
+        case NMEA_FRAME_RMC:
+            switch (nmea->param) {
+                case 7:
+                    pending->speed = (nmeaFieldTenths(nmea) * 5144L) / 1000L;  // knots * 10 to cm/s
+                    break;
+                case 8:
+                    pending->groundCourse = nmeaFieldTenths(nmea);         // degrees * 10
+                    break;
+            }
+            break;
+
+        case NMEA_FRAME_GSV: {
+            if (nmea->param == 2) {
+                nmea->svMessageNum = nmea->fieldInteger;
+                break;
+            }
+            if (nmea->param == 3) {
+                nmea->svTotal = nmea->fieldInteger;
+                break;
+            }
+            if (nmea->param < 4) {
+                break;
+            }
+
+            // four fields per satellite: PRN, elevation, azimuth and SNR
+            const uint8_t satIndex = (nmea->param - 4) / 4;
+            if (satIndex >= NMEA_GSV_SATS_PER_MESSAGE) {
+                break;
+            }
+            switch ((nmea->param - 4) % 4) {
+                case 0:
+                    nmea->svid[satIndex] = nmea->fieldInteger;
+                    nmea->cno[satIndex] = 0;
+                    nmea->svCount = satIndex + 1;
+                    break;
+                case 3:
+                    nmea->cno[satIndex] = nmea->fieldInteger;
+                    break;
+            }
+            break;
+        }
+    }
+}
+
+static gpsParseResult_e nmeaSentenceEnd(gpsParser_t *parser)
+{
+    gpsNmeaState_t *nmea = &parser->state.nmea;
+    gpsSolution_t *solution = &parser->solution;
+    gpsParseResult_e result = GPS_PARSE_PACKET;
+
+    if (nmea->checksumDigits != 2 || nmea->checksum != nmea->parity) {
+        parser->packetLogChar = GPS_LOG_ERROR;
+        return result;
+    }
+
+    parser->stats.packetCount++;
+    parser->packetLogChar = GPS_LOG_IGNORED;
+
+    switch (nmea->frame) {
+        case NMEA_FRAME_GGA:
+            parser->packetLogChar = GPS_LOG_NMEA_GGA;
+            solution->fix = nmea->pending.fix;
+            if (solution->fix) {
+                solution->coord[LAT] = nmea->pending.coord[LAT];
+                solution->coord[LON] = nmea->pending.coord[LON];
+                solution->numSat = nmea->pending.numSat;
+                solution->hdop = nmea->pending.hdop;
+                solution->altitude = nmea->pending.altitude;
+            }
+            result = GPS_PARSE_SOLUTION;
+            break;
+
+        case NMEA_FRAME_RMC:
+            parser->packetLogChar = GPS_LOG_NMEA_RMC;
+            solution->speed = nmea->pending.speed;
+            solution->groundCourse = nmea->pending.groundCourse;
+            break;
+
+        case NMEA_FRAME_GSV:
+            parser->packetLogChar = GPS_LOG_NMEA_GSV;
+            parser->svInfo.numCh = MIN(nmea->svTotal, GPS_SV_MAXSATS);
+            for (int i = 0; i < nmea->svCount; i++) {
+                const int svIndex = (nmea->svMessageNum - 1) * NMEA_GSV_SATS_PER_MESSAGE + i;
+                if (svIndex < 0 || svIndex >= GPS_SV_MAXSATS) {
+                    break;
+                }
+                parser->svInfo.chn[svIndex] = svIndex + 1;
+                parser->svInfo.svid[svIndex] = nmea->svid[i];
+                parser->svInfo.quality[svIndex] = 0;   // only used by ublox
+                parser->svInfo.cno[svIndex] = nmea->cno[i];
+            }
+            parser->svInfoUpdated = true;
+            break;
+    }
+
+    return result;
+}
+
+gpsParseResult_e gpsParserProcessNmea(gpsParser_t *parser, uint8_t c)
+{
+    gpsNmeaState_t *nmea = &parser->state.nmea;
+
+    switch (c) {
+        case '$':
+            nmea->inSentence = true;
+            nmea->inChecksum = false;
+            nmea->frame = NMEA_FRAME_NONE;
+            nmea->param = 0;
+            nmea->parity = 0;
+            nmea->checksum = 0;
+            nmea->checksumDigits = 0;
+            nmeaFieldReset(nmea);
+            return GPS_PARSE_IN_PROGRESS;
+
+        case '\r':
+        case '\n':
+            if (!nmea->inSentence || !nmea->inChecksum) {
+                // a sentence without checksum is not used
+                nmea->inSentence = false;
+                return GPS_PARSE_IN_PROGRESS;
+            }
+            nmea->inSentence = false;
+            return nmeaSentenceEnd(parser);
+    }
+
+    if (!nmea->inSentence) {
+        parser->stats.garbageByteCount++;
+        return GPS_PARSE_IN_PROGRESS;
+    }
+
+    if (nmea->inChecksum) {
+        const uint8_t nibble = (c >= 'a') ? c - 'a' + 10 : (c >= 'A') ? c - 'A' + 10 : c - '0';
+        nmea->checksum = (nmea->checksum << 4) | (nibble & 0x0F);
+        if (nmea->checksumDigits < UINT8_MAX) {
+            nmea->checksumDigits++;
+        }
+        return GPS_PARSE_IN_PROGRESS;
+    }
+
+    switch (c) {
+        case '*':
+            nmea->inChecksum = true;
+            nmeaFieldEnd(nmea);
+            break;
+
+        case ',':
+            nmea->parity ^= c;
+            nmeaFieldEnd(nmea);
+            if (nmea->param < UINT8_MAX) {
+                nmea->param++;
+            }
+            nmeaFieldReset(nmea);
+            break;
+
+        default:
+            nmea->parity ^= c;
+            nmeaFieldAddChar(nmea, c);
+            break;
+    }
+    return GPS_PARSE_IN_PROGRESS;
+}
+
+/*
+ * UBX
+ *
+ * The payload is not buffered, each message has a table of the fields used, ordered by offset, and the
+ * bytes of those fields are assembled as they go past. NAV-PVT carries a complete solution in one message,
+ * u-blox 6 and older receivers need NAV-POSLLH, NAV-VELNED and NAV-SOL or NAV-STATUS.
+ */
+
+enum {
+    PREAMBLE1 = 0xb5,
+    PREAMBLE2 = 0x62,
+    CLASS_NAV = 0x01,
+    MSG_POSLLH = 0x02,
+    MSG_STATUS = 0x03,
+    MSG_SOL = 0x06,
+    MSG_PVT = 0x07,
+    MSG_VELNED = 0x12,
+    MSG_SVINFO = 0x30,
+} ubx_protocol_bytes;
+
+enum {
+    FIX_NONE = 0,
+    FIX_DEAD_RECKONING = 1,
+    FIX_2D = 2,
+    FIX_3D = 3,
+    FIX_GPS_DEAD_RECKONING = 4,
+    FIX_TIME = 5
+} ubs_nav_fix_type;
+
+enum {
+    NAV_STATUS_FIX_VALID = 1
+} ubx_nav_status_bits;
+
+typedef enum {
+    UBX_STEP_SYNC1 = 0,
+    UBX_STEP_SYNC2,
+    UBX_STEP_CLASS,
+    UBX_STEP_ID,
+    UBX_STEP_LENGTH1,
+    UBX_STEP_LENGTH2,
+    UBX_STEP_PAYLOAD,
+    UBX_STEP_CK_A,
+    UBX_STEP_CK_B,
+} ubxStep_e;
+
+// from the UBlox6 document, the largest payload we receive is the NAV-SVINFO and the payload size
+// is calculated as 8 + 12*numCh.  numCh in the case of a Glonass receiver is 28.
+#define MAX_UBLOX_PAYLOAD_SIZE 344
+
+#define UBX_SVINFO_HEADER_SIZE   8
+#define UBX_SVINFO_CHANNEL_SIZE  12
+
+typedef enum {
+    UBX_FIELD_TIME_OF_WEEK,
+    UBX_FIELD_LON,
+    UBX_FIELD_LAT,
+    UBX_FIELD_ALTITUDE_MSL,
+    UBX_FIELD_FIX_TYPE,
+    UBX_FIELD_FIX_FLAGS,
+    UBX_FIELD_NUM_SAT,
+    UBX_FIELD_PDOP,
+    UBX_FIELD_VEL_N,
+    UBX_FIELD_VEL_E,
+    UBX_FIELD_VEL_D,
+    UBX_FIELD_GROUND_SPEED,
+    UBX_FIELD_HEADING,
+    UBX_FIELD_SPEED_ACCURACY,
+    UBX_FIELD_NUM_CH,
+} ubxFieldId_e;
+
+typedef struct ubxField_s {
+    uint8_t offset;
+    uint8_t size;
+    uint8_t id;
+} ubxField_t;
+
+typedef struct ubxMessage_s {
+    uint8_t id;
+    uint8_t minLength;
+    char logChar;
+    uint8_t fieldCount;
+    const ubxField_t *fields;
+} ubxMessage_t;
+
+static const ubxField_t ubxPosllhFields[] = {
+    { 0,  4, UBX_FIELD_TIME_OF_WEEK },
+    { 4,  4, UBX_FIELD_LON },
+    { 8,  4, UBX_FIELD_LAT },
+    { 16, 4, UBX_FIELD_ALTITUDE_MSL },
+};
+
+static const ubxField_t ubxStatusFields[] = {
+    { 4,  1, UBX_FIELD_FIX_TYPE },
+    { 5,  1, UBX_FIELD_FIX_FLAGS },
+};
+
+static const ubxField_t ubxSolFields[] = {
+    { 10, 1, UBX_FIELD_FIX_TYPE },
+    { 11, 1, UBX_FIELD_FIX_FLAGS },
+    { 44, 2, UBX_FIELD_PDOP },
+    { 47, 1, UBX_FIELD_NUM_SAT },
+};
+
+static const ubxField_t ubxPvtFields[] = {
+    { 0,  4, UBX_FIELD_TIME_OF_WEEK },
+    { 20, 1, UBX_FIELD_FIX_TYPE },
+    { 21, 1, UBX_FIELD_FIX_FLAGS },
+    { 23, 1, UBX_FIELD_NUM_SAT },
+    { 24, 4, UBX_FIELD_LON },
+    { 28, 4, UBX_FIELD_LAT },
+    { 36, 4, UBX_FIELD_ALTITUDE_MSL },
+    { 48, 4, UBX_FIELD_VEL_N },
+    { 52, 4, UBX_FIELD_VEL_E },
+    { 56, 4, UBX_FIELD_VEL_D },
+    { 60, 4, UBX_FIELD_GROUND_SPEED },
+    { 64, 4, UBX_FIELD_HEADING },
+    { 68, 4, UBX_FIELD_SPEED_ACCURACY },
+    { 76, 2, UBX_FIELD_PDOP },
+};
+
+static const ubxField_t ubxVelnedFields[] = {
+    { 0,  4, UBX_FIELD_TIME_OF_WEEK },
+    { 4,  4, UBX_FIELD_VEL_N },
+    { 8,  4, UBX_FIELD_VEL_E },
+    { 12, 4, UBX_FIELD_VEL_D },
+    { 20, 4, UBX_FIELD_GROUND_SPEED },
+    { 24, 4, UBX_FIELD_HEADING },
+    { 28, 4, UBX_FIELD_SPEED_ACCURACY },
+};
+
+// the channel blocks that follow the header are decoded by ubxSvInfoChannelByte()
+static const ubxField_t ubxSvInfoFields[] = {
+    { 4,  1, UBX_FIELD_NUM_CH },
+};
+
+static const ubxMessage_t ubxMessages[] = {
+    { MSG_POSLLH, 28, GPS_LOG_UBLOX_POSLLH, ARRAYLEN(ubxPosllhFields), ubxPosllhFields },
+    { MSG_STATUS, 16, GPS_LOG_UBLOX_STATUS, ARRAYLEN(ubxStatusFields), ubxStatusFields },
+    { MSG_SOL,    52, GPS_LOG_UBLOX_SOL,    ARRAYLEN(ubxSolFields),    ubxSolFields },
+    { MSG_PVT,    92, GPS_LOG_UBLOX_PVT,    ARRAYLEN(ubxPvtFields),    ubxPvtFields },
+    { MSG_VELNED, 36, GPS_LOG_UBLOX_VELNED, ARRAYLEN(ubxVelnedFields), ubxVelnedFields },
+    { MSG_SVINFO, UBX_SVINFO_HEADER_SIZE, GPS_LOG_UBLOX_SVINFO, ARRAYLEN(ubxSvInfoFields), ubxSvInfoFields },
+};
+
+static const ubxMessage_t *ubxFindMessage(uint8_t msgClass, uint8_t msgId, uint16_t length)
+{
+    if (msgClass != CLASS_NAV) {
+        return NULL;
+    }
+    for (unsigned i = 0; i < ARRAYLEN(ubxMessages); i++) {
+        if (ubxMessages[i].id == msgId) {
+            return length >= ubxMessages[i].minLength ? &ubxMessages[i] : NULL;
+        }
+    }
+    return NULL;
+}
+
+static void ubxStoreField(gpsUbloxState_t *ubx, uint8_t id, uint32_t value)
+{
+    switch (id) {
+        case UBX_FIELD_TIME_OF_WEEK:
+            ubx->pending.timeOfWeekMs = value;
+            break;
+        case UBX_FIELD_LON:
+            ubx->pending.lon = value;
+            break;
+        case UBX_FIELD_LAT:
+            ubx->pending.lat = value;
+            break;
+        case UBX_FIELD_ALTITUDE_MSL:
+            ubx->pending.altitudeMsl = value;
+            break;
+        case UBX_FIELD_FIX_TYPE:
+            ubx->pending.fixType = value;
+            break;
+        case UBX_FIELD_FIX_FLAGS:
+            ubx->pending.fixFlags = value;
+            break;
+        case UBX_FIELD_NUM_SAT:
+            ubx->pending.numSat = value;
+            break;
+        case UBX_FIELD_PDOP:
+            ubx->pending.pdop = value;
+            break;
+        case UBX_FIELD_VEL_N:
+        case UBX_FIELD_VEL_E:
+        case UBX_FIELD_VEL_D:
+            ubx->pending.velNED[id - UBX_FIELD_VEL_N] = value;
+            break;
+        case UBX_FIELD_GROUND_SPEED:
+            ubx->pending.groundSpeed = value;
+            break;
+        case UBX_FIELD_HEADING:
+            ubx->pending.heading = value;
+            break;
+        case UBX_FIELD_SPEED_ACCURACY:
+            ubx->pending.speedAccuracy = value;
+            break;
+        case UBX_FIELD_NUM_CH:
+            ubx->pending.numCh = value;
+            break;
+    }
+}
+
+static void ubxSvInfoChannelByte(gpsParser_t *parser, uint16_t offset, uint8_t data)
+{
+    const uint16_t channel = (offset - UBX_SVINFO_HEADER_SIZE) / UBX_SVINFO_CHANNEL_SIZE;
+
+    if (channel >= GPS_SV_MAXSATS) {
+        return;
+    }
+
+    switch ((offset - UBX_SVINFO_HEADER_SIZE) % UBX_SVINFO_CHANNEL_SIZE) {
+        case 0:
+            parser->svInfoPending.chn[channel] = data;
+            break;
+        case 1:
+            parser->svInfoPending.svid[channel] = data;
+            break;
+        case 3:
+            parser->svInfoPending.quality[channel] = data;
+            break;
+        case 4:
+            parser->svInfoPending.cno[channel] = data;
+            break;
+    }
+}
+
+static void ubxPayloadByte(gpsParser_t *parser, uint8_t data)
+{
+    gpsUbloxState_t *ubx = &parser->state.ublox;
+    const ubxMessage_t *message = ubx->message;
+    const uint16_t offset = ubx->payloadCounter;
+
+    if (ubx->fieldIndex < message->fieldCount) {
+        const ubxField_t *field = &message->fields[ubx->fieldIndex];
+        if (offset >= field->offset) {
+            const uint8_t byteIndex = offset - field->offset;
+            ubx->fieldValue |= (uint32_t)data << (8 * byteIndex);
+            if (byteIndex == field->size - 1) {
+                ubxStoreField(ubx, field->id, ubx->fieldValue);
+                ubx->fieldValue = 0;
+                ubx->fieldIndex++;
+            }
+        }
+        return;
+    }
+
+    if (message->id == MSG_SVINFO && offset >= UBX_SVINFO_HEADER_SIZE) {
+        ubxSvInfoChannelByte(parser, offset, data);
+    }
+}
+
+static bool ubxFix(const gpsUbloxState_t *ubx)
+{
+    return (ubx->pending.fixFlags & NAV_STATUS_FIX_VALID) && (ubx->pending.fixType == FIX_3D);
+}
+
+static gpsParseResult_e ubxMessageEnd(gpsParser_t *parser)
+{
+    gpsUbloxState_t *ubx = &parser->state.ublox;
+    gpsSolution_t *solution = &parser->solution;
+
+    switch (ubx->message->id) {
+        case MSG_POSLLH:
+            solution->timeOfWeekMs = ubx->pending.timeOfWeekMs;
+            solution->coord[LON] = ubx->pending.lon;
+            solution->coord[LAT] = ubx->pending.lat;
+            solution->altitude = ubx->pending.altitudeMsl / 10 / 100;     // alt in m
+            solution->fix = ubx->nextFix;
+            ubx->newPosition = true;
+            break;
+
+        case MSG_STATUS:
+            ubx->nextFix = ubxFix(ubx);
+            if (!ubx->nextFix) {
+                solution->fix = false;
+            }
+            break;
+
+        case MSG_SOL:
+            ubx->nextFix = ubxFix(ubx);
+            if (!ubx->nextFix) {
+                solution->fix = false;
+            }
+            solution->numSat = ubx->pending.numSat;
+            solution->hdop = ubx->pending.pdop;
+            break;
+
+        case MSG_VELNED:
+            solution->speed = ubx->pending.groundSpeed;                     // cm/s
+            solution->groundCourse = ubx->pending.heading / 10000;          // Heading 2D deg * 100000 rescaled to deg * 10
+            solution->velNED[0] = ubx->pending.velNED[0];
+            solution->velNED[1] = ubx->pending.velNED[1];
+            solution->velNED[2] = ubx->pending.velNED[2];
+            solution->speedAccuracy = ubx->pending.speedAccuracy;
+            solution->velocityValid = true;
+            ubx->newSpeed = true;
+            break;
+
+        case MSG_PVT:
+            // position and velocity of the same epoch in one message, mm and mm/s
+            solution->timeOfWeekMs = ubx->pending.timeOfWeekMs;
+            solution->fix = ubxFix(ubx);
+            solution->coord[LON] = ubx->pending.lon;
+            solution->coord[LAT] = ubx->pending.lat;
+            solution->altitude = ubx->pending.altitudeMsl / 10 / 100;
+            solution->numSat = ubx->pending.numSat;
+            solution->hdop = ubx->pending.pdop;
+            solution->speed = ubx->pending.groundSpeed / 10;
+            solution->groundCourse = ubx->pending.heading / 10000;
+            solution->velNED[0] = ubx->pending.velNED[0] / 10;
+            solution->velNED[1] = ubx->pending.velNED[1] / 10;
+            solution->velNED[2] = ubx->pending.velNED[2] / 10;
+            solution->speedAccuracy = ubx->pending.speedAccuracy / 10;
+            solution->velocityValid = true;
+            ubx->newPosition = ubx->newSpeed = false;
+            return GPS_PARSE_SOLUTION;
+
+        case MSG_SVINFO:
+            parser->svInfoPending.numCh = MIN(ubx->pending.numCh, GPS_SV_MAXSATS);
+            parser->svInfo = parser->svInfoPending;
+            parser->svInfoUpdated = true;
+            break;
+    }
+
+    // only report a solution once both position and speed were received, so stale data is not used
+    if (ubx->newPosition && ubx->newSpeed) {
+        ubx->newPosition = ubx->newSpeed = false;
+        return GPS_PARSE_SOLUTION;
+    }
+    return GPS_PARSE_PACKET;
+}
+
+gpsParseResult_e gpsParserProcessUblox(gpsParser_t *parser, uint8_t data)
+{
+    gpsUbloxState_t *ubx = &parser->state.ublox;
+
+    switch (ubx->step) {
+        case UBX_STEP_SYNC1:
+            if (data == PREAMBLE1) {
+                ubx->step = UBX_STEP_SYNC2;
+            } else {
+                parser->stats.garbageByteCount++;
+            }
+            break;
+
+        case UBX_STEP_SYNC2:
+            ubx->step = (data == PREAMBLE2) ? UBX_STEP_CLASS : UBX_STEP_SYNC1;
+            break;
+
+        case UBX_STEP_CLASS:
+            ubx->msgClass = data;
+            ubx->ckB = ubx->ckA = data;     // reset the checksum accumulators
+            ubx->step = UBX_STEP_ID;
+            break;
+
+        case UBX_STEP_ID:
+            ubx->ckB += (ubx->ckA += data);
+            ubx->msgId = data;
+            ubx->step = UBX_STEP_LENGTH1;
+            break;
+
+        case UBX_STEP_LENGTH1:
+            ubx->ckB += (ubx->ckA += data);
+            ubx->payloadLength = data;
+            ubx->step = UBX_STEP_LENGTH2;
+            break;
+
+        case UBX_STEP_LENGTH2:
+            ubx->ckB += (ubx->ckA += data);
+            ubx->payloadLength |= (uint16_t)(data << 8);
+
+            if (ubx->payloadLength > MAX_UBLOX_PAYLOAD_SIZE) {
+                // garbage or a message we do not use, start searching for the next packet
+                parser->packetLogChar = GPS_LOG_SKIPPED;
+                parser->stats.errors++;
+                ubx->step = UBX_STEP_SYNC1;
+                return GPS_PARSE_PACKET;
+            }
+
+            ubx->message = ubxFindMessage(ubx->msgClass, ubx->msgId, ubx->payloadLength);
+            ubx->fieldIndex = 0;
+            ubx->fieldValue = 0;
+            ubx->payloadCounter = 0;
+            if (ubx->message && ubx->message->id == MSG_SVINFO) {
+                memset(&parser->svInfoPending, 0, sizeof(parser->svInfoPending));
+            }
+            ubx->step = (ubx->payloadLength == 0) ? UBX_STEP_CK_A : UBX_STEP_PAYLOAD;
+            break;
+
+        case UBX_STEP_PAYLOAD:
+            ubx->ckB += (ubx->ckA += data);
+            if (ubx->message) {
+                ubxPayloadByte(parser, data);
+            }
+            if (++ubx->payloadCounter == ubx->payloadLength) {
+                ubx->step = UBX_STEP_CK_A;
+            }
+            break;
+
+        case UBX_STEP_CK_A:
+            ubx->ckValid = (ubx->ckA == data);
+            ubx->step = UBX_STEP_CK_B;
+            break;
+
+        case UBX_STEP_CK_B:
+            ubx->step = UBX_STEP_SYNC1;
+
+            if (!ubx->ckValid || ubx->ckB != data) {
+                parser->packetLogChar = GPS_LOG_ERROR;
+                parser->stats.errors++;
+                return GPS_PARSE_PACKET;
+            }
+
+            parser->stats.packetCount++;
+
+            if (!ubx->message) {
+                parser->packetLogChar = GPS_LOG_IGNORED;
+                return GPS_PARSE_PACKET;
+            }
+
+            parser->packetLogChar = ubx->message->logChar;
+            return ubxMessageEnd(parser);
+    }
+    return GPS_PARSE_IN_PROGRESS;
+}
+
+#endif
@@ -0,0 +1,155 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Streaming NMEA and UBX parsers.
+//
+// Bytes are consumed one at a time without a sentence or payload buffer: numeric NMEA fields are converted
+// as their digits arrive and UBX payload fields are picked out of the stream at their offsets. Decoded values
+// are held in a pending copy until the checksum of the packet has been verified, then merged into the
+// solution, so a corrupted packet never changes the published values.
+
+#define GPS_SV_MAXSATS   16
+
+typedef enum {
+    GPS_PARSE_IN_PROGRESS = 0,
+    GPS_PARSE_PACKET,               // a packet ended, see packetLogChar
+    GPS_PARSE_SOLUTION,             // a packet completed a navigation solution
+} gpsParseResult_e;
+
+typedef struct gpsSolution_s {
+    uint32_t timeOfWeekMs;          // UBX only
+    int32_t coord[2];               // LAT/LON, degrees * 10^7
+    uint16_t altitude;              // m
+    uint16_t speed;                 // ground speed, cm/s
+    uint16_t groundCourse;          // degrees * 10
+    uint16_t hdop;                  // 0.01
+    uint8_t numSat;
+    bool fix;
+    bool velocityValid;             // velNED and speedAccuracy are set, UBX only
+    int32_t velNED[3];              // cm/s
+    uint32_t speedAccuracy;         // cm/s
+} gpsSolution_t;
+
+typedef struct gpsSvInfo_s {
+    uint8_t numCh;
+    uint8_t chn[GPS_SV_MAXSATS];
+    uint8_t svid[GPS_SV_MAXSATS];
+    uint8_t quality[GPS_SV_MAXSATS];
+    uint8_t cno[GPS_SV_MAXSATS];
+} gpsSvInfo_t;
+
+typedef struct gpsParserStats_s {
+    uint32_t packetCount;
+    uint32_t errors;
+    uint32_t garbageByteCount;
+} gpsParserStats_t;
+
+typedef struct gpsNmeaState_s {
+    bool inSentence;
+    bool inChecksum;
+    uint8_t frame;
+    uint8_t param;
+    uint8_t parity;
+    uint8_t checksum;
+    uint8_t checksumDigits;
+
+    // the field being received
+    uint32_t fieldTag;              // last four characters
+    uint32_t fieldInteger;          // digits before the decimal point
+    uint16_t fieldFraction;         // up to four digits after it
+    uint8_t fieldFractionDigits;
+    uint8_t fieldIntegerDigits;
+    uint8_t fieldLength;
+    bool fieldDecimal;
+
+    // the sentence being received, used once the checksum matches
+    gpsSolution_t pending;
+    uint8_t svMessageNum;
+    uint8_t svTotal;
+    uint8_t svCount;
+    uint8_t svid[4];
+    uint8_t cno[4];
+} gpsNmeaState_t;
+
+typedef struct gpsUbloxState_s {
+    uint8_t step;
+    uint8_t msgClass;
+    uint8_t msgId;
+    uint8_t ckA;
+    uint8_t ckB;
+    bool ckValid;
+    uint16_t payloadLength;
+    uint16_t payloadCounter;
+    const struct ubxMessage_s *message;     // NULL while the payload is skipped
+    uint8_t fieldIndex;
+    uint32_t fieldValue;
+
+    // the message being received, used once the checksum matches
+    struct {
+        uint32_t timeOfWeekMs;
+        int32_t lon;
+        int32_t lat;
+        int32_t altitudeMsl;                // mm
+        uint8_t fixType;
+        uint8_t fixFlags;
+        uint8_t numSat;
+        uint16_t pdop;
+        int32_t velNED[3];
+        uint32_t groundSpeed;
+        int32_t heading;                    // degrees * 10^5
+        uint32_t speedAccuracy;
+        uint8_t numCh;
+    } pending;
+
+    bool nextFix;
+    bool newPosition;
+    bool newSpeed;
+} gpsUbloxState_t;
+
+typedef struct gpsParser_s {
+    uint8_t provider;                       // gpsProvider_e
+    char packetLogChar;                     // kind of the last packet, see GPS_LOG_*
+    bool svInfoUpdated;                     // set when a packet updated svInfo, cleared by the caller
+    gpsSolution_t solution;
+    gpsSvInfo_t svInfo;
+    gpsSvInfo_t svInfoPending;
+    gpsParserStats_t stats;
+    union {
+        gpsNmeaState_t nmea;
+        gpsUbloxState_t ublox;
+    } state;
+} gpsParser_t;
+
+#define GPS_LOG_ERROR           '?'
+#define GPS_LOG_IGNORED         '!'
+#define GPS_LOG_SKIPPED         '>'
+#define GPS_LOG_NMEA_GGA        'g'
+#define GPS_LOG_NMEA_RMC        'r'
+#define GPS_LOG_NMEA_GSV        'v'
+#define GPS_LOG_UBLOX_SOL       'O'
+#define GPS_LOG_UBLOX_STATUS    'S'
+#define GPS_LOG_UBLOX_SVINFO    'I'
+#define GPS_LOG_UBLOX_POSLLH    'P'
+#define GPS_LOG_UBLOX_VELNED    'V'
+#define GPS_LOG_UBLOX_PVT       'T'
+
+void gpsParserInit(gpsParser_t *parser, uint8_t provider);
+gpsParseResult_e gpsParserProcessByte(gpsParser_t *parser, uint8_t c);
+gpsParseResult_e gpsParserProcessNmea(gpsParser_t *parser, uint8_t c);
+gpsParseResult_e gpsParserProcessUblox(gpsParser_t *parser, uint8_t c);
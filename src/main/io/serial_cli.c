@@ -49,6 +49,8 @@
 #include "drivers/gpio.h"
 #include "drivers/timer.h"
 #include "drivers/pwm_rx.h"
+#include "drivers/pwm_output.h"
+#include "drivers/dshot.h"
 #include "drivers/sdcard.h"
 
 #include "drivers/buf_writer.h"
@@ -141,6 +143,9 @@ static void cliDump(char *cmdLine);
 static void cliExit(char *cmdline);
 static void cliFeature(char *cmdline);
 static void cliMotor(char *cmdline);
+#ifdef USE_DSHOT
+static void cliDshotCommand(char *cmdline);
+#endif
 #ifdef BUZZER
 static void cliPlaySound(char *cmdline);
 #endif
@@ -224,7 +229,11 @@ static const char * const featureNames[] = {
     "SERVO_TILT", "SOFTSERIAL", "GPS", "FAILSAFE",
     "SONAR", "TELEMETRY", "AMPERAGE_METER", "3D", "RX_PARALLEL_PWM",
     "RX_MSP", "RSSI_ADC", "LED_STRIP", "DISPLAY", "ONESHOT125",
-    "BLACKBOX", "CHANNEL_FORWARDING", "TRANSPONDER", NULL
+    "BLACKBOX", "CHANNEL_FORWARDING", "TRANSPONDER",
+#ifdef USE_DSHOT
+    "DSHOT",
+#endif
+    NULL
 };
 
 // sync this with rxFailsafeChannelMode_e
@@ -285,6 +294,10 @@ const clicmd_t cmdTable[] = {
     CLI_COMMAND_DEF("mode_color", "configure mode and special colors", NULL, cliModeColor),
 #endif
     CLI_COMMAND_DEF("defaults", "reset to defaults and reboot", NULL, cliDefaults),
+#ifdef USE_DSHOT
+    CLI_COMMAND_DEF("dshot_cmd", "send a command to DShot ESCs",
+        "<index|all> <command>", cliDshotCommand),
+#endif
     CLI_COMMAND_DEF("dump", "dump configuration",
         "[master|profile|rates]", cliDump),
     CLI_COMMAND_DEF("exit", NULL, NULL, cliExit),
@@ -410,6 +423,10 @@ static const char * const lookupTableBlackboxDevice[] = {
     "SERIAL", "SPIFLASH", "SDCARD"
 };
 
+static const char * const lookupTableBlackboxMode[] = {
+    "CONTINUOUS", "TRIGGERED"
+};
+
 static const char * const lookupTableSerialRX[] = {
     "SPEK1024",
     "SPEK2048",
@@ -457,6 +474,7 @@ static const char * const lookupTableDebug[DEBUG_MODE_COUNT] = {
     "GYRO",
     "PIDLOOP",
     "GYROSYNC",
+    "OUTPUTLATENCY",
 };
 
 typedef struct lookupTableEntry_s {
@@ -475,6 +493,7 @@ typedef enum {
 #endif
 #ifdef BLACKBOX
     TABLE_BLACKBOX_DEVICE,
+    TABLE_BLACKBOX_MODE,
 #endif
     TABLE_AMPERAGE_METER,
 #ifdef USE_SERVOS
@@ -501,6 +520,7 @@ static const lookupTableEntry_t lookupTables[] = {
 #endif
 #ifdef BLACKBOX
     { lookupTableBlackboxDevice, sizeof(lookupTableBlackboxDevice) / sizeof(char *) },
+    { lookupTableBlackboxMode, sizeof(lookupTableBlackboxMode) / sizeof(char *) },
 #endif
     { lookupTableAmperageMeter, sizeof(lookupTableAmperageMeter) / sizeof(char *) },
 #ifdef USE_SERVOS
@@ -621,6 +641,7 @@ const clivalue_t valueTable[] = {
     { "gps_sbas_mode",              VAR_UINT8  | MASTER_VALUE | MODE_LOOKUP, .config.lookup = { TABLE_GPS_SBAS_MODE }, PG_GPS_CONFIG, offsetof(gpsConfig_t, sbasMode)},
     { "gps_auto_config",            VAR_UINT8  | MASTER_VALUE | MODE_LOOKUP, .config.lookup = { TABLE_OFF_ON }, PG_GPS_CONFIG, offsetof(gpsConfig_t, autoConfig)},
     { "gps_auto_baud",              VAR_UINT8  | MASTER_VALUE | MODE_LOOKUP, .config.lookup = { TABLE_OFF_ON }, PG_GPS_CONFIG, offsetof(gpsConfig_t, autoBaud)},
+    { "gps_ublox_nav_pvt",          VAR_UINT8  | MASTER_VALUE | MODE_LOOKUP, .config.lookup = { TABLE_OFF_ON }, PG_GPS_CONFIG, offsetof(gpsConfig_t, ubloxNavPvt)},
 
     { "gps_pos_p",                  VAR_UINT8  | PROFILE_VALUE, .config.minmax = { 0,  200 }, PG_PID_PROFILE, offsetof(pidProfile_t, P8[PIDPOS]) },
     { "gps_pos_i",                  VAR_UINT8  | PROFILE_VALUE, .config.minmax = { 0,  200 }, PG_PID_PROFILE, offsetof(pidProfile_t, I8[PIDPOS]) },
@@ -640,6 +661,8 @@ const clivalue_t valueTable[] = {
     { "nav_speed_min",              VAR_UINT16 | PROFILE_VALUE, .config.minmax = { 10,  2000 }, PG_NAVIGATION_CONFIG, offsetof(gpsProfile_t, nav_speed_min) },
     { "nav_speed_max",              VAR_UINT16 | PROFILE_VALUE, .config.minmax = { 10,  2000 }, PG_NAVIGATION_CONFIG, offsetof(gpsProfile_t, nav_speed_max) },
     { "nav_slew_rate",              VAR_UINT8  | PROFILE_VALUE, .config.minmax = { 0,  100 }, PG_NAVIGATION_CONFIG, offsetof(gpsProfile_t, nav_slew_rate) },
+    { "nav_inertial",               VAR_UINT8  | PROFILE_VALUE | MODE_LOOKUP, .config.lookup = { TABLE_OFF_ON }, PG_NAVIGATION_CONFIG, offsetof(gpsProfile_t, nav_inertial) },
+    { "nav_gps_delay",              VAR_UINT8  | PROFILE_VALUE, .config.minmax = { 0,  200 }, PG_NAVIGATION_CONFIG, offsetof(gpsProfile_t, nav_gps_delay) },
 #endif
 
 #ifdef TELEMETRY
@@ -758,8 +781,11 @@ const clivalue_t valueTable[] = {
 #ifdef BARO
     { "baro_tab_size",              VAR_UINT8  | PROFILE_VALUE, .config.minmax = { 0,  BARO_SAMPLE_COUNT_MAX } , PG_BAROMETER_CONFIG, offsetof(barometerConfig_t, baro_sample_count)},
     { "baro_noise_lpf",             VAR_FLOAT  | PROFILE_VALUE, .config.minmax = { 0 , 1 } , PG_BAROMETER_CONFIG, offsetof(barometerConfig_t, baro_noise_lpf)},
-    { "baro_cf_vel",                VAR_FLOAT  | PROFILE_VALUE, .config.minmax = { 0 , 1 } , PG_BAROMETER_CONFIG, offsetof(barometerConfig_t, baro_cf_vel)},
-    { "baro_cf_alt",                VAR_FLOAT  | PROFILE_VALUE, .config.minmax = { 0 , 1 } , PG_BAROMETER_CONFIG, offsetof(barometerConfig_t, baro_cf_alt)},
+
+    { "alt_acc_noise",              VAR_FLOAT  | MASTER_VALUE, .config.minmax = { 0 , 1000 } , PG_ALTITUDE_KALMAN_CONFIG, offsetof(altitudeKalmanConfig_t, alt_acc_noise)},
+    { "alt_acc_bias_noise",         VAR_FLOAT  | MASTER_VALUE, .config.minmax = { 0 , 100 } , PG_ALTITUDE_KALMAN_CONFIG, offsetof(altitudeKalmanConfig_t, alt_acc_bias_noise)},
+    { "alt_baro_noise",             VAR_FLOAT  | MASTER_VALUE, .config.minmax = { 1 , 1000 } , PG_ALTITUDE_KALMAN_CONFIG, offsetof(altitudeKalmanConfig_t, alt_baro_noise)},
+    { "alt_sonar_noise",            VAR_FLOAT  | MASTER_VALUE, .config.minmax = { 1 , 100 } , PG_ALTITUDE_KALMAN_CONFIG, offsetof(altitudeKalmanConfig_t, alt_sonar_noise)},
 
     { "baro_hardware",              VAR_UINT8  | MASTER_VALUE, .config.minmax = { 0,  BARO_MAX } , PG_SENSOR_SELECTION_CONFIG, offsetof(sensorSelectionConfig_t, baro_hardware)},
 #endif
@@ -797,6 +823,7 @@ const clivalue_t valueTable[] = {
     { "pid_delta_method",           VAR_UINT8  | PROFILE_VALUE | MODE_LOOKUP,  .config.lookup = { TABLE_PID_DELTA_METHOD }, PG_PID_PROFILE, offsetof(pidProfile_t, deltaMethod) },
     { "yaw_p_limit",                VAR_UINT16 | PROFILE_VALUE, .config.minmax = { YAW_P_LIMIT_MIN, YAW_P_LIMIT_MAX } , PG_PID_PROFILE, offsetof(pidProfile_t, yaw_p_limit)},
     { "yaw_lpf_hz",                 VAR_UINT16 | PROFILE_VALUE, .config.minmax = {0, 500 } , PG_PID_PROFILE, offsetof(pidProfile_t, yaw_lpf_hz)},
+    { "yaw_ff_lead_ms",             VAR_UINT8  | PROFILE_VALUE, .config.minmax = { 0, YAW_FF_LEAD_MS_MAX } , PG_PID_PROFILE, offsetof(pidProfile_t, yaw_ff_lead_ms)},
     { "dterm_lowpass_level",        VAR_UINT8  | PROFILE_VALUE | MODE_LOOKUP, .config.lookup = { TABLE_LOWPASS_TYPE }, PG_PID_PROFILE, offsetof(pidProfile_t, dterm_filter_type)},
     { "dterm_lowpass_hz",           VAR_UINT16 | PROFILE_VALUE, .config.minmax = {0, 500 } , PG_PID_PROFILE, offsetof(pidProfile_t, dterm_lpf_hz)},
     { "horizon_tilt_effect",        VAR_UINT8  | PROFILE_VALUE, .config.minmax = { 0, 250 } , PG_PID_PROFILE, offsetof(pidProfile_t, horizon_tilt_effect)},
@@ -818,6 +845,11 @@ const clivalue_t valueTable[] = {
     { "blackbox_rate_num",          VAR_UINT8  | MASTER_VALUE, .config.minmax = { 1,  32 } , PG_BLACKBOX_CONFIG, offsetof(blackboxConfig_t, rate_num)},
     { "blackbox_rate_denom",        VAR_UINT8  | MASTER_VALUE, .config.minmax = { 1,  32 } , PG_BLACKBOX_CONFIG, offsetof(blackboxConfig_t, rate_denom)},
     { "blackbox_device",            VAR_UINT8  | MASTER_VALUE | MODE_LOOKUP, .config.lookup = { TABLE_BLACKBOX_DEVICE } , PG_BLACKBOX_CONFIG, offsetof(blackboxConfig_t, device)},
+    { "blackbox_timing_rate",       VAR_UINT8  | MASTER_VALUE, .config.minmax = { 0,  50 } , PG_BLACKBOX_CONFIG, offsetof(blackboxConfig_t, timing_rate)},
+    { "blackbox_mode",              VAR_UINT8  | MASTER_VALUE | MODE_LOOKUP, .config.lookup = { TABLE_BLACKBOX_MODE } , PG_BLACKBOX_CONFIG, offsetof(blackboxConfig_t, mode)},
+    { "blackbox_triggers",          VAR_UINT8  | MASTER_VALUE, .config.minmax = { 0,  BLACKBOX_TRIGGER_ALL } , PG_BLACKBOX_CONFIG, offsetof(blackboxConfig_t, triggers)},
+    { "blackbox_pre_trigger_ms",    VAR_UINT16 | MASTER_VALUE, .config.minmax = { 0,  10000 } , PG_BLACKBOX_CONFIG, offsetof(blackboxConfig_t, pre_trigger_ms)},
+    { "blackbox_post_trigger_ms",   VAR_UINT16 | MASTER_VALUE, .config.minmax = { 0,  60000 } , PG_BLACKBOX_CONFIG, offsetof(blackboxConfig_t, post_trigger_ms)},
 #endif
 
     { "magzero_x",                  VAR_INT16  | MASTER_VALUE, .config.minmax = { -32768,  32767 } , PG_SENSOR_TRIMS, offsetof(sensorTrims_t, magZero.raw[X])},
@@ -2294,6 +2326,47 @@ static void cliMotor(char *cmdline)
     cliPrintf("motor %d: %d\r\n", motor_index, motor_disarmed[motor_index]);
 }
 
+#ifdef USE_DSHOT
+static void cliDshotCommand(char *cmdline)
+{
+    char *saveptr;
+    char *motorArg = strtok_r(cmdline, " ", &saveptr);
+    char *commandArg = strtok_r(NULL, " ", &saveptr);
+
+    if (!motorArg || !commandArg) {
+        cliShowParseError();
+        return;
+    }
+
+    // the ESC ignores commands while the motor is running
+    if (ARMING_FLAG(ARMED)) {
+        cliPrint("Disarm first\r\n");
+        return;
+    }
+
+    int command = atoi(commandArg);
+    if (command < DSHOT_CMD_MOTOR_STOP || command > DSHOT_CMD_MAX) {
+        cliShowArgumentRangeError("command", DSHOT_CMD_MOTOR_STOP, DSHOT_CMD_MAX);
+        return;
+    }
+
+    if (strcasecmp(motorArg, "all") == 0) {
+        for (int i = 0; i < MAX_SUPPORTED_MOTORS; i++) {
+            pwmWriteDshotCommand(i, command);
+        }
+    } else {
+        int motorIndex = atoi(motorArg);
+        if (motorIndex < 0 || motorIndex >= MAX_SUPPORTED_MOTORS) {
+            cliShowArgumentRangeError("index", 0, MAX_SUPPORTED_MOTORS - 1);
+            return;
+        }
+        pwmWriteDshotCommand(motorIndex, command);
+    }
+
+    cliPrintf("dshot_cmd %s: %d\r\n", motorArg, command);
+}
+#endif
+
 #ifdef BUZZER
 static void cliPlaySound(char *cmdline)
 {
@@ -210,6 +210,18 @@
 #define MSP_SENSOR_CONFIG               96
 #define MSP_SET_SENSOR_CONFIG           97
 
+#define MSP_TRACE_NAMES                 98 //out message         Names of the trace sections or the scheduler tasks, ';' separated
+#define MSP_TRACE_READ                  99 //out message         Start or stop recording trace events and read the recorded events
+
+// MSP_TRACE_NAMES request
+#define MSP_TRACE_NAMES_SECTIONS        0
+#define MSP_TRACE_NAMES_TASKS           1
+
+// MSP_TRACE_READ request, the reply is the recording state, the events left to read and events of 6 bytes
+#define MSP_TRACE_READ_EVENTS           0
+#define MSP_TRACE_READ_START            1
+#define MSP_TRACE_READ_STOP             2
+
 //
 // OSD specific
 //
@@ -91,15 +91,15 @@ static const element_t osdDefaultElements[] = {
     { 11, -3, EF_ENABLED | EF_FLASH_ON_DISCONNECT, OSD_ELEMENT_INDICATOR_MAG },
     { 18, -3, EF_ENABLED | EF_FLASH_ON_DISCONNECT, OSD_ELEMENT_INDICATOR_BARO },
     { 13, -3, EF_ENABLED | EF_FLASH_ON_DISCONNECT, OSD_ELEMENT_FLIGHT_MODE },
-    {  2, -4, EF_ENABLED, OSD_ELEMENT_ON_DURATION },
-    { 22, -4, EF_ENABLED, OSD_ELEMENT_ARMED_DURATION },
-    {  2, -3, EF_ENABLED, OSD_ELEMENT_VOLTAGE_12V },
+    {  2, -4, EF_ENABLED | EF_REFRESH_SLOW, OSD_ELEMENT_ON_DURATION },
+    { 22, -4, EF_ENABLED | EF_REFRESH_SLOW, OSD_ELEMENT_ARMED_DURATION },
+    {  2, -3, EF_ENABLED | EF_REFRESH_SLOW, OSD_ELEMENT_VOLTAGE_12V },
     { 22, -3, EF_ENABLED, OSD_ELEMENT_VOLTAGE_BATTERY },
-    {  2, -2, EF_ENABLED, OSD_ELEMENT_VOLTAGE_5V },
+    {  2, -2, EF_ENABLED | EF_REFRESH_SLOW, OSD_ELEMENT_VOLTAGE_5V },
     { 22, -2, EF_ENABLED | EF_FLASH_ON_DISCONNECT, OSD_ELEMENT_VOLTAGE_BATTERY_FC },
     {  2, -1, EF_ENABLED, OSD_ELEMENT_AMPERAGE },
-    { 22, -1, EF_ENABLED, OSD_ELEMENT_MAH_DRAWN },
-    {  8, -1, EF_ENABLED, OSD_ELEMENT_CALLSIGN },
+    { 22, -1, EF_ENABLED | EF_REFRESH_SLOW, OSD_ELEMENT_MAH_DRAWN },
+    {  8, -1, EF_ENABLED | EF_REFRESH_SLOW, OSD_ELEMENT_CALLSIGN },
     { 13, -5, EF_ENABLED, OSD_ELEMENT_MOTORS },
 };
 
@@ -110,6 +110,8 @@ void pgResetFn_osdElementConfig(osdElementConfig_t *osdElementConfig) {
 
 osdState_t osdState;
 
+static osdElementCache_t osdElementCaches[MAX_OSD_ELEMENT_COUNT];
+
 void osdDisplaySplash(void)
 {
     osdHardwareDrawLogo();
@@ -231,7 +233,7 @@ void osdUpdate(void)
     for (uint8_t elementIndex = 0; elementIndex < MAX_OSD_ELEMENT_COUNT; elementIndex++) {
         element_t *element = &osdElementConfig()->elements[elementIndex];
 
-        osdDrawTextElement(element);
+        osdDrawCachedTextElement(element, &osdElementCaches[elementIndex], now);
     }
 
     //
@@ -23,6 +23,7 @@
 #include <platform.h>
 #include "build/debug.h"
 
+#include "common/maths.h" // only required for data providers
 #include "common/utils.h"
 #include "common/filter.h" // only required for data providers
 
@@ -154,21 +155,53 @@ intptr_t osdElementData_motors(void)
     return (intptr_t) fcMotors;
 }
 
+// the durations are rendered in seconds
+uint32_t osdElementKey_duration(intptr_t data)
+{
+    return (uint32_t)data / 1000;
+}
+
+uint32_t osdElementKey_voltage(intptr_t data)
+{
+    voltageAndName_t *voltageAndName = (voltageAndName_t *)data;
+    return (uint32_t)(uint16_t)voltageAndName->voltage | (voltageAndName->symbol << 16);
+}
+
+uint32_t osdElementKey_callsign(intptr_t data)
+{
+    const uint8_t *callsign = (const uint8_t *)data;
+    uint32_t hash = 5381;
+    while (*callsign) {
+        hash = hash * 33 + *callsign++;
+    }
+    return hash;
+}
+
+uint32_t osdElementKey_motors(intptr_t data)
+{
+    const uint16_t *motors = (const uint16_t *)data;
+    uint32_t key = 0;
+    for (int i = 0; i < 4; i++) {
+        key = (key << 8) | (motors[i] ? (uint8_t)(scaleRange(motors[i], 1000, 2000, 0, 100) + 1) : 0);
+    }
+    return key;
+}
+
 elementHandlerConfig_t elementHandlers[] = {
-    {OSD_ELEMENT_ON_DURATION, osdElementRender_duration, osdElementData_onDuration},
-    {OSD_ELEMENT_ARMED_DURATION, osdElementRender_duration, osdElementData_armedDuration},
-    {OSD_ELEMENT_MAH_DRAWN, osdElementRender_mahDrawn, osdElementData_mAhDrawn},
-    {OSD_ELEMENT_AMPERAGE, osdElementRender_amperage, osdElementData_amperage},
-    {OSD_ELEMENT_VOLTAGE_5V, osdElementRender_voltageBattery, osdElementData_voltage5V},
-    {OSD_ELEMENT_VOLTAGE_12V, osdElementRender_voltageBattery, osdElementData_voltage12V},
-    {OSD_ELEMENT_VOLTAGE_BATTERY, osdElementRender_voltageBattery, osdElementData_voltageBattery},
-    {OSD_ELEMENT_VOLTAGE_BATTERY_FC, osdElementRender_voltageBattery, osdElementData_voltageBatteryFC},
-    {OSD_ELEMENT_FLIGHT_MODE, osdElementRender_flightMode, osdElementData_flightModeFC},
-    {OSD_ELEMENT_INDICATOR_MAG, osdElementRender_indicatorMag, osdElementData_indicatorMagFC},
-    {OSD_ELEMENT_INDICATOR_BARO, osdElementRender_indicatorBaro, osdElementData_indicatorBaroFC},
-    {OSD_ELEMENT_RSSI_FC, osdElementRender_rssi, osdElementData_rssiFC},
-    {OSD_ELEMENT_CALLSIGN, osdElementRender_callsign, osdElementData_callsign},
-    {OSD_ELEMENT_MOTORS, osdElementRender_motors, osdElementData_motors},
+    {OSD_ELEMENT_ON_DURATION, osdElementRender_duration, osdElementData_onDuration, osdElementKey_duration},
+    {OSD_ELEMENT_ARMED_DURATION, osdElementRender_duration, osdElementData_armedDuration, osdElementKey_duration},
+    {OSD_ELEMENT_MAH_DRAWN, osdElementRender_mahDrawn, osdElementData_mAhDrawn, NULL},
+    {OSD_ELEMENT_AMPERAGE, osdElementRender_amperage, osdElementData_amperage, NULL},
+    {OSD_ELEMENT_VOLTAGE_5V, osdElementRender_voltageBattery, osdElementData_voltage5V, osdElementKey_voltage},
+    {OSD_ELEMENT_VOLTAGE_12V, osdElementRender_voltageBattery, osdElementData_voltage12V, osdElementKey_voltage},
+    {OSD_ELEMENT_VOLTAGE_BATTERY, osdElementRender_voltageBattery, osdElementData_voltageBattery, osdElementKey_voltage},
+    {OSD_ELEMENT_VOLTAGE_BATTERY_FC, osdElementRender_voltageBattery, osdElementData_voltageBatteryFC, osdElementKey_voltage},
+    {OSD_ELEMENT_FLIGHT_MODE, osdElementRender_flightMode, osdElementData_flightModeFC, NULL},
+    {OSD_ELEMENT_INDICATOR_MAG, osdElementRender_indicatorMag, osdElementData_indicatorMagFC, NULL},
+    {OSD_ELEMENT_INDICATOR_BARO, osdElementRender_indicatorBaro, osdElementData_indicatorBaroFC, NULL},
+    {OSD_ELEMENT_RSSI_FC, osdElementRender_rssi, osdElementData_rssiFC, NULL},
+    {OSD_ELEMENT_CALLSIGN, osdElementRender_callsign, osdElementData_callsign, osdElementKey_callsign},
+    {OSD_ELEMENT_MOTORS, osdElementRender_motors, osdElementData_motors, osdElementKey_motors},
 };
 
 static elementHandlerConfig_t *osdFindElementHandler(uint8_t id)
@@ -193,12 +226,39 @@ void osdSetElementFlashOnDisconnectState(bool showNow) {
     osdElementState.flashWhenDisconnected = showNow;
 }
 
-void osdDrawTextElement(const element_t *element)
+static bool osdIsElementShown(const element_t *element)
 {
     if (!(element->flags & EF_ENABLED)) {
-        return;
+        return false;
     }
     if (element->flags & EF_FLASH_ON_DISCONNECT && !osdElementState.flashWhenDisconnected) {
+        return false;
+    }
+    return true;
+}
+
+void osdDrawTextElement(const element_t *element)
+{
+    if (!osdIsElementShown(element)) {
+        return;
+    }
+
+    elementHandlerConfig_t *elementHandlerConfig = osdFindElementHandler(element->id);
+
+    if (!elementHandlerConfig) {
+        return;
+    }
+
+    elementHandlerConfig->renderFn(element, elementHandlerConfig->dataFn());
+}
+
+/*
+ * Draws the element from the cache unless the key of its data has changed since it was rendered.
+ * Elements with EF_REFRESH_SLOW get their data at most once per OSD_ELEMENT_SLOW_REFRESH_INTERVAL_US.
+ */
+void osdDrawCachedTextElement(const element_t *element, osdElementCache_t *cache, uint32_t now)
+{
+    if (!osdIsElementShown(element)) {
         return;
     }
 
@@ -208,5 +268,31 @@ void osdDrawTextElement(const element_t *element)
         return;
     }
 
-    elementHandlerConfig->renderFn(element, elementHandlerConfig->dataFn);
+    const bool cacheUsable = cache->valid
+        && memcmp(&cache->element, element, sizeof(element_t)) == 0
+        && cache->screenHeight == osdTextScreen.height;
+
+    if (cacheUsable && (element->flags & EF_REFRESH_SLOW) && cmp32(now, cache->checkedAt) < OSD_ELEMENT_SLOW_REFRESH_INTERVAL_US) {
+        osdScreenCaptureReplay(&cache->capture);
+        return;
+    }
+
+    const intptr_t data = elementHandlerConfig->dataFn();
+    const uint32_t key = elementHandlerConfig->keyFn ? elementHandlerConfig->keyFn(data) : (uint32_t)data;
+    cache->checkedAt = now;
+
+    if (cacheUsable && key == cache->key) {
+        osdScreenCaptureReplay(&cache->capture);
+        return;
+    }
+
+    osdScreenCaptureBegin(&cache->capture);
+    elementHandlerConfig->renderFn(element, data);
+    osdScreenCaptureEnd();
+
+    // elements that write more than fits in the capture are rendered every time
+    cache->valid = !cache->capture.overflow;
+    cache->element = *element;
+    cache->screenHeight = osdTextScreen.height;
+    cache->key = key;
 }
@@ -15,6 +15,10 @@
  * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#pragma once
+
+#include "osd/osd_screen.h"
+
 // 0 - 65535 / 16 bits.
 enum osdElementIds_e {
     // durations/timers
@@ -52,8 +56,11 @@ enum osdElementFlags_e {
     EF_ENABLED = (1 << 0),
     EF_POSITIONABLE = (1 << 1),
     EF_FLASH_ON_DISCONNECT = (1 << 2),
+    EF_REFRESH_SLOW = (1 << 3),     // the data is checked for changes at OSD_ELEMENT_SLOW_REFRESH_INTERVAL_US, e.g. for timers and mAh
 };
 
+#define OSD_ELEMENT_SLOW_REFRESH_INTERVAL_US (250 * 1000)
+
 typedef struct element_s {
     int8_t x;
     int8_t y;
@@ -62,16 +69,29 @@ typedef struct element_s {
 } element_t;
 
 typedef intptr_t (*elementDataProviderFn)(void);
-typedef void (*elementRenderFn)(const element_t *element, elementDataProviderFn dataFn);
+typedef void (*elementRenderFn)(const element_t *element, intptr_t data);
+typedef uint32_t (*elementDataKeyFn)(intptr_t data); // what the rendered text depends on, the data itself when NULL
 
 typedef struct elementHandlerConfig_s {
     uint8_t id;
     elementRenderFn renderFn;
     elementDataProviderFn dataFn;
+    elementDataKeyFn keyFn;
 } elementHandlerConfig_t;
 
+// The last rendering of an element, written again while the key of its data is unchanged.
+typedef struct osdElementCache_s {
+    element_t element;
+    uint8_t screenHeight;
+    bool valid;
+    uint32_t key;
+    uint32_t checkedAt;
+    osdScreenCapture_t capture;
+} osdElementCache_t;
+
 // state - update state before drawing elements.
 void osdSetElementFlashOnDisconnectState(bool flashWhenDisconnected);
 
 // draw
 void osdDrawTextElement(const element_t *element);
+void osdDrawCachedTextElement(const element_t *element, osdElementCache_t *cache, uint32_t now);
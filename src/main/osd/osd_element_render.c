@@ -40,9 +40,9 @@ void osdHardwareDisplayMotor(uint8_t x, uint8_t y, uint8_t percent);
 
 static char elementAsciiBuffer[31];
 
-void osdElementRender_duration(const element_t *element, elementDataProviderFn dataFn)
+void osdElementRender_duration(const element_t *element, intptr_t data)
 {
-    uint32_t millis = (uint32_t) dataFn();
+    uint32_t millis = (uint32_t) data;
 
     uint32_t totalSeconds = (millis / 1000);
     uint8_t minutes = totalSeconds / 60;
@@ -52,62 +52,62 @@ void osdElementRender_duration(const element_t *element, elementDataProviderFn d
     osdPrintAt(element->x, element->y, elementAsciiBuffer);
 }
 
-void osdElementRender_mahDrawn(const element_t *element, elementDataProviderFn dataFn)
+void osdElementRender_mahDrawn(const element_t *element, intptr_t data)
 {
-    int32_t mAhDrawn = (int32_t) dataFn();
+    int32_t mAhDrawn = (int32_t) data;
 
     tfp_sprintf(elementAsciiBuffer, "%5d", mAhDrawn);
     osdPrintAt(element->x, element->y, elementAsciiBuffer);
     osdSetRawCharacterAtPosition(element->x + 5, element->y, FONT_CHARACTER_MAH);
 }
 
-void osdElementRender_amperage(const element_t *element, elementDataProviderFn dataFn)
+void osdElementRender_amperage(const element_t *element, intptr_t data)
 {
-    int32_t amperage = (int32_t) dataFn();
+    int32_t amperage = (int32_t) data;
 
     tfp_sprintf(elementAsciiBuffer, "%2d.%02d", amperage / 100, amperage % 100);
     osdPrintAt(element->x, element->y, elementAsciiBuffer);
     osdSetRawCharacterAtPosition(element->x + 5, element->y, FONT_CHARACTER_AMP);
 }
 
-void osdElementRender_voltage(const element_t *element, elementDataProviderFn dataFn)
+void osdElementRender_voltage(const element_t *element, intptr_t data)
 {
-    voltageAndName_t *voltageAndName= (voltageAndName_t *) dataFn();
+    voltageAndName_t *voltageAndName= (voltageAndName_t *) data;
 
     tfp_sprintf(elementAsciiBuffer, "%s:%2d.%dV", voltageAndName->name, voltageAndName->voltage / 10, voltageAndName->voltage % 10);
     osdPrintAt(element->x, element->y, elementAsciiBuffer);
 }
 
-void osdElementRender_voltageBattery(const element_t *element, elementDataProviderFn dataFn)
+void osdElementRender_voltageBattery(const element_t *element, intptr_t data)
 {
-    voltageAndName_t *voltageAndName= (voltageAndName_t *) dataFn();
+    voltageAndName_t *voltageAndName= (voltageAndName_t *) data;
 
     tfp_sprintf(elementAsciiBuffer, "%2d.%dV", voltageAndName->voltage / 10, voltageAndName->voltage % 10);
     osdPrintAt(element->x +1, element->y, elementAsciiBuffer);
     osdSetRawCharacterAtPosition(element->x, element->y, voltageAndName->symbol);
 }
 
-void osdElementRender_indicatorMag(const element_t *element, elementDataProviderFn dataFn)
+void osdElementRender_indicatorMag(const element_t *element, intptr_t data)
 {
-    bool on = (bool) dataFn();
+    bool on = (bool) data;
     if (!on)
         return;
 
     osdSetRawCharacterAtPosition(element->x, element->y, FONT_CHARACTER_MAG);
 }
 
-void osdElementRender_indicatorBaro(const element_t *element, elementDataProviderFn dataFn)
+void osdElementRender_indicatorBaro(const element_t *element, intptr_t data)
 {
-   bool on = (bool) dataFn();
+   bool on = (bool) data;
    if (!on)
        return;
 
     osdSetRawCharacterAtPosition(element->x, element->y, FONT_CHARACTER_BARO);
 }
 
-void osdElementRender_flightMode(const element_t *element, elementDataProviderFn dataFn)
+void osdElementRender_flightMode(const element_t *element, intptr_t data)
 {
-    uint8_t modes = (int8_t) dataFn();
+    uint8_t modes = (int8_t) data;
 
     char *flightMode = "";
     if (modes & OSD_FLIGHT_MODE_ACRO) {
@@ -121,18 +121,18 @@ void osdElementRender_flightMode(const element_t *element, elementDataProviderFn
     osdPrintAt(element->x, element->y, flightMode);
 }
 
-void osdElementRender_rssi(const element_t *element, elementDataProviderFn dataFn)
+void osdElementRender_rssi(const element_t *element, intptr_t data)
 {
-    uint16_t rssi = (uint16_t) dataFn();
+    uint16_t rssi = (uint16_t) data;
 
     tfp_sprintf(elementAsciiBuffer, "%3d", (rssi / 1023) * 100);
     osdPrintAt(element->x, element->y, elementAsciiBuffer);
     osdSetRawCharacterAtPosition(element->x + 3, element->y, FONT_CHARACTER_RSSI);
 }
 
-void osdElementRender_callsign(const element_t *element, elementDataProviderFn dataFn)
+void osdElementRender_callsign(const element_t *element, intptr_t data)
 {
-    uint8_t *callsign = (uint8_t *) dataFn();
+    uint8_t *callsign = (uint8_t *) data;
 
     osdPrintAt(element->x, element->y, (char *)callsign);
 }
@@ -150,9 +150,9 @@ struct quadMotorCoordinateOffset_s {
     {0, 1}
 };
 
-void osdElementRender_motors(const element_t *element, elementDataProviderFn dataFn)
+void osdElementRender_motors(const element_t *element, intptr_t data)
 {
-    uint16_t *motors = (uint16_t *) dataFn();
+    uint16_t *motors = (uint16_t *) data;
 
     const int maxMotors = 4; // just quad for now
     for (int i = 0; i < maxMotors; i++) {
@@ -25,14 +25,14 @@ typedef struct voltageAndName_s {
     int16_t voltage;
 } voltageAndName_t;
 
-void osdElementRender_duration(const element_t *element, elementDataProviderFn dataFn);
-void osdElementRender_mahDrawn(const element_t *element, elementDataProviderFn dataFn);
-void osdElementRender_amperage(const element_t *element, elementDataProviderFn dataFn);
-void osdElementRender_voltage(const element_t *element, elementDataProviderFn dataFn);
-void osdElementRender_voltageBattery(const element_t *element, elementDataProviderFn dataFn);
-void osdElementRender_flightMode(const element_t *element, elementDataProviderFn dataFn);
-void osdElementRender_indicatorMag(const element_t *element, elementDataProviderFn dataFn);
-void osdElementRender_indicatorBaro(const element_t *element, elementDataProviderFn dataFn);
-void osdElementRender_rssi(const element_t *element, elementDataProviderFn dataFn);
-void osdElementRender_callsign(const element_t *element, elementDataProviderFn dataFn);
-void osdElementRender_motors(const element_t *element, elementDataProviderFn dataFn);
+void osdElementRender_duration(const element_t *element, intptr_t data);
+void osdElementRender_mahDrawn(const element_t *element, intptr_t data);
+void osdElementRender_amperage(const element_t *element, intptr_t data);
+void osdElementRender_voltage(const element_t *element, intptr_t data);
+void osdElementRender_voltageBattery(const element_t *element, intptr_t data);
+void osdElementRender_flightMode(const element_t *element, intptr_t data);
+void osdElementRender_indicatorMag(const element_t *element, intptr_t data);
+void osdElementRender_indicatorBaro(const element_t *element, intptr_t data);
+void osdElementRender_rssi(const element_t *element, intptr_t data);
+void osdElementRender_callsign(const element_t *element, intptr_t data);
+void osdElementRender_motors(const element_t *element, intptr_t data);
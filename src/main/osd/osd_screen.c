@@ -39,6 +39,8 @@ typedef struct osdCursor_s {
 
 static osdCursor_t cursor = {0, 0};
 
+static osdScreenCapture_t *activeCapture;
+
 static uint16_t osdCalculateBufferOffset(osdCoordVal_t x, osdCoordVal_t y) {
     osdCoordVal_t yy;
     if (y >= 0) {
@@ -57,20 +59,37 @@ static uint16_t osdCalculateBufferOffset(osdCoordVal_t x, osdCoordVal_t y) {
     uint16_t offset = (yy * osdTextScreen.width) + x;
     return offset;
 }
+
+static void osdWriteCharacter(uint16_t offset, TEXT_SCREEN_CHAR c)
+{
+    textScreenBuffer[offset] = c;
+
+    if (!activeCapture) {
+        return;
+    }
+    if (activeCapture->count >= OSD_SCREEN_CAPTURE_SIZE) {
+        activeCapture->overflow = true;
+        return;
+    }
+    activeCapture->offsets[activeCapture->count] = offset;
+    activeCapture->characters[activeCapture->count] = c;
+    activeCapture->count++;
+}
+
 // Does not move the cursor.
 void osdSetCharacterAtPosition(osdCoordVal_t x, osdCoordVal_t y, char c)
 {
     uint8_t mappedCharacter = asciiToFontMapping[(uint8_t)c];
 
     uint16_t offset = osdCalculateBufferOffset(x,y);
-    textScreenBuffer[offset] = mappedCharacter;
+    osdWriteCharacter(offset, mappedCharacter);
 }
 
 // Does not move the cursor.
 void osdSetRawCharacterAtPosition(osdCoordVal_t x, osdCoordVal_t y, char c)
 {
     uint16_t offset = osdCalculateBufferOffset(x,y);
-    textScreenBuffer[offset] = c;
+    osdWriteCharacter(offset, c);
 }
 
 void osdResetCursor(void)
@@ -144,3 +163,23 @@ void osdClearScreen(void)
         }
     }
 }
+
+// Records the characters written until osdScreenCaptureEnd, overflow is set when they do not all fit.
+void osdScreenCaptureBegin(osdScreenCapture_t *capture)
+{
+    capture->count = 0;
+    capture->overflow = false;
+    activeCapture = capture;
+}
+
+void osdScreenCaptureEnd(void)
+{
+    activeCapture = NULL;
+}
+
+void osdScreenCaptureReplay(const osdScreenCapture_t *capture)
+{
+    for (int i = 0; i < capture->count; i++) {
+        textScreenBuffer[capture->offsets[i]] = capture->characters[i];
+    }
+}
@@ -15,7 +15,9 @@
  * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#define TEXT_SCREEN_CHAR uint8_t
+#pragma once
+
+#include "drivers/video_textscreen.h"
 
 extern textScreen_t osdTextScreen;
 extern TEXT_SCREEN_CHAR textScreenBuffer[];
@@ -24,6 +26,16 @@ extern const uint8_t *asciiToFontMapping;
 
 typedef int8_t osdCoordVal_t;
 
+#define OSD_SCREEN_CAPTURE_SIZE 16
+
+// The characters written to the screen while capturing, so they can be written again without rendering.
+typedef struct osdScreenCapture_s {
+    uint16_t offsets[OSD_SCREEN_CAPTURE_SIZE];
+    TEXT_SCREEN_CHAR characters[OSD_SCREEN_CAPTURE_SIZE];
+    uint8_t count;
+    bool overflow;
+} osdScreenCapture_t;
+
 void osdSetTextScreen(textScreen_t *textScreen);
 void osdClearScreen(void);
 void osdResetCursor(void);
@@ -33,3 +45,6 @@ void osdPrintAt(osdCoordVal_t x, osdCoordVal_t y, char *message);
 void osdSetCharacterAtPosition(osdCoordVal_t x, osdCoordVal_t y, char c);
 void osdSetRawCharacterAtPosition(osdCoordVal_t x, osdCoordVal_t y, char c);
 
+void osdScreenCaptureBegin(osdScreenCapture_t *capture);
+void osdScreenCaptureEnd(void);
+void osdScreenCaptureReplay(const osdScreenCapture_t *capture);
@@ -75,6 +75,7 @@ static bool rxIsInFailsafeMode = true;
 static bool rxIsInFailsafeModeNotDataDriven = true;
 
 static uint32_t rxUpdateAt = 0;
+static uint32_t rxFrameReceivedAt = 0;
 static uint32_t needRxSignalBefore = 0;
 static uint32_t suspendRxSignalUntil = 0;
 static uint8_t  skipRxSamples = 0;
@@ -356,6 +357,7 @@ void updateRx(uint32_t currentTime)
             rxIsInFailsafeMode = (frameStatus & RX_FRAME_FAILSAFE) != 0;
             rxSignalReceived = !rxIsInFailsafeMode;
             needRxSignalBefore = currentTime + DELAY_10_HZ;
+            rxFrameReceivedAt = currentTime;
         }
     }
 #endif
@@ -367,6 +369,7 @@ void updateRx(uint32_t currentTime)
             rxIsInFailsafeMode = false;
             rxSignalReceived = true;
             needRxSignalBefore = currentTime + DELAY_5_HZ;
+            rxFrameReceivedAt = currentTime;
         }
     }
 
@@ -375,6 +378,7 @@ void updateRx(uint32_t currentTime)
             rxSignalReceivedNotDataDriven = true;
             rxIsInFailsafeModeNotDataDriven = false;
             needRxSignalBefore = currentTime + DELAY_10_HZ;
+            rxFrameReceivedAt = currentTime;
             resetPPMDataReceivedState();
         }
     }
@@ -384,6 +388,7 @@ void updateRx(uint32_t currentTime)
             rxSignalReceivedNotDataDriven = true;
             rxIsInFailsafeModeNotDataDriven = false;
             needRxSignalBefore = currentTime + DELAY_10_HZ;
+            rxFrameReceivedAt = currentTime;
         }
     }
 
@@ -652,3 +657,9 @@ uint16_t rxGetRefreshRate(void)
     return rxRuntimeConfig.rxRefreshRate;
 }
 
+// Time since the last frame was received, for frame based receivers and PPM/PWM
+uint32_t rxGetFrameAge(uint32_t currentTime)
+{
+    return currentTime - rxFrameReceivedAt;
+}
+
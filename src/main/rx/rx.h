@@ -159,3 +159,4 @@ void suspendRxSignal(void);
 void resumeRxSignal(void);
 
 uint16_t rxGetRefreshRate(void);
+uint32_t rxGetFrameAge(uint32_t currentTime);
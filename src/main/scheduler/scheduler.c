@@ -158,6 +158,13 @@ void getTaskInfo(const int taskId, cfTaskInfo_t * taskInfo)
     taskInfo->averageExecutionTime = cfTasks[taskId].averageExecutionTime;
     taskInfo->latestDeltaTime = cfTasks[taskId].taskLatestDeltaTime;
 }
+
+// Returns the statistics gathered since the last call and starts a new window
+void getTaskTimingWindow(const int taskId, cfTaskTimingWindow_t *window)
+{
+    *window = cfTasks[taskId].timingWindow;
+    memset(&cfTasks[taskId].timingWindow, 0, sizeof(cfTasks[taskId].timingWindow));
+}
 #endif
 
 void rescheduleTask(const int taskId, uint32_t newPeriodMicros)
@@ -264,19 +271,33 @@ void scheduler(void)
 
     if (selectedTask != NULL) {
         // Found a task that should be run
+#ifndef SKIP_TASK_STATISTICS
+        const uint32_t dueAt = selectedTask->checkFunc ? selectedTask->lastSignaledAt : selectedTask->lastExecutedAt + selectedTask->desiredPeriod;
+        const int32_t taskLatency = currentTime - dueAt;
+#endif
         selectedTask->taskLatestDeltaTime = currentTime - selectedTask->lastExecutedAt;
         selectedTask->lastExecutedAt = currentTime;
         selectedTask->dynamicPriority = 0;
 
         // Execute task
         const uint32_t currentTimeBeforeTaskCall = micros();
+        TRACE_BEGIN(TRACE_SECTION_TASK, selectedTask - cfTasks);
         selectedTask->taskFunc();
+        TRACE_END(TRACE_SECTION_TASK, selectedTask - cfTasks);
         const uint32_t taskExecutionTime = micros() - currentTimeBeforeTaskCall;
 
         selectedTask->averageExecutionTime = ((uint32_t)selectedTask->averageExecutionTime * 31 + taskExecutionTime) / 32;
 #ifndef SKIP_TASK_STATISTICS
         selectedTask->totalExecutionTime += taskExecutionTime;   // time consumed by scheduler + task
         selectedTask->maxExecutionTime = MAX(selectedTask->maxExecutionTime, taskExecutionTime);
+
+        cfTaskTimingWindow_t *window = &selectedTask->timingWindow;
+        window->executionCount++;
+        window->totalExecutionTime += taskExecutionTime;
+        window->maxExecutionTime = MAX(window->maxExecutionTime, taskExecutionTime);
+        if (taskLatency > 0) {
+            window->maxLatency = MAX(window->maxLatency, (uint32_t)taskLatency);
+        }
 #endif
 #if defined SCHEDULER_DEBUG
         debug[3] = (micros() - currentTime) - taskExecutionTime;
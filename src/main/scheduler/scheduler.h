@@ -45,6 +45,14 @@ typedef struct {
     uint32_t     latestDeltaTime;
 } cfTaskInfo_t;
 
+// Task statistics since they were last read with getTaskTimingWindow()
+typedef struct {
+    uint16_t     executionCount;
+    uint32_t     totalExecutionTime;
+    uint32_t     maxExecutionTime;
+    uint32_t     maxLatency;        // how late the task ran after its period elapsed or its event was signalled
+} cfTaskTimingWindow_t;
+
 typedef struct {
     /* Configuration */
     const char * taskName;
@@ -65,6 +73,7 @@ typedef struct {
 #ifndef SKIP_TASK_STATISTICS
     uint32_t maxExecutionTime;
     uint32_t totalExecutionTime;    // total time consumed by task since boot
+    cfTaskTimingWindow_t timingWindow;
 #endif
 } cfTask_t;
 
@@ -76,6 +85,7 @@ extern const uint32_t taskCount;
 extern cfTask_t cfTasks[];
 
 void getTaskInfo(const int taskId, cfTaskInfo_t *taskInfo);
+void getTaskTimingWindow(const int taskId, cfTaskTimingWindow_t *window);
 void rescheduleTask(const int taskId, uint32_t newPeriodMicros);
 void setTaskEnabled(const int taskId, bool newEnabledState);
 uint32_t getTaskDeltaTime(const int taskId);
@@ -80,6 +80,9 @@ extern bool AccInflightCalibrationSavetoEEProm;
 extern bool AccInflightCalibrationActive;
 
 static flightDynamicsTrims_t *accelerationTrims;
+static flightDynamicsTrims_t noAccelerationTrims;
+
+static sensorTransform_t accTransform = { .offset = noAccelerationTrims.raw };
 
 void accSetCalibrationCycles(uint16_t calibrationCyclesRequired)
 {
@@ -112,8 +115,8 @@ void performAcclerationCalibration(rollAndPitchTrims_t *rollAndPitchTrims)
         if (isOnFirstAccelerationCalibrationCycle())
             a[axis] = 0;
 
-        // Sum up CALIBRATING_ACC_CYCLES readings
-        a[axis] += accADC[axis];
+        // Sum up CALIBRATING_ACC_CYCLES readings, without the trims that applySensorTransform() took off
+        a[axis] += accADC[axis] + accelerationTrims->raw[axis];
 
         // Reset global variables to prevent other code from using un-calibrated data
         accADC[axis] = 0;
@@ -155,7 +158,7 @@ void performInflightAccelerationCalibration(rollAndPitchTrims_t *rollAndPitchTri
             if (InflightcalibratingA == 50)
                 b[axis] = 0;
             // Sum up 50 readings
-            b[axis] += accADC[axis];
+            b[axis] += accADC[axis] + accelerationTrims->raw[axis];
             // Clear global variables for next reading
             accADC[axis] = 0;
             accelerationTrims->raw[axis] = 0;
@@ -187,20 +190,9 @@ void performInflightAccelerationCalibration(rollAndPitchTrims_t *rollAndPitchTri
     }
 }
 
-void applyAccelerationTrims(flightDynamicsTrims_t *accelerationTrims)
-{
-    accADC[X] -= accelerationTrims->raw[X];
-    accADC[Y] -= accelerationTrims->raw[Y];
-    accADC[Z] -= accelerationTrims->raw[Z];
-}
-
-static void convertRawACCADCReadingsToInternalType(int16_t *accADCRaw)
+void accInitSensorTransform(void)
 {
-    int axis;
-
-    for (axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-        accADC[axis] = accADCRaw[axis];
-    }
+    buildSensorTransform(&accTransform, accAlign, accelerationTrims ? accelerationTrims->raw : noAccelerationTrims.raw);
 }
 
 void updateAccelerationReadings(rollAndPitchTrims_t *rollAndPitchTrims)
@@ -211,9 +203,8 @@ void updateAccelerationReadings(rollAndPitchTrims_t *rollAndPitchTrims)
         return;
     }
 
-    convertRawACCADCReadingsToInternalType(accADCRaw);
-
-    alignSensors(accADC, accADC, accAlign);
+    // rotate into the body frame and apply the trims in one pass
+    applySensorTransform(&accTransform, accADCRaw, accADC);
 
     if (!isAccelerationCalibrationComplete()) {
         performAcclerationCalibration(rollAndPitchTrims);
@@ -222,11 +213,10 @@ void updateAccelerationReadings(rollAndPitchTrims_t *rollAndPitchTrims)
     if (feature(FEATURE_INFLIGHT_ACC_CAL)) {
         performInflightAccelerationCalibration(rollAndPitchTrims);
     }
-
-    applyAccelerationTrims(accelerationTrims);
 }
 
 void setAccelerationTrims(flightDynamicsTrims_t *accelerationTrimsToUse)
 {
     accelerationTrims = accelerationTrimsToUse;
+    accTransform.offset = accelerationTrims->raw;
 }
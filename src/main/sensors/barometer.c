@@ -31,6 +31,7 @@
 #include "config/profile.h"
 
 #include "drivers/barometer.h"
+#include "drivers/bus_i2c.h"
 #include "drivers/system.h"
 
 //#include "fc/config.h"
@@ -42,10 +43,12 @@ uint16_t calibratingB = 0;      // baro calibration = get new ground pressure va
 int32_t baroPressure = 0;
 int32_t baroTemperature = 0;
 int32_t BaroAlt = 0;
+int32_t baroSampleAltitude = 0;
+uint32_t baroSampleTime = 0;
 
 #ifdef BARO
 
-PG_REGISTER_PROFILE_WITH_RESET_TEMPLATE(barometerConfig_t, barometerConfig, PG_BAROMETER_CONFIG, 0);
+PG_REGISTER_PROFILE_WITH_RESET_TEMPLATE(barometerConfig_t, barometerConfig, PG_BAROMETER_CONFIG, 1);
 
 static int32_t baroGroundAltitude = 0;
 static int32_t baroGroundPressure = 0;
@@ -54,8 +57,6 @@ static uint32_t baroPressureSum = 0;
 PG_RESET_TEMPLATE(barometerConfig_t, barometerConfig,
     .baro_sample_count = 21,
     .baro_noise_lpf = 0.6f,
-    .baro_cf_vel = 0.985f,
-    .baro_cf_alt = 0.965f,
 );
 
 
@@ -109,7 +110,7 @@ static uint32_t recalculateBarometerTotal(uint8_t baroSampleCount, uint32_t pres
         nextSampleIndex = 0;
         baroReady = true;
     }
-    barometerSamples[currentSampleIndex] = applyBarometerMedianFilter(newPressureReading);
+    barometerSamples[currentSampleIndex] = newPressureReading;
 
     // recalculate pressure total
     // Note, the pressure total is made up of baroSampleCount - 1 samples - See PRESSURE_SAMPLE_COUNT
@@ -123,17 +124,29 @@ static uint32_t recalculateBarometerTotal(uint8_t baroSampleCount, uint32_t pres
 
 typedef enum {
     BAROMETER_NEEDS_SAMPLES = 0,
-    BAROMETER_NEEDS_CALCULATION
+    BAROMETER_NEEDS_CALCULATION,
+    BAROMETER_NEEDS_RESULT
 } barometerState_e;
 
+// the drivers queue their reads on the I2C bus, the result is calculated when they had time to complete
+#define BAROMETER_READ_DELAY_US 500
+
 
 bool isBaroReady(void) {
 	return baroReady;
 }
 
+// see: https://github.com/diydrones/ardupilot/blob/master/libraries/AP_Baro/AP_Baro.cpp#L140
+static float baroPressureToAltitude(float pressure)
+{
+    return (1.0f - powf(pressure / 101325.0f, 0.190295f)) * 4433000.0f; // in cm
+}
+
 uint32_t baroUpdate(void)
 {
     static barometerState_e state = BAROMETER_NEEDS_SAMPLES;
+    static uint32_t pressureConvertedAt;
+    int32_t pressure;
 
     switch (state) {
         default:
@@ -147,10 +160,25 @@ uint32_t baroUpdate(void)
         case BAROMETER_NEEDS_CALCULATION:
             baro.get_up();
             baro.start_ut();
+            pressureConvertedAt = micros();
+            state = BAROMETER_NEEDS_RESULT;
+            return BAROMETER_READ_DELAY_US;
+        break;
+
+        case BAROMETER_NEEDS_RESULT:
+            i2cQueueCheckTimeout();
+            if (i2cQueueBusy()) {
+                return BAROMETER_READ_DELAY_US;
+            }
             baro.calculate(&baroPressure, &baroTemperature);
-            baroPressureSum = recalculateBarometerTotal(barometerConfig()->baro_sample_count, baroPressureSum, baroPressure);
+            baroSampleTime = pressureConvertedAt - baro.up_delay / 2; // the middle of the pressure conversion
+            pressure = applyBarometerMedianFilter(baroPressure);
+            baroPressureSum = recalculateBarometerTotal(barometerConfig()->baro_sample_count, baroPressureSum, pressure);
+            if (isBaroCalibrationComplete()) {
+                baroSampleAltitude = lrintf(baroPressureToAltitude(pressure)) - baroGroundAltitude;
+            }
             state = BAROMETER_NEEDS_SAMPLES;
-            return baro.ut_delay;
+            return baro.ut_delay > BAROMETER_READ_DELAY_US ? baro.ut_delay - BAROMETER_READ_DELAY_US : baro.ut_delay;
         break;
     }
 }
@@ -160,9 +188,8 @@ int32_t baroCalculateAltitude(void)
     int32_t BaroAlt_tmp;
 
     // calculates height from ground via baro readings
-    // see: https://github.com/diydrones/ardupilot/blob/master/libraries/AP_Baro/AP_Baro.cpp#L140
     if (isBaroCalibrationComplete()) {
-        BaroAlt_tmp = lrintf((1.0f - powf((float)(baroPressureSum / PRESSURE_SAMPLE_COUNT) / 101325.0f, 0.190295f)) * 4433000.0f); // in cm
+        BaroAlt_tmp = lrintf(baroPressureToAltitude(baroPressureSum / PRESSURE_SAMPLE_COUNT));
         BaroAlt_tmp -= baroGroundAltitude;
         BaroAlt = lrintf((float)BaroAlt * barometerConfig()->baro_noise_lpf + (float)BaroAlt_tmp * (1.0f - barometerConfig()->baro_noise_lpf)); // additional LPF to reduce baro noise
     }
@@ -176,7 +203,7 @@ void performBaroCalibrationCycle(void)
 {
     baroGroundPressure -= baroGroundPressure / 8;
     baroGroundPressure += baroPressureSum / PRESSURE_SAMPLE_COUNT;
-    baroGroundAltitude = (1.0f - powf((baroGroundPressure / 8) / 101325.0f, 0.190295f)) * 4433000.0f;
+    baroGroundAltitude = baroPressureToAltitude(baroGroundPressure / 8);
 
     calibratingB--;
 }
@@ -73,11 +73,8 @@ static void alignBoard(int32_t *vec)
 }
 #endif
 
-void alignSensors(int32_t *src, int32_t *dest, uint8_t rotation)
+static void alignSensorOrientation(const int32_t *swap, int32_t *dest, uint8_t rotation)
 {
-    static uint32_t swap[3];
-    memcpy(swap, src, sizeof(swap));
-
     switch (rotation) {
         default:
         case CW0_DEG:
@@ -121,9 +118,52 @@ void alignSensors(int32_t *src, int32_t *dest, uint8_t rotation)
             dest[Z] = -swap[Z];
             break;
     }
+}
+
+void alignSensors(int32_t *src, int32_t *dest, uint8_t rotation)
+{
+    static int32_t swap[3];
+    memcpy(swap, src, sizeof(swap));
+
+    alignSensorOrientation(swap, dest, rotation);
 
 #ifndef SKIP_BOARD_ALIGNMENT
     if (!standardBoardAlignment)
         alignBoard(dest);
 #endif
 }
+
+/*
+ * Folds the sensor orientation and the board alignment into a single Q30 matrix so the
+ * gyro and acc paths can rotate and zero a sample in one pass, see applySensorTransform().
+ */
+void buildSensorTransform(sensorTransform_t *transform, uint8_t rotation, const int16_t *offset)
+{
+    for (int column = 0; column < XYZ_AXIS_COUNT; column++) {
+        int32_t basis[XYZ_AXIS_COUNT] = { 0, 0, 0 };
+        int32_t rotated[XYZ_AXIS_COUNT];
+
+        basis[column] = 1;
+        alignSensorOrientation(basis, rotated, rotation);
+
+        for (int row = 0; row < XYZ_AXIS_COUNT; row++) {
+            float value = rotated[row];
+#ifndef SKIP_BOARD_ALIGNMENT
+            if (!standardBoardAlignment) {
+                value = boardRotation[X][row] * rotated[X] + boardRotation[Y][row] * rotated[Y] + boardRotation[Z][row] * rotated[Z];
+            }
+#endif
+            transform->matrix[row][column] = lrintf(value * SENSOR_TRANSFORM_ONE);
+        }
+    }
+    transform->offset = offset;
+}
+
+void applySensorTransform(const sensorTransform_t *transform, const int16_t *src, int32_t *dest)
+{
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        const int32_t *row = transform->matrix[axis];
+        int64_t sum = (int64_t)row[X] * src[X] + (int64_t)row[Y] * src[Y] + (int64_t)row[Z] * src[Z];
+        dest[axis] = (int32_t)((sum + (SENSOR_TRANSFORM_ONE / 2)) >> SENSOR_TRANSFORM_FRACTION_BITS) - transform->offset[axis];
+    }
+}
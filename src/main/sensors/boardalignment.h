@@ -25,5 +25,16 @@ typedef struct boardAlignment_s {
 
 PG_DECLARE(boardAlignment_t, boardAlignment);
 
+#define SENSOR_TRANSFORM_FRACTION_BITS  30
+#define SENSOR_TRANSFORM_ONE            (1L << SENSOR_TRANSFORM_FRACTION_BITS)
+
+// sensor orientation and board alignment as one matrix, followed by a calibration offset in the body frame
+typedef struct sensorTransform_s {
+    int32_t matrix[3][3];       // Q30
+    const int16_t *offset;      // subtracted after rotation, e.g. gyro zero or acc trims
+} sensorTransform_t;
+
 void alignSensors(int32_t *src, int32_t *dest, uint8_t rotation);
 void initBoardAlignment(void);
+void buildSensorTransform(sensorTransform_t *transform, uint8_t rotation, const int16_t *offset);
+void applySensorTransform(const sensorTransform_t *transform, const int16_t *src, int32_t *dest);
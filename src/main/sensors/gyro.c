@@ -54,7 +54,8 @@ int32_t gyroADC[XYZ_AXIS_COUNT];
 float gyroADCf[XYZ_AXIS_COUNT];
 
 static int16_t gyroADCRaw[XYZ_AXIS_COUNT];
-static int32_t gyroZero[XYZ_AXIS_COUNT] = { 0, 0, 0 };
+static int16_t gyroZero[XYZ_AXIS_COUNT] = { 0, 0, 0 };
+static sensorTransform_t gyroTransform = { .offset = gyroZero };
 
 static uint16_t calibratingG = 0;
 
@@ -111,6 +112,11 @@ void gyroInit(void)
     }
 }
 
+void gyroInitSensorTransform(void)
+{
+    buildSensorTransform(&gyroTransform, gyroAlign, gyroZero);
+}
+
 void gyroSetCalibrationCycles(uint16_t calibrationCyclesRequired)
 {
     calibratingG = calibrationCyclesRequired;
@@ -144,9 +150,10 @@ static void performAcclerationCalibration(uint8_t gyroMovementCalibrationThresho
             devClear(&var[axis]);
         }
 
-        // Sum up CALIBRATING_GYRO_CYCLES readings
-        g[axis] += gyroADC[axis];
-        devPush(&var[axis], gyroADC[axis]);
+        // Sum up CALIBRATING_GYRO_CYCLES readings, without the zero that applySensorTransform() took off
+        const int32_t sample = gyroADC[axis] + gyroZero[axis];
+        g[axis] += sample;
+        devPush(&var[axis], sample);
 
         // Reset global variables to prevent other code from using un-calibrated data
         gyroADC[axis] = 0;
@@ -169,13 +176,6 @@ static void performAcclerationCalibration(uint8_t gyroMovementCalibrationThresho
     calibratingG--;
 }
 
-static void applyGyroZero(void)
-{
-    for (int axis = 0; axis < 3; axis++) {
-        gyroADC[axis] -= gyroZero[axis];
-    }
-}
-
 void gyroUpdate(void)
 {
     // range: +/- 8192; +/- 2000 deg/sec
@@ -183,19 +183,13 @@ void gyroUpdate(void)
         return;
     }
 
-    // Prepare a copy of int32_t gyroADC for mangling to prevent overflow
-    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-        gyroADC[axis] = gyroADCRaw[axis];
-    }
-
-    alignSensors(gyroADC, gyroADC, gyroAlign);
+    // rotate into the body frame and remove the zero offset in one pass, widening to int32_t to prevent overflow
+    applySensorTransform(&gyroTransform, gyroADCRaw, gyroADC);
 
     if (!isGyroCalibrationComplete()) {
         performAcclerationCalibration(gyroConfig()->gyroMovementCalibrationThreshold);
     }
 
-    applyGyroZero();
-
     if (gyroConfig()->gyro_soft_lpf_hz) {
         for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
 
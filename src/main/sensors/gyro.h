@@ -50,6 +50,7 @@ typedef struct gyroConfig_s {
 PG_DECLARE(gyroConfig_t, gyroConfig);
 
 void gyroInit(void);
+void gyroInitSensorTransform(void);
 void gyroUpdate(void);
 void gyroSetCalibrationCycles(uint16_t calibrationCyclesRequired);
 bool isGyroCalibrationComplete(void);
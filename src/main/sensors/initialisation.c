@@ -685,6 +685,9 @@ void reconfigureAlignment(sensorAlignmentConfig_t *sensorAlignmentConfig)
         magAlign = sensorAlignmentConfig->mag_align;
     }
 #endif
+
+    gyroInitSensorTransform();
+    accInitSensorTransform();
 }
 
 bool sensorsAutodetect(void)
@@ -39,13 +39,10 @@
 
 // Sonar measurements are in cm, a value of SONAR_OUT_OF_RANGE indicates sonar is not in range.
 // Inclination is adjusted by imu
-    float baro_cf_vel;                      // apply Complimentary Filter to keep the calculated velocity based on baro velocity (i.e. near real velocity)
-    float baro_cf_alt;                      // apply CF to use ACC for height estimation
 
 #ifdef SONAR
 int16_t sonarMaxRangeCm;
 int16_t sonarMaxAltWithTiltCm;
-int16_t sonarCfAltCm; // Complimentary Filter altitude
 STATIC_UNIT_TESTED int16_t sonarMaxTiltDeciDegrees;
 float sonarMaxTiltCos;
 
@@ -102,7 +99,6 @@ void sonarInit(const sonarHardware_t *sonarHardware)
     hcsr04_init(sonarHardware, &sonarRange);
     sensorsSet(SENSOR_SONAR);
     sonarMaxRangeCm = sonarRange.maxRangeCm;
-    sonarCfAltCm = sonarMaxRangeCm / 2;
     sonarMaxTiltDeciDegrees =  sonarRange.detectionConeExtendedDeciDegrees / 2;
     sonarMaxTiltCos = cos_approx(sonarMaxTiltDeciDegrees / 10.0f * RAD);
     sonarMaxAltWithTiltCm = sonarMaxRangeCm * sonarMaxTiltCos;
@@ -152,6 +148,28 @@ int32_t sonarRead(void)
     return applySonarMedianFilter(distance);
 }
 
+/**
+ * Get the distance of a measurement completed since the last call in centimeters and the time it was taken at in
+ * microseconds. Returns false if there is no new measurement. Unlike sonarRead() no median filter is applied, so
+ * the distance is not delayed by older measurements.
+ */
+bool sonarReadSample(int32_t *distance, uint32_t *timeUs)
+{
+    static uint32_t lastMeasurementTime;
+    const uint32_t measurementTime = hcsr04_get_measurement_time();
+
+    if (measurementTime == lastMeasurementTime) {
+        return false;
+    }
+    lastMeasurementTime = measurementTime;
+
+    *distance = hcsr04_get_distance();
+    if (*distance > HCSR04_MAX_RANGE_CM)
+        *distance = SONAR_OUT_OF_RANGE;
+    *timeUs = measurementTime;
+    return true;
+}
+
 /**
  * Apply tilt correction to the given raw sonar reading in order to compensate for the tilt of the craft when estimating
  * the altitude. Returns the computed altitude in centimeters.
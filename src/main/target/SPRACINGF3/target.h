@@ -162,6 +162,7 @@
 
 #define BLACKBOX
 #define ENABLE_BLACKBOX_LOGGING_ON_SPIFLASH_BY_DEFAULT
+#define USE_BLACKBOX_RING // 8kB of RAM for the triggered blackbox mode
 
 #define DISPLAY
 #define GPS
@@ -180,6 +181,9 @@
 
 #define USE_SERIAL_4WAY_BLHELI_INTERFACE
 
+// motor timers 4, 15, 16 and 17 each have their own update DMA channel
+#define USE_DSHOT
+
 // IO - stm32f303cc in 48pin package
 #define TARGET_IO_PORTA 0xffff
 #define TARGET_IO_PORTB 0xffff
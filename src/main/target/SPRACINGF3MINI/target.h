@@ -153,8 +153,8 @@
 #define SDCARD_SPI_FULL_SPEED_CLOCK_DIVIDER     2
 
 // Note, this is the same DMA channel as USART1_RX. Luckily we don't use DMA for USART Rx.
-#define SDCARD_DMA_CHANNEL_TX               DMA1_Channel5
-#define SDCARD_DMA_CHANNEL_TX_COMPLETE_FLAG DMA1_FLAG_TC5
+#define SPI2_DMA_CHANNEL_TX                 DMA1_Channel5
+#define SPI2_DMA_IRQ_HANDLER_ID             DMA1Channel5Descriptor
 
 // Performance logging for SD card operations:
 // #define AFATFS_USE_INTROSPECTIVE_LOGGING
@@ -219,6 +219,7 @@
 #define GPS
 #define BLACKBOX
 #define ENABLE_BLACKBOX_LOGGING_ON_SDCARD_BY_DEFAULT
+#define USE_BLACKBOX_RING // 8kB of RAM for the triggered blackbox mode
 #define TELEMETRY
 #define TELEMETRY_IBUS
 #define SERIAL_RX
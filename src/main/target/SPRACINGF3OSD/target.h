@@ -46,9 +46,11 @@
 #define MAX7456_CS_PIN         SPI2_CS_PIN
 #define MAX7456_SPI_INSTANCE   SPI2
 
-#define MAX7456_DMA_CHANNEL_TX              DMA1_Channel5
-#define MAX7456_DMA_CHANNEL_RX              DMA1_Channel4
-#define MAX7456_DMA_IRQ_HANDLER_ID          DMA1Channel4Descriptor
+#define USE_MAX7456_DMA
+
+#define SPI2_DMA_CHANNEL_TX                 DMA1_Channel5
+#define SPI2_DMA_CHANNEL_RX                 DMA1_Channel4
+#define SPI2_DMA_IRQ_HANDLER_ID             DMA1Channel4Descriptor
 
 #define MAX7456_NRST_GPIO_PERIPHERAL    RCC_AHBPeriph_GPIOB
 #define MAX7456_NRST_GPIO               GPIOB
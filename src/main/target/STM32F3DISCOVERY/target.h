@@ -96,8 +96,8 @@
 #define SDCARD_SPI_FULL_SPEED_CLOCK_DIVIDER 2
 
 // Note, this is the same DMA channel as USART1_RX. Luckily we don't use DMA for USART Rx.
-#define SDCARD_DMA_CHANNEL_TX               DMA1_Channel5
-#define SDCARD_DMA_CHANNEL_TX_COMPLETE_FLAG DMA1_FLAG_TC5
+#define SPI2_DMA_CHANNEL_TX                 DMA1_Channel5
+#define SPI2_DMA_IRQ_HANDLER_ID             DMA1Channel5Descriptor
 
 // Performance logging for SD card operations:
 // #define AFATFS_USE_INTROSPECTIVE_LOGGING
@@ -29,6 +29,7 @@
 
 #include "common/maths.h"
 #include "common/axis.h"
+#include "common/utils.h"
 
 #include "config/parameter_group.h"
 #include "config/parameter_group_ids.h"
@@ -59,6 +60,8 @@
 #include "flight/altitudehold.h"
 
 #include "telemetry/telemetry.h"
+#include "telemetry/telemetry_data.h"
+#include "telemetry/telemetry_scheduler.h"
 #include "telemetry/frsky.h"
 
 PG_REGISTER(frskyTelemetryConfig_t, frskyTelemetryConfig, PG_FRSKY_TELEMETRY_CONFIG, 0);
@@ -74,8 +77,6 @@ static portSharing_e frskyPortSharing;
 
 extern int16_t telemTemperature1; // FIXME dependency on mw.c
 
-#define CYCLETIME             125
-
 #define PROTOCOL_HEADER       0x5E
 #define PROTOCOL_TAIL         0x5E
 
@@ -123,30 +124,39 @@ extern int16_t telemTemperature1; // FIXME dependency on mw.c
 #define DELAY_FOR_BARO_INITIALISATION (5 * 1000) //5s
 #define BLADE_NUMBER_DIVIDER  5 // should set 12 blades in Taranis
 
-static uint32_t lastCycleTime = 0;
-static uint8_t cycleNum = 0;
+// every item is a header byte, the data id and two data bytes that may each be stuffed to two bytes
+#define FRSKY_ITEM_SIZE_MAX   6
+#define FRSKY_FRAME_SIZE_MAX  48
+
+// Averaged over the fixed schedule this replaced the hub sends some 300 bytes/s; the budget leaves headroom for
+// that while staying well below the 960 bytes/s the 9600 baud line carries.
+#define FRSKY_BYTES_PER_SECOND 480
+
+static telemetryScheduler_t frskyScheduler;
+static uint16_t frskyDeadband3dThrottle;
+
 static void sendDataHead(uint8_t id)
 {
-    serialWrite(frskyPort, PROTOCOL_HEADER);
-    serialWrite(frskyPort, id);
+    telemetryFrameWrite(&frskyScheduler.frame, PROTOCOL_HEADER);
+    telemetryFrameWrite(&frskyScheduler.frame, id);
 }
 
 static void sendTelemetryTail(void)
 {
-    serialWrite(frskyPort, PROTOCOL_TAIL);
+    telemetryFrameWrite(&frskyScheduler.frame, PROTOCOL_TAIL);
 }
 
 static void serializeFrsky(uint8_t data)
 {
     // take care of byte stuffing
     if (data == 0x5e) {
-        serialWrite(frskyPort, 0x5d);
-        serialWrite(frskyPort, 0x3e);
+        telemetryFrameWrite(&frskyScheduler.frame, 0x5d);
+        telemetryFrameWrite(&frskyScheduler.frame, 0x3e);
     } else if (data == 0x5d) {
-        serialWrite(frskyPort, 0x5d);
-        serialWrite(frskyPort, 0x3d);
+        telemetryFrameWrite(&frskyScheduler.frame, 0x5d);
+        telemetryFrameWrite(&frskyScheduler.frame, 0x3d);
     } else
-        serialWrite(frskyPort, data);
+        telemetryFrameWrite(&frskyScheduler.frame, data);
 }
 
 static void serialize16(int16_t a)
@@ -167,16 +177,22 @@ static void sendAccel(void)
 
 static void sendBaro(void)
 {
+    if (millis() < DELAY_FOR_BARO_INITIALISATION) { //Allow 5s to boot correctly
+        return;
+    }
     sendDataHead(ID_ALTITUDE_BP);
-    serialize16(BaroAlt / 100);
+    serialize16(telemetryData.baroAltitude / 100);
     sendDataHead(ID_ALTITUDE_AP);
-    serialize16(ABS(BaroAlt % 100));
+    serialize16(ABS(telemetryData.baroAltitude % 100));
 }
 
 #ifdef GPS
 static void sendGpsAltitude(void)
 {
-    uint16_t altitude = GPS_altitude;
+    if (!sensors(SENSOR_GPS)) {
+        return;
+    }
+    uint16_t altitude = telemetryData.gpsAltitude;
     //Send real GPS altitude only if it's reliable (there's a GPS fix)
     if (!STATE(GPS_FIX)) {
         altitude = 0;
@@ -188,12 +204,12 @@ static void sendGpsAltitude(void)
 }
 #endif
 
-static void sendThrottleOrBatterySizeAsRpm(uint16_t deadband3d_throttle)
+static void sendThrottleOrBatterySizeAsRpm(void)
 {
     uint16_t throttleForRPM = rcCommand[THROTTLE] / BLADE_NUMBER_DIVIDER;
     sendDataHead(ID_RPM);
     if (ARMING_FLAG(ARMED)) {
-        throttleStatus_e throttleStatus = calculateThrottleStatus(rxConfig(), deadband3d_throttle);
+        throttleStatus_e throttleStatus = calculateThrottleStatus(rxConfig(), frskyDeadband3dThrottle);
         if (throttleStatus == THROTTLE_LOW && feature(FEATURE_MOTOR_STOP))
                     throttleForRPM = 0;
         serialize16(throttleForRPM);
@@ -216,9 +232,12 @@ static void sendTemperature1(void)
 #ifdef GPS
 static void sendSatalliteSignalQualityAsTemperature2(void)
 {
-    uint16_t satellite = GPS_numSat;
-    if (GPS_hdop > GPS_BAD_QUALITY && ( (cycleNum % 16 ) < 8)) {//Every 1s
-        satellite = constrain(GPS_hdop, 0, GPS_MAX_HDOP_VAL);
+    if (!sensors(SENSOR_GPS)) {
+        return;
+    }
+    uint16_t satellite = telemetryData.gpsNumSat;
+    if (telemetryData.gpsHdop > GPS_BAD_QUALITY && (millis() % 2000) < 1000) { //Alternate every 1s
+        satellite = constrain(telemetryData.gpsHdop, 0, GPS_MAX_HDOP_VAL);
     }
     sendDataHead(ID_TEMPRATURE2);
 
@@ -234,15 +253,15 @@ static void sendSatalliteSignalQualityAsTemperature2(void)
 
 static void sendSpeed(void)
 {
-    if (!STATE(GPS_FIX)) {
+    if (!sensors(SENSOR_GPS) || !STATE(GPS_FIX)) {
         return;
     }
     //Speed should be sent in knots (GPS speed is in cm/s)
     sendDataHead(ID_GPS_SPEED_BP);
     //convert to knots: 1cm/s = 0.0194384449 knots
-    serialize16(GPS_speed * 1944 / 100000);
+    serialize16(telemetryData.gpsSpeed * 1944 / 100000);
     sendDataHead(ID_GPS_SPEED_AP);
-    serialize16((GPS_speed * 1944 / 100) % 100);
+    serialize16((telemetryData.gpsSpeed * 1944 / 100) % 100);
 }
 #endif
 
@@ -259,44 +278,31 @@ static void sendTime(void)
 }
 
 // Frsky pdf: dddmm.mmmm
-// .mmmm is returned in decimal fraction of minutes.
-static void GPStoDDDMM_MMMM(int32_t mwiigps, gpsCoordinateDDDMMmmmm_t *result)
+static void sendLatLongDDDMMmmmm(const int32_t coord[2], const gpsCoordinateDDDMMmmmm_t coordinate[2])
 {
-    int32_t absgps, deg, min;
-    absgps = ABS(mwiigps);
-    deg    = absgps / GPS_DEGREES_DIVIDER;
-    absgps = (absgps - deg * GPS_DEGREES_DIVIDER) * 60;        // absgps = Minutes left * 10^7
-    min    = absgps / GPS_DEGREES_DIVIDER;                     // minutes left
-
-    if (frskyTelemetryConfig()->frsky_coordinate_format == FRSKY_FORMAT_DMS) {
-        result->dddmm = deg * 100 + min;
-    } else {
-        result->dddmm = deg * 60 + min;
-    }
-
-    result->mmmm  = (absgps - min * GPS_DEGREES_DIVIDER) / 1000;
-}
-
-static void sendLatLong(int32_t coord[2])
-{
-    gpsCoordinateDDDMMmmmm_t coordinate;
-    GPStoDDDMM_MMMM(coord[LAT], &coordinate);
     sendDataHead(ID_LATITUDE_BP);
-    serialize16(coordinate.dddmm);
+    serialize16(coordinate[LAT].dddmm);
     sendDataHead(ID_LATITUDE_AP);
-    serialize16(coordinate.mmmm);
+    serialize16(coordinate[LAT].mmmm);
     sendDataHead(ID_N_S);
     serialize16(coord[LAT] < 0 ? 'S' : 'N');
 
-    GPStoDDDMM_MMMM(coord[LON], &coordinate);
     sendDataHead(ID_LONGITUDE_BP);
-    serialize16(coordinate.dddmm);
+    serialize16(coordinate[LON].dddmm);
     sendDataHead(ID_LONGITUDE_AP);
-    serialize16(coordinate.mmmm);
+    serialize16(coordinate[LON].mmmm);
     sendDataHead(ID_E_W);
     serialize16(coord[LON] < 0 ? 'W' : 'E');
 }
 
+static void sendLatLong(int32_t coord[2])
+{
+    gpsCoordinateDDDMMmmmm_t coordinate[2];
+    telemetryCoordinateToDDDMMmmmm(coord[LAT], frskyTelemetryConfig()->frsky_coordinate_format, &coordinate[LAT]);
+    telemetryCoordinateToDDDMMmmmm(coord[LON], frskyTelemetryConfig()->frsky_coordinate_format, &coordinate[LON]);
+    sendLatLongDDDMMmmmm(coord, coordinate);
+}
+
 #ifdef GPS
 static void sendFakeLatLong(void)
 {
@@ -329,7 +335,7 @@ static void sendGPSLatLong(void)
     if (STATE(GPS_FIX) || gpsFixOccured == 1) {
         // If we have ever had a fix, send the last known lat/long
         gpsFixOccured = 1;
-        sendLatLong(GPS_coord);
+        sendLatLongDDDMMmmmm(telemetryData.gpsCoord, telemetryDataGetCoordinateDDDMMmmmm(frskyTelemetryConfig()->frsky_coordinate_format));
     } else {
         // otherwise send fake lat/long in order to display compass value
         sendFakeLatLong();
@@ -337,6 +343,17 @@ static void sendGPSLatLong(void)
 }
 #endif
 
+static void sendPosition(void)
+{
+#ifdef GPS
+    if (sensors(SENSOR_GPS)) {
+        sendGPSLatLong();
+        return;
+    }
+#endif
+    sendFakeLatLongThatAllowsHeadingDisplay();
+}
+
 /*
  * Send vertical speed for opentx. ID_VERT_SPEED
  * Unit is cm/s
@@ -344,18 +361,18 @@ static void sendGPSLatLong(void)
 static void sendVario(void)
 {
     sendDataHead(ID_VERT_SPEED);
-    serialize16(vario);
+    serialize16(telemetryData.vario);
 }
 
 /*
  * Send voltage via ID_VOLT
  *
- * NOTE: This sends voltage divided by batteryCellCount. To get the real
- * battery voltage, you need to multiply the value by batteryCellCount.
+ * NOTE: This sends voltage divided by the cell count. To get the real
+ * battery voltage, you need to multiply the value by the cell count.
  */
 static void sendVoltage(void)
 {
-    if (!telemetryConfig()->telemetry_send_cells) {
+    if (!feature(FEATURE_VBAT) || !telemetryConfig()->telemetry_send_cells) {
         return;
     }
     static uint16_t currentCell = 0;
@@ -373,7 +390,7 @@ static void sendVoltage(void)
      * The actual value sent for cell voltage has resolution of 0.002 volts
      * Since vbat has resolution of 0.1 volts it has to be multiplied by 50
      */
-    cellVoltage = ((uint32_t)vbat * 100 + batteryCellCount) / (batteryCellCount * 2);
+    cellVoltage = telemetryData.cellVoltageFlvss;
 
     // Cell number is at bit 9-12
     payload = (currentCell << 4);
@@ -388,7 +405,7 @@ static void sendVoltage(void)
     serialize16(payload);
 
     currentCell++;
-    currentCell %= batteryCellCount;
+    currentCell %= telemetryData.cellCount;
 }
 
 /*
@@ -396,14 +413,17 @@ static void sendVoltage(void)
  */
 static void sendVoltageAmp(void)
 {
+    if (!feature(FEATURE_VBAT)) {
+        return;
+    }
     if (frskyTelemetryConfig()->frsky_vfas_precision == FRSKY_VFAS_PRECISION_HIGH) {
         /*
          * Use new ID 0x39 to send voltage directly in 0.1 volts resolution
          */
         sendDataHead(ID_VOLTAGE_AMP);
-        serialize16(vbat);
+        serialize16(telemetryData.vbat);
     } else {
-        uint16_t voltage = (vbat * 110) / 21;
+        uint16_t voltage = (telemetryData.vbat * 110) / 21;
 
         sendDataHead(ID_VOLTAGE_AMP_BP);
         serialize16(voltage / 100);
@@ -414,33 +434,63 @@ static void sendVoltageAmp(void)
 
 static void sendAmperage(void)
 {
-    amperageMeter_t *state = getAmperageMeter(batteryConfig()->amperageMeterSource);
-
+    if (!feature(FEATURE_VBAT)) {
+        return;
+    }
     sendDataHead(ID_CURRENT);
-    serialize16((uint16_t)(state->amperage / 10));
+    serialize16((uint16_t)(telemetryData.amperage / 10));
 }
 
 static void sendFuelLevel(void)
 {
-
+    if (!feature(FEATURE_VBAT)) {
+        return;
+    }
     sendDataHead(ID_FUEL_LEVEL);
 
     if (batteryConfig()->batteryCapacity > 0) {
-        serialize16((uint16_t)batteryCapacityRemainingPercentage());
+        serialize16((uint16_t)telemetryData.capacityRemaining);
     } else {
-        amperageMeter_t *state = getAmperageMeter(batteryConfig()->amperageMeterSource);
-        serialize16((uint16_t)constrain(state->mAhDrawn, 0, 0xFFFF));
+        serialize16((uint16_t)constrain(telemetryData.mAhDrawn, 0, 0xFFFF));
     }
 }
 
 static void sendHeading(void)
 {
     sendDataHead(ID_COURSE_BP);
-    serialize16(DECIDEGREES_TO_DEGREES(attitude.values.yaw));
+    serialize16(DECIDEGREES_TO_DEGREES(telemetryData.attitude.values.yaw));
     sendDataHead(ID_COURSE_AP);
     serialize16(0);
 }
 
+// Battery first, then the fast flight data, then the rest
+static const telemetrySlot_t frskySlots[] = {
+    { sendVoltageAmp,                            1000, 0, 2 * FRSKY_ITEM_SIZE_MAX },
+    { sendVoltage,                               1000, 0, FRSKY_ITEM_SIZE_MAX },
+    { sendAmperage,                              1000, 1, FRSKY_ITEM_SIZE_MAX },
+    { sendFuelLevel,                             1000, 1, FRSKY_ITEM_SIZE_MAX },
+    { sendVario,                                  125, 1, FRSKY_ITEM_SIZE_MAX },
+    { sendAccel,                                  125, 2, 3 * FRSKY_ITEM_SIZE_MAX },
+    { sendHeading,                                500, 2, 2 * FRSKY_ITEM_SIZE_MAX },
+    { sendBaro,                                   500, 2, 2 * FRSKY_ITEM_SIZE_MAX },
+    { sendThrottleOrBatterySizeAsRpm,            1000, 3, FRSKY_ITEM_SIZE_MAX },
+    { sendTemperature1,                          1000, 3, FRSKY_ITEM_SIZE_MAX },
+#ifdef GPS
+    { sendSpeed,                                 1000, 3, 2 * FRSKY_ITEM_SIZE_MAX },
+    { sendGpsAltitude,                           1000, 3, 2 * FRSKY_ITEM_SIZE_MAX },
+    { sendSatalliteSignalQualityAsTemperature2,  1000, 3, FRSKY_ITEM_SIZE_MAX },
+#endif
+    { sendPosition,                              1000, 3, 6 * FRSKY_ITEM_SIZE_MAX },
+    { sendTime,                                  5000, 4, 2 * FRSKY_ITEM_SIZE_MAX },
+};
+
+static const telemetryLink_t frskyLink = {
+    .bytesPerSecond = FRSKY_BYTES_PER_SECOND,
+    .maxFrameSize = FRSKY_FRAME_SIZE_MAX,
+    .trailerSize = 1,
+    .writeTrailer = sendTelemetryTail,
+};
+
 void initFrSkyTelemetry(void)
 {
     portConfig = findSerialPortConfig(FUNCTION_TELEMETRY_FRSKY);
@@ -465,12 +515,9 @@ void configureFrSkyTelemetryPort(void)
         return;
     }
 
-    frskyTelemetryEnabled = true;
-}
+    telemetrySchedulerInit(&frskyScheduler, &frskyLink, frskySlots, ARRAYLEN(frskySlots), millis());
 
-bool hasEnoughTimeLapsedSinceLastTelemetryTransmission(uint32_t currentMillis)
-{
-    return currentMillis - lastCycleTime >= CYCLETIME;
+    frskyTelemetryEnabled = true;
 }
 
 bool checkFrSkyTelemetryState(void)
@@ -495,62 +542,9 @@ void handleFrSkyTelemetry(uint16_t deadband3d_throttle)
         return;
     }
 
-    uint32_t now = millis();
+    frskyDeadband3dThrottle = deadband3d_throttle;
 
-    if (!hasEnoughTimeLapsedSinceLastTelemetryTransmission(now)) {
-        return;
-    }
-
-    lastCycleTime = now;
-
-    cycleNum++;
-
-    // Sent every 125ms
-    sendAccel();
-    sendVario();
-    sendTelemetryTail();
-
-    if ((cycleNum % 4) == 0) {      // Sent every 500ms
-        if (lastCycleTime > DELAY_FOR_BARO_INITIALISATION) { //Allow 5s to boot correctly
-            sendBaro();
-        }
-        sendHeading();
-        sendTelemetryTail();
-    }
-
-    if ((cycleNum % 8) == 0) {      // Sent every 1s
-        sendTemperature1();
-        sendThrottleOrBatterySizeAsRpm(deadband3d_throttle);
-
-        if (feature(FEATURE_VBAT)) {
-            sendVoltage();
-            sendVoltageAmp();
-            sendAmperage();
-            sendFuelLevel();
-        }
-
-#ifdef GPS
-        if (sensors(SENSOR_GPS)) {
-            sendSpeed();
-            sendGpsAltitude();
-            sendSatalliteSignalQualityAsTemperature2();
-            sendGPSLatLong();
-        }
-        else {
-            sendFakeLatLongThatAllowsHeadingDisplay();
-        }
-#else
-        sendFakeLatLongThatAllowsHeadingDisplay();
-#endif
-
-        sendTelemetryTail();
-    }
-
-    if (cycleNum == 40) {     //Frame 3: Sent every 5s
-        cycleNum = 0;
-        sendTime();
-        sendTelemetryTail();
-    }
+    telemetrySchedulerProcess(&frskyScheduler, frskyPort, millis());
 }
 
 #endif
@@ -63,11 +63,14 @@
 #ifdef TELEMETRY
 
 #include "common/axis.h"
+#include "common/maths.h"
 
 #include "config/parameter_group.h"
 #include "config/parameter_group_ids.h"
 
 #include "drivers/system.h"
+#include "drivers/sensor.h"
+#include "drivers/accgyro.h"
 
 #include "fc/fc_serial.h"
 #include "fc/runtime_config.h"
@@ -77,14 +80,17 @@
 
 
 #include "sensors/sensors.h"
+#include "sensors/acceleration.h"
 #include "../sensors/amperage.h"
 #include "sensors/battery.h"
 
 #include "flight/pid.h"
+#include "flight/imu.h"
 #include "flight/navigation.h"
 #include "io/gps.h"
 
 #include "telemetry/telemetry.h"
+#include "telemetry/telemetry_data.h"
 #include "telemetry/hott.h"
 
 //#define HOTT_DEBUG
@@ -189,30 +195,30 @@ void addGPSCoordinates(HOTT_GPS_MSG_t *hottGPSMessage, int32_t latitude, int32_t
 
 void hottPrepareGPSResponse(HOTT_GPS_MSG_t *hottGPSMessage)
 {
-    hottGPSMessage->gps_satelites = GPS_numSat;
+    hottGPSMessage->gps_satelites = telemetryData.gpsNumSat;
 
     if (!STATE(GPS_FIX)) {
         hottGPSMessage->gps_fix_char = GPS_FIX_CHAR_NONE;
         return;
     }
 
-    if (GPS_numSat >= 5) {
+    if (telemetryData.gpsNumSat >= 5) {
         hottGPSMessage->gps_fix_char = GPS_FIX_CHAR_3D;
     } else {
         hottGPSMessage->gps_fix_char = GPS_FIX_CHAR_2D;
     }
 
-    addGPSCoordinates(hottGPSMessage, GPS_coord[LAT], GPS_coord[LON]);
+    addGPSCoordinates(hottGPSMessage, telemetryData.gpsCoord[LAT], telemetryData.gpsCoord[LON]);
 
     // GPS Speed is returned in cm/s (from io/gps.c) and must be sent in km/h (Hott requirement)
-    uint16_t speed = (GPS_speed * 36) / 1000;
+    uint16_t speed = (telemetryData.gpsSpeed * 36) / 1000;
     hottGPSMessage->gps_speed_L = speed & 0x00FF;
     hottGPSMessage->gps_speed_H = speed >> 8;
 
     hottGPSMessage->home_distance_L = GPS_distanceToHome & 0x00FF;
     hottGPSMessage->home_distance_H = GPS_distanceToHome >> 8;
 
-    uint16_t hottGpsAltitude = GPS_altitude + HOTT_GPS_ALTITUDE_OFFSET;   // GPS_altitude in m ; offset = 500 -> O m
+    uint16_t hottGpsAltitude = telemetryData.gpsAltitude + HOTT_GPS_ALTITUDE_OFFSET;   // GPS_altitude in m ; offset = 500 -> O m
 
     hottGPSMessage->altitude_L = hottGpsAltitude & 0x00FF;
     hottGPSMessage->altitude_H = hottGpsAltitude >> 8;
@@ -246,28 +252,24 @@ static inline void updateAlarmBatteryStatus(HOTT_EAM_MSG_t *hottEAMMessage)
 
 static inline void hottEAMUpdateBattery(HOTT_EAM_MSG_t *hottEAMMessage)
 {
-    hottEAMMessage->main_voltage_L = vbat & 0xFF;
-    hottEAMMessage->main_voltage_H = vbat >> 8;
-    hottEAMMessage->batt1_voltage_L = vbat & 0xFF;
-    hottEAMMessage->batt1_voltage_H = vbat >> 8;
+    hottEAMMessage->main_voltage_L = telemetryData.vbat & 0xFF;
+    hottEAMMessage->main_voltage_H = telemetryData.vbat >> 8;
+    hottEAMMessage->batt1_voltage_L = telemetryData.vbat & 0xFF;
+    hottEAMMessage->batt1_voltage_H = telemetryData.vbat >> 8;
 
     updateAlarmBatteryStatus(hottEAMMessage);
 }
 
 static inline void hottEAMUpdateCurrentMeter(HOTT_EAM_MSG_t *hottEAMMessage)
 {
-    amperageMeter_t *state = getAmperageMeter(batteryConfig()->amperageMeterSource);
-
-    int32_t amp = state->amperage / 10;
+    int32_t amp = telemetryData.amperage / 10;
     hottEAMMessage->current_L = amp & 0xFF;
     hottEAMMessage->current_H = amp >> 8;
 }
 
 static inline void hottEAMUpdateBatteryDrawnCapacity(HOTT_EAM_MSG_t *hottEAMMessage)
 {
-    amperageMeter_t *state = getAmperageMeter(batteryConfig()->amperageMeterSource);
-
-    int32_t mAh = state->mAhDrawn / 10;
+    int32_t mAh = telemetryData.mAhDrawn / 10;
     hottEAMMessage->batt_cap_L = mAh & 0xFF;
     hottEAMMessage->batt_cap_H = mAh >> 8;
 }
@@ -36,6 +36,7 @@
 #include "config/parameter_group_ids.h"
 
 #include "common/axis.h"
+#include "common/maths.h"
 
 #include "drivers/system.h"
 #include "drivers/sensor.h"
@@ -47,12 +48,16 @@
 #include "sensors/battery.h"
 #include "sensors/barometer.h"
 
+#include "flight/imu.h"
+
 #include "io/serial.h"
+#include "io/gps.h"
 #include "fc/rc_controls.h"
 #include "fc/cleanflight_fc.h"
 
 
 #include "telemetry/telemetry.h"    
+#include "telemetry/telemetry_data.h"
 #include "telemetry/ibus.h"
 
 #include "scheduler/scheduler.h"
@@ -292,9 +297,10 @@ static void dispatchMeasurementReply(ibusAddress_t address)
     
     switch (sensorAddressTypeLookup[address - ibusBaseAddress]) {
     case IBUS_SENSOR_TYPE_EXTERNAL_VOLTAGE:
-        value = vbat * 10;
         if (ibusTelemetryConfig()->report_cell_voltage) {
-            value /= batteryCellCount;
+            value = telemetryData.cellVoltage;
+        } else {
+            value = telemetryData.vbat * 10;
         }
         sendIbusMeasurement(address, value);
         break;
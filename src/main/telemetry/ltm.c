@@ -39,6 +39,7 @@
 
 #include "common/maths.h"
 #include "common/axis.h"
+#include "common/utils.h"
 
 #include "config/parameter_group.h"
 
@@ -64,31 +65,33 @@
 #include "flight/navigation.h"
 
 #include "telemetry/telemetry.h"
+#include "telemetry/telemetry_scheduler.h"
+#include "telemetry/telemetry_data.h"
 #include "telemetry/ltm.h"
 
 #include "fc/runtime_config.h"
 
 #define TELEMETRY_LTM_INITIAL_PORT_MODE MODE_TX
-#define LTM_CYCLETIME   100
+#define LTM_FRAME_SIZE_MAX  40
 
-extern uint16_t rssi;           // FIXME dependency on mw.c
 static serialPort_t *ltmPort;
 static serialPortConfig_t *portConfig;
 static bool ltmEnabled;
 static portSharing_e ltmPortSharing;
 static uint8_t ltm_crc;
+static telemetryScheduler_t ltmScheduler;
 
 static void ltm_initialise_packet(uint8_t ltm_id)
 {
     ltm_crc = 0;
-    serialWrite(ltmPort, '$');
-    serialWrite(ltmPort, 'T');
-    serialWrite(ltmPort, ltm_id);
+    telemetryFrameWrite(&ltmScheduler.frame, '$');
+    telemetryFrameWrite(&ltmScheduler.frame, 'T');
+    telemetryFrameWrite(&ltmScheduler.frame, ltm_id);
 }
 
 static void ltm_serialise_8(uint8_t v)
 {
-    serialWrite(ltmPort, v);
+    telemetryFrameWrite(&ltmScheduler.frame, v);
     ltm_crc ^= v;
 }
 
@@ -108,7 +111,7 @@ static void ltm_serialise_32(uint32_t v)
 
 static void ltm_finalise(void)
 {
-    serialWrite(ltmPort, ltm_crc);
+    telemetryFrameWrite(&ltmScheduler.frame, ltm_crc);
 }
 
 /*
@@ -126,23 +129,23 @@ static void ltm_gframe(void)
 
     if (!STATE(GPS_FIX))
         gps_fix_type = 1;
-    else if (GPS_numSat < 5)
+    else if (telemetryData.gpsNumSat < 5)
         gps_fix_type = 2;
     else
         gps_fix_type = 3;
 
     ltm_initialise_packet('G');
-    ltm_serialise_32(GPS_coord[LAT]);
-    ltm_serialise_32(GPS_coord[LON]);
-    ltm_serialise_8((uint8_t)(GPS_speed / 100));
+    ltm_serialise_32(telemetryData.gpsCoord[LAT]);
+    ltm_serialise_32(telemetryData.gpsCoord[LON]);
+    ltm_serialise_8((uint8_t)(telemetryData.gpsSpeed / 100));
 
 #if defined(BARO) || defined(SONAR)
-    ltm_alt = (sensors(SENSOR_SONAR) || sensors(SENSOR_BARO)) ? altitudeHoldGetEstimatedAltitude() : GPS_altitude * 100;
+    ltm_alt = (sensors(SENSOR_SONAR) || sensors(SENSOR_BARO)) ? altitudeHoldGetEstimatedAltitude() : telemetryData.gpsAltitude * 100;
 #else
-    ltm_alt = GPS_altitude * 100;
+    ltm_alt = telemetryData.gpsAltitude * 100;
 #endif
     ltm_serialise_32(ltm_alt);
-    ltm_serialise_8((GPS_numSat << 2) | gps_fix_type);
+    ltm_serialise_8((telemetryData.gpsNumSat << 2) | gps_fix_type);
     ltm_finalise();
 #endif
 }
@@ -183,9 +186,9 @@ static void ltm_sframe(void)
     if (failsafeIsActive())
         lt_statemode |= 2;
     ltm_initialise_packet('S');
-    ltm_serialise_16(vbat * 100);    //vbat converted to mv
+    ltm_serialise_16(telemetryData.vbat * 100);    //vbat converted to mv
     ltm_serialise_16(0);             //  current, not implemented
-    ltm_serialise_8((uint8_t)((rssi * 254) / 1023));        // scaled RSSI (uchar)
+    ltm_serialise_8((uint8_t)((telemetryData.rssi * 254) / 1023));        // scaled RSSI (uchar)
     ltm_serialise_8(0);              // no airspeed
     ltm_serialise_8((lt_flightmode << 2) | lt_statemode);
     ltm_finalise();
@@ -195,12 +198,12 @@ static void ltm_sframe(void)
  * Attitude A-frame - 10 Hz at > 2400 baud
  *  PITCH ROLL HEADING
  */
-static void ltm_aframe()
+static void ltm_aframe(void)
 {
     ltm_initialise_packet('A');
-    ltm_serialise_16(DECIDEGREES_TO_DEGREES(attitude.values.pitch));
-    ltm_serialise_16(DECIDEGREES_TO_DEGREES(attitude.values.roll));
-    ltm_serialise_16(DECIDEGREES_TO_DEGREES(attitude.values.yaw));
+    ltm_serialise_16(DECIDEGREES_TO_DEGREES(telemetryData.attitude.values.pitch));
+    ltm_serialise_16(DECIDEGREES_TO_DEGREES(telemetryData.attitude.values.roll));
+    ltm_serialise_16(DECIDEGREES_TO_DEGREES(telemetryData.attitude.values.yaw));
     ltm_finalise();
 }
 
@@ -209,7 +212,7 @@ static void ltm_aframe()
  *  This frame will be ignored by Ghettostation, but processed by GhettOSD if it is used as standalone onboard OSD
  *  home pos, home alt, direction to home
  */
-static void ltm_oframe()
+static void ltm_oframe(void)
 {
     ltm_initialise_packet('O');
 #if defined(GPS)
@@ -225,33 +228,21 @@ static void ltm_oframe()
     ltm_finalise();
 }
 
-static void process_ltm(void)
-{
-    static uint8_t ltm_scheduler;
-    ltm_aframe();
-    if (ltm_scheduler & 1)
-        ltm_gframe();
-    else
-        ltm_sframe();
-    if (ltm_scheduler == 0)
-        ltm_oframe();
-    ltm_scheduler++;
-    ltm_scheduler %= 10;
-}
+// frame sizes are the '$', 'T', id header, the payload and the checksum
+static const telemetrySlot_t ltmSlots[] = {
+    { ltm_sframe, 200,  0, 3 + 7 + 1 },
+    { ltm_aframe, 100,  1, 3 + 6 + 1 },
+    { ltm_gframe, 200,  1, 3 + 14 + 1 },
+    { ltm_oframe, 1000, 2, 3 + 14 + 1 },
+};
 
 void handleLtmTelemetry(void)
 {
-    static uint32_t ltm_lastCycleTime;
-    uint32_t now;
     if (!ltmEnabled)
         return;
     if (!ltmPort)
         return;
-    now = millis();
-    if ((now - ltm_lastCycleTime) >= LTM_CYCLETIME) {
-        process_ltm();
-        ltm_lastCycleTime = now;
-    }
+    telemetrySchedulerProcess(&ltmScheduler, ltmPort, millis());
 }
 
 void freeLtmTelemetryPort(void)
@@ -279,6 +270,14 @@ void configureLtmTelemetryPort(void)
     ltmPort = openSerialPort(portConfig->identifier, FUNCTION_TELEMETRY_LTM, NULL, baudRates[baudRateIndex], TELEMETRY_LTM_INITIAL_PORT_MODE, SERIAL_NOT_INVERTED);
     if (!ltmPort)
         return;
+
+    // one start and one stop bit per byte
+    const telemetryLink_t ltmLink = {
+        .bytesPerSecond = baudRates[baudRateIndex] / 10,
+        .maxFrameSize = LTM_FRAME_SIZE_MAX,
+    };
+    telemetrySchedulerInit(&ltmScheduler, &ltmLink, ltmSlots, ARRAYLEN(ltmSlots), millis());
+
     ltmEnabled = true;
 }
 
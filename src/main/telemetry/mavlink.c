@@ -74,6 +74,7 @@
 
 #include "telemetry/telemetry.h"
 #include "telemetry/mavlink.h"
+#include "telemetry/telemetry_data.h"
 
 #include "common/mavlink.h"
 
@@ -213,8 +214,6 @@ void mavlinkSendSystemStatus(void)
     if (sensors(SENSOR_BARO)) onboardControlAndSensors |=  8200;
     if (sensors(SENSOR_GPS))  onboardControlAndSensors |= 16416;
 
-    amperageMeter_t *amperageMeter = getAmperageMeter(batteryConfig()->amperageMeterSource);
-    
     mavlink_msg_sys_status_pack(0, 200, &mavMsg,
         // onboard_control_sensors_present Bitmask showing which onboard controllers and sensors are present. 
         //Value of 0: not present. Value of 1: present. Indices: 0: 3D gyro, 1: 3D acc, 2: 3D mag, 3: absolute pressure, 
@@ -229,9 +228,9 @@ void mavlinkSendSystemStatus(void)
         // load Maximum usage in percent of the mainloop time, (0%: 0, 100%: 1000) should be always below 1000
         0,
         // voltage_battery Battery voltage, in millivolts (1 = 1 millivolt)
-        feature(FEATURE_VBAT) ? vbat * 100 : 0,
+        feature(FEATURE_VBAT) ? telemetryData.vbat * 100 : 0,
         // current_battery Battery amperage, in 10*milliamperes (1 = 10 milliampere), -1: autopilot does not measure the current
-        feature(FEATURE_AMPERAGE_METER) ? amperageMeter->amperage : -1,
+        feature(FEATURE_AMPERAGE_METER) ? telemetryData.amperage : -1,
         // battery_remaining Remaining battery energy: (0%: 0, 100%: 100), -1: autopilot estimate the remaining battery
         feature(FEATURE_VBAT) ? batteryVoltagePercentage() : 100,
         // drop_rate_comm Communication drops in percent, (0%: 0, 100%: 10'000), (UART, I2C, SPI, CAN), dropped packets on all links (packets that were corrupted on reception on the MAV)
@@ -275,7 +274,7 @@ void mavlinkSendRCChannelsAndRSSI(void)
         // chan8_raw RC channel 8 value, in microseconds
         (rxRuntimeConfig.channelCount >= 8) ? rcData[7] : 0,
         // rssi Receive signal strength indicator, 0: 0%, 255: 100%
-        scaleRange(rssi, 0, 1023, 0, 255));
+        scaleRange(telemetryData.rssi, 0, 1023, 0, 255));
     msgLength = mavlink_msg_to_send_buffer(mavBuffer, &mavMsg);
     mavlinkSerialWrite(mavBuffer, msgLength);
 }
@@ -293,7 +292,7 @@ void mavlinkSendPosition(void)
         gpsFixType = 1;
     }
     else {
-        if (GPS_numSat < 5) {
+        if (telemetryData.gpsNumSat < 5) {
             gpsFixType = 2;
         }
         else {
@@ -307,21 +306,21 @@ void mavlinkSendPosition(void)
         // fix_type 0-1: no fix, 2: 2D fix, 3: 3D fix. Some applications will not use the value of this field unless it is at least two, so always correctly fill in the fix.
         gpsFixType,
         // lat Latitude in 1E7 degrees
-        GPS_coord[LAT],
+        telemetryData.gpsCoord[LAT],
         // lon Longitude in 1E7 degrees
-        GPS_coord[LON],
+        telemetryData.gpsCoord[LON],
         // alt Altitude in 1E3 meters (millimeters) above MSL
-        GPS_altitude * 1000,
+        telemetryData.gpsAltitude * 1000,
         // eph GPS HDOP horizontal dilution of position in cm (m*100). If unknown, set to: 65535
         65535,
         // epv GPS VDOP horizontal dilution of position in cm (m*100). If unknown, set to: 65535
         65535,
         // vel GPS ground speed (m/s * 100). If unknown, set to: 65535
-        GPS_speed,
+        telemetryData.gpsSpeed,
         // cog Course over ground (NOT heading, but direction of movement) in degrees * 100, 0.0..359.99 degrees. If unknown, set to: 65535
         GPS_ground_course * 10,
         // satellites_visible Number of satellites visible. If unknown, set to 255
-        GPS_numSat);
+        telemetryData.gpsNumSat);
     msgLength = mavlink_msg_to_send_buffer(mavBuffer, &mavMsg);
     mavlinkSerialWrite(mavBuffer, msgLength);
 
@@ -330,16 +329,16 @@ void mavlinkSendPosition(void)
         // time_usec Timestamp (microseconds since UNIX epoch or microseconds since system boot)
         micros(),
         // lat Latitude in 1E7 degrees
-        GPS_coord[LAT],
+        telemetryData.gpsCoord[LAT],
         // lon Longitude in 1E7 degrees
-        GPS_coord[LON],
+        telemetryData.gpsCoord[LON],
         // alt Altitude in 1E3 meters (millimeters) above MSL
-        GPS_altitude * 1000,
+        telemetryData.gpsAltitude * 1000,
         // relative_alt Altitude above ground in meters, expressed as * 1000 (millimeters)
 #if defined(BARO) || defined(SONAR)
-        (sensors(SENSOR_SONAR) || sensors(SENSOR_BARO)) ? altitudeHoldGetEstimatedAltitude() * 10 : GPS_altitude * 1000,
+        (sensors(SENSOR_SONAR) || sensors(SENSOR_BARO)) ? altitudeHoldGetEstimatedAltitude() * 10 : telemetryData.gpsAltitude * 1000,
 #else
-        GPS_altitude * 1000,
+        telemetryData.gpsAltitude * 1000,
 #endif
         // Ground X Speed (Latitude), expressed as m/s * 100
         0,
@@ -348,7 +347,7 @@ void mavlinkSendPosition(void)
         // Ground Z Speed (Altitude), expressed as m/s * 100
         0,
         // heading Current heading in degrees, in compass units (0..360, 0=north)
-        DECIDEGREES_TO_DEGREES(attitude.values.yaw)
+        DECIDEGREES_TO_DEGREES(telemetryData.attitude.values.yaw)
     );
     msgLength = mavlink_msg_to_send_buffer(mavBuffer, &mavMsg);
     mavlinkSerialWrite(mavBuffer, msgLength);
@@ -372,11 +371,11 @@ void mavlinkSendAttitude(void)
         // time_boot_ms Timestamp (milliseconds since system boot)
         millis(),
         // roll Roll angle (rad)
-        DECIDEGREES_TO_RADIANS(attitude.values.roll),
+        DECIDEGREES_TO_RADIANS(telemetryData.attitude.values.roll),
         // pitch Pitch angle (rad)
-        DECIDEGREES_TO_RADIANS(-attitude.values.pitch),
+        DECIDEGREES_TO_RADIANS(-telemetryData.attitude.values.pitch),
         // yaw Yaw angle (rad)
-        DECIDEGREES_TO_RADIANS(attitude.values.yaw),
+        DECIDEGREES_TO_RADIANS(telemetryData.attitude.values.yaw),
         // rollspeed Roll angular speed (rad/s)
         0,
         // pitchspeed Pitch angular speed (rad/s)
@@ -397,7 +396,7 @@ void mavlinkSendHUDAndHeartbeat(void)
 #if defined(GPS)
     // use ground speed if source available
     if (sensors(SENSOR_GPS)) {
-        mavGroundSpeed = GPS_speed / 100.0;
+        mavGroundSpeed = telemetryData.gpsSpeed / 100.0;
     }
 #endif
     
@@ -410,13 +409,13 @@ void mavlinkSendHUDAndHeartbeat(void)
 #if defined(GPS)
     else if (sensors(SENSOR_GPS)) {
         // No sonar or baro, just display altitude above MLS
-        mavAltitude = GPS_altitude;
+        mavAltitude = telemetryData.gpsAltitude;
     }
 #endif
 #elif defined(GPS)
     if (sensors(SENSOR_GPS)) {
         // No sonar or baro, just display altitude above MLS
-        mavAltitude = GPS_altitude;
+        mavAltitude = telemetryData.gpsAltitude;
     }
 #endif
     
@@ -426,7 +425,7 @@ void mavlinkSendHUDAndHeartbeat(void)
         // groundspeed Current ground speed in m/s
         mavGroundSpeed,
         // heading Current heading in degrees, in compass units (0..360, 0=north)
-        DECIDEGREES_TO_DEGREES(attitude.values.yaw),
+        DECIDEGREES_TO_DEGREES(telemetryData.attitude.values.yaw),
         // throttle Current throttle setting in integer percent, 0 to 100
         scaleRange(constrain(rcData[THROTTLE], PWM_RANGE_MIN, PWM_RANGE_MAX), PWM_RANGE_MIN, PWM_RANGE_MAX, 0, 100),
         // alt Current altitude (MSL), in meters, if we have sonar or baro use them, otherwise use GPS (less accurate)
@@ -43,6 +43,8 @@
 #include "flight/altitudehold.h"
 
 #include "telemetry/telemetry.h"
+#include "telemetry/telemetry_data.h"
+#include "telemetry/telemetry_scheduler.h"
 #include "telemetry/smartport.h"
 
 #include "fc/runtime_config.h"
@@ -160,15 +162,15 @@ static void smartPortDataReceive(uint16_t c)
     lastChar = c;
 }
 
-static void smartPortSendByte(uint8_t c, uint16_t *crcp)
+static void smartPortSendByte(telemetryFrame_t *frame, uint8_t c, uint16_t *crcp)
 {
     // smart port escape sequence
     if (c == 0x7D || c == 0x7E) {
-        serialWrite(smartPortSerialPort, 0x7D);
+        telemetryFrameWrite(frame, 0x7D);
         c ^= 0x20;
     }
 
-    serialWrite(smartPortSerialPort, c);
+    telemetryFrameWrite(frame, c);
 
     if (crcp == NULL)
         return;
@@ -180,19 +182,23 @@ static void smartPortSendByte(uint8_t c, uint16_t *crcp)
     *crcp = crc;
 }
 
+// The package is built in full and handed to the port in one go, the sensor hub only has a short window to reply
 static void smartPortSendPackage(uint16_t id, uint32_t val)
 {
+    telemetryFrame_t frame = { .size = 0 };
     uint16_t crc = 0;
-    smartPortSendByte(FSSP_DATA_FRAME, &crc);
+    smartPortSendByte(&frame, FSSP_DATA_FRAME, &crc);
     uint8_t *u8p = (uint8_t*)&id;
-    smartPortSendByte(u8p[0], &crc);
-    smartPortSendByte(u8p[1], &crc);
+    smartPortSendByte(&frame, u8p[0], &crc);
+    smartPortSendByte(&frame, u8p[1], &crc);
     u8p = (uint8_t*)&val;
-    smartPortSendByte(u8p[0], &crc);
-    smartPortSendByte(u8p[1], &crc);
-    smartPortSendByte(u8p[2], &crc);
-    smartPortSendByte(u8p[3], &crc);
-    smartPortSendByte(0xFF - (uint8_t)crc, NULL);
+    smartPortSendByte(&frame, u8p[0], &crc);
+    smartPortSendByte(&frame, u8p[1], &crc);
+    smartPortSendByte(&frame, u8p[2], &crc);
+    smartPortSendByte(&frame, u8p[3], &crc);
+    smartPortSendByte(&frame, 0xFF - (uint8_t)crc, NULL);
+
+    serialWriteBuf(smartPortSerialPort, frame.data, frame.size);
 }
 
 void initSmartPortTelemetry(void)
@@ -309,7 +315,7 @@ void handleSmartPortTelemetry(void)
                 if (sensors(SENSOR_GPS) && STATE(GPS_FIX)) {
                     //convert to knots: 1cm/s = 0.0194384449 knots
                     //Speed should be sent in knots/1000 (GPS speed is in cm/s)
-                    uint32_t tmpui = GPS_speed * 1944 / 100; 
+                    uint32_t tmpui = telemetryData.gpsSpeed * 1944 / 100;
                     smartPortSendPackage(id, tmpui);
                     smartPortHasRequest = 0;
                 }
@@ -317,7 +323,7 @@ void handleSmartPortTelemetry(void)
 #endif
             case FSSP_DATAID_VFAS       :
                 if (feature(FEATURE_VBAT)) {
-                    smartPortSendPackage(id, vbat * 10); // given in 0.1V, convert to volts
+                    smartPortSendPackage(id, telemetryData.vbat * 10); // given in 0.1V, convert to volts
                     smartPortHasRequest = 0;
                 }
                 break;
@@ -335,9 +341,9 @@ void handleSmartPortTelemetry(void)
 
                     // Cells Data Payload
                     uint32_t payload = 0;
-                    payload |= ((uint16_t)(vbat * 100 + batteryCellCount) / (batteryCellCount * 2)) & 0x0FFF;  // Cell Voltage formatted for payload, modified code from cleanflight Frsky.c, TESTING NOTE: (uint16_t)(4.2 * 500.0) & 0x0FFF;
+                    payload |= telemetryData.cellVoltageFlvss & 0x0FFF;  // Cell Voltage formatted for payload, TESTING NOTE: (uint16_t)(4.2 * 500.0) & 0x0FFF;
                     payload <<= 4;
-                    payload |= (uint8_t)batteryCellCount & 0x0F; // Cell Total Count formatted for payload
+                    payload |= telemetryData.cellCount & 0x0F; // Cell Total Count formatted for payload
                     payload <<= 4;
                     payload |= (uint8_t)currentCell & 0x0F; // Current Cell Index Number formatted for payload
 
@@ -347,28 +353,25 @@ void handleSmartPortTelemetry(void)
 
                     // Incremental Counter
                     currentCell++;
-                    currentCell %= batteryCellCount; // Reset counter @ max index
+                    currentCell %= telemetryData.cellCount; // Reset counter @ max index
                 }
                 break;
             case FSSP_DATAID_CURRENT    :
                 if (feature(FEATURE_AMPERAGE_METER)) {
-                    amperageMeter_t *state = getAmperageMeter(batteryConfig()->amperageMeterSource);
-
-                    smartPortSendPackage(id, state->amperage / 10); // given in 10mA steps, unknown requested unit
+                    smartPortSendPackage(id, telemetryData.amperage / 10); // given in 10mA steps, unknown requested unit
                     smartPortHasRequest = 0;
                 }
                 break;
             //case FSSP_DATAID_RPM        :
             case FSSP_DATAID_ALTITUDE   :
                 if (sensors(SENSOR_BARO)) {
-                    smartPortSendPackage(id, BaroAlt); // unknown given unit, requested 100 = 1 meter
+                    smartPortSendPackage(id, telemetryData.baroAltitude); // unknown given unit, requested 100 = 1 meter
                     smartPortHasRequest = 0;
                 }
                 break;
             case FSSP_DATAID_FUEL       :
                 if (feature(FEATURE_AMPERAGE_METER)) {
-                    amperageMeter_t *state = getAmperageMeter(batteryConfig()->amperageMeterSource);
-                    smartPortSendPackage(id, state->mAhDrawn); // given in mAh, unknown requested unit
+                    smartPortSendPackage(id, telemetryData.mAhDrawn); // given in mAh, unknown requested unit
                     smartPortHasRequest = 0;
                 }
                 break;
@@ -382,14 +385,14 @@ void handleSmartPortTelemetry(void)
                     // the MSB of the sent uint32_t helps FrSky keep track
                     // the even/odd bit of our counter helps us keep track
                     if (smartPortIdCnt & 1) {
-                        tmpui = abs(GPS_coord[LON]);  // now we have unsigned value and one bit to spare
+                        tmpui = abs(telemetryData.gpsCoord[LON]);  // now we have unsigned value and one bit to spare
                         tmpui = (tmpui + tmpui / 2) / 25 | 0x80000000;  // 6/100 = 1.5/25, division by power of 2 is fast
-                        if (GPS_coord[LON] < 0) tmpui |= 0x40000000;
+                        if (telemetryData.gpsCoord[LON] < 0) tmpui |= 0x40000000;
                     }
                     else {
-                        tmpui = abs(GPS_coord[LAT]);  // now we have unsigned value and one bit to spare
+                        tmpui = abs(telemetryData.gpsCoord[LAT]);  // now we have unsigned value and one bit to spare
                         tmpui = (tmpui + tmpui / 2) / 25;  // 6/100 = 1.5/25, division by power of 2 is fast
-                        if (GPS_coord[LAT] < 0) tmpui |= 0x40000000;
+                        if (telemetryData.gpsCoord[LAT] < 0) tmpui |= 0x40000000;
                     }
                     smartPortSendPackage(id, tmpui);
                     smartPortHasRequest = 0;
@@ -399,12 +402,12 @@ void handleSmartPortTelemetry(void)
             //case FSSP_DATAID_CAP_USED   :
             case FSSP_DATAID_VARIO      :
                 if (sensors(SENSOR_BARO)) {
-                    smartPortSendPackage(id, vario); // unknown given unit but requested in 100 = 1m/s
+                    smartPortSendPackage(id, telemetryData.vario); // unknown given unit but requested in 100 = 1m/s
                     smartPortHasRequest = 0;
                 }
                 break;
             case FSSP_DATAID_HEADING    :
-                smartPortSendPackage(id, attitude.values.yaw * 10); // given in 10*deg, requested in 10000 = 100 deg
+                smartPortSendPackage(id, telemetryData.attitude.values.yaw * 10); // given in 10*deg, requested in 10000 = 100 deg
                 smartPortHasRequest = 0;
                 break;
             case FSSP_DATAID_ACCX       :
@@ -464,7 +467,7 @@ void handleSmartPortTelemetry(void)
                 if (sensors(SENSOR_GPS)) {
 #ifdef GPS
                     // provide GPS lock status
-                    smartPortSendPackage(id, (STATE(GPS_FIX) ? 1000 : 0) + (STATE(GPS_FIX_HOME) ? 2000 : 0) + GPS_numSat);
+                    smartPortSendPackage(id, (STATE(GPS_FIX) ? 1000 : 0) + (STATE(GPS_FIX_HOME) ? 2000 : 0) + telemetryData.gpsNumSat);
                     smartPortHasRequest = 0;
 #endif
                 }
@@ -476,14 +479,14 @@ void handleSmartPortTelemetry(void)
 #ifdef GPS
             case FSSP_DATAID_GPS_ALT    :
                 if (sensors(SENSOR_GPS) && STATE(GPS_FIX)) {
-                    smartPortSendPackage(id, GPS_altitude * 100); // given in 0.1m , requested in 10 = 1m (should be in mm, probably a bug in opentx, tested on 2.0.1.7)
+                    smartPortSendPackage(id, telemetryData.gpsAltitude * 100); // given in 0.1m , requested in 10 = 1m (should be in mm, probably a bug in opentx, tested on 2.0.1.7)
                     smartPortHasRequest = 0;
                 }
                 break;
 #endif
 	    case FSSP_DATAID_A4    :
                 if (feature(FEATURE_VBAT)) {
-                    smartPortSendPackage(id, vbat * 10 / batteryCellCount ); //sending calculated average cell value with 0.01 precision
+                    smartPortSendPackage(id, telemetryData.cellVoltage); //sending calculated average cell value with 0.01 precision
                     smartPortHasRequest = 0;
                 }
                 break;
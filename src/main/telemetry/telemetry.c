@@ -23,6 +23,9 @@
 
 #ifdef TELEMETRY
 
+#include "common/maths.h"
+#include "common/axis.h"
+
 #include "config/parameter_group.h"
 #include "config/parameter_group_ids.h"
 
@@ -30,17 +33,26 @@
 #include "drivers/timer.h"
 #include "drivers/serial.h"
 #include "drivers/serial_softserial.h"
+#include "drivers/sensor.h"
+#include "drivers/accgyro.h"
 
 #include "fc/runtime_config.h"
 #include "fc/config.h"
 #include "fc/rc_controls.h"
 #include "fc/fc_serial.h"
 #include "io/serial.h"
+#include "io/gps.h"
+
+#include "sensors/sensors.h"
+#include "sensors/acceleration.h"
+
+#include "flight/imu.h"
 
 #include "rx/rx.h"
 
 
 #include "telemetry/telemetry.h"
+#include "telemetry/telemetry_data.h"
 #include "telemetry/frsky.h"
 #include "telemetry/hott.h"
 #include "telemetry/smartport.h"
@@ -107,6 +119,8 @@ uint8_t telemetryCheckState(void)
 
 void telemetryProcess(uint16_t deadband3d_throttle)
 {
+    telemetryDataUpdate();
+
     handleFrSkyTelemetry(deadband3d_throttle);
     handleHoTTTelemetry();
     handleSmartPortTelemetry();
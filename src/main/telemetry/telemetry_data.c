@@ -0,0 +1,129 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <platform.h>
+
+#ifdef TELEMETRY
+
+#include "common/maths.h"
+#include "common/axis.h"
+
+#include "config/parameter_group.h"
+
+#include "drivers/sensor.h"
+#include "drivers/accgyro.h"
+#include "drivers/serial.h"
+
+#include "io/serial.h"
+#include "io/gps.h"
+
+#include "rx/rx.h"
+
+#include "sensors/sensors.h"
+#include "sensors/acceleration.h"
+#include "sensors/barometer.h"
+#include "sensors/amperage.h"
+#include "sensors/battery.h"
+
+#include "flight/imu.h"
+#include "flight/altitudehold.h"
+
+#include "telemetry/telemetry.h"
+#include "telemetry/telemetry_data.h"
+
+telemetryData_t telemetryData;
+
+#ifdef GPS
+static struct {
+    bool valid[2];                              // per coordinate format, cleared by every snapshot
+    gpsCoordinateDDDMMmmmm_t coord[2][2];
+} coordinateDDDMMmmmm;
+#endif
+
+void telemetryDataUpdate(void)
+{
+    telemetryData.vbat = vbat;
+    telemetryData.cellCount = batteryCellCount;
+    if (batteryCellCount) {
+        telemetryData.cellVoltage = vbat * 10 / batteryCellCount;
+        telemetryData.cellVoltageFlvss = ((uint32_t)vbat * 100 + batteryCellCount) / (batteryCellCount * 2);
+    } else {
+        telemetryData.cellVoltage = 0;
+        telemetryData.cellVoltageFlvss = 0;
+    }
+
+    const amperageMeter_t *amperageMeter = getAmperageMeter(batteryConfig()->amperageMeterSource);
+    telemetryData.amperage = amperageMeter->amperage;
+    telemetryData.mAhDrawn = amperageMeter->mAhDrawn;
+    if (batteryConfig()->batteryCapacity > 0) {
+        telemetryData.capacityRemaining = batteryCapacityRemainingPercentage();
+    }
+
+    telemetryData.attitude = attitude;
+    telemetryData.baroAltitude = BaroAlt;
+    telemetryData.vario = vario;
+    telemetryData.rssi = rssi;
+
+#ifdef GPS
+    telemetryData.gpsCoord[LAT] = GPS_coord[LAT];
+    telemetryData.gpsCoord[LON] = GPS_coord[LON];
+    telemetryData.gpsAltitude = GPS_altitude;
+    telemetryData.gpsSpeed = GPS_speed;
+    telemetryData.gpsHdop = GPS_hdop;
+    telemetryData.gpsNumSat = GPS_numSat;
+
+    coordinateDDDMMmmmm.valid[FRSKY_FORMAT_DMS] = false;
+    coordinateDDDMMmmmm.valid[FRSKY_FORMAT_NMEA] = false;
+#endif
+}
+
+// dddmm.mmmm, the .mmmm is the decimal fraction of minutes
+void telemetryCoordinateToDDDMMmmmm(int32_t coordinate, frskyGpsCoordFormat_e format, gpsCoordinateDDDMMmmmm_t *result)
+{
+    int32_t absgps, deg, min;
+    absgps = ABS(coordinate);
+    deg    = absgps / GPS_DEGREES_DIVIDER;
+    absgps = (absgps - deg * GPS_DEGREES_DIVIDER) * 60;        // absgps = Minutes left * 10^7
+    min    = absgps / GPS_DEGREES_DIVIDER;                     // minutes left
+
+    if (format == FRSKY_FORMAT_DMS) {
+        result->dddmm = deg * 100 + min;
+    } else {
+        result->dddmm = deg * 60 + min;
+    }
+
+    result->mmmm  = (absgps - min * GPS_DEGREES_DIVIDER) / 1000;
+}
+
+#ifdef GPS
+// Returns the LAT/LON pair of the snapshot, converted on the first call after each snapshot
+const gpsCoordinateDDDMMmmmm_t *telemetryDataGetCoordinateDDDMMmmmm(frskyGpsCoordFormat_e format)
+{
+    if (!coordinateDDDMMmmmm.valid[format]) {
+        telemetryCoordinateToDDDMMmmmm(telemetryData.gpsCoord[LAT], format, &coordinateDDDMMmmmm.coord[format][LAT]);
+        telemetryCoordinateToDDDMMmmmm(telemetryData.gpsCoord[LON], format, &coordinateDDDMMmmmm.coord[format][LON]);
+        coordinateDDDMMmmmm.valid[format] = true;
+    }
+    return coordinateDDDMMmmmm.coord[format];
+}
+#endif
+
+#endif
@@ -0,0 +1,56 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Snapshot of the values sent by the telemetry protocols.
+//
+// Taken once per telemetry task run, before the protocols are serviced, so every link reports the same values
+// and the unit conversions shared by several protocols are done only once. Conversions only one protocol
+// needs are done on first use and kept until the next snapshot.
+
+typedef struct telemetryData_s {
+    uint16_t vbat;                  // 0.1V
+    uint8_t cellCount;
+    uint16_t cellVoltage;           // average cell voltage, 0.01V
+    uint16_t cellVoltageFlvss;      // average cell voltage in the 0.002V steps of the FrSky FLVSS sensor
+    int32_t amperage;               // 0.01A
+    int32_t mAhDrawn;
+    uint8_t capacityRemaining;      // percent, only valid if the battery capacity is configured
+
+    attitudeEulerAngles_t attitude; // decidegrees
+    int32_t baroAltitude;           // cm
+    int32_t vario;                  // cm/s
+    uint16_t rssi;                  // 0-1023
+
+#ifdef GPS
+    int32_t gpsCoord[2];            // LAT/LON, degrees * 10^7
+    uint16_t gpsAltitude;           // m
+    uint16_t gpsSpeed;              // cm/s
+    uint16_t gpsHdop;
+    uint8_t gpsNumSat;
+#endif
+} telemetryData_t;
+
+extern telemetryData_t telemetryData;
+
+void telemetryDataUpdate(void);
+
+void telemetryCoordinateToDDDMMmmmm(int32_t coordinate, frskyGpsCoordFormat_e format, gpsCoordinateDDDMMmmmm_t *result);
+#ifdef GPS
+const gpsCoordinateDDDMMmmmm_t *telemetryDataGetCoordinateDDDMMmmmm(frskyGpsCoordFormat_e format);
+#endif
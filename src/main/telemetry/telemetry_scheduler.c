@@ -0,0 +1,139 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <platform.h>
+
+#ifdef TELEMETRY
+
+#include "common/maths.h"
+
+#include "drivers/serial.h"
+
+#include "telemetry/telemetry_scheduler.h"
+
+void telemetrySchedulerInit(telemetryScheduler_t *scheduler, const telemetryLink_t *link,
+                            const telemetrySlot_t *slots, uint8_t slotCount, uint32_t currentTimeMs)
+{
+    memset(scheduler, 0, sizeof(*scheduler));
+
+    scheduler->link = *link;
+    scheduler->link.maxFrameSize = MIN(link->maxFrameSize, TELEMETRY_FRAME_SIZE_MAX);
+    scheduler->slots = slots;
+    scheduler->slotCount = MIN(slotCount, TELEMETRY_SLOT_COUNT_MAX);
+    scheduler->lastRefillMs = currentTimeMs;
+
+    // everything is due straight away, the priorities decide the order the items go out in
+    for (int i = 0; i < scheduler->slotCount; i++) {
+        scheduler->nextDueMs[i] = currentTimeMs;
+    }
+}
+
+static void telemetrySchedulerRefill(telemetryScheduler_t *scheduler, uint32_t currentTimeMs)
+{
+    const uint32_t elapsedMs = currentTimeMs - scheduler->lastRefillMs;
+    const uint32_t creditMax = scheduler->link.maxFrameSize * 1000;
+
+    scheduler->lastRefillMs = currentTimeMs;
+
+    // the credit never exceeds one frame, so a link that was idle can not burst above its rate afterwards
+    if (elapsedMs >= creditMax) {
+        scheduler->credit = creditMax;
+    } else {
+        scheduler->credit = MIN(scheduler->credit + elapsedMs * scheduler->link.bytesPerSecond, creditMax);
+    }
+}
+
+// Returns the most important slot that is due, the one that has been waiting longest if several share a priority
+static int telemetrySchedulerNextSlot(const telemetryScheduler_t *scheduler, uint32_t currentTimeMs)
+{
+    int next = -1;
+    int32_t nextOverdueMs = 0;
+
+    for (int i = 0; i < scheduler->slotCount; i++) {
+        const int32_t overdueMs = currentTimeMs - scheduler->nextDueMs[i];
+        if (overdueMs < 0) {
+            continue;
+        }
+        if (next < 0
+            || scheduler->slots[i].priority < scheduler->slots[next].priority
+            || (scheduler->slots[i].priority == scheduler->slots[next].priority && overdueMs > nextOverdueMs)) {
+            next = i;
+            nextOverdueMs = overdueMs;
+        }
+    }
+    return next;
+}
+
+/*
+ * Fills the scheduler frame with due items, most important first, while the link budget and the bytesFree
+ * space in the port allow. Stops at the first item that does not fit so a large, important item can not
+ * be starved by smaller ones.
+ * Returns the size of the frame, 0 when nothing was sent.
+ */
+uint8_t telemetrySchedulerBuildFrame(telemetryScheduler_t *scheduler, uint8_t bytesFree, uint32_t currentTimeMs)
+{
+    telemetryFrame_t *frame = &scheduler->frame;
+
+    frame->size = 0;
+
+    telemetrySchedulerRefill(scheduler, currentTimeMs);
+
+    const uint32_t budget = MIN(MIN(scheduler->credit / 1000, bytesFree), scheduler->link.maxFrameSize);
+    if (budget <= scheduler->link.trailerSize) {
+        return 0;
+    }
+    const uint8_t payloadMax = budget - scheduler->link.trailerSize;
+
+    int slotIndex;
+    while ((slotIndex = telemetrySchedulerNextSlot(scheduler, currentTimeMs)) >= 0) {
+        const telemetrySlot_t *slot = &scheduler->slots[slotIndex];
+        if (frame->size + slot->maxSize > payloadMax) {
+            break;
+        }
+
+        slot->write();
+
+        scheduler->nextDueMs[slotIndex] += slot->periodMs;
+        if ((int32_t)(currentTimeMs - scheduler->nextDueMs[slotIndex]) >= 0) {
+            // more than a period behind, drop the missed updates instead of sending them back to back
+            scheduler->nextDueMs[slotIndex] = currentTimeMs + slot->periodMs;
+        }
+    }
+
+    if (frame->size > 0 && scheduler->link.writeTrailer) {
+        scheduler->link.writeTrailer();
+    }
+
+    scheduler->credit -= MIN(frame->size * 1000, scheduler->credit);
+
+    return frame->size;
+}
+
+void telemetrySchedulerProcess(telemetryScheduler_t *scheduler, serialPort_t *port, uint32_t currentTimeMs)
+{
+    const uint8_t size = telemetrySchedulerBuildFrame(scheduler, serialTxBytesFree(port), currentTimeMs);
+
+    if (size > 0) {
+        serialWriteBuf(port, scheduler->frame.data, size);
+    }
+}
+
+#endif
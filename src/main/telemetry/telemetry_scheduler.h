@@ -0,0 +1,69 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Shared scheduler for the push telemetry protocols.
+//
+// Each protocol describes its sensor items as slots with an update period, a priority and the worst case
+// number of bytes the item encodes to, and its link with the average byte rate it can carry.
+// On every call the scheduler fills one frame with the most important items that are due, limited by the
+// link budget and the free space in the port TX buffer, and hands it to the port in a single serialWriteBuf().
+
+#define TELEMETRY_FRAME_SIZE_MAX    64
+#define TELEMETRY_SLOT_COUNT_MAX    24
+
+typedef struct telemetryFrame_s {
+    uint8_t data[TELEMETRY_FRAME_SIZE_MAX];
+    uint8_t size;
+} telemetryFrame_t;
+
+typedef struct telemetrySlot_s {
+    void (*write)(void);    // encodes the item into the scheduler frame, may write nothing if the item is not available
+    uint16_t periodMs;
+    uint8_t priority;       // 0 is the most important
+    uint8_t maxSize;        // worst case bytes written, including any byte stuffing
+} telemetrySlot_t;
+
+typedef struct telemetryLink_s {
+    uint16_t bytesPerSecond;    // average rate the link carries to the radio
+    uint8_t maxFrameSize;       // largest frame written to the port in one call, including the trailer
+    uint8_t trailerSize;
+    void (*writeTrailer)(void); // optional, closes a frame that is not empty
+} telemetryLink_t;
+
+typedef struct telemetryScheduler_s {
+    telemetryLink_t link;
+    const telemetrySlot_t *slots;
+    uint8_t slotCount;
+    uint32_t nextDueMs[TELEMETRY_SLOT_COUNT_MAX];
+    uint32_t lastRefillMs;
+    uint32_t credit;            // link budget available, in bytes * 1000
+    telemetryFrame_t frame;
+} telemetryScheduler_t;
+
+static inline void telemetryFrameWrite(telemetryFrame_t *frame, uint8_t data)
+{
+    if (frame->size < TELEMETRY_FRAME_SIZE_MAX) {
+        frame->data[frame->size++] = data;
+    }
+}
+
+void telemetrySchedulerInit(telemetryScheduler_t *scheduler, const telemetryLink_t *link,
+                            const telemetrySlot_t *slots, uint8_t slotCount, uint32_t currentTimeMs);
+uint8_t telemetrySchedulerBuildFrame(telemetryScheduler_t *scheduler, uint8_t bytesFree, uint32_t currentTimeMs);
+void telemetrySchedulerProcess(telemetryScheduler_t *scheduler, serialPort_t *port, uint32_t currentTimeMs);
@@ -0,0 +1,227 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+
+benchSample_t benchTrace[BENCH_TRACE_LENGTH];
+
+benchOptions_t benchOptions = {
+    .iterations = 100000,
+    .repeats = 15,
+    .filter = NULL,
+};
+
+static uint32_t xorshift32(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static int16_t noise(uint32_t *state, int amplitude)
+{
+    return (int16_t)((int32_t)(xorshift32(state) % (2 * amplitude + 1)) - amplitude);
+}
+
+/*
+ * Fills the trace with a second of flight at 1kHz: slow stick movements on every axis, the gyro following them with
+ * a motor vibration and noise on top, and a noisy accelerometer reading about 1G on Z.
+ */
+void benchGenerateTrace(uint32_t seed)
+{
+    uint32_t state = seed ? seed : 1;
+
+    for (int i = 0; i < BENCH_TRACE_LENGTH; i++) {
+        benchSample_t *sample = &benchTrace[i];
+        const float t = i / 1000.0f;
+        const float stick[3] = {
+            400 * sinf(2 * M_PI * 0.7f * t),
+            300 * sinf(2 * M_PI * 1.1f * t + 1),
+            200 * sinf(2 * M_PI * 0.3f * t),
+        };
+
+        for (int axis = 0; axis < 3; axis++) {
+            sample->rcCommand[axis] = lrintf(stick[axis]);
+            sample->gyroADC[axis] = lrintf(stick[axis] * 0.8f + 50 * sinf(2 * M_PI * 180 * t + axis)) + noise(&state, 40);
+            sample->accSmooth[axis] = noise(&state, 200);
+        }
+        sample->accSmooth[2] += 4096;
+        sample->rcCommand[3] = lrintf(1500 + 300 * sinf(2 * M_PI * 0.2f * t));
+    }
+}
+
+static std::string trim(const std::string &s)
+{
+    const size_t begin = s.find_first_not_of(" \t\r\n");
+    const size_t end = s.find_last_not_of(" \t\r\n");
+    return begin == std::string::npos ? "" : s.substr(begin, end - begin + 1);
+}
+
+static std::vector<std::string> splitCsvLine(const char *line)
+{
+    std::vector<std::string> fields;
+    std::string field;
+
+    for (const char *c = line; *c; c++) {
+        if (*c == ',') {
+            fields.push_back(trim(field));
+            field.clear();
+        } else {
+            field += *c;
+        }
+    }
+    fields.push_back(trim(field));
+    return fields;
+}
+
+/*
+ * Loads the trace from a CSV file as written by blackbox_decode, using the gyroADC, accSmooth and rcCommand columns.
+ * Logs shorter than the trace are repeated, longer logs are cut short.
+ */
+bool benchLoadTrace(const char *path)
+{
+    static const char *const columnNames[] = {
+        "gyroADC[0]", "gyroADC[1]", "gyroADC[2]",
+        "accSmooth[0]", "accSmooth[1]", "accSmooth[2]",
+        "rcCommand[0]", "rcCommand[1]", "rcCommand[2]", "rcCommand[3]",
+    };
+    const int columnCount = sizeof(columnNames) / sizeof(columnNames[0]);
+    int columns[columnCount];
+    char line[4096];
+    int rows = 0;
+
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Could not open trace %s\n", path);
+        return false;
+    }
+
+    if (!fgets(line, sizeof(line), file)) {
+        fclose(file);
+        return false;
+    }
+
+    const std::vector<std::string> header = splitCsvLine(line);
+    for (int i = 0; i < columnCount; i++) {
+        columns[i] = std::find(header.begin(), header.end(), columnNames[i]) - header.begin();
+        if (columns[i] == (int)header.size()) {
+            fprintf(stderr, "Trace %s has no %s column\n", path, columnNames[i]);
+            fclose(file);
+            return false;
+        }
+    }
+
+    while (rows < BENCH_TRACE_LENGTH && fgets(line, sizeof(line), file)) {
+        const std::vector<std::string> fields = splitCsvLine(line);
+        int16_t values[columnCount];
+
+        if (fields.size() < header.size()) {
+            continue; // not a main frame row
+        }
+        for (int i = 0; i < columnCount; i++) {
+            values[i] = atoi(fields[columns[i]].c_str());
+        }
+
+        benchSample_t *sample = &benchTrace[rows++];
+        memcpy(sample->gyroADC, &values[0], sizeof(sample->gyroADC));
+        memcpy(sample->accSmooth, &values[3], sizeof(sample->accSmooth));
+        memcpy(sample->rcCommand, &values[6], sizeof(sample->rcCommand));
+    }
+    fclose(file);
+
+    if (rows == 0) {
+        fprintf(stderr, "Trace %s has no samples\n", path);
+        return false;
+    }
+    for (int i = rows; i < BENCH_TRACE_LENGTH; i++) {
+        benchTrace[i] = benchTrace[i % rows];
+    }
+    return true;
+}
+
+static uint64_t nanosecondsNow(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+/*
+ * Times repeats of the given number of iterations after one unmeasured repeat to warm the caches, and writes one JSON
+ * object per benchmark to stdout. The median is the figure to compare, the spread of the repeats says how far to trust it.
+ */
+void benchRun(const char *name, benchSetupFn setup, benchIterationFn iteration)
+{
+    if (benchOptions.filter && !strstr(name, benchOptions.filter)) {
+        return;
+    }
+
+    if (setup) {
+        setup();
+    }
+
+    const uint32_t iterations = benchOptions.iterations;
+    std::vector<double> nsPerIteration;
+    uint32_t index = 0;
+
+    for (uint32_t repeat = 0; repeat <= benchOptions.repeats; repeat++) {
+        const uint64_t start = nanosecondsNow();
+        for (uint32_t i = 0; i < iterations; i++) {
+            iteration(index++);
+        }
+        const uint64_t elapsed = nanosecondsNow() - start;
+
+        if (repeat > 0) {
+            nsPerIteration.push_back((double)elapsed / iterations);
+        }
+    }
+
+    std::sort(nsPerIteration.begin(), nsPerIteration.end());
+
+    const size_t count = nsPerIteration.size();
+    const double median = count % 2 ? nsPerIteration[count / 2] : (nsPerIteration[count / 2 - 1] + nsPerIteration[count / 2]) / 2;
+    double mean = 0;
+    for (double ns : nsPerIteration) {
+        mean += ns;
+    }
+    mean /= count;
+    double variance = 0;
+    for (double ns : nsPerIteration) {
+        variance += (ns - mean) * (ns - mean);
+    }
+    const double stddev = count > 1 ? sqrt(variance / (count - 1)) : 0;
+
+    printf("{\"benchmark\":\"%s\",\"iterations\":%u,\"repeats\":%u,"
+           "\"median_ns\":%.2f,\"min_ns\":%.2f,\"max_ns\":%.2f,\"mean_ns\":%.2f,\"stddev_ns\":%.2f,\"rsd_percent\":%.2f}\n",
+           name, iterations, (unsigned)count,
+           median, nsPerIteration.front(), nsPerIteration.back(), mean, stddev, mean > 0 ? 100 * stddev / mean : 0);
+    fflush(stdout);
+}
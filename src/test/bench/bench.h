@@ -0,0 +1,54 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define BENCH_TRACE_LENGTH 1024     // samples, a power of two so the benchmarks can wrap with a mask
+
+// One flight loop of input, in the units of the blackbox fields of the same name
+typedef struct benchSample_s {
+    int16_t gyroADC[3];
+    int16_t accSmooth[3];
+    int16_t rcCommand[4];
+} benchSample_t;
+
+extern benchSample_t benchTrace[BENCH_TRACE_LENGTH];
+
+#define BENCH_SAMPLE(iteration) (&benchTrace[(iteration) & (BENCH_TRACE_LENGTH - 1)])
+
+typedef struct benchOptions_s {
+    uint32_t iterations;        // per repeat
+    uint32_t repeats;
+    const char *filter;         // only run benchmarks whose name contains this, or NULL for all
+} benchOptions_t;
+
+extern benchOptions_t benchOptions;
+
+typedef void (*benchSetupFn)(void);
+typedef void (*benchIterationFn)(uint32_t iteration);
+
+void benchGenerateTrace(uint32_t seed);
+bool benchLoadTrace(const char *path);
+
+void benchRun(const char *name, benchSetupFn setup, benchIterationFn iteration);
+
+// benchmarks outside the control path, each runs its own set with benchRun()
+void benchGpsParser(void);
+void benchBlackboxEncoding(void);
@@ -0,0 +1,86 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Times the variable byte and tag encodings of blackbox_io.c, one iteration is one frame laid out as the main P frame
+ * of the firmware. blackboxLogIteration in control_path_bench times the whole logging path around them.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+extern "C" {
+    #include <platform.h>
+
+    #include "blackbox/blackbox_io.h"
+}
+
+#include "bench.h"
+
+#define ENCODING_FRAMES         1024    // a power of two so the iterations can wrap with a mask
+#define ENCODING_FRAME_FIELDS   24
+
+static int32_t frames[ENCODING_FRAMES][ENCODING_FRAME_FIELDS];
+
+static uint32_t randomState;
+
+static uint32_t randomU32(void)
+{
+    // xorshift32
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+static int32_t randomBetween(int32_t min, int32_t max)
+{
+    return min + (int32_t)(randomU32() % ((uint32_t)(max - min) + 1));
+}
+
+/*
+ * Values that change as the logged ones do from one loop iteration to the next: small PID and gyro deltas with the
+ * odd large one, motors that move a little.
+ */
+static void setupMainFrame(void)
+{
+    randomState = 8;
+    for (int i = 0; i < ENCODING_FRAMES; i++) {
+        for (int field = 0; field < ENCODING_FRAME_FIELDS; field++) {
+            frames[i][field] = randomU32() % 16 == 0 ? randomBetween(-2000, 2000) : randomBetween(-20, 20);
+        }
+    }
+}
+
+static void iterateMainFrame(uint32_t iteration)
+{
+    int32_t *frame = frames[iteration & (ENCODING_FRAMES - 1)];
+
+    blackboxWriteSignedVB(frame[0]);                // loopIteration and time
+    blackboxWriteSignedVB(frame[1]);
+    blackboxWriteSignedVBArray(&frame[2], 3);       // axisP
+    blackboxWriteTag2_3S32(&frame[5]);              // axisI
+    blackboxWriteTag8_8SVB(&frame[8], 3);           // axisD
+    blackboxWriteTag8_4S16(&frame[11]);             // rcCommand
+    blackboxWriteTag8_8SVB(&frame[15], 6);          // vbat, amperage, magADC, BaroAlt
+    blackboxWriteSignedVBArray(&frame[21], 3);      // gyroADC
+}
+
+void benchBlackboxEncoding(void)
+{
+    benchRun("blackboxEncoding/mainFrame", setupMainFrame, iterateMainFrame);
+}
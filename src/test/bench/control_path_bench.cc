@@ -0,0 +1,455 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Times the functions of the flight control loop over a trace of recorded or synthetic sensor and stick input.
+ *
+ * Usage: control_path_bench [--iterations N] [--repeats N] [--filter NAME] [--trace LOG.csv] [--seed N]
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern "C" {
+    #include <platform.h>
+    #include "build/build_config.h"
+    #include "build/debug.h"
+    #include "build/version.h"
+
+    #include "common/axis.h"
+    #include "common/filter.h"
+    #include "common/maths.h"
+
+    #include "config/parameter_group.h"
+    #include "config/parameter_group_ids.h"
+    #include "config/profile.h"
+
+    #include "drivers/adc.h"
+    #include "drivers/sensor.h"
+    #include "drivers/accgyro.h"
+    #include "drivers/compass.h"
+    #include "drivers/serial.h"
+    #include "drivers/pwm_mapping.h"
+
+    #include "fc/config.h"
+    #include "fc/runtime_config.h"
+    #include "fc/rc_controls.h"
+    #include "fc/rate_profile.h"
+
+    #include "io/beeper.h"
+    #include "io/serial.h"
+    #include "io/motors.h"
+
+    #include "rx/rx.h"
+
+    #include "sensors/sensors.h"
+    #include "sensors/acceleration.h"
+    #include "sensors/amperage.h"
+    #include "sensors/barometer.h"
+    #include "sensors/battery.h"
+    #include "sensors/compass.h"
+    #include "sensors/gyro.h"
+    #include "sensors/voltage.h"
+
+    #include "flight/failsafe.h"
+    #include "flight/pid.h"
+    #include "flight/imu.h"
+    #include "flight/mixer.h"
+    #include "flight/mixer_tricopter.h"
+    #include "flight/servos.h"
+    #include "flight/navigation.h"
+
+    #include "scheduler/scheduler.h"
+    #include "fc/fc_tasks.h"
+
+    #include "blackbox/blackbox.h"
+
+    PG_REGISTER(batteryConfig_t, batteryConfig, PG_BATTERY_CONFIG, 0);
+    PG_REGISTER_PROFILE(rcControlsConfig_t, rcControlsConfig, PG_RC_CONTROLS_CONFIG, 0);
+    PG_REGISTER_PROFILE(modeActivationProfile_t, modeActivationProfile, PG_MODE_ACTIVATION_PROFILE, 0);
+    PG_REGISTER(rxConfig_t, rxConfig, PG_RX_CONFIG, 0);
+
+    extern uint32_t currentTime;
+
+    extern pidControllerFuncPtr pid_controller;
+
+    void mixerInit(motorMixer_t *initialCustomMixers);
+    void mixerInitServos(servoMixer_t *initialCustomServoMixers);
+    void mixerUsePWMIOConfiguration(pwmIOConfiguration_t *pwmIOConfiguration);
+
+    void imuMahonyAHRSupdate(float dt, float gx, float gy, float gz,
+                                    bool useAcc, float ax, float ay, float az,
+                                    bool useMag, float mx, float my, float mz,
+                                    bool useYaw, float yawError);
+}
+
+#include "bench.h"
+
+#define BENCH_LOOPTIME_US 1000
+
+static const benchSample_t *currentSample;
+static uint32_t benchMicros;
+static uint32_t benchSerialBytes;
+static rollAndPitchTrims_t benchTrims;
+
+static void applyRcCommand(const benchSample_t *sample)
+{
+    for (int axis = 0; axis < 4; axis++) {
+        rcCommand[axis] = sample->rcCommand[axis];
+    }
+}
+
+static void applyGyro(const benchSample_t *sample)
+{
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        gyroADC[axis] = sample->gyroADC[axis];
+        gyroADCf[axis] = sample->gyroADC[axis];
+    }
+}
+
+static void applyAxisPID(const benchSample_t *sample)
+{
+    // Use the stick input as PID output, it has the range and the rate of change of a flight
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        axisPID[axis] = sample->rcCommand[axis];
+    }
+    rcCommand[THROTTLE] = sample->rcCommand[THROTTLE];
+}
+
+static void resetConfig(void)
+{
+    pgResetAll(MAX_PROFILE_COUNT);
+    pgActivateProfile(0);
+    setControlRateProfile(0);
+
+    rxConfig()->midrc = 1500;
+    rxConfig()->mincheck = 1100;
+    rxConfig()->maxcheck = 1900;
+
+    targetPidLooptime = BENCH_LOOPTIME_US;
+    gyro.scale = 1.0f / 16.4f;
+    gyro.sampleFrequencyHz = 1000000 / BENCH_LOOPTIME_US;
+    armingFlags = ARMED;
+    flightModeFlags = 0;
+}
+
+static bool benchGyroRead(int16_t *gyroADCRaw)
+{
+    memcpy(gyroADCRaw, currentSample->gyroADC, sizeof(currentSample->gyroADC));
+    return true;
+}
+
+static void setupGyro(void)
+{
+    resetConfig();
+    gyro.read = benchGyroRead;
+    gyroInitSensorTransform();
+    gyroInit();
+}
+
+static void iterateGyro(uint32_t iteration)
+{
+    currentSample = BENCH_SAMPLE(iteration);
+    gyroUpdate();
+}
+
+static void setupPid(pidControllerType_e type)
+{
+    resetConfig();
+    pidSetController(type);
+    pidSetTargetLooptime(BENCH_LOOPTIME_US);
+    pidInitFilters(pidProfile());
+    pidResetITerm();
+}
+
+static void setupPidLuxFloat(void)
+{
+    setupPid(PID_CONTROLLER_LUX_FLOAT);
+}
+
+static void setupPidMultiWiiRewrite(void)
+{
+    setupPid(PID_CONTROLLER_MWREWRITE);
+}
+
+static void setupPidMultiWii23(void)
+{
+    setupPid(PID_CONTROLLER_MW23);
+}
+
+static void iteratePid(uint32_t iteration)
+{
+    const benchSample_t *sample = BENCH_SAMPLE(iteration);
+
+    applyGyro(sample);
+    applyRcCommand(sample);
+    pid_controller(pidProfile(), currentControlRateProfile, 500, &benchTrims, rxConfig());
+}
+
+static void setupMixer(mixerMode_e mixerMode)
+{
+    pwmIOConfiguration_t pwmIOConfiguration;
+
+    resetConfig();
+    memset(&pwmIOConfiguration, 0, sizeof(pwmIOConfiguration));
+    pwmIOConfiguration.servoCount = mixerMode == MIXER_TRI ? 1 : 0;
+
+    mixerConfig()->mixerMode = mixerMode;
+    mixerUseConfigs(servoProfile()->servoConf);
+    // as activateConfig() does
+    servoProfile()->servoConf[SERVO_RUDDER].angleAtMin = 40;
+    servoProfile()->servoConf[SERVO_RUDDER].angleAtMax = 40;
+    mixerInit(customMotorMixer(0));
+    mixerInitServos(customServoMixer(0));
+    mixerUsePWMIOConfiguration(&pwmIOConfiguration);
+    mixerResetDisarmedMotors();
+
+    // mixTable() asks the tricopter mixer for a tail motor correction whatever the mixer, which reads the tail servo
+    // through pointers only mixerInitServos() sets for a tricopter. Flash at address 0 hides that on a board.
+    if (mixerMode != MIXER_TRI) {
+        triInitMixer(&servoProfile()->servoConf[SERVO_RUDDER], &servo[SERVO_RUDDER]);
+    }
+}
+
+static void setupMixerQuadX(void)
+{
+    setupMixer(MIXER_QUADX);
+}
+
+static void setupMixerTri(void)
+{
+    setupMixer(MIXER_TRI);
+}
+
+static void iterateMixTable(uint32_t iteration)
+{
+    applyAxisPID(BENCH_SAMPLE(iteration));
+    mixTable();
+}
+
+static void iterateTriServoMixer(uint32_t iteration)
+{
+    applyAxisPID(BENCH_SAMPLE(iteration));
+    triServoMixer(axisPID[FD_YAW]);
+}
+
+static void iterateServoMixTable(uint32_t iteration)
+{
+    applyAxisPID(BENCH_SAMPLE(iteration));
+    servoMixTable();
+}
+
+static void setupImu(void)
+{
+    static imuRuntimeConfig_t imuRuntimeConfig;
+    static accDeadband_t accDeadband;
+
+    resetConfig();
+
+    imuRuntimeConfig.dcm_kp = imuConfig()->dcm_kp / 10000.0f;
+    imuRuntimeConfig.dcm_ki = imuConfig()->dcm_ki / 10000.0f;
+    imuRuntimeConfig.small_angle = imuConfig()->small_angle;
+    imuConfigure(&imuRuntimeConfig, &accDeadband, 5.0f, throttleCorrectionConfig()->throttle_correction_angle);
+    imuInit();
+}
+
+static void iterateImu(uint32_t iteration)
+{
+    const benchSample_t *sample = BENCH_SAMPLE(iteration);
+    const float gyroScale = DEGREES_TO_RADIANS(1.0f / 16.4f);
+
+    imuMahonyAHRSupdate(BENCH_LOOPTIME_US * 1e-6f,
+                        sample->gyroADC[X] * gyroScale, sample->gyroADC[Y] * gyroScale, sample->gyroADC[Z] * gyroScale,
+                        true, sample->accSmooth[X], sample->accSmooth[Y], sample->accSmooth[Z],
+                        false, 0, 0, 0,
+                        false, 0);
+}
+
+static void setupBlackbox(void)
+{
+    resetConfig();
+    initBlackbox();
+    startBlackbox();
+
+    // Send the headers, so the timed iterations only log frames
+    for (int i = 0; i < 5000; i++) {
+        benchMicros += BENCH_LOOPTIME_US;
+        currentTime = benchMicros;
+        handleBlackbox();
+    }
+
+    if (benchSerialBytes == 0) {
+        fprintf(stderr, "Blackbox did not start logging\n");
+        exit(1);
+    }
+}
+
+static void iterateBlackbox(uint32_t iteration)
+{
+    const benchSample_t *sample = BENCH_SAMPLE(iteration);
+
+    applyGyro(sample);
+    applyRcCommand(sample);
+    memcpy(accSmooth, sample->accSmooth, sizeof(sample->accSmooth));
+    benchMicros += BENCH_LOOPTIME_US;
+    currentTime = benchMicros;
+    handleBlackbox();
+}
+
+static void usage(const char *program)
+{
+    fprintf(stderr, "Usage: %s [--iterations N] [--repeats N] [--filter NAME] [--trace LOG.csv] [--seed N]\n", program);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    const char *tracePath = NULL;
+    uint32_t seed = 1;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+        }
+        if (strcmp(arg, "--iterations") == 0) {
+            benchOptions.iterations = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(arg, "--repeats") == 0) {
+            benchOptions.repeats = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(arg, "--filter") == 0) {
+            benchOptions.filter = argv[++i];
+        } else if (strcmp(arg, "--trace") == 0) {
+            tracePath = argv[++i];
+        } else if (strcmp(arg, "--seed") == 0) {
+            seed = strtoul(argv[++i], NULL, 10);
+        } else {
+            usage(argv[0]);
+        }
+    }
+
+    if (benchOptions.iterations == 0 || benchOptions.repeats == 0) {
+        usage(argv[0]);
+    }
+
+    if (tracePath) {
+        if (!benchLoadTrace(tracePath)) {
+            return 1;
+        }
+    } else {
+        benchGenerateTrace(seed);
+    }
+
+    benchRun("gyroUpdate", setupGyro, iterateGyro);
+    benchRun("pidLuxFloat", setupPidLuxFloat, iteratePid);
+    benchRun("pidMultiWiiRewrite", setupPidMultiWiiRewrite, iteratePid);
+    benchRun("pidMultiWii23", setupPidMultiWii23, iteratePid);
+    benchRun("mixTable/quadx", setupMixerQuadX, iterateMixTable);
+    benchRun("mixTable/tri", setupMixerTri, iterateMixTable);
+    benchRun("triServoMixer", setupMixerTri, iterateTriServoMixer);
+    benchRun("servoMixTable/tri", setupMixerTri, iterateServoMixTable);
+    benchRun("imuMahonyAHRSupdate", setupImu, iterateImu);
+    benchRun("blackboxLogIteration", setupBlackbox, iterateBlackbox);
+
+    benchGpsParser();
+    benchBlackboxEncoding();
+
+    return 0;
+}
+
+// STUBS
+
+extern "C" {
+uint8_t armingFlags;
+uint16_t flightModeFlags;
+uint8_t stateFlags;
+uint16_t enableFlightMode(flightModeFlags_e mask) { return flightModeFlags |= mask; }
+uint16_t disableFlightMode(flightModeFlags_e mask) { return flightModeFlags &= ~mask; }
+
+int16_t debug[DEBUG16_VALUE_COUNT];
+uint8_t debugMode;
+const char * const buildDate = "Jan 01 1970";
+const char * const buildTime = "00:00:00";
+const char * const shortGitRevision = "bench";
+
+uint32_t currentTime;
+uint16_t averageSystemLoadPercent;
+uint16_t pidDeltaUs;
+cfTask_t cfTasks[TASK_COUNT] = {};
+void getTaskTimingWindow(const int, cfTaskTimingWindow_t *window) { memset(window, 0, sizeof(*window)); }
+
+uint32_t micros(void) { return benchMicros; }
+uint32_t millis(void) { return benchMicros / 1000; }
+void delay(uint32_t) {}
+
+bool feature(uint32_t mask) { return mask & FEATURE_BLACKBOX; }
+bool sensors(uint32_t mask) { return mask & (SENSOR_GYRO | SENSOR_ACC); }
+uint8_t getCurrentProfile(void) { return 0; }
+void saveConfigAndNotify(void) {}
+
+acc_t acc;
+int32_t magADC[XYZ_AXIS_COUNT];
+int32_t BaroAlt;
+int16_t GPS_angle[ANGLE_INDEX_COUNT];
+
+int16_t rcCommand[4];
+int16_t rcData[MAX_SUPPORTED_RC_CHANNEL_COUNT];
+uint16_t rssi;
+rxRuntimeConfig_t rxRuntimeConfig;
+bool rxIsReceivingSignal(void) { return true; }
+bool rxAreFlightChannelsValid(void) { return true; }
+uint32_t rxGetFrameAge(uint32_t) { return 0; }
+throttleStatus_e calculateThrottleStatus(rxConfig_t *, uint16_t) { return THROTTLE_HIGH; }
+bool rcModeIsActive(boxId_e) { return false; }
+bool rcModeIsActivationConditionPresent(modeActivationCondition_t *, boxId_e) { return false; }
+int32_t getRcStickDeflection(int32_t axis, uint16_t midrc) { return MIN(ABS(rcData[axis] - midrc), 500); }
+bool isRcAxisWithinDeadband(int32_t) { return false; }
+
+bool failsafeIsActive(void) { return false; }
+failsafePhase_e failsafePhase(void) { return FAILSAFE_IDLE; }
+
+void beeper(beeperMode_e) {}
+void beeperConfirmationBeeps(uint8_t) {}
+uint32_t getArmingBeepTimeMicros(void) { return 0; }
+
+uint16_t adcGetChannel(uint8_t) { return 0; }
+uint16_t getLatestVoltageForADCChannel(uint8_t) { return 0; }
+static voltageMeterConfig_t benchVoltageMeterConfig;
+voltageMeterConfig_t *getVoltageMeterConfig(const uint8_t) { return &benchVoltageMeterConfig; }
+static amperageMeter_t benchAmperageMeter;
+amperageMeter_t *getAmperageMeter(amperageMeter_e) { return &benchAmperageMeter; }
+
+void mspSerialAllocatePorts(void) {}
+
+const uint32_t baudRates[] = {0, 9600, 19200, 38400, 57600, 115200, 230400, 250000};
+
+static serialPort_t benchSerialPort;
+static serialPortConfig_t benchSerialPortConfig;
+
+serialPortConfig_t *findSerialPortConfig(uint16_t) { return &benchSerialPortConfig; }
+portSharing_e determinePortSharing(serialPortConfig_t *, serialPortFunction_e) { return PORTSHARING_NOT_SHARED; }
+serialPort_t *openSerialPort(serialPortIdentifier_e, serialPortFunction_e, serialReceiveCallbackPtr, uint32_t, portMode_t, portOptions_t)
+{
+    return &benchSerialPort;
+}
+void closeSerialPort(serialPort_t *) {}
+void serialWrite(serialPort_t *, uint8_t) { benchSerialBytes++; }
+uint8_t serialTxBytesFree(const serialPort_t *) { return 255; }
+bool isSerialTransmitBufferEmpty(const serialPort_t *) { return true; }
+}
@@ -0,0 +1,155 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Times the NMEA and UBX parsers, one iteration is one receiver epoch fed a byte at a time.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern "C" {
+    #include <platform.h>
+
+    #include "common/utils.h"
+
+    #include "config/parameter_group.h"
+
+    #include "io/gps.h"
+    #include "io/gps_parser.h"
+}
+
+#include "bench.h"
+
+// NMEA receiver output: GGA and RMC of two epochs, a GGA without fix and a GPGSV cycle
+static const char nmeaEpoch[] =
+    "$GPGGA,092750.000,5321.6802,N,00630.3372,W,1,08,1.03,61.7,M,55.2,M,,*46\r\n"
+    "$GPRMC,092750.000,A,5321.6802,N,00630.3372,W,22.4,54.7,191194,020.3,E*7C\r\n"
+    "$GNGGA,092751.000,4710.5186,N,01151.4252,E,2,12,0.87,1234.5,M,47.0,M,,*4A\r\n"
+    "$GNRMC,092751.000,A,4710.5186,N,01151.4252,E,0.5,273.1,191194,,*1F\r\n"
+    "$GPGGA,092752.000,,,,,0,00,99.99,,M,,M,,*5D\r\n"
+    "$GPGSV,3,1,11,03,03,111,00,04,15,270,00,06,01,010,00,13,06,292,00*74\r\n"
+    "$GPGSV,3,2,11,14,25,170,00,16,57,208,39,18,67,296,40,19,40,246,00*74\r\n"
+    "$GPGSV,3,3,11,22,42,067,42,24,14,311,43,27,05,244,00,,,,*4D\r\n";
+
+#define UBX_NAV_PVT_PAYLOAD_SIZE    92
+#define UBX_NAV_PVT_FRAME_SIZE      (UBX_NAV_PVT_PAYLOAD_SIZE + 8)
+#define UBX_EPOCHS                  1024    // a power of two so the iterations can wrap with a mask
+
+static uint8_t ubxEpochs[UBX_EPOCHS][UBX_NAV_PVT_FRAME_SIZE];
+
+static gpsParser_t parser;
+
+static int feed(const uint8_t *data, int length)
+{
+    int solutions = 0;
+
+    for (int i = 0; i < length; i++) {
+        if (gpsParserProcessByte(&parser, data[i]) == GPS_PARSE_SOLUTION) {
+            solutions++;
+        }
+    }
+    return solutions;
+}
+
+static void putU32(uint8_t *payload, int offset, uint32_t value)
+{
+    payload[offset] = value;
+    payload[offset + 1] = value >> 8;
+    payload[offset + 2] = value >> 16;
+    payload[offset + 3] = value >> 24;
+}
+
+static void ubxNavPvt(uint8_t *frame, uint32_t iTow, int32_t lat, int32_t lon, int32_t velNMms, int32_t velEMms)
+{
+    uint8_t *payload = &frame[6];
+    memset(payload, 0, UBX_NAV_PVT_PAYLOAD_SIZE);
+
+    putU32(payload, 0, iTow);
+    payload[20] = 3;                // 3D fix
+    payload[21] = 0x01;             // gnssFixOK
+    payload[23] = 14;               // numSV
+    putU32(payload, 24, lon);
+    putU32(payload, 28, lat);
+    putU32(payload, 32, 147000);
+    putU32(payload, 36, 100000);
+    putU32(payload, 48, velNMms);
+    putU32(payload, 52, velEMms);
+    putU32(payload, 60, 5000);      // gSpeed
+    putU32(payload, 64, 4500000);   // headMot, 45 degrees
+    putU32(payload, 68, 350);       // sAcc
+    payload[76] = 0x87;             // pDOP 1.35
+
+    frame[0] = 0xB5;
+    frame[1] = 0x62;
+    frame[2] = 0x01;
+    frame[3] = 0x07;
+    frame[4] = UBX_NAV_PVT_PAYLOAD_SIZE;
+    frame[5] = 0;
+
+    uint8_t ckA = 0, ckB = 0;
+    for (int i = 2; i < 6 + UBX_NAV_PVT_PAYLOAD_SIZE; i++) {
+        ckA += frame[i];
+        ckB += ckA;
+    }
+    frame[6 + UBX_NAV_PVT_PAYLOAD_SIZE] = ckA;
+    frame[7 + UBX_NAV_PVT_PAYLOAD_SIZE] = ckB;
+}
+
+static void setupNmea(void)
+{
+    gpsParserInit(&parser, GPS_NMEA);
+
+    if (feed((const uint8_t *)nmeaEpoch, strlen(nmeaEpoch)) != 3 || parser.stats.errors) {
+        fprintf(stderr, "NMEA parser did not decode the epoch\n");
+        exit(1);
+    }
+}
+
+static void iterateNmea(uint32_t iteration)
+{
+    UNUSED(iteration);
+
+    feed((const uint8_t *)nmeaEpoch, sizeof(nmeaEpoch) - 1);
+}
+
+static void setupUbloxNavPvt(void)
+{
+    for (int i = 0; i < UBX_EPOCHS; i++) {
+        ubxNavPvt(ubxEpochs[i], i * 100, 515638860 + i, -1599600 - i, i, -i);
+    }
+
+    gpsParserInit(&parser, GPS_UBLOX);
+
+    if (feed(ubxEpochs[0], UBX_NAV_PVT_FRAME_SIZE) != 1 || parser.stats.errors) {
+        fprintf(stderr, "UBX parser did not decode NAV-PVT\n");
+        exit(1);
+    }
+}
+
+static void iterateUbloxNavPvt(uint32_t iteration)
+{
+    feed(ubxEpochs[iteration & (UBX_EPOCHS - 1)], UBX_NAV_PVT_FRAME_SIZE);
+}
+
+void benchGpsParser(void)
+{
+    benchRun("gpsParser/nmeaEpoch", setupNmea, iterateNmea);
+    benchRun("gpsParser/ubxNavPvt", setupUbloxNavPvt, iterateUbloxNavPvt);
+}
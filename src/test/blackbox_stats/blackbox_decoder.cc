@@ -0,0 +1,618 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "blackbox_decoder.h"
+
+extern "C" {
+    #include "common/encoding.h"
+}
+
+// The firmware never writes a frame longer than this, a longer one means we lost sync
+#define BLACKBOX_MAX_FRAME_LENGTH 256
+
+// Each log of a file starts with this line, blackbox_decode and blackbox_replay number the logs by it too
+static const char logStartMarker[] = "H Product:";
+
+uint8_t blackboxReadByte(blackboxStream_t *stream)
+{
+    if (stream->pos >= stream->end) {
+        stream->overrun = true;
+        return 0;
+    }
+    return *stream->pos++;
+}
+
+uint32_t blackboxReadUnsignedVB(blackboxStream_t *stream)
+{
+    uint32_t result = 0;
+
+    // 5 bytes hold 35 bits, more than that is not something the firmware wrote
+    for (int shift = 0; shift < 35; shift += 7) {
+        uint8_t b = blackboxReadByte(stream);
+
+        result |= (uint32_t)(b & 0x7F) << shift;
+        if (b < 128) {
+            return result;
+        }
+    }
+
+    stream->overrun = true;
+    return 0;
+}
+
+int32_t blackboxReadSignedVB(blackboxStream_t *stream)
+{
+    return zigzagDecode(blackboxReadUnsignedVB(stream));
+}
+
+int16_t blackboxReadS16(blackboxStream_t *stream)
+{
+    uint16_t result = blackboxReadByte(stream);
+    result |= blackboxReadByte(stream) << 8;
+
+    return (int16_t)result;
+}
+
+uint32_t blackboxReadU32(blackboxStream_t *stream)
+{
+    uint32_t result = 0;
+
+    for (int i = 0; i < 4; i++) {
+        result |= (uint32_t)blackboxReadByte(stream) << (i * 8);
+    }
+
+    return result;
+}
+
+float blackboxReadFloat(blackboxStream_t *stream)
+{
+    return castIntBytesToFloat(blackboxReadU32(stream));
+}
+
+static int32_t signExtend(uint32_t value, int bits)
+{
+    return (int32_t)(value << (32 - bits)) >> (32 - bits);
+}
+
+/*
+ * The inverse of blackboxWriteTag2_3S32(), see there for the layouts.
+ */
+void blackboxReadTag2_3S32(blackboxStream_t *stream, int32_t *values)
+{
+    uint8_t leadByte = blackboxReadByte(stream);
+    uint8_t b;
+
+    switch (leadByte >> 6) {
+        case 0:
+            values[0] = signExtend((leadByte >> 4) & 0x03, 2);
+            values[1] = signExtend((leadByte >> 2) & 0x03, 2);
+            values[2] = signExtend(leadByte & 0x03, 2);
+        break;
+        case 1:
+            values[0] = signExtend(leadByte & 0x0F, 4);
+            b = blackboxReadByte(stream);
+            values[1] = signExtend(b >> 4, 4);
+            values[2] = signExtend(b & 0x0F, 4);
+        break;
+        case 2:
+            values[0] = signExtend(leadByte & 0x3F, 6);
+            values[1] = signExtend(blackboxReadByte(stream) & 0x3F, 6);
+            values[2] = signExtend(blackboxReadByte(stream) & 0x3F, 6);
+        break;
+        case 3:
+            for (int i = 0; i < 3; i++, leadByte >>= 2) {
+                int byteCount = (leadByte & 0x03) + 1;
+                uint32_t value = 0;
+
+                for (int j = 0; j < byteCount; j++) {
+                    value |= (uint32_t)blackboxReadByte(stream) << (j * 8);
+                }
+                values[i] = signExtend(value, byteCount * 8);
+            }
+        break;
+    }
+}
+
+/*
+ * The inverse of blackboxWriteTag8_4S16(), the fields are packed in nibbles with the high bits first.
+ */
+void blackboxReadTag8_4S16(blackboxStream_t *stream, int32_t *values)
+{
+    uint8_t selector = blackboxReadByte(stream);
+    uint8_t buffer = 0;
+    bool haveNibble = false;
+
+    for (int i = 0; i < 4; i++, selector >>= 2) {
+        uint32_t value = 0;
+
+        switch (selector & 0x03) {
+            case 0:
+                values[i] = 0;
+            break;
+            case 1:
+                if (haveNibble) {
+                    value = buffer & 0x0F;
+                    haveNibble = false;
+                } else {
+                    buffer = blackboxReadByte(stream);
+                    value = buffer >> 4;
+                    haveNibble = true;
+                }
+                values[i] = signExtend(value, 4);
+            break;
+            case 2:
+                if (haveNibble) {
+                    value = (buffer & 0x0F) << 4;
+                    buffer = blackboxReadByte(stream);
+                    value |= buffer >> 4;
+                } else {
+                    value = blackboxReadByte(stream);
+                }
+                values[i] = signExtend(value, 8);
+            break;
+            case 3:
+                if (haveNibble) {
+                    value = (buffer & 0x0F) << 12;
+                    value |= blackboxReadByte(stream) << 4;
+                    buffer = blackboxReadByte(stream);
+                    value |= buffer >> 4;
+                } else {
+                    value = blackboxReadByte(stream) << 8;
+                    value |= blackboxReadByte(stream);
+                }
+                values[i] = signExtend(value, 16);
+            break;
+        }
+    }
+}
+
+void blackboxReadTag8_8SVB(blackboxStream_t *stream, int32_t *values, int valueCount)
+{
+    if (valueCount == 1) {
+        values[0] = blackboxReadSignedVB(stream);
+        return;
+    }
+
+    uint8_t header = blackboxReadByte(stream);
+
+    for (int i = 0; i < valueCount; i++, header >>= 1) {
+        values[i] = (header & 0x01) ? blackboxReadSignedVB(stream) : 0;
+    }
+}
+
+int blackboxFieldIndex(const blackboxFrameDef_t *def, const char *name)
+{
+    for (int i = 0; i < def->fieldCount; i++) {
+        if (def->names[i] == name) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void parseFieldValues(uint8_t *dest, const std::string &list)
+{
+    const char *pos = list.c_str();
+
+    for (int i = 0; *pos && i < BLACKBOX_DECODER_MAX_FIELDS; i++) {
+        char *next;
+
+        dest[i] = (uint8_t)strtol(pos, &next, 10);
+        pos = *next == ',' ? next + 1 : next;
+    }
+}
+
+static void parseFieldHeader(blackboxLog_t *log, char frameType, const std::string &property, const std::string &value)
+{
+    blackboxFrameDef_t *def = &log->frameDefs[(uint8_t)frameType];
+
+    if (property == "name") {
+        size_t begin = 0;
+
+        def->names.clear();
+        while (begin <= value.size() && def->names.size() < BLACKBOX_DECODER_MAX_FIELDS) {
+            size_t comma = value.find(',', begin);
+            if (comma == std::string::npos) {
+                comma = value.size();
+            }
+            def->names.push_back(value.substr(begin, comma - begin));
+            begin = comma + 1;
+        }
+        def->fieldCount = def->names.size();
+    } else if (property == "signed") {
+        parseFieldValues(def->isSigned, value);
+    } else if (property == "predictor") {
+        parseFieldValues(def->predictor, value);
+    } else if (property == "encoding") {
+        parseFieldValues(def->encoding, value);
+    }
+}
+
+static void parseHeader(blackboxLog_t *log)
+{
+    const uint8_t *pos = log->start;
+
+    log->minthrottle = 0;
+    log->vbatref = 0;
+    log->frameIntervalI = 32;
+    log->frameIntervalPNum = 1;
+    log->frameIntervalPDenom = 1;
+
+    while (pos + 2 < log->end && pos[0] == 'H' && pos[1] == ' ') {
+        const uint8_t *lineEnd = (const uint8_t *)memchr(pos, '\n', log->end - pos);
+        if (!lineEnd) {
+            lineEnd = log->end;
+        }
+
+        std::string line((const char *)pos + 2, lineEnd - pos - 2);
+        size_t colon = line.find(':');
+
+        pos = lineEnd < log->end ? lineEnd + 1 : lineEnd;
+
+        if (colon == std::string::npos) {
+            continue;
+        }
+
+        std::string name = line.substr(0, colon);
+        std::string value = line.substr(colon + 1);
+
+        // "Field I name", the P frame only has predictor and encoding lines and shares the rest with the I frame
+        if (name.compare(0, 6, "Field ") == 0 && name.size() > 8 && name[7] == ' ') {
+            parseFieldHeader(log, name[6], name.substr(8), value);
+            continue;
+        }
+
+        log->headers[name] = value;
+
+        if (name == "minthrottle") {
+            log->minthrottle = strtoul(value.c_str(), NULL, 10);
+        } else if (name == "vbatref") {
+            log->vbatref = strtoul(value.c_str(), NULL, 10);
+        } else if (name == "I interval") {
+            log->frameIntervalI = std::max(strtoul(value.c_str(), NULL, 10), 1UL);
+        } else if (name == "P interval") {
+            char *slash;
+
+            log->frameIntervalPNum = strtoul(value.c_str(), &slash, 10);
+            log->frameIntervalPDenom = *slash == '/' ? std::max(strtoul(slash + 1, NULL, 10), 1UL) : 1;
+        }
+    }
+
+    log->frameDefs['P'].fieldCount = log->frameDefs['I'].fieldCount;
+    log->frameDefs['P'].names = log->frameDefs['I'].names;
+    memcpy(log->frameDefs['P'].isSigned, log->frameDefs['I'].isSigned, sizeof(log->frameDefs['P'].isSigned));
+
+    log->framesStart = pos;
+}
+
+std::vector<blackboxLog_t> blackboxFindLogs(const uint8_t *data, size_t length)
+{
+    std::vector<const uint8_t *> starts;
+    const uint8_t *end = data + length;
+    const size_t markerLength = strlen(logStartMarker);
+
+    for (const uint8_t *pos = data; pos + markerLength <= end; pos++) {
+        pos = (const uint8_t *)memmem(pos, end - pos, logStartMarker, markerLength);
+        if (!pos) {
+            break;
+        }
+        starts.push_back(pos);
+    }
+
+    std::vector<blackboxLog_t> logs(starts.size());
+
+    for (size_t i = 0; i < starts.size(); i++) {
+        logs[i].start = starts[i];
+        logs[i].end = i + 1 < starts.size() ? starts[i + 1] : end;
+        parseHeader(&logs[i]);
+    }
+
+    return logs;
+}
+
+static bool isFrameMarker(uint8_t c)
+{
+    switch (c) {
+        case 'I': case 'P': case 'S': case 'G': case 'H': case 'T': case 'E':
+            return true;
+        default:
+            return false;
+    }
+}
+
+typedef struct decoderState_s {
+    const blackboxLog_t *log;
+
+    int32_t mainHistory[2][BLACKBOX_DECODER_MAX_FIELDS];   // the last two main frames, both the "I" frame after one
+    bool mainHistoryValid;
+    int motor0Index;
+    int timeIndex;
+
+    int32_t gpsHome[2];
+    bool gpsHomeValid;
+} decoderState_t;
+
+/*
+ * Reads the encoded values of the fields of a frame, fields of the grouped encodings are read in one go.
+ */
+static void readFrameValues(blackboxStream_t *stream, const blackboxFrameDef_t *def, const uint8_t *encoding, int32_t *raw)
+{
+    int i = 0;
+
+    while (i < def->fieldCount) {
+        int groupCount;
+
+        switch (encoding[i]) {
+            case FLIGHT_LOG_FIELD_ENCODING_SIGNED_VB:
+                raw[i++] = blackboxReadSignedVB(stream);
+            break;
+            case FLIGHT_LOG_FIELD_ENCODING_UNSIGNED_VB:
+                raw[i++] = (int32_t)blackboxReadUnsignedVB(stream);
+            break;
+            case FLIGHT_LOG_FIELD_ENCODING_NEG_14BIT:
+                raw[i++] = -signExtend(blackboxReadUnsignedVB(stream) & 0x3FFF, 14);
+            break;
+            case FLIGHT_LOG_FIELD_ENCODING_TAG2_3S32:
+            {
+                int32_t values[3];
+
+                blackboxReadTag2_3S32(stream, values);
+                for (int j = 0; j < 3 && i < def->fieldCount; j++) {
+                    raw[i++] = values[j];
+                }
+            }
+            break;
+            case FLIGHT_LOG_FIELD_ENCODING_TAG8_4S16:
+            {
+                int32_t values[4];
+
+                blackboxReadTag8_4S16(stream, values);
+                for (int j = 0; j < 4 && i < def->fieldCount; j++) {
+                    raw[i++] = values[j];
+                }
+            }
+            break;
+            case FLIGHT_LOG_FIELD_ENCODING_TAG8_8SVB:
+                // Up to 8 consecutive fields of this encoding share the header byte
+                for (groupCount = 1; groupCount < 8 && i + groupCount < def->fieldCount
+                        && encoding[i + groupCount] == FLIGHT_LOG_FIELD_ENCODING_TAG8_8SVB; groupCount++);
+
+                blackboxReadTag8_8SVB(stream, raw + i, groupCount);
+                i += groupCount;
+            break;
+            case FLIGHT_LOG_FIELD_ENCODING_NULL:
+            default:
+                raw[i++] = 0;
+            break;
+        }
+    }
+}
+
+/*
+ * The loop iteration of the next "P" frame, which skips the iterations blackboxShouldLogPFrame() does not log.
+ */
+static uint32_t predictIteration(const blackboxLog_t *log, uint32_t lastIteration)
+{
+    uint32_t iteration = lastIteration + 1;
+
+    for (uint32_t i = 0; i < log->frameIntervalI; i++, iteration++) {
+        uint32_t pFrameIndex = iteration % log->frameIntervalI;
+
+        if (pFrameIndex == 0
+                || (pFrameIndex + log->frameIntervalPNum - 1) % log->frameIntervalPDenom < log->frameIntervalPNum) {
+            break;
+        }
+    }
+
+    return iteration;
+}
+
+static int32_t predictField(decoderState_t *state, const blackboxFrameDef_t *def, const uint8_t *predictor, int field,
+    const int32_t *current, uint32_t lastMainFrameTime, int *homeCoordIndex)
+{
+    const blackboxLog_t *log = state->log;
+    const int32_t *previous = state->mainHistory[0];
+    const int32_t *previous2 = state->mainHistory[1];
+
+    switch (predictor[field]) {
+        case FLIGHT_LOG_FIELD_PREDICTOR_PREVIOUS:
+            return previous[field];
+        case FLIGHT_LOG_FIELD_PREDICTOR_STRAIGHT_LINE:
+            return (int32_t)(2 * (uint32_t)previous[field] - (uint32_t)previous2[field]);
+        case FLIGHT_LOG_FIELD_PREDICTOR_AVERAGE_2:
+            if (def->isSigned[field]) {
+                return (int32_t)(((int64_t)previous[field] + previous2[field]) / 2);
+            }
+            return (int32_t)(((uint64_t)(uint32_t)previous[field] + (uint32_t)previous2[field]) / 2);
+        case FLIGHT_LOG_FIELD_PREDICTOR_MINTHROTTLE:
+            return log->minthrottle;
+        case FLIGHT_LOG_FIELD_PREDICTOR_MOTOR_0:
+            return state->motor0Index >= 0 && state->motor0Index < field ? current[state->motor0Index] : 0;
+        case FLIGHT_LOG_FIELD_PREDICTOR_INC:
+            return (int32_t)predictIteration(log, previous[field]);
+        case FLIGHT_LOG_FIELD_PREDICTOR_HOME_COORD:
+            return state->gpsHomeValid && *homeCoordIndex < 2 ? state->gpsHome[(*homeCoordIndex)++] : 0;
+        case FLIGHT_LOG_FIELD_PREDICTOR_1500:
+            return 1500;
+        case FLIGHT_LOG_FIELD_PREDICTOR_VBATREF:
+            return log->vbatref;
+        case FLIGHT_LOG_FIELD_PREDICTOR_LAST_MAIN_FRAME_TIME:
+            return (int32_t)lastMainFrameTime;
+        case FLIGHT_LOG_FIELD_PREDICTOR_0:
+        default:
+            return 0;
+    }
+}
+
+static void readEvent(blackboxStream_t *stream, flightLogEvent_t *event)
+{
+    event->event = (FlightLogEvent)blackboxReadByte(stream);
+
+    switch (event->event) {
+        case FLIGHT_LOG_EVENT_SYNC_BEEP:
+            event->data.syncBeep.time = blackboxReadUnsignedVB(stream);
+        break;
+        case FLIGHT_LOG_EVENT_INFLIGHT_ADJUSTMENT:
+        {
+            flightLogEvent_inflightAdjustment_t adjustment;
+            uint8_t function = blackboxReadByte(stream);
+
+            adjustment.floatFlag = function & FLIGHT_LOG_EVENT_INFLIGHT_ADJUSTMENT_FUNCTION_FLOAT_VALUE_FLAG;
+            adjustment.adjustmentFunction = function & ~FLIGHT_LOG_EVENT_INFLIGHT_ADJUSTMENT_FUNCTION_FLOAT_VALUE_FLAG;
+            adjustment.newValue = 0;
+            adjustment.newFloatValue = 0;
+            if (adjustment.floatFlag) {
+                adjustment.newFloatValue = blackboxReadFloat(stream);
+            } else {
+                adjustment.newValue = blackboxReadSignedVB(stream);
+            }
+
+            // blackboxLogEvent() falls through to the G-Tune result after an adjustment, so skip over that too
+            blackboxReadByte(stream);
+            blackboxReadSignedVB(stream);
+            blackboxReadS16(stream);
+
+            event->data.inflightAdjustment = adjustment;
+        }
+        break;
+        case FLIGHT_LOG_EVENT_GTUNE_RESULT:
+            event->data.gtuneCycleResult.gtuneAxis = blackboxReadByte(stream);
+            event->data.gtuneCycleResult.gtuneGyroAVG = blackboxReadSignedVB(stream);
+            event->data.gtuneCycleResult.gtuneNewP = blackboxReadS16(stream);
+        break;
+        case FLIGHT_LOG_EVENT_LOGGING_RESUME:
+            event->data.loggingResume.logIteration = blackboxReadUnsignedVB(stream);
+            event->data.loggingResume.currentTime = blackboxReadUnsignedVB(stream);
+        break;
+        case FLIGHT_LOG_EVENT_LOG_END:
+        {
+            static const char endMessage[] = "End of log";
+
+            // The message and its terminator, anything else means this was not really an event
+            for (size_t i = 0; i < sizeof(endMessage); i++) {
+                if (blackboxReadByte(stream) != (uint8_t)endMessage[i]) {
+                    stream->overrun = true;
+                }
+            }
+        }
+        break;
+        default:
+            stream->overrun = true;
+        break;
+    }
+}
+
+void blackboxDecodeLog(const blackboxLog_t *log, blackboxFrameHandler onFrame, blackboxEventHandler onEvent,
+    void *context, blackboxDecodeStats_t *stats)
+{
+    decoderState_t state;
+    blackboxStream_t stream = { log->framesStart, log->end, false };
+    const blackboxFrameDef_t *mainDef = &log->frameDefs['I'];
+    uint32_t lastMainFrameTime = 0;
+
+    memset(stats, 0, sizeof(*stats));
+    memset(&state, 0, sizeof(state));
+    state.log = log;
+    state.motor0Index = blackboxFieldIndex(mainDef, "motor[0]");
+    state.timeIndex = blackboxFieldIndex(mainDef, "time");
+
+    while (stream.pos < stream.end) {
+        const uint8_t *frameStart = stream.pos;
+        const char frameType = blackboxReadByte(&stream);
+        const blackboxFrameDef_t *def = &log->frameDefs[(uint8_t)frameType];
+        int32_t raw[BLACKBOX_DECODER_MAX_FIELDS];
+        int32_t values[BLACKBOX_DECODER_MAX_FIELDS];
+        flightLogEvent_t event;
+        int homeCoordIndex = 0;
+
+        if (!isFrameMarker(frameType) || (frameType != 'E' && def->fieldCount == 0)) {
+            // Lost sync, look for the start of the next frame
+            stats->skippedByteCount++;
+            continue;
+        }
+
+        if (frameType == 'E') {
+            readEvent(&stream, &event);
+        } else {
+            readFrameValues(&stream, def, def->encoding, raw);
+            for (int i = 0; i < def->fieldCount; i++) {
+                int32_t prediction = predictField(&state, def, def->predictor, i, values, lastMainFrameTime, &homeCoordIndex);
+
+                values[i] = (int32_t)((uint32_t)raw[i] + (uint32_t)prediction);
+            }
+        }
+
+        /*
+         * The firmware has nothing to mark the end of a frame with, but a frame is followed by the start of another
+         * one. Anything else means the frame was damaged and what was decoded from it is not to be trusted.
+         */
+        if (stream.overrun || stream.pos - frameStart > BLACKBOX_MAX_FRAME_LENGTH
+                || (stream.pos < stream.end && !isFrameMarker(*stream.pos) && !(frameType == 'E' && event.event == FLIGHT_LOG_EVENT_LOG_END))) {
+            stats->corruptFrameCount++;
+            state.mainHistoryValid = false;
+            stream.pos = frameStart + 1;
+            stream.overrun = false;
+            continue;
+        }
+
+        switch (frameType) {
+            case 'I':
+                memcpy(state.mainHistory[0], values, sizeof(values[0]) * def->fieldCount);
+                memcpy(state.mainHistory[1], values, sizeof(values[0]) * def->fieldCount);
+                state.mainHistoryValid = true;
+            break;
+            case 'P':
+                if (!state.mainHistoryValid) {
+                    // Its predictions came from a frame that was lost, wait for the next "I" frame
+                    continue;
+                }
+                memcpy(state.mainHistory[1], state.mainHistory[0], sizeof(values[0]) * def->fieldCount);
+                memcpy(state.mainHistory[0], values, sizeof(values[0]) * def->fieldCount);
+            break;
+            case 'H':
+                state.gpsHome[0] = values[0];
+                state.gpsHome[1] = def->fieldCount > 1 ? values[1] : 0;
+                state.gpsHomeValid = true;
+            break;
+            case 'E':
+                stats->frameCount[(uint8_t)frameType]++;
+                if (onEvent) {
+                    onEvent(context, &event);
+                }
+                if (event.event == FLIGHT_LOG_EVENT_LOG_END) {
+                    stats->reachedLogEnd = true;
+                    return;
+                }
+            continue;
+        }
+
+        if ((frameType == 'I' || frameType == 'P') && state.timeIndex >= 0) {
+            lastMainFrameTime = values[state.timeIndex];
+        }
+
+        stats->frameCount[(uint8_t)frameType]++;
+        if (onFrame) {
+            onFrame(context, frameType, values, def->fieldCount);
+        }
+    }
+}
@@ -0,0 +1,100 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+extern "C" {
+    #include "blackbox/blackbox_fielddefs.h"
+}
+
+/*
+ * Decodes blackbox logs on the host. The layout of each frame type is read from the "H Field" lines the firmware writes
+ * from its field tables, and the predictors and encodings are the FLIGHT_LOG_FIELD_* values of the firmware, so a log
+ * decodes with the same definitions it was encoded with.
+ */
+
+#define BLACKBOX_DECODER_MAX_FIELDS 128
+
+typedef struct blackboxStream_s {
+    const uint8_t *pos;
+    const uint8_t *end;
+    bool overrun;           // set once a read went past the end, the values read are then 0
+} blackboxStream_t;
+
+uint8_t blackboxReadByte(blackboxStream_t *stream);
+uint32_t blackboxReadUnsignedVB(blackboxStream_t *stream);
+int32_t blackboxReadSignedVB(blackboxStream_t *stream);
+int16_t blackboxReadS16(blackboxStream_t *stream);
+uint32_t blackboxReadU32(blackboxStream_t *stream);
+float blackboxReadFloat(blackboxStream_t *stream);
+void blackboxReadTag2_3S32(blackboxStream_t *stream, int32_t *values);
+void blackboxReadTag8_4S16(blackboxStream_t *stream, int32_t *values);
+void blackboxReadTag8_8SVB(blackboxStream_t *stream, int32_t *values, int valueCount);
+
+typedef struct blackboxFrameDef_s {
+    int fieldCount;
+    std::vector<std::string> names;
+    uint8_t isSigned[BLACKBOX_DECODER_MAX_FIELDS];
+    uint8_t predictor[BLACKBOX_DECODER_MAX_FIELDS];
+    uint8_t encoding[BLACKBOX_DECODER_MAX_FIELDS];
+} blackboxFrameDef_t;
+
+typedef struct blackboxLog_s {
+    const uint8_t *start;   // the log within the file, from its first header line to the start of the next log
+    const uint8_t *end;
+    const uint8_t *framesStart;                     // the first byte after the header lines
+
+    std::map<std::string, std::string> headers;     // the "H name:value" lines other than the field definitions
+    blackboxFrameDef_t frameDefs[256];              // indexed by the frame type character
+
+    uint32_t minthrottle;
+    uint32_t vbatref;
+    uint32_t frameIntervalI;
+    uint32_t frameIntervalPNum;
+    uint32_t frameIntervalPDenom;
+} blackboxLog_t;
+
+int blackboxFieldIndex(const blackboxFrameDef_t *def, const char *name);
+
+/*
+ * Finds the logs in a file, a file from flash or an OpenLog may hold several one after the other.
+ */
+std::vector<blackboxLog_t> blackboxFindLogs(const uint8_t *data, size_t length);
+
+typedef struct blackboxDecodeStats_s {
+    uint32_t frameCount[256];
+    uint32_t corruptFrameCount;
+    uint32_t skippedByteCount;
+    bool reachedLogEnd;
+} blackboxDecodeStats_t;
+
+/*
+ * Called for each decoded frame with the values of the fields of its frame definition. The values of a 'P' frame are
+ * those of the fields of the 'I' definition once the predictions are added back, like those of an 'I' frame.
+ */
+typedef void (*blackboxFrameHandler)(void *context, char frameType, const int32_t *values, int valueCount);
+typedef void (*blackboxEventHandler)(void *context, const flightLogEvent_t *event);
+
+void blackboxDecodeLog(const blackboxLog_t *log, blackboxFrameHandler onFrame, blackboxEventHandler onEvent,
+    void *context, blackboxDecodeStats_t *stats);
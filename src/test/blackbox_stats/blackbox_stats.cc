@@ -0,0 +1,587 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Decodes archives of blackbox logs on every core and prints a summary of each flight as one JSON object per line:
+ * the loop time, the scheduler timing, how often the PID output saturated, where the tail servo spent its time, the
+ * gyro noise spectrum and the vibration the accelerometer saw.
+ */
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <atomic>
+#include <complex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "blackbox_decoder.h"
+
+extern "C" {
+    #include "common/encoding.h"
+    #include "common/utils.h"
+}
+
+#define AXIS_COUNT 3
+#define TAIL_SERVO_BIN_DEGREES 5
+#define TAIL_SERVO_BIN_COUNT (180 / TAIL_SERVO_BIN_DEGREES)
+// Noise below this is flying rather than vibration
+#define NOISE_MIN_FREQUENCY_HZ 20
+
+static struct {
+    unsigned jobs;
+    unsigned fftSize;
+} statsOptions = { 0, 256 };
+
+typedef struct mappedFile_s {
+    const char *path;
+    const uint8_t *data;
+    size_t length;
+    std::vector<blackboxLog_t> logs;
+} mappedFile_t;
+
+/*
+ * Power spectral density by Welch's method, the average over Hann windowed segments that overlap by half.
+ */
+class Spectrum {
+public:
+    explicit Spectrum(unsigned size) : size(size), window(size), power(size / 2 + 1), segmentCount(0)
+    {
+        segment.reserve(size);
+        windowPower = 0;
+        for (unsigned i = 0; i < size; i++) {
+            window[i] = 0.5 - 0.5 * cos(2 * M_PI * i / size);
+            windowPower += window[i] * window[i];
+        }
+    }
+
+    void add(double sample)
+    {
+        segment.push_back(sample);
+        if (segment.size() == size) {
+            transform();
+            segment.erase(segment.begin(), segment.begin() + size / 2);
+        }
+    }
+
+    // The samples either side of a gap in the log are not a continuous signal
+    void restart()
+    {
+        segment.clear();
+    }
+
+    unsigned segments() const
+    {
+        return segmentCount;
+    }
+
+    // In units squared per Hz of the samples
+    double density(unsigned bin, double sampleRate) const
+    {
+        const double oneSided = bin == 0 || bin == size / 2 ? 1 : 2;
+
+        return segmentCount ? oneSided * power[bin] / (segmentCount * sampleRate * windowPower) : 0;
+    }
+
+private:
+    void transform()
+    {
+        std::vector<std::complex<double> > x(size);
+        double mean = 0;
+
+        for (double sample : segment) {
+            mean += sample;
+        }
+        mean /= size;
+        for (unsigned i = 0; i < size; i++) {
+            x[i] = (segment[i] - mean) * window[i];
+        }
+
+        // In place radix-2 FFT
+        for (unsigned i = 1, j = 0; i < size; i++) {
+            unsigned bit = size >> 1;
+            for (; j & bit; bit >>= 1) {
+                j ^= bit;
+            }
+            j ^= bit;
+            if (i < j) {
+                std::swap(x[i], x[j]);
+            }
+        }
+        for (unsigned length = 2; length <= size; length <<= 1) {
+            const std::complex<double> step = std::polar(1.0, -2 * M_PI / length);
+
+            for (unsigned i = 0; i < size; i += length) {
+                std::complex<double> w(1);
+
+                for (unsigned j = 0; j < length / 2; j++, w *= step) {
+                    const std::complex<double> even = x[i + j];
+                    const std::complex<double> odd = x[i + j + length / 2] * w;
+
+                    x[i + j] = even + odd;
+                    x[i + j + length / 2] = even - odd;
+                }
+            }
+        }
+
+        for (unsigned bin = 0; bin <= size / 2; bin++) {
+            power[bin] += std::norm(x[bin]);
+        }
+        segmentCount++;
+    }
+
+    const unsigned size;
+    std::vector<double> window;
+    double windowPower;
+    std::vector<double> power;
+    std::vector<double> segment;
+    unsigned segmentCount;
+};
+
+typedef struct flightStats_s {
+    const blackboxLog_t *log;
+
+    int timeIndex;
+    int iterationIndex;
+    int saturationIndex;
+    int tailServoIndex;
+    int gyroIndex[AXIS_COUNT];
+    int accIndex[AXIS_COUNT];
+    int timingIndex[5];
+
+    uint32_t expectedIterationStep;
+
+    bool haveMainFrame;
+    uint32_t firstTime;
+    uint32_t lastTime;
+    uint32_t lastIteration;
+
+    // Of the time per loop iteration between main frames, in microseconds
+    uint32_t loopCount;
+    double loopSum, loopSumSquares, loopMin, loopMax;
+    // Of the time between main frames, the sample rate of the spectra
+    uint64_t frameIntervalSum;
+    uint32_t frameIntervalCount;
+
+    uint32_t mainFrameCount;
+    uint32_t saturatedFrames[AXIS_COUNT];
+    uint32_t tailServoHistogram[TAIL_SERVO_BIN_COUNT];
+
+    uint32_t timingFrameCount;
+    uint32_t loopDeltaMin, loopDeltaMax, rxFrameAgeMax;
+    uint32_t systemLoadMax;
+    uint64_t systemLoadSum;
+
+    std::vector<Spectrum> gyroSpectrum;
+    std::vector<Spectrum> accSpectrum;
+} flightStats_t;
+
+static void onMainFrame(flightStats_t *stats, const int32_t *values)
+{
+    const uint32_t time = values[stats->timeIndex];
+    const uint32_t iteration = values[stats->iterationIndex];
+
+    if (stats->haveMainFrame) {
+        const uint32_t iterations = iteration - stats->lastIteration;
+        const uint32_t interval = time - stats->lastTime;
+
+        // A pause, or frames lost to corruption
+        if (iterations == 0 || iterations > 2 * stats->expectedIterationStep) {
+            for (int axis = 0; axis < AXIS_COUNT; axis++) {
+                stats->gyroSpectrum[axis].restart();
+                stats->accSpectrum[axis].restart();
+            }
+        } else {
+            const double loopTime = (double)interval / iterations;
+
+            stats->loopSum += loopTime;
+            stats->loopSumSquares += loopTime * loopTime;
+            stats->loopMin = stats->loopCount ? fmin(stats->loopMin, loopTime) : loopTime;
+            stats->loopMax = stats->loopCount ? fmax(stats->loopMax, loopTime) : loopTime;
+            stats->loopCount++;
+
+            stats->frameIntervalSum += interval;
+            stats->frameIntervalCount++;
+        }
+    } else {
+        stats->firstTime = time;
+        stats->haveMainFrame = true;
+    }
+    stats->lastTime = time;
+    stats->lastIteration = iteration;
+
+    stats->mainFrameCount++;
+    if (stats->saturationIndex >= 0) {
+        for (int axis = 0; axis < AXIS_COUNT; axis++) {
+            if (values[stats->saturationIndex] & (1 << axis)) {
+                stats->saturatedFrames[axis]++;
+            }
+        }
+    }
+
+    if (stats->tailServoIndex >= 0) {
+        // The servo angle is logged in decidegrees
+        int bin = values[stats->tailServoIndex] / (10 * TAIL_SERVO_BIN_DEGREES);
+        stats->tailServoHistogram[bin < 0 ? 0 : bin >= TAIL_SERVO_BIN_COUNT ? TAIL_SERVO_BIN_COUNT - 1 : bin]++;
+    }
+
+    for (int axis = 0; axis < AXIS_COUNT; axis++) {
+        if (stats->gyroIndex[axis] >= 0) {
+            stats->gyroSpectrum[axis].add(values[stats->gyroIndex[axis]]);
+        }
+        if (stats->accIndex[axis] >= 0) {
+            stats->accSpectrum[axis].add(values[stats->accIndex[axis]]);
+        }
+    }
+}
+
+static void onTimingFrame(flightStats_t *stats, const int32_t *values)
+{
+    const uint32_t loopDeltaMin = values[stats->timingIndex[1]];
+    const uint32_t loopDeltaMax = values[stats->timingIndex[2]];
+    const uint32_t systemLoad = values[stats->timingIndex[3]];
+    const uint32_t rxFrameAge = values[stats->timingIndex[4]];
+
+    stats->loopDeltaMin = stats->timingFrameCount ? std::min(stats->loopDeltaMin, loopDeltaMin) : loopDeltaMin;
+    stats->loopDeltaMax = std::max(stats->loopDeltaMax, loopDeltaMax);
+    stats->systemLoadSum += systemLoad;
+    stats->systemLoadMax = std::max(stats->systemLoadMax, systemLoad);
+    stats->rxFrameAgeMax = std::max(stats->rxFrameAgeMax, rxFrameAge);
+    stats->timingFrameCount++;
+}
+
+static void onFrame(void *context, char frameType, const int32_t *values, int valueCount)
+{
+    flightStats_t *stats = (flightStats_t *)context;
+
+    UNUSED(valueCount);
+
+    if ((frameType == 'I' || frameType == 'P') && stats->timeIndex >= 0 && stats->iterationIndex >= 0) {
+        onMainFrame(stats, values);
+    } else if (frameType == 'T' && stats->timingIndex[4] >= 0) {
+        onTimingFrame(stats, values);
+    }
+}
+
+static std::string jsonString(const char *s)
+{
+    std::string result = "\"";
+
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') {
+            result += '\\';
+            result += *s;
+        } else if ((uint8_t)*s < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", *s);
+            result += escaped;
+        } else {
+            result += *s;
+        }
+    }
+
+    return result + "\"";
+}
+
+static std::string format(const char *fmt, ...) __attribute__ ((format (printf, 1, 2)));
+
+static std::string format(const char *fmt, ...)
+{
+    char buffer[256];
+    va_list va;
+
+    va_start(va, fmt);
+    vsnprintf(buffer, sizeof(buffer), fmt, va);
+    va_end(va);
+
+    return buffer;
+}
+
+static uint32_t headerValue(const blackboxLog_t *log, const char *name)
+{
+    std::map<std::string, std::string>::const_iterator it = log->headers.find(name);
+
+    return it == log->headers.end() ? 0 : strtoul(it->second.c_str(), NULL, 0);
+}
+
+/*
+ * The spectrum of the three axes, with the RMS of the noise above NOISE_MIN_FREQUENCY_HZ in the given unit.
+ */
+static std::string spectrumJson(const std::vector<Spectrum> &spectrum, double sampleRate, double scale, bool withDensity)
+{
+    const unsigned binCount = statsOptions.fftSize / 2 + 1;
+    const double binWidth = sampleRate / statsOptions.fftSize;
+    std::string peaks, rms, density;
+
+    for (int axis = 0; axis < AXIS_COUNT; axis++) {
+        double noisePower = 0;
+        double peak = 0;
+        unsigned peakBin = 0;
+
+        density += axis ? ",[" : "[";
+        for (unsigned bin = 0; bin < binCount; bin++) {
+            const double psd = spectrum[axis].density(bin, sampleRate) * scale * scale;
+
+            if (bin * binWidth >= NOISE_MIN_FREQUENCY_HZ) {
+                noisePower += psd * binWidth;
+                if (psd > peak) {
+                    peak = psd;
+                    peakBin = bin;
+                }
+            }
+            density += format(bin ? ",%.4g" : "%.4g", psd);
+        }
+        density += "]";
+
+        peaks += format(axis ? ",%.1f" : "%.1f", peakBin * binWidth);
+        rms += format(axis ? ",%.4g" : "%.4g", sqrt(noisePower));
+    }
+
+    std::string result = format("\"segments\":%u,\"peak_hz\":[%s],\"rms\":[%s]", spectrum[0].segments(), peaks.c_str(), rms.c_str());
+    if (withDensity) {
+        result += format(",\"bin_hz\":%.3f,\"psd\":[", binWidth) + density + "]";
+    }
+    return result;
+}
+
+static std::string flightJson(const mappedFile_t *file, int logIndex, const flightStats_t *stats,
+    const blackboxDecodeStats_t *decodeStats)
+{
+    const blackboxLog_t *log = stats->log;
+    std::string json = "{\"file\":" + jsonString(file->path) + format(",\"log\":%d", logIndex + 1);
+
+    json += ",\"frames\":{";
+    const char frameTypes[] = "IPSGHTE";
+    for (const char *type = frameTypes; *type; type++) {
+        json += format("%s\"%c\":%u", type == frameTypes ? "" : ",", *type, decodeStats->frameCount[(uint8_t)*type]);
+    }
+    json += format("},\"corrupt_frames\":%u,\"complete\":%s", decodeStats->corruptFrameCount, decodeStats->reachedLogEnd ? "true" : "false");
+
+    if (!stats->haveMainFrame) {
+        return json + "}";
+    }
+
+    json += format(",\"duration_s\":%.3f", (stats->lastTime - stats->firstTime) / 1e6);
+
+    json += format(",\"looptime_us\":{\"header\":%u", headerValue(log, "looptime"));
+    if (stats->loopCount) {
+        const double mean = stats->loopSum / stats->loopCount;
+        const double variance = stats->loopSumSquares / stats->loopCount - mean * mean;
+
+        json += format(",\"mean\":%.2f,\"min\":%.2f,\"max\":%.2f,\"stddev\":%.2f",
+            mean, stats->loopMin, stats->loopMax, variance > 0 ? sqrt(variance) : 0);
+    }
+    json += "}";
+
+    if (stats->timingFrameCount) {
+        json += format(",\"timing\":{\"frames\":%u,\"loop_delta_min_us\":%u,\"loop_delta_max_us\":%u,"
+            "\"system_load_mean_percent\":%.1f,\"system_load_max_percent\":%u,\"rx_frame_age_max_us\":%u}",
+            stats->timingFrameCount, stats->loopDeltaMin, stats->loopDeltaMax,
+            (double)stats->systemLoadSum / stats->timingFrameCount, stats->systemLoadMax, stats->rxFrameAgeMax);
+    }
+
+    if (stats->saturationIndex >= 0) {
+        json += format(",\"saturation\":{\"frames\":[%u,%u,%u],\"percent\":[%.2f,%.2f,%.2f]}",
+            stats->saturatedFrames[0], stats->saturatedFrames[1], stats->saturatedFrames[2],
+            100.0 * stats->saturatedFrames[0] / stats->mainFrameCount,
+            100.0 * stats->saturatedFrames[1] / stats->mainFrameCount,
+            100.0 * stats->saturatedFrames[2] / stats->mainFrameCount);
+    }
+
+    if (stats->tailServoIndex >= 0) {
+        json += format(",\"tail_servo\":{\"bin_degrees\":%d,\"frames\":[", TAIL_SERVO_BIN_DEGREES);
+        for (int bin = 0; bin < TAIL_SERVO_BIN_COUNT; bin++) {
+            json += format(bin ? ",%u" : "%u", stats->tailServoHistogram[bin]);
+        }
+        json += "]}";
+    }
+
+    if (stats->frameIntervalCount && stats->gyroSpectrum[0].segments()) {
+        const double sampleRate = 1e6 * stats->frameIntervalCount / stats->frameIntervalSum;
+        const float gyroScale = castIntBytesToFloat(headerValue(log, "gyro.scale"));
+        const uint32_t acc1G = headerValue(log, "acc_1G");
+
+        // gyroADC times gyro.scale is degrees per second, accSmooth is acc_1G to 1G
+        json += format(",\"sample_rate_hz\":%.1f", sampleRate);
+        json += ",\"gyro_noise_dps\":{" + spectrumJson(stats->gyroSpectrum, sampleRate, gyroScale > 0 ? gyroScale : 1, true) + "}";
+        json += ",\"vibration_g\":{" + spectrumJson(stats->accSpectrum, sampleRate, acc1G ? 1.0 / acc1G : 1, false) + "}";
+    }
+
+    return json + "}";
+}
+
+static std::string summariseFlight(const mappedFile_t *file, int logIndex)
+{
+    const blackboxLog_t *log = &file->logs[logIndex];
+    const blackboxFrameDef_t *mainDef = &log->frameDefs['I'];
+    const blackboxFrameDef_t *timingDef = &log->frameDefs['T'];
+    static const char * const timingFieldNames[] = { "time", "loopDeltaMin", "loopDeltaMax", "systemLoad", "rxFrameAgeMax" };
+    flightStats_t stats = flightStats_t();
+    blackboxDecodeStats_t decodeStats;
+
+    stats.log = log;
+    stats.timeIndex = blackboxFieldIndex(mainDef, "time");
+    stats.iterationIndex = blackboxFieldIndex(mainDef, "loopIteration");
+    stats.saturationIndex = blackboxFieldIndex(mainDef, "saturation");
+    stats.tailServoIndex = blackboxFieldIndex(mainDef, "servo[5]");
+    for (int axis = 0; axis < AXIS_COUNT; axis++) {
+        char name[16];
+
+        snprintf(name, sizeof(name), "gyroADC[%d]", axis);
+        stats.gyroIndex[axis] = blackboxFieldIndex(mainDef, name);
+        snprintf(name, sizeof(name), "accSmooth[%d]", axis);
+        stats.accIndex[axis] = blackboxFieldIndex(mainDef, name);
+
+        stats.gyroSpectrum.push_back(Spectrum(statsOptions.fftSize));
+        stats.accSpectrum.push_back(Spectrum(statsOptions.fftSize));
+    }
+    for (unsigned i = 0; i < ARRAYLEN(timingFieldNames); i++) {
+        stats.timingIndex[i] = blackboxFieldIndex(timingDef, timingFieldNames[i]);
+    }
+    // The most iterations between two logged main frames
+    stats.expectedIterationStep = log->frameIntervalPNum ? (log->frameIntervalPDenom + log->frameIntervalPNum - 1) / log->frameIntervalPNum : log->frameIntervalI;
+
+    blackboxDecodeLog(log, onFrame, NULL, &stats, &decodeStats);
+
+    return flightJson(file, logIndex, &stats, &decodeStats);
+}
+
+static bool mapFile(mappedFile_t *file)
+{
+    struct stat status;
+    int fd = open(file->path, O_RDONLY);
+
+    if (fd < 0 || fstat(fd, &status) != 0) {
+        fprintf(stderr, "Could not open %s\n", file->path);
+        if (fd >= 0) {
+            close(fd);
+        }
+        return false;
+    }
+
+    file->length = status.st_size;
+    file->data = NULL;
+    if (file->length) {
+        void *data = mmap(NULL, file->length, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (data == MAP_FAILED) {
+            fprintf(stderr, "Could not map %s\n", file->path);
+            close(fd);
+            return false;
+        }
+        madvise(data, file->length, MADV_SEQUENTIAL);
+        file->data = (const uint8_t *)data;
+    }
+    close(fd);
+
+    return true;
+}
+
+static void usage(const char *program)
+{
+    fprintf(stderr, "Usage: %s [--jobs N] [--fft-size N] LOG.TXT...\n", program);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<mappedFile_t> files;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+
+        if (arg[0] != '-') {
+            mappedFile_t file = mappedFile_t();
+            file.path = arg;
+            files.push_back(file);
+            continue;
+        }
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+        }
+        if (strcmp(arg, "--jobs") == 0) {
+            statsOptions.jobs = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(arg, "--fft-size") == 0) {
+            statsOptions.fftSize = strtoul(argv[++i], NULL, 10);
+        } else {
+            usage(argv[0]);
+        }
+    }
+
+    // The FFT is radix-2
+    if (files.empty() || statsOptions.fftSize < 16 || (statsOptions.fftSize & (statsOptions.fftSize - 1))) {
+        usage(argv[0]);
+    }
+    if (statsOptions.jobs == 0) {
+        statsOptions.jobs = std::max(std::thread::hardware_concurrency(), 1U);
+    }
+
+    // A flight is the unit of work, an archive is usually a few files of many flights
+    std::vector<std::pair<mappedFile_t *, int> > flights;
+    int status = 0;
+
+    for (mappedFile_t &file : files) {
+        if (!mapFile(&file)) {
+            status = 1;
+            continue;
+        }
+        file.logs = blackboxFindLogs(file.data, file.length);
+        if (file.logs.empty()) {
+            fprintf(stderr, "%s has no blackbox logs\n", file.path);
+        }
+        for (unsigned i = 0; i < file.logs.size(); i++) {
+            flights.push_back(std::make_pair(&file, i));
+        }
+    }
+
+    std::vector<std::string> results(flights.size());
+    std::atomic<unsigned> nextFlight(0);
+    std::vector<std::thread> workers;
+
+    for (unsigned i = 0; i < std::min(statsOptions.jobs, (unsigned)flights.size()); i++) {
+        workers.push_back(std::thread([&]() {
+            for (unsigned flight; (flight = nextFlight++) < flights.size(); ) {
+                results[flight] = summariseFlight(flights[flight].first, flights[flight].second);
+            }
+        }));
+    }
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+
+    for (const std::string &result : results) {
+        printf("%s\n", result.c_str());
+    }
+
+    for (mappedFile_t &file : files) {
+        if (file.data) {
+            munmap((void *)file.data, file.length);
+        }
+    }
+
+    return status;
+}
@@ -0,0 +1,844 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Replays a decoded blackbox log through the gyro filters, the PID controller, the mixer and the tricopter tail model
+ * of the firmware, and writes the recomputed outputs as a CSV with the column names of blackbox_decode.
+ *
+ * The settings are taken from the H lines of the raw log and can be overridden with --set, using the names of the
+ * header lines.
+ *
+ * Usage: blackbox_replay [--header LOG.TXT [--index N]] [--set name=value[,value]...]... LOG.csv > REPLAY.csv
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <time.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+extern "C" {
+    #include <platform.h>
+    #include "build/build_config.h"
+    #include "build/debug.h"
+
+    #include "common/axis.h"
+    #include "common/filter.h"
+    #include "common/maths.h"
+
+    #include "config/parameter_group.h"
+    #include "config/parameter_group_ids.h"
+    #include "config/profile.h"
+
+    #include "drivers/adc.h"
+    #include "drivers/sensor.h"
+    #include "drivers/accgyro.h"
+    #include "drivers/compass.h"
+    #include "drivers/pwm_mapping.h"
+
+    #include "fc/config.h"
+    #include "fc/runtime_config.h"
+    #include "fc/rc_controls.h"
+    #include "fc/rate_profile.h"
+    #include "fc/fc_debug.h"
+
+    #include "io/beeper.h"
+    #include "io/motors.h"
+
+    #include "rx/rx.h"
+
+    #include "sensors/sensors.h"
+    #include "sensors/acceleration.h"
+    #include "sensors/boardalignment.h"
+    #include "sensors/compass.h"
+    #include "sensors/gyro.h"
+
+    #include "flight/pid.h"
+    #include "flight/imu.h"
+    #include "flight/mixer.h"
+    #include "flight/mixer_tricopter.h"
+    #include "flight/servos.h"
+    #include "flight/navigation.h"
+
+    PG_REGISTER_PROFILE(rcControlsConfig_t, rcControlsConfig, PG_RC_CONTROLS_CONFIG, 0);
+    PG_REGISTER(rxConfig_t, rxConfig, PG_RX_CONFIG, 0);
+
+    extern pidControllerFuncPtr pid_controller;
+    extern uint8_t motorCount;
+    extern uint8_t dynP8[3], dynI8[3], dynD8[3];
+
+    void mixerInit(motorMixer_t *initialCustomMixers);
+    void mixerInitServos(servoMixer_t *initialCustomServoMixers);
+    void mixerUsePWMIOConfiguration(pwmIOConfiguration_t *pwmIOConfiguration);
+}
+
+typedef enum {
+    REPLAY_UINT8,
+    REPLAY_INT8,
+    REPLAY_UINT16,
+    REPLAY_INT16,
+    REPLAY_FLOAT,
+} replayValueType_e;
+
+typedef struct replayValue_s {
+    replayValueType_e type;
+    uint16_t offset;
+} replayValue_t;
+
+#define REPLAY_SETTING_MAX_VALUES 5
+
+typedef struct replaySetting_s {
+    const char *name;
+    pgn_t pgn;
+    uint8_t count;
+    replayValue_t values[REPLAY_SETTING_MAX_VALUES];
+} replaySetting_t;
+
+#define VALUE(_type, _struct, _field) { _type, offsetof(_struct, _field) }
+
+// The settings named as in the H lines of the log, see blackboxWriteSysinfo()
+static const replaySetting_t replaySettings[] = {
+    { "minthrottle",                    PG_MOTOR_CONFIG, 1, { VALUE(REPLAY_UINT16, motorConfig_t, minthrottle) } },
+    { "maxthrottle",                    PG_MOTOR_CONFIG, 1, { VALUE(REPLAY_UINT16, motorConfig_t, maxthrottle) } },
+    { "min_command",                    PG_MOTOR_CONFIG, 1, { VALUE(REPLAY_UINT16, motorConfig_t, mincommand) } },
+
+    { "pid_controller",                 PG_PID_PROFILE, 1, { VALUE(REPLAY_UINT8, pidProfile_t, pidController) } },
+    { "rollPID",                        PG_PID_PROFILE, 3, { VALUE(REPLAY_UINT8, pidProfile_t, P8[PIDROLL]), VALUE(REPLAY_UINT8, pidProfile_t, I8[PIDROLL]), VALUE(REPLAY_UINT8, pidProfile_t, D8[PIDROLL]) } },
+    { "pitchPID",                       PG_PID_PROFILE, 3, { VALUE(REPLAY_UINT8, pidProfile_t, P8[PIDPITCH]), VALUE(REPLAY_UINT8, pidProfile_t, I8[PIDPITCH]), VALUE(REPLAY_UINT8, pidProfile_t, D8[PIDPITCH]) } },
+    { "yawPID",                         PG_PID_PROFILE, 3, { VALUE(REPLAY_UINT8, pidProfile_t, P8[PIDYAW]), VALUE(REPLAY_UINT8, pidProfile_t, I8[PIDYAW]), VALUE(REPLAY_UINT8, pidProfile_t, D8[PIDYAW]) } },
+    { "levelPID",                       PG_PID_PROFILE, 3, { VALUE(REPLAY_UINT8, pidProfile_t, P8[PIDLEVEL]), VALUE(REPLAY_UINT8, pidProfile_t, I8[PIDLEVEL]), VALUE(REPLAY_UINT8, pidProfile_t, D8[PIDLEVEL]) } },
+    { "yaw_p_limit",                    PG_PID_PROFILE, 1, { VALUE(REPLAY_UINT16, pidProfile_t, yaw_p_limit) } },
+    { "pid_delta_method",               PG_PID_PROFILE, 1, { VALUE(REPLAY_UINT8, pidProfile_t, deltaMethod) } },
+    { "dterm_lowpass",                  PG_PID_PROFILE, 2, { VALUE(REPLAY_UINT8, pidProfile_t, dterm_filter_type), VALUE(REPLAY_UINT16, pidProfile_t, dterm_lpf_hz) } },
+    { "dterm_notch",                    PG_PID_PROFILE, 2, { VALUE(REPLAY_UINT16, pidProfile_t, dterm_notch_hz), VALUE(REPLAY_UINT16, pidProfile_t, dterm_notch_cutoff) } },
+    { "yaw_lpf_hz",                     PG_PID_PROFILE, 1, { VALUE(REPLAY_UINT16, pidProfile_t, yaw_lpf_hz) } },
+    { "yaw_ff_lead_ms",                 PG_PID_PROFILE, 1, { VALUE(REPLAY_UINT8, pidProfile_t, yaw_ff_lead_ms) } },
+
+    { "rcRate",                         PG_CONTROL_RATE_PROFILES, 1, { VALUE(REPLAY_UINT8, controlRateConfig_t, rcRate8) } },
+    { "rates",                          PG_CONTROL_RATE_PROFILES, 3, { VALUE(REPLAY_UINT8, controlRateConfig_t, rates[ROLL]), VALUE(REPLAY_UINT8, controlRateConfig_t, rates[PITCH]), VALUE(REPLAY_UINT8, controlRateConfig_t, rates[YAW]) } },
+    { "tpa",                            PG_CONTROL_RATE_PROFILES, 2, { VALUE(REPLAY_UINT8, controlRateConfig_t, dynThrPID), VALUE(REPLAY_UINT16, controlRateConfig_t, tpa_breakpoint) } },
+    { "tri_dynamic_yaw",                PG_CONTROL_RATE_PROFILES, 2, { VALUE(REPLAY_UINT16, controlRateConfig_t, tri_dynamic_yaw_minthrottle), VALUE(REPLAY_UINT16, controlRateConfig_t, tri_dynamic_yaw_maxthrottle) } },
+
+    { "gyro_lowpass",                   PG_GYRO_CONFIG, 2, { VALUE(REPLAY_UINT8, gyroConfig_t, gyro_soft_type), VALUE(REPLAY_UINT16, gyroConfig_t, gyro_soft_lpf_hz) } },
+    { "gyro_notch",                     PG_GYRO_CONFIG, 2, { VALUE(REPLAY_UINT16, gyroConfig_t, gyro_soft_notch_hz), VALUE(REPLAY_UINT16, gyroConfig_t, gyro_soft_notch_cutoff_hz) } },
+
+    { "mixer",                          PG_MIXER_CONFIG, 1, { VALUE(REPLAY_UINT8, mixerConfig_t, mixerMode) } },
+    { "yaw_motor_direction",            PG_MIXER_CONFIG, 1, { VALUE(REPLAY_INT8, mixerConfig_t, yaw_motor_direction) } },
+    { "yaw_jump_prevention_limit",      PG_MIXER_CONFIG, 1, { VALUE(REPLAY_UINT16, mixerConfig_t, yaw_jump_prevention_limit) } },
+    { "pid_at_min_throttle",            PG_MIXER_CONFIG, 1, { VALUE(REPLAY_UINT8, mixerConfig_t, pid_at_min_throttle) } },
+#ifdef USE_SERVOS
+    { "servo_lowpass",                  PG_MIXER_CONFIG, 2, { VALUE(REPLAY_INT8, mixerConfig_t, servo_lowpass_enable), VALUE(REPLAY_FLOAT, mixerConfig_t, servo_lowpass_freq) } },
+    { "tri_tail",                       PG_MIXER_CONFIG, 3, { VALUE(REPLAY_INT16, mixerConfig_t, tri_tail_motor_thrustfactor), VALUE(REPLAY_INT16, mixerConfig_t, tri_tail_servo_speed), VALUE(REPLAY_UINT8, mixerConfig_t, tri_servo_feedback) } },
+    { "tri_motor_acc_yaw_correction",   PG_MIXER_CONFIG, 1, { VALUE(REPLAY_UINT16, mixerConfig_t, tri_motor_acc_yaw_correction) } },
+    { "tri_motor_acceleration",         PG_MIXER_CONFIG, 1, { VALUE(REPLAY_FLOAT, mixerConfig_t, tri_motor_acceleration) } },
+    { "tri_tail_servo",                 PG_SERVO_PROFILE, 5, {
+        VALUE(REPLAY_INT16, servoProfile_t, servoConf[SERVO_RUDDER].min),
+        VALUE(REPLAY_INT16, servoProfile_t, servoConf[SERVO_RUDDER].middle),
+        VALUE(REPLAY_INT16, servoProfile_t, servoConf[SERVO_RUDDER].max),
+        VALUE(REPLAY_UINT8, servoProfile_t, servoConf[SERVO_RUDDER].angleAtMin),
+        VALUE(REPLAY_UINT8, servoProfile_t, servoConf[SERVO_RUDDER].angleAtMax),
+    } },
+#endif
+};
+
+#define REPLAY_SETTING_COUNT (sizeof(replaySettings) / sizeof(replaySettings[0]))
+
+// The columns read from the decoded log, in the order of replayFrame_t
+static const char *const inputColumnNames[] = {
+    "time",
+    "gyroADC[0]", "gyroADC[1]", "gyroADC[2]",
+    "accSmooth[0]", "accSmooth[1]", "accSmooth[2]",
+    "rcCommand[0]", "rcCommand[1]", "rcCommand[2]", "rcCommand[3]",
+};
+
+#define INPUT_COLUMN_COUNT (sizeof(inputColumnNames) / sizeof(inputColumnNames[0]))
+
+// With debug_mode = GYRO the firmware logs the gyro before the gyro filters in the first debug fields
+static const char *const debugGyroColumnNames[] = {
+    "debug[0]", "debug[1]", "debug[2]",
+};
+
+typedef struct replayFrame_s {
+    uint32_t time;
+    int16_t gyroADC[XYZ_AXIS_COUNT];
+    int16_t accSmooth[XYZ_AXIS_COUNT];
+    int16_t rcCommand[4];
+} replayFrame_t;
+
+typedef struct flightModeName_s {
+    const char *name;
+    flightModeFlags_e flag;
+} flightModeName_t;
+
+static const flightModeName_t flightModeNames[] = {
+    { "ANGLE_MODE",     ANGLE_MODE },
+    { "HORIZON_MODE",   HORIZON_MODE },
+    { "MAG_MODE",       MAG_MODE },
+    { "BARO_MODE",      BARO_MODE },
+    { "GPS_HOME_MODE",  GPS_HOME_MODE },
+    { "GPS_HOLD_MODE",  GPS_HOLD_MODE },
+    { "HEADFREE_MODE",  HEADFREE_MODE },
+    { "UNUSED_MODE",    UNUSED_MODE },
+    { "PASSTHRU_MODE",  PASSTHRU_MODE },
+    { "SONAR_MODE",     SONAR_MODE },
+    { "FAILSAFE_MODE",  FAILSAFE_MODE },
+    { "GTUNE_MODE",     GTUNE_MODE },
+};
+
+static const replayFrame_t *currentFrame;
+static uint32_t replayMicros;
+static uint32_t frameIntervalNum = 1;
+static uint32_t frameIntervalDenom = 1;
+static rollAndPitchTrims_t replayTrims;
+static imuRuntimeConfig_t replayImuRuntimeConfig;
+static accDeadband_t replayAccDeadband;
+static uint8_t logDebugMode = DEBUG_NONE;
+
+static void usage(const char *program)
+{
+    fprintf(stderr, "Usage: %s [--header LOG.TXT [--index N]] [--set name=value[,value]...]... LOG.csv > REPLAY.csv\n", program);
+    exit(2);
+}
+
+static uint8_t *settingBase(const replaySetting_t *setting)
+{
+    const pgRegistry_t *reg = pgFind(setting->pgn);
+
+    if (!reg) {
+        return NULL;
+    }
+    // Array groups such as the rate profiles are replayed with their first entry, the one selected at setup
+    return pgIsSystem(reg) ? reg->address : *reg->ptr;
+}
+
+static void writeSettingValue(uint8_t *field, replayValueType_e type, const char *text)
+{
+    switch (type) {
+    case REPLAY_UINT8:
+    case REPLAY_INT8: {
+        const uint8_t value = strtol(text, NULL, 0);
+        memcpy(field, &value, sizeof(value));
+        break;
+    }
+    case REPLAY_UINT16:
+    case REPLAY_INT16: {
+        const uint16_t value = strtol(text, NULL, 0);
+        memcpy(field, &value, sizeof(value));
+        break;
+    }
+    case REPLAY_FLOAT: {
+        // The header logs floats as their bits in hex, on the command line a decimal value is easier
+        float value;
+        if (strncmp(text, "0x", 2) == 0) {
+            const uint32_t bits = strtoul(text, NULL, 16);
+            memcpy(&value, &bits, sizeof(value));
+        } else {
+            value = strtof(text, NULL);
+        }
+        memcpy(field, &value, sizeof(value));
+        break;
+    }
+    }
+}
+
+static std::vector<std::string> splitValues(const char *text)
+{
+    std::vector<std::string> values;
+    std::string value;
+
+    for (const char *c = text; *c; c++) {
+        if (*c == ',') {
+            values.push_back(value);
+            value.clear();
+        } else if (*c != '\r' && *c != '\n') {
+            value += *c;
+        }
+    }
+    values.push_back(value);
+    return values;
+}
+
+/*
+ * Applies one "name:value" header line or "name=value" option. Returns false for a setting the replay does not use.
+ */
+static bool applySetting(const std::string &name, const char *text)
+{
+    const std::vector<std::string> values = splitValues(text);
+
+    if (name == "looptime") {
+        targetPidLooptime = strtoul(text, NULL, 0);
+        return true;
+    }
+    if (name == "P interval") {
+        if (sscanf(text, "%u/%u", &frameIntervalNum, &frameIntervalDenom) != 2 || frameIntervalNum == 0) {
+            frameIntervalNum = frameIntervalDenom = 1;
+        }
+        return true;
+    }
+    if (name == "gyro.scale") {
+        writeSettingValue((uint8_t *)&gyro.scale, REPLAY_FLOAT, text);
+        return true;
+    }
+    if (name == "debug_mode") {
+        logDebugMode = strtoul(text, NULL, 0);
+        return true;
+    }
+    if (name == "acc_1G") {
+        acc.acc_1G = strtoul(text, NULL, 0);
+        return true;
+    }
+
+    for (unsigned i = 0; i < REPLAY_SETTING_COUNT; i++) {
+        const replaySetting_t *setting = &replaySettings[i];
+
+        if (name != setting->name) {
+            continue;
+        }
+
+        uint8_t *base = settingBase(setting);
+        if (!base) {
+            return false;
+        }
+        for (unsigned v = 0; v < setting->count && v < values.size(); v++) {
+            writeSettingValue(base + setting->values[v].offset, setting->values[v].type, values[v].c_str());
+        }
+        return true;
+    }
+    return false;
+}
+
+/*
+ * Applies the H lines of the index'th log in a raw blackbox file, a file may hold several logs one after the other.
+ */
+static bool applyHeader(const char *path, int index)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "Could not open log %s\n", path);
+        return false;
+    }
+
+    std::string contents;
+    char buffer[65536];
+    size_t length;
+    while ((length = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        contents.append(buffer, length);
+    }
+    fclose(file);
+
+    static const char logStart[] = "H Product:";
+    size_t position = std::string::npos;
+    for (int i = 0; i <= index; i++) {
+        position = contents.find(logStart, position == std::string::npos ? 0 : position + 1);
+        if (position == std::string::npos) {
+            fprintf(stderr, "Log %s has no log %d\n", path, index + 1);
+            return false;
+        }
+    }
+
+    // The headers end where the first frame starts
+    while (contents.compare(position, 2, "H ") == 0) {
+        const size_t end = contents.find('\n', position);
+        const std::string line = contents.substr(position + 2, end - position - 2);
+        const size_t colon = line.find(':');
+
+        if (colon != std::string::npos) {
+            applySetting(line.substr(0, colon), line.c_str() + colon + 1);
+        }
+        if (end == std::string::npos) {
+            break;
+        }
+        position = end + 1;
+    }
+    return true;
+}
+
+// blackbox_decode appends the unit to some column names, e.g. "time (us)"
+static bool columnNameMatches(const char *column, size_t length, const char *name)
+{
+    const size_t nameLength = strlen(name);
+
+    return length >= nameLength && strncmp(column, name, nameLength) == 0
+        && (length == nameLength || column[nameLength] == ' ');
+}
+
+static uint16_t parseFlightModeFlags(const char *text, size_t length)
+{
+    if (length > 0 && text[0] >= '0' && text[0] <= '9') {
+        return strtoul(text, NULL, 10);
+    }
+
+    uint16_t flags = 0;
+    for (unsigned i = 0; i < sizeof(flightModeNames) / sizeof(flightModeNames[0]); i++) {
+        const char *found = (const char *)memmem(text, length, flightModeNames[i].name, strlen(flightModeNames[i].name));
+        if (found) {
+            flags |= flightModeNames[i].flag;
+        }
+    }
+    return flags;
+}
+
+static bool replayGyroRead(int16_t *gyroADCRaw)
+{
+    memcpy(gyroADCRaw, currentFrame->gyroADC, sizeof(currentFrame->gyroADC));
+    return true;
+}
+
+static bool isTricopter(void)
+{
+#ifdef USE_SERVOS
+    return mixerConfig()->mixerMode == MIXER_TRI || mixerConfig()->mixerMode == MIXER_CUSTOM_TRI;
+#else
+    return false;
+#endif
+}
+
+static void setupReplay(uint32_t framePeriodUs)
+{
+    pwmIOConfiguration_t pwmIOConfiguration;
+
+    if (!targetPidLooptime) {
+        targetPidLooptime = framePeriodUs;
+    }
+
+    // The logged gyro is already in the body frame
+    gyroAlign = CW0_DEG;
+    gyro.read = replayGyroRead;
+    gyro.sampleFrequencyHz = 1000000 / targetPidLooptime;
+    gyroInitSensorTransform();
+    gyroInit();
+
+    pidSetController((pidControllerType_e)pidProfile()->pidController);
+    pidSetTargetLooptime(targetPidLooptime);
+    pidInitFilters(pidProfile());
+    pidResetITerm();
+
+    // No accelerometer filter, the logged accSmooth is the filtered reading already
+    replayImuRuntimeConfig.acc_cut_hz = 0;
+    replayImuRuntimeConfig.dcm_kp = imuConfig()->dcm_kp / 10000.0f;
+    replayImuRuntimeConfig.dcm_ki = imuConfig()->dcm_ki / 10000.0f;
+    replayImuRuntimeConfig.small_angle = imuConfig()->small_angle;
+    imuConfigure(&replayImuRuntimeConfig, &replayAccDeadband, 5.0f, throttleCorrectionConfig()->throttle_correction_angle);
+    imuInit();
+
+#ifdef USE_SERVOS
+    // The servo feedback is not logged, so the tail servo is modelled as with no feedback signal
+    mixerConfig()->tri_servo_feedback = TRI_SERVO_FB_VIRTUAL;
+#endif
+
+    memset(&pwmIOConfiguration, 0, sizeof(pwmIOConfiguration));
+    mixerUseConfigs(servoProfile()->servoConf);
+    mixerInit(customMotorMixer(0));
+#ifdef USE_SERVOS
+    pwmIOConfiguration.servoCount = isTricopter() ? 1 : 0;
+    mixerInitServos(customServoMixer(0));
+    mixerInitialiseServoFiltering(targetPidLooptime);
+#endif
+    mixerUsePWMIOConfiguration(&pwmIOConfiguration);
+    mixerResetDisarmedMotors();
+
+    // mixTable() asks the tricopter mixer for a tail motor correction whatever the mixer, see control_path_bench.cc
+    if (!isTricopter()) {
+        triInitMixer(&servoProfile()->servoConf[SERVO_RUDDER], &servo[SERVO_RUDDER]);
+    }
+
+    armingFlags = ARMED;
+}
+
+/*
+ * Reproduces the TPA and yaw I weights of updateRcCommands() from the logged rcCommand, taking the stick position as
+ * proportional to it. The throttle curve and the rc rate are left out.
+ */
+static void updatePidWeights(void)
+{
+    const int32_t throttle = rcCommand[THROTTLE];
+    int32_t prop2 = 100;
+
+    rcData[THROTTLE] = throttle;
+
+    if (throttle >= currentControlRateProfile->tpa_breakpoint) {
+        if (throttle < 2000) {
+            prop2 = 100 - (uint16_t)currentControlRateProfile->dynThrPID * (throttle - currentControlRateProfile->tpa_breakpoint) / (2000 - currentControlRateProfile->tpa_breakpoint);
+        } else {
+            prop2 = 100 - currentControlRateProfile->dynThrPID;
+        }
+    }
+
+    for (int axis = 0; axis < 3; axis++) {
+        const int32_t stick = MIN(ABS(rcCommand[axis]), 500);
+        int32_t prop1 = 100 - (uint16_t)currentControlRateProfile->rates[axis] * stick / 500;
+
+        rcData[axis] = rxConfig()->midrc + rcCommand[axis];
+        if (axis == YAW) {
+            pidSetWeights((flight_dynamics_index_t)axis, 100, MAX(0, 100 - stick * 100 / 500));
+        } else {
+            prop1 = (uint16_t)prop1 * prop2 / 100;
+            pidSetWeights((flight_dynamics_index_t)axis, prop2, 100);
+        }
+        dynP8[axis] = (uint16_t)pidProfile()->P8[axis] * prop1 / 100;
+        dynI8[axis] = (uint16_t)pidProfile()->I8[axis] * prop1 / 100;
+        dynD8[axis] = (uint16_t)pidProfile()->D8[axis] * prop1 / 100;
+    }
+}
+
+static void replayFrame(const replayFrame_t *frame)
+{
+    currentFrame = frame;
+    replayMicros = frame->time;
+
+    gyroUpdate();
+
+    imuUpdateAccelerometer(&replayTrims);
+    imuUpdateAttitude();
+
+    memcpy(rcCommand, frame->rcCommand, sizeof(frame->rcCommand));
+    updatePidWeights();
+
+    pid_controller(pidProfile(), currentControlRateProfile, imuConfig()->max_angle_inclination, &replayTrims, rxConfig());
+
+    mixTable();
+#ifdef USE_SERVOS
+    filterServos();
+#endif
+}
+
+#define REPLAY_WARM_UP_US 500000
+
+/*
+ * Settles the filters and the tail motor and servo models on the first frame before the replay starts, since a log
+ * usually starts in flight rather than from rest.
+ */
+static void replayWarmUp(const replayFrame_t *first, uint32_t framePeriodUs)
+{
+    replayFrame_t frame = *first;
+    const uint32_t iterations = REPLAY_WARM_UP_US / framePeriodUs;
+
+    for (uint32_t i = iterations; i > 0; i--) {
+        frame.time = first->time - i * framePeriodUs;
+        replayFrame(&frame);
+    }
+    pidResetITerm();
+}
+
+static void writeOutputHeader(FILE *out, bool logTailServo)
+{
+    fprintf(out, "loopIteration,time (us),axisP[0],axisP[1],axisP[2],axisI[0],axisI[1],axisI[2],axisD[0],axisD[1],axisD[2],"
+                 "axisF[2],tailLag,saturation,gyroADC[0],gyroADC[1],gyroADC[2]");
+    for (int i = 0; i < motorCount; i++) {
+        fprintf(out, ",motor[%d]", i);
+    }
+    if (logTailServo) {
+        fprintf(out, ",servo[5]");
+    }
+    fputc('\n', out);
+}
+
+static void writeOutputRow(FILE *out, uint32_t loopIteration, bool logTailServo)
+{
+    fprintf(out, "%u,%u,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%u,%u,%d,%d,%d",
+        loopIteration, currentFrame->time,
+        axisPID_P[ROLL], axisPID_P[PITCH], axisPID_P[YAW],
+        axisPID_I[ROLL], axisPID_I[PITCH], axisPID_I[YAW],
+        axisPID_D[ROLL], axisPID_D[PITCH], axisPID_D[YAW],
+        axisPID_F[YAW], (uint32_t)(tailLagTime * 1000000.0f), pidSaturationFlags,
+        gyroADC[X], gyroADC[Y], gyroADC[Z]);
+    for (int i = 0; i < motorCount; i++) {
+        fprintf(out, ",%d", motor[i]);
+    }
+#ifdef USE_SERVOS
+    if (logTailServo) {
+        fprintf(out, ",%u", triGetCurrentServoAngle());
+    }
+#else
+    UNUSED(logTailServo);
+#endif
+    fputc('\n', out);
+}
+
+static double secondsNow(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+int main(int argc, char **argv)
+{
+    const char *headerPath = NULL;
+    const char *csvPath = NULL;
+    int logIndex = 0;
+    std::vector<const char *> overrides;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+
+        if (arg[0] != '-') {
+            if (csvPath) {
+                usage(argv[0]);
+            }
+            csvPath = arg;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+        }
+        if (strcmp(arg, "--header") == 0) {
+            headerPath = argv[++i];
+        } else if (strcmp(arg, "--index") == 0) {
+            logIndex = atoi(argv[++i]) - 1;
+        } else if (strcmp(arg, "--set") == 0) {
+            overrides.push_back(argv[++i]);
+        } else {
+            usage(argv[0]);
+        }
+    }
+
+    if (!csvPath || logIndex < 0) {
+        usage(argv[0]);
+    }
+
+    pgResetAll(MAX_PROFILE_COUNT);
+    pgActivateProfile(0);
+    setControlRateProfile(0);
+    // as activateConfig() does
+    servoProfile()->servoConf[SERVO_RUDDER].angleAtMin = 40;
+    servoProfile()->servoConf[SERVO_RUDDER].angleAtMax = 40;
+    gyro.scale = 1.0f / 16.4f;
+    acc.acc_1G = 4096;
+
+    if (headerPath && !applyHeader(headerPath, logIndex)) {
+        return 1;
+    }
+    // as logged, before any --set of the gyro filters
+    const bool loggedGyroIsFiltered = gyroConfig()->gyro_soft_lpf_hz != 0;
+    for (const char *setting : overrides) {
+        const char *equals = strchr(setting, '=');
+
+        if (!equals || !applySetting(std::string(setting, equals - setting), equals + 1)) {
+            fprintf(stderr, "Unknown setting %s\n", setting);
+            return 2;
+        }
+    }
+
+    FILE *in = fopen(csvPath, "r");
+    if (!in) {
+        fprintf(stderr, "Could not open %s\n", csvPath);
+        return 1;
+    }
+
+    char line[4096];
+    if (!fgets(line, sizeof(line), in)) {
+        fprintf(stderr, "%s is empty\n", csvPath);
+        return 1;
+    }
+
+    // Map the columns of the decoded log onto the frame fields
+    int columnOfField[INPUT_COLUMN_COUNT];
+    int columnOfDebugGyro[XYZ_AXIS_COUNT] = { -1, -1, -1 };
+    int flightModeColumn = -1;
+    int columnCount = 0;
+    for (unsigned i = 0; i < INPUT_COLUMN_COUNT; i++) {
+        columnOfField[i] = -1;
+    }
+    for (char *column = line; column; columnCount++) {
+        while (*column == ' ') {
+            column++;
+        }
+
+        char *end = strpbrk(column, ",\r\n");
+        const size_t length = end ? end - column : strlen(column);
+        for (unsigned i = 0; i < INPUT_COLUMN_COUNT; i++) {
+            if (columnOfField[i] < 0 && columnNameMatches(column, length, inputColumnNames[i])) {
+                columnOfField[i] = columnCount;
+            }
+        }
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            if (columnNameMatches(column, length, debugGyroColumnNames[axis])) {
+                columnOfDebugGyro[axis] = columnCount;
+            }
+        }
+        if (columnNameMatches(column, length, "flightModeFlags")) {
+            flightModeColumn = columnCount;
+        }
+        column = end && *end == ',' ? end + 1 : NULL;
+    }
+    for (unsigned i = 0; i < INPUT_COLUMN_COUNT; i++) {
+        if (columnOfField[i] < 0) {
+            fprintf(stderr, "%s has no %s column\n", csvPath, inputColumnNames[i]);
+            return 1;
+        }
+    }
+
+    // The logged gyroADC has been through the gyro filters, the replay runs the filters on the unfiltered gyro when
+    // the log has it
+    bool gyroFromDebug = false;
+    if (loggedGyroIsFiltered) {
+        gyroFromDebug = logDebugMode == DEBUG_GYRO;
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            gyroFromDebug = gyroFromDebug && columnOfDebugGyro[axis] >= 0;
+        }
+        if (!gyroFromDebug) {
+            fprintf(stderr, "%s has no unfiltered gyro, replaying the filtered gyroADC through the gyro filters again. "
+                "Log with debug_mode = GYRO to replay the unfiltered gyro\n", csvPath);
+        }
+    }
+
+    std::vector<replayFrame_t> frames;
+    std::vector<uint16_t> frameFlightModes;
+    while (fgets(line, sizeof(line), in)) {
+        int32_t values[INPUT_COLUMN_COUNT];
+        int32_t debugGyro[XYZ_AXIS_COUNT] = { 0, 0, 0 };
+        uint16_t modes = 0;
+        unsigned found = 0;
+        int column = 0;
+
+        for (char *field = line; field; column++) {
+            char *end = strchr(field, ',');
+
+            for (unsigned i = 0; i < INPUT_COLUMN_COUNT; i++) {
+                if (columnOfField[i] == column) {
+                    values[i] = strtol(field, NULL, 10);
+                    found++;
+                }
+            }
+            for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+                if (columnOfDebugGyro[axis] == column) {
+                    debugGyro[axis] = strtol(field, NULL, 10);
+                }
+            }
+            if (column == flightModeColumn) {
+                modes = parseFlightModeFlags(field + strspn(field, " "), end ? (size_t)(end - field) : strlen(field));
+            }
+            field = end ? end + 1 : NULL;
+        }
+        if (found < INPUT_COLUMN_COUNT) {
+            continue; // not a main frame row
+        }
+
+        replayFrame_t frame;
+        frame.time = values[0];
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            frame.gyroADC[axis] = gyroFromDebug ? debugGyro[axis] : values[1 + axis];
+            frame.accSmooth[axis] = values[4 + axis];
+        }
+        for (int i = 0; i < 4; i++) {
+            frame.rcCommand[i] = values[7 + i];
+        }
+        frames.push_back(frame);
+        frameFlightModes.push_back(modes);
+    }
+    fclose(in);
+
+    if (frames.size() < 2) {
+        fprintf(stderr, "%s has too few frames to replay\n", csvPath);
+        return 1;
+    }
+
+    // A log that only kept some of the loop iterations is replayed at the rate it was logged at
+    std::vector<uint32_t> deltas;
+    for (size_t i = 1; i < frames.size(); i++) {
+        deltas.push_back(frames[i].time - frames[i - 1].time);
+    }
+    std::nth_element(deltas.begin(), deltas.begin() + deltas.size() / 2, deltas.end());
+    const uint32_t framePeriodUs = MAX(deltas[deltas.size() / 2], 1u);
+    if (targetPidLooptime) {
+        targetPidLooptime = targetPidLooptime * frameIntervalDenom / frameIntervalNum;
+    }
+    if (targetPidLooptime && ABS((int32_t)(targetPidLooptime - framePeriodUs)) > (int32_t)framePeriodUs / 4) {
+        fprintf(stderr, "Frames are %uus apart in the log but the header gives %uus, replaying at %uus\n",
+            framePeriodUs, targetPidLooptime, framePeriodUs);
+        targetPidLooptime = framePeriodUs;
+    }
+
+    setupReplay(framePeriodUs);
+    flightModeFlags = frameFlightModes[0];
+    replayWarmUp(&frames[0], framePeriodUs);
+
+    static char outputBuffer[1 << 16];
+    setvbuf(stdout, outputBuffer, _IOFBF, sizeof(outputBuffer));
+
+    const bool logTailServo = isTricopter();
+    writeOutputHeader(stdout, logTailServo);
+
+    const double start = secondsNow();
+    for (size_t i = 0; i < frames.size(); i++) {
+        flightModeFlags = frameFlightModes[i];
+        replayFrame(&frames[i]);
+        writeOutputRow(stdout, i, logTailServo);
+    }
+    fflush(stdout);
+    const double elapsed = secondsNow() - start;
+
+    const double flightSeconds = (frames.back().time - frames.front().time) * 1e-6;
+    fprintf(stderr, "Replayed %u frames, %.1fs of flight in %.3fs (%.0fx real time)\n",
+        (unsigned)frames.size(), flightSeconds, elapsed, elapsed > 0 ? flightSeconds / elapsed : 0);
+
+    return 0;
+}
+
+// STUBS
+
+extern "C" {
+uint8_t armingFlags;
+uint16_t flightModeFlags;
+uint8_t stateFlags;
+uint16_t enableFlightMode(flightModeFlags_e mask) { return flightModeFlags |= mask; }
+uint16_t disableFlightMode(flightModeFlags_e mask) { return flightModeFlags &= ~mask; }
+
+int16_t debug[DEBUG16_VALUE_COUNT];
+uint8_t debugMode;
+
+uint32_t micros(void) { return replayMicros; }
+uint32_t millis(void) { return replayMicros / 1000; }
+void delay(uint32_t) {}
+
+bool feature(uint32_t) { return false; }
+bool sensors(uint32_t mask) { return mask & (SENSOR_GYRO | SENSOR_ACC); }
+uint8_t getCurrentProfile(void) { return 0; }
+void saveConfigAndNotify(void) {}
+
+acc_t acc;
+int32_t accADC[XYZ_AXIS_COUNT];
+int32_t magADC[XYZ_AXIS_COUNT];
+float magneticDeclination;
+int16_t GPS_angle[ANGLE_INDEX_COUNT];
+
+void updateAccelerationReadings(rollAndPitchTrims_t *)
+{
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        accADC[axis] = currentFrame->accSmooth[axis];
+    }
+}
+
+int16_t rcCommand[4];
+int16_t rcData[MAX_SUPPORTED_RC_CHANNEL_COUNT];
+rxRuntimeConfig_t rxRuntimeConfig;
+throttleStatus_e calculateThrottleStatus(rxConfig_t *, uint16_t) { return THROTTLE_HIGH; }
+bool rcModeIsActive(boxId_e) { return false; }
+int32_t getRcStickDeflection(int32_t axis, uint16_t midrc) { return MIN(ABS(rcData[axis] - midrc), 500); }
+bool isRcAxisWithinDeadband(int32_t) { return false; }
+
+bool failsafeIsActive(void) { return false; }
+
+void beeper(beeperMode_e) {}
+uint16_t adcGetChannel(uint8_t) { return 0; }
+}
@@ -0,0 +1,97 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <string.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "drivers/adc.h"
+    #include "drivers/adc_impl.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+static void configureChannels(int count)
+{
+    memset(adcConfig, 0, sizeof(adcConfig));
+    memset((void *)adcValues, 0, sizeof(adcValues));
+    for (int i = 0; i < count; i++) {
+        adcConfig[i].enabled = true;
+        adcConfig[i].dmaIndex = i;
+    }
+    adcSequenceLength = count;
+}
+
+TEST(AdcTest, AveragesOversampledConversions)
+{
+    // given three channels converted ADC_OVERSAMPLE_COUNT times
+    configureChannels(3);
+    int rampSum = 0;
+    for (int sequence = 0; sequence < ADC_OVERSAMPLE_COUNT; sequence++) {
+        adcValues[sequence * 3 + 0] = 1000;
+        adcValues[sequence * 3 + 1] = 2000 + sequence * 10;
+        adcValues[sequence * 3 + 2] = 4095;
+        rampSum += 2000 + sequence * 10;
+    }
+
+    // then each channel reads the average of its own conversions
+    EXPECT_EQ(1000, adcGetChannel(ADC_CHANNEL0));
+    EXPECT_EQ((rampSum + ADC_OVERSAMPLE_COUNT / 2) / ADC_OVERSAMPLE_COUNT, adcGetChannel(ADC_CHANNEL1));
+    EXPECT_EQ(4095, adcGetChannel(ADC_CHANNEL2));
+}
+
+TEST(AdcTest, AverageRoundsToNearest)
+{
+    // given
+    configureChannels(1);
+    adcValues[0] = 1;
+
+    // then 1 / ADC_OVERSAMPLE_COUNT rounds down, ADC_OVERSAMPLE_COUNT / 2 rounds up
+    EXPECT_EQ(0, adcGetChannel(ADC_CHANNEL0));
+
+    for (int sequence = 0; sequence < ADC_OVERSAMPLE_COUNT / 2; sequence++) {
+        adcValues[sequence] = 1;
+    }
+    EXPECT_EQ(1, adcGetChannel(ADC_CHANNEL0));
+}
+
+TEST(AdcTest, SparseChannelsUseDmaIndex)
+{
+    // given channel 2 is the only enabled channel
+    configureChannels(0);
+    adcConfig[ADC_CHANNEL2].enabled = true;
+    adcConfig[ADC_CHANNEL2].dmaIndex = 0;
+    adcSequenceLength = 1;
+
+    for (int sequence = 0; sequence < ADC_OVERSAMPLE_COUNT; sequence++) {
+        adcValues[sequence] = 1234;
+    }
+
+    // then
+    EXPECT_EQ(1234, adcGetChannel(ADC_CHANNEL2));
+}
+
+// STUBS
+
+extern "C" {
+int32_t debug[4];
+}
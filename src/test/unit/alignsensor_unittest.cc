@@ -17,6 +17,7 @@
 
 #include "math.h"
 #include "stdint.h"
+#include "stdio.h"
 #include "time.h"
 
 extern "C" {
@@ -271,3 +272,113 @@ TEST(AlignSensorTest, ClockwiseTwoSeventyDegreesFlip)
     testCWFlip(CW270_DEG_FLIP, 270);
 }
 
+
+static void testSensorTransform(int tolerance)
+{
+    const int16_t noOffset[3] = { 0, 0, 0 };
+    sensorTransform_t transform;
+
+    for (int rotation = CW0_DEG; rotation <= CW270_DEG_FLIP; rotation++) {
+        buildSensorTransform(&transform, rotation, noOffset);
+
+        for (int i = 0; i < 100; i++) {
+            int16_t raw[3];
+            int32_t src[3];
+            int32_t expected[3];
+            int32_t dest[3];
+
+            for (int axis = 0; axis < 3; axis++) {
+                raw[axis] = (rand() % 65536) - 32768;
+                src[axis] = raw[axis];
+            }
+
+            alignSensors(src, expected, rotation);
+            applySensorTransform(&transform, raw, dest);
+
+            EXPECT_NEAR(expected[X], dest[X], tolerance) << "rotation " << rotation;
+            EXPECT_NEAR(expected[Y], dest[Y], tolerance) << "rotation " << rotation;
+            EXPECT_NEAR(expected[Z], dest[Z], tolerance) << "rotation " << rotation;
+        }
+    }
+}
+
+TEST(AlignSensorTest, SensorTransformMatchesAlignSensors)
+{
+    testSensorTransform(0);
+}
+
+TEST(AlignSensorTest, SensorTransformAppliesOffsetAfterRotation)
+{
+    int16_t offset[3] = { 10, -20, 30 };
+    const int16_t raw[3] = { 100, 200, 300 };
+    int32_t dest[3];
+    sensorTransform_t transform;
+
+    buildSensorTransform(&transform, CW90_DEG, offset);
+    applySensorTransform(&transform, raw, dest);
+
+    // CW90: x = y, y = -x
+    EXPECT_EQ(200 - 10, dest[X]);
+    EXPECT_EQ(-100 + 20, dest[Y]);
+    EXPECT_EQ(300 - 30, dest[Z]);
+
+    // offset is read on every call, calibration updates take effect without a rebuild
+    offset[Z] = 0;
+    applySensorTransform(&transform, raw, dest);
+    EXPECT_EQ(300, dest[Z]);
+}
+
+static void benchmarkSensorTransform(const char *name)
+{
+    const int samples = 1000000;
+    const int16_t zero[3] = { 3, -5, 7 };
+    int16_t raw[3] = { 120, -340, 4096 };
+    int32_t dest[3];
+    volatile int32_t sink = 0;
+    sensorTransform_t transform;
+
+    buildSensorTransform(&transform, CW270_DEG_FLIP, zero);
+
+    // current path: widen, align, then a separate zero pass
+    clock_t start = clock();
+    for (int i = 0; i < samples; i++) {
+        raw[X] = i;
+        for (int axis = 0; axis < 3; axis++) {
+            dest[axis] = raw[axis];
+        }
+        alignSensors(dest, dest, CW270_DEG_FLIP);
+        for (int axis = 0; axis < 3; axis++) {
+            dest[axis] -= zero[axis];
+        }
+        sink += dest[X];
+    }
+    double alignNs = (double)(clock() - start) * 1e9 / CLOCKS_PER_SEC / samples;
+
+    start = clock();
+    for (int i = 0; i < samples; i++) {
+        raw[X] = i;
+        applySensorTransform(&transform, raw, dest);
+        sink += dest[X];
+    }
+    double transformNs = (double)(clock() - start) * 1e9 / CLOCKS_PER_SEC / samples;
+
+    printf("%s: alignSensors %.1f ns/sample, applySensorTransform %.1f ns/sample\n", name, alignNs, transformNs);
+}
+
+TEST(AlignSensorTest, SensorTransformBenchmark)
+{
+    benchmarkSensorTransform("standard board alignment");
+}
+
+// leaves the board alignment non-standard, keep this test last
+TEST(AlignSensorTest, SensorTransformMatchesAlignSensorsWithBoardAlignment)
+{
+    boardAlignment()->rollDegrees = 5;
+    boardAlignment()->pitchDegrees = -12;
+    boardAlignment()->yawDegrees = 37;
+    initBoardAlignment();
+
+    // the float path rounds once per axis after the rotation, the matrix is rounded to Q30 first
+    testSensorTransform(1);
+    benchmarkSensorTransform("board alignment");
+}
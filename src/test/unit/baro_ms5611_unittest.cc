@@ -160,5 +160,11 @@ bool i2cWrite(uint8_t, uint8_t, uint8_t) {
 bool i2cRead(uint8_t, uint8_t, uint8_t, uint8_t) {
     return 1;
 }
+bool i2cQueueRead(void *, uint8_t, uint8_t, uint8_t, uint8_t *, void *) {
+    return 1;
+}
+bool i2cQueueWrite(void *, uint8_t, uint8_t, uint8_t) {
+    return 1;
+}
 
 }
@@ -0,0 +1,958 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <map>
+#include <vector>
+
+extern "C" {
+    #include <platform.h>
+    #include "build/build_config.h"
+    #include "build/debug.h"
+    #include "build/version.h"
+
+    #include "common/axis.h"
+    #include "common/filter.h"
+    #include "common/maths.h"
+
+    #include "config/parameter_group.h"
+    #include "config/parameter_group_ids.h"
+    #include "config/profile.h"
+
+    #include "drivers/adc.h"
+    #include "drivers/sensor.h"
+    #include "drivers/accgyro.h"
+    #include "drivers/compass.h"
+    #include "drivers/serial.h"
+
+    #include "fc/config.h"
+    #include "fc/runtime_config.h"
+    #include "fc/rc_controls.h"
+    #include "fc/rate_profile.h"
+
+    #include "io/gps.h"
+    #include "io/serial.h"
+    #include "io/motors.h"
+
+    #include "rx/rx.h"
+
+    #include "sensors/sensors.h"
+    #include "sensors/acceleration.h"
+    #include "sensors/amperage.h"
+    #include "sensors/barometer.h"
+    #include "sensors/battery.h"
+    #include "sensors/compass.h"
+    #include "sensors/gyro.h"
+    #include "sensors/voltage.h"
+
+    #include "flight/failsafe.h"
+    #include "flight/pid.h"
+    #include "flight/imu.h"
+    #include "flight/mixer.h"
+    #include "flight/mixer_tricopter.h"
+    #include "flight/servos.h"
+    #include "flight/navigation.h"
+
+    #include "scheduler/scheduler.h"
+    #include "fc/fc_tasks.h"
+    #include "fc/fc_debug.h"
+
+    #include "blackbox/blackbox.h"
+    #include "blackbox/blackbox_io.h"
+
+    PG_REGISTER(batteryConfig_t, batteryConfig, PG_BATTERY_CONFIG, 0);
+    PG_REGISTER_ARR(amperageMeterConfig_t, MAX_AMPERAGE_METERS, amperageMeterConfig, PG_AMPERAGE_METER_CONFIG, 0);
+    PG_REGISTER_ARR(controlRateConfig_t, MAX_CONTROL_RATE_PROFILE_COUNT, controlRateProfiles, PG_CONTROL_RATE_PROFILES, 0);
+    PG_REGISTER(gyroConfig_t, gyroConfig, PG_GYRO_CONFIG, 0);
+    PG_REGISTER(mixerConfig_t, mixerConfig, PG_MIXER_CONFIG, 0);
+    PG_REGISTER(motorConfig_t, motorConfig, PG_MOTOR_CONFIG, 0);
+    PG_REGISTER(rxConfig_t, rxConfig, PG_RX_CONFIG, 0);
+    PG_REGISTER_PROFILE(modeActivationProfile_t, modeActivationProfile, PG_MODE_ACTIVATION_PROFILE, 0);
+    PG_REGISTER_PROFILE(pidProfile_t, pidProfile, PG_PID_PROFILE, 0);
+    PG_REGISTER_PROFILE(servoProfile_t, servoProfile, PG_SERVO_PROFILE, 0);
+
+    extern uint32_t currentTime;
+    extern uint16_t pidDeltaUs;
+    extern uint8_t motorCount;
+}
+
+#include "blackbox_decoder.h"
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define TEST_LOOPTIME_US 1000
+#define TEST_MINTHROTTLE 1150
+#define TEST_MOTOR_COUNT 3
+
+static std::vector<uint8_t> serialBytes;
+static uint32_t testMicros;
+static uint16_t testVbat;
+static amperageMeter_t testAmperageMeter;
+static uint16_t testTailServoAngle;
+
+// What the flight controller had in the globals the blackbox logs, by the time of the loop iteration
+typedef struct testFrame_s {
+    int32_t axisPID_P[XYZ_AXIS_COUNT], axisPID_I[XYZ_AXIS_COUNT], axisPID_D[XYZ_AXIS_COUNT];
+    int32_t yawPID_F;
+    uint32_t tailLag;
+    uint8_t saturation;
+    int16_t rcCommand[4];
+    int16_t gyroADC[XYZ_AXIS_COUNT];
+    int16_t accSmooth[XYZ_AXIS_COUNT];
+    int16_t debug[DEBUG16_VALUE_COUNT];
+    int16_t motor[TEST_MOTOR_COUNT];
+    uint16_t tailServo;
+    uint16_t vbat;
+    int32_t amperage;
+    int16_t magADC[XYZ_AXIS_COUNT];
+    int32_t BaroAlt;
+    uint16_t rssi;
+} testFrame_t;
+
+static std::map<uint32_t, testFrame_t> expectedFrames;
+static std::vector<flightLogEvent_t> expectedEvents;
+
+// Called before each loop iteration flown, to set what the triggers of the triggered mode look at
+static void (*testBeforeIteration)(int iteration);
+static failsafePhase_e testFailsafePhase;
+static bool testBlackboxSwitch;
+
+static uint32_t randomState;
+
+static int32_t randomBetween(int32_t min, int32_t max)
+{
+    randomState = randomState * 1103515245 + 12345;
+    return min + (int32_t)((randomState >> 8) % (uint32_t)(max - min + 1));
+}
+
+// Mostly small steps, so the small encodings are used, with the odd jump that needs the wide ones
+static int32_t randomWalk(int32_t value, int32_t min, int32_t max)
+{
+    value += randomBetween(0, 15) == 0 ? randomBetween(-30000, 30000) : randomBetween(-3, 3);
+    return constrain(value, min, max);
+}
+
+static void resetConfig(uint8_t rateNum, uint8_t rateDenom)
+{
+    pgResetAll(MAX_PROFILE_COUNT);
+    pgActivateProfile(0);
+    currentControlRateProfile = controlRateProfiles(0);
+
+    blackboxConfig()->device = BLACKBOX_DEVICE_SERIAL;
+    blackboxConfig()->rate_num = rateNum;
+    blackboxConfig()->rate_denom = rateDenom;
+    blackboxConfig()->timing_rate = 50;
+    for (int i = 0; i < TASK_COUNT; i++) {
+        cfTasks[i].taskName = "TEST";
+    }
+
+    motorConfig()->minthrottle = TEST_MINTHROTTLE;
+    mixerConfig()->mixerMode = MIXER_TRI;
+    motorCount = TEST_MOTOR_COUNT;
+    rxConfig()->rssi_channel = 8;
+
+    pidProfile()->pidController = PID_CONTROLLER_LUX_FLOAT;
+    pidProfile()->D8[ROLL] = 10;
+    pidProfile()->D8[PITCH] = 10;
+    pidProfile()->D8[YAW] = 0;
+    pidProfile()->yaw_ff_lead_ms = 20;
+
+    targetPidLooptime = TEST_LOOPTIME_US;
+    pidDeltaUs = TEST_LOOPTIME_US;
+    gyro.scale = 1.0f / 16.4f;
+    acc.acc_1G = 512;
+
+    serialBytes.clear();
+    expectedFrames.clear();
+    expectedEvents.clear();
+    randomState = 1;
+    testVbat = 168;
+    flightModeFlags = 0;
+
+    testBeforeIteration = NULL;
+    testFailsafePhase = FAILSAFE_IDLE;
+    testBlackboxSwitch = false;
+    motorLimitReached = false;
+}
+
+static void randomiseFrame(testFrame_t *frame)
+{
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        frame->axisPID_P[axis] = randomWalk(frame->axisPID_P[axis], -100000, 100000);
+        frame->axisPID_I[axis] = randomWalk(frame->axisPID_I[axis], -10000000, 10000000);
+        frame->axisPID_D[axis] = axis == YAW ? 0 : randomWalk(frame->axisPID_D[axis], -5000, 5000);
+        frame->gyroADC[axis] = randomWalk(frame->gyroADC[axis], -32768, 32767);
+        frame->accSmooth[axis] = randomWalk(frame->accSmooth[axis], -4096, 4096);
+        frame->magADC[axis] = randomWalk(frame->magADC[axis], -2000, 2000);
+    }
+    for (int i = 0; i < DEBUG16_VALUE_COUNT; i++) {
+        frame->debug[i] = randomWalk(frame->debug[i], -32768, 32767);
+    }
+    frame->yawPID_F = randomWalk(frame->yawPID_F, -500, 500);
+    frame->tailLag = randomBetween(0, 3) * 62500; // exact in a float
+    frame->saturation = randomBetween(0, 7);
+    for (int i = 0; i < 3; i++) {
+        frame->rcCommand[i] = randomWalk(frame->rcCommand[i], -500, 500);
+    }
+    frame->rcCommand[THROTTLE] = randomWalk(frame->rcCommand[THROTTLE], 1000, 2000);
+    for (int i = 0; i < TEST_MOTOR_COUNT; i++) {
+        frame->motor[i] = randomWalk(frame->motor[i], 1000, 2000);
+    }
+    frame->tailServo = randomWalk(frame->tailServo, 0, 1800);
+    frame->vbat = randomBetween(0, 31) ? frame->vbat : randomBetween(100, 250);
+    frame->amperage = randomBetween(0, 31) ? frame->amperage : randomBetween(-1000, 100000);
+    frame->BaroAlt = randomWalk(frame->BaroAlt, -100000, 100000);
+    frame->rssi = randomBetween(0, 63) ? frame->rssi : randomBetween(0, 1023);
+}
+
+static void applyFrame(const testFrame_t *frame)
+{
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        axisPID_P[axis] = frame->axisPID_P[axis];
+        axisPID_I[axis] = frame->axisPID_I[axis];
+        axisPID_D[axis] = frame->axisPID_D[axis];
+        gyroADC[axis] = frame->gyroADC[axis];
+        accSmooth[axis] = frame->accSmooth[axis];
+        magADC[axis] = frame->magADC[axis];
+    }
+    axisPID_F[YAW] = frame->yawPID_F;
+    tailLagTime = frame->tailLag / 1000000.0f;
+    pidSaturationFlags = frame->saturation;
+    memcpy(rcCommand, frame->rcCommand, sizeof(rcCommand));
+    memcpy(debug, frame->debug, sizeof(debug));
+    for (int i = 0; i < TEST_MOTOR_COUNT; i++) {
+        motor[i] = frame->motor[i];
+    }
+    testTailServoAngle = frame->tailServo;
+    testVbat = frame->vbat;
+    testAmperageMeter.amperage = frame->amperage;
+    BaroAlt = frame->BaroAlt;
+    rssi = frame->rssi;
+}
+
+/*
+ * Runs the firmware blackbox for the given number of loop iterations of changing flight data, then ends the log.
+ */
+static void flyAndLog(int iterations)
+{
+    testFrame_t frame;
+
+    memset(&frame, 0, sizeof(frame));
+    frame.rcCommand[THROTTLE] = 1200;
+    frame.vbat = testVbat;
+    for (int i = 0; i < TEST_MOTOR_COUNT; i++) {
+        frame.motor[i] = 1300;
+    }
+    frame.tailServo = 900;
+    applyFrame(&frame);
+
+    initBlackbox();
+    startBlackbox();
+
+    for (int i = 0; i < iterations; i++) {
+        testMicros += TEST_LOOPTIME_US;
+        currentTime = testMicros;
+
+        randomiseFrame(&frame);
+        applyFrame(&frame);
+        expectedFrames[currentTime] = frame;
+
+        if (i % 200 == 100) {
+            flightModeFlags ^= ANGLE_MODE;
+        }
+        if (i % 100 == 50) {
+            GPS_numSat = i / 100;
+            GPS_coord[0] = 500000000 + i * 1234;
+            GPS_coord[1] = -1000000 - i * 77;
+            GPS_altitude = i;
+            GPS_speed = 2 * i;
+            GPS_ground_course = 3 * i;
+        }
+        if (i == 500) {
+            GPS_home[0] = 500000000;
+            GPS_home[1] = -1000000;
+        }
+        // Events are only logged once the headers are out
+        if (i >= 1000 && i % 300 == 250) {
+            flightLogEvent_t event;
+
+            memset(&event, 0, sizeof(event));
+            event.event = FLIGHT_LOG_EVENT_INFLIGHT_ADJUSTMENT;
+            event.data.inflightAdjustment.adjustmentFunction = i / 300 + 1;
+            event.data.inflightAdjustment.floatFlag = (i / 300) % 2;
+            event.data.inflightAdjustment.newValue = event.data.inflightAdjustment.floatFlag ? 0 : -i;
+            event.data.inflightAdjustment.newFloatValue = event.data.inflightAdjustment.floatFlag ? i / 8.0f : 0;
+            blackboxLogEvent(event.event, &event.data);
+            expectedEvents.push_back(event);
+        }
+        if (testBeforeIteration) {
+            testBeforeIteration(i);
+        }
+
+        handleBlackbox();
+    }
+
+    // Long enough for the ring of the triggered mode to be sent over the slowest device
+    finishBlackbox();
+    for (int i = 0; i < 2500; i++) {
+        testMicros += TEST_LOOPTIME_US;
+        currentTime = testMicros;
+        handleBlackbox();
+    }
+}
+
+// Runs the loop while disarmed, when the blackbox is stopped
+static void stayDisarmed(int iterations)
+{
+    for (int i = 0; i < iterations; i++) {
+        testMicros += TEST_LOOPTIME_US;
+        currentTime = testMicros;
+        handleBlackbox();
+    }
+}
+
+typedef struct decodedLog_s {
+    const blackboxFrameDef_t *mainDef;
+    std::vector<std::vector<int32_t> > mainFrames;
+    std::vector<std::vector<int32_t> > slowFrames;
+    std::vector<std::vector<int32_t> > gpsFrames;
+    std::vector<std::vector<int32_t> > timingFrames;
+    std::vector<flightLogEvent_t> events;
+    std::vector<size_t> eventMainFrameIndexes;  // Main frames decoded before each event
+    std::vector<char> mainFrameTypes;
+} decodedLog_t;
+
+static void collectFrame(void *context, char frameType, const int32_t *values, int valueCount)
+{
+    decodedLog_t *decoded = (decodedLog_t *)context;
+    std::vector<int32_t> frame(values, values + valueCount);
+
+    switch (frameType) {
+        case 'I':
+        case 'P':
+            decoded->mainFrames.push_back(frame);
+            decoded->mainFrameTypes.push_back(frameType);
+        break;
+        case 'S':
+            decoded->slowFrames.push_back(frame);
+        break;
+        case 'G':
+            decoded->gpsFrames.push_back(frame);
+        break;
+        case 'T':
+            decoded->timingFrames.push_back(frame);
+        break;
+    }
+}
+
+static void collectEvent(void *context, const flightLogEvent_t *event)
+{
+    decodedLog_t *decoded = (decodedLog_t *)context;
+
+    decoded->events.push_back(*event);
+    decoded->eventMainFrameIndexes.push_back(decoded->mainFrames.size());
+}
+
+static int32_t field(const decodedLog_t *decoded, const std::vector<int32_t> &frame, const char *name)
+{
+    int index = blackboxFieldIndex(decoded->mainDef, name);
+
+    EXPECT_GE(index, 0) << name;
+    return index >= 0 ? frame[index] : 0;
+}
+
+static void expectMainFrame(const decodedLog_t *decoded, const std::vector<int32_t> &frame, const testFrame_t *expected)
+{
+    static const char * const axisNames[] = { "[0]", "[1]", "[2]" };
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        EXPECT_EQ(expected->axisPID_P[axis], field(decoded, frame, (std::string("axisP") + axisNames[axis]).c_str()));
+        EXPECT_EQ(expected->axisPID_I[axis], field(decoded, frame, (std::string("axisI") + axisNames[axis]).c_str()));
+        EXPECT_EQ(expected->gyroADC[axis], field(decoded, frame, (std::string("gyroADC") + axisNames[axis]).c_str()));
+        EXPECT_EQ(expected->accSmooth[axis], field(decoded, frame, (std::string("accSmooth") + axisNames[axis]).c_str()));
+        EXPECT_EQ(expected->magADC[axis], field(decoded, frame, (std::string("magADC") + axisNames[axis]).c_str()));
+    }
+    EXPECT_EQ(expected->axisPID_D[ROLL], field(decoded, frame, "axisD[0]"));
+    EXPECT_EQ(expected->axisPID_D[PITCH], field(decoded, frame, "axisD[1]"));
+    EXPECT_EQ(expected->yawPID_F, field(decoded, frame, "axisF[2]"));
+    EXPECT_EQ(expected->tailLag, (uint32_t)field(decoded, frame, "tailLag"));
+    EXPECT_EQ(expected->saturation, field(decoded, frame, "saturation"));
+    for (int i = 0; i < 4; i++) {
+        EXPECT_EQ(expected->rcCommand[i], field(decoded, frame, (std::string("rcCommand[") + (char)('0' + i) + "]").c_str()));
+    }
+    for (int i = 0; i < TEST_MOTOR_COUNT; i++) {
+        EXPECT_EQ(expected->motor[i], field(decoded, frame, (std::string("motor[") + (char)('0' + i) + "]").c_str()));
+    }
+    EXPECT_EQ(expected->tailServo, field(decoded, frame, "servo[5]"));
+    EXPECT_EQ(expected->vbat, field(decoded, frame, "vbatLatest"));
+    EXPECT_EQ(expected->amperage, field(decoded, frame, "amperageLatest"));
+    EXPECT_EQ(expected->BaroAlt, field(decoded, frame, "BaroAlt"));
+    EXPECT_EQ(expected->rssi, field(decoded, frame, "rssi"));
+    if (debugMode != DEBUG_NONE) {
+        for (int i = 0; i < DEBUG16_VALUE_COUNT; i++) {
+            EXPECT_EQ(expected->debug[i], field(decoded, frame, (std::string("debug[") + (char)('0' + i) + "]").c_str()));
+        }
+    } else {
+        EXPECT_LT(blackboxFieldIndex(decoded->mainDef, "debug[0]"), 0);
+    }
+}
+
+static void decode(const blackboxLog_t *log, decodedLog_t *decoded, blackboxDecodeStats_t *stats)
+{
+    decoded->mainDef = &log->frameDefs['I'];
+    blackboxDecodeLog(log, collectFrame, collectEvent, decoded, stats);
+}
+
+// The GPS frames flyAndLog() writes, which tell the iteration they were set at by their altitude
+static void expectGpsFrames(const blackboxLog_t *log, const decodedLog_t *decoded)
+{
+    ASSERT_FALSE(decoded->gpsFrames.empty());
+    const blackboxFrameDef_t *gpsDef = &log->frameDefs['G'];
+    for (const std::vector<int32_t> &frame : decoded->gpsFrames) {
+        const int32_t i = frame[blackboxFieldIndex(gpsDef, "GPS_altitude")];
+
+        EXPECT_EQ(i / 100, frame[blackboxFieldIndex(gpsDef, "GPS_numSat")]);
+        EXPECT_EQ(500000000 + i * 1234, frame[blackboxFieldIndex(gpsDef, "GPS_coord[0]")]);
+        EXPECT_EQ(-1000000 - i * 77, frame[blackboxFieldIndex(gpsDef, "GPS_coord[1]")]);
+        EXPECT_EQ(2 * i, frame[blackboxFieldIndex(gpsDef, "GPS_speed")]);
+        EXPECT_EQ(3 * i, frame[blackboxFieldIndex(gpsDef, "GPS_ground_course")]);
+    }
+}
+
+static void expectRoundTrip(uint8_t rateNum, uint8_t rateDenom)
+{
+    resetConfig(rateNum, rateDenom);
+    flyAndLog(2000);
+
+    std::vector<blackboxLog_t> logs = blackboxFindLogs(serialBytes.data(), serialBytes.size());
+    ASSERT_EQ(1U, logs.size());
+
+    const blackboxLog_t *log = &logs[0];
+    EXPECT_EQ(TEST_MINTHROTTLE, (int)log->minthrottle);
+    EXPECT_EQ(rateNum, log->frameIntervalPNum);
+    EXPECT_EQ(rateDenom, log->frameIntervalPDenom);
+    EXPECT_EQ(std::string("Cleanflight"), log->headers.at("Firmware type"));
+    EXPECT_EQ(std::to_string(debugMode), log->headers.at("debug_mode"));
+
+    decodedLog_t decoded;
+    blackboxDecodeStats_t stats;
+    decode(log, &decoded, &stats);
+
+    EXPECT_TRUE(stats.reachedLogEnd);
+    EXPECT_EQ(0U, stats.corruptFrameCount);
+    EXPECT_EQ(0U, stats.skippedByteCount);
+    EXPECT_GT(stats.frameCount['I'], 0U);
+    EXPECT_GT(stats.frameCount['P'], 0U);
+
+    // Every frame the firmware logged is decoded to what the flight controller had at the time
+    ASSERT_GT(decoded.mainFrames.size(), 1000U * rateNum / rateDenom);
+    const int32_t firstIteration = field(&decoded, decoded.mainFrames[0], "loopIteration");
+    const uint32_t firstTime = field(&decoded, decoded.mainFrames[0], "time");
+    for (const std::vector<int32_t> &frame : decoded.mainFrames) {
+        const uint32_t time = field(&decoded, frame, "time");
+
+        ASSERT_EQ(1U, expectedFrames.count(time));
+        EXPECT_EQ((int32_t)((time - firstTime) / TEST_LOOPTIME_US), field(&decoded, frame, "loopIteration") - firstIteration);
+        expectMainFrame(&decoded, frame, &expectedFrames[time]);
+    }
+    EXPECT_EQ(decoded.mainFrames.size(), stats.frameCount['I'] + stats.frameCount['P']);
+
+    EXPECT_FALSE(decoded.slowFrames.empty());
+    EXPECT_EQ((int32_t)flightModeFlags, decoded.slowFrames.back()[0]);
+
+    expectGpsFrames(log, &decoded);
+
+    ASSERT_FALSE(decoded.timingFrames.empty());
+    for (const std::vector<int32_t> &frame : decoded.timingFrames) {
+        EXPECT_EQ(TEST_LOOPTIME_US, frame[blackboxFieldIndex(&log->frameDefs['T'], "loopDeltaMax")]);
+    }
+
+    ASSERT_EQ(expectedEvents.size() + 1, decoded.events.size());
+    for (size_t i = 0; i < expectedEvents.size(); i++) {
+        const flightLogEvent_inflightAdjustment_t *expected = &expectedEvents[i].data.inflightAdjustment;
+        const flightLogEvent_inflightAdjustment_t *actual = &decoded.events[i].data.inflightAdjustment;
+
+        EXPECT_EQ(FLIGHT_LOG_EVENT_INFLIGHT_ADJUSTMENT, decoded.events[i].event);
+        EXPECT_EQ(expected->adjustmentFunction, actual->adjustmentFunction);
+        EXPECT_EQ(expected->floatFlag, actual->floatFlag);
+        EXPECT_EQ(expected->newValue, actual->newValue);
+        EXPECT_EQ(expected->newFloatValue, actual->newFloatValue);
+    }
+    EXPECT_EQ(FLIGHT_LOG_EVENT_LOG_END, decoded.events.back().event);
+}
+
+TEST(BlackboxDecoderTest, DecodesEveryFrameOfFirmwareLog)
+{
+    expectRoundTrip(1, 1);
+}
+
+TEST(BlackboxDecoderTest, DecodesFirmwareLogOfSomeFrames)
+{
+    // Skips a different number of iterations between frames, the loop iteration prediction has to follow that
+    expectRoundTrip(2, 3);
+}
+
+TEST(BlackboxDecoderTest, DecodesDebugFieldsOfFirmwareLog)
+{
+    // The replay takes the unfiltered gyro from the debug fields of a log made with debug_mode = GYRO
+    debugMode = DEBUG_GYRO;
+    expectRoundTrip(1, 1);
+    debugMode = DEBUG_NONE;
+}
+
+TEST(BlackboxDecoderTest, FindsEachLogOfFile)
+{
+    resetConfig(1, 1);
+    flyAndLog(1200);
+    flyAndLog(1500);
+
+    std::vector<blackboxLog_t> logs = blackboxFindLogs(serialBytes.data(), serialBytes.size());
+    ASSERT_EQ(2U, logs.size());
+    EXPECT_EQ(logs[0].end, logs[1].start);
+
+    for (const blackboxLog_t &log : logs) {
+        decodedLog_t decoded;
+        blackboxDecodeStats_t stats;
+
+        decode(&log, &decoded, &stats);
+        EXPECT_TRUE(stats.reachedLogEnd);
+        EXPECT_EQ(0U, stats.corruptFrameCount);
+    }
+}
+
+static std::string pidHeader(int pidIndex)
+{
+    char header[32];
+
+    snprintf(header, sizeof(header), "%d,%d,%d", pidProfile()->P8[pidIndex], pidProfile()->I8[pidIndex], pidProfile()->D8[pidIndex]);
+    return header;
+}
+
+// The header is rendered ahead of arming, the settings it was rendered from may have changed since
+TEST(BlackboxDecoderTest, HeaderFollowsSettingsChangedBeforeArming)
+{
+    std::string rollPID[3];
+
+    resetConfig(1, 1);
+    stayDisarmed(1000);
+    rollPID[0] = pidHeader(ROLL);
+    flyAndLog(1200);
+
+    // Long enough before arming for the header to be rendered again while disarmed
+    pidProfile()->P8[ROLL] = 77;
+    testVbat = 150;
+    stayDisarmed(2000);
+    rollPID[1] = pidHeader(ROLL);
+    flyAndLog(1200);
+
+    // Just before arming, with a logging rate that arming reduces to 1/2
+    pidProfile()->P8[ROLL] = 78;
+    blackboxConfig()->rate_num = 2;
+    blackboxConfig()->rate_denom = 4;
+    testVbat = 140;
+    rollPID[2] = pidHeader(ROLL);
+    flyAndLog(1200);
+
+    std::vector<blackboxLog_t> logs = blackboxFindLogs(serialBytes.data(), serialBytes.size());
+    ASSERT_EQ(3U, logs.size());
+
+    const uint32_t vbatref[3] = {168, 150, 140};
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ(rollPID[i], logs[i].headers.at("rollPID"));
+        EXPECT_EQ(vbatref[i], logs[i].vbatref);
+        EXPECT_EQ(i == 2 ? 2U : 1U, logs[i].frameIntervalPDenom);
+
+        decodedLog_t decoded;
+        blackboxDecodeStats_t stats;
+
+        decode(&logs[i], &decoded, &stats);
+        EXPECT_TRUE(stats.reachedLogEnd);
+        EXPECT_EQ(0U, stats.corruptFrameCount);
+        EXPECT_GT(stats.frameCount['P'], 0U);
+    }
+}
+
+TEST(BlackboxDecoderTest, ResynchronisesAfterCorruption)
+{
+    resetConfig(1, 1);
+    flyAndLog(2000);
+
+    std::vector<blackboxLog_t> logs = blackboxFindLogs(serialBytes.data(), serialBytes.size());
+    ASSERT_EQ(1U, logs.size());
+
+    decodedLog_t clean;
+    blackboxDecodeStats_t cleanStats;
+    decode(&logs[0], &clean, &cleanStats);
+
+    // Drop some bytes from the middle of the frames, as a logger dropping a buffer would
+    const size_t dropAt = logs[0].framesStart - serialBytes.data() + (logs[0].end - logs[0].framesStart) / 2;
+    serialBytes.erase(serialBytes.begin() + dropAt, serialBytes.begin() + dropAt + 7);
+
+    logs = blackboxFindLogs(serialBytes.data(), serialBytes.size());
+    ASSERT_EQ(1U, logs.size());
+
+    decodedLog_t decoded;
+    blackboxDecodeStats_t stats;
+    decode(&logs[0], &decoded, &stats);
+
+    EXPECT_GT(stats.corruptFrameCount + stats.skippedByteCount, 0U);
+    EXPECT_TRUE(stats.reachedLogEnd);
+
+    // Decoding picks up again at the next "I" frame, so no more than an "I" interval of frames is lost
+    EXPECT_LT(decoded.mainFrames.size(), clean.mainFrames.size());
+    EXPECT_GE(decoded.mainFrames.size() + 2 * 32, clean.mainFrames.size());
+    for (const std::vector<int32_t> &frame : decoded.mainFrames) {
+        const uint32_t time = field(&decoded, frame, "time");
+
+        ASSERT_EQ(1U, expectedFrames.count(time));
+        expectMainFrame(&decoded, frame, &expectedFrames[time]);
+    }
+}
+
+// Times of the first and last frame of a run of frames of consecutive loop iterations
+typedef struct frameRun_s {
+    uint32_t firstTime;
+    uint32_t lastTime;
+} frameRun_t;
+
+/*
+ * Checks a log of the triggered mode, that every frame decodes to what was flown and that each run of frames after a
+ * gap starts at an "I" frame the log was told of by a resume event. Returns the runs of frames.
+ */
+static std::vector<frameRun_t> expectTriggeredLog(const blackboxLog_t *log, decodedLog_t *decoded)
+{
+    std::vector<frameRun_t> runs;
+    blackboxDecodeStats_t stats;
+    int32_t lastIteration = 0;
+
+    decode(log, decoded, &stats);
+    EXPECT_TRUE(stats.reachedLogEnd);
+    EXPECT_EQ(0U, stats.corruptFrameCount);
+    EXPECT_EQ(0U, stats.skippedByteCount);
+
+    for (size_t i = 0; i < decoded->mainFrames.size(); i++) {
+        const std::vector<int32_t> &frame = decoded->mainFrames[i];
+        const int32_t iteration = field(decoded, frame, "loopIteration");
+        const uint32_t time = field(decoded, frame, "time");
+
+        EXPECT_EQ(1U, expectedFrames.count(time));
+        expectMainFrame(decoded, frame, &expectedFrames[time]);
+
+        if (!runs.empty() && iteration == lastIteration + 1) {
+            runs.back().lastTime = time;
+        } else {
+            bool resumed = false;
+
+            for (size_t e = 0; e < decoded->events.size(); e++) {
+                if (decoded->eventMainFrameIndexes[e] == i && decoded->events[e].event == FLIGHT_LOG_EVENT_LOGGING_RESUME) {
+                    EXPECT_EQ((uint32_t)iteration, decoded->events[e].data.loggingResume.logIteration);
+                    EXPECT_EQ(time, decoded->events[e].data.loggingResume.currentTime);
+                    resumed = true;
+                }
+            }
+            EXPECT_TRUE(resumed) << "run at iteration " << iteration;
+            EXPECT_EQ('I', decoded->mainFrameTypes[i]);
+
+            runs.push_back({ time, time });
+        }
+        lastIteration = iteration;
+    }
+
+    // Each run starts with the slow state, as it is not known from the frames before it
+    EXPECT_GE(decoded->slowFrames.size(), runs.size());
+
+    return runs;
+}
+
+static void setTriggeredMode(uint8_t triggers, uint16_t preTriggerMs, uint16_t postTriggerMs)
+{
+    blackboxConfig()->mode = BLACKBOX_MODE_TRIGGERED;
+    blackboxConfig()->triggers = triggers;
+    blackboxConfig()->pre_trigger_ms = preTriggerMs;
+    blackboxConfig()->post_trigger_ms = postTriggerMs;
+}
+
+// The serial rate is kept low for an OpenLog, this raises it to that of flash
+static void sendAtFlashRate(void)
+{
+    targetPidLooptime = 25000;
+}
+
+static uint32_t testTriggerTime[2];
+
+static void pressSwitchOnce(int iteration)
+{
+    testBlackboxSwitch = iteration == 1500;
+    if (testBlackboxSwitch) {
+        testTriggerTime[0] = currentTime;
+    }
+}
+
+TEST(BlackboxDecoderTest, TriggeredModeLogsFramesAroundTrigger)
+{
+    resetConfig(1, 1);
+    setTriggeredMode(BLACKBOX_TRIGGER_SWITCH, 50, 200);
+    sendAtFlashRate();
+    testBeforeIteration = pressSwitchOnce;
+    flyAndLog(3000);
+
+    std::vector<blackboxLog_t> logs = blackboxFindLogs(serialBytes.data(), serialBytes.size());
+    ASSERT_EQ(1U, logs.size());
+
+    decodedLog_t decoded;
+    std::vector<frameRun_t> runs = expectTriggeredLog(&logs[0], &decoded);
+
+    // From the start of the "I" interval pre_trigger_ms before, to the end of the one post_trigger_ms after
+    ASSERT_EQ(1U, runs.size());
+    EXPECT_LE(runs[0].firstTime, testTriggerTime[0] - 50000);
+    EXPECT_GT(runs[0].firstTime, testTriggerTime[0] - 50000 - 32 * TEST_LOOPTIME_US);
+    EXPECT_GE(runs[0].lastTime, testTriggerTime[0] + 200000);
+    EXPECT_LT(runs[0].lastTime, testTriggerTime[0] + 200000 + 32 * TEST_LOOPTIME_US);
+
+    expectGpsFrames(&logs[0], &decoded);
+    EXPECT_EQ(FLIGHT_LOG_EVENT_LOG_END, decoded.events.back().event);
+}
+
+TEST(BlackboxDecoderTest, TriggeredModeWithoutTriggerLogsNoFrames)
+{
+    resetConfig(1, 1);
+    setTriggeredMode(BLACKBOX_TRIGGER_FAILSAFE | BLACKBOX_TRIGGER_MOTOR_LIMIT | BLACKBOX_TRIGGER_SWITCH, 2000, 2000);
+    flyAndLog(3000);
+
+    std::vector<blackboxLog_t> logs = blackboxFindLogs(serialBytes.data(), serialBytes.size());
+    ASSERT_EQ(1U, logs.size());
+
+    decodedLog_t decoded;
+    blackboxDecodeStats_t stats;
+    decode(&logs[0], &decoded, &stats);
+
+    EXPECT_TRUE(stats.reachedLogEnd);
+    EXPECT_TRUE(decoded.mainFrames.empty());
+    ASSERT_EQ(1U, decoded.events.size());
+    EXPECT_EQ(FLIGHT_LOG_EVENT_LOG_END, decoded.events[0].event);
+}
+
+// Keeps the gyro clear of the crash trigger but for one spike, a motor limit burst too short to trigger, a failsafe and a longer burst
+static void flyIntoTriggers(int iteration)
+{
+    testFrame_t *expected = &expectedFrames[currentTime];
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        expected->gyroADC[axis] = constrain(expected->gyroADC[axis], -20000, 20000);
+    }
+    if (iteration == 1500) {
+        expected->gyroADC[PITCH] = -31000;
+        testTriggerTime[0] = currentTime;
+    }
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        gyroADC[axis] = expected->gyroADC[axis];
+    }
+
+    testFailsafePhase = iteration == 2000 ? FAILSAFE_RX_LOSS_DETECTED : FAILSAFE_IDLE;
+    motorLimitReached = (iteration >= 1000 && iteration < 1050) || (iteration >= 2500 && iteration < 2700);
+    if (iteration == 2600) {
+        testTriggerTime[1] = currentTime;
+    }
+}
+
+TEST(BlackboxDecoderTest, TriggeredModeTriggersOnCrashFailsafeAndMotorLimitBursts)
+{
+    resetConfig(1, 1);
+    setTriggeredMode(BLACKBOX_TRIGGER_CRASH | BLACKBOX_TRIGGER_FAILSAFE | BLACKBOX_TRIGGER_MOTOR_LIMIT, 20, 50);
+    sendAtFlashRate();
+    testBeforeIteration = flyIntoTriggers;
+    flyAndLog(3000);
+
+    std::vector<blackboxLog_t> logs = blackboxFindLogs(serialBytes.data(), serialBytes.size());
+    ASSERT_EQ(1U, logs.size());
+
+    decodedLog_t decoded;
+    std::vector<frameRun_t> runs = expectTriggeredLog(&logs[0], &decoded);
+
+    // The gyro spike, the failsafe 500ms after it and the motor limit held from 100ms into the burst to its end
+    ASSERT_EQ(3U, runs.size());
+    EXPECT_LE(runs[0].firstTime, testTriggerTime[0] - 20000);
+    EXPECT_GE(runs[0].lastTime, testTriggerTime[0] + 50000);
+    EXPECT_LE(runs[1].firstTime, testTriggerTime[0] + 500000 - 20000);
+    EXPECT_GE(runs[1].lastTime, testTriggerTime[0] + 500000 + 50000);
+    EXPECT_LE(runs[2].firstTime, testTriggerTime[1] - 20000);
+    EXPECT_GT(runs[2].firstTime, testTriggerTime[1] - 20000 - 32 * TEST_LOOPTIME_US);
+    EXPECT_GE(runs[2].lastTime, testTriggerTime[1] + 99 * TEST_LOOPTIME_US + 50000);
+    EXPECT_LT(runs[2].lastTime, testTriggerTime[1] + 99 * TEST_LOOPTIME_US + 50000 + 32 * TEST_LOOPTIME_US);
+}
+
+static void holdSwitchToDisarm(int iteration)
+{
+    testBlackboxSwitch = iteration >= 2900;
+}
+
+TEST(BlackboxDecoderTest, TriggeredModeSendsTheRingOnDisarm)
+{
+    resetConfig(1, 1);
+    setTriggeredMode(BLACKBOX_TRIGGER_SWITCH, 100, 2000);
+    sendAtFlashRate();
+    testBeforeIteration = holdSwitchToDisarm;
+    flyAndLog(3000);
+
+    std::vector<blackboxLog_t> logs = blackboxFindLogs(serialBytes.data(), serialBytes.size());
+    ASSERT_EQ(1U, logs.size());
+
+    decodedLog_t decoded;
+    std::vector<frameRun_t> runs = expectTriggeredLog(&logs[0], &decoded);
+
+    // Up to the last iteration before disarming, with the end of the log after it
+    ASSERT_EQ(1U, runs.size());
+    EXPECT_EQ(expectedFrames.rbegin()->first, runs[0].lastTime);
+    EXPECT_EQ(FLIGHT_LOG_EVENT_LOG_END, decoded.events.back().event);
+}
+
+static void holdSwitchLong(int iteration)
+{
+    testBlackboxSwitch = iteration >= 1000 && iteration < 2500;
+}
+
+TEST(BlackboxDecoderTest, TriggeredModeOverSlowDeviceOnlySkipsWholeIntervals)
+{
+    // The OpenLog rate is far below that of the frames, so the ring fills up and frames are dropped
+    resetConfig(1, 1);
+    setTriggeredMode(BLACKBOX_TRIGGER_SWITCH, 100, 100);
+    testBeforeIteration = holdSwitchLong;
+    flyAndLog(3000);
+
+    std::vector<blackboxLog_t> logs = blackboxFindLogs(serialBytes.data(), serialBytes.size());
+    ASSERT_EQ(1U, logs.size());
+
+    decodedLog_t decoded;
+    std::vector<frameRun_t> runs = expectTriggeredLog(&logs[0], &decoded);
+
+    EXPECT_GT(runs.size(), 2U);
+    EXPECT_EQ(FLIGHT_LOG_EVENT_LOG_END, decoded.events.back().event);
+}
+
+TEST(BlackboxDecoderTest, TriggeredModeOverSlowDeviceKeepsTheFramesOfTheTrigger)
+{
+    // More pre-trigger frames than the ring holds, so what is not yet sent of them makes room for the trigger
+    resetConfig(1, 1);
+    setTriggeredMode(BLACKBOX_TRIGGER_SWITCH, 1000, 100);
+    testBeforeIteration = pressSwitchOnce;
+    flyAndLog(3000);
+
+    std::vector<blackboxLog_t> logs = blackboxFindLogs(serialBytes.data(), serialBytes.size());
+    ASSERT_EQ(1U, logs.size());
+
+    decodedLog_t decoded;
+    std::vector<frameRun_t> runs = expectTriggeredLog(&logs[0], &decoded);
+
+    // Every frame from the "I" interval of the trigger to post_trigger_ms after it, after the oldest of the others
+    ASSERT_GE(runs.size(), 2U);
+    EXPECT_LE(runs.back().firstTime, testTriggerTime[0]);
+    EXPECT_GT(runs.back().firstTime, testTriggerTime[0] - 32 * TEST_LOOPTIME_US);
+    EXPECT_GE(runs.back().lastTime, testTriggerTime[0] + 100000);
+    EXPECT_LT(runs.front().lastTime, testTriggerTime[0] - 32 * TEST_LOOPTIME_US);
+    EXPECT_EQ(FLIGHT_LOG_EVENT_LOG_END, decoded.events.back().event);
+}
+
+// STUBS
+
+extern "C" {
+uint8_t armingFlags;
+uint16_t flightModeFlags;
+uint8_t stateFlags;
+
+int16_t debug[DEBUG16_VALUE_COUNT];
+uint8_t debugMode;
+const char * const buildDate = "Jan 01 1970";
+const char * const buildTime = "00:00:00";
+const char * const shortGitRevision = "test";
+
+uint32_t currentTime;
+uint16_t averageSystemLoadPercent;
+uint16_t pidDeltaUs;
+cfTask_t cfTasks[TASK_COUNT] = {};
+void getTaskTimingWindow(const int, cfTaskTimingWindow_t *window) { memset(window, 0, sizeof(*window)); }
+
+uint32_t micros(void) { return testMicros; }
+uint32_t millis(void) { return testMicros / 1000; }
+
+bool feature(uint32_t mask) { return mask & (FEATURE_BLACKBOX | FEATURE_GPS | FEATURE_VBAT | FEATURE_AMPERAGE_METER); }
+bool sensors(uint32_t mask) { return mask & (SENSOR_GYRO | SENSOR_ACC | SENSOR_MAG | SENSOR_BARO); }
+uint8_t getCurrentProfile(void) { return 0; }
+
+controlRateConfig_t *currentControlRateProfile;
+gyro_t gyro;
+acc_t acc;
+int32_t gyroADC[XYZ_AXIS_COUNT];
+int16_t accSmooth[XYZ_AXIS_COUNT];
+int32_t magADC[XYZ_AXIS_COUNT];
+int32_t BaroAlt;
+
+int32_t axisPID_P[FD_INDEX_COUNT], axisPID_I[FD_INDEX_COUNT], axisPID_D[FD_INDEX_COUNT];
+int32_t axisPID_F[FD_INDEX_COUNT];
+uint8_t pidSaturationFlags;
+float tailLagTime;
+uint32_t targetPidLooptime;
+uint8_t motorCount;
+int16_t motor[MAX_SUPPORTED_MOTORS];
+bool motorLimitReached;
+uint16_t triGetCurrentServoAngle(void) { return testTailServoAngle; }
+
+int32_t GPS_home[2];
+int32_t GPS_coord[2];
+uint8_t GPS_numSat;
+uint16_t GPS_altitude;
+uint16_t GPS_speed;
+uint16_t GPS_ground_course;
+
+int16_t rcCommand[4];
+uint16_t rssi;
+bool rxIsReceivingSignal(void) { return true; }
+bool rxAreFlightChannelsValid(void) { return true; }
+uint32_t rxGetFrameAge(uint32_t) { return 0; }
+bool rcModeIsActive(boxId_e boxId) { return boxId == BOXBLACKBOX && testBlackboxSwitch; }
+bool rcModeIsActivationConditionPresent(modeActivationCondition_t *, boxId_e) { return false; }
+
+failsafePhase_e failsafePhase(void) { return testFailsafePhase; }
+
+uint32_t getArmingBeepTimeMicros(void) { return 0; }
+
+uint16_t getLatestVoltageForADCChannel(uint8_t) { return testVbat; }
+static voltageMeterConfig_t testVoltageMeterConfig;
+voltageMeterConfig_t *getVoltageMeterConfig(const uint8_t) { return &testVoltageMeterConfig; }
+amperageMeter_t *getAmperageMeter(amperageMeter_e) { return &testAmperageMeter; }
+
+void mspSerialAllocatePorts(void) {}
+
+const uint32_t baudRates[] = {0, 9600, 19200, 38400, 57600, 115200, 230400, 250000};
+
+static serialPort_t testSerialPort;
+static serialPortConfig_t testSerialPortConfig;
+
+serialPortConfig_t *findSerialPortConfig(uint16_t) { return &testSerialPortConfig; }
+portSharing_e determinePortSharing(serialPortConfig_t *, serialPortFunction_e) { return PORTSHARING_NOT_SHARED; }
+serialPort_t *openSerialPort(serialPortIdentifier_e, serialPortFunction_e, serialReceiveCallbackPtr, uint32_t, portMode_t, portOptions_t)
+{
+    return &testSerialPort;
+}
+void closeSerialPort(serialPort_t *) {}
+void serialWrite(serialPort_t *, uint8_t ch) { serialBytes.push_back(ch); }
+uint8_t serialTxBytesFree(const serialPort_t *) { return 255; }
+bool isSerialTransmitBufferEmpty(const serialPort_t *) { return true; }
+}
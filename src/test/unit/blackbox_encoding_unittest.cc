@@ -0,0 +1,602 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+extern "C" {
+    #include <platform.h>
+
+    #include "common/encoding.h"
+    #include "common/utils.h"
+
+    #include "config/parameter_group.h"
+    #include "config/parameter_group_ids.h"
+
+    #include "drivers/serial.h"
+
+    #include "io/serial.h"
+
+    #include "blackbox/blackbox.h"
+    #include "blackbox/blackbox_io.h"
+
+    PG_REGISTER(blackboxConfig_t, blackboxConfig, PG_BLACKBOX_CONFIG, 1);
+}
+
+#include "blackbox_decoder.h"
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+/*
+ * The encoders of blackbox_io.c are checked against the decoder of the blackbox_stats tool: every value must read back
+ * bit for bit and each call must write exactly the bytes its encoding takes, no more and no less, or the frames after
+ * it would be misread. The expected sizes and bytes are worked out here independently of both.
+ */
+
+static std::vector<uint8_t> serialBytes;
+
+static uint32_t randomState;
+
+static uint32_t randomU32(void)
+{
+    // xorshift32
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+// Values of every width from 0 to 32 bits alike, so each of the size classes of the encodings is hit often
+static int32_t randomOfAnyWidth(void)
+{
+    const int bits = randomU32() % 33;
+    if (bits == 0) {
+        return 0;
+    }
+    const int32_t value = (int32_t)(randomU32() << (32 - bits)) >> (32 - bits);
+    return value;
+}
+
+static int32_t randomBetween(int32_t min, int32_t max)
+{
+    return min + (int32_t)(randomU32() % ((uint32_t)(max - min) + 1));
+}
+
+static void startEncoding(void)
+{
+    serialBytes.clear();
+}
+
+static blackboxStream_t startDecoding(void)
+{
+    blackboxStream_t stream;
+    stream.pos = serialBytes.data();
+    stream.end = serialBytes.data() + serialBytes.size();
+    stream.overrun = false;
+    return stream;
+}
+
+static void expectAllRead(const blackboxStream_t *stream)
+{
+    EXPECT_FALSE(stream->overrun);
+    EXPECT_EQ(serialBytes.data() + serialBytes.size(), stream->pos);
+}
+
+static void expectBytes(const std::vector<uint8_t> &expected)
+{
+    EXPECT_EQ(expected, serialBytes);
+}
+
+static int unsignedVBSize(uint32_t value)
+{
+    int size = 1;
+    while (value > 127) {
+        value >>= 7;
+        size++;
+    }
+    return size;
+}
+
+static bool fitsBits(int32_t value, int bits)
+{
+    return value >= -(1 << (bits - 1)) && value < (1 << (bits - 1));
+}
+
+static int tag2_3S32Size(const int32_t *values)
+{
+    int widest = 2;
+    for (int i = 0; i < 3; i++) {
+        if (!fitsBits(values[i], 6)) {
+            widest = 32;
+        } else if (!fitsBits(values[i], 4)) {
+            widest = std::max(widest, 6);
+        } else if (!fitsBits(values[i], 2)) {
+            widest = std::max(widest, 4);
+        }
+    }
+
+    if (widest < 32) {
+        return widest / 2;
+    }
+
+    int size = 1;
+    for (int i = 0; i < 3; i++) {
+        size += fitsBits(values[i], 8) ? 1 : fitsBits(values[i], 16) ? 2 : fitsBits(values[i], 24) ? 3 : 4;
+    }
+    return size;
+}
+
+static int tag8_4S16Size(const int32_t *values)
+{
+    int nibbles = 0;
+    for (int i = 0; i < 4; i++) {
+        nibbles += values[i] == 0 ? 0 : fitsBits(values[i], 4) ? 1 : fitsBits(values[i], 8) ? 2 : 4;
+    }
+    return 1 + (nibbles + 1) / 2;
+}
+
+static int tag8_8SVBSize(const int32_t *values, int valueCount)
+{
+    if (valueCount == 1) {
+        return unsignedVBSize(zigzagEncode(values[0]));
+    }
+
+    int size = 1;
+    for (int i = 0; i < valueCount; i++) {
+        if (values[i] != 0) {
+            size += unsignedVBSize(zigzagEncode(values[i]));
+        }
+    }
+    return size;
+}
+
+// The boundaries of the size classes of the encodings
+static const int32_t edgeValues[] = {
+    0, 1, -1, -2, 2, 7, -8, 8, -9, 31, -32, 32, -33, 63, -64, 64, -65, 127, -128, 128, -129,
+    8191, -8192, 8192, 32767, -32768, 32768, -32769, 8388607, -8388608, 8388608, -8388609,
+    INT32_MAX, INT32_MIN, INT32_MAX - 1, INT32_MIN + 1
+};
+#define EDGE_VALUE_COUNT (int)ARRAYLEN(edgeValues)
+
+static const int32_t edgeValues16[] = {
+    0, 1, -1, 7, -8, 8, -9, 127, -128, 128, -129, 2047, -2048, 2048, 32767, -32768
+};
+#define EDGE_VALUE_16_COUNT (int)ARRAYLEN(edgeValues16)
+
+#define FUZZ_ITERATIONS 20000
+
+TEST(BlackboxEncodingTest, UnsignedVBRoundTrip)
+{
+    static const uint32_t edges[] = {
+        0, 1, 127, 128, 16383, 16384, 2097151, 2097152, 268435455, 268435456, UINT32_MAX
+    };
+
+    randomState = 1;
+    for (int i = 0; i < (int)ARRAYLEN(edges) + FUZZ_ITERATIONS; i++) {
+        const uint32_t value = i < (int)ARRAYLEN(edges) ? edges[i] : (uint32_t)randomOfAnyWidth();
+
+        startEncoding();
+        blackboxWriteUnsignedVB(value);
+        EXPECT_EQ(unsignedVBSize(value), (int)serialBytes.size()) << value;
+
+        blackboxStream_t stream = startDecoding();
+        EXPECT_EQ(value, blackboxReadUnsignedVB(&stream));
+        expectAllRead(&stream);
+    }
+}
+
+TEST(BlackboxEncodingTest, SignedVBRoundTrip)
+{
+    randomState = 2;
+    for (int i = 0; i < EDGE_VALUE_COUNT + FUZZ_ITERATIONS; i++) {
+        const int32_t value = i < EDGE_VALUE_COUNT ? edgeValues[i] : randomOfAnyWidth();
+
+        startEncoding();
+        blackboxWriteSignedVB(value);
+        EXPECT_EQ(unsignedVBSize(zigzagEncode(value)), (int)serialBytes.size()) << value;
+
+        blackboxStream_t stream = startDecoding();
+        EXPECT_EQ(value, blackboxReadSignedVB(&stream));
+        expectAllRead(&stream);
+    }
+}
+
+TEST(BlackboxEncodingTest, Tag2_3S32RoundTrip)
+{
+    int32_t values[3];
+
+    // Every combination of the edge values, so each field takes each size while the others take every other size
+    for (int i = 0; i < EDGE_VALUE_COUNT * EDGE_VALUE_COUNT * EDGE_VALUE_COUNT; i++) {
+        values[0] = edgeValues[i % EDGE_VALUE_COUNT];
+        values[1] = edgeValues[i / EDGE_VALUE_COUNT % EDGE_VALUE_COUNT];
+        values[2] = edgeValues[i / EDGE_VALUE_COUNT / EDGE_VALUE_COUNT];
+
+        startEncoding();
+        blackboxWriteTag2_3S32(values);
+        EXPECT_EQ(tag2_3S32Size(values), (int)serialBytes.size());
+
+        int32_t decoded[3];
+        blackboxStream_t stream = startDecoding();
+        blackboxReadTag2_3S32(&stream, decoded);
+        expectAllRead(&stream);
+        for (int field = 0; field < 3; field++) {
+            EXPECT_EQ(values[field], decoded[field]) << values[0] << "," << values[1] << "," << values[2];
+        }
+    }
+
+    randomState = 3;
+    for (int i = 0; i < FUZZ_ITERATIONS; i++) {
+        for (int field = 0; field < 3; field++) {
+            values[field] = randomOfAnyWidth();
+        }
+
+        startEncoding();
+        blackboxWriteTag2_3S32(values);
+        EXPECT_EQ(tag2_3S32Size(values), (int)serialBytes.size());
+
+        int32_t decoded[3];
+        blackboxStream_t stream = startDecoding();
+        blackboxReadTag2_3S32(&stream, decoded);
+        expectAllRead(&stream);
+        EXPECT_EQ(0, memcmp(values, decoded, sizeof(values)));
+    }
+}
+
+TEST(BlackboxEncodingTest, Tag8_4S16RoundTrip)
+{
+    int32_t values[4];
+
+    // Every combination of the edge values, which covers every order of odd and even nibble counts
+    for (int i = 0; i < EDGE_VALUE_16_COUNT * EDGE_VALUE_16_COUNT * EDGE_VALUE_16_COUNT * EDGE_VALUE_16_COUNT; i++) {
+        int rest = i;
+        for (int field = 0; field < 4; field++) {
+            values[field] = edgeValues16[rest % EDGE_VALUE_16_COUNT];
+            rest /= EDGE_VALUE_16_COUNT;
+        }
+
+        startEncoding();
+        blackboxWriteTag8_4S16(values);
+        EXPECT_EQ(tag8_4S16Size(values), (int)serialBytes.size());
+
+        int32_t decoded[4];
+        blackboxStream_t stream = startDecoding();
+        blackboxReadTag8_4S16(&stream, decoded);
+        expectAllRead(&stream);
+        EXPECT_EQ(0, memcmp(values, decoded, sizeof(values)))
+            << values[0] << "," << values[1] << "," << values[2] << "," << values[3];
+    }
+
+    randomState = 4;
+    for (int i = 0; i < FUZZ_ITERATIONS; i++) {
+        for (int field = 0; field < 4; field++) {
+            values[field] = (int16_t)randomOfAnyWidth();
+        }
+
+        startEncoding();
+        blackboxWriteTag8_4S16(values);
+        EXPECT_EQ(tag8_4S16Size(values), (int)serialBytes.size());
+
+        int32_t decoded[4];
+        blackboxStream_t stream = startDecoding();
+        blackboxReadTag8_4S16(&stream, decoded);
+        expectAllRead(&stream);
+        EXPECT_EQ(0, memcmp(values, decoded, sizeof(values)));
+    }
+}
+
+TEST(BlackboxEncodingTest, Tag8_8SVBRoundTrip)
+{
+    int32_t values[8];
+
+    randomState = 5;
+    for (int i = 0; i < FUZZ_ITERATIONS; i++) {
+        const int valueCount = 1 + i % 8;
+        for (int field = 0; field < valueCount; field++) {
+            // Mostly zero, as the fields it is used for are
+            const int kind = randomU32() % 4;
+            values[field] = kind < 2 ? 0 : kind == 2 ? edgeValues[randomU32() % EDGE_VALUE_COUNT] : randomOfAnyWidth();
+        }
+
+        startEncoding();
+        blackboxWriteTag8_8SVB(values, valueCount);
+        EXPECT_EQ(tag8_8SVBSize(values, valueCount), (int)serialBytes.size());
+
+        int32_t decoded[8];
+        blackboxStream_t stream = startDecoding();
+        blackboxReadTag8_8SVB(&stream, decoded, valueCount);
+        expectAllRead(&stream);
+        EXPECT_EQ(0, memcmp(values, decoded, valueCount * sizeof(values[0])));
+    }
+}
+
+TEST(BlackboxEncodingTest, FloatRoundTrip)
+{
+    static const uint32_t edges[] = {
+        0x00000000, // 0
+        0x80000000, // -0
+        0x3F800000, // 1
+        0x00000001, // smallest denormal
+        0x807FFFFF, // largest negative denormal
+        0x7F7FFFFF, // FLT_MAX
+        0x7F800000, // infinity
+        0xFF800000, // -infinity
+        0x7FC00000, // NaN
+        0xFFC12345, // NaN with a payload
+    };
+
+    randomState = 6;
+    for (int i = 0; i < (int)ARRAYLEN(edges) + FUZZ_ITERATIONS; i++) {
+        uint32_t bits = i < (int)ARRAYLEN(edges) ? edges[i] : randomU32();
+        if ((bits & 0x7F800000) == 0x7F800000 && (bits & 0x007FFFFF)) {
+            // Only quiet NaNs, a signalling one may be quietened just by passing it in a register
+            bits |= 0x00400000;
+        }
+
+        startEncoding();
+        blackboxWriteFloat(castIntBytesToFloat(bits));
+        EXPECT_EQ(4, (int)serialBytes.size());
+
+        blackboxStream_t stream = startDecoding();
+        EXPECT_EQ(bits, castFloatBytesToInt(blackboxReadFloat(&stream)));
+        expectAllRead(&stream);
+    }
+}
+
+// The bytes of each encoding, so a change of the format shows even where the decoder is changed along with it
+TEST(BlackboxEncodingTest, WritesFormatOfDecoders)
+{
+    startEncoding();
+    blackboxWriteUnsignedVB(300);
+    expectBytes({0xAC, 0x02});
+
+    startEncoding();
+    blackboxWriteSignedVB(-65);
+    expectBytes({0x81, 0x01});
+
+    startEncoding();
+    blackboxWriteFloat(1.0f);
+    expectBytes({0x00, 0x00, 0x80, 0x3F});
+
+    int32_t tag2_3S32[][3] = {
+        {1, -2, 0},
+        {7, -8, 3},
+        {31, -32, 8},
+        {32, -129, 100000},
+    };
+    const std::vector<uint8_t> tag2_3S32Bytes[] = {
+        {0x18},
+        {0x47, 0x83},
+        {0x9F, 0xE0, 0x08},
+        {0xE4, 0x20, 0x7F, 0xFF, 0xA0, 0x86, 0x01},
+    };
+    for (int i = 0; i < (int)ARRAYLEN(tag2_3S32); i++) {
+        startEncoding();
+        blackboxWriteTag2_3S32(tag2_3S32[i]);
+        expectBytes(tag2_3S32Bytes[i]);
+    }
+
+    int32_t tag8_4S16[] = {0, 5, -100, 1000};
+    startEncoding();
+    blackboxWriteTag8_4S16(tag8_4S16);
+    expectBytes({0xE4, 0x59, 0xC0, 0x3E, 0x80});
+
+    int32_t tag8_8SVB[] = {0, -1, 0, 300};
+    startEncoding();
+    blackboxWriteTag8_8SVB(tag8_8SVB, 4);
+    expectBytes({0x0A, 0x01, 0xD8, 0x04});
+
+    startEncoding();
+    blackboxWriteTag8_8SVB(tag8_8SVB, 1);
+    expectBytes({0x00});
+}
+
+typedef enum {
+    ENCODING_SIGNED_VB,
+    ENCODING_UNSIGNED_VB,
+    ENCODING_TAG2_3S32,
+    ENCODING_TAG8_4S16,
+    ENCODING_TAG8_8SVB,
+    ENCODING_FLOAT,
+    ENCODING_COUNT
+} testEncoding_e;
+
+typedef struct testEncodedValues_s {
+    testEncoding_e encoding;
+    int valueCount;
+    int32_t values[8];
+} testEncodedValues_t;
+
+static void randomEncodedValues(testEncodedValues_t *encoded)
+{
+    encoded->encoding = (testEncoding_e)(randomU32() % ENCODING_COUNT);
+
+    switch (encoded->encoding) {
+        case ENCODING_TAG2_3S32:
+            encoded->valueCount = 3;
+        break;
+        case ENCODING_TAG8_4S16:
+            encoded->valueCount = 4;
+        break;
+        case ENCODING_TAG8_8SVB:
+            encoded->valueCount = randomBetween(1, 8);
+        break;
+        default:
+            encoded->valueCount = 1;
+        break;
+    }
+
+    for (int i = 0; i < encoded->valueCount; i++) {
+        encoded->values[i] = encoded->encoding == ENCODING_TAG8_4S16 ? (int16_t)randomOfAnyWidth() : randomOfAnyWidth();
+    }
+    if (encoded->encoding == ENCODING_FLOAT) {
+        // Not a NaN, so the bits are kept whatever the float registers do with them
+        encoded->values[0] &= 0xBFFFFFFF;
+    }
+}
+
+static void writeEncodedValues(testEncodedValues_t *encoded)
+{
+    switch (encoded->encoding) {
+        case ENCODING_SIGNED_VB:
+            blackboxWriteSignedVB(encoded->values[0]);
+        break;
+        case ENCODING_UNSIGNED_VB:
+            blackboxWriteUnsignedVB(encoded->values[0]);
+        break;
+        case ENCODING_TAG2_3S32:
+            blackboxWriteTag2_3S32(encoded->values);
+        break;
+        case ENCODING_TAG8_4S16:
+            blackboxWriteTag8_4S16(encoded->values);
+        break;
+        case ENCODING_TAG8_8SVB:
+            blackboxWriteTag8_8SVB(encoded->values, encoded->valueCount);
+        break;
+        case ENCODING_FLOAT:
+            blackboxWriteFloat(castIntBytesToFloat(encoded->values[0]));
+        break;
+        default:
+        break;
+    }
+}
+
+static void readEncodedValues(blackboxStream_t *stream, testEncoding_e encoding, int valueCount, int32_t *values)
+{
+    switch (encoding) {
+        case ENCODING_SIGNED_VB:
+            values[0] = blackboxReadSignedVB(stream);
+        break;
+        case ENCODING_UNSIGNED_VB:
+            values[0] = blackboxReadUnsignedVB(stream);
+        break;
+        case ENCODING_TAG2_3S32:
+            blackboxReadTag2_3S32(stream, values);
+        break;
+        case ENCODING_TAG8_4S16:
+            blackboxReadTag8_4S16(stream, values);
+        break;
+        case ENCODING_TAG8_8SVB:
+            blackboxReadTag8_8SVB(stream, values, valueCount);
+        break;
+        case ENCODING_FLOAT:
+            values[0] = castFloatBytesToInt(blackboxReadFloat(stream));
+        break;
+        default:
+        break;
+    }
+}
+
+// A stream of all the encodings one after the other, as in a frame, read back in one pass
+TEST(BlackboxEncodingTest, MixedStreamRoundTrip)
+{
+    std::vector<testEncodedValues_t> written(FUZZ_ITERATIONS);
+
+    randomState = 7;
+    startEncoding();
+    for (auto &encoded : written) {
+        randomEncodedValues(&encoded);
+        writeEncodedValues(&encoded);
+    }
+
+    blackboxStream_t stream = startDecoding();
+    for (size_t i = 0; i < written.size(); i++) {
+        int32_t decoded[8];
+        readEncodedValues(&stream, written[i].encoding, written[i].valueCount, decoded);
+        ASSERT_EQ(0, memcmp(written[i].values, decoded, written[i].valueCount * sizeof(decoded[0])))
+            << "encoding " << written[i].encoding << " at " << i;
+    }
+    expectAllRead(&stream);
+}
+
+#define MAIN_FRAMES 5000
+
+/*
+ * Encodes frames laid out as the main P frame of the firmware, with values that change as the logged ones do from one
+ * loop iteration to the next: small PID and gyro deltas with the odd large one, motors that move a little.
+ * blackboxEncoding/mainFrame in make bench times the same frames.
+ */
+TEST(BlackboxEncodingTest, TestMainFrameRoundTrip)
+{
+    static int32_t frames[MAIN_FRAMES][24];
+
+    randomState = 8;
+    for (int i = 0; i < MAIN_FRAMES; i++) {
+        int32_t *frame = frames[i];
+        for (int field = 0; field < 24; field++) {
+            frame[field] = randomU32() % 16 == 0 ? randomBetween(-2000, 2000) : randomBetween(-20, 20);
+        }
+    }
+
+    serialBytes.reserve(MAIN_FRAMES * 24 * 5);
+    startEncoding();
+
+    for (int i = 0; i < MAIN_FRAMES; i++) {
+        int32_t *frame = frames[i];
+
+        blackboxWriteSignedVB(frame[0]);                // loopIteration and time
+        blackboxWriteSignedVB(frame[1]);
+        blackboxWriteSignedVBArray(&frame[2], 3);       // axisP
+        blackboxWriteTag2_3S32(&frame[5]);              // axisI
+        blackboxWriteTag8_8SVB(&frame[8], 3);           // axisD
+        blackboxWriteTag8_4S16(&frame[11]);             // rcCommand
+        blackboxWriteTag8_8SVB(&frame[15], 6);          // vbat, amperage, magADC, BaroAlt
+        blackboxWriteSignedVBArray(&frame[21], 3);      // gyroADC
+    }
+
+    blackboxStream_t stream = startDecoding();
+    for (int i = 0; i < MAIN_FRAMES; i++) {
+        int32_t decoded[24];
+        decoded[0] = blackboxReadSignedVB(&stream);
+        decoded[1] = blackboxReadSignedVB(&stream);
+        for (int field = 2; field < 5; field++) {
+            decoded[field] = blackboxReadSignedVB(&stream);
+        }
+        blackboxReadTag2_3S32(&stream, &decoded[5]);
+        blackboxReadTag8_8SVB(&stream, &decoded[8], 3);
+        blackboxReadTag8_4S16(&stream, &decoded[11]);
+        blackboxReadTag8_8SVB(&stream, &decoded[15], 6);
+        for (int field = 21; field < 24; field++) {
+            decoded[field] = blackboxReadSignedVB(&stream);
+        }
+        ASSERT_EQ(0, memcmp(frames[i], decoded, sizeof(decoded))) << "frame " << i;
+    }
+    expectAllRead(&stream);
+}
+
+// STUBS
+
+extern "C" {
+uint32_t targetPidLooptime;
+
+const uint32_t baudRates[] = {0, 9600, 19200, 38400, 57600, 115200, 230400, 250000};
+
+void mspSerialAllocatePorts(void) {}
+serialPortConfig_t *findSerialPortConfig(uint16_t) { return NULL; }
+portSharing_e determinePortSharing(serialPortConfig_t *, serialPortFunction_e) { return PORTSHARING_NOT_SHARED; }
+serialPort_t *openSerialPort(serialPortIdentifier_e, serialPortFunction_e, serialReceiveCallbackPtr, uint32_t, portMode_t, portOptions_t)
+{
+    return NULL;
+}
+void closeSerialPort(serialPort_t *) {}
+void serialWrite(serialPort_t *, uint8_t ch) { serialBytes.push_back(ch); }
+uint8_t serialTxBytesFree(const serialPort_t *) { return 255; }
+bool isSerialTransmitBufferEmpty(const serialPort_t *) { return true; }
+}
@@ -0,0 +1,393 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <vector>
+
+extern "C" {
+#include <platform.h>
+
+#include "drivers/bus_i2c.h"
+#include "drivers/barometer.h"
+#include "drivers/barometer_ms5611.h"
+
+extern uint32_t ms5611_ut;
+extern uint32_t ms5611_up;
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define MOCK_DEVICE_ADDR    0x77
+
+// A bus with a single device whose registers are read and written with auto increment. On a synchronous bus
+// jobs are done when they start, otherwise the job stays on the bus until the test finishes it.
+static struct {
+    bool synchronous;
+    uint32_t transferUs;            // time a synchronous transfer takes
+    bool fail;
+    const i2cJob_t *running;
+    std::vector<i2cJob_t> started;
+    int aborted;
+    uint8_t registers[256];
+} mockBus;
+
+static uint32_t mockTimeUs;
+static std::vector<const i2cJob_t *> callbacks;
+
+static bool mockBusTransfer(const i2cJob_t *job)
+{
+    if (job->addr != MOCK_DEVICE_ADDR || mockBus.fail) {
+        return false;
+    }
+    if (job->read) {
+        memcpy(job->buf, &mockBus.registers[job->reg], job->len);
+    } else {
+        memcpy(&mockBus.registers[job->reg], job->buf, job->len);
+    }
+    return true;
+}
+
+static void mockBusFinish(void)
+{
+    const i2cJob_t *job = mockBus.running;
+    ASSERT_TRUE(job != NULL);
+    mockBus.running = NULL;
+    i2cJobComplete(mockBusTransfer(job));
+}
+
+static void recordCallback(i2cJob_t *job)
+{
+    callbacks.push_back(job);
+}
+
+// Jobs and buffers live in the fixture as the queue may still use them after the test body returns.
+class I2cQueueTest : public ::testing::Test {
+protected:
+    i2cJob_t jobs[I2C_QUEUE_SIZE];
+    uint8_t buf[4];
+
+    virtual void SetUp() {
+        memset(jobs, 0, sizeof(jobs));
+        memset(buf, 0, sizeof(buf));
+        mockBus.synchronous = false;
+        mockBus.transferUs = 0;
+        mockBus.fail = false;
+        mockBus.running = NULL;
+        mockBus.started.clear();
+        mockBus.aborted = 0;
+        memset(mockBus.registers, 0, sizeof(mockBus.registers));
+        callbacks.clear();
+        mockTimeUs = 0;
+    }
+
+    virtual void TearDown() {
+        // leave an empty queue for the next test
+        mockBus.fail = false;
+        while (mockBus.running) {
+            mockBusFinish();
+        }
+    }
+};
+
+TEST_F(I2cQueueTest, RunsJobsOneAfterTheOther)
+{
+    i2cJob_t &first = jobs[0], &second = jobs[1], &third = jobs[2];
+
+    // when
+    EXPECT_TRUE(i2cQueueWrite(&first, MOCK_DEVICE_ADDR, 0x10, 0x55));
+    EXPECT_TRUE(i2cQueueRead(&second, MOCK_DEVICE_ADDR, 0x10, 1, buf, recordCallback));
+    EXPECT_TRUE(i2cQueueWrite(&third, MOCK_DEVICE_ADDR, 0x11, 0x66));
+
+    // then, only the first is on the bus
+    EXPECT_EQ(1u, mockBus.started.size());
+    EXPECT_EQ(&first, mockBus.running);
+    EXPECT_TRUE(i2cQueueBusy());
+    EXPECT_EQ(I2C_JOB_QUEUED, second.state);
+
+    // when
+    mockBusFinish();
+
+    // then
+    EXPECT_EQ(I2C_JOB_DONE, first.state);
+    EXPECT_EQ(&second, mockBus.running);
+
+    // when
+    mockBusFinish();
+
+    // then, the read saw the write queued before it
+    EXPECT_EQ(I2C_JOB_DONE, second.state);
+    EXPECT_EQ(0x55, buf[0]);
+    ASSERT_EQ(1u, callbacks.size());
+    EXPECT_EQ(&second, callbacks[0]);
+    EXPECT_EQ(&third, mockBus.running);
+
+    // when
+    mockBusFinish();
+
+    // then
+    EXPECT_FALSE(i2cQueueBusy());
+    EXPECT_EQ(0x66, mockBus.registers[0x11]);
+}
+
+TEST_F(I2cQueueTest, RejectsJobStillQueued)
+{
+    i2cJob_t &blocking = jobs[0], &job = jobs[1];
+
+    // given
+    i2cQueueWrite(&blocking, MOCK_DEVICE_ADDR, 0x10, 1);
+    EXPECT_TRUE(i2cQueueWrite(&job, MOCK_DEVICE_ADDR, 0x11, 2));
+
+    // expect
+    EXPECT_FALSE(i2cQueueWrite(&job, MOCK_DEVICE_ADDR, 0x11, 3));
+    EXPECT_FALSE(i2cQueueJob(&job));
+
+    // when
+    mockBusFinish();
+    mockBusFinish();
+
+    // then
+    EXPECT_EQ(2, mockBus.registers[0x11]);
+    EXPECT_TRUE(i2cQueueWrite(&job, MOCK_DEVICE_ADDR, 0x11, 3));
+}
+
+TEST_F(I2cQueueTest, RejectsJobsWhenFull)
+{
+    // when
+    for (int i = 0; i < I2C_QUEUE_SIZE - 1; i++) {
+        EXPECT_TRUE(i2cQueueWrite(&jobs[i], MOCK_DEVICE_ADDR, i, i));
+    }
+
+    // then
+    EXPECT_FALSE(i2cQueueWrite(&jobs[I2C_QUEUE_SIZE - 1], MOCK_DEVICE_ADDR, 0, 0));
+    EXPECT_EQ(I2C_JOB_IDLE, jobs[I2C_QUEUE_SIZE - 1].state);
+
+    // when
+    mockBusFinish();
+
+    // then
+    EXPECT_TRUE(i2cQueueWrite(&jobs[I2C_QUEUE_SIZE - 1], MOCK_DEVICE_ADDR, 0, 0));
+}
+
+TEST_F(I2cQueueTest, ReportsFailedJobs)
+{
+    i2cJob_t &failing = jobs[0], &next = jobs[1];
+
+    // given
+    i2cQueueRead(&failing, MOCK_DEVICE_ADDR + 1, 0x10, 1, buf, recordCallback);
+    i2cQueueWrite(&next, MOCK_DEVICE_ADDR, 0x10, 1);
+
+    // when
+    mockBusFinish();
+
+    // then
+    EXPECT_EQ(I2C_JOB_FAILED, failing.state);
+    ASSERT_EQ(1u, callbacks.size());
+    EXPECT_EQ(&next, mockBus.running);
+}
+
+TEST_F(I2cQueueTest, SynchronousBusCompletesJobsWhenQueued)
+{
+    i2cJob_t &write = jobs[0], &read = jobs[1];
+
+    // given
+    mockBus.synchronous = true;
+
+    // when
+    i2cQueueWrite(&write, MOCK_DEVICE_ADDR, 0x20, 0x42);
+    i2cQueueRead(&read, MOCK_DEVICE_ADDR, 0x20, 1, buf, recordCallback);
+
+    // then
+    EXPECT_EQ(I2C_JOB_DONE, write.state);
+    EXPECT_EQ(I2C_JOB_DONE, read.state);
+    EXPECT_EQ(0x42, buf[0]);
+    EXPECT_EQ(1u, callbacks.size());
+    EXPECT_FALSE(i2cQueueBusy());
+}
+
+static i2cJob_t followUpJob;
+
+static void queueFollowUp(i2cJob_t *job)
+{
+    callbacks.push_back(job);
+    i2cQueueWrite(&followUpJob, MOCK_DEVICE_ADDR, 0x21, 0x43);
+}
+
+TEST_F(I2cQueueTest, SynchronousBusRunsJobsQueuedByCallbackAfterIt)
+{
+    i2cJob_t &read = jobs[0];
+
+    // given
+    mockBus.synchronous = true;
+    memset(&followUpJob, 0, sizeof(followUpJob));
+
+    // when
+    i2cQueueRead(&read, MOCK_DEVICE_ADDR, 0x20, 1, buf, queueFollowUp);
+
+    // then
+    ASSERT_EQ(2u, mockBus.started.size());
+    EXPECT_EQ(0x20, mockBus.started[0].reg);
+    EXPECT_EQ(0x21, mockBus.started[1].reg);
+    EXPECT_EQ(I2C_JOB_DONE, followUpJob.state);
+    EXPECT_EQ(0x43, mockBus.registers[0x21]);
+    EXPECT_FALSE(i2cQueueBusy());
+}
+
+TEST_F(I2cQueueTest, SlowSynchronousJobIsNotAbortedOnceDone)
+{
+    i2cJob_t &read = jobs[0];
+
+    // given
+    mockBus.synchronous = true;
+    mockBus.transferUs = I2C_JOB_TIMEOUT_US + 1;
+    memset(&followUpJob, 0, sizeof(followUpJob));
+
+    // when, the callback queueing a job checks the timeout of the job just done
+    i2cQueueRead(&read, MOCK_DEVICE_ADDR, 0x20, 1, buf, queueFollowUp);
+
+    // then
+    EXPECT_EQ(0, mockBus.aborted);
+    EXPECT_EQ(I2C_JOB_DONE, read.state);
+    EXPECT_EQ(I2C_JOB_DONE, followUpJob.state);
+    EXPECT_EQ(1u, callbacks.size());
+    EXPECT_FALSE(i2cQueueBusy());
+}
+
+TEST_F(I2cQueueTest, AbortsJobThatTakesTooLong)
+{
+    i2cJob_t &stuck = jobs[0], &next = jobs[1];
+
+    // given
+    i2cQueueWrite(&stuck, MOCK_DEVICE_ADDR, 0x10, 1);
+    i2cQueueWrite(&next, MOCK_DEVICE_ADDR, 0x11, 2);
+
+    // when
+    mockTimeUs += I2C_JOB_TIMEOUT_US;
+    i2cQueueCheckTimeout();
+
+    // then
+    EXPECT_EQ(0, mockBus.aborted);
+
+    // when
+    mockTimeUs += 1;
+    i2cQueueCheckTimeout();
+
+    // then
+    EXPECT_EQ(1, mockBus.aborted);
+    EXPECT_EQ(I2C_JOB_FAILED, stuck.state);
+    EXPECT_EQ(&next, mockBus.running);
+}
+
+TEST_F(I2cQueueTest, Ms5611ConversionIsReadWithoutWaiting)
+{
+    static const uint16_t prom[] = { 0x3132, 0x3334, 0x3536, 0x3738, 0x3940, 0x4142, 0x4344, 0x450B };
+    baro_t baro;
+
+    // given, a detected sensor
+    mockBus.synchronous = true;
+    for (int i = 0; i < 8; i++) {
+        mockBus.registers[0xA0 + i * 2] = prom[i] >> 8;
+        mockBus.registers[0xA0 + i * 2 + 1] = prom[i] & 0xFF;
+    }
+    ASSERT_TRUE(ms5611Detect(&baro));
+    mockBus.synchronous = false;
+    mockBus.registers[0] = 0x12;
+    mockBus.registers[1] = 0x34;
+    mockBus.registers[2] = 0x56;
+    ms5611_ut = 0;
+
+    // when, the baro task starts a conversion and reads the last one
+    baro.get_ut();
+    baro.start_up();
+
+    // then, the task did not wait for either
+    EXPECT_EQ(0u, ms5611_ut);
+    EXPECT_TRUE(i2cQueueBusy());
+
+    // when
+    mockBusFinish();
+
+    // then
+    EXPECT_EQ(0x123456u, ms5611_ut);
+    EXPECT_EQ(0, mockBus.registers[0x48]);
+
+    // when
+    mockBusFinish();
+
+    // then
+    EXPECT_EQ(1, mockBus.registers[0x48]);  // D1 conversion at OSR 4096
+
+    // when
+    mockBus.registers[2] = 0x57;
+    baro.get_up();
+    mockBusFinish();
+
+    // then
+    EXPECT_EQ(0x123457u, ms5611_up);
+    EXPECT_EQ(0x123456u, ms5611_ut);
+}
+
+// STUBS
+
+extern "C" {
+
+i2cJobState_e i2cHardwareStartJob(const i2cJob_t *job)
+{
+    mockBus.started.push_back(*job);
+    if (mockBus.synchronous) {
+        mockTimeUs += mockBus.transferUs;
+        return mockBusTransfer(job) ? I2C_JOB_DONE : I2C_JOB_FAILED;
+    }
+    mockBus.running = job;
+    return I2C_JOB_QUEUED;
+}
+
+void i2cHardwareAbortJob(void)
+{
+    mockBus.aborted++;
+    mockBus.running = NULL;
+}
+
+bool i2cRead(uint8_t addr_, uint8_t reg_, uint8_t len, uint8_t *buf)
+{
+    i2cJob_t job = {};
+    job.addr = addr_;
+    job.reg = reg_;
+    job.len = len;
+    job.read = true;
+    job.buf = buf;
+    return i2cTransferBlocking(&job);
+}
+
+bool i2cWrite(uint8_t addr_, uint8_t reg_, uint8_t data)
+{
+    i2cJob_t job = {};
+    job.addr = addr_;
+    job.reg = reg_;
+    job.len = 1;
+    job.buf = &data;
+    return i2cTransferBlocking(&job);
+}
+
+uint32_t micros(void) { return mockTimeUs; }
+void delay(uint32_t) {}
+void delayMicroseconds(uint32_t) {}
+
+}
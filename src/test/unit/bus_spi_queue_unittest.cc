@@ -0,0 +1,236 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <vector>
+
+extern "C" {
+#include <platform.h>
+
+#include "drivers/bus_spi.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+static SPI_TypeDef bus1, bus2;
+
+static const spiDevice_t gyro = { &bus1, NULL, 0 };
+static const spiDevice_t flash = { &bus1, NULL, 0 };
+static const spiDevice_t osd = { &bus2, NULL, 0 };
+
+// A bus runs transactions in the background, as with DMA, unless it is synchronous.
+static struct {
+    bool synchronous;
+    bool fail;
+    std::vector<const spiTransaction_t *> started;
+} mockBus;
+
+static std::vector<const spiTransaction_t *> callbacks;
+static spiTransaction_t *queueFromCallback;
+
+static void mockBusFinish(SPI_TypeDef *instance)
+{
+    spiTransactionComplete(instance, !mockBus.fail);
+}
+
+static void recordCallback(spiTransaction_t *transaction)
+{
+    callbacks.push_back(transaction);
+    if (queueFromCallback) {
+        spiTransaction_t *next = queueFromCallback;
+        queueFromCallback = NULL;
+        EXPECT_TRUE(spiQueueTransaction(next));
+    }
+}
+
+class SpiQueueTest : public ::testing::Test {
+protected:
+    // transactions live in the fixture as the queue may still use them after the test body returns
+    spiTransaction_t transactions[6];
+
+    void setUp(spiTransaction_t *transaction, const spiDevice_t *device, spiPriority_e priority) {
+        transaction->device = device;
+        transaction->len = 1;
+        transaction->priority = priority;
+        transaction->callback = recordCallback;
+    }
+
+    virtual void SetUp() {
+        memset(transactions, 0, sizeof(transactions));
+        mockBus.synchronous = false;
+        mockBus.fail = false;
+        mockBus.started.clear();
+        callbacks.clear();
+        queueFromCallback = NULL;
+    }
+
+    virtual void TearDown() {
+        // leave empty queues for the next test
+        mockBus.fail = false;
+        while (spiQueueBusy(&bus1)) {
+            mockBusFinish(&bus1);
+        }
+        while (spiQueueBusy(&bus2)) {
+            mockBusFinish(&bus2);
+        }
+    }
+};
+
+TEST_F(SpiQueueTest, SynchronousBusCompletesTransactionsWhenQueued)
+{
+    // given
+    mockBus.synchronous = true;
+    setUp(&transactions[0], &flash, SPI_PRIORITY_BULK);
+
+    // when
+    EXPECT_TRUE(spiQueueTransaction(&transactions[0]));
+
+    // then
+    EXPECT_EQ(SPI_TRANSACTION_DONE, transactions[0].state);
+    ASSERT_EQ(1u, callbacks.size());
+    EXPECT_FALSE(spiQueueBusy(&bus1));
+}
+
+TEST_F(SpiQueueTest, SensorGoesAheadOfWaitingTransfers)
+{
+    // given, a flash transfer on the bus and more waiting
+    setUp(&transactions[0], &flash, SPI_PRIORITY_BULK);
+    setUp(&transactions[1], &flash, SPI_PRIORITY_BULK);
+    setUp(&transactions[2], &flash, SPI_PRIORITY_NORMAL);
+    setUp(&transactions[3], &gyro, SPI_PRIORITY_SENSOR);
+    setUp(&transactions[4], &gyro, SPI_PRIORITY_SENSOR);
+    for (int i = 0; i < 5; i++) {
+        EXPECT_TRUE(spiQueueTransaction(&transactions[i]));
+    }
+
+    // then, the running transfer is not preempted
+    ASSERT_EQ(1u, mockBus.started.size());
+    EXPECT_EQ(&transactions[0], mockBus.started[0]);
+    EXPECT_TRUE(spiQueueBusy(&bus1));
+
+    // when
+    for (int i = 0; i < 5; i++) {
+        mockBusFinish(&bus1);
+    }
+
+    // then, first come first served within a priority
+    ASSERT_EQ(5u, mockBus.started.size());
+    EXPECT_EQ(&transactions[3], mockBus.started[1]);
+    EXPECT_EQ(&transactions[4], mockBus.started[2]);
+    EXPECT_EQ(&transactions[2], mockBus.started[3]);
+    EXPECT_EQ(&transactions[1], mockBus.started[4]);
+    EXPECT_FALSE(spiQueueBusy(&bus1));
+    for (int i = 0; i < 5; i++) {
+        EXPECT_EQ(SPI_TRANSACTION_DONE, transactions[i].state);
+    }
+}
+
+TEST_F(SpiQueueTest, RejectsTransactionStillQueued)
+{
+    // given
+    setUp(&transactions[0], &flash, SPI_PRIORITY_BULK);
+    setUp(&transactions[1], &gyro, SPI_PRIORITY_SENSOR);
+    spiQueueTransaction(&transactions[0]);
+    EXPECT_TRUE(spiQueueTransaction(&transactions[1]));
+
+    // expect
+    EXPECT_FALSE(spiQueueTransaction(&transactions[1]));
+
+    // when
+    mockBusFinish(&bus1);
+    mockBusFinish(&bus1);
+
+    // then
+    EXPECT_EQ(2u, mockBus.started.size());
+    EXPECT_TRUE(spiQueueTransaction(&transactions[1]));
+}
+
+TEST_F(SpiQueueTest, BusesAreIndependent)
+{
+    // given
+    setUp(&transactions[0], &flash, SPI_PRIORITY_BULK);
+    setUp(&transactions[1], &osd, SPI_PRIORITY_BULK);
+
+    // when
+    spiQueueTransaction(&transactions[0]);
+    spiQueueTransaction(&transactions[1]);
+
+    // then
+    EXPECT_EQ(2u, mockBus.started.size());
+
+    // when
+    mockBusFinish(&bus2);
+
+    // then
+    EXPECT_EQ(SPI_TRANSACTION_QUEUED, transactions[0].state);
+    EXPECT_EQ(SPI_TRANSACTION_DONE, transactions[1].state);
+    EXPECT_TRUE(spiQueueBusy(&bus1));
+    EXPECT_FALSE(spiQueueBusy(&bus2));
+}
+
+TEST_F(SpiQueueTest, ReportsFailedTransactions)
+{
+    // given
+    setUp(&transactions[0], &flash, SPI_PRIORITY_BULK);
+    spiQueueTransaction(&transactions[0]);
+
+    // when
+    mockBus.fail = true;
+    mockBusFinish(&bus1);
+
+    // then
+    EXPECT_EQ(SPI_TRANSACTION_FAILED, transactions[0].state);
+    EXPECT_EQ(1u, callbacks.size());
+}
+
+TEST_F(SpiQueueTest, CallbackCanQueueTheNextTransaction)
+{
+    // given
+    mockBus.synchronous = true;
+    setUp(&transactions[0], &flash, SPI_PRIORITY_BULK);
+    setUp(&transactions[1], &flash, SPI_PRIORITY_BULK);
+    queueFromCallback = &transactions[1];
+
+    // when
+    spiQueueTransaction(&transactions[0]);
+
+    // then, the second ran after the first was complete
+    ASSERT_EQ(2u, callbacks.size());
+    EXPECT_EQ(&transactions[0], callbacks[0]);
+    EXPECT_EQ(&transactions[1], callbacks[1]);
+    EXPECT_EQ(SPI_TRANSACTION_DONE, transactions[1].state);
+    EXPECT_FALSE(spiQueueBusy(&bus1));
+}
+
+// STUBS
+
+extern "C" {
+
+spiTransactionState_e spiHardwareStartTransaction(const spiTransaction_t *transaction)
+{
+    mockBus.started.push_back(transaction);
+    if (mockBus.synchronous) {
+        return mockBus.fail ? SPI_TRANSACTION_FAILED : SPI_TRANSACTION_DONE;
+    }
+    return SPI_TRANSACTION_QUEUED;
+}
+
+}
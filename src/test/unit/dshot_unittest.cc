@@ -0,0 +1,165 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <string.h>
+
+extern "C" {
+    #include "drivers/dshot.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+// independent reference, computes the checksum bit by bit from the 12 bit payload
+static uint16_t referencePacket(uint16_t value, bool telemetry)
+{
+    uint16_t payload = (value << 1) | telemetry;
+    uint16_t csum = 0;
+    for (int bit = 0; bit < 12; bit++) {
+        if (payload & (1 << bit)) {
+            csum ^= 1 << (bit % 4);
+        }
+    }
+    return (payload << 4) | csum;
+}
+
+TEST(DshotTest, EncodePacketKnownFrames)
+{
+    EXPECT_EQ(0x0000, dshotEncodePacket(0, false));
+    EXPECT_EQ(0x0011, dshotEncodePacket(DSHOT_CMD_MOTOR_STOP, true));
+    EXPECT_EQ(0x0606, dshotEncodePacket(DSHOT_MIN_THROTTLE, false));
+    EXPECT_EQ(0x82C6, dshotEncodePacket(1046, false));
+    EXPECT_EQ(0xFFEE, dshotEncodePacket(DSHOT_MAX_THROTTLE, false));
+    EXPECT_EQ(0xFFFF, dshotEncodePacket(DSHOT_MAX_THROTTLE, true));
+}
+
+TEST(DshotTest, EncodePacketMatchesReferenceForAllValues)
+{
+    for (uint16_t value = 0; value <= DSHOT_MAX_THROTTLE; value++) {
+        EXPECT_EQ(referencePacket(value, false), dshotEncodePacket(value, false)) << "value " << value;
+        EXPECT_EQ(referencePacket(value, true), dshotEncodePacket(value, true)) << "value " << value;
+    }
+}
+
+TEST(DshotTest, ThrottleFromPulse)
+{
+    EXPECT_EQ(DSHOT_CMD_MOTOR_STOP, dshotThrottleFromPulse(0));
+    EXPECT_EQ(DSHOT_CMD_MOTOR_STOP, dshotThrottleFromPulse(1000));
+    EXPECT_EQ(49, dshotThrottleFromPulse(1001));
+    EXPECT_EQ(1047, dshotThrottleFromPulse(1500));
+    EXPECT_EQ(2045, dshotThrottleFromPulse(1999));
+    EXPECT_EQ(DSHOT_MAX_THROTTLE, dshotThrottleFromPulse(2000));
+    EXPECT_EQ(DSHOT_MAX_THROTTLE, dshotThrottleFromPulse(2100));
+
+    // never produces a command value for a running motor
+    for (uint16_t pulse = 1001; pulse <= 2000; pulse++) {
+        EXPECT_GE(dshotThrottleFromPulse(pulse), DSHOT_MIN_THROTTLE);
+    }
+}
+
+TEST(DshotTest, EncodeBitsMsbFirst)
+{
+    uint32_t buffer[DSHOT_DMA_BUFFER_SLOTS];
+    memset(buffer, 0, sizeof(buffer));
+
+    dshotEncodeBits(0x82C6, buffer, 1);
+
+    const uint8_t expected[DSHOT_FRAME_BITS] = { 1,0,0,0, 0,0,1,0, 1,1,0,0, 0,1,1,0 };
+    for (int bit = 0; bit < DSHOT_FRAME_BITS; bit++) {
+        EXPECT_EQ(expected[bit] ? DSHOT_BIT_COMPARE_1 : DSHOT_BIT_COMPARE_0, buffer[bit]) << "bit " << bit;
+    }
+
+    // padding is left at zero so the line idles low after the frame
+    for (int slot = DSHOT_FRAME_BITS; slot < DSHOT_DMA_BUFFER_SLOTS; slot++) {
+        EXPECT_EQ(0, buffer[slot]);
+    }
+}
+
+TEST(DshotTest, EncodeBitsInterleavesBurstChannels)
+{
+    const int channels = 3;
+    uint32_t buffer[DSHOT_DMA_BUFFER_SLOTS * channels];
+    memset(buffer, 0, sizeof(buffer));
+
+    const uint16_t packets[channels] = { 0xFFFF, 0x0000, 0x82C6 };
+    for (int channel = 0; channel < channels; channel++) {
+        dshotEncodeBits(packets[channel], &buffer[channel], channels);
+    }
+
+    for (int bit = 0; bit < DSHOT_FRAME_BITS; bit++) {
+        for (int channel = 0; channel < channels; channel++) {
+            uint32_t expected = (packets[channel] & (0x8000 >> bit)) ? DSHOT_BIT_COMPARE_1 : DSHOT_BIT_COMPARE_0;
+            EXPECT_EQ(expected, buffer[bit * channels + channel]) << "bit " << bit << " channel " << channel;
+        }
+    }
+    for (int slot = DSHOT_FRAME_BITS * channels; slot < DSHOT_DMA_BUFFER_SLOTS * channels; slot++) {
+        EXPECT_EQ(0, buffer[slot]);
+    }
+}
+
+// timers are tracked by address only, each test uses its own
+static int burstTimer, nonAdjacentTimer, servoTimer, pwmFirstTimer;
+
+TEST(DshotTest, BurstGrowsByAdjacentChannels)
+{
+    EXPECT_TRUE(dshotTimerAcceptsChannel(&burstTimer, 1));
+    const dshotBurst_t *burst = dshotTimerAddChannel(&burstTimer, 1);
+    EXPECT_EQ(1, burst->firstChannelIndex);
+    EXPECT_EQ(1, burst->length);
+
+    EXPECT_TRUE(dshotTimerAcceptsChannel(&burstTimer, 0));
+    burst = dshotTimerAddChannel(&burstTimer, 0);
+    EXPECT_TRUE(dshotTimerAcceptsChannel(&burstTimer, 2));
+    burst = dshotTimerAddChannel(&burstTimer, 2);
+    EXPECT_EQ(0, burst->firstChannelIndex);
+    EXPECT_EQ(3, burst->length);
+}
+
+TEST(DshotTest, NonAdjacentChannelIsRefused)
+{
+    dshotTimerAddChannel(&nonAdjacentTimer, 0);
+
+    // CCR2 sits between the burst and CCR3, the burst would overwrite it
+    EXPECT_FALSE(dshotTimerAcceptsChannel(&nonAdjacentTimer, 2));
+    EXPECT_FALSE(dshotTimerAcceptsChannel(&nonAdjacentTimer, 3));
+
+    // and the motor may not fall back to PWM on the same timer either
+    EXPECT_FALSE(dshotClaimTimerForPwm(&nonAdjacentTimer));
+}
+
+TEST(DshotTest, ServoCannotShareDshotTimer)
+{
+    dshotTimerAddChannel(&servoTimer, 2);
+    dshotTimerAddChannel(&servoTimer, 3);
+
+    EXPECT_FALSE(dshotClaimTimerForPwm(&servoTimer));
+
+    const dshotBurst_t *burst = dshotTimerAddChannel(&servoTimer, 3);
+    EXPECT_EQ(2, burst->firstChannelIndex);
+    EXPECT_EQ(2, burst->length);
+}
+
+TEST(DshotTest, DshotCannotTakePwmTimer)
+{
+    EXPECT_TRUE(dshotClaimTimerForPwm(&pwmFirstTimer));
+    EXPECT_TRUE(dshotClaimTimerForPwm(&pwmFirstTimer));
+
+    EXPECT_FALSE(dshotTimerAcceptsChannel(&pwmFirstTimer, 0));
+}
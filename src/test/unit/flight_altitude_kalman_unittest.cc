@@ -0,0 +1,356 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+extern "C" {
+#include <platform.h>
+
+#include "flight/altitude_kalman.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define ACC_NOISE           50.0f   // cm/s/s, filter settings as the defaults
+#define ACC_BIAS_NOISE      2.0f
+#define BARO_NOISE          50.0f   // cm
+
+#define LOOP_US             1000    // acceleration at the attitude task rate
+#define BARO_INTERVAL_US    25000
+
+static altitudeKalman_t kf;
+
+// Repeatable normally distributed noise
+static uint32_t noiseSeed;
+
+static float gaussian(float sd)
+{
+    float sum = 0;
+    for (int i = 0; i < 12; i++) {
+        noiseSeed = noiseSeed * 1664525 + 1013904223;
+        sum += (noiseSeed >> 8) / 16777216.0f;
+    }
+    return (sum - 6.0f) * sd;
+}
+
+// Synthetic vertical flight: hover, climb at 2m/s, hover, descend at 1m/s, with 0.5s acceleration ramps
+static float profileVelocity(float t)
+{
+    if (t < 2.0f) {
+        return 0;
+    } else if (t < 2.5f) {
+        return (t - 2.0f) * 400.0f;
+    } else if (t < 6.0f) {
+        return 200.0f;
+    } else if (t < 6.5f) {
+        return (6.5f - t) * 400.0f;
+    } else if (t < 9.0f) {
+        return 0;
+    } else if (t < 9.5f) {
+        return (9.0f - t) * 200.0f;
+    } else if (t < 13.0f) {
+        return -100.0f;
+    } else if (t < 13.5f) {
+        return (t - 13.5f) * 200.0f;
+    }
+    return 0;
+}
+
+static float profileAcceleration(float t)
+{
+    if (t >= 2.0f && t < 2.5f) {
+        return 400.0f;
+    } else if (t >= 6.0f && t < 6.5f) {
+        return -400.0f;
+    } else if (t >= 9.0f && t < 9.5f) {
+        return -200.0f;
+    } else if (t >= 13.0f && t < 13.5f) {
+        return 200.0f;
+    }
+    return 0;
+}
+
+typedef struct simulation_s {
+    float accNoise;
+    float accBias;
+    float baroNoise;
+    uint32_t baroDelayUs;       // from the middle of the conversion until the sample is used
+    bool timestamped;           // the sample carries the time it was taken rather than the time it arrived
+} simulation_t;
+
+typedef struct simulationResult_s {
+    float altitudeRms;
+    float velocityRms;
+    float meanAltitudeError;
+} simulationResult_t;
+
+// Runs the profile until endS seconds, the errors are accumulated from evaluateS on
+static simulationResult_t simulate(const simulation_t *sim, float endS, float evaluateS)
+{
+    double altitudeSquares = 0, velocitySquares = 0, altitudeErrors = 0;
+    int count = 0;
+    float altitude = 1000.0f;
+    uint32_t nextBaroUs = BARO_INTERVAL_US;
+
+    noiseSeed = 1;
+    altitudeKalmanInit(&kf, ACC_NOISE, ACC_BIAS_NOISE);
+
+    for (uint32_t timeUs = LOOP_US; timeUs <= endS * 1e6f; timeUs += LOOP_US) {
+        const float t = timeUs * 1e-6f;
+        altitude += profileVelocity(t) * LOOP_US * 1e-6f;
+
+        altitudeKalmanPredict(&kf, profileAcceleration(t) + sim->accBias + gaussian(sim->accNoise), timeUs);
+
+        if (timeUs >= nextBaroUs + sim->baroDelayUs) {
+            // altitude when the sample was taken
+            float sampleAltitude = altitude;
+            for (uint32_t back = 0; back < sim->baroDelayUs; back += LOOP_US) {
+                sampleAltitude -= profileVelocity((timeUs - back) * 1e-6f) * LOOP_US * 1e-6f;
+            }
+            altitudeKalmanCorrect(&kf, sampleAltitude + gaussian(sim->baroNoise), BARO_NOISE,
+                sim->timestamped ? nextBaroUs : timeUs);
+            nextBaroUs += BARO_INTERVAL_US;
+        }
+
+        if (kf.initialised && t >= evaluateS) {
+            const float altitudeError = kf.x[ALT_KF_ALTITUDE] - altitude;
+            const float velocityError = kf.x[ALT_KF_VELOCITY] - profileVelocity(t);
+            altitudeSquares += altitudeError * altitudeError;
+            velocitySquares += velocityError * velocityError;
+            altitudeErrors += altitudeError;
+            count++;
+        }
+    }
+
+    simulationResult_t result;
+    result.altitudeRms = sqrt(altitudeSquares / count);
+    result.velocityRms = sqrt(velocitySquares / count);
+    result.meanAltitudeError = altitudeErrors / count;
+    return result;
+}
+
+TEST(AltitudeKalmanTest, StartsOnFirstMeasurement)
+{
+    altitudeKalmanInit(&kf, ACC_NOISE, ACC_BIAS_NOISE);
+
+    // when
+    altitudeKalmanPredict(&kf, 100.0f, 1000);
+
+    // then
+    EXPECT_FALSE(kf.initialised);
+
+    // when
+    EXPECT_TRUE(altitudeKalmanCorrect(&kf, 1234.0f, BARO_NOISE, 2000));
+
+    // then
+    EXPECT_TRUE(kf.initialised);
+    EXPECT_FLOAT_EQ(1234.0f, kf.x[ALT_KF_ALTITUDE]);
+    EXPECT_FLOAT_EQ(0.0f, kf.x[ALT_KF_VELOCITY]);
+    EXPECT_EQ(2000, kf.timeUs);
+}
+
+TEST(AltitudeKalmanTest, PredictsWithAcceleration)
+{
+    altitudeKalmanInit(&kf, ACC_NOISE, ACC_BIAS_NOISE);
+    altitudeKalmanReset(&kf, 0.0f, 0);
+
+    // when
+    for (uint32_t timeUs = LOOP_US; timeUs <= 1000000; timeUs += LOOP_US) {
+        altitudeKalmanPredict(&kf, 100.0f, timeUs);
+    }
+
+    // then
+    EXPECT_NEAR(100.0f, kf.x[ALT_KF_VELOCITY], 0.1f);
+    EXPECT_NEAR(50.0f, kf.x[ALT_KF_ALTITUDE], 0.1f);
+}
+
+TEST(AltitudeKalmanTest, ReducesBaroNoiseWhileHovering)
+{
+    const simulation_t sim = { 20.0f, 0.0f, BARO_NOISE, 0, true };
+
+    // when
+    const simulationResult_t result = simulate(&sim, 10.0f, 5.0f);
+
+    // then
+    EXPECT_LT(result.altitudeRms, BARO_NOISE / 3);
+    EXPECT_LT(result.velocityRms, 20.0f);
+}
+
+TEST(AltitudeKalmanTest, LearnsAccelerometerBias)
+{
+    altitudeKalmanInit(&kf, ACC_NOISE, ACC_BIAS_NOISE);
+    noiseSeed = 2;
+
+    // when
+    for (uint32_t timeUs = LOOP_US; timeUs <= 30000000; timeUs += LOOP_US) {
+        altitudeKalmanPredict(&kf, 30.0f + gaussian(20.0f), timeUs);
+        if (timeUs % BARO_INTERVAL_US == 0) {
+            altitudeKalmanCorrect(&kf, 500.0f + gaussian(BARO_NOISE), BARO_NOISE, timeUs);
+        }
+    }
+
+    // then
+    EXPECT_NEAR(30.0f, kf.x[ALT_KF_ACC_BIAS], 5.0f);
+    EXPECT_NEAR(0.0f, kf.x[ALT_KF_VELOCITY], 10.0f);
+    EXPECT_NEAR(500.0f, kf.x[ALT_KF_ALTITUDE], 20.0f);
+}
+
+TEST(AltitudeKalmanTest, TimestampRemovesLagOfDelayedSamples)
+{
+    // given
+    simulation_t sim = { 0.0f, 0.0f, 0.0f, 60000, false };
+
+    // when, the constant climb from 3 to 6 seconds
+    const simulationResult_t late = simulate(&sim, 6.0f, 3.0f);
+    sim.timestamped = true;
+    const simulationResult_t timestamped = simulate(&sim, 6.0f, 3.0f);
+
+    // then, samples taken as current hold the estimate 60ms behind, 12cm at 2m/s
+    EXPECT_LT(late.meanAltitudeError, -4.0f);
+    EXPECT_LT(fabsf(timestamped.meanAltitudeError), 1.0f);
+}
+
+TEST(AltitudeKalmanTest, RejectsOutliers)
+{
+    altitudeKalmanInit(&kf, ACC_NOISE, ACC_BIAS_NOISE);
+    uint32_t timeUs = 0;
+    for (int i = 0; i < 200; i++) {
+        timeUs += BARO_INTERVAL_US;
+        altitudeKalmanPredict(&kf, 0.0f, timeUs);
+        altitudeKalmanCorrect(&kf, 1000.0f, BARO_NOISE, timeUs);
+    }
+
+    // when
+    timeUs += BARO_INTERVAL_US;
+    altitudeKalmanPredict(&kf, 0.0f, timeUs);
+    const bool accepted = altitudeKalmanCorrect(&kf, 6000.0f, BARO_NOISE, timeUs);
+
+    // then
+    EXPECT_FALSE(accepted);
+    EXPECT_NEAR(1000.0f, kf.x[ALT_KF_ALTITUDE], 1.0f);
+
+    // when the measurement stays there, the filter follows it
+    for (int i = 0; i < 10; i++) {
+        timeUs += BARO_INTERVAL_US;
+        altitudeKalmanPredict(&kf, 0.0f, timeUs);
+        altitudeKalmanCorrect(&kf, 6000.0f, BARO_NOISE, timeUs);
+    }
+
+    // then
+    EXPECT_FLOAT_EQ(6000.0f, kf.x[ALT_KF_ALTITUDE]);
+    EXPECT_FLOAT_EQ(0.0f, kf.x[ALT_KF_VELOCITY]);
+}
+
+TEST(AltitudeKalmanTest, SetAltitudeKeepsVelocity)
+{
+    altitudeKalmanInit(&kf, ACC_NOISE, ACC_BIAS_NOISE);
+    altitudeKalmanReset(&kf, 1000.0f, 0);
+    kf.x[ALT_KF_VELOCITY] = 100.0f;
+    altitudeKalmanPredict(&kf, 0.0f, 100000);
+
+    // when, measured 50ms ago
+    altitudeKalmanSetAltitude(&kf, 200.0f, 50000);
+
+    // then
+    EXPECT_FLOAT_EQ(205.0f, kf.x[ALT_KF_ALTITUDE]);
+    EXPECT_FLOAT_EQ(100.0f, kf.x[ALT_KF_VELOCITY]);
+}
+
+/*
+ * The complementary filter the Kalman filter replaced, run at 40Hz on the acceleration averaged since the
+ * previous run and the low pass filtered baro altitude, with the former default settings.
+ */
+static simulationResult_t simulateComplementaryFilter(const simulation_t *sim, float endS, float evaluateS)
+{
+    const float cfAlt = 0.965f;
+    const float cfVel = 0.985f;
+    const float baroLpf = 0.6f;
+
+    double altitudeSquares = 0, velocitySquares = 0, altitudeErrors = 0;
+    int count = 0;
+    float altitude = 1000.0f;
+    float baroAlt = altitude;
+    float lastBaroAlt = altitude;
+    float accAlt = altitude;
+    float vel = 0;
+    float accSum = 0;
+    int accSumCount = 0;
+
+    noiseSeed = 1;
+
+    for (uint32_t timeUs = LOOP_US; timeUs <= endS * 1e6f; timeUs += LOOP_US) {
+        const float t = timeUs * 1e-6f;
+        altitude += profileVelocity(t) * LOOP_US * 1e-6f;
+
+        accSum += profileAcceleration(t) + sim->accBias + gaussian(sim->accNoise);
+        accSumCount++;
+
+        if (timeUs % BARO_INTERVAL_US == 0) {
+            float sampleAltitude = altitude;
+            for (uint32_t back = 0; back < sim->baroDelayUs; back += LOOP_US) {
+                sampleAltitude -= profileVelocity((timeUs - back) * 1e-6f) * LOOP_US * 1e-6f;
+            }
+            baroAlt = baroAlt * baroLpf + (sampleAltitude + gaussian(sim->baroNoise)) * (1.0f - baroLpf);
+
+            const float dt = BARO_INTERVAL_US * 1e-6f;
+            const float velAcc = accSum / accSumCount * dt;
+            accSum = 0;
+            accSumCount = 0;
+
+            accAlt += (velAcc * 0.5f) * dt + vel * dt;
+            accAlt = accAlt * cfAlt + baroAlt * (1.0f - cfAlt);
+            vel += velAcc;
+
+            float baroVel = (baroAlt - lastBaroAlt) / dt;
+            lastBaroAlt = baroAlt;
+            baroVel = fabsf(baroVel) < 10 ? 0 : baroVel;
+            vel = vel * cfVel + baroVel * (1.0f - cfVel);
+        }
+
+        if (t >= evaluateS) {
+            const float altitudeError = accAlt - altitude;
+            const float velocityError = vel - profileVelocity(t);
+            altitudeSquares += altitudeError * altitudeError;
+            velocitySquares += velocityError * velocityError;
+            altitudeErrors += altitudeError;
+            count++;
+        }
+    }
+
+    simulationResult_t result;
+    result.altitudeRms = sqrt(altitudeSquares / count);
+    result.velocityRms = sqrt(velocitySquares / count);
+    result.meanAltitudeError = altitudeErrors / count;
+    return result;
+}
+
+TEST(AltitudeKalmanTest, TracksFlightBetterThanComplementaryFilter)
+{
+    // given, a noisy baro read 10ms after the middle of its conversion and a slightly biased accelerometer
+    const simulation_t sim = { 30.0f, 10.0f, 30.0f, 10000, true };
+
+    // when
+    const simulationResult_t kalman = simulate(&sim, 16.0f, 1.0f);
+    const simulationResult_t complementary = simulateComplementaryFilter(&sim, 16.0f, 1.0f);
+
+    // then
+    EXPECT_LT(kalman.altitudeRms, complementary.altitudeRms);
+    EXPECT_LT(kalman.velocityRms, complementary.velocityRms);
+}
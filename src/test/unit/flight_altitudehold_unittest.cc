@@ -163,8 +163,11 @@ attitudeEulerAngles_t attitude;
 //int16_t heading;
 //gyro_t gyro;
 int32_t accSum[XYZ_AXIS_COUNT];
+float accEarth[XYZ_AXIS_COUNT];
 //int16_t magADC[XYZ_AXIS_COUNT];
 int32_t BaroAlt;
+int32_t baroSampleAltitude;
+uint32_t baroSampleTime;
 int16_t debug[DEBUG16_VALUE_COUNT];
 
 uint8_t stateFlags;
@@ -172,7 +175,6 @@ uint16_t flightModeFlags;
 uint8_t armingFlags;
 
 int32_t sonarAlt;
-int16_t sonarCfAltCm;
 int16_t sonarMaxAltWithTiltCm;
 
 uint16_t enableFlightMode(flightModeFlags_e mask)
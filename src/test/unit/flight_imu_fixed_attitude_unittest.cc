@@ -0,0 +1,211 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include <limits.h>
+
+extern "C" {
+    #include <platform.h>
+    #include "build/build_config.h"
+    #include "build/debug.h"
+
+    #include "common/axis.h"
+    #include "common/maths.h"
+
+    #include "config/parameter_group.h"
+    #include "config/parameter_group_ids.h"
+    #include "config/profile.h"
+
+    #include "sensors/sensors.h"
+
+    #include "drivers/sensor.h"
+    #include "drivers/accgyro.h"
+    #include "drivers/compass.h"
+
+    #include "sensors/gyro.h"
+    #include "sensors/compass.h"
+    #include "sensors/acceleration.h"
+    #include "sensors/barometer.h"
+
+    #include "fc/runtime_config.h"
+
+    #include "io/motors.h"
+    #include "fc/rc_controls.h"
+
+    #include "rx/rx.h"
+
+    #include "flight/mixer.h"
+    #include "flight/pid.h"
+    #include "flight/imu.h"
+
+    PG_REGISTER_PROFILE(pidProfile_t, pidProfile, PG_PID_PROFILE, 0);
+    PG_REGISTER_PROFILE(rcControlsConfig_t, rcControlsConfig, PG_RC_CONTROLS_CONFIG, 0);
+    PG_REGISTER_PROFILE(barometerConfig_t, barometerConfig, PG_BAROMETER_CONFIG, 0);
+    PG_REGISTER_PROFILE(compassConfig_t, compassConfig, PG_COMPASS_CONFIGURATION, 0);
+    PG_REGISTER(motorConfig_t, motorConfig, PG_MOTOR_CONFIG, 0);
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+/*
+ * imu.c built with USE_IMU_FIXED_POINT, checks the code that hands the sensor samples to the fixed point estimator
+ * and publishes its rotation matrix and angles. flight_imu_fixed_unittest compares the estimators themselves.
+ */
+
+#define LOOP_TIME_US 1000
+
+static uint32_t currentTime = 0;
+
+static imuRuntimeConfig_t imuRuntimeConfig;
+static accDeadband_t accDeadband;
+
+static void initImu(void)
+{
+    imuRuntimeConfig.dcm_kp = 0.25f;
+    imuRuntimeConfig.dcm_ki = 0.0f;
+    imuRuntimeConfig.acc_cut_hz = 0;
+    imuConfigure(&imuRuntimeConfig, &accDeadband, 10.0f, 800);
+
+    gyro.scale = 1.0f / 16.4f;
+    acc.acc_1G = 4096;
+    imuInit();
+
+    rollAndPitchTrims_t trims;
+    imuUpdateAccelerometer(&trims);
+}
+
+// level and still, except for the accelerometer which reads the given roll
+static void runImu(float rollDegrees, int loops)
+{
+    gyroADC[X] = 0;
+    gyroADC[Y] = 0;
+    gyroADC[Z] = 0;
+    for (int i = 0; i < loops; i++) {
+        accADC[X] = 0;
+        accADC[Y] = lrintf(acc.acc_1G * sinf(DEGREES_TO_RADIANS(rollDegrees)));
+        accADC[Z] = lrintf(acc.acc_1G * cosf(DEGREES_TO_RADIANS(rollDegrees)));
+        currentTime += LOOP_TIME_US;
+        imuUpdateAttitude();
+    }
+}
+
+TEST(FlightImuFixedAttitudeTest, LevelAtRest)
+{
+    magneticDeclination = 0.0f;
+    initImu();
+    runImu(0, 100);
+
+    EXPECT_EQ(0, attitude.values.roll);
+    EXPECT_EQ(0, attitude.values.pitch);
+    EXPECT_EQ(0, attitude.values.yaw);
+    EXPECT_NEAR(1.0f, getCosTiltAngle(), 1e-4f);
+    EXPECT_TRUE(imuIsAircraftArmable(25));
+}
+
+TEST(FlightImuFixedAttitudeTest, ConvergesToAccelerometerTilt)
+{
+    magneticDeclination = 0.0f;
+    initImu();
+
+    // fast gains apply before arming, a few seconds are plenty
+    runImu(30, 5000);
+
+    EXPECT_NEAR(300, attitude.values.roll, 1);
+    EXPECT_NEAR(0, attitude.values.pitch, 1);
+
+    // the rotation matrix is published to the float consumers in imu.c
+    EXPECT_NEAR(cosf(DEGREES_TO_RADIANS(30)), getCosTiltAngle(), 1e-3f);
+    EXPECT_FALSE(imuIsAircraftArmable(25));
+    EXPECT_TRUE(imuIsAircraftArmable(35));
+
+    runImu(0, 5000);
+    EXPECT_NEAR(0, attitude.values.roll, 1);
+}
+
+TEST(FlightImuFixedAttitudeTest, YawIncludesDeclination)
+{
+    magneticDeclination = -50.0f;
+    initImu();
+    runImu(0, 10);
+
+    // -5 degrees wraps into 0-3600
+    EXPECT_EQ(3550, attitude.values.yaw);
+}
+
+// STUBS
+
+extern "C" {
+uint32_t rcModeActivationMask;
+int16_t rcCommand[4];
+int16_t rcData[MAX_SUPPORTED_RC_CHANNEL_COUNT];
+
+acc_t acc;
+int16_t heading;
+gyro_t gyro;
+int32_t magADC[XYZ_AXIS_COUNT];
+int32_t BaroAlt;
+int32_t baroSampleAltitude;
+uint32_t baroSampleTime;
+int16_t debug[DEBUG16_VALUE_COUNT];
+
+uint8_t stateFlags;
+uint16_t flightModeFlags;
+uint8_t armingFlags;
+
+int32_t sonarAlt;
+int16_t sonarMaxAltWithTiltCm;
+int32_t accADC[XYZ_AXIS_COUNT];
+int32_t gyroADC[XYZ_AXIS_COUNT];
+
+int16_t GPS_speed;
+int16_t GPS_ground_course;
+int16_t GPS_numSat;
+
+float magneticDeclination = 0.0f;
+
+bool rcModeIsActive(boxId_e modeId) { return rcModeActivationMask & (1 << modeId); }
+
+uint16_t enableFlightMode(flightModeFlags_e mask)
+{
+    return flightModeFlags |= (mask);
+}
+
+uint16_t disableFlightMode(flightModeFlags_e mask)
+{
+    return flightModeFlags &= ~(mask);
+}
+
+void gyroUpdate(void) {};
+bool sensors(uint32_t mask)
+{
+    return mask == SENSOR_ACC;
+};
+void updateAccelerationReadings(rollAndPitchTrims_t *rollAndPitchTrims)
+{
+    UNUSED(rollAndPitchTrims);
+}
+
+uint32_t micros(void) { return currentTime; }
+uint32_t millis(void) { return 0; }
+bool isBaroCalibrationComplete(void) { return true; }
+void performBaroCalibrationCycle(void) {}
+int32_t baroCalculateAltitude(void) { return 0; }
+}
@@ -0,0 +1,312 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <limits.h>
+
+extern "C" {
+    #include <platform.h>
+    #include "build/build_config.h"
+    #include "build/debug.h"
+
+    #include "common/axis.h"
+    #include "common/maths.h"
+    #include "common/fixedpoint.h"
+
+    #include "config/parameter_group.h"
+    #include "config/parameter_group_ids.h"
+    #include "config/profile.h"
+
+    #include "sensors/sensors.h"
+
+    #include "drivers/sensor.h"
+    #include "drivers/accgyro.h"
+    #include "drivers/compass.h"
+
+    #include "sensors/gyro.h"
+    #include "sensors/compass.h"
+    #include "sensors/acceleration.h"
+    #include "sensors/barometer.h"
+
+    #include "fc/runtime_config.h"
+
+    #include "io/motors.h"
+    #include "fc/rc_controls.h"
+
+    #include "rx/rx.h"
+
+    #include "flight/mixer.h"
+    #include "flight/pid.h"
+    #include "flight/imu.h"
+    #include "flight/imu_fixed.h"
+
+    PG_REGISTER_PROFILE(pidProfile_t, pidProfile, PG_PID_PROFILE, 0);
+    PG_REGISTER_PROFILE(rcControlsConfig_t, rcControlsConfig, PG_RC_CONTROLS_CONFIG, 0);
+    PG_REGISTER_PROFILE(barometerConfig_t, barometerConfig, PG_BAROMETER_CONFIG, 0);
+    PG_REGISTER_PROFILE(compassConfig_t, compassConfig, PG_COMPASS_CONFIGURATION, 0);
+    PG_REGISTER(motorConfig_t, motorConfig, PG_MOTOR_CONFIG, 0);
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+extern float q0, q1, q2, q3;
+extern "C" {
+void imuComputeRotationMatrix(void);
+void imuUpdateEulerAngles(void);
+void imuMahonyAHRSupdate(float dt, float gx, float gy, float gz,
+                         bool useAcc, float ax, float ay, float az,
+                         bool useMag, float mx, float my, float mz,
+                         bool useYaw, float yawError);
+
+int16_t cycleTime = 2000;
+}
+
+TEST(FixedPointTest, TestNormalize)
+{
+    const int32_t acc[3] = { 0, 0, 512 };
+    fix30_t dest[3];
+
+    EXPECT_TRUE(fixNormalize(acc, dest, 3));
+    EXPECT_EQ(0, dest[X]);
+    EXPECT_EQ(0, dest[Y]);
+    EXPECT_NEAR(FIX30_ONE, dest[Z], 4);
+
+    const int32_t zero[3] = { 0, 0, 0 };
+    EXPECT_FALSE(fixNormalize(zero, dest, 3));
+
+    double error = 0;
+    for (int32_t x = -20000; x <= 20000; x += 777) {
+        for (int32_t y = -20000; y <= 20000; y += 1313) {
+            const int32_t v[3] = { x, y, 4096 };
+            fixNormalize(v, dest, 3);
+            double norm = sqrt((double)x * x + (double)y * y + 4096.0 * 4096.0);
+            error = MAX(error, fabs(FIX30_TO_FLOAT(dest[X]) - x / norm));
+            error = MAX(error, fabs(FIX30_TO_FLOAT(dest[Y]) - y / norm));
+        }
+    }
+    printf("fixNormalize maximum absolute error = %e\n", error);
+    EXPECT_LE(error, 1e-7);
+}
+
+TEST(FixedPointTest, TestAtan2)
+{
+    double error = 0;
+    double magnitudeError = 0;
+    for (float x = -1.0f; x < 1.0f; x += 0.002f) {
+        for (float y = -1.0f; y < 1.0f; y += 0.002f) {
+            int32_t magnitude;
+            fixAngle_t angle = fixAtan2(FIX30_FROM_FLOAT(y), FIX30_FROM_FLOAT(x), &magnitude);
+            double result = angle * (M_PI / 2147483648.0);
+            double libmResult = atan2(y, x);
+            double diff = fabs(result - libmResult);
+            error = MAX(error, MIN(diff, 2 * M_PI - diff));
+            magnitudeError = MAX(magnitudeError, fabs(FIX30_TO_FLOAT(magnitude) - sqrt(x * x + y * y)));
+        }
+    }
+    printf("fixAtan2 maximum absolute error = %e rads (%e degree), magnitude error = %e\n", error, error / M_PI * 180.0f, magnitudeError);
+    EXPECT_LE(error, 1e-6);
+    EXPECT_LE(magnitudeError, 1e-6);
+}
+
+TEST(FixedPointTest, TestSin)
+{
+    double error = 0;
+    for (int32_t decidegrees = -1800; decidegrees <= 1800; decidegrees++) {
+        double result = FIX30_TO_FLOAT(fixSin(fixAngleFromDecidegrees(decidegrees)));
+        error = MAX(error, fabs(result - sin(decidegrees * M_PI / 1800.0)));
+    }
+    printf("fixSin maximum absolute error = %e\n", error);
+    EXPECT_LE(error, 1e-6);
+}
+
+TEST(FixedPointTest, TestAngleConversion)
+{
+    EXPECT_EQ(FIX_ANGLE_90_DEG, fixAngleFromDecidegrees(900));
+    EXPECT_EQ(900, fixAngleToDecidegrees(FIX_ANGLE_90_DEG));
+    EXPECT_EQ(-1800, fixAngleToDecidegrees(fixAngleFromDecidegrees(1800)));
+    for (int32_t decidegrees = -1799; decidegrees < 1800; decidegrees++) {
+        EXPECT_EQ(decidegrees, fixAngleToDecidegrees(fixAngleFromDecidegrees(decidegrees)));
+    }
+}
+
+static int16_t angleDifference(int16_t a, int16_t b)
+{
+    int16_t diff = ABS(a - b);
+    return MIN(diff, 3600 - diff);
+}
+
+/*
+ * Feeds the float and the fixed point AHRS the same synthetic gyro and accelerometer samples of a tumbling
+ * aircraft and reports the largest difference between the attitudes they calculate.
+ */
+static int16_t runEquivalence(float kp, float ki, bool armed)
+{
+    static imuRuntimeConfig_t imuRuntimeConfig;
+    static accDeadband_t accDeadband;
+    const uint32_t deltaT = 1000;
+    const int steps = 30000;
+
+    imuRuntimeConfig.dcm_kp = kp;
+    imuRuntimeConfig.dcm_ki = ki;
+    imuConfigure(&imuRuntimeConfig, &accDeadband, 10.0f, 800);
+
+    gyro.scale = 1.0f / 16.4f;
+    acc.acc_1G = 4096;
+    if (armed) {
+        ENABLE_ARMING_FLAG(ARMED);
+    } else {
+        DISABLE_ARMING_FLAG(ARMED);
+    }
+    q0 = 1.0f; q1 = 0.0f; q2 = 0.0f; q3 = 0.0f;
+    imuInit();
+
+    const float gyroScale = gyro.scale * (M_PIf / 180.0f);
+    imuFixedInit(gyroScale);
+    imuFixedConfigure(kp, ki);
+
+    // true attitude, integrated in double precision from the same body rates the gyro samples are made of
+    double t0 = 1.0, t1 = 0.0, t2 = 0.0, t3 = 0.0;
+    int16_t maxDivergence = 0;
+
+    srand(42);
+    for (int i = 0; i < steps; i++) {
+        double t = i * deltaT * 1e-6;
+        double wx = 3.0 * sin(2.1 * t) + 0.05;
+        double wy = 2.0 * sin(1.3 * t + 1.0) - 0.03;
+        double wz = 4.0 * sin(0.7 * t + 2.0);
+
+        double hx = 0.5 * wx * deltaT * 1e-6, hy = 0.5 * wy * deltaT * 1e-6, hz = 0.5 * wz * deltaT * 1e-6;
+        double a = t0, b = t1, c = t2;
+        t0 += -b * hx - c * hy - t3 * hz;
+        t1 += a * hx + c * hz - t3 * hy;
+        t2 += a * hy - b * hz + t3 * hx;
+        t3 += a * hz + b * hy - c * hx;
+        double n = sqrt(t0 * t0 + t1 * t1 + t2 * t2 + t3 * t3);
+        t0 /= n; t1 /= n; t2 /= n; t3 /= n;
+
+        int32_t gyroSample[3];
+        gyroSample[X] = lrint(wx / gyroScale) + (rand() % 5) - 2;
+        gyroSample[Y] = lrint(wy / gyroScale) + (rand() % 5) - 2;
+        gyroSample[Z] = lrint(wz / gyroScale) + (rand() % 5) - 2;
+
+        int32_t accSample[3];
+        accSample[X] = lrint(acc.acc_1G * 2.0 * (t1 * t3 - t0 * t2)) + (rand() % 41) - 20;
+        accSample[Y] = lrint(acc.acc_1G * 2.0 * (t2 * t3 + t0 * t1)) + (rand() % 41) - 20;
+        accSample[Z] = lrint(acc.acc_1G * (1.0 - 2.0 * (t1 * t1 + t2 * t2))) + (rand() % 41) - 20;
+
+        imuMahonyAHRSupdate(deltaT * 1e-6f,
+                            gyroSample[X] * gyroScale, gyroSample[Y] * gyroScale, gyroSample[Z] * gyroScale,
+                            true, accSample[X], accSample[Y], accSample[Z],
+                            false, 0, 0, 0,
+                            false, 0);
+        imuUpdateEulerAngles();
+
+        const int32_t mag[3] = { 0, 0, 0 };
+        imuFixedMahonyAHRSupdate(deltaT, gyroSample, true, accSample, false, mag, false, 0, !armed);
+        attitudeEulerAngles_t fixedAttitude;
+        imuFixedCalculateEulerAngles(&fixedAttitude);
+        if (fixedAttitude.values.yaw < 0) {
+            fixedAttitude.values.yaw += 3600;
+        }
+
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            maxDivergence = MAX(maxDivergence, angleDifference(attitude.raw[axis], fixedAttitude.raw[axis]));
+        }
+    }
+    return maxDivergence;
+}
+
+TEST(FlightImuFixedTest, TestEquivalenceWithFloatImplementation)
+{
+    int16_t divergence = runEquivalence(0.25f, 0.0f, true);
+    printf("imuFixedMahonyAHRSupdate maximum angular divergence = %d decidegrees (kp 0.25)\n", divergence);
+    EXPECT_LE(divergence, 1);
+
+    divergence = runEquivalence(0.25f, 0.003f, true);
+    printf("imuFixedMahonyAHRSupdate maximum angular divergence = %d decidegrees (kp 0.25, ki 0.003)\n", divergence);
+    EXPECT_LE(divergence, 1);
+
+    divergence = runEquivalence(0.25f, 0.0f, false);
+    printf("imuFixedMahonyAHRSupdate maximum angular divergence = %d decidegrees (kp 0.25, fast gains)\n", divergence);
+    EXPECT_LE(divergence, 1);
+}
+
+// STUBS
+
+extern "C" {
+uint32_t rcModeActivationMask;
+int16_t rcCommand[4];
+int16_t rcData[MAX_SUPPORTED_RC_CHANNEL_COUNT];
+
+acc_t acc;
+int16_t heading;
+gyro_t gyro;
+int32_t magADC[XYZ_AXIS_COUNT];
+int32_t BaroAlt;
+int32_t baroSampleAltitude;
+uint32_t baroSampleTime;
+int16_t debug[DEBUG16_VALUE_COUNT];
+
+uint8_t stateFlags;
+uint16_t flightModeFlags;
+uint8_t armingFlags;
+
+int32_t sonarAlt;
+int16_t sonarMaxAltWithTiltCm;
+int32_t accADC[XYZ_AXIS_COUNT];
+int32_t gyroADC[XYZ_AXIS_COUNT];
+
+int16_t GPS_speed;
+int16_t GPS_ground_course;
+int16_t GPS_numSat;
+
+float magneticDeclination = 0.0f;
+
+bool rcModeIsActive(boxId_e modeId) { return rcModeActivationMask & (1 << modeId); }
+
+uint16_t enableFlightMode(flightModeFlags_e mask)
+{
+    return flightModeFlags |= (mask);
+}
+
+uint16_t disableFlightMode(flightModeFlags_e mask)
+{
+    return flightModeFlags &= ~(mask);
+}
+
+void gyroUpdate(void) {};
+bool sensors(uint32_t mask)
+{
+    UNUSED(mask);
+    return false;
+};
+void updateAccelerationReadings(rollAndPitchTrims_t *rollAndPitchTrims)
+{
+    UNUSED(rollAndPitchTrims);
+}
+
+uint32_t micros(void) { return 0; }
+uint32_t millis(void) { return 0; }
+bool isBaroCalibrationComplete(void) { return true; }
+void performBaroCalibrationCycle(void) {}
+int32_t baroCalculateAltitude(void) { return 0; }
+}
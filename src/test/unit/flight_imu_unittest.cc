@@ -159,6 +159,8 @@ int16_t heading;
 gyro_t gyro;
 int32_t magADC[XYZ_AXIS_COUNT];
 int32_t BaroAlt;
+int32_t baroSampleAltitude;
+uint32_t baroSampleTime;
 int16_t debug[DEBUG16_VALUE_COUNT];
 
 uint8_t stateFlags;
@@ -166,7 +168,6 @@ uint16_t flightModeFlags;
 uint8_t armingFlags;
 
 int32_t sonarAlt;
-int16_t sonarCfAltCm;
 int16_t sonarMaxAltWithTiltCm;
 int32_t accADC[XYZ_AXIS_COUNT];
 int32_t gyroADC[XYZ_AXIS_COUNT];
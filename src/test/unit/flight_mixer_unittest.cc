@@ -51,6 +51,7 @@ extern "C" {
     #include "io/motors.h"
     #include "io/gimbal.h"
     #include "fc/rc_controls.h"
+    #include "fc/config.h"
 
 
     extern uint8_t servoCount;
@@ -90,11 +91,18 @@ servo_t servos[MAX_SUPPORTED_SERVOS];
 
 uint8_t lastOneShotUpdateMotorCount;
 
+int16_t reportedSaturation[XYZ_AXIS_COUNT];
+
 uint32_t testFeatureMask = 0;
 
 int updatedServoCount;
 int updatedMotorCount;
 
+bool outputFrameOpen;
+int outputFrameCommits;
+int outputWritesOutsideFrame;
+int oneshotUpdatesInsideFrame;
+
 TEST(FlightAxisUnittest, TestAxisIndices)
 {
     // In various places Cleanflight assumes equality between the flight dynamics indices,
@@ -206,6 +214,12 @@ protected:
         updatedServoCount = 0;
         updatedMotorCount = 0;
 
+        outputFrameOpen = false;
+        outputFrameCommits = 0;
+        outputWritesOutsideFrame = 0;
+        oneshotUpdatesInsideFrame = 0;
+        testFeatureMask = 0;
+
         memset(mixerConfig(), 0, sizeof(*mixerConfig()));
         memset(rxConfig(), 0, sizeof(*rxConfig()));
         memset(motorConfig(), 0, sizeof(*motorConfig()));
@@ -214,6 +228,7 @@ protected:
         memset(rcData, 0, sizeof(rcData));
         memset(rcCommand, 0, sizeof(rcCommand));
         memset(axisPID, 0, sizeof(axisPID));
+        memset(reportedSaturation, 0, sizeof(reportedSaturation));
         memset(customMotorMixer_arr(), 0, sizeof(*customMotorMixer_arr()));
     }
 
@@ -277,6 +292,84 @@ TEST_F(BasicMixerIntegrationTest, TestTricopterServo)
     EXPECT_EQ(TEST_SERVO_MID, servos[0].value);
 }
 
+TEST_F(BasicMixerIntegrationTest, TestTricopterOutputFrame)
+{
+    // given
+    withDefaultMotorConfiguration();
+    withDefaultRxConfig();
+    mixerConfig()->tri_unarmed_servo = 1;
+
+    servoConf[5].min = DEFAULT_SERVO_MIN;
+    servoConf[5].max = DEFAULT_SERVO_MAX;
+    servoConf[5].middle = DEFAULT_SERVO_MIDDLE;
+    servoConf[5].rate = 100;
+    servoConf[5].forwardFromChannel = CHANNEL_FORWARDING_DISABLED;
+
+    configureMixer(MIXER_TRI);
+
+    mixerInit(customMotorMixer(0));
+    mixerInitServos(customServoMixer(0));
+
+    // and
+    pwmIOConfiguration_t pwmIOConfiguration = {
+            .servoCount = 1,
+            .motorCount = 3,
+            .ioCount = 4,
+            .pwmInputCount = 0,
+            .ppmInputCount = 0,
+            .ioConfigurations = {}
+    };
+
+    mixerUsePWMIOConfiguration(&pwmIOConfiguration);
+
+    // and
+    testFeatureMask = FEATURE_ONESHOT125;
+
+    // when
+    mixTable();
+    writeOutputFrame(true);
+
+    // then the tail servo and all motors are latched by one commit
+    EXPECT_EQ(1, updatedServoCount);
+    EXPECT_EQ(3, updatedMotorCount);
+    EXPECT_EQ(1, outputFrameCommits);
+    EXPECT_EQ(0, outputWritesOutsideFrame);
+
+    // and oneshot pulses are only fired once the frame is committed
+    EXPECT_EQ(3, lastOneShotUpdateMotorCount);
+    EXPECT_EQ(0, oneshotUpdatesInsideFrame);
+}
+
+TEST_F(BasicMixerIntegrationTest, TestOutputFrameWithoutMotors)
+{
+    // given
+    withDefaultMotorConfiguration();
+    configureMixer(MIXER_QUADX);
+
+    mixerInit(customMotorMixer(0));
+    mixerInitServos(customServoMixer(0));
+
+    // and
+    pwmIOConfiguration_t pwmIOConfiguration = {
+            .servoCount = 0,
+            .motorCount = 4,
+            .ioCount = 4,
+            .pwmInputCount = 0,
+            .ppmInputCount = 0,
+            .ioConfigurations = {}
+    };
+
+    mixerUsePWMIOConfiguration(&pwmIOConfiguration);
+
+    // when
+    mixTable();
+    writeOutputFrame(false);
+
+    // then
+    EXPECT_EQ(0, updatedMotorCount);
+    EXPECT_EQ(1, outputFrameCommits);
+}
+
 TEST_F(BasicMixerIntegrationTest, TestQuadMotors)
 {
     // given
@@ -320,6 +413,50 @@ TEST_F(BasicMixerIntegrationTest, TestQuadMotors)
     EXPECT_EQ(TEST_MIN_COMMAND, motors[3].value);
 }
 
+TEST_F(BasicMixerIntegrationTest, TestQuadMotorSaturationReported)
+{
+    // given
+    withDefaultMotorConfiguration();
+    motorConfig()->minthrottle = 1000;
+    motorConfig()->maxthrottle = 2000;
+
+    configureMixer(MIXER_QUADX);
+
+    mixerInit(customMotorMixer(0));
+    mixerInitServos(customServoMixer(0));
+
+    // and
+    pwmIOConfiguration_t pwmIOConfiguration = {
+            .servoCount = 0,
+            .motorCount = 4,
+            .ioCount = 4,
+            .pwmInputCount = 0,
+            .ppmInputCount = 0,
+            .ioConfigurations = {}
+    };
+
+    mixerUsePWMIOConfiguration(&pwmIOConfiguration);
+
+    // and
+    rcCommand[THROTTLE] = 1100;
+    axisPID[FD_ROLL] = 400;
+
+    // when
+    mixTable();
+
+    // then
+    // the right motors are held at minthrottle, 250 of the 400 roll is delivered
+    EXPECT_EQ(150, reportedSaturation[FD_ROLL]);
+    EXPECT_EQ(0, reportedSaturation[FD_PITCH]);
+
+    // when
+    rcCommand[THROTTLE] = 1500;
+    mixTable();
+
+    // then
+    EXPECT_EQ(0, reportedSaturation[FD_ROLL]);
+    EXPECT_EQ(0, reportedSaturation[FD_PITCH]);
+}
 
 class CustomMixerIntegrationTest : public BasicMixerIntegrationTest {
 protected:
@@ -454,6 +591,9 @@ bool feature(uint32_t mask) {
 void pwmWriteMotor(uint8_t index, uint16_t value) {
     motors[index].value = value;
     updatedMotorCount++;
+    if (!outputFrameOpen) {
+        outputWritesOutsideFrame++;
+    }
 }
 
 void pwmShutdownPulsesForAllMotors(uint8_t motorCount)
@@ -467,6 +607,18 @@ void pwmShutdownPulsesForAllMotors(uint8_t motorCount)
 
 void pwmCompleteOneshotMotorUpdate(uint8_t motorCount) {
     lastOneShotUpdateMotorCount = motorCount;
+    if (outputFrameOpen) {
+        oneshotUpdatesInsideFrame++;
+    }
+}
+
+void pwmOutputBeginUpdate(void) {
+    outputFrameOpen = true;
+}
+
+void pwmOutputCommitUpdate(void) {
+    outputFrameOpen = false;
+    outputFrameCommits++;
 }
 
 void pwmWriteServo(uint8_t index, uint16_t value) {
@@ -478,6 +630,9 @@ void pwmWriteServo(uint8_t index, uint16_t value) {
         servos[index].value = value;
     }
     updatedServoCount++;
+    if (!outputFrameOpen) {
+        outputWritesOutsideFrame++;
+    }
 }
 
 bool rcModeIsActive(boxId_e modeId) { return rcModeActivationMask & (1 << modeId); }
@@ -486,6 +641,10 @@ bool failsafeIsActive(void) {
     return false;
 }
 
+void pidSetActuatorSaturation(flight_dynamics_index_t axis, int16_t clipped) {
+    reportedSaturation[axis] = clipped;
+}
+
 //Tricopter mixer stubs
 void triInitMixer(servoParam_t *pTailServoConfig, int16_t *pTailServo, mixerConfig_t *pMixerConfig) {
     UNUSED(pTailServoConfig);
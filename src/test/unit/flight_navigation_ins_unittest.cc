@@ -0,0 +1,409 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <vector>
+
+extern "C" {
+#include <platform.h>
+
+#include "flight/navigation_ins.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+// One line of a navigation log: the IMU sample of a filter step and, if gps is set, the GPS solution that
+// arrived in it. The true position and velocity are only known for generated traces.
+typedef struct replayRecord_s {
+    uint32_t timeMs;
+    float acc[NAV_INS_AXIS_COUNT];          // cm/s/s
+    bool gps;
+    bool gpsVelocity;
+    float gpsPos[NAV_INS_AXIS_COUNT];       // cm
+    float gpsVel[NAV_INS_AXIS_COUNT];       // cm/s
+    uint16_t gpsLatencyMs;
+    float truePos[NAV_INS_AXIS_COUNT];
+    float trueVel[NAV_INS_AXIS_COUNT];
+} replayRecord_t;
+
+typedef struct replayResult_s {
+    float posRms;
+    float velRms;
+    float maxPosError;
+} replayResult_t;
+
+static navIns_t ins;
+
+// Feeds a log to the filter as the GPS task does, returns the error against the true trajectory
+static replayResult_t replay(const std::vector<replayRecord_t> &log, FILE *output)
+{
+    replayResult_t result = { 0, 0, 0 };
+    double posSquares = 0, velSquares = 0;
+    int count = 0;
+
+    navInsInit(&ins);
+    for (const replayRecord_t &record : log) {
+        if (record.gps) {
+            navInsCorrect(&ins, record.gpsPos, record.gpsVelocity ? record.gpsVel : NULL, record.timeMs, record.gpsLatencyMs);
+        }
+        navInsPredict(&ins, record.acc, record.timeMs);
+        if (output) {
+            fprintf(output, "%u,%d,%.1f,%.1f,%.1f,%.1f\n", record.timeMs, ins.valid,
+                ins.pos[NAV_INS_NORTH], ins.pos[NAV_INS_EAST], ins.vel[NAV_INS_NORTH], ins.vel[NAV_INS_EAST]);
+        }
+        if (!ins.valid) {
+            continue;
+        }
+        for (int axis = 0; axis < NAV_INS_AXIS_COUNT; axis++) {
+            const float posError = ins.pos[axis] - record.truePos[axis];
+            const float velError = ins.vel[axis] - record.trueVel[axis];
+            posSquares += posError * posError;
+            velSquares += velError * velError;
+            result.maxPosError = fmaxf(result.maxPosError, fabsf(posError));
+        }
+        count++;
+    }
+    if (count) {
+        result.posRms = sqrt(posSquares / count);
+        result.velRms = sqrt(velSquares / count);
+    }
+    return result;
+}
+
+static uint32_t noiseSeed;
+
+// uniform in [-amplitude, amplitude], repeatable
+static float noise(float amplitude)
+{
+    noiseSeed = noiseSeed * 1103515245 + 12345;
+    return amplitude * (((noiseSeed >> 8) & 0xffff) / 32767.5f - 1.0f);
+}
+
+/*
+ * A craft circling at 3m/s with a 10m radius, logged at 100Hz. The IMU has noise and a bias, the GPS
+ * reports at gpsHz with a delay of latencyMs and noise on position and velocity.
+ */
+static std::vector<replayRecord_t> generateCircle(int seconds, int gpsHz, uint16_t latencyMs, bool gpsVelocity)
+{
+    const float radius = 1000.0f;
+    const float omega = 300.0f / radius;
+    const float accBias[NAV_INS_AXIS_COUNT] = { 15.0f, -10.0f };
+    std::vector<replayRecord_t> log;
+
+    noiseSeed = 1;
+    for (uint32_t timeMs = 1000; timeMs < 1000 + seconds * 1000u; timeMs += 10) {
+        replayRecord_t record;
+        memset(&record, 0, sizeof(record));
+        record.timeMs = timeMs;
+
+        const float t = timeMs / 1000.0f;
+        record.truePos[NAV_INS_NORTH] = radius * cosf(omega * t);
+        record.truePos[NAV_INS_EAST] = radius * sinf(omega * t);
+        record.trueVel[NAV_INS_NORTH] = -radius * omega * sinf(omega * t);
+        record.trueVel[NAV_INS_EAST] = radius * omega * cosf(omega * t);
+        record.acc[NAV_INS_NORTH] = -radius * omega * omega * cosf(omega * t) + accBias[NAV_INS_NORTH] + noise(50);
+        record.acc[NAV_INS_EAST] = -radius * omega * omega * sinf(omega * t) + accBias[NAV_INS_EAST] + noise(50);
+
+        if (timeMs % (1000 / gpsHz) == 0) {
+            const float measured = (timeMs - latencyMs) / 1000.0f;
+            record.gps = true;
+            record.gpsVelocity = gpsVelocity;
+            record.gpsLatencyMs = latencyMs;
+            record.gpsPos[NAV_INS_NORTH] = radius * cosf(omega * measured) + noise(50);
+            record.gpsPos[NAV_INS_EAST] = radius * sinf(omega * measured) + noise(50);
+            record.gpsVel[NAV_INS_NORTH] = -radius * omega * sinf(omega * measured) + noise(20);
+            record.gpsVel[NAV_INS_EAST] = radius * omega * cosf(omega * measured) + noise(20);
+        }
+        log.push_back(record);
+    }
+    return log;
+}
+
+// The position error of navigating on the last fix received, what the navigation code did without the filter
+static float lastFixPositionRms(const std::vector<replayRecord_t> &log)
+{
+    double squares = 0;
+    int count = 0;
+    const replayRecord_t *fix = NULL;
+
+    for (const replayRecord_t &record : log) {
+        if (record.gps) {
+            fix = &record;
+        }
+        if (!fix) {
+            continue;
+        }
+        for (int axis = 0; axis < NAV_INS_AXIS_COUNT; axis++) {
+            squares += (fix->gpsPos[axis] - record.truePos[axis]) * (fix->gpsPos[axis] - record.truePos[axis]);
+        }
+        count++;
+    }
+    return sqrt(squares / count);
+}
+
+// The velocity error of differentiating successive fixes and averaging two of them, as GPS_calc_velocity() does
+static float differentiatedVelocityRms(const std::vector<replayRecord_t> &log)
+{
+    double squares = 0;
+    int count = 0;
+    const replayRecord_t *fix = NULL;
+    const replayRecord_t *lastFix = NULL;
+    float speed[NAV_INS_AXIS_COUNT] = { 0, 0 };
+
+    for (const replayRecord_t &record : log) {
+        if (record.gps) {
+            if (fix) {
+                for (int axis = 0; axis < NAV_INS_AXIS_COUNT; axis++) {
+                    const float differentiated = (record.gpsPos[axis] - fix->gpsPos[axis]) * 1000.0f / (record.timeMs - fix->timeMs);
+                    speed[axis] = (differentiated + speed[axis]) / 2;
+                }
+                lastFix = fix;
+            }
+            fix = &record;
+        }
+        if (!lastFix) {
+            continue;
+        }
+        for (int axis = 0; axis < NAV_INS_AXIS_COUNT; axis++) {
+            squares += (speed[axis] - record.trueVel[axis]) * (speed[axis] - record.trueVel[axis]);
+        }
+        count++;
+    }
+    return sqrt(squares / count);
+}
+
+TEST(NavigationInsTest, StartsOnFirstSolution)
+{
+    const float acc[NAV_INS_AXIS_COUNT] = { 100, 0 };
+    const float pos[NAV_INS_AXIS_COUNT] = { 500, -300 };
+    const float vel[NAV_INS_AXIS_COUNT] = { 20, 10 };
+
+    navInsInit(&ins);
+    navInsPredict(&ins, acc, 1000);
+    EXPECT_FALSE(ins.valid);
+
+    navInsCorrect(&ins, pos, vel, 1000, 100);
+    EXPECT_TRUE(ins.valid);
+    EXPECT_FLOAT_EQ(500, ins.pos[NAV_INS_NORTH]);
+    EXPECT_FLOAT_EQ(-300, ins.pos[NAV_INS_EAST]);
+    EXPECT_FLOAT_EQ(20, ins.vel[NAV_INS_NORTH]);
+    EXPECT_FLOAT_EQ(10, ins.vel[NAV_INS_EAST]);
+}
+
+TEST(NavigationInsTest, PredictsBetweenSolutions)
+{
+    const float acc[NAV_INS_AXIS_COUNT] = { 100, -50 };
+    const float pos[NAV_INS_AXIS_COUNT] = { 0, 0 };
+
+    navInsInit(&ins);
+    navInsCorrect(&ins, pos, NULL, 1000, 0);
+    for (uint32_t timeMs = 1010; timeMs <= 1500; timeMs += 10) {
+        navInsPredict(&ins, acc, timeMs);
+    }
+
+    // half a second of constant acceleration
+    EXPECT_NEAR(12.5f, ins.pos[NAV_INS_NORTH], 0.01f);
+    EXPECT_NEAR(-6.25f, ins.pos[NAV_INS_EAST], 0.01f);
+    EXPECT_NEAR(50.0f, ins.vel[NAV_INS_NORTH], 0.01f);
+    EXPECT_NEAR(-25.0f, ins.vel[NAV_INS_EAST], 0.01f);
+}
+
+TEST(NavigationInsTest, ComparesSolutionWithEstimateOfItsTime)
+{
+    const float acc[NAV_INS_AXIS_COUNT] = { 0, 0 };
+    const float vel[NAV_INS_AXIS_COUNT] = { 100, 0 };
+    float pos[NAV_INS_AXIS_COUNT] = { 0, 0 };
+
+    // moving north at 1m/s, the filter agrees with the GPS
+    navInsInit(&ins);
+    navInsCorrect(&ins, pos, vel, 1000, 0);
+    for (uint32_t timeMs = 1010; timeMs <= 1400; timeMs += 10) {
+        navInsPredict(&ins, acc, timeMs);
+    }
+    EXPECT_NEAR(40.0f, ins.pos[NAV_INS_NORTH], 0.01f);
+
+    navIns_t undelayed = ins;
+
+    // a solution for 200ms ago arrives, it matches the estimate of that time so nothing changes
+    pos[NAV_INS_NORTH] = 20.0f;
+    navInsCorrect(&ins, pos, vel, 1400, 200);
+    EXPECT_NEAR(40.0f, ins.pos[NAV_INS_NORTH], 0.01f);
+    EXPECT_NEAR(100.0f, ins.vel[NAV_INS_NORTH], 0.01f);
+
+    // taken as current it would have pulled the estimate back
+    navInsCorrect(&undelayed, pos, vel, 1400, 0);
+    EXPECT_LT(undelayed.pos[NAV_INS_NORTH], 39.0f);
+}
+
+TEST(NavigationInsTest, CorrectionReachesHistory)
+{
+    const float acc[NAV_INS_AXIS_COUNT] = { 0, 0 };
+    float pos[NAV_INS_AXIS_COUNT] = { 0, 0 };
+
+    navInsInit(&ins);
+    navInsCorrect(&ins, pos, NULL, 1000, 0);
+    for (uint32_t timeMs = 1010; timeMs <= 1200; timeMs += 10) {
+        navInsPredict(&ins, acc, timeMs);
+    }
+
+    // the same delayed offset reported twice must not be corrected twice as much
+    pos[NAV_INS_NORTH] = 100.0f;
+    navInsCorrect(&ins, pos, NULL, 1200, 100);
+    const float afterFirst = ins.pos[NAV_INS_NORTH];
+    EXPECT_GT(afterFirst, 0.0f);
+
+    for (uint32_t timeMs = 1210; timeMs <= 1400; timeMs += 10) {
+        navInsPredict(&ins, acc, timeMs);
+    }
+    const float predicted = ins.pos[NAV_INS_NORTH];
+    navInsCorrect(&ins, pos, NULL, 1400, 100);
+    EXPECT_LT(ins.pos[NAV_INS_NORTH] - predicted, afterFirst);
+}
+
+TEST(NavigationInsTest, StopsWithoutSolutions)
+{
+    const float acc[NAV_INS_AXIS_COUNT] = { 0, 0 };
+    const float pos[NAV_INS_AXIS_COUNT] = { 0, 0 };
+
+    navInsInit(&ins);
+    navInsCorrect(&ins, pos, NULL, 1000, 0);
+    navInsPredict(&ins, acc, 1000 + NAV_INS_TIMEOUT_MS);
+    EXPECT_TRUE(ins.valid);
+    navInsPredict(&ins, acc, 1010 + NAV_INS_TIMEOUT_MS);
+    EXPECT_FALSE(ins.valid);
+}
+
+TEST(NavigationInsTest, RestartsOnFarSolution)
+{
+    const float acc[NAV_INS_AXIS_COUNT] = { 0, 0 };
+    float pos[NAV_INS_AXIS_COUNT] = { 0, 0 };
+
+    navInsInit(&ins);
+    navInsCorrect(&ins, pos, NULL, 1000, 0);
+    navInsPredict(&ins, acc, 1100);
+
+    pos[NAV_INS_EAST] = 100000.0f;
+    navInsCorrect(&ins, pos, NULL, 1200, 0);
+    EXPECT_FLOAT_EQ(100000.0f, ins.pos[NAV_INS_EAST]);
+}
+
+TEST(NavigationInsTest, EstimatesLatency)
+{
+    navInsInit(&ins);
+
+    // our clock is 123456ms ahead of GPS time, solutions at 10Hz take 30 to 70ms to arrive
+    const uint16_t delays[] = { 50, 30, 70, 45, 30, 60 };
+    uint16_t latency[6];
+    for (int i = 0; i < 6; i++) {
+        const uint32_t timeOfWeekMs = 500000 + i * 100;
+        latency[i] = navInsEstimateLatency(&ins, timeOfWeekMs + 123456 + delays[i], timeOfWeekMs, 20);
+    }
+
+    // the fastest solution seen so far is taken as having no delay beyond the processing time
+    EXPECT_EQ(20, latency[0]);
+    EXPECT_EQ(20, latency[1]);
+    EXPECT_EQ(60, latency[2]);
+    EXPECT_EQ(35, latency[3]);
+    EXPECT_EQ(20, latency[4]);
+    EXPECT_EQ(50, latency[5]);
+
+    // a new GPS week starts over
+    EXPECT_EQ(20, navInsEstimateLatency(&ins, 700000, 0, 20));
+    EXPECT_EQ(30, navInsEstimateLatency(&ins, 700110, 100, 20));
+
+    // never more than the history covers
+    EXPECT_EQ(NAV_INS_MAX_LATENCY_MS, navInsEstimateLatency(&ins, 700200, 200, 1000));
+}
+
+TEST(NavigationInsTest, ReplayWithPositionOnly)
+{
+    const std::vector<replayRecord_t> log = generateCircle(60, 5, 150, false);
+    const replayResult_t result = replay(log, NULL);
+    const float lastFixRms = lastFixPositionRms(log);
+    const float differentiatedRms = differentiatedVelocityRms(log);
+
+    printf("[ replay   ] 5Hz NMEA: position rms %.1fcm (last fix %.1fcm), velocity rms %.1fcm/s (differentiated %.1fcm/s)\n",
+        result.posRms, lastFixRms, result.velRms, differentiatedRms);
+    EXPECT_LT(result.posRms, lastFixRms / 2);
+    EXPECT_LT(result.velRms, differentiatedRms / 2);
+}
+
+TEST(NavigationInsTest, ReplayWithVelocity)
+{
+    const std::vector<replayRecord_t> log = generateCircle(60, 10, 100, true);
+    const replayResult_t result = replay(log, NULL);
+    const float lastFixRms = lastFixPositionRms(log);
+    const float differentiatedRms = differentiatedVelocityRms(log);
+
+    printf("[ replay   ] 10Hz UBX: position rms %.1fcm (last fix %.1fcm), velocity rms %.1fcm/s (differentiated %.1fcm/s)\n",
+        result.posRms, lastFixRms, result.velRms, differentiatedRms);
+    EXPECT_LT(result.posRms, lastFixRms / 2);
+    EXPECT_LT(result.velRms, differentiatedRms / 4);
+    EXPECT_LT(result.maxPosError, 100.0f);
+}
+
+/*
+ * Replays a recorded log given in NAV_INS_REPLAY_LOG and writes the estimate to NAV_INS_REPLAY_OUTPUT, or
+ * stdout. The log is CSV with one line per filter step:
+ *     time_ms,acc_north,acc_east,gps,pos_north,pos_east,vel_valid,vel_north,vel_east,latency_ms
+ * in cm, cm/s and cm/s/s; the GPS columns are only used if gps is 1. The output is
+ *     time_ms,valid,pos_north,pos_east,vel_north,vel_east
+ */
+TEST(NavigationInsTest, ReplayLog)
+{
+    const char *logName = getenv("NAV_INS_REPLAY_LOG");
+    if (!logName) {
+        return;
+    }
+
+    FILE *logFile = fopen(logName, "r");
+    ASSERT_TRUE(logFile != NULL);
+
+    std::vector<replayRecord_t> log;
+    char line[256];
+    while (fgets(line, sizeof(line), logFile)) {
+        replayRecord_t record;
+        int gps, velocity, latency;
+        memset(&record, 0, sizeof(record));
+        if (sscanf(line, "%u,%f,%f,%d,%f,%f,%d,%f,%f,%d", &record.timeMs, &record.acc[NAV_INS_NORTH], &record.acc[NAV_INS_EAST],
+                &gps, &record.gpsPos[NAV_INS_NORTH], &record.gpsPos[NAV_INS_EAST],
+                &velocity, &record.gpsVel[NAV_INS_NORTH], &record.gpsVel[NAV_INS_EAST], &latency) != 10) {
+            continue;   // header or comment
+        }
+        record.gps = gps;
+        record.gpsVelocity = velocity;
+        record.gpsLatencyMs = latency;
+        log.push_back(record);
+    }
+    fclose(logFile);
+
+    const char *outputName = getenv("NAV_INS_REPLAY_OUTPUT");
+    FILE *output = outputName ? fopen(outputName, "w") : stdout;
+    ASSERT_TRUE(output != NULL);
+    replay(log, output);
+    if (output != stdout) {
+        fclose(output);
+    }
+
+    EXPECT_GT(log.size(), 0u);
+}
@@ -57,13 +57,13 @@ extern "C" {
     int16_t pidMultiWiiRewriteCore(int axis, const pidProfile_t *pidProfile, int32_t gyroRate, int32_t AngleRate);
     void pidResetITerm(void);
     extern pidControllerFuncPtr pid_controller;
-    extern uint8_t PIDweight[3];
     extern bool motorLimitReached;
     extern uint32_t rcModeActivationMask;
     float unittest_pidLuxFloatCore_lastRateForDelta[3];
     float unittest_pidLuxFloatCore_PTerm[3];
     float unittest_pidLuxFloatCore_ITerm[3];
     float unittest_pidLuxFloatCore_DTerm[3];
+    float unittest_pidLuxFloatCore_FTerm[3];
     int32_t unittest_pidMultiWiiRewriteCore_lastRateForDelta[3];
     int32_t unittest_pidMultiWiiRewriteCore_PTerm[3];
     int32_t unittest_pidMultiWiiRewriteCore_ITerm[3];
@@ -119,6 +119,7 @@ void resetPidProfile(pidProfile_t *pidProfile)
     pidProfile->yaw_p_limit = YAW_P_LIMIT_MAX;
     pidProfile->dterm_lpf_hz = 0;
     pidProfile->yaw_lpf_hz = 0;
+    pidProfile->yaw_ff_lead_ms = 0;
 }
 
 void resetRcCommands(void)
@@ -155,9 +156,9 @@ void pidControllerInitLuxFloatCore(void)
     gyro.scale = 1.0 / 16.4; // value for 6050 family of gyros
     resetGyroADC();
     // set up the PIDWeights to 100%, so they are neutral in the tests
-    PIDweight[FD_ROLL] = 100;
-    PIDweight[FD_PITCH] = 100;
-    PIDweight[FD_YAW] = 100;
+    pidSetWeights(FD_ROLL, 100, 100);
+    pidSetWeights(FD_PITCH, 100, 100);
+    pidSetWeights(FD_YAW, 100, 100);
     // reset the pidLuxFloat static values
     for (int axis = FD_ROLL; axis <= FD_YAW; ++axis) {
         unittest_pidLuxFloatCore_lastRateForDelta[axis] = 0.0f;
@@ -259,14 +260,15 @@ TEST(PIDUnittest, TestPidLuxFloat)
     EXPECT_EQ(0, unittest_pidLuxFloatCore_ITerm[FD_YAW]);
     EXPECT_EQ(0, unittest_pidLuxFloatCore_DTerm[FD_YAW]);
 
-    // set up a rateError of 100 on the roll axis
-    const float rateErrorRoll = 100;
+    // set up a rateError of 50 on the roll axis, gyro rates above LUXFLOAT_INTEGRATOR_DISABLE_LIMIT_DPS
+    // only let the integrator shrink
+    const float rateErrorRoll = 50;
 
-    // set up a rateError of 100 on the pitch axis
-    const float rateErrorPitch = 100;
+    // set up a rateError of 50 on the pitch axis
+    const float rateErrorPitch = 50;
 
-    // set up a rateError of 100 on the yaw axis
-    const float rateErrorYaw = 100;
+    // set up a rateError of 50 on the yaw axis
+    const float rateErrorYaw = 50;
 
     // run the PID controller. Check expected PID values
     pidControllerInitLuxFloat(&controlRate, max_angle_inclination, &rollAndPitchTrims, &rxConfig);
@@ -555,9 +557,9 @@ void pidControllerInitMultiWiiRewriteCore(void)
     pidResetITerm();
     resetGyroADC();
     // set up the PIDWeights to 100%, so they are neutral in the tests
-    PIDweight[FD_ROLL] = 100;
-    PIDweight[FD_PITCH] = 100;
-    PIDweight[FD_YAW] = 100;
+    pidSetWeights(FD_ROLL, 100, 100);
+    pidSetWeights(FD_PITCH, 100, 100);
+    pidSetWeights(FD_YAW, 100, 100);
     // reset the pidMultiWiiRewrite static values
     for (int axis = FD_ROLL; axis <= FD_YAW; ++axis) {
         unittest_pidMultiWiiRewriteCore_lastRateForDelta[axis] = 0;
@@ -636,6 +638,110 @@ int32_t calcMwrDTerm(pidProfile_t *pidProfile, pidIndex_e axis, int rateError) {
     return ret;
 }
 
+TEST(PIDUnittest, TestPidLuxFloatYawFeedForward)
+{
+    pidProfile_t *pidProfile = &testPidProfile;
+    pidControllerInitLuxFloatCore();
+    pidSetTailLag(0.0f);
+
+    // feed-forward disabled by default
+    pidLuxFloatCore(FD_YAW, pidProfile, 0, 100);
+    EXPECT_EQ(0, unittest_pidLuxFloatCore_FTerm[FD_YAW]);
+    EXPECT_EQ(0, unittest_pidLuxFloatCore_FTerm[FD_ROLL]);
+
+    // setpoint ramping at a constant rate, feed-forward settles at P * rate of change * lead time
+    pidProfile->yaw_ff_lead_ms = 20;
+    const float setpointStep = 1.0f;
+    const float expectedFTerm = luxPTermScale * (setpointStep / expectedDeltaTime) * 0.020f * pidProfile->P8[FD_YAW];
+    float angleRate = 100;
+    for (int i = 0; i < 500; i++) {
+        angleRate += setpointStep;
+        pidLuxFloatCore(FD_YAW, pidProfile, 0, angleRate);
+    }
+    EXPECT_NEAR(expectedFTerm, unittest_pidLuxFloatCore_FTerm[FD_YAW], 0.01f);
+
+    // a lagging tail extends the lead time
+    pidSetTailLag(0.020f);
+    for (int i = 0; i < 500; i++) {
+        angleRate += setpointStep;
+        pidLuxFloatCore(FD_YAW, pidProfile, 0, angleRate);
+    }
+    EXPECT_NEAR(2 * expectedFTerm, unittest_pidLuxFloatCore_FTerm[FD_YAW], 0.01f);
+
+    // steady setpoint, no feed-forward
+    for (int i = 0; i < 500; i++) {
+        pidLuxFloatCore(FD_YAW, pidProfile, 0, angleRate);
+    }
+    EXPECT_NEAR(0, unittest_pidLuxFloatCore_FTerm[FD_YAW], 0.01f);
+
+    // constrained like the D term
+    for (int i = 0; i < 500; i++) {
+        angleRate += 100 * setpointStep;
+        pidLuxFloatCore(FD_YAW, pidProfile, 0, angleRate);
+    }
+    EXPECT_FLOAT_EQ(PID_MAX_D, unittest_pidLuxFloatCore_FTerm[FD_YAW]);
+
+    pidSetTailLag(0.0f);
+    pidProfile->yaw_ff_lead_ms = 0;
+}
+
+TEST(PIDUnittest, TestPidLuxFloatCoefficientCache)
+{
+    pidProfile_t *pidProfile = &testPidProfile;
+    pidControllerInitLuxFloatCore();
+    const float rateError = 100;
+
+    pidLuxFloatCore(FD_ROLL, pidProfile, 0, rateError);
+    EXPECT_FLOAT_EQ(calcLuxPTerm(pidProfile, FD_ROLL, rateError), unittest_pidLuxFloatCore_PTerm[FD_ROLL]);
+
+    // profile edits only take effect once the coefficients are invalidated
+    pidProfile->P8[FD_ROLL] = 80;
+    pidLuxFloatCore(FD_ROLL, pidProfile, 0, rateError);
+    EXPECT_FLOAT_EQ(luxPTermScale * rateError * 40, unittest_pidLuxFloatCore_PTerm[FD_ROLL]);
+    pidInvalidateCoefficients();
+    pidLuxFloatCore(FD_ROLL, pidProfile, 0, rateError);
+    EXPECT_FLOAT_EQ(luxPTermScale * rateError * 80, unittest_pidLuxFloatCore_PTerm[FD_ROLL]);
+
+    // TPA weight changes invalidate the coefficients themselves
+    pidSetWeights(FD_ROLL, 50, 100);
+    pidLuxFloatCore(FD_ROLL, pidProfile, 0, rateError);
+    EXPECT_FLOAT_EQ(luxPTermScale * rateError * 40, unittest_pidLuxFloatCore_PTerm[FD_ROLL]);
+
+    pidSetWeights(FD_ROLL, 100, 100);
+    resetPidProfile(pidProfile);
+}
+
+TEST(PIDUnittest, TestPidLuxFloatSaturationBackCalculation)
+{
+    pidProfile_t *pidProfile = &testPidProfile;
+    pidControllerInitLuxFloatCore();
+    const float rateError = 100;
+    const float ITermDelta = calcLuxITermDelta(pidProfile, FD_ROLL, rateError);
+
+    pidLuxFloatCore(FD_ROLL, pidProfile, 0, rateError);
+    EXPECT_FLOAT_EQ(ITermDelta, unittest_pidLuxFloatCore_ITerm[FD_ROLL]);
+
+    // clipping in the direction of the integrator bleeds it off
+    pidSetActuatorSaturation(FD_ROLL, 10);
+    EXPECT_EQ(1 << FD_ROLL, pidSaturationFlags);
+    pidLuxFloatCore(FD_ROLL, pidProfile, 0, rateError);
+    const float bleed = PID_SATURATION_BACKCALC_GAIN * expectedDeltaTime * 10;
+    EXPECT_NEAR(2 * ITermDelta - bleed, unittest_pidLuxFloatCore_ITerm[FD_ROLL], 1e-5f);
+
+    // a large clip empties the integrator but never drives it through zero
+    pidSetActuatorSaturation(FD_ROLL, 10000);
+    pidLuxFloatCore(FD_ROLL, pidProfile, 0, rateError);
+    EXPECT_EQ(0, unittest_pidLuxFloatCore_ITerm[FD_ROLL]);
+
+    // clipping against the integrator leaves it alone
+    pidSetActuatorSaturation(FD_ROLL, -10);
+    pidLuxFloatCore(FD_ROLL, pidProfile, 0, rateError);
+    EXPECT_FLOAT_EQ(ITermDelta, unittest_pidLuxFloatCore_ITerm[FD_ROLL]);
+
+    pidSetActuatorSaturation(FD_ROLL, 0);
+    EXPECT_EQ(0, pidSaturationFlags);
+}
+
 TEST(PIDUnittest, TestPidMultiWiiRewrite)
 {
     pidProfile_t *pidProfile = &testPidProfile;
@@ -0,0 +1,343 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+extern "C" {
+#include <platform.h>
+
+#include "config/parameter_group.h"
+
+#include "io/gps.h"
+#include "io/gps_parser.h"
+
+#include "flight/gps_conversion.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+// NMEA receiver output: GGA and RMC of two epochs, a GGA without fix and a GPGSV cycle
+static const char nmeaStream[] =
+    "$GPGGA,092750.000,5321.6802,N,00630.3372,W,1,08,1.03,61.7,M,55.2,M,,*46\r\n"
+    "$GPRMC,092750.000,A,5321.6802,N,00630.3372,W,22.4,54.7,191194,020.3,E*7C\r\n"
+    "$GNGGA,092751.000,4710.5186,N,01151.4252,E,2,12,0.87,1234.5,M,47.0,M,,*4A\r\n"
+    "$GNRMC,092751.000,A,4710.5186,N,01151.4252,E,0.5,273.1,191194,,*1F\r\n"
+    "$GPGGA,092752.000,,,,,0,00,99.99,,M,,M,,*5D\r\n"
+    "$GPGSV,3,1,11,03,03,111,00,04,15,270,00,06,01,010,00,13,06,292,00*74\r\n"
+    "$GPGSV,3,2,11,14,25,170,00,16,57,208,39,18,67,296,40,19,40,246,00*74\r\n"
+    "$GPGSV,3,3,11,22,42,067,42,24,14,311,43,27,05,244,00,,,,*4D\r\n";
+
+static gpsParser_t parser;
+
+static int feed(const uint8_t *data, int length, int *packets)
+{
+    int solutions = 0;
+
+    for (int i = 0; i < length; i++) {
+        const gpsParseResult_e result = gpsParserProcessByte(&parser, data[i]);
+        if (result != GPS_PARSE_IN_PROGRESS && packets) {
+            (*packets)++;
+        }
+        if (result == GPS_PARSE_SOLUTION) {
+            solutions++;
+        }
+    }
+    return solutions;
+}
+
+static int feedString(const char *sentences, int *packets)
+{
+    return feed((const uint8_t *)sentences, strlen(sentences), packets);
+}
+
+static void putU32(uint8_t *payload, int offset, uint32_t value)
+{
+    payload[offset] = value;
+    payload[offset + 1] = value >> 8;
+    payload[offset + 2] = value >> 16;
+    payload[offset + 3] = value >> 24;
+}
+
+// Returns the size of the UBX frame written to frame
+static int ubxFrame(uint8_t *frame, uint8_t msgClass, uint8_t msgId, const uint8_t *payload, uint16_t length)
+{
+    frame[0] = 0xB5;
+    frame[1] = 0x62;
+    frame[2] = msgClass;
+    frame[3] = msgId;
+    frame[4] = length & 0xFF;
+    frame[5] = length >> 8;
+    memcpy(&frame[6], payload, length);
+
+    uint8_t ckA = 0, ckB = 0;
+    for (int i = 2; i < 6 + length; i++) {
+        ckA += frame[i];
+        ckB += ckA;
+    }
+    frame[6 + length] = ckA;
+    frame[7 + length] = ckB;
+    return length + 8;
+}
+
+static int ubxNavPvt(uint8_t *frame, uint32_t iTow, int32_t lat, int32_t lon, int32_t hMslMm, int32_t velNMms, int32_t velEMms, int32_t velDMms)
+{
+    uint8_t payload[92];
+    memset(payload, 0, sizeof(payload));
+
+    putU32(payload, 0, iTow);
+    payload[20] = 3;                // 3D fix
+    payload[21] = 0x01;             // gnssFixOK
+    payload[23] = 14;               // numSV
+    putU32(payload, 24, lon);
+    putU32(payload, 28, lat);
+    putU32(payload, 32, hMslMm + 47000);
+    putU32(payload, 36, hMslMm);
+    putU32(payload, 48, velNMms);
+    putU32(payload, 52, velEMms);
+    putU32(payload, 56, velDMms);
+    putU32(payload, 60, 5000);      // gSpeed
+    putU32(payload, 64, 4500000);   // headMot, 45 degrees
+    putU32(payload, 68, 350);       // sAcc
+    payload[76] = 0x87;             // pDOP 1.35
+    payload[77] = 0x00;
+
+    return ubxFrame(frame, 0x01, 0x07, payload, sizeof(payload));
+}
+
+TEST(GpsParserTest, TestNmeaSolution)
+{
+    gpsParserInit(&parser, GPS_NMEA);
+
+    int packets = 0;
+    EXPECT_EQ(3, feedString(nmeaStream, &packets));
+    EXPECT_EQ(8, packets);
+    EXPECT_EQ(8, (int)parser.stats.packetCount);
+
+    // the GGA without fix keeps the last position and clears the fix
+    EXPECT_FALSE(parser.solution.fix);
+    EXPECT_EQ((int32_t)GPS_coord_to_degrees("4710.5186"), parser.solution.coord[LAT]);
+    EXPECT_EQ((int32_t)GPS_coord_to_degrees("01151.4252"), parser.solution.coord[LON]);
+    EXPECT_EQ(12, parser.solution.numSat);
+    EXPECT_EQ(87, parser.solution.hdop);
+    EXPECT_EQ(1234, parser.solution.altitude);
+    EXPECT_EQ((5 * 5144) / 1000, parser.solution.speed);
+    EXPECT_EQ(2731, parser.solution.groundCourse);
+
+    EXPECT_EQ(11, parser.svInfo.numCh);
+    EXPECT_EQ(16, parser.svInfo.svid[5]);
+    EXPECT_EQ(39, parser.svInfo.cno[5]);
+    EXPECT_EQ(27, parser.svInfo.svid[10]);
+    EXPECT_EQ(43, parser.svInfo.cno[9]);
+    EXPECT_EQ(11, parser.svInfo.chn[10]);
+}
+
+TEST(GpsParserTest, TestNmeaSouthWest)
+{
+    gpsParserInit(&parser, GPS_NMEA);
+
+    EXPECT_EQ(1, feedString("$GPGGA,092750.000,5321.6802,N,00630.3372,W,1,08,1.03,61.7,M,55.2,M,,*46\r\n", NULL));
+    EXPECT_TRUE(parser.solution.fix);
+    EXPECT_EQ((int32_t)GPS_coord_to_degrees("5321.6802"), parser.solution.coord[LAT]);
+    EXPECT_EQ(-(int32_t)GPS_coord_to_degrees("00630.3372"), parser.solution.coord[LON]);
+    EXPECT_EQ(8, parser.solution.numSat);
+    EXPECT_EQ(103, parser.solution.hdop);
+    EXPECT_EQ(61, parser.solution.altitude);
+
+    feedString("$GPRMC,092750.000,A,5321.6802,N,00630.3372,W,22.4,54.7,191194,020.3,E*7C\r\n", NULL);
+    EXPECT_EQ((224 * 5144) / 1000, parser.solution.speed);
+    EXPECT_EQ(547, parser.solution.groundCourse);
+}
+
+TEST(GpsParserTest, TestNmeaBadChecksumIsNotPublished)
+{
+    gpsParserInit(&parser, GPS_NMEA);
+
+    feedString("$GPGGA,092750.000,5321.6802,N,00630.3372,W,1,08,1.03,61.7,M,55.2,M,,*46\r\n", NULL);
+    const gpsSolution_t before = parser.solution;
+
+    // one digit of the latitude corrupted
+    EXPECT_EQ(0, feedString("$GPGGA,092750.000,5321.6803,N,00630.3372,W,1,08,1.03,61.7,M,55.2,M,,*46\r\n", NULL));
+    EXPECT_EQ(GPS_LOG_ERROR, parser.packetLogChar);
+    EXPECT_EQ(0, memcmp(&before, &parser.solution, sizeof(before)));
+    EXPECT_EQ(1, (int)parser.stats.packetCount);
+
+    // a sentence cut short by a new one is dropped, the next one is used
+    EXPECT_EQ(1, feedString("$GPGGA,0927$GNGGA,092751.000,4710.5186,N,01151.4252,E,2,12,0.87,1234.5,M,47.0,M,,*4A\r\n", NULL));
+    EXPECT_EQ((int32_t)GPS_coord_to_degrees("4710.5186"), parser.solution.coord[LAT]);
+}
+
+TEST(GpsParserTest, TestUbloxNavPvt)
+{
+    gpsParserInit(&parser, GPS_UBLOX);
+
+    uint8_t frame[100];
+    const int size = ubxNavPvt(frame, 123456, 515638860, -1599600, 123456, 1500, -2500, 300);
+
+    EXPECT_EQ(1, feed(frame, size, NULL));
+    EXPECT_EQ(GPS_LOG_UBLOX_PVT, parser.packetLogChar);
+
+    EXPECT_TRUE(parser.solution.fix);
+    EXPECT_EQ(123456u, parser.solution.timeOfWeekMs);
+    EXPECT_EQ(515638860, parser.solution.coord[LAT]);
+    EXPECT_EQ(-1599600, parser.solution.coord[LON]);
+    EXPECT_EQ(123, parser.solution.altitude);
+    EXPECT_EQ(14, parser.solution.numSat);
+    EXPECT_EQ(135, parser.solution.hdop);
+    EXPECT_EQ(500, parser.solution.speed);
+    EXPECT_EQ(450, parser.solution.groundCourse);
+    EXPECT_TRUE(parser.solution.velocityValid);
+    EXPECT_EQ(150, parser.solution.velNED[0]);
+    EXPECT_EQ(-250, parser.solution.velNED[1]);
+    EXPECT_EQ(30, parser.solution.velNED[2]);
+    EXPECT_EQ(35u, parser.solution.speedAccuracy);
+}
+
+TEST(GpsParserTest, TestUbloxLegacySolutionNeedsPositionAndSpeed)
+{
+    gpsParserInit(&parser, GPS_UBLOX);
+
+    uint8_t payload[52];
+    uint8_t frame[64];
+    int size;
+
+    // NAV-SOL, 3D fix, 9 satellites
+    memset(payload, 0, sizeof(payload));
+    payload[10] = 3;
+    payload[11] = 0x01;
+    payload[44] = 180;
+    payload[47] = 9;
+    size = ubxFrame(frame, 0x01, 0x06, payload, 52);
+    EXPECT_EQ(0, feed(frame, size, NULL));
+    EXPECT_EQ(9, parser.solution.numSat);
+    EXPECT_EQ(180, parser.solution.hdop);
+
+    // NAV-POSLLH
+    memset(payload, 0, sizeof(payload));
+    putU32(payload, 4, 115142520);
+    putU32(payload, 8, 471051860);
+    putU32(payload, 16, 612000);
+    size = ubxFrame(frame, 0x01, 0x02, payload, 28);
+    EXPECT_EQ(0, feed(frame, size, NULL));
+    EXPECT_TRUE(parser.solution.fix);
+    EXPECT_EQ(471051860, parser.solution.coord[LAT]);
+    EXPECT_EQ(612, parser.solution.altitude);
+
+    // NAV-VELNED completes the solution
+    memset(payload, 0, sizeof(payload));
+    putU32(payload, 4, (uint32_t)-120);
+    putU32(payload, 20, 340);
+    putU32(payload, 24, 27310000);
+    size = ubxFrame(frame, 0x01, 0x12, payload, 36);
+    EXPECT_EQ(1, feed(frame, size, NULL));
+    EXPECT_EQ(340, parser.solution.speed);
+    EXPECT_EQ(2731, parser.solution.groundCourse);
+    EXPECT_EQ(-120, parser.solution.velNED[0]);
+}
+
+TEST(GpsParserTest, TestUbloxBadChecksumAndGarbage)
+{
+    gpsParserInit(&parser, GPS_UBLOX);
+
+    uint8_t frame[100];
+    int size = ubxNavPvt(frame, 1000, 100, 200, 10000, 0, 0, 0);
+
+    frame[40] ^= 0x10;
+    EXPECT_EQ(0, feed(frame, size, NULL));
+    EXPECT_EQ(GPS_LOG_ERROR, parser.packetLogChar);
+    EXPECT_EQ(1, (int)parser.stats.errors);
+    EXPECT_FALSE(parser.solution.fix);
+    EXPECT_EQ(0, parser.solution.coord[LAT]);
+
+    // garbage and a frame of a message that is not used before a good one
+    const uint8_t garbage[] = { 0x00, 0xB5, 0x13, 0x55 };
+    EXPECT_EQ(0, feed(garbage, sizeof(garbage), NULL));
+    EXPECT_EQ(2, (int)parser.stats.garbageByteCount);
+
+    const uint8_t clock[20] = { 0 };
+    size = ubxFrame(frame, 0x01, 0x22, clock, sizeof(clock));
+    EXPECT_EQ(0, feed(frame, size, NULL));
+    EXPECT_EQ(GPS_LOG_IGNORED, parser.packetLogChar);
+
+    size = ubxNavPvt(frame, 1000, 100, 200, 10000, 0, 0, 0);
+    EXPECT_EQ(1, feed(frame, size, NULL));
+    EXPECT_EQ(100, parser.solution.coord[LAT]);
+    EXPECT_EQ(2, (int)parser.stats.packetCount);
+}
+
+TEST(GpsParserTest, TestUbloxSvInfo)
+{
+    gpsParserInit(&parser, GPS_UBLOX);
+
+    uint8_t payload[8 + 12 * 3];
+    uint8_t frame[sizeof(payload) + 8];
+
+    memset(payload, 0, sizeof(payload));
+    payload[4] = 3;
+    for (int i = 0; i < 3; i++) {
+        payload[8 + 12 * i + 0] = i;            // chn
+        payload[8 + 12 * i + 1] = 10 + i;       // svid
+        payload[8 + 12 * i + 3] = 7;            // quality
+        payload[8 + 12 * i + 4] = 40 + i;       // cno
+    }
+
+    const int size = ubxFrame(frame, 0x01, 0x30, payload, sizeof(payload));
+    EXPECT_EQ(0, feed(frame, size, NULL));
+
+    EXPECT_TRUE(parser.svInfoUpdated);
+    EXPECT_EQ(3, parser.svInfo.numCh);
+    EXPECT_EQ(12, parser.svInfo.svid[2]);
+    EXPECT_EQ(7, parser.svInfo.quality[1]);
+    EXPECT_EQ(40, parser.svInfo.cno[0]);
+}
+
+#define STREAM_EPOCHS 200
+
+static uint8_t stream[STREAM_EPOCHS * 100];
+
+// long streams keep decoding every epoch, the timing of these runs is in the parser benchmark of make bench
+TEST(GpsParserTest, TestNmeaStream)
+{
+    const int epochSize = strlen(nmeaStream);
+    const int epochs = sizeof(stream) / epochSize;
+
+    for (int i = 0; i < epochs; i++) {
+        memcpy(&stream[i * epochSize], nmeaStream, epochSize);
+    }
+
+    gpsParserInit(&parser, GPS_NMEA);
+
+    EXPECT_EQ(epochs * 3, feed(stream, epochs * epochSize, NULL));
+    EXPECT_EQ(0, (int)parser.stats.errors);
+    EXPECT_EQ((int32_t)GPS_coord_to_degrees("4710.5186"), parser.solution.coord[LAT]);
+}
+
+TEST(GpsParserTest, TestUbloxNavPvtStream)
+{
+    int size = 0;
+    for (int i = 0; i < STREAM_EPOCHS; i++) {
+        size += ubxNavPvt(&stream[size], i * 100, 515638860 + i, -1599600 - i, 100000, i, -i, 0);
+    }
+
+    gpsParserInit(&parser, GPS_UBLOX);
+
+    EXPECT_EQ(STREAM_EPOCHS, feed(stream, size, NULL));
+    EXPECT_EQ(0, (int)parser.stats.errors);
+    EXPECT_EQ(515638860 + STREAM_EPOCHS - 1, parser.solution.coord[LAT]);
+    EXPECT_EQ((STREAM_EPOCHS - 1) / 10, parser.solution.velNED[0]);
+}
@@ -227,5 +227,14 @@ void pidSetExpectedGyroError(flight_dynamics_index_t axis, int16_t error) {
     UNUSED(error);
 }
 
+void pidSetTailLag(float lagTime) {
+    UNUSED(lagTime);
+}
+
+void pidSetActuatorSaturation(flight_dynamics_index_t axis, int16_t clipped) {
+    UNUSED(axis);
+    UNUSED(clipped);
+}
+
 }
 
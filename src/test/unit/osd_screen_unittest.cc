@@ -490,6 +490,92 @@ TEST_F(OsdScreenTest, TestOsdElement_RSSIFC)
 }
 
 
+TEST_F(OsdScreenTest, TestCachedElement_RenderedAgainWhenDataChanges)
+{
+    // given
+    osdElementCache_t cache;
+    memset(&cache, 0, sizeof(cache));
+    amperageMeter.mAhDrawn = 1234;
+
+    element_t element = {
+        0, 0, EF_ENABLED, OSD_ELEMENT_MAH_DRAWN
+    };
+
+    osdDrawCachedTextElement(&element, &cache, 0);
+
+    // when, the screen is cleared and the data is unchanged
+    memset(textScreenBuffer, TEST_INITIAL_CHARACTER, sizeof(textScreenBuffer));
+    osdDrawCachedTextElement(&element, &cache, 1000);
+
+    // then
+    char expectedAscii[] = " 1234";
+    compareScreen(0, 0, asciiToFontMap(expectedAscii), strlen(expectedAscii));
+    compareScreenCharacterAtPosition(5, 0, TEST_FONT_CHARACTER_MAH);
+
+    // when
+    amperageMeter.mAhDrawn = 1235;
+    osdDrawCachedTextElement(&element, &cache, 2000);
+
+    // then
+    char expectedChangedAscii[] = " 1235";
+    compareScreen(0, 0, asciiToFontMap(expectedChangedAscii), strlen(expectedChangedAscii));
+}
+
+TEST_F(OsdScreenTest, TestCachedElement_SlowRefreshWaitsForInterval)
+{
+    // given
+    osdElementCache_t cache;
+    memset(&cache, 0, sizeof(cache));
+    amperageMeter.mAhDrawn = 1234;
+
+    element_t element = {
+        0, 0, EF_ENABLED | EF_REFRESH_SLOW, OSD_ELEMENT_MAH_DRAWN
+    };
+
+    osdDrawCachedTextElement(&element, &cache, 0);
+
+    // when
+    amperageMeter.mAhDrawn = 1235;
+    osdDrawCachedTextElement(&element, &cache, OSD_ELEMENT_SLOW_REFRESH_INTERVAL_US - 1);
+
+    // then
+    char expectedAscii[] = " 1234";
+    compareScreen(0, 0, asciiToFontMap(expectedAscii), strlen(expectedAscii));
+
+    // when
+    osdDrawCachedTextElement(&element, &cache, OSD_ELEMENT_SLOW_REFRESH_INTERVAL_US);
+
+    // then
+    char expectedChangedAscii[] = " 1235";
+    compareScreen(0, 0, asciiToFontMap(expectedChangedAscii), strlen(expectedChangedAscii));
+}
+
+TEST_F(OsdScreenTest, TestCachedElement_RenderedAgainWhenMoved)
+{
+    // given
+    osdElementCache_t cache;
+    memset(&cache, 0, sizeof(cache));
+    testMillis = 65 * 1000;
+
+    element_t element = {
+        0, 0, EF_ENABLED | EF_REFRESH_SLOW, OSD_ELEMENT_ON_DURATION
+    };
+
+    osdDrawCachedTextElement(&element, &cache, 0);
+
+    // when
+    memset(textScreenBuffer, TEST_INITIAL_CHARACTER, sizeof(textScreenBuffer));
+    element.x = 10;
+    element.y = -1;
+    osdDrawCachedTextElement(&element, &cache, 1);
+
+    // then
+    char expectedAscii[] = "  1:05";
+    compareScreen(10, TEST_ROW_COUNT - 1, asciiToFontMap(expectedAscii), strlen(expectedAscii));
+    compareScreenCharacterAtPosition(0, 0, TEST_INITIAL_CHARACTER);
+}
+
+
 
 // STUBS
 extern "C" {
@@ -61,6 +61,11 @@ typedef struct
     void* test;
 } TIM_TypeDef;
 
+typedef struct
+{
+    void* test;
+} SPI_TypeDef;
+
 typedef enum {RESET = 0, SET = !RESET} FlagStatus, ITStatus;
 
 typedef enum {
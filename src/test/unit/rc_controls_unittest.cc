@@ -756,6 +756,7 @@ TEST_F(RcControlsAdjustmentsTest, processPIDIncreasePidController2) // uses floa
 
 extern "C" {
 void saveConfigAndNotify(void) {}
+void pidInvalidateCoefficients(void) {}
 void generateThrottleCurve(controlRateConfig_t *, motorConfig_t *) {}
 void changeProfile(uint8_t) {}
 void accSetCalibrationCycles(uint16_t) {}
@@ -364,6 +364,40 @@ TEST(SchedulerUnittest, TestTwoTasks)
     EXPECT_EQ(&cfTasks[TASK_SERIAL], unittest_scheduler_selectedTask);
 }
 
+TEST(SchedulerUnittest, TestTaskTimingWindow)
+{
+    // disable all tasks except TASK_ACCEL
+    for (unsigned int taskId=0; taskId < taskCount; ++taskId) {
+        setTaskEnabled(static_cast<cfTaskId_e>(taskId), false);
+    }
+    setTaskEnabled(TASK_ACCEL, true);
+    cfTaskTimingWindow_t window;
+    getTaskTimingWindow(TASK_ACCEL, &window); // discard statistics from earlier tests
+
+    // TASK_ACCEL is due at 2000, but the scheduler only gets to it 150 microseconds later
+    cfTasks[TASK_ACCEL].lastExecutedAt = 1000;
+    simulatedTime = 2150;
+    scheduler();
+    EXPECT_EQ(&cfTasks[TASK_ACCEL], unittest_scheduler_selectedTask);
+
+    // and then runs on time
+    simulatedTime = 3150;
+    scheduler();
+    EXPECT_EQ(&cfTasks[TASK_ACCEL], unittest_scheduler_selectedTask);
+
+    getTaskTimingWindow(TASK_ACCEL, &window);
+    EXPECT_EQ(2, window.executionCount);
+    EXPECT_EQ(2 * updateAccelerometerTime, window.totalExecutionTime);
+    EXPECT_EQ(updateAccelerometerTime, window.maxExecutionTime);
+    EXPECT_EQ(150, window.maxLatency);
+
+    // reading the statistics starts a new window
+    getTaskTimingWindow(TASK_ACCEL, &window);
+    EXPECT_EQ(0, window.executionCount);
+    EXPECT_EQ(0, window.totalExecutionTime);
+    EXPECT_EQ(0, window.maxLatency);
+}
+
 // FIXME these tests are out of date
 // a) Realtime guard is currently disabled.
 // b) TASK_GYRO now uses a 'checkFunc', it's behavior needs to be controlled.
@@ -48,9 +48,6 @@ TEST(SonarUnittest, TestSonarInit)
     // Check against gross errors in max range values
     EXPECT_GE(sonarMaxAltWithTiltCm, 100);
     EXPECT_LE(sonarMaxAltWithTiltCm, sonarMaxRangeCm);
-    EXPECT_GE(sonarCfAltCm, 100);
-    EXPECT_LE(sonarCfAltCm, sonarMaxRangeCm);
-    EXPECT_LE(sonarCfAltCm, sonarMaxAltWithTiltCm);
     // Check reasonable values for maximum tilt
     EXPECT_GE(sonarMaxTiltDeciDegrees, 0);
     EXPECT_LE(sonarMaxTiltDeciDegrees, 450);
@@ -0,0 +1,185 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+extern "C" {
+    #include <platform.h>
+
+    #include "common/axis.h"
+    #include "common/maths.h"
+
+    #include "config/parameter_group.h"
+    #include "config/parameter_group_ids.h"
+
+    #include "drivers/sensor.h"
+    #include "drivers/accgyro.h"
+    #include "drivers/serial.h"
+
+    #include "io/serial.h"
+    #include "io/gps.h"
+
+    #include "sensors/sensors.h"
+    #include "sensors/acceleration.h"
+    #include "sensors/amperage.h"
+    #include "sensors/battery.h"
+
+    #include "flight/imu.h"
+
+    #include "telemetry/telemetry.h"
+    #include "telemetry/telemetry_data.h"
+
+    PG_REGISTER(batteryConfig_t, batteryConfig, PG_BATTERY_CONFIG, 0);
+
+    amperageMeter_t amperageMeter;
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+TEST(TelemetryDataTest, SnapshotOnlyChangesOnUpdate)
+{
+    // given
+    vbat = 126;
+    batteryCellCount = 3;
+    amperageMeter.amperage = 1500;
+    GPS_numSat = 9;
+
+    // when
+    telemetryDataUpdate();
+
+    // then
+    EXPECT_EQ(126, telemetryData.vbat);
+    EXPECT_EQ(3, telemetryData.cellCount);
+    EXPECT_EQ(420, telemetryData.cellVoltage);
+    EXPECT_EQ(1500, telemetryData.amperage);
+    EXPECT_EQ(9, telemetryData.gpsNumSat);
+
+    // when the sensors change between two telemetry task runs
+    vbat = 111;
+    amperageMeter.amperage = 200;
+    GPS_numSat = 4;
+
+    // then every protocol still sees the values of the first run
+    EXPECT_EQ(126, telemetryData.vbat);
+    EXPECT_EQ(420, telemetryData.cellVoltage);
+    EXPECT_EQ(1500, telemetryData.amperage);
+    EXPECT_EQ(9, telemetryData.gpsNumSat);
+
+    // and the next run takes a new snapshot
+    telemetryDataUpdate();
+    EXPECT_EQ(111, telemetryData.vbat);
+    EXPECT_EQ(370, telemetryData.cellVoltage);
+    EXPECT_EQ(200, telemetryData.amperage);
+    EXPECT_EQ(4, telemetryData.gpsNumSat);
+}
+
+TEST(TelemetryDataTest, CellVoltageWithoutCellCount)
+{
+    // given the cell count is not known before a battery is detected
+    vbat = 126;
+    batteryCellCount = 0;
+
+    // when
+    telemetryDataUpdate();
+
+    // then
+    EXPECT_EQ(126, telemetryData.vbat);
+    EXPECT_EQ(0, telemetryData.cellCount);
+    EXPECT_EQ(0, telemetryData.cellVoltage);
+    EXPECT_EQ(0, telemetryData.cellVoltageFlvss);
+}
+
+TEST(TelemetryDataTest, CellVoltageFlvssRounds)
+{
+    // given
+    vbat = 125;
+    batteryCellCount = 3;
+
+    // when
+    telemetryDataUpdate();
+
+    // then 4.1667V in 0.002V steps
+    EXPECT_EQ(2083, telemetryData.cellVoltageFlvss);
+}
+
+TEST(TelemetryDataTest, CoordinateConversionIsMemoizedPerSnapshot)
+{
+    // given 51.5074 N, 0.1278 W
+    GPS_coord[LAT] = 515074000;
+    GPS_coord[LON] = -1278000;
+    telemetryDataUpdate();
+
+    // when
+    const gpsCoordinateDDDMMmmmm_t *first = telemetryDataGetCoordinateDDDMMmmmm(FRSKY_FORMAT_DMS);
+
+    // then
+    EXPECT_EQ(5130, first[LAT].dddmm);
+    EXPECT_EQ(4440, first[LAT].mmmm);
+    EXPECT_EQ(7, first[LON].dddmm);
+    EXPECT_EQ(6680, first[LON].mmmm);
+
+    // when the position changes without a new snapshot
+    GPS_coord[LAT] = 0;
+    const gpsCoordinateDDDMMmmmm_t *second = telemetryDataGetCoordinateDDDMMmmmm(FRSKY_FORMAT_DMS);
+
+    // then the converted values are reused
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(5130, second[LAT].dddmm);
+
+    // and the other format is converted separately
+    const gpsCoordinateDDDMMmmmm_t *nmea = telemetryDataGetCoordinateDDDMMmmmm(FRSKY_FORMAT_NMEA);
+    EXPECT_EQ(51 * 60 + 30, nmea[LAT].dddmm);
+
+    // when the next snapshot is taken
+    telemetryDataUpdate();
+
+    // then the conversion is redone
+    const gpsCoordinateDDDMMmmmm_t *third = telemetryDataGetCoordinateDDDMMmmmm(FRSKY_FORMAT_DMS);
+    EXPECT_EQ(0, third[LAT].dddmm);
+    EXPECT_EQ(0, third[LAT].mmmm);
+}
+
+// STUBS
+
+extern "C" {
+
+uint16_t vbat;
+uint8_t batteryCellCount;
+
+attitudeEulerAngles_t attitude;
+int32_t BaroAlt;
+int32_t vario;
+uint16_t rssi;
+
+int32_t GPS_coord[2];
+uint16_t GPS_altitude;
+uint16_t GPS_speed;
+uint16_t GPS_hdop;
+uint8_t GPS_numSat;
+
+uint8_t batteryCapacityRemainingPercentage(void) {
+    return 0;
+}
+
+amperageMeter_t *getAmperageMeter(amperageMeter_e index) {
+    UNUSED(index);
+    return &amperageMeter;
+}
+}
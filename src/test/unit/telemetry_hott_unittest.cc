@@ -27,6 +27,7 @@ extern "C" {
     #include <platform.h>
 
     #include "common/axis.h"
+    #include "common/maths.h"
     #include "common/filter.h"
 
     #include "config/parameter_group.h"
@@ -34,6 +35,8 @@ extern "C" {
     #include "config/profile.h"
 
     #include "drivers/system.h"
+    #include "drivers/sensor.h"
+    #include "drivers/accgyro.h"
     #include "drivers/serial.h"
 
     #include "fc/runtime_config.h"
@@ -44,13 +47,18 @@ extern "C" {
     #include "sensors/voltage.h"
     #include "sensors/amperage.h"
     #include "sensors/battery.h"
+    #include "sensors/acceleration.h"
 
     #include "telemetry/telemetry.h"
     #include "telemetry/hott.h"
 
     #include "flight/pid.h"
+    #include "flight/imu.h"
+
     #include "flight/gps_conversion.h"
 
+    #include "telemetry/telemetry_data.h"
+
     PG_REGISTER(batteryConfig_t, batteryConfig, PG_BATTERY_CONFIG, 0);
 
     amperageMeter_t amperageMeter;
@@ -146,7 +154,7 @@ TEST(TelemetryHottTest, PrepareGPSMessage_Altitude1m)
 
     stateFlags = GPS_FIX;
     uint16_t altitudeInMeters = 1;
-    GPS_altitude = altitudeInMeters;
+    telemetryData.gpsAltitude = altitudeInMeters;
 
     // when
     hottPrepareGPSResponse(hottGPSMessage);
@@ -164,6 +172,8 @@ int16_t debug[DEBUG16_VALUE_COUNT];
 
 uint8_t stateFlags;
 
+telemetryData_t telemetryData;
+
 uint16_t batteryWarningVoltage;
 uint8_t useHottAlarmSoundPeriod (void) { return 0; }
 
@@ -20,13 +20,22 @@
 
 extern "C" {
 #include <platform.h>
+#include "common/axis.h"
+#include "common/maths.h"
 #include "config/parameter_group.h"
+#include "drivers/sensor.h"
+#include "drivers/accgyro.h"
 #include "drivers/serial.h"
 #include "io/serial.h"
 #include "fc/rc_controls.h"
 #include "telemetry/telemetry.h"
 #include "telemetry/ibus.h"
 #include "sensors/barometer.h"
+#include "sensors/sensors.h"
+#include "sensors/acceleration.h"
+#include "flight/imu.h"
+#include "io/gps.h"
+#include "telemetry/telemetry_data.h"
 #include "scheduler/scheduler.h"
 #include "fc/fc_tasks.h"
 }
@@ -36,8 +45,7 @@ extern "C" {
 
 
 extern "C" {
-    uint8_t batteryCellCount = 3;
-    uint16_t vbat = 100;
+    telemetryData_t telemetryData;
     int16_t rcCommand[4] = {0, 0, 0, 0};
 
     int16_t telemTemperature1 = 0;
@@ -45,6 +53,14 @@ extern "C" {
 }
 
 
+// the snapshot telemetryDataUpdate() would take of the battery
+static void setBattery(uint8_t cellCount, uint16_t vbat)
+{
+    telemetryData.vbat = vbat;
+    telemetryData.cellCount = cellCount;
+    telemetryData.cellVoltage = cellCount ? vbat * 10 / cellCount : 0;
+}
+
 #define SERIAL_BUFFER_SIZE 256
 
 typedef struct serialPortStub_s {
@@ -321,7 +337,7 @@ TEST_F(IbusTelemteryProtocolUnitTest, Test_IbusRespondToGetMeasurementVbattZero)
 {
     //Given ibus command: Sensor at address 1, please send your measurement
     //then we respond with: I'm reading 0 volts
-    vbat = 0;
+    setBattery(3, 0);
     checkResponseToCommand("\x04\xA1\x5a\xff", 4, "\x06\xA1\x00\x00\x58\xFF", 6);
 }
 
@@ -331,15 +347,18 @@ TEST_F(IbusTelemteryProtocolUnitTest, Test_IbusRespondToGetMeasurementVbattCellV
 
     //Given ibus command: Sensor at address 1, please send your measurement
     //then we respond with: I'm reading 0.1 volts
-    batteryCellCount = 3;
-    vbat = 30;
+    setBattery(3, 30);
     checkResponseToCommand("\x04\xA1\x5a\xff", 4, "\x06\xA1\x64\x00\xf4\xFe", 6);
 
     //Given ibus command: Sensor at address 1, please send your measurement
     //then we respond with: I'm reading 0.1 volts
-    batteryCellCount = 1;
-    vbat = 10;
+    setBattery(1, 10);
     checkResponseToCommand("\x04\xA1\x5a\xff", 4, "\x06\xA1\x64\x00\xf4\xFe", 6);
+
+    //Given ibus command: Sensor at address 1, please send your measurement
+    //then we respond with: I'm reading 0 volts, the cell count is not known yet
+    setBattery(0, 10);
+    checkResponseToCommand("\x04\xA1\x5a\xff", 4, "\x06\xA1\x00\x00\x58\xFF", 6);
 }
 
 TEST_F(IbusTelemteryProtocolUnitTest, Test_IbusRespondToGetMeasurementVbattPackVoltage)
@@ -348,14 +367,12 @@ TEST_F(IbusTelemteryProtocolUnitTest, Test_IbusRespondToGetMeasurementVbattPackV
 
     //Given ibus command: Sensor at address 1, please send your measurement
     //then we respond with: I'm reading 0.1 volts
-    batteryCellCount = 3;
-    vbat = 10;
+    setBattery(3, 10);
     checkResponseToCommand("\x04\xA1\x5a\xff", 4, "\x06\xA1\x64\x00\xf4\xFe", 6);
 
     //Given ibus command: Sensor at address 1, please send your measurement
     //then we respond with: I'm reading 0.1 volts
-    batteryCellCount = 1;
-    vbat = 10;
+    setBattery(1, 10);
     checkResponseToCommand("\x04\xA1\x5a\xff", 4, "\x06\xA1\x64\x00\xf4\xFe", 6);
 }
 
@@ -455,8 +472,7 @@ TEST_F(IbusTelemteryProtocolUnitTestDaisyChained, Test_IbusRespondToGetMeasureme
 {
     //Given ibus command: Sensor at address 3, please send your measurement
     //then we respond with: I'm reading 0.1 volts
-    batteryCellCount = 1;
-    vbat = 10;
+    setBattery(1, 10);
     checkResponseToCommand("\x04\xA3\x58\xff", 4, "\x06\xA3\x64\x00\xf2\xFe", 6);
 
 #ifdef BARO
@@ -0,0 +1,205 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+extern "C" {
+#include <platform.h>
+#include "common/utils.h"
+#include "drivers/serial.h"
+#include "telemetry/telemetry_scheduler.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define ITEM_SIZE 6
+
+static telemetryScheduler_t scheduler;
+
+static int batteryWrites;
+static int attitudeWrites;
+static int positionWrites;
+static int trailerWrites;
+
+static int serialWriteBufCalls;
+static int serialWriteBufBytes;
+
+static void writeItem(uint8_t id, uint8_t size)
+{
+    for (int i = 0; i < size; i++) {
+        telemetryFrameWrite(&scheduler.frame, id);
+    }
+}
+
+static void writeBattery(void)
+{
+    batteryWrites++;
+    writeItem('B', ITEM_SIZE);
+}
+
+static void writeAttitude(void)
+{
+    attitudeWrites++;
+    writeItem('A', ITEM_SIZE);
+}
+
+static void writePosition(void)
+{
+    positionWrites++;
+    writeItem('P', 3 * ITEM_SIZE);
+}
+
+static void writeTrailer(void)
+{
+    trailerWrites++;
+    telemetryFrameWrite(&scheduler.frame, 'T');
+}
+
+static const telemetrySlot_t testSlots[] = {
+    { writeAttitude, 100,  1, ITEM_SIZE },
+    { writePosition, 1000, 2, 3 * ITEM_SIZE },
+    { writeBattery,  500,  0, ITEM_SIZE },
+};
+
+static void initScheduler(uint16_t bytesPerSecond, uint8_t maxFrameSize, uint32_t currentTimeMs)
+{
+    const telemetryLink_t link = {
+        .bytesPerSecond = bytesPerSecond,
+        .maxFrameSize = maxFrameSize,
+        .trailerSize = 1,
+        .writeTrailer = writeTrailer,
+    };
+
+    batteryWrites = 0;
+    attitudeWrites = 0;
+    positionWrites = 0;
+    trailerWrites = 0;
+
+    telemetrySchedulerInit(&scheduler, &link, testSlots, ARRAYLEN(testSlots), currentTimeMs);
+}
+
+TEST(TelemetrySchedulerTest, TestFrameHoldsMostImportantItemsFirst)
+{
+    initScheduler(10000, 24, 0);
+
+    // the link budget builds up from nothing after init
+    EXPECT_EQ(0, telemetrySchedulerBuildFrame(&scheduler, 255, 0));
+
+    // everything is due, battery first, then attitude, the position does not fit any more
+    EXPECT_EQ(2 * ITEM_SIZE + 1, telemetrySchedulerBuildFrame(&scheduler, 255, 10));
+    EXPECT_EQ('B', scheduler.frame.data[0]);
+    EXPECT_EQ('A', scheduler.frame.data[ITEM_SIZE]);
+    EXPECT_EQ('T', scheduler.frame.data[2 * ITEM_SIZE]);
+    EXPECT_EQ(0, positionWrites);
+
+    // the position goes out on its own in the next frame
+    EXPECT_EQ(3 * ITEM_SIZE + 1, telemetrySchedulerBuildFrame(&scheduler, 255, 14));
+    EXPECT_EQ(1, positionWrites);
+
+    // nothing due, no frame and no trailer
+    EXPECT_EQ(0, telemetrySchedulerBuildFrame(&scheduler, 255, 18));
+    EXPECT_EQ(2, trailerWrites);
+}
+
+TEST(TelemetrySchedulerTest, TestItemRates)
+{
+    initScheduler(10000, 24, 0);
+
+    // a fast link, run the telemetry task at 4ms for 10 seconds
+    for (uint32_t now = 4; now < 10000; now += 4) {
+        telemetrySchedulerBuildFrame(&scheduler, 255, now);
+    }
+
+    EXPECT_EQ(100, attitudeWrites);
+    EXPECT_EQ(20, batteryWrites);
+    EXPECT_EQ(10, positionWrites);
+}
+
+TEST(TelemetrySchedulerTest, TestLinkBudget)
+{
+    // 60 bytes/s can not carry the 60 bytes/s of attitude, 12 of battery, 18 of position and the trailers
+    initScheduler(60, 24, 0);
+
+    int bytesSent = 0;
+    for (uint32_t now = 4; now < 10000; now += 4) {
+        bytesSent += telemetrySchedulerBuildFrame(&scheduler, 255, now);
+    }
+
+    EXPECT_LE(bytesSent, 60 * 10);
+
+    // the battery keeps its rate, the less important items give way
+    EXPECT_EQ(20, batteryWrites);
+    EXPECT_LT(attitudeWrites, 100);
+}
+
+TEST(TelemetrySchedulerTest, TestPortSpace)
+{
+    initScheduler(10000, 24, 0);
+
+    // no room in the port, the items stay due
+    EXPECT_EQ(0, telemetrySchedulerBuildFrame(&scheduler, ITEM_SIZE, 10));
+    EXPECT_EQ(0, batteryWrites);
+
+    // room for the battery only
+    EXPECT_EQ(ITEM_SIZE + 1, telemetrySchedulerBuildFrame(&scheduler, ITEM_SIZE + 1, 14));
+    EXPECT_EQ(1, batteryWrites);
+    EXPECT_EQ(0, attitudeWrites);
+
+    EXPECT_EQ(ITEM_SIZE + 1, telemetrySchedulerBuildFrame(&scheduler, 255, 18));
+    EXPECT_EQ(1, attitudeWrites);
+}
+
+TEST(TelemetrySchedulerTest, TestProcessUsesOneBufferWrite)
+{
+    serialPort_t port;
+
+    initScheduler(10000, 24, 0);
+    serialWriteBufCalls = 0;
+    serialWriteBufBytes = 0;
+
+    telemetrySchedulerProcess(&scheduler, &port, 10);
+
+    EXPECT_EQ(1, serialWriteBufCalls);
+    EXPECT_EQ(2 * ITEM_SIZE + 1, serialWriteBufBytes);
+
+    // the position follows in a frame of its own, then nothing is due
+    telemetrySchedulerProcess(&scheduler, &port, 11);
+    telemetrySchedulerProcess(&scheduler, &port, 12);
+    EXPECT_EQ(2, serialWriteBufCalls);
+}
+
+// STUBS
+
+extern "C" {
+
+uint8_t serialTxBytesFree(const serialPort_t *instance)
+{
+    UNUSED(instance);
+    return 255;
+}
+
+void serialWriteBuf(serialPort_t *instance, const uint8_t *data, int count)
+{
+    UNUSED(instance);
+    UNUSED(data);
+    serialWriteBufCalls++;
+    serialWriteBufBytes += count;
+}
+
+}
@@ -0,0 +1,147 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+extern "C" {
+#include <platform.h>
+
+#include "build/trace.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+static uint32_t mockTimeUs;
+
+class TraceTest : public ::testing::Test {
+protected:
+    traceEvent_t events[TRACE_BUFFER_SIZE];
+
+    virtual void SetUp() {
+        mockTimeUs = 1000;
+        traceStop();
+        while (traceRead(events, TRACE_BUFFER_SIZE)) {
+        }
+    }
+};
+
+TEST_F(TraceTest, NothingIsRecordedUntilStarted)
+{
+    // when
+    TRACE_BEGIN(TRACE_SECTION_PID_CONTROLLER, 0);
+
+    // then
+    EXPECT_FALSE(traceIsRecording());
+    EXPECT_EQ(0, traceEventsWaiting());
+}
+
+TEST_F(TraceTest, RecordsEventsInOrder)
+{
+    // given
+    traceStart();
+
+    // when
+    TRACE_BEGIN(TRACE_SECTION_TASK, 3);
+    mockTimeUs = 1010;
+    TRACE_INSTANT(TRACE_SECTION_GYRO_DATA_READY, 0);
+    mockTimeUs = 1025;
+    TRACE_END(TRACE_SECTION_TASK, 3);
+
+    // then
+    ASSERT_EQ(3, traceRead(events, TRACE_BUFFER_SIZE));
+    EXPECT_EQ(1000u, events[0].timeUs);
+    EXPECT_EQ(TRACE_SECTION_TASK, events[0].section);
+    EXPECT_EQ(TRACE_EVENT_BEGIN | 3, events[0].flags);
+    EXPECT_EQ(TRACE_SECTION_GYRO_DATA_READY, events[1].section);
+    EXPECT_EQ(TRACE_EVENT_INSTANT, events[1].flags & TRACE_EVENT_TYPE_MASK);
+    EXPECT_EQ(1025u, events[2].timeUs);
+    EXPECT_EQ(TRACE_EVENT_END | 3, events[2].flags);
+    EXPECT_EQ(0, traceEventsWaiting());
+}
+
+TEST_F(TraceTest, ArgumentIsMasked)
+{
+    // given
+    traceStart();
+
+    // when
+    TRACE_BEGIN(TRACE_SECTION_TASK, TRACE_EVENT_ARG_MASK + 2);
+
+    // then
+    ASSERT_EQ(1, traceRead(events, 1));
+    EXPECT_EQ(TRACE_EVENT_BEGIN | 1, events[0].flags);
+}
+
+TEST_F(TraceTest, RecordingStopsWhenFull)
+{
+    // given
+    traceStart();
+
+    // when
+    for (int i = 0; i < TRACE_BUFFER_SIZE + 10; i++) {
+        mockTimeUs = i;
+        TRACE_INSTANT(TRACE_SECTION_GYRO_DATA_READY, 0);
+    }
+
+    // then, the first events are kept without gaps
+    EXPECT_FALSE(traceIsRecording());
+    EXPECT_EQ(TRACE_BUFFER_SIZE, traceEventsWaiting());
+    ASSERT_EQ(10, traceRead(events, 10));
+    EXPECT_EQ(0u, events[0].timeUs);
+    EXPECT_EQ(9u, events[9].timeUs);
+
+    // when
+    TRACE_INSTANT(TRACE_SECTION_GYRO_DATA_READY, 0);
+
+    // then
+    EXPECT_EQ(TRACE_BUFFER_SIZE - 10, traceEventsWaiting());
+}
+
+TEST_F(TraceTest, StartDiscardsEventsNotRead)
+{
+    // given
+    traceStart();
+    TRACE_BEGIN(TRACE_SECTION_MOTOR_UPDATE, 0);
+    TRACE_END(TRACE_SECTION_MOTOR_UPDATE, 0);
+
+    // when
+    traceStart();
+    TRACE_BEGIN(TRACE_SECTION_SUBPROCESSES, 0);
+
+    // then
+    ASSERT_EQ(1, traceRead(events, TRACE_BUFFER_SIZE));
+    EXPECT_EQ(TRACE_SECTION_SUBPROCESSES, events[0].section);
+}
+
+TEST_F(TraceTest, EverySectionHasAName)
+{
+    for (int i = 0; i < TRACE_SECTION_COUNT; i++) {
+        ASSERT_TRUE(traceSectionNames[i] != NULL);
+        EXPECT_LT(0u, strlen(traceSectionNames[i]));
+    }
+}
+
+// STUBS
+
+extern "C" {
+
+uint32_t micros(void) { return mockTimeUs; }
+
+}
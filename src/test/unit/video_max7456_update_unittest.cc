@@ -0,0 +1,207 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+extern "C" {
+#include <platform.h>
+
+#include "drivers/io.h"
+#include "drivers/exti.h"
+#include "drivers/video.h"
+#include "drivers/video_textscreen.h"
+#include "drivers/video_max7456.h"
+#include "drivers/video_max7456_registers.h"
+#include "drivers/video_max7456_update.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define SCREEN_SIZE MAX7456_PAL_CHARACTER_COUNT
+
+// The display memory of a MAX7456, written by the register writes in a frame.
+static struct {
+    uint8_t dmah;
+    uint8_t dmal;
+    uint8_t dmm;
+    uint8_t memory[SCREEN_SIZE];
+} mockChip;
+
+static void mockChipReceive(const uint8_t *frame, uint16_t length)
+{
+    ASSERT_EQ(0, length % 2);
+    for (uint16_t i = 0; i < length; i += 2) {
+        const uint8_t value = frame[i + 1];
+        switch (frame[i]) {
+        case MAX7456_REG_DMAH:
+            mockChip.dmah = value;
+            break;
+        case MAX7456_REG_DMAL:
+            mockChip.dmal = value;
+            break;
+        case MAX7456_REG_DMM:
+            mockChip.dmm = value;
+            break;
+        case MAX7456_REG_DMDI: {
+            const bool autoIncrement = mockChip.dmm & MAX7456_DMM_BIT_AUTO_INCREMENT;
+            if (autoIncrement && value == 0xFF) {
+                mockChip.dmm &= ~MAX7456_DMM_BIT_AUTO_INCREMENT;
+                break;
+            }
+            uint16_t address = ((mockChip.dmah & 0x01) << 8) | mockChip.dmal;
+            ASSERT_LT(address, SCREEN_SIZE);
+            mockChip.memory[address] = value;
+            if (autoIncrement) {
+                address++;
+                mockChip.dmah = address >> 8;
+                mockChip.dmal = address & 0xFF;
+            }
+            break;
+        }
+        default:
+            FAIL() << "unexpected register " << (int)frame[i];
+        }
+    }
+}
+
+class Max7456UpdateTest : public ::testing::Test {
+protected:
+    max7456Display_t display;
+    uint8_t screen[SCREEN_SIZE];
+    uint8_t frame[MAX7456_UPDATE_FRAME_SIZE];
+
+    virtual void SetUp() {
+        memset(&mockChip, 0, sizeof(mockChip));
+        memset(&display, 0, sizeof(display));
+        max7456DisplayInvalidate(&display);
+        memset(screen, ' ', sizeof(screen));
+    }
+
+    uint16_t update(uint16_t frameSize = MAX7456_UPDATE_FRAME_SIZE) {
+        const uint16_t length = max7456BuildScreenUpdate(&display, screen, SCREEN_SIZE, frame, frameSize);
+        EXPECT_LE(length, frameSize);
+        mockChipReceive(frame, length);
+        return length;
+    }
+};
+
+TEST_F(Max7456UpdateTest, FirstUpdateSendsWholeScreenInOneBurst)
+{
+    // when
+    uint16_t length = update();
+
+    // then
+    EXPECT_EQ(10 + SCREEN_SIZE * 2, length);
+    EXPECT_EQ(0, memcmp(screen, mockChip.memory, SCREEN_SIZE));
+    EXPECT_EQ(0, mockChip.dmm);
+}
+
+TEST_F(Max7456UpdateTest, UnchangedScreenSendsNothing)
+{
+    // given
+    update();
+
+    // expect
+    EXPECT_EQ(0, update());
+}
+
+TEST_F(Max7456UpdateTest, ScatteredChangesAreSentByAddress)
+{
+    // given
+    update();
+
+    // when, the values on a flight screen change, e.g. a digit of the altitude, voltage and timer
+    for (int i = 0; i < 20; i++) {
+        screen[i * 23 + 5] = '0' + i % 10;
+    }
+    uint16_t length = update();
+
+    // then, four bytes each and the high address twice
+    EXPECT_EQ(20 * 4 + 2 * 2, length);
+    EXPECT_EQ(0, memcmp(screen, mockChip.memory, SCREEN_SIZE));
+}
+
+TEST_F(Max7456UpdateTest, RunOfChangesIsSentInABurst)
+{
+    // given
+    update();
+
+    // when, a row changes along with characters close to it
+    memset(&screen[MAX7456_COLUMN_COUNT * 9], 'A', MAX7456_COLUMN_COUNT);
+    screen[MAX7456_COLUMN_COUNT * 10 + 2] = 'B';
+    uint16_t length = update();
+
+    // then, the unchanged characters in between are sent again
+    EXPECT_EQ(10 + (MAX7456_COLUMN_COUNT + 3) * 2, length);
+    EXPECT_EQ(0, memcmp(screen, mockChip.memory, SCREEN_SIZE));
+}
+
+TEST_F(Max7456UpdateTest, CharacterThatEndsAutoIncrementIsSentByAddress)
+{
+    // given
+    update();
+
+    // when
+    memset(&screen[100], 'C', 20);
+    screen[110] = 0xFF;
+    update();
+
+    // then
+    EXPECT_EQ(0, memcmp(screen, mockChip.memory, SCREEN_SIZE));
+    EXPECT_EQ(0, update());
+}
+
+TEST_F(Max7456UpdateTest, ChangesThatDoNotFitAreSentByTheNextUpdate)
+{
+    // given
+    memset(mockChip.memory, 0x55, SCREEN_SIZE);
+    for (int i = 0; i < SCREEN_SIZE; i += 7) {
+        screen[i] = 0xFF;
+    }
+
+    // when
+    uint16_t length = update(200);
+
+    // then
+    EXPECT_GT(length, 150);
+    EXPECT_NE(0, memcmp(screen, mockChip.memory, SCREEN_SIZE));
+
+    // when
+    for (int i = 0; i < 20 && update(200) > 0; i++) {
+    }
+
+    // then
+    EXPECT_EQ(0, memcmp(screen, mockChip.memory, SCREEN_SIZE));
+    EXPECT_EQ(0, update());
+}
+
+TEST_F(Max7456UpdateTest, InvalidatedDisplayIsSentAgain)
+{
+    // given
+    update();
+    memset(mockChip.memory, 0, SCREEN_SIZE);    // cleared by the chip
+
+    // when
+    max7456DisplayInvalidate(&display);
+    update();
+
+    // then
+    EXPECT_EQ(0, memcmp(screen, mockChip.memory, SCREEN_SIZE));
+}
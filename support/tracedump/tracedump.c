@@ -0,0 +1,266 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Captures trace events from a flight controller built with OPTIONS=USE_TRACE over MSP and writes them
+ * as Chrome trace JSON, which chrome://tracing and https://ui.perfetto.dev show as a timeline.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include "serial.h"
+
+#include "build/trace.h"
+#include "msp/msp_protocol.h"
+
+#define DEFAULT_PORT            "/dev/ttyUSB0"
+#define DEFAULT_BAUD            115200
+#define DEFAULT_CAPTURE_MS      50
+
+#define MSP_MAX_PAYLOAD         255
+#define MSP_REPLY_TIMEOUT_MS    500
+
+#define MAX_NAMES               64
+#define MAX_EVENTS              (TRACE_BUFFER_SIZE * 4)
+
+typedef struct names_s {
+    char buffer[MSP_MAX_PAYLOAD + 1];
+    const char *name[MAX_NAMES];
+    int count;
+} names_t;
+
+static serialStruct_t *port;
+
+static names_t sectionNames;
+static names_t taskNames;
+
+static traceEvent_t events[MAX_EVENTS];
+static int eventCount;
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: tracedump <-h> <-p device_file> <-b baud_rate> <-t capture_ms> <-o output_file>\n");
+}
+
+static long millisNow(void)
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return now.tv_sec * 1000 + now.tv_usec / 1000;
+}
+
+static int readByte(long deadline, unsigned char *c)
+{
+    while (!serialAvailable(port)) {
+        if (millisNow() > deadline) {
+            return 0;
+        }
+        usleep(100);
+    }
+    *c = serialRead(port);
+    return 1;
+}
+
+// Sends an MSP v1 request and waits for the reply, returns the payload length or -1.
+static int mspRequest(unsigned char cmd, const unsigned char *payload, unsigned char size, unsigned char *reply)
+{
+    unsigned char frame[6 + MSP_MAX_PAYLOAD];
+    unsigned char checksum = size ^ cmd;
+
+    frame[0] = '$';
+    frame[1] = 'M';
+    frame[2] = '<';
+    frame[3] = size;
+    frame[4] = cmd;
+    for (int i = 0; i < size; i++) {
+        frame[5 + i] = payload[i];
+        checksum ^= payload[i];
+    }
+    frame[5 + size] = checksum;
+    serialWrite(port, (const char *)frame, 6 + size);
+
+    const long deadline = millisNow() + MSP_REPLY_TIMEOUT_MS;
+    const char preamble[] = "$M>";
+    unsigned char c;
+    int matched = 0;
+    while (matched < 3) {
+        if (!readByte(deadline, &c)) {
+            return -1;
+        }
+        matched = (c == preamble[matched]) ? matched + 1 : (c == '$');
+    }
+
+    unsigned char replySize, replyCmd, replyChecksum;
+    if (!readByte(deadline, &replySize) || !readByte(deadline, &replyCmd)) {
+        return -1;
+    }
+    checksum = replySize ^ replyCmd;
+    for (int i = 0; i < replySize; i++) {
+        if (!readByte(deadline, &reply[i])) {
+            return -1;
+        }
+        checksum ^= reply[i];
+    }
+    if (!readByte(deadline, &replyChecksum) || replyChecksum != checksum || replyCmd != cmd) {
+        return -1;
+    }
+    return replySize;
+}
+
+static int readNames(unsigned char list, names_t *names)
+{
+    int size = mspRequest(MSP_TRACE_NAMES, &list, 1, (unsigned char *)names->buffer);
+    if (size < 0) {
+        return 0;
+    }
+    names->buffer[size] = '\0';
+    names->count = 0;
+    for (char *name = strtok(names->buffer, ";"); name && names->count < MAX_NAMES; name = strtok(NULL, ";")) {
+        names->name[names->count++] = name;
+    }
+    return 1;
+}
+
+// Sends a trace command and stores the events in the reply, returns the events left to read or -1.
+static int readEvents(unsigned char command, int *recording)
+{
+    unsigned char reply[MSP_MAX_PAYLOAD];
+    int size = mspRequest(MSP_TRACE_READ, &command, 1, reply);
+    if (size < 3) {
+        return -1;
+    }
+    *recording = reply[0];
+    const int waiting = reply[1] | (reply[2] << 8);
+
+    for (int offset = 3; offset + 6 <= size && eventCount < MAX_EVENTS; offset += 6) {
+        traceEvent_t *event = &events[eventCount++];
+        event->timeUs = reply[offset] | (reply[offset + 1] << 8) | (reply[offset + 2] << 16) | ((uint32_t)reply[offset + 3] << 24);
+        event->section = reply[offset + 4];
+        event->flags = reply[offset + 5];
+    }
+    return waiting;
+}
+
+static const char *nameOf(const names_t *names, int index)
+{
+    return index < names->count ? names->name[index] : "unknown";
+}
+
+static void writeChromeTrace(FILE *out)
+{
+    const uint32_t startUs = eventCount ? events[0].timeUs : 0;
+
+    fprintf(out, "{\"traceEvents\":[\n");
+    for (int i = 0; i < eventCount; i++) {
+        const traceEvent_t *event = &events[i];
+        const int arg = event->flags & TRACE_EVENT_ARG_MASK;
+        const int type = event->flags & TRACE_EVENT_TYPE_MASK;
+        const char *phase = type == TRACE_EVENT_INSTANT ? "i" : type == TRACE_EVENT_END ? "E" : "B";
+
+        char name[64];
+        if (event->section == TRACE_SECTION_TASK) {
+            snprintf(name, sizeof(name), "%s", nameOf(&taskNames, arg));
+        } else if (event->section == TRACE_SECTION_TIME_SECTION) {
+            snprintf(name, sizeof(name), "%s%d", nameOf(&sectionNames, event->section), arg);
+        } else {
+            snprintf(name, sizeof(name), "%s", nameOf(&sectionNames, event->section));
+        }
+
+        // the timestamps wrap after 71 minutes, the difference from the first event does not
+        fprintf(out, "{\"name\":\"%s\",\"ph\":\"%s\",\"ts\":%u,\"pid\":1,\"tid\":1%s}%s\n",
+            name, phase, (unsigned)(event->timeUs - startUs), type == TRACE_EVENT_INSTANT ? ",\"s\":\"t\"" : "",
+            i + 1 < eventCount ? "," : "");
+    }
+    fprintf(out, "],\"displayTimeUnit\":\"ns\"}\n");
+}
+
+int main(int argc, char **argv)
+{
+    const char *portName = DEFAULT_PORT;
+    const char *outputName = NULL;
+    unsigned int baud = DEFAULT_BAUD;
+    int captureMs = DEFAULT_CAPTURE_MS;
+    int ch;
+
+    while ((ch = getopt(argc, argv, "hp:b:t:o:")) != -1) {
+        switch (ch) {
+        case 'p':
+            portName = optarg;
+            break;
+        case 'b':
+            baud = atoi(optarg);
+            break;
+        case 't':
+            captureMs = atoi(optarg);
+            break;
+        case 'o':
+            outputName = optarg;
+            break;
+        case 'h':
+        default:
+            usage();
+            return ch == 'h' ? 0 : 1;
+        }
+    }
+
+    port = initSerial(portName, baud, 0);
+    if (!port) {
+        fprintf(stderr, "Cannot open serial port '%s', aborting.\n", portName);
+        return 1;
+    }
+    serialFlush(port);
+
+    if (!readNames(MSP_TRACE_NAMES_SECTIONS, &sectionNames) || !readNames(MSP_TRACE_NAMES_TASKS, &taskNames)) {
+        fprintf(stderr, "No reply to MSP_TRACE_NAMES, is the firmware built with OPTIONS=USE_TRACE?\n");
+        return 1;
+    }
+
+    int recording;
+    if (readEvents(MSP_TRACE_READ_START, &recording) < 0) {
+        fprintf(stderr, "Cannot start recording.\n");
+        return 1;
+    }
+    usleep(captureMs * 1000);
+
+    int waiting = readEvents(MSP_TRACE_READ_STOP, &recording);
+    while (waiting > 0 && eventCount < MAX_EVENTS) {
+        waiting = readEvents(MSP_TRACE_READ_EVENTS, &recording);
+    }
+    if (waiting < 0) {
+        fprintf(stderr, "Reading the events failed after %d events.\n", eventCount);
+        return 1;
+    }
+
+    FILE *out = outputName ? fopen(outputName, "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "Cannot open output file '%s', aborting.\n", outputName);
+        return 1;
+    }
+    writeChromeTrace(out);
+    if (out != stdout) {
+        fclose(out);
+    }
+    fprintf(stderr, "%d events written.\n", eventCount);
+
+    serialFree(port);
+    return 0;
+}